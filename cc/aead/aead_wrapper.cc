@@ -18,7 +18,9 @@
 
 #include "tink/aead.h"
 #include "tink/crypto_format.h"
+#include "tink/monitoring/monitoring.h"
 #include "tink/primitive_set.h"
+#include "tink/raw_key_trial_order.h"
 #include "tink/subtle/subtle_util_boringssl.h"
 #include "tink/util/status.h"
 #include "tink/util/statusor.h"
@@ -42,7 +44,10 @@ util::Status Validate(PrimitiveSet<Aead>* aead_set) {
 class AeadSetWrapper : public Aead {
  public:
   explicit AeadSetWrapper(std::unique_ptr<PrimitiveSet<Aead>> aead_set)
-      : aead_set_(std::move(aead_set)) {}
+      : aead_set_(std::move(aead_set)),
+        raw_primitives_(RawPrimitivesOrNull(aead_set_.get())),
+        raw_key_trial_order_(raw_primitives_),
+        monitoring_sink_(Monitoring::GetSink()) {}
 
   crypto::tink::util::StatusOr<std::string> Encrypt(
       absl::string_view plaintext,
@@ -56,6 +61,9 @@ class AeadSetWrapper : public Aead {
 
  private:
   std::unique_ptr<PrimitiveSet<Aead>> aead_set_;
+  const PrimitiveSet<Aead>::Primitives* raw_primitives_;
+  RawKeyTrialOrder raw_key_trial_order_;
+  std::shared_ptr<MonitoringSink> monitoring_sink_;
 };
 
 util::StatusOr<std::string> AeadSetWrapper::Encrypt(
@@ -65,11 +73,19 @@ util::StatusOr<std::string> AeadSetWrapper::Encrypt(
   // regardless of whether the size is 0.
   plaintext = subtle::SubtleUtilBoringSSL::EnsureNonNull(plaintext);
   associated_data = subtle::SubtleUtilBoringSSL::EnsureNonNull(associated_data);
+  MonitoredOperation operation(monitoring_sink_.get(), "aead",
+                               MonitoringOperation::kEncrypt,
+                               plaintext.size());
 
-  auto encrypt_result = aead_set_->get_primary()->get_primitive()
+  auto primary = aead_set_->get_primary();
+  auto encrypt_result = primary->get_primitive()
       .Encrypt(plaintext, associated_data);
-  if (!encrypt_result.ok()) return encrypt_result.status();
-  const std::string& key_id = aead_set_->get_primary()->get_identifier();
+  if (!encrypt_result.ok()) {
+    operation.RecordFailure(primary->get_key_id());
+    return encrypt_result.status();
+  }
+  operation.RecordSuccess(primary->get_key_id());
+  const std::string& key_id = primary->get_identifier();
   return key_id + encrypt_result.ValueOrDie();
 }
 
@@ -79,6 +95,9 @@ util::StatusOr<std::string> AeadSetWrapper::Decrypt(
   // BoringSSL expects a non-null pointer for plaintext and additional_data,
   // regardless of whether the size is 0.
   associated_data = subtle::SubtleUtilBoringSSL::EnsureNonNull(associated_data);
+  MonitoredOperation operation(monitoring_sink_.get(), "aead",
+                               MonitoringOperation::kDecrypt,
+                               ciphertext.size());
 
   if (ciphertext.length() > CryptoFormat::kNonRawPrefixSize) {
     const std::string& key_id = std::string(
@@ -88,9 +107,12 @@ util::StatusOr<std::string> AeadSetWrapper::Decrypt(
       absl::string_view raw_ciphertext =
           ciphertext.substr(CryptoFormat::kNonRawPrefixSize);
       for (auto& aead_entry : *(primitives_result.ValueOrDie())) {
-        Aead& aead = aead_entry->get_primitive();
+        auto aead_result = aead_entry->GetOrCreatePrimitive();
+        if (!aead_result.ok()) continue;
+        Aead& aead = *aead_result.ValueOrDie();
         auto decrypt_result = aead.Decrypt(raw_ciphertext, associated_data);
         if (decrypt_result.ok()) {
+          operation.RecordSuccess(aead_entry->get_key_id());
           return std::move(decrypt_result.ValueOrDie());
         } else {
           // LOG that a matching key didn't decrypt the ciphertext.
@@ -100,17 +122,108 @@ util::StatusOr<std::string> AeadSetWrapper::Decrypt(
   }
 
   // No matching key succeeded with decryption, try all RAW keys.
-  auto raw_primitives_result = aead_set_->get_raw_primitives();
-  if (raw_primitives_result.ok()) {
-    for (auto& aead_entry : *(raw_primitives_result.ValueOrDie())) {
-      Aead& aead = aead_entry->get_primitive();
-      auto decrypt_result = aead.Decrypt(ciphertext, associated_data);
-      if (decrypt_result.ok()) {
-        return std::move(decrypt_result.ValueOrDie());
-      }
-    }
+  std::string plaintext;
+  int index = raw_key_trial_order_.TryKeys([&](int i) {
+    operation.AddRawTrial();
+    auto aead_result = (*raw_primitives_)[i]->GetOrCreatePrimitive();
+    if (!aead_result.ok()) return false;
+    auto decrypt_result =
+        aead_result.ValueOrDie()->Decrypt(ciphertext, associated_data);
+    if (!decrypt_result.ok()) return false;
+    plaintext = std::move(decrypt_result.ValueOrDie());
+    return true;
+  });
+  if (index >= 0) {
+    operation.RecordSuccess((*raw_primitives_)[index]->get_key_id());
+    return std::move(plaintext);
   }
-  return util::Status(util::error::INVALID_ARGUMENT, "decryption failed");
+  operation.RecordFailure();
+  static const util::StaticStatus* kDecryptionFailed =
+      new util::StaticStatus(util::error::INVALID_ARGUMENT,
+                             "decryption failed");
+  return *kDecryptionFailed;
+}
+
+// The wrapper for a set with a single key, which is then the primary.
+// Binds the key's Aead and prefix at construction, so that Encrypt()
+// needs no primary lookup, and Decrypt() compares the prefix in place
+// instead of looking it up.
+class SingleKeyAeadWrapper : public Aead {
+ public:
+  explicit SingleKeyAeadWrapper(std::unique_ptr<PrimitiveSet<Aead>> aead_set)
+      : aead_set_(std::move(aead_set)),
+        aead_(&aead_set_->get_primary()->get_primitive()),
+        prefix_(aead_set_->get_primary()->get_identifier()),
+        key_id_(aead_set_->get_primary()->get_key_id()),
+        monitoring_sink_(Monitoring::GetSink()) {}
+
+  crypto::tink::util::StatusOr<std::string> Encrypt(
+      absl::string_view plaintext,
+      absl::string_view associated_data) const override;
+
+  crypto::tink::util::StatusOr<std::string> Decrypt(
+      absl::string_view ciphertext,
+      absl::string_view associated_data) const override;
+
+  ~SingleKeyAeadWrapper() override {}
+
+ private:
+  std::unique_ptr<PrimitiveSet<Aead>> aead_set_;
+  const Aead* aead_;  // Owned by aead_set_.
+  const std::string prefix_;
+  const uint32_t key_id_;
+  std::shared_ptr<MonitoringSink> monitoring_sink_;
+};
+
+util::StatusOr<std::string> SingleKeyAeadWrapper::Encrypt(
+    absl::string_view plaintext,
+    absl::string_view associated_data) const {
+  plaintext = subtle::SubtleUtilBoringSSL::EnsureNonNull(plaintext);
+  associated_data = subtle::SubtleUtilBoringSSL::EnsureNonNull(associated_data);
+  MonitoredOperation operation(monitoring_sink_.get(), "aead",
+                               MonitoringOperation::kEncrypt,
+                               plaintext.size());
+  auto encrypt_result = aead_->Encrypt(plaintext, associated_data);
+  if (!encrypt_result.ok()) {
+    operation.RecordFailure(key_id_);
+    return encrypt_result.status();
+  }
+  operation.RecordSuccess(key_id_);
+  std::string ciphertext = std::move(encrypt_result.ValueOrDie());
+  // Prepending the prefix of a TINK or LEGACY key copies the ciphertext;
+  // the ciphertext of a RAW key is returned as is.
+  ciphertext.insert(0, prefix_);
+  return std::move(ciphertext);
+}
+
+util::StatusOr<std::string> SingleKeyAeadWrapper::Decrypt(
+    absl::string_view ciphertext,
+    absl::string_view associated_data) const {
+  associated_data = subtle::SubtleUtilBoringSSL::EnsureNonNull(associated_data);
+  MonitoredOperation operation(monitoring_sink_.get(), "aead",
+                               MonitoringOperation::kDecrypt,
+                               ciphertext.size());
+  if (prefix_.empty()) {
+    operation.AddRawTrial();
+  } else if (ciphertext.size() <= prefix_.size() ||
+             ciphertext.substr(0, prefix_.size()) != prefix_) {
+    operation.RecordFailure();
+    static const util::StaticStatus* kDecryptionFailed =
+        new util::StaticStatus(util::error::INVALID_ARGUMENT,
+                               "decryption failed");
+    return *kDecryptionFailed;
+  }
+  auto decrypt_result =
+      aead_->Decrypt(ciphertext.substr(prefix_.size()), associated_data);
+  if (!decrypt_result.ok()) {
+    operation.RecordFailure();
+    static const util::StaticStatus* kDecryptionFailed =
+        new util::StaticStatus(util::error::INVALID_ARGUMENT,
+                               "decryption failed");
+    return *kDecryptionFailed;
+  }
+  operation.RecordSuccess(key_id_);
+  return std::move(decrypt_result.ValueOrDie());
 }
 
 }  // anonymous namespace
@@ -119,7 +232,12 @@ util::StatusOr<std::unique_ptr<Aead>> AeadWrapper::Wrap(
     std::unique_ptr<PrimitiveSet<Aead>> aead_set) const {
   util::Status status = Validate(aead_set.get());
   if (!status.ok()) return status;
-  std::unique_ptr<Aead> aead(new AeadSetWrapper(std::move(aead_set)));
+  std::unique_ptr<Aead> aead;
+  if (aead_set->size() == 1) {
+    aead.reset(new SingleKeyAeadWrapper(std::move(aead_set)));
+  } else {
+    aead.reset(new AeadSetWrapper(std::move(aead_set)));
+  }
   return std::move(aead);
 }
 
@@ -32,6 +32,8 @@ namespace tink {
 // instances, depending on the context:
 //   * Aead::Encrypt(...) uses the primary instance from the set
 //   * Aead::Decrypt(...) uses the instance that matches the ciphertext prefix.
+// Sets with a single instance get a specialized wrapper with the same
+// behaviour, which binds the instance and its prefix once.
 class AeadWrapper : public PrimitiveWrapper<Aead> {
  public:
   // Returns an Aead-primitive that uses Aead-instances provided in 'aead_set',
@@ -16,8 +16,12 @@
 
 #include "tink/aead/aead_wrapper.h"
 #include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
 #include "tink/aead.h"
+#include "tink/monitoring/histogram_monitoring_sink.h"
+#include "tink/monitoring/monitoring.h"
 #include "tink/primitive_set.h"
+#include "tink/raw_key_trial_order.h"
 #include "tink/util/status.h"
 #include "tink/util/test_util.h"
 
@@ -107,6 +111,184 @@ TEST(AeadSetWrapperTest, Basic) {
                       decrypt_result.status().error_message());
 }
 
+TEST(AeadSetWrapperTest, SingleKey) {
+  for (OutputPrefixType output_prefix_type :
+       {OutputPrefixType::TINK, OutputPrefixType::RAW}) {
+    Keyset::Key key;
+    key.set_output_prefix_type(output_prefix_type);
+    key.set_key_id(1234);
+    std::unique_ptr<PrimitiveSet<Aead>> aead_set(new PrimitiveSet<Aead>());
+    auto entry_result =
+        aead_set->AddPrimitive(absl::make_unique<DummyAead>("aead"), key);
+    ASSERT_TRUE(entry_result.ok()) << entry_result.status();
+    aead_set->set_primary(entry_result.ValueOrDie());
+    std::string prefix = entry_result.ValueOrDie()->get_identifier();
+
+    auto sink = std::make_shared<HistogramMonitoringSink>();
+    Monitoring::SetSink(sink);
+    auto aead_result = AeadWrapper().Wrap(std::move(aead_set));
+    Monitoring::SetSink(nullptr);
+    ASSERT_TRUE(aead_result.ok()) << aead_result.status();
+    auto aead = std::move(aead_result.ValueOrDie());
+
+    std::string plaintext = "some_plaintext";
+    std::string aad = "some_aad";
+    auto encrypt_result = aead->Encrypt(plaintext, aad);
+    ASSERT_TRUE(encrypt_result.ok()) << encrypt_result.status();
+    // Same format as produced by the wrapper for several keys.
+    EXPECT_EQ(prefix + DummyAead("aead").Encrypt(plaintext, aad).ValueOrDie(),
+              encrypt_result.ValueOrDie());
+    auto decrypt_result = aead->Decrypt(encrypt_result.ValueOrDie(), aad);
+    ASSERT_TRUE(decrypt_result.ok()) << decrypt_result.status();
+    EXPECT_EQ(plaintext, decrypt_result.ValueOrDie());
+
+    EXPECT_FALSE(aead->Decrypt("some bad ciphertext", aad).ok());
+    EXPECT_FALSE(aead->Decrypt(encrypt_result.ValueOrDie(), "bad aad").ok());
+    EXPECT_FALSE(aead->Decrypt(prefix, aad).ok());
+    if (!prefix.empty()) {
+      // A ciphertext without the prefix is rejected.
+      EXPECT_FALSE(
+          aead->Decrypt(DummyAead("aead").Encrypt(plaintext, aad).ValueOrDie(),
+                        aad)
+              .ok());
+    }
+
+    auto metrics = sink->Snapshot();
+    ASSERT_EQ(3, metrics.size());
+    EXPECT_EQ(MonitoringOperation::kEncrypt, metrics[0].operation);
+    EXPECT_EQ(1234, metrics[0].key_id);
+    EXPECT_TRUE(metrics[0].success);
+    EXPECT_EQ(MonitoringOperation::kDecrypt, metrics[1].operation);
+    EXPECT_EQ(0, metrics[1].key_id);
+    EXPECT_FALSE(metrics[1].success);
+    EXPECT_EQ(MonitoringOperation::kDecrypt, metrics[2].operation);
+    EXPECT_EQ(1234, metrics[2].key_id);
+    EXPECT_TRUE(metrics[2].success);
+    EXPECT_EQ(prefix.empty() ? 1 : 0, metrics[2].raw_trials);
+  }
+}
+
+TEST(AeadSetWrapperTest, Monitoring) {
+  Keyset keyset;
+  Keyset::Key* key = keyset.add_key();
+  key->set_output_prefix_type(OutputPrefixType::RAW);
+  key->set_key_id(1234);
+  key = keyset.add_key();
+  key->set_output_prefix_type(OutputPrefixType::TINK);
+  key->set_key_id(5678);
+
+  std::unique_ptr<PrimitiveSet<Aead>> aead_set(new PrimitiveSet<Aead>());
+  ASSERT_TRUE(aead_set
+                  ->AddPrimitive(absl::make_unique<DummyAead>("raw_aead"),
+                                 keyset.key(0))
+                  .ok());
+  auto entry_result = aead_set->AddPrimitive(
+      absl::make_unique<DummyAead>("tink_aead"), keyset.key(1));
+  ASSERT_TRUE(entry_result.ok());
+  aead_set->set_primary(entry_result.ValueOrDie());
+
+  auto sink = std::make_shared<HistogramMonitoringSink>();
+  Monitoring::SetSink(sink);
+  AeadWrapper wrapper;
+  auto aead_result = wrapper.Wrap(std::move(aead_set));
+  Monitoring::SetSink(nullptr);
+  ASSERT_TRUE(aead_result.ok()) << aead_result.status();
+  auto aead = std::move(aead_result.ValueOrDie());
+
+  std::string plaintext = "some_plaintext";
+  std::string aad = "some_aad";
+  auto encrypt_result = aead->Encrypt(plaintext, aad);
+  ASSERT_TRUE(encrypt_result.ok()) << encrypt_result.status();
+  EXPECT_TRUE(aead->Decrypt(encrypt_result.ValueOrDie(), aad).ok());
+  auto raw_ciphertext = DummyAead("raw_aead").Encrypt(plaintext, aad);
+  ASSERT_TRUE(raw_ciphertext.ok()) << raw_ciphertext.status();
+  EXPECT_TRUE(aead->Decrypt(raw_ciphertext.ValueOrDie(), aad).ok());
+  EXPECT_FALSE(aead->Decrypt("some bad ciphertext", aad).ok());
+
+  auto metrics = sink->Snapshot();
+  // Sorted by operation, then key id, then outcome.
+  ASSERT_EQ(4, metrics.size());
+  EXPECT_EQ("aead", metrics[0].primitive);
+  EXPECT_EQ(MonitoringOperation::kEncrypt, metrics[0].operation);
+  EXPECT_EQ(5678, metrics[0].key_id);
+  EXPECT_TRUE(metrics[0].success);
+  EXPECT_EQ(plaintext.size(), metrics[0].num_bytes);
+
+  EXPECT_EQ(MonitoringOperation::kDecrypt, metrics[1].operation);
+  EXPECT_EQ(0, metrics[1].key_id);
+  EXPECT_FALSE(metrics[1].success);
+  EXPECT_EQ(1, metrics[1].raw_trials);
+
+  EXPECT_EQ(MonitoringOperation::kDecrypt, metrics[2].operation);
+  EXPECT_EQ(1234, metrics[2].key_id);
+  EXPECT_TRUE(metrics[2].success);
+  EXPECT_EQ(1, metrics[2].raw_trials);
+
+  EXPECT_EQ(MonitoringOperation::kDecrypt, metrics[3].operation);
+  EXPECT_EQ(5678, metrics[3].key_id);
+  EXPECT_TRUE(metrics[3].success);
+  EXPECT_EQ(0, metrics[3].raw_trials);
+  for (const auto& metric : metrics) {
+    EXPECT_EQ(1, metric.count);
+  }
+}
+
+TEST(AeadSetWrapperTest, RawKeyTrialOrder) {
+  Keyset keyset;
+  std::unique_ptr<PrimitiveSet<Aead>> aead_set(new PrimitiveSet<Aead>());
+  for (int i = 0; i < 3; i++) {
+    Keyset::Key* key = keyset.add_key();
+    key->set_output_prefix_type(OutputPrefixType::RAW);
+    key->set_key_id(100 + i);
+    auto entry_result = aead_set->AddPrimitive(
+        absl::make_unique<DummyAead>(absl::StrCat("aead", i)), *key);
+    ASSERT_TRUE(entry_result.ok()) << entry_result.status();
+    aead_set->set_primary(entry_result.ValueOrDie());
+  }
+
+  auto sink = std::make_shared<HistogramMonitoringSink>();
+  Monitoring::SetSink(sink);
+  AeadWrapper wrapper;
+  auto aead_result = wrapper.Wrap(std::move(aead_set));
+  Monitoring::SetSink(nullptr);
+  ASSERT_TRUE(aead_result.ok()) << aead_result.status();
+  auto aead = std::move(aead_result.ValueOrDie());
+  // Returns the total number of RAW trials so far.
+  auto raw_trials = [&sink]() {
+    int64_t total = 0;
+    for (const auto& metric : sink->Snapshot()) total += metric.raw_trials;
+    return total;
+  };
+
+  std::string aad = "some_aad";
+  auto ciphertext_0 = DummyAead("aead0").Encrypt("plaintext_0", aad);
+  auto ciphertext_2 = DummyAead("aead2").Encrypt("plaintext_2", aad);
+  ASSERT_TRUE(ciphertext_0.ok() && ciphertext_2.ok());
+
+  // The keys are tried in the order of the set.
+  auto decrypt_result = aead->Decrypt(ciphertext_2.ValueOrDie(), aad);
+  ASSERT_TRUE(decrypt_result.ok()) << decrypt_result.status();
+  EXPECT_EQ("plaintext_2", decrypt_result.ValueOrDie());
+  EXPECT_EQ(3, raw_trials());
+
+  // The most recently successful key is tried first.
+  EXPECT_TRUE(aead->Decrypt(ciphertext_2.ValueOrDie(), aad).ok());
+  EXPECT_EQ(4, raw_trials());
+
+  // A hinted key is tried before the recently successful ones.
+  {
+    RawKeyHint hint(100);
+    auto hinted_result = aead->Decrypt(ciphertext_0.ValueOrDie(), aad);
+    ASSERT_TRUE(hinted_result.ok()) << hinted_result.status();
+    EXPECT_EQ("plaintext_0", hinted_result.ValueOrDie());
+    EXPECT_EQ(5, raw_trials());
+  }
+
+  // Every key is tried once when none succeeds.
+  EXPECT_FALSE(aead->Decrypt("some bad ciphertext", aad).ok());
+  EXPECT_EQ(8, raw_trials());
+}
+
 }  // namespace
 }  // namespace tink
 }  // namespace crypto
@@ -24,6 +24,7 @@
 #include "tink/mac.h"
 #include "tink/registry.h"
 #include "tink/subtle/aes_ctr_boringssl.h"
+#include "tink/subtle/aes_ctr_hmac_sha256_boringssl.h"
 #include "tink/subtle/encrypt_then_authenticate.h"
 #include "tink/subtle/hmac_boringssl.h"
 #include "tink/subtle/random.h"
@@ -34,6 +35,7 @@
 #include "tink/util/statusor.h"
 #include "tink/util/validation.h"
 #include "proto/aes_ctr_hmac_aead.pb.h"
+#include "proto/hmac.pb.h"
 #include "proto/tink.pb.h"
 
 namespace crypto {
@@ -45,6 +47,7 @@ using crypto::tink::util::StatusOr;
 using google::crypto::tink::AesCtrHmacAeadKey;
 using google::crypto::tink::AesCtrHmacAeadKeyFormat;
 using google::crypto::tink::HashType;
+using google::crypto::tink::HmacParams;
 using google::crypto::tink::KeyData;
 
 class AesCtrHmacAeadKeyFactory
@@ -95,6 +98,33 @@ const int kMinKeySizeInBytes = 16;
 const int kMinIvSizeInBytes = 12;
 const int kMinTagSizeInBytes = 10;
 
+namespace {
+
+Status ValidateHmacParams(const HmacParams& params) {
+  if (params.tag_size() < kMinTagSizeInBytes) {
+    return ToStatusF(util::error::INVALID_ARGUMENT,
+                     "Invalid HmacParams: tag_size %d is too small.",
+                     params.tag_size());
+  }
+  std::map<HashType, uint32_t> max_tag_size = {
+      {HashType::SHA1, 20}, {HashType::SHA256, 32}, {HashType::SHA512, 64}};
+  if (max_tag_size.find(params.hash()) == max_tag_size.end()) {
+    return ToStatusF(util::error::INVALID_ARGUMENT,
+                     "Invalid HmacParams: HashType '%s' not supported.",
+                     Enums::HashName(params.hash()));
+  } else {
+    if (params.tag_size() > max_tag_size[params.hash()]) {
+      return ToStatusF(
+          util::error::INVALID_ARGUMENT,
+          "Invalid HmacParams: tag_size %d is too big for HashType '%s'.",
+          params.tag_size(), Enums::HashName(params.hash()));
+    }
+  }
+  return Status::OK;
+}
+
+}  // namespace
+
 AesCtrHmacAeadKeyManager::AesCtrHmacAeadKeyManager()
     : key_factory_(absl::make_unique<AesCtrHmacAeadKeyFactory>()) {}
 
@@ -108,6 +138,17 @@ StatusOr<std::unique_ptr<Aead>> AesCtrHmacAeadKeyManager::GetPrimitiveFromKey(
     const AesCtrHmacAeadKey& aes_ctr_hmac_aead_key) const {
   Status status = Validate(aes_ctr_hmac_aead_key);
   if (!status.ok()) return status;
+  // With SHA256, the fused implementation encrypts and authenticates in a
+  // single pass, producing the same ciphertexts; the key was validated
+  // above, so neither the AES-CTR nor the HMAC primitive is needed.
+  if (aes_ctr_hmac_aead_key.hmac_key().params().hash() == HashType::SHA256) {
+    return subtle::AesCtrHmacSha256BoringSsl::New(
+        aes_ctr_hmac_aead_key.aes_ctr_key().key_value(),
+        aes_ctr_hmac_aead_key.aes_ctr_key().params().iv_size(),
+        aes_ctr_hmac_aead_key.hmac_key().key_value(),
+        aes_ctr_hmac_aead_key.hmac_key().params().tag_size());
+  }
+
   auto aes_ctr_result = subtle::AesCtrBoringSsl::New(
       aes_ctr_hmac_aead_key.aes_ctr_key().key_value(),
       aes_ctr_hmac_aead_key.aes_ctr_key().params().iv_size());
@@ -144,7 +185,16 @@ Status AesCtrHmacAeadKeyManager::Validate(const AesCtrHmacAeadKey& key) {
     return ToStatusF(util::error::INVALID_ARGUMENT,
                      "Invalid AesCtrHmacAeadKey: IV size out of range.");
   }
-  return Status::OK;
+
+  // Validate HmacKey.
+  const auto& hmac_key = key.hmac_key();
+  status = ValidateVersion(hmac_key.version(), kVersion);
+  if (!status.ok()) return status;
+  if (hmac_key.key_value().size() < kMinKeySizeInBytes) {
+    return ToStatusF(util::error::INVALID_ARGUMENT,
+                     "Invalid AesCtrHmacAeadKey: HMAC key_value is too short.");
+  }
+  return ValidateHmacParams(hmac_key.params());
 }
 
 // static
@@ -169,28 +219,7 @@ Status AesCtrHmacAeadKeyManager::Validate(
         util::error::INVALID_ARGUMENT,
         "Invalid AesCtrHmacAeadKeyFormat: HMAC key_size is too small.");
   }
-  auto params = hmac_key_format.params();
-  if (params.tag_size() < kMinTagSizeInBytes) {
-    return ToStatusF(util::error::INVALID_ARGUMENT,
-                     "Invalid HmacParams: tag_size %d is too small.",
-                     params.tag_size());
-  }
-  std::map<HashType, uint32_t> max_tag_size = {
-      {HashType::SHA1, 20}, {HashType::SHA256, 32}, {HashType::SHA512, 64}};
-  if (max_tag_size.find(params.hash()) == max_tag_size.end()) {
-    return ToStatusF(util::error::INVALID_ARGUMENT,
-                     "Invalid HmacParams: HashType '%s' not supported.",
-                     Enums::HashName(params.hash()));
-  } else {
-    if (params.tag_size() > max_tag_size[params.hash()]) {
-      return ToStatusF(
-          util::error::INVALID_ARGUMENT,
-          "Invalid HmacParams: tag_size %d is too big for HashType '%s'.",
-          params.tag_size(), Enums::HashName(params.hash()));
-    }
-  }
-
-  return Status::OK;
+  return ValidateHmacParams(hmac_key_format.params());
 }
 
 }  // namespace tink
@@ -18,6 +18,10 @@
 
 #include "tink/config.h"
 #include "tink/mac/mac_config.h"
+#include "tink/subtle/aes_ctr_boringssl.h"
+#include "tink/subtle/common_enums.h"
+#include "tink/subtle/encrypt_then_authenticate.h"
+#include "tink/subtle/hmac_boringssl.h"
 #include "tink/util/status.h"
 #include "tink/util/statusor.h"
 #include "gtest/gtest.h"
@@ -217,6 +221,94 @@ TEST_F(AesCtrHmacAeadKeyManagerTest, testPrimitives) {
   }
 }
 
+TEST_F(AesCtrHmacAeadKeyManagerTest, testPrimitivesSha256) {
+  // With SHA256 the key manager returns the fused implementation, whose
+  // ciphertexts must remain readable by EncryptThenAuthenticate.
+  std::string aad = "some aad";
+  AesCtrHmacAeadKeyManager key_manager;
+  AesCtrHmacAeadKey key;
+
+  key.set_version(0);
+  auto aes_ctr_key = key.mutable_aes_ctr_key();
+  aes_ctr_key->set_key_value(std::string(32, 'a'));
+  aes_ctr_key->mutable_params()->set_iv_size(16);
+  auto hmac_key = key.mutable_hmac_key();
+  hmac_key->set_key_value(std::string(32, 'b'));
+  hmac_key->mutable_params()->set_hash(HashType::SHA256);
+  hmac_key->mutable_params()->set_tag_size(32);
+
+  auto result = key_manager.GetPrimitive(key);
+  ASSERT_TRUE(result.ok()) << result.status();
+  auto cipher = std::move(result.ValueOrDie());
+
+  auto ind_cpa_cipher =
+      subtle::AesCtrBoringSsl::New(std::string(32, 'a'), 16);
+  ASSERT_TRUE(ind_cpa_cipher.ok()) << ind_cpa_cipher.status();
+  auto mac = subtle::HmacBoringSsl::New(subtle::HashType::SHA256, 32,
+                                        std::string(32, 'b'));
+  ASSERT_TRUE(mac.ok()) << mac.status();
+  auto composed = subtle::EncryptThenAuthenticate::New(
+      std::move(ind_cpa_cipher.ValueOrDie()), std::move(mac.ValueOrDie()), 32);
+  ASSERT_TRUE(composed.ok()) << composed.status();
+
+  for (int size : {0, 14, 100000}) {
+    std::string plaintext(size, 'p');
+    auto encrypt_result = cipher->Encrypt(plaintext, aad);
+    ASSERT_TRUE(encrypt_result.ok()) << encrypt_result.status();
+    auto decrypt_result =
+        composed.ValueOrDie()->Decrypt(encrypt_result.ValueOrDie(), aad);
+    ASSERT_TRUE(decrypt_result.ok()) << decrypt_result.status();
+    EXPECT_EQ(plaintext, decrypt_result.ValueOrDie());
+  }
+}
+
+TEST_F(AesCtrHmacAeadKeyManagerTest, testHmacKeyErrors) {
+  // The HMAC key is validated by the key manager itself, since the fused
+  // SHA256 implementation does not get the HMAC primitive.
+  AesCtrHmacAeadKeyManager key_manager;
+  AesCtrHmacAeadKey key;
+  key.set_version(0);
+  auto aes_ctr_key = key.mutable_aes_ctr_key();
+  aes_ctr_key->set_key_value(std::string(16, 'a'));
+  aes_ctr_key->mutable_params()->set_iv_size(12);
+  auto hmac_key = key.mutable_hmac_key();
+  hmac_key->set_key_value(std::string(16, 'b'));
+  hmac_key->mutable_params()->set_hash(HashType::SHA256);
+  hmac_key->mutable_params()->set_tag_size(16);
+  EXPECT_TRUE(key_manager.GetPrimitive(key).ok());
+
+  {  // Bad version.
+    AesCtrHmacAeadKey bad_key = key;
+    bad_key.mutable_hmac_key()->set_version(1);
+    auto result = key_manager.GetPrimitive(bad_key);
+    EXPECT_FALSE(result.ok());
+    EXPECT_PRED_FORMAT2(testing::IsSubstring, "version",
+                        result.status().error_message());
+  }
+
+  {  // Short key_value.
+    AesCtrHmacAeadKey bad_key = key;
+    bad_key.mutable_hmac_key()->set_key_value(std::string(15, 'b'));
+    auto result = key_manager.GetPrimitive(bad_key);
+    EXPECT_FALSE(result.ok());
+    EXPECT_EQ(util::error::INVALID_ARGUMENT, result.status().error_code());
+    EXPECT_PRED_FORMAT2(testing::IsSubstring, "too short",
+                        result.status().error_message());
+  }
+
+  {  // tag_size too big for SHA256, also modulo 256.
+    for (int tag_size : {33, 289}) {
+      AesCtrHmacAeadKey bad_key = key;
+      bad_key.mutable_hmac_key()->mutable_params()->set_tag_size(tag_size);
+      auto result = key_manager.GetPrimitive(bad_key);
+      EXPECT_FALSE(result.ok());
+      EXPECT_EQ(util::error::INVALID_ARGUMENT, result.status().error_code());
+      EXPECT_PRED_FORMAT2(testing::IsSubstring, "too big",
+                          result.status().error_message());
+    }
+  }
+}
+
 TEST_F(AesCtrHmacAeadKeyManagerTest, testNewKeyErrors) {
   AesCtrHmacAeadKeyManager key_manager;
   const KeyFactory& key_factory = key_manager.get_key_factory();
@@ -0,0 +1,116 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/aead/coalescing_async_aead.h"
+
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "tink/aead.h"
+#include "tink/async_aead.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+
+namespace {
+
+// Returns an unambiguous encoding of the pair (ciphertext, associated_data).
+std::string GetRequestKey(absl::string_view ciphertext,
+                          absl::string_view associated_data) {
+  return absl::StrCat(associated_data.size(), ":", associated_data,
+                      ciphertext);
+}
+
+}  // namespace
+
+// static
+util::StatusOr<std::unique_ptr<CoalescingAsyncAead>> CoalescingAsyncAead::New(
+    std::unique_ptr<Aead> aead, int num_threads) {
+  if (aead == nullptr) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+                        "aead must be non-NULL");
+  }
+  if (num_threads <= 0) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+                        "num_threads must be positive");
+  }
+  std::unique_ptr<CoalescingAsyncAead> async_aead(
+      new CoalescingAsyncAead(std::move(aead), num_threads));
+  return std::move(async_aead);
+}
+
+CoalescingAsyncAead::CoalescingAsyncAead(std::unique_ptr<Aead> aead,
+                                         int num_threads)
+    : aead_(std::move(aead)),
+      backend_decrypt_count_(0),
+      coalesced_decrypt_count_(0),
+      pool_(num_threads) {}
+
+void CoalescingAsyncAead::EncryptAsync(absl::string_view plaintext,
+                                       absl::string_view associated_data,
+                                       DoneCallback done) const {
+  std::string plaintext_copy(plaintext);
+  std::string associated_data_copy(associated_data);
+  pool_.Schedule([this, plaintext_copy, associated_data_copy, done]() {
+    done(aead_->Encrypt(plaintext_copy, associated_data_copy));
+  });
+}
+
+void CoalescingAsyncAead::DecryptAsync(absl::string_view ciphertext,
+                                       absl::string_view associated_data,
+                                       DoneCallback done) const {
+  std::string request_key = GetRequestKey(ciphertext, associated_data);
+  {
+    absl::MutexLock lock(&mutex_);
+    auto pending = pending_decrypts_.find(request_key);
+    if (pending != pending_decrypts_.end()) {
+      pending->second.push_back(std::move(done));
+      coalesced_decrypt_count_++;
+      return;
+    }
+    pending_decrypts_[request_key].push_back(std::move(done));
+  }
+  std::string ciphertext_copy(ciphertext);
+  std::string associated_data_copy(associated_data);
+  pool_.Schedule(
+      [this, request_key, ciphertext_copy, associated_data_copy]() {
+        RunDecrypt(request_key, ciphertext_copy, associated_data_copy);
+      });
+}
+
+void CoalescingAsyncAead::RunDecrypt(const std::string& request_key,
+                                     const std::string& ciphertext,
+                                     const std::string& associated_data) const {
+  backend_decrypt_count_++;
+  util::StatusOr<std::string> result =
+      aead_->Decrypt(ciphertext, associated_data);
+  std::vector<DoneCallback> callbacks;
+  {
+    absl::MutexLock lock(&mutex_);
+    auto pending = pending_decrypts_.find(request_key);
+    callbacks = std::move(pending->second);
+    pending_decrypts_.erase(pending);
+  }
+  // The callbacks run outside of the lock, as they may issue new requests.
+  for (auto& done : callbacks) {
+    done(result);
+  }
+}
+
+}  // namespace tink
+}  // namespace crypto
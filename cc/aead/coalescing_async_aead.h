@@ -0,0 +1,95 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_AEAD_COALESCING_ASYNC_AEAD_H_
+#define TINK_AEAD_COALESCING_ASYNC_AEAD_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "tink/aead.h"
+#include "tink/async_aead.h"
+#include "tink/util/statusor.h"
+#include "tink/util/thread_pool.h"
+
+namespace crypto {
+namespace tink {
+
+// An AsyncAead that executes the operations of a (blocking) Aead
+// on a dedicated pool of threads, so that the callers are not blocked
+// for the duration of e.g. a remote KMS call.
+//
+// Decryption requests for the same (ciphertext, associated_data) pair
+// that arrive while an identical request is still in flight are coalesced:
+// only one call is made to the underlying Aead, and its result is passed
+// to all the waiting callbacks.  This is typical for envelope encryption,
+// where many threads unwrap the same wrapped keyset at the same time.
+// Encryption requests are never coalesced, as each of them must produce
+// a fresh ciphertext.
+class CoalescingAsyncAead : public AsyncAead {
+ public:
+  // Returns an AsyncAead that forwards the operations to 'aead',
+  // using 'num_threads' worker threads.
+  static crypto::tink::util::StatusOr<std::unique_ptr<CoalescingAsyncAead>>
+  New(std::unique_ptr<Aead> aead, int num_threads);
+
+  void EncryptAsync(absl::string_view plaintext,
+                    absl::string_view associated_data,
+                    DoneCallback done) const override;
+
+  void DecryptAsync(absl::string_view ciphertext,
+                    absl::string_view associated_data,
+                    DoneCallback done) const override LOCKS_EXCLUDED(mutex_);
+
+  // Returns the number of Decrypt-calls made to the underlying Aead.
+  int64_t backend_decrypt_count() const { return backend_decrypt_count_; }
+
+  // Returns the number of decryption requests that have been served
+  // by a call already in flight, without a separate Decrypt-call.
+  int64_t coalesced_decrypt_count() const { return coalesced_decrypt_count_; }
+
+  ~CoalescingAsyncAead() override {}
+
+ private:
+  CoalescingAsyncAead(std::unique_ptr<Aead> aead, int num_threads);
+
+  // Runs the decryption identified by 'request_key', and delivers
+  // the result to all the callbacks waiting for it.
+  void RunDecrypt(const std::string& request_key, const std::string& ciphertext,
+                  const std::string& associated_data) const
+      LOCKS_EXCLUDED(mutex_);
+
+  const std::unique_ptr<Aead> aead_;
+  mutable std::atomic<int64_t> backend_decrypt_count_;
+  mutable std::atomic<int64_t> coalesced_decrypt_count_;
+  mutable absl::Mutex mutex_;
+  // Callbacks waiting for in-flight decryptions, by request key.
+  mutable std::unordered_map<std::string, std::vector<DoneCallback>>
+      pending_decrypts_ GUARDED_BY(mutex_);
+  // Declared last, so that it is destroyed (and drained) first.
+  mutable util::ThreadPool pool_;
+};
+
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_AEAD_COALESCING_ASYNC_AEAD_H_
@@ -0,0 +1,187 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/aead/coalescing_async_aead.h"
+
+#include <atomic>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/memory/memory.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "tink/aead.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "tink/util/test_util.h"
+
+namespace crypto {
+namespace tink {
+namespace {
+
+using crypto::tink::test::DummyAead;
+
+// A DummyAead whose Decrypt-calls block until 'release' is notified.
+class BlockingAead : public Aead {
+ public:
+  BlockingAead(absl::string_view name, absl::Notification* release)
+      : aead_(name), release_(release) {}
+
+  util::StatusOr<std::string> Encrypt(
+      absl::string_view plaintext,
+      absl::string_view associated_data) const override {
+    return aead_.Encrypt(plaintext, associated_data);
+  }
+
+  util::StatusOr<std::string> Decrypt(
+      absl::string_view ciphertext,
+      absl::string_view associated_data) const override {
+    release_->WaitForNotification();
+    return aead_.Decrypt(ciphertext, associated_data);
+  }
+
+ private:
+  DummyAead aead_;
+  absl::Notification* release_;
+};
+
+// Collects the results passed to the callbacks.
+class Results {
+ public:
+  explicit Results(int count) : pending_(count) {}
+
+  AsyncAead::DoneCallback Callback() {
+    return [this](util::StatusOr<std::string> result) {
+      {
+        absl::MutexLock lock(&mutex_);
+        results_.push_back(result);
+      }
+      pending_.DecrementCount();
+    };
+  }
+
+  std::vector<util::StatusOr<std::string>> Wait() {
+    pending_.Wait();
+    absl::MutexLock lock(&mutex_);
+    return results_;
+  }
+
+ private:
+  absl::BlockingCounter pending_;
+  absl::Mutex mutex_;
+  std::vector<util::StatusOr<std::string>> results_;
+};
+
+TEST(CoalescingAsyncAeadTest, InvalidArguments) {
+  auto null_aead_result = CoalescingAsyncAead::New(nullptr, 2);
+  EXPECT_FALSE(null_aead_result.ok());
+  EXPECT_EQ(util::error::INVALID_ARGUMENT,
+            null_aead_result.status().error_code());
+
+  auto no_threads_result =
+      CoalescingAsyncAead::New(absl::make_unique<DummyAead>("aead"), 0);
+  EXPECT_FALSE(no_threads_result.ok());
+  EXPECT_EQ(util::error::INVALID_ARGUMENT,
+            no_threads_result.status().error_code());
+}
+
+TEST(CoalescingAsyncAeadTest, EncryptDecrypt) {
+  auto async_aead_result =
+      CoalescingAsyncAead::New(absl::make_unique<DummyAead>("aead"), 2);
+  ASSERT_TRUE(async_aead_result.ok()) << async_aead_result.status();
+  auto async_aead = std::move(async_aead_result.ValueOrDie());
+
+  std::string plaintext = "some plaintext";
+  std::string aad = "some aad";
+  Results encrypt_results(1);
+  async_aead->EncryptAsync(plaintext, aad, encrypt_results.Callback());
+  auto ciphertexts = encrypt_results.Wait();
+  ASSERT_TRUE(ciphertexts[0].ok()) << ciphertexts[0].status();
+
+  Results decrypt_results(2);
+  async_aead->DecryptAsync(ciphertexts[0].ValueOrDie(), aad,
+                           decrypt_results.Callback());
+  async_aead->DecryptAsync(ciphertexts[0].ValueOrDie(), "wrong aad",
+                           decrypt_results.Callback());
+  int ok_count = 0;
+  for (const auto& result : decrypt_results.Wait()) {
+    if (result.ok()) {
+      ok_count++;
+      EXPECT_EQ(plaintext, result.ValueOrDie());
+    }
+  }
+  EXPECT_EQ(1, ok_count);
+}
+
+TEST(CoalescingAsyncAeadTest, IdenticalDecryptionsAreCoalesced) {
+  const int kRequestCount = 50;
+  std::string plaintext = "wrapped keyset";
+  std::string aad = "aad";
+  std::string ciphertext = DummyAead("aead").Encrypt(plaintext, aad)
+      .ValueOrDie();
+  absl::Notification release;
+  auto async_aead = std::move(
+      CoalescingAsyncAead::New(
+          absl::make_unique<BlockingAead>("aead", &release), 4).ValueOrDie());
+
+  // All requests arrive while the first one is blocked in the backend.
+  Results results(kRequestCount);
+  for (int i = 0; i < kRequestCount; i++) {
+    async_aead->DecryptAsync(ciphertext, aad, results.Callback());
+  }
+  release.Notify();
+  for (const auto& result : results.Wait()) {
+    ASSERT_TRUE(result.ok()) << result.status();
+    EXPECT_EQ(plaintext, result.ValueOrDie());
+  }
+  EXPECT_EQ(1, async_aead->backend_decrypt_count());
+  EXPECT_EQ(kRequestCount - 1, async_aead->coalesced_decrypt_count());
+
+  // Once the first call is complete, a new request goes to the backend.
+  Results more_results(1);
+  async_aead->DecryptAsync(ciphertext, aad, more_results.Callback());
+  EXPECT_TRUE(more_results.Wait()[0].ok());
+  EXPECT_EQ(2, async_aead->backend_decrypt_count());
+}
+
+TEST(CoalescingAsyncAeadTest, DifferentRequestsAreNotCoalesced) {
+  absl::Notification release;
+  auto async_aead = std::move(
+      CoalescingAsyncAead::New(
+          absl::make_unique<BlockingAead>("aead", &release), 4).ValueOrDie());
+  DummyAead aead("aead");
+  std::string ciphertext_1 = aead.Encrypt("plaintext 1", "aad").ValueOrDie();
+  std::string ciphertext_2 = aead.Encrypt("plaintext 2", "aad").ValueOrDie();
+
+  Results results(4);
+  async_aead->DecryptAsync(ciphertext_1, "aad", results.Callback());
+  async_aead->DecryptAsync(ciphertext_2, "aad", results.Callback());
+  async_aead->DecryptAsync(ciphertext_1, "other aad", results.Callback());
+  async_aead->DecryptAsync(ciphertext_1, "aad", results.Callback());
+  release.Notify();
+  int ok_count = 0;
+  for (const auto& result : results.Wait()) {
+    if (result.ok()) ok_count++;
+  }
+  EXPECT_EQ(3, ok_count);
+  EXPECT_EQ(3, async_aead->backend_decrypt_count());
+  EXPECT_EQ(1, async_aead->coalesced_decrypt_count());
+}
+
+}  // namespace
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,73 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/aead/coalescing_async_kms_client.h"
+
+#include <utility>
+
+#include "tink/aead/coalescing_async_aead.h"
+#include "tink/util/errors.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+
+// static
+util::StatusOr<std::unique_ptr<CoalescingAsyncKmsClient>>
+CoalescingAsyncKmsClient::New(std::unique_ptr<KmsClient> kms_client,
+                              int threads_per_key) {
+  if (kms_client == nullptr) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+                        "kms_client must be non-NULL");
+  }
+  if (threads_per_key <= 0) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+                        "threads_per_key must be positive");
+  }
+  std::unique_ptr<CoalescingAsyncKmsClient> client(
+      new CoalescingAsyncKmsClient(std::move(kms_client), threads_per_key));
+  return std::move(client);
+}
+
+bool CoalescingAsyncKmsClient::DoesSupport(absl::string_view key_uri) const {
+  return kms_client_->DoesSupport(key_uri);
+}
+
+util::StatusOr<std::shared_ptr<AsyncAead>>
+CoalescingAsyncKmsClient::GetAsyncAead(absl::string_view key_uri) const {
+  if (!DoesSupport(key_uri)) {
+    return ToStatusF(util::error::INVALID_ARGUMENT,
+                     "The key URI '%s' is not supported by this client.",
+                     std::string(key_uri).c_str());
+  }
+  absl::MutexLock lock(&mutex_);
+  auto found = async_aeads_.find(std::string(key_uri));
+  if (found != async_aeads_.end()) return found->second;
+
+  auto aead_result = kms_client_->GetAead(key_uri);
+  if (!aead_result.ok()) return aead_result.status();
+  auto async_aead_result = CoalescingAsyncAead::New(
+      std::move(aead_result.ValueOrDie()), threads_per_key_);
+  if (!async_aead_result.ok()) return async_aead_result.status();
+  std::shared_ptr<AsyncAead> async_aead =
+      std::move(async_aead_result.ValueOrDie());
+  async_aeads_.emplace(std::string(key_uri), async_aead);
+  return async_aead;
+}
+
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,70 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_AEAD_COALESCING_ASYNC_KMS_CLIENT_H_
+#define TINK_AEAD_COALESCING_ASYNC_KMS_CLIENT_H_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "tink/async_aead.h"
+#include "tink/async_kms_client.h"
+#include "tink/kms_client.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+
+// An AsyncKmsClient on top of a (blocking) KmsClient.
+//
+// For every key URI a single CoalescingAsyncAead is created and shared
+// by all the callers, so that identical decryption requests for the same
+// key are coalesced regardless of which caller issued them.
+class CoalescingAsyncKmsClient : public AsyncKmsClient {
+ public:
+  // Returns an AsyncKmsClient that obtains the Aead-primitives from
+  // 'kms_client', and runs each of them on 'threads_per_key' threads.
+  static crypto::tink::util::StatusOr<std::unique_ptr<CoalescingAsyncKmsClient>>
+  New(std::unique_ptr<KmsClient> kms_client, int threads_per_key);
+
+  bool DoesSupport(absl::string_view key_uri) const override;
+
+  crypto::tink::util::StatusOr<std::shared_ptr<AsyncAead>> GetAsyncAead(
+      absl::string_view key_uri) const override LOCKS_EXCLUDED(mutex_);
+
+  ~CoalescingAsyncKmsClient() override {}
+
+ private:
+  CoalescingAsyncKmsClient(std::unique_ptr<KmsClient> kms_client,
+                           int threads_per_key)
+      : kms_client_(std::move(kms_client)),
+        threads_per_key_(threads_per_key) {}
+
+  const std::unique_ptr<KmsClient> kms_client_;
+  const int threads_per_key_;
+  mutable absl::Mutex mutex_;
+  mutable std::unordered_map<std::string, std::shared_ptr<AsyncAead>>
+      async_aeads_ GUARDED_BY(mutex_);
+};
+
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_AEAD_COALESCING_ASYNC_KMS_CLIENT_H_
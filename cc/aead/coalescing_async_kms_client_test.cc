@@ -0,0 +1,107 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/aead/coalescing_async_kms_client.h"
+
+#include <atomic>
+
+#include "gtest/gtest.h"
+#include "absl/memory/memory.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/time/time.h"
+#include "tink/integration/fakekms/fake_kms_client.h"
+#include "tink/integration/fakekms/fake_kms_server.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+namespace {
+
+using crypto::tink::integration::fakekms::FakeKmsClient;
+using crypto::tink::integration::fakekms::FakeKmsServer;
+
+TEST(CoalescingAsyncKmsClientTest, InvalidArguments) {
+  auto null_client_result = CoalescingAsyncKmsClient::New(nullptr, 1);
+  EXPECT_FALSE(null_client_result.ok());
+  EXPECT_EQ(util::error::INVALID_ARGUMENT,
+            null_client_result.status().error_code());
+
+  auto server = std::make_shared<FakeKmsServer>(absl::ZeroDuration());
+  auto no_threads_result = CoalescingAsyncKmsClient::New(
+      absl::make_unique<FakeKmsClient>(server), 0);
+  EXPECT_FALSE(no_threads_result.ok());
+  EXPECT_EQ(util::error::INVALID_ARGUMENT,
+            no_threads_result.status().error_code());
+}
+
+TEST(CoalescingAsyncKmsClientTest, UnsupportedKeyUri) {
+  auto server = std::make_shared<FakeKmsServer>(absl::ZeroDuration());
+  auto client = std::move(CoalescingAsyncKmsClient::New(
+      absl::make_unique<FakeKmsClient>(server), 1).ValueOrDie());
+  EXPECT_TRUE(client->DoesSupport("fake-kms://key"));
+  EXPECT_FALSE(client->DoesSupport("gcp-kms://key"));
+  auto async_aead_result = client->GetAsyncAead("gcp-kms://key");
+  EXPECT_FALSE(async_aead_result.ok());
+  EXPECT_EQ(util::error::INVALID_ARGUMENT,
+            async_aead_result.status().error_code());
+}
+
+TEST(CoalescingAsyncKmsClientTest, SharedPerKeyUri) {
+  auto server = std::make_shared<FakeKmsServer>(absl::ZeroDuration());
+  ASSERT_TRUE(server->CreateKey("key-1").ok());
+  ASSERT_TRUE(server->CreateKey("key-2").ok());
+  auto client = std::move(CoalescingAsyncKmsClient::New(
+      absl::make_unique<FakeKmsClient>(server), 1).ValueOrDie());
+  auto aead_1 = client->GetAsyncAead("fake-kms://key-1").ValueOrDie();
+  auto aead_1_again = client->GetAsyncAead("fake-kms://key-1").ValueOrDie();
+  auto aead_2 = client->GetAsyncAead("fake-kms://key-2").ValueOrDie();
+  EXPECT_EQ(aead_1.get(), aead_1_again.get());
+  EXPECT_NE(aead_1.get(), aead_2.get());
+}
+
+TEST(CoalescingAsyncKmsClientTest, ConcurrentUnwrapping) {
+  const int kRequestCount = 100;
+  auto server = std::make_shared<FakeKmsServer>(absl::Milliseconds(20));
+  ASSERT_TRUE(server->CreateKey("kek").ok());
+  auto client = std::move(CoalescingAsyncKmsClient::New(
+      absl::make_unique<FakeKmsClient>(server), 2).ValueOrDie());
+  std::string wrapped_keyset =
+      FakeKmsClient(server).GetAead("fake-kms://kek").ValueOrDie()
+          ->Encrypt("keyset", "").ValueOrDie();
+  int64_t initial_request_count = server->request_count();
+
+  auto async_aead = client->GetAsyncAead("fake-kms://kek").ValueOrDie();
+  absl::BlockingCounter pending(kRequestCount);
+  std::atomic<int> ok_count(0);
+  for (int i = 0; i < kRequestCount; i++) {
+    async_aead->DecryptAsync(
+        wrapped_keyset, "",
+        [&pending, &ok_count](util::StatusOr<std::string> result) {
+          if (result.ok() && result.ValueOrDie() == "keyset") ok_count++;
+          pending.DecrementCount();
+        });
+  }
+  pending.Wait();
+  EXPECT_EQ(kRequestCount, ok_count);
+  // The requests are issued much faster than the simulated round-trip,
+  // so almost all of them are served by calls already in flight.
+  EXPECT_LT(server->request_count() - initial_request_count, kRequestCount);
+}
+
+}  // namespace
+}  // namespace tink
+}  // namespace crypto
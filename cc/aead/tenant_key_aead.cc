@@ -0,0 +1,179 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/aead/tenant_key_aead.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "tink/aead.h"
+#include "tink/subtle/aes_gcm_boringssl.h"
+#include "tink/subtle/hkdf.h"
+#include "tink/util/secret_data.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+
+// static
+util::StatusOr<std::unique_ptr<TenantKeyAead>> TenantKeyAead::New(
+    const util::SecretData& master_key, const Options& options,
+    AeadFactory aead_factory) {
+  if (master_key.empty()) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+                        "master_key must be non-empty");
+  }
+  if (options.key_size_in_bytes == 0) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+                        "key_size_in_bytes must be positive");
+  }
+  if (options.cache_capacity == 0) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+                        "cache_capacity must be positive");
+  }
+  if (options.shard_count <= 0) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+                        "shard_count must be positive");
+  }
+  if (aead_factory == nullptr) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+                        "aead_factory must be non-NULL");
+  }
+  auto prk_result = subtle::Hkdf::ComputeHkdfPrk(
+      options.hash, util::SecretDataAsStringView(master_key), options.salt);
+  if (!prk_result.ok()) return prk_result.status();
+  std::unique_ptr<TenantKeyAead> aead(
+      new TenantKeyAead(std::move(prk_result.ValueOrDie()), options,
+                        std::move(aead_factory)));
+  return std::move(aead);
+}
+
+// static
+util::StatusOr<std::unique_ptr<TenantKeyAead>> TenantKeyAead::NewAesGcm(
+    const util::SecretData& master_key, const Options& options) {
+  if (options.key_size_in_bytes != 16 && options.key_size_in_bytes != 32) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+                        "key_size_in_bytes must be 16 or 32 for AES-GCM");
+  }
+  return New(master_key, options, [](const util::SecretData& key) {
+    return subtle::AesGcmBoringSsl::New(util::SecretDataAsStringView(key));
+  });
+}
+
+TenantKeyAead::TenantKeyAead(util::SecretData prk, const Options& options,
+                             AeadFactory aead_factory)
+    : prk_(std::move(prk)),
+      hash_(options.hash),
+      key_size_in_bytes_(options.key_size_in_bytes),
+      shard_capacity_(std::max<size_t>(
+          1, (options.cache_capacity + options.shard_count - 1) /
+                 options.shard_count)),
+      aead_factory_(std::move(aead_factory)),
+      shards_(NewShards(options.shard_count)) {}
+
+// static
+std::vector<std::unique_ptr<TenantKeyAead::Shard>> TenantKeyAead::NewShards(
+    int count) {
+  std::vector<std::unique_ptr<Shard>> shards;
+  for (int i = 0; i < count; i++) shards.push_back(absl::make_unique<Shard>());
+  return shards;
+}
+
+TenantKeyAead::Shard* TenantKeyAead::GetShard(
+    absl::string_view tenant_id) const {
+  size_t hash = absl::Hash<absl::string_view>()(tenant_id);
+  // The low bits of the hash also pick the bucket within the shard, so
+  // the shard is picked by the high bits.
+  return shards_[(hash >> (sizeof(size_t) * 4)) % shards_.size()].get();
+}
+
+util::StatusOr<std::unique_ptr<Aead>> TenantKeyAead::NewAead(
+    absl::string_view tenant_id) const {
+  auto key_result =
+      subtle::Hkdf::ExpandHkdfPrk(hash_, prk_, tenant_id, key_size_in_bytes_);
+  if (!key_result.ok()) return key_result.status();
+  return aead_factory_(key_result.ValueOrDie());
+}
+
+util::StatusOr<std::shared_ptr<const Aead>> TenantKeyAead::GetAead(
+    absl::string_view tenant_id) const {
+  Shard* shard = GetShard(tenant_id);
+  {
+    absl::MutexLock lock(&shard->mutex);
+    auto found = shard->index.find(tenant_id);
+    if (found != shard->index.end()) {
+      shard->hits++;
+      shard->lru.splice(shard->lru.begin(), shard->lru, found->second);
+      return found->second->aead;
+    }
+    shard->misses++;
+  }
+  // The key is derived without holding the lock, so that a miss does not
+  // delay the other tenants of the shard.  Concurrent misses for the same
+  // tenant may thus derive its key more than once; only one of the
+  // results is cached.
+  auto aead_result = NewAead(tenant_id);
+  if (!aead_result.ok()) return aead_result.status();
+  std::shared_ptr<const Aead> aead = std::move(aead_result.ValueOrDie());
+
+  absl::MutexLock lock(&shard->mutex);
+  auto found = shard->index.find(tenant_id);
+  if (found != shard->index.end()) {
+    shard->lru.splice(shard->lru.begin(), shard->lru, found->second);
+    return found->second->aead;
+  }
+  shard->lru.push_front(Entry{std::string(tenant_id), aead});
+  shard->index.emplace(shard->lru.front().tenant_id, shard->lru.begin());
+  if (shard->lru.size() > shard_capacity_) {
+    shard->index.erase(shard->lru.back().tenant_id);
+    shard->lru.pop_back();
+    shard->evictions++;
+  }
+  return aead;
+}
+
+util::StatusOr<std::string> TenantKeyAead::Encrypt(
+    absl::string_view tenant_id, absl::string_view plaintext,
+    absl::string_view associated_data) const {
+  auto aead_result = GetAead(tenant_id);
+  if (!aead_result.ok()) return aead_result.status();
+  return aead_result.ValueOrDie()->Encrypt(plaintext, associated_data);
+}
+
+util::StatusOr<std::string> TenantKeyAead::Decrypt(
+    absl::string_view tenant_id, absl::string_view ciphertext,
+    absl::string_view associated_data) const {
+  auto aead_result = GetAead(tenant_id);
+  if (!aead_result.ok()) return aead_result.status();
+  return aead_result.ValueOrDie()->Decrypt(ciphertext, associated_data);
+}
+
+TenantKeyAead::CacheStats TenantKeyAead::GetCacheStats() const {
+  CacheStats stats = {0, 0, 0, 0};
+  for (const auto& shard : shards_) {
+    absl::MutexLock lock(&shard->mutex);
+    stats.hits += shard->hits;
+    stats.misses += shard->misses;
+    stats.evictions += shard->evictions;
+    stats.size += shard->lru.size();
+  }
+  return stats;
+}
+
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,142 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_AEAD_TENANT_KEY_AEAD_H_
+#define TINK_AEAD_TENANT_KEY_AEAD_H_
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/hash/hash.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "tink/aead.h"
+#include "tink/subtle/common_enums.h"
+#include "tink/util/secret_data.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+
+// AEAD with a separate key for each tenant, where the keys are derived
+// from a single master key instead of being stored in their own keysets.
+//
+// The key of a tenant is HKDF(master key, salt, info = tenant id), and it
+// is used with the subtle Aead returned by an AeadFactory (AES-GCM for
+// NewAesGcm()).  The pseudorandom key of HKDF is computed once in New(),
+// so that deriving a tenant key only takes the "expand" step.
+//
+// The Aead instances of recently used tenants are kept in a bounded LRU
+// cache, split into shards with their own locks.  Encrypting or
+// decrypting for a cached tenant only costs a lookup in its shard; for
+// any other tenant, one key derivation and one key setup.
+class TenantKeyAead {
+ public:
+  // Returns the Aead for a derived key.
+  using AeadFactory = std::function<
+      crypto::tink::util::StatusOr<std::unique_ptr<Aead>>(
+          const crypto::tink::util::SecretData& key)>;
+
+  struct Options {
+    subtle::HashType hash = subtle::HashType::SHA256;
+    std::string salt;
+    size_t key_size_in_bytes = 32;
+    // The maximum number of cached Aead instances, in all shards.
+    size_t cache_capacity = 10000;
+    int shard_count = 16;
+  };
+
+  struct CacheStats {
+    int64_t hits;
+    int64_t misses;
+    int64_t evictions;
+    // The number of cached Aead instances.
+    int64_t size;
+  };
+
+  static crypto::tink::util::StatusOr<std::unique_ptr<TenantKeyAead>> New(
+      const crypto::tink::util::SecretData& master_key, const Options& options,
+      AeadFactory aead_factory);
+
+  // Same as New(), with AesGcmBoringSsl as the Aead of the tenants.
+  // options.key_size_in_bytes must be 16 or 32.
+  static crypto::tink::util::StatusOr<std::unique_ptr<TenantKeyAead>>
+  NewAesGcm(const crypto::tink::util::SecretData& master_key,
+            const Options& options);
+
+  // Returns the Aead of 'tenant_id'.  It remains usable after it has
+  // been evicted from the cache.
+  crypto::tink::util::StatusOr<std::shared_ptr<const Aead>> GetAead(
+      absl::string_view tenant_id) const;
+
+  crypto::tink::util::StatusOr<std::string> Encrypt(
+      absl::string_view tenant_id, absl::string_view plaintext,
+      absl::string_view associated_data) const;
+
+  crypto::tink::util::StatusOr<std::string> Decrypt(
+      absl::string_view tenant_id, absl::string_view ciphertext,
+      absl::string_view associated_data) const;
+
+  CacheStats GetCacheStats() const;
+
+ private:
+  struct Entry {
+    std::string tenant_id;
+    std::shared_ptr<const Aead> aead;
+  };
+
+  struct Shard {
+    absl::Mutex mutex;
+    // The cached instances, the most recently used first.
+    std::list<Entry> lru GUARDED_BY(mutex);
+    // The elements of 'lru', by their tenant ids (which are owned by
+    // the elements, so that lookups do not copy the tenant id).
+    std::unordered_map<absl::string_view, std::list<Entry>::iterator,
+                       absl::Hash<absl::string_view>>
+        index GUARDED_BY(mutex);
+    int64_t hits GUARDED_BY(mutex) = 0;
+    int64_t misses GUARDED_BY(mutex) = 0;
+    int64_t evictions GUARDED_BY(mutex) = 0;
+  };
+
+  TenantKeyAead(crypto::tink::util::SecretData prk, const Options& options,
+                AeadFactory aead_factory);
+
+  static std::vector<std::unique_ptr<Shard>> NewShards(int count);
+
+  Shard* GetShard(absl::string_view tenant_id) const;
+
+  // Derives the key of 'tenant_id' and creates its Aead.
+  crypto::tink::util::StatusOr<std::unique_ptr<Aead>> NewAead(
+      absl::string_view tenant_id) const;
+
+  const crypto::tink::util::SecretData prk_;
+  const subtle::HashType hash_;
+  const size_t key_size_in_bytes_;
+  const size_t shard_capacity_;
+  const AeadFactory aead_factory_;
+  const std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_AEAD_TENANT_KEY_AEAD_H_
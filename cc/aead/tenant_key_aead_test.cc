@@ -0,0 +1,218 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/aead/tenant_key_aead.h"
+
+#include <atomic>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "gtest/gtest.h"
+#include "tink/subtle/aes_gcm_boringssl.h"
+#include "tink/subtle/common_enums.h"
+#include "tink/subtle/hkdf.h"
+#include "tink/util/secret_data.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+namespace {
+
+using crypto::tink::util::SecretData;
+using crypto::tink::util::SecretDataFromStringView;
+
+const char kMasterKey[] = "0123456789abcdef0123456789abcdef";
+
+TenantKeyAead::Options GetOptions(size_t cache_capacity, int shard_count) {
+  TenantKeyAead::Options options;
+  options.salt = "tenant key salt";
+  options.cache_capacity = cache_capacity;
+  options.shard_count = shard_count;
+  return options;
+}
+
+// Returns an AeadFactory that creates AES-GCM instances, and counts them.
+TenantKeyAead::AeadFactory CountingFactory(std::atomic<int>* count) {
+  return [count](const SecretData& key) {
+    (*count)++;
+    return subtle::AesGcmBoringSsl::New(util::SecretDataAsStringView(key));
+  };
+}
+
+TEST(TenantKeyAeadTest, EncryptDecrypt) {
+  auto aead_result = TenantKeyAead::NewAesGcm(
+      SecretDataFromStringView(kMasterKey), GetOptions(100, 4));
+  ASSERT_TRUE(aead_result.ok()) << aead_result.status();
+  auto& aead = aead_result.ValueOrDie();
+
+  auto ciphertext = aead->Encrypt("tenant 1", "some plaintext", "some ad");
+  ASSERT_TRUE(ciphertext.ok()) << ciphertext.status();
+  auto plaintext =
+      aead->Decrypt("tenant 1", ciphertext.ValueOrDie(), "some ad");
+  ASSERT_TRUE(plaintext.ok()) << plaintext.status();
+  EXPECT_EQ("some plaintext", plaintext.ValueOrDie());
+
+  // The tenants have different keys.
+  EXPECT_FALSE(
+      aead->Decrypt("tenant 2", ciphertext.ValueOrDie(), "some ad").ok());
+  EXPECT_FALSE(
+      aead->Decrypt("tenant 1", ciphertext.ValueOrDie(), "other ad").ok());
+}
+
+TEST(TenantKeyAeadTest, KeysAreDerivedWithHkdf) {
+  TenantKeyAead::Options options = GetOptions(100, 4);
+  auto aead_result =
+      TenantKeyAead::NewAesGcm(SecretDataFromStringView(kMasterKey), options);
+  ASSERT_TRUE(aead_result.ok()) << aead_result.status();
+  auto ciphertext =
+      aead_result.ValueOrDie()->Encrypt("tenant", "plaintext", "ad");
+  ASSERT_TRUE(ciphertext.ok()) << ciphertext.status();
+
+  auto key_result = subtle::Hkdf::ComputeHkdf(
+      subtle::HashType::SHA256, kMasterKey, options.salt, "tenant", 32);
+  ASSERT_TRUE(key_result.ok()) << key_result.status();
+  auto expected_aead = subtle::AesGcmBoringSsl::New(key_result.ValueOrDie());
+  ASSERT_TRUE(expected_aead.ok()) << expected_aead.status();
+  auto plaintext =
+      expected_aead.ValueOrDie()->Decrypt(ciphertext.ValueOrDie(), "ad");
+  ASSERT_TRUE(plaintext.ok()) << plaintext.status();
+  EXPECT_EQ("plaintext", plaintext.ValueOrDie());
+}
+
+TEST(TenantKeyAeadTest, CacheHitsAndMisses) {
+  std::atomic<int> count(0);
+  auto aead_result =
+      TenantKeyAead::New(SecretDataFromStringView(kMasterKey),
+                         GetOptions(100, 4), CountingFactory(&count));
+  ASSERT_TRUE(aead_result.ok()) << aead_result.status();
+  auto& aead = aead_result.ValueOrDie();
+
+  auto first = aead->GetAead("tenant");
+  ASSERT_TRUE(first.ok()) << first.status();
+  auto second = aead->GetAead("tenant");
+  ASSERT_TRUE(second.ok()) << second.status();
+  EXPECT_EQ(first.ValueOrDie().get(), second.ValueOrDie().get());
+  ASSERT_TRUE(aead->GetAead("other tenant").ok());
+  EXPECT_EQ(2, count);
+
+  TenantKeyAead::CacheStats stats = aead->GetCacheStats();
+  EXPECT_EQ(1, stats.hits);
+  EXPECT_EQ(2, stats.misses);
+  EXPECT_EQ(0, stats.evictions);
+  EXPECT_EQ(2, stats.size);
+}
+
+TEST(TenantKeyAeadTest, LeastRecentlyUsedIsEvicted) {
+  std::atomic<int> count(0);
+  auto aead_result =
+      TenantKeyAead::New(SecretDataFromStringView(kMasterKey),
+                         GetOptions(2, 1), CountingFactory(&count));
+  ASSERT_TRUE(aead_result.ok()) << aead_result.status();
+  auto& aead = aead_result.ValueOrDie();
+
+  auto evicted = aead->GetAead("b");
+  ASSERT_TRUE(evicted.ok());
+  ASSERT_TRUE(aead->GetAead("a").ok());
+  ASSERT_TRUE(aead->GetAead("b").ok());
+  ASSERT_TRUE(aead->GetAead("a").ok());
+  // Evicts "b", which was used less recently than "a".
+  ASSERT_TRUE(aead->GetAead("c").ok());
+  EXPECT_EQ(3, count);
+  TenantKeyAead::CacheStats stats = aead->GetCacheStats();
+  EXPECT_EQ(1, stats.evictions);
+  EXPECT_EQ(2, stats.size);
+
+  ASSERT_TRUE(aead->GetAead("a").ok());
+  EXPECT_EQ(3, count);
+  ASSERT_TRUE(aead->GetAead("b").ok());
+  EXPECT_EQ(4, count);
+
+  // Evicted instances remain usable.
+  auto ciphertext = evicted.ValueOrDie()->Encrypt("plaintext", "ad");
+  ASSERT_TRUE(ciphertext.ok()) << ciphertext.status();
+  EXPECT_TRUE(aead->Decrypt("b", ciphertext.ValueOrDie(), "ad").ok());
+}
+
+TEST(TenantKeyAeadTest, FactoryErrorsAreNotCached) {
+  std::atomic<int> count(0);
+  auto aead_result = TenantKeyAead::New(
+      SecretDataFromStringView(kMasterKey), GetOptions(100, 4),
+      [&count](const SecretData& key)
+          -> util::StatusOr<std::unique_ptr<Aead>> {
+        count++;
+        return util::Status(util::error::INTERNAL, "no aead");
+      });
+  ASSERT_TRUE(aead_result.ok()) << aead_result.status();
+  auto& aead = aead_result.ValueOrDie();
+  EXPECT_FALSE(aead->GetAead("tenant").ok());
+  EXPECT_FALSE(aead->Encrypt("tenant", "plaintext", "ad").ok());
+  EXPECT_EQ(2, count);
+  EXPECT_EQ(0, aead->GetCacheStats().size);
+}
+
+TEST(TenantKeyAeadTest, InvalidArguments) {
+  SecretData master_key = SecretDataFromStringView(kMasterKey);
+  EXPECT_FALSE(
+      TenantKeyAead::NewAesGcm(SecretData(), GetOptions(100, 4)).ok());
+  EXPECT_FALSE(TenantKeyAead::NewAesGcm(master_key, GetOptions(0, 4)).ok());
+  EXPECT_FALSE(TenantKeyAead::NewAesGcm(master_key, GetOptions(100, 0)).ok());
+  TenantKeyAead::Options options = GetOptions(100, 4);
+  options.key_size_in_bytes = 24;
+  EXPECT_FALSE(TenantKeyAead::NewAesGcm(master_key, options).ok());
+  EXPECT_FALSE(
+      TenantKeyAead::New(master_key, GetOptions(100, 4), nullptr).ok());
+}
+
+TEST(TenantKeyAeadTest, ManyThreads) {
+  std::atomic<int> count(0);
+  auto aead_result =
+      TenantKeyAead::New(SecretDataFromStringView(kMasterKey),
+                         GetOptions(50, 4), CountingFactory(&count));
+  ASSERT_TRUE(aead_result.ok()) << aead_result.status();
+  const TenantKeyAead* aead = aead_result.ValueOrDie().get();
+
+  const int kThreadCount = 8;
+  const int kTenantCount = 100;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreadCount; t++) {
+    threads.emplace_back([aead, t]() {
+      for (int i = 0; i < 2 * kTenantCount; i++) {
+        std::string tenant_id = absl::StrCat("tenant ", (i * (t + 1)) % kTenantCount);
+        std::string plaintext = absl::StrCat("message ", t, " ", i);
+        auto ciphertext = aead->Encrypt(tenant_id, plaintext, "ad");
+        ASSERT_TRUE(ciphertext.ok()) << ciphertext.status();
+        auto decrypted =
+            aead->Decrypt(tenant_id, ciphertext.ValueOrDie(), "ad");
+        ASSERT_TRUE(decrypted.ok()) << decrypted.status();
+        EXPECT_EQ(plaintext, decrypted.ValueOrDie());
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  TenantKeyAead::CacheStats stats = aead->GetCacheStats();
+  EXPECT_EQ(2 * 2 * kTenantCount * kThreadCount, stats.hits + stats.misses);
+  EXPECT_LE(stats.size, 52);  // The capacity, rounded up to the shards.
+  // Concurrent misses for the same tenant cache only one instance.
+  EXPECT_LE(stats.size + stats.evictions, stats.misses);
+}
+
+}  // namespace
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,62 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_ASYNC_AEAD_H_
+#define TINK_ASYNC_AEAD_H_
+
+#include <functional>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+
+///////////////////////////////////////////////////////////////////////////////
+// The asynchronous variant of the Aead-interface, for implementations
+// whose operations have a high latency, e.g. because they are backed
+// by a remote key management service.  The security guarantees are the
+// same as for Aead.
+//
+// The operations return immediately; the result is delivered by invoking
+// 'done' exactly once, possibly on a different thread than the caller's.
+// The inputs are copied as needed, i.e. the caller does not have to keep
+// 'plaintext', 'ciphertext' or 'associated_data' alive until 'done' runs.
+class AsyncAead {
+ public:
+  using DoneCallback =
+      std::function<void(crypto::tink::util::StatusOr<std::string>)>;
+
+  // Encrypts 'plaintext' with 'associated_data' as associated data,
+  // and passes the resulting ciphertext to 'done'.
+  virtual void EncryptAsync(absl::string_view plaintext,
+                            absl::string_view associated_data,
+                            DoneCallback done) const = 0;
+
+  // Decrypts 'ciphertext' with 'associated_data' as associated data,
+  // and passes the resulting plaintext to 'done'.
+  virtual void DecryptAsync(absl::string_view ciphertext,
+                            absl::string_view associated_data,
+                            DoneCallback done) const = 0;
+
+  virtual ~AsyncAead() {}
+};
+
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_ASYNC_AEAD_H_
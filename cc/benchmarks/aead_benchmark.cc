@@ -0,0 +1,327 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Benchmarks of the AEAD and IND-CPA primitives in tink/subtle.
+// The arguments of each benchmark are the message size in bytes and
+// the key size in bytes.
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tink/aead.h"
+#include "tink/aead/tenant_key_aead.h"
+#include "tink/benchmarks/benchmark_util.h"
+#include "tink/subtle/aes_ctr_boringssl.h"
+#include "tink/subtle/aes_ctr_hmac_sha256_boringssl.h"
+#include "tink/subtle/aes_eax_boringssl.h"
+#include "tink/subtle/aes_gcm_boringssl.h"
+#include "tink/subtle/aes_gcm_siv_boringssl.h"
+#include "tink/subtle/buffer_pool.h"
+#include "tink/subtle/common_enums.h"
+#include "tink/subtle/encrypt_then_authenticate.h"
+#include "tink/subtle/hmac_boringssl.h"
+#include "tink/subtle/ind_cpa_cipher.h"
+#include "tink/subtle/pooled_aead.h"
+#include "tink/subtle/random.h"
+#include "tink/subtle/xchacha20_poly1305_boringssl.h"
+#include "tink/util/secret_data.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+namespace benchmarks {
+namespace {
+
+using NewAeadFunction =
+    util::StatusOr<std::unique_ptr<Aead>> (*)(absl::string_view key_value);
+
+const char kAssociatedData[] = "associated data";
+
+util::StatusOr<std::unique_ptr<Aead>> NewAesEax(absl::string_view key_value) {
+  return subtle::AesEaxBoringSsl::New(key_value, 16);
+}
+
+void AesKeySizes(benchmark::internal::Benchmark* benchmark) {
+  MessageAndKeySizes(benchmark, {16, 32});
+}
+
+void ChaChaKeySizes(benchmark::internal::Benchmark* benchmark) {
+  MessageAndKeySizes(benchmark, {32});
+}
+
+// Creates a new AEAD with a random key of the size given by the second
+// argument of 'state'.
+std::unique_ptr<Aead> NewAeadOrSkip(benchmark::State& state,
+                                    NewAeadFunction new_aead) {
+  auto aead_result =
+      new_aead(subtle::Random::GetRandomBytes(state.range(1)));
+  if (!CheckOk(state, aead_result.status())) return nullptr;
+  return std::move(aead_result.ValueOrDie());
+}
+
+void BM_AeadEncrypt(benchmark::State& state, NewAeadFunction new_aead) {
+  std::unique_ptr<Aead> aead = NewAeadOrSkip(state, new_aead);
+  if (aead == nullptr) return;
+  std::string plaintext = RandomMessage(state.range(0));
+  int64_t allocations = ThreadAllocationCount();
+  for (auto _ : state) {
+    auto result = aead->Encrypt(plaintext, kAssociatedData);
+    if (!CheckOk(state, result.status())) return;
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetBytesProcessed(state.iterations() * plaintext.size());
+  ReportAllocationsPerOp(state, allocations);
+}
+
+void BM_AeadDecrypt(benchmark::State& state, NewAeadFunction new_aead) {
+  std::unique_ptr<Aead> aead = NewAeadOrSkip(state, new_aead);
+  if (aead == nullptr) return;
+  std::string plaintext = RandomMessage(state.range(0));
+  auto ciphertext = aead->Encrypt(plaintext, kAssociatedData);
+  if (!CheckOk(state, ciphertext.status())) return;
+  int64_t allocations = ThreadAllocationCount();
+  for (auto _ : state) {
+    auto result = aead->Decrypt(ciphertext.ValueOrDie(), kAssociatedData);
+    if (!CheckOk(state, result.status())) return;
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetBytesProcessed(state.iterations() * plaintext.size());
+  ReportAllocationsPerOp(state, allocations);
+}
+
+// Decrypts ciphertexts whose last byte (part of the tag) was flipped, i.e.
+// the rate at which invalid ciphertexts are rejected.  Rejecting them
+// should not allocate memory.
+void BM_AeadDecryptInvalid(benchmark::State& state, NewAeadFunction new_aead) {
+  std::unique_ptr<Aead> aead = NewAeadOrSkip(state, new_aead);
+  if (aead == nullptr) return;
+  auto ciphertext =
+      aead->Encrypt(RandomMessage(state.range(0)), kAssociatedData);
+  if (!CheckOk(state, ciphertext.status())) return;
+  std::string invalid = ciphertext.ValueOrDie();
+  invalid.back() ^= 1;
+  int64_t allocations = ThreadAllocationCount();
+  for (auto _ : state) {
+    auto result = aead->Decrypt(invalid, kAssociatedData);
+    if (result.ok()) {
+      state.SkipWithError("invalid ciphertext was accepted");
+      return;
+    }
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetItemsProcessed(state.iterations());
+  ReportAllocationsPerOp(state, allocations);
+}
+
+#define AEAD_BENCHMARKS(name, new_aead, key_sizes)                  \
+  BENCHMARK_CAPTURE(BM_AeadEncrypt, name, new_aead)->Apply(key_sizes); \
+  BENCHMARK_CAPTURE(BM_AeadDecrypt, name, new_aead)->Apply(key_sizes); \
+  BENCHMARK_CAPTURE(BM_AeadDecryptInvalid, name, new_aead)->Apply(key_sizes)
+
+AEAD_BENCHMARKS(AesGcm, &subtle::AesGcmBoringSsl::New, AesKeySizes);
+AEAD_BENCHMARKS(AesGcmSiv, &subtle::AesGcmSivBoringSsl::New, AesKeySizes);
+AEAD_BENCHMARKS(AesEax, &NewAesEax, AesKeySizes);
+AEAD_BENCHMARKS(XChaCha20Poly1305, &subtle::XChacha20Poly1305BoringSsl::New,
+                ChaChaKeySizes);
+
+// AES-CTR with HMAC-SHA256, as the composition of AesCtrBoringSsl and
+// HmacBoringSsl that makes two passes over the message, and as the fused
+// implementation that makes one.  Both use a 32 byte HMAC key, 16 byte IVs
+// and 16 byte tags; the second argument is the AES key size.
+constexpr int kHmacKeySize = 32;
+constexpr int kAesCtrHmacIvSize = 16;
+constexpr int kAesCtrHmacTagSize = 16;
+
+util::StatusOr<std::unique_ptr<Aead>> NewAesCtrHmacSha256Composed(
+    absl::string_view key_value) {
+  auto cipher_result = subtle::AesCtrBoringSsl::New(key_value,
+                                                    kAesCtrHmacIvSize);
+  if (!cipher_result.ok()) return cipher_result.status();
+  auto mac_result = subtle::HmacBoringSsl::New(
+      subtle::HashType::SHA256, kAesCtrHmacTagSize,
+      subtle::Random::GetRandomBytes(kHmacKeySize));
+  if (!mac_result.ok()) return mac_result.status();
+  return subtle::EncryptThenAuthenticate::New(
+      std::move(cipher_result.ValueOrDie()),
+      std::move(mac_result.ValueOrDie()), kAesCtrHmacTagSize);
+}
+
+util::StatusOr<std::unique_ptr<Aead>> NewAesCtrHmacSha256Fused(
+    absl::string_view key_value) {
+  return subtle::AesCtrHmacSha256BoringSsl::New(
+      key_value, kAesCtrHmacIvSize,
+      subtle::Random::GetRandomBytes(kHmacKeySize), kAesCtrHmacTagSize);
+}
+
+AEAD_BENCHMARKS(AesCtrHmacSha256Composed, &NewAesCtrHmacSha256Composed,
+                AesKeySizes);
+AEAD_BENCHMARKS(AesCtrHmacSha256Fused, &NewAesCtrHmacSha256Fused,
+                AesKeySizes);
+
+// The same primitives, writing their outputs into buffers of
+// BufferPool::Default() instead of into new strings.
+const subtle::PooledAead* GetPooledAeadOrSkip(benchmark::State& state,
+                                              const Aead& aead) {
+  auto pooled = dynamic_cast<const subtle::PooledAead*>(&aead);
+  if (pooled == nullptr) state.SkipWithError("not a PooledAead");
+  return pooled;
+}
+
+void BM_AeadEncryptToBuffer(benchmark::State& state,
+                            NewAeadFunction new_aead) {
+  std::unique_ptr<Aead> aead = NewAeadOrSkip(state, new_aead);
+  if (aead == nullptr) return;
+  const subtle::PooledAead* pooled = GetPooledAeadOrSkip(state, *aead);
+  if (pooled == nullptr) return;
+  subtle::BufferPool* pool = subtle::BufferPool::Default();
+  std::string plaintext = RandomMessage(state.range(0));
+  int64_t allocations = ThreadAllocationCount();
+  for (auto _ : state) {
+    auto result = pooled->EncryptToBuffer(plaintext, kAssociatedData, pool);
+    if (!CheckOk(state, result.status())) return;
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetBytesProcessed(state.iterations() * plaintext.size());
+  ReportAllocationsPerOp(state, allocations);
+}
+
+void BM_AeadDecryptToBuffer(benchmark::State& state,
+                            NewAeadFunction new_aead) {
+  std::unique_ptr<Aead> aead = NewAeadOrSkip(state, new_aead);
+  if (aead == nullptr) return;
+  const subtle::PooledAead* pooled = GetPooledAeadOrSkip(state, *aead);
+  if (pooled == nullptr) return;
+  subtle::BufferPool* pool = subtle::BufferPool::Default();
+  std::string plaintext = RandomMessage(state.range(0));
+  auto ciphertext = aead->Encrypt(plaintext, kAssociatedData);
+  if (!CheckOk(state, ciphertext.status())) return;
+  int64_t allocations = ThreadAllocationCount();
+  for (auto _ : state) {
+    auto result = pooled->DecryptToBuffer(ciphertext.ValueOrDie(),
+                                          kAssociatedData, pool);
+    if (!CheckOk(state, result.status())) return;
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetBytesProcessed(state.iterations() * plaintext.size());
+  ReportAllocationsPerOp(state, allocations);
+}
+
+#define POOLED_AEAD_BENCHMARKS(name, new_aead, key_sizes)   \
+  BENCHMARK_CAPTURE(BM_AeadEncryptToBuffer, name, new_aead) \
+      ->Apply(key_sizes);                                   \
+  BENCHMARK_CAPTURE(BM_AeadDecryptToBuffer, name, new_aead) \
+      ->Apply(key_sizes)
+
+POOLED_AEAD_BENCHMARKS(AesGcm, &subtle::AesGcmBoringSsl::New, AesKeySizes);
+POOLED_AEAD_BENCHMARKS(AesGcmSiv, &subtle::AesGcmSivBoringSsl::New,
+                       AesKeySizes);
+POOLED_AEAD_BENCHMARKS(XChaCha20Poly1305,
+                       &subtle::XChacha20Poly1305BoringSsl::New,
+                       ChaChaKeySizes);
+
+// AES-CTR is only IND-CPA secure, and is benchmarked on its own.
+std::unique_ptr<subtle::IndCpaCipher> NewAesCtrOrSkip(
+    benchmark::State& state) {
+  auto cipher_result = subtle::AesCtrBoringSsl::New(
+      subtle::Random::GetRandomBytes(state.range(1)), 16);
+  if (!CheckOk(state, cipher_result.status())) return nullptr;
+  return std::move(cipher_result.ValueOrDie());
+}
+
+void BM_AesCtrEncrypt(benchmark::State& state) {
+  auto cipher = NewAesCtrOrSkip(state);
+  if (cipher == nullptr) return;
+  std::string plaintext = RandomMessage(state.range(0));
+  int64_t allocations = ThreadAllocationCount();
+  for (auto _ : state) {
+    auto result = cipher->Encrypt(plaintext);
+    if (!CheckOk(state, result.status())) return;
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetBytesProcessed(state.iterations() * plaintext.size());
+  ReportAllocationsPerOp(state, allocations);
+}
+BENCHMARK(BM_AesCtrEncrypt)->Apply(AesKeySizes);
+
+void BM_AesCtrDecrypt(benchmark::State& state) {
+  auto cipher = NewAesCtrOrSkip(state);
+  if (cipher == nullptr) return;
+  std::string plaintext = RandomMessage(state.range(0));
+  auto ciphertext = cipher->Encrypt(plaintext);
+  if (!CheckOk(state, ciphertext.status())) return;
+  int64_t allocations = ThreadAllocationCount();
+  for (auto _ : state) {
+    auto result = cipher->Decrypt(ciphertext.ValueOrDie());
+    if (!CheckOk(state, result.status())) return;
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetBytesProcessed(state.iterations() * plaintext.size());
+  ReportAllocationsPerOp(state, allocations);
+}
+BENCHMARK(BM_AesCtrDecrypt)->Apply(AesKeySizes);
+
+// Encryption of 256 B messages with a TenantKeyAead that caches up to
+// kTenantCacheCapacity instances, cycling through the number of tenants
+// given by the argument: with at most kTenantCacheCapacity tenants, every
+// operation is a cache hit; with many more, nearly every one is a miss.
+constexpr int kTenantCacheCapacity = 1000;
+
+void BM_TenantKeyAeadEncrypt(benchmark::State& state) {
+  // Shared by all the threads, like in a server.
+  static TenantKeyAead* aead = []() -> TenantKeyAead* {
+    TenantKeyAead::Options options;
+    options.cache_capacity = kTenantCacheCapacity;
+    auto aead_result = TenantKeyAead::NewAesGcm(
+        util::SecretDataFromStringView(subtle::Random::GetRandomBytes(32)),
+        options);
+    if (!aead_result.ok()) return nullptr;
+    return aead_result.ValueOrDie().release();
+  }();
+  if (aead == nullptr) {
+    state.SkipWithError("TenantKeyAead::NewAesGcm() failed");
+    return;
+  }
+  std::vector<std::string> tenant_ids;
+  for (int i = 0; i < state.range(0); i++) {
+    tenant_ids.push_back(absl::StrCat("tenant ", i));
+  }
+  std::string plaintext = RandomMessage(256);
+  size_t next_tenant = state.thread_index;
+  for (auto _ : state) {
+    auto result = aead->Encrypt(tenant_ids[next_tenant % tenant_ids.size()],
+                                plaintext, kAssociatedData);
+    if (!CheckOk(state, result.status())) return;
+    benchmark::DoNotOptimize(result);
+    next_tenant++;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TenantKeyAeadEncrypt)
+    ->ArgName("tenants")
+    ->Arg(1)
+    ->Arg(kTenantCacheCapacity)
+    ->Arg(100 * kTenantCacheCapacity)
+    ->Apply(Threads);
+
+}  // namespace
+}  // namespace benchmarks
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,125 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/benchmarks/benchmark_util.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "tink/config/tink_config.h"
+#include "tink/subtle/random.h"
+#include "tink/util/status.h"
+
+namespace {
+
+// Heap allocations made by the current thread, see ThreadAllocationCount().
+// A plain integer, so that it can be used before any constructor has run.
+thread_local int64_t thread_allocation_count = 0;
+
+}  // namespace
+
+// Replacements of the global allocation functions, which only add counting
+// to the default behavior.  The other forms of new and delete call these.
+void* operator new(size_t size) {
+  thread_allocation_count++;
+  void* ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) throw std::bad_alloc();
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void* operator new[](size_t size) { return operator new(size); }
+
+void operator delete[](void* ptr) noexcept { operator delete(ptr); }
+
+namespace crypto {
+namespace tink {
+namespace benchmarks {
+
+namespace {
+
+std::vector<int64_t> MessageSizeList() {
+  std::vector<int64_t> sizes = {kMinMessageSize};
+  for (int64_t size = 16; size <= kMaxMessageSize; size *= 16) {
+    sizes.push_back(size);
+  }
+  return sizes;
+}
+
+}  // namespace
+
+void Threads(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ThreadRange(1, MaxThreads());
+  // With several threads the CPU time of the main thread is meaningless.
+  benchmark->UseRealTime();
+}
+
+void MessageSizes(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgName("bytes");
+  for (int64_t size : MessageSizeList()) {
+    benchmark->Arg(size);
+  }
+  Threads(benchmark);
+}
+
+void MessageAndKeySizes(benchmark::internal::Benchmark* benchmark,
+                        const std::vector<int64_t>& key_sizes) {
+  benchmark->ArgNames({"bytes", "key_size"});
+  for (int64_t key_size : key_sizes) {
+    for (int64_t size : MessageSizeList()) {
+      benchmark->Args({size, key_size});
+    }
+  }
+  Threads(benchmark);
+}
+
+int MaxThreads() {
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+std::string RandomMessage(int64_t size) {
+  return subtle::Random::GetRandomBytes(size);
+}
+
+util::Status RegisterTink() {
+  static const util::Status* status =
+      new util::Status(TinkConfig::Register());
+  return *status;
+}
+
+bool CheckOk(benchmark::State& state, const util::Status& status) {
+  if (status.ok()) return true;
+  state.SkipWithError(status.error_message().c_str());
+  return false;
+}
+
+int64_t ThreadAllocationCount() { return thread_allocation_count; }
+
+void ReportAllocationsPerOp(benchmark::State& state,
+                            int64_t allocations_before) {
+  state.counters["allocs_per_op"] = benchmark::Counter(
+      ThreadAllocationCount() - allocations_before,
+      benchmark::Counter::kAvgIterations);
+}
+
+}  // namespace benchmarks
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,80 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_BENCHMARKS_BENCHMARK_UTIL_H_
+#define TINK_BENCHMARKS_BENCHMARK_UTIL_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "tink/util/status.h"
+
+namespace crypto {
+namespace tink {
+namespace benchmarks {
+
+// Smallest and largest message sizes used by the benchmarks.
+constexpr int64_t kMinMessageSize = 0;
+constexpr int64_t kMaxMessageSize = 16 * 1024 * 1024;
+
+// Sets the thread counts of 'benchmark' to 1, 2, 4, ..., MaxThreads().
+void Threads(benchmark::internal::Benchmark* benchmark);
+
+// Sets the arguments of 'benchmark' to the message sizes 0 B, 16 B, 256 B,
+// ..., 16 MB, i.e. every power of 16 up to kMaxMessageSize, and its thread
+// counts to 1, 2, 4, ..., MaxThreads().
+void MessageSizes(benchmark::internal::Benchmark* benchmark);
+
+// Same as MessageSizes(), but with the key size in bytes as the second
+// argument, taking each value of 'key_sizes'.
+void MessageAndKeySizes(benchmark::internal::Benchmark* benchmark,
+                        const std::vector<int64_t>& key_sizes);
+
+// Returns the number of hardware threads, at least 1.
+int MaxThreads();
+
+// Returns a message of 'size' random bytes.
+std::string RandomMessage(int64_t size);
+
+// Registers all the key types of Tink with the registry, once per process.
+// Returns the status of the registration.
+util::Status RegisterTink();
+
+// Marks 'state' as failed with the message of 'status', if it is not OK.
+// Returns whether 'status' is OK, so that benchmarks can bail out with
+//   if (!CheckOk(state, status)) return;
+bool CheckOk(benchmark::State& state, const util::Status& status);
+
+// Returns the number of heap allocations made by the calling thread so
+// far.  benchmark_util replaces the global operator new to count them, so
+// this covers every binary that links it.
+int64_t ThreadAllocationCount();
+
+// Reports the heap allocations made by the calling thread since
+// 'allocations_before', a value of ThreadAllocationCount() taken before
+// the benchmark loop, as the "allocs_per_op" counter of 'state'.
+// With several threads, the counts of all threads are added up and then
+// divided by the total number of iterations.
+void ReportAllocationsPerOp(benchmark::State& state,
+                            int64_t allocations_before);
+
+}  // namespace benchmarks
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_BENCHMARKS_BENCHMARK_UTIL_H_
@@ -0,0 +1,135 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Benchmarks of AesSivBoringSsl.  The argument of each benchmark is the
+// message size in bytes; AES-SIV only supports 64-byte keys.
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "absl/strings/string_view.h"
+#include "tink/benchmarks/benchmark_util.h"
+#include "tink/deterministic_aead.h"
+#include "tink/subtle/aes_siv_boringssl.h"
+#include "tink/subtle/batch_deterministic_aead.h"
+#include "tink/subtle/random.h"
+
+namespace crypto {
+namespace tink {
+namespace benchmarks {
+namespace {
+
+const char kAssociatedData[] = "associated data";
+
+std::unique_ptr<DeterministicAead> NewAesSivOrSkip(benchmark::State& state) {
+  auto daead_result =
+      subtle::AesSivBoringSsl::New(subtle::Random::GetRandomBytes(64));
+  if (!CheckOk(state, daead_result.status())) return nullptr;
+  return std::move(daead_result.ValueOrDie());
+}
+
+void BM_AesSivEncrypt(benchmark::State& state) {
+  auto daead = NewAesSivOrSkip(state);
+  if (daead == nullptr) return;
+  std::string plaintext = RandomMessage(state.range(0));
+  int64_t allocations = ThreadAllocationCount();
+  for (auto _ : state) {
+    auto result = daead->EncryptDeterministically(plaintext, kAssociatedData);
+    if (!CheckOk(state, result.status())) return;
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetBytesProcessed(state.iterations() * plaintext.size());
+  ReportAllocationsPerOp(state, allocations);
+}
+BENCHMARK(BM_AesSivEncrypt)->Apply(MessageSizes);
+
+void BM_AesSivDecrypt(benchmark::State& state) {
+  auto daead = NewAesSivOrSkip(state);
+  if (daead == nullptr) return;
+  std::string plaintext = RandomMessage(state.range(0));
+  auto ciphertext =
+      daead->EncryptDeterministically(plaintext, kAssociatedData);
+  if (!CheckOk(state, ciphertext.status())) return;
+  int64_t allocations = ThreadAllocationCount();
+  for (auto _ : state) {
+    auto result = daead->DecryptDeterministically(ciphertext.ValueOrDie(),
+                                                  kAssociatedData);
+    if (!CheckOk(state, result.status())) return;
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetBytesProcessed(state.iterations() * plaintext.size());
+  ReportAllocationsPerOp(state, allocations);
+}
+BENCHMARK(BM_AesSivDecrypt)->Apply(MessageSizes);
+
+// Tokenization of a column of kColumnSize values of the size given by the
+// argument, one value at a time with EncryptDeterministically(), or with
+// a single EncryptDeterministicallyBatch().
+constexpr int kColumnSize = 4096;
+
+void ColumnValueSizes(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgName("bytes");
+  for (int size : {8, 16, 32, 64, 256}) benchmark->Arg(size);
+  benchmark->Apply(Threads);
+}
+
+void BM_AesSivEncryptColumn(benchmark::State& state, bool batch) {
+  auto daead = NewAesSivOrSkip(state);
+  if (daead == nullptr) return;
+  auto batch_daead =
+      dynamic_cast<const subtle::BatchDeterministicAead*>(daead.get());
+  if (batch_daead == nullptr) {
+    state.SkipWithError("not a BatchDeterministicAead");
+    return;
+  }
+  int64_t size = state.range(0);
+  std::string values = RandomMessage(size * kColumnSize);
+  std::vector<int64_t> offsets;
+  for (int64_t i = 0; i <= kColumnSize; i++) offsets.push_back(i * size);
+  std::string ciphertexts;
+  std::vector<int64_t> ciphertext_offsets;
+  for (auto _ : state) {
+    if (batch) {
+      auto status = batch_daead->EncryptDeterministicallyBatch(
+          values, offsets, kAssociatedData, &ciphertexts,
+          &ciphertext_offsets);
+      if (!CheckOk(state, status)) return;
+    } else {
+      for (int i = 0; i < kColumnSize; i++) {
+        auto result = daead->EncryptDeterministically(
+            absl::string_view(values).substr(i * size, size),
+            kAssociatedData);
+        if (!CheckOk(state, result.status())) return;
+        benchmark::DoNotOptimize(result);
+      }
+    }
+    benchmark::DoNotOptimize(ciphertexts);
+  }
+  state.SetItemsProcessed(state.iterations() * kColumnSize);
+  state.SetBytesProcessed(state.iterations() * values.size());
+}
+BENCHMARK_CAPTURE(BM_AesSivEncryptColumn, OneByOne, false)
+    ->Apply(ColumnValueSizes);
+BENCHMARK_CAPTURE(BM_AesSivEncryptColumn, Batch, true)
+    ->Apply(ColumnValueSizes);
+
+}  // namespace
+}  // namespace benchmarks
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,191 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Benchmarks of the ECIES-HKDF KEMs in tink/subtle, and of encrypting one
+// message for many recipients.  The KEM benchmarks have no arguments other
+// than the thread count, as the KEMs do not process messages; see
+// keyset_benchmark.cc for complete hybrid encryption.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "tink/benchmarks/benchmark_util.h"
+#include "tink/hybrid/ecies_aead_hkdf_multi_recipient_encrypt.h"
+#include "tink/hybrid/hybrid_key_templates.h"
+#include "tink/hybrid_encrypt.h"
+#include "tink/registry.h"
+#include "tink/subtle/common_enums.h"
+#include "tink/subtle/ecies_hkdf_recipient_kem_boringssl.h"
+#include "tink/subtle/ecies_hkdf_sender_kem_boringssl.h"
+#include "tink/subtle/subtle_util_boringssl.h"
+#include "tink/util/statusor.h"
+#include "proto/ecies_aead_hkdf.pb.h"
+
+namespace crypto {
+namespace tink {
+namespace benchmarks {
+namespace {
+
+using google::crypto::tink::EciesAeadHkdfKeyFormat;
+using google::crypto::tink::EciesAeadHkdfPublicKey;
+using subtle::EcPointFormat;
+using subtle::EllipticCurveType;
+using subtle::HashType;
+using subtle::SubtleUtilBoringSSL;
+
+const char kHkdfSalt[] = "salt";
+const char kHkdfInfo[] = "info";
+const int kSymmetricKeySize = 32;
+
+void BM_EciesSenderKem(benchmark::State& state, EllipticCurveType curve) {
+  auto key_result = SubtleUtilBoringSSL::GetNewEcKey(curve);
+  if (!CheckOk(state, key_result.status())) return;
+  const auto& key = key_result.ValueOrDie();
+  auto kem_result =
+      subtle::EciesHkdfSenderKemBoringSsl::New(curve, key.pub_x, key.pub_y);
+  if (!CheckOk(state, kem_result.status())) return;
+  const auto& kem = kem_result.ValueOrDie();
+  for (auto _ : state) {
+    auto result = kem->GenerateKey(HashType::SHA256, kHkdfSalt, kHkdfInfo,
+                                   kSymmetricKeySize,
+                                   EcPointFormat::UNCOMPRESSED);
+    if (!CheckOk(state, result.status())) return;
+    benchmark::DoNotOptimize(result);
+  }
+}
+BENCHMARK_CAPTURE(BM_EciesSenderKem, P256, EllipticCurveType::NIST_P256)
+    ->Apply(Threads);
+BENCHMARK_CAPTURE(BM_EciesSenderKem, P384, EllipticCurveType::NIST_P384)
+    ->Apply(Threads);
+BENCHMARK_CAPTURE(BM_EciesSenderKem, P521, EllipticCurveType::NIST_P521)
+    ->Apply(Threads);
+
+void BM_EciesRecipientKem(benchmark::State& state, EllipticCurveType curve) {
+  auto key_result = SubtleUtilBoringSSL::GetNewEcKey(curve);
+  if (!CheckOk(state, key_result.status())) return;
+  const auto& key = key_result.ValueOrDie();
+  auto sender_result =
+      subtle::EciesHkdfSenderKemBoringSsl::New(curve, key.pub_x, key.pub_y);
+  if (!CheckOk(state, sender_result.status())) return;
+  auto kem_key = sender_result.ValueOrDie()->GenerateKey(
+      HashType::SHA256, kHkdfSalt, kHkdfInfo, kSymmetricKeySize,
+      EcPointFormat::UNCOMPRESSED);
+  if (!CheckOk(state, kem_key.status())) return;
+  std::string kem_bytes = kem_key.ValueOrDie()->get_kem_bytes();
+  auto recipient_result =
+      subtle::EciesHkdfRecipientKemBoringSsl::New(curve, key.priv);
+  if (!CheckOk(state, recipient_result.status())) return;
+  const auto& recipient = recipient_result.ValueOrDie();
+  for (auto _ : state) {
+    auto result = recipient->GenerateKey(kem_bytes, HashType::SHA256,
+                                         kHkdfSalt, kHkdfInfo,
+                                         kSymmetricKeySize,
+                                         EcPointFormat::UNCOMPRESSED);
+    if (!CheckOk(state, result.status())) return;
+    benchmark::DoNotOptimize(result);
+  }
+}
+BENCHMARK_CAPTURE(BM_EciesRecipientKem, P256, EllipticCurveType::NIST_P256)
+    ->Apply(Threads);
+BENCHMARK_CAPTURE(BM_EciesRecipientKem, P384, EllipticCurveType::NIST_P384)
+    ->Apply(Threads);
+BENCHMARK_CAPTURE(BM_EciesRecipientKem, P521, EllipticCurveType::NIST_P521)
+    ->Apply(Threads);
+
+// Encrypts one message for several recipients, either with a HybridEncrypt
+// per recipient, which encrypts the message once for each of them, or with
+// EciesAeadHkdfMultiRecipientEncrypt, which encrypts it only once.
+enum class FanOut { kPerRecipient, kMultiRecipient };
+
+const char kContextInfo[] = "context info";
+
+// Returns the public key of a new P-256 key pair, with an AES-128-GCM DEM.
+util::StatusOr<EciesAeadHkdfPublicKey> NewRecipientKey() {
+  EciesAeadHkdfKeyFormat key_format;
+  if (!key_format.ParseFromString(
+          HybridKeyTemplates::EciesP256HkdfHmacSha256Aes128Gcm().value())) {
+    return util::Status(util::error::INTERNAL, "invalid key template");
+  }
+  auto ec_key_result =
+      SubtleUtilBoringSSL::GetNewEcKey(EllipticCurveType::NIST_P256);
+  if (!ec_key_result.ok()) return ec_key_result.status();
+  EciesAeadHkdfPublicKey key;
+  key.set_x(ec_key_result.ValueOrDie().pub_x);
+  key.set_y(ec_key_result.ValueOrDie().pub_y);
+  *key.mutable_params() = key_format.params();
+  return key;
+}
+
+void BM_FanOutEncrypt(benchmark::State& state, FanOut fan_out) {
+  if (!CheckOk(state, RegisterTink())) return;
+  std::vector<EciesAeadHkdfPublicKey> keys;
+  for (int i = 0; i < state.range(0); i++) {
+    auto key_result = NewRecipientKey();
+    if (!CheckOk(state, key_result.status())) return;
+    keys.push_back(key_result.ValueOrDie());
+  }
+  std::string plaintext = RandomMessage(state.range(1));
+
+  if (fan_out == FanOut::kPerRecipient) {
+    std::vector<std::unique_ptr<HybridEncrypt>> hybrid_encrypts;
+    for (const auto& key : keys) {
+      auto result = Registry::GetPrimitive<HybridEncrypt>(
+          "type.googleapis.com/google.crypto.tink.EciesAeadHkdfPublicKey",
+          key);
+      if (!CheckOk(state, result.status())) return;
+      hybrid_encrypts.push_back(std::move(result.ValueOrDie()));
+    }
+    for (auto _ : state) {
+      for (const auto& hybrid_encrypt : hybrid_encrypts) {
+        auto result = hybrid_encrypt->Encrypt(plaintext, kContextInfo);
+        if (!CheckOk(state, result.status())) return;
+        benchmark::DoNotOptimize(result);
+      }
+    }
+  } else {
+    auto encrypt_result = EciesAeadHkdfMultiRecipientEncrypt::New(keys);
+    if (!CheckOk(state, encrypt_result.status())) return;
+    const auto& multi_recipient_encrypt = encrypt_result.ValueOrDie();
+    for (auto _ : state) {
+      auto result = multi_recipient_encrypt->Encrypt(plaintext, kContextInfo);
+      if (!CheckOk(state, result.status())) return;
+      benchmark::DoNotOptimize(result);
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * plaintext.size());
+}
+
+void FanOutSizes(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"recipients", "bytes"});
+  for (int recipients : {1, 10, 50}) {
+    for (int bytes : {1024, 1024 * 1024}) {
+      benchmark->Args({recipients, bytes});
+    }
+  }
+  Threads(benchmark);
+}
+BENCHMARK_CAPTURE(BM_FanOutEncrypt, PerRecipient, FanOut::kPerRecipient)
+    ->Apply(FanOutSizes);
+BENCHMARK_CAPTURE(BM_FanOutEncrypt, MultiRecipient, FanOut::kMultiRecipient)
+    ->Apply(FanOutSizes);
+
+}  // namespace
+}  // namespace benchmarks
+}  // namespace tink
+}  // namespace crypto
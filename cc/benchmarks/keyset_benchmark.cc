@@ -0,0 +1,268 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Benchmarks of the keyset-level API: KeysetHandle::GetPrimitive() and the
+// primitives returned by the wrappers, for keysets of 1, 10 and 1000 keys.
+
+#include <memory>
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "tink/aead.h"
+#include "tink/aead/aead_key_templates.h"
+#include "tink/benchmarks/benchmark_util.h"
+#include "tink/hybrid/hybrid_key_templates.h"
+#include "tink/hybrid_decrypt.h"
+#include "tink/hybrid_encrypt.h"
+#include "tink/keyset_handle.h"
+#include "tink/keyset_manager.h"
+#include "tink/mac.h"
+#include "tink/mac/mac_key_templates.h"
+#include "tink/registry.h"
+#include "tink/util/keyset_util.h"
+#include "tink/util/status.h"
+#include "proto/tink.pb.h"
+
+namespace crypto {
+namespace tink {
+namespace benchmarks {
+namespace {
+
+using google::crypto::tink::KeyTemplate;
+using google::crypto::tink::OutputPrefixType;
+
+const char kAssociatedData[] = "associated data";
+
+// The first argument of the wrapper benchmarks is the number of keys in
+// the keyset, the second one the message size in bytes.
+void KeysetSizes(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"keys", "bytes"});
+  for (int keys : {1, 10, 1000}) {
+    for (int bytes : {64, 16 * 1024}) {
+      benchmark->Args({keys, bytes});
+    }
+  }
+  Threads(benchmark);
+}
+
+KeyTemplate WithOutputPrefixType(const KeyTemplate& key_template,
+                                 OutputPrefixType output_prefix_type) {
+  KeyTemplate result = key_template;
+  result.set_output_prefix_type(output_prefix_type);
+  return result;
+}
+
+// Creates a keyset of 'num_keys' keys generated from 'key_template'.
+// The primary is the last key, which is also the last one tried when
+// decrypting RAW ciphertexts.
+util::Status NewKeyset(const KeyTemplate& key_template, int num_keys,
+                       std::unique_ptr<KeysetHandle>* keyset_handle) {
+  auto status = RegisterTink();
+  if (!status.ok()) return status;
+  KeysetManager manager;
+  for (int i = 0; i < num_keys; i++) {
+    auto rotate_result = manager.Rotate(key_template);
+    if (!rotate_result.ok()) return rotate_result.status();
+  }
+  *keyset_handle = manager.GetKeysetHandle();
+  return util::OkStatus();
+}
+
+template <class P>
+void GetPrimitive(benchmark::State& state, const KeyTemplate& key_template) {
+  std::unique_ptr<KeysetHandle> keyset_handle;
+  if (!CheckOk(state, NewKeyset(key_template, state.range(0),
+                                &keyset_handle))) {
+    return;
+  }
+  for (auto _ : state) {
+    auto result = keyset_handle->GetPrimitive<P>();
+    if (!CheckOk(state, result.status())) return;
+    benchmark::DoNotOptimize(result);
+  }
+}
+
+void BM_GetAeadPrimitive(benchmark::State& state) {
+  GetPrimitive<Aead>(state, AeadKeyTemplates::Aes128Gcm());
+}
+BENCHMARK(BM_GetAeadPrimitive)->ArgName("keys")->Arg(1)->Arg(10)->Arg(1000);
+
+void BM_GetMacPrimitive(benchmark::State& state) {
+  GetPrimitive<Mac>(state, MacKeyTemplates::HmacSha256());
+}
+BENCHMARK(BM_GetMacPrimitive)->ArgName("keys")->Arg(1)->Arg(10)->Arg(1000);
+
+std::unique_ptr<Aead> NewWrappedAeadOrSkip(
+    benchmark::State& state, OutputPrefixType output_prefix_type) {
+  std::unique_ptr<KeysetHandle> keyset_handle;
+  auto key_template = WithOutputPrefixType(AeadKeyTemplates::Aes128Gcm(),
+                                           output_prefix_type);
+  if (!CheckOk(state, NewKeyset(key_template, state.range(0),
+                                &keyset_handle))) {
+    return nullptr;
+  }
+  auto aead_result = keyset_handle->GetPrimitive<Aead>();
+  if (!CheckOk(state, aead_result.status())) return nullptr;
+  return std::move(aead_result.ValueOrDie());
+}
+
+void BM_WrappedAeadEncrypt(benchmark::State& state) {
+  auto aead = NewWrappedAeadOrSkip(state, OutputPrefixType::TINK);
+  if (aead == nullptr) return;
+  std::string plaintext = RandomMessage(state.range(1));
+  for (auto _ : state) {
+    auto result = aead->Encrypt(plaintext, kAssociatedData);
+    if (!CheckOk(state, result.status())) return;
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetBytesProcessed(state.iterations() * plaintext.size());
+}
+BENCHMARK(BM_WrappedAeadEncrypt)->Apply(KeysetSizes);
+
+// Decrypts ciphertexts of the primary, with TINK keys for the prefix lookup
+// and with RAW keys for the trial decryption with every key of the keyset.
+void BM_WrappedAeadDecrypt(benchmark::State& state,
+                           OutputPrefixType output_prefix_type) {
+  auto aead = NewWrappedAeadOrSkip(state, output_prefix_type);
+  if (aead == nullptr) return;
+  std::string plaintext = RandomMessage(state.range(1));
+  auto ciphertext = aead->Encrypt(plaintext, kAssociatedData);
+  if (!CheckOk(state, ciphertext.status())) return;
+  for (auto _ : state) {
+    auto result = aead->Decrypt(ciphertext.ValueOrDie(), kAssociatedData);
+    if (!CheckOk(state, result.status())) return;
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetBytesProcessed(state.iterations() * plaintext.size());
+}
+BENCHMARK_CAPTURE(BM_WrappedAeadDecrypt, Tink, OutputPrefixType::TINK)
+    ->Apply(KeysetSizes);
+BENCHMARK_CAPTURE(BM_WrappedAeadDecrypt, Raw, OutputPrefixType::RAW)
+    ->Apply(KeysetSizes);
+
+// Rejects ciphertexts that no key of the keyset can decrypt: with RAW keys
+// every key is tried, and each failed trial returns an error status.
+void BM_WrappedAeadDecryptInvalid(benchmark::State& state,
+                                  OutputPrefixType output_prefix_type) {
+  auto aead = NewWrappedAeadOrSkip(state, output_prefix_type);
+  if (aead == nullptr) return;
+  auto ciphertext =
+      aead->Encrypt(RandomMessage(state.range(1)), kAssociatedData);
+  if (!CheckOk(state, ciphertext.status())) return;
+  std::string invalid = ciphertext.ValueOrDie();
+  invalid.back() ^= 1;
+  int64_t allocations = ThreadAllocationCount();
+  for (auto _ : state) {
+    auto result = aead->Decrypt(invalid, kAssociatedData);
+    if (result.ok()) {
+      state.SkipWithError("invalid ciphertext was accepted");
+      return;
+    }
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetItemsProcessed(state.iterations());
+  ReportAllocationsPerOp(state, allocations);
+}
+BENCHMARK_CAPTURE(BM_WrappedAeadDecryptInvalid, Tink, OutputPrefixType::TINK)
+    ->Apply(KeysetSizes);
+BENCHMARK_CAPTURE(BM_WrappedAeadDecryptInvalid, Raw, OutputPrefixType::RAW)
+    ->Apply(KeysetSizes);
+
+// The cost of the keyset layer on small messages: encrypts 64 bytes with
+// the AES-GCM primitive of a single TINK key unwrapped, wrapped as a
+// single-key keyset, and wrapped as the primary of a two-key keyset (which
+// does not get the single-key wrapper).
+enum class AeadWrapping { kUnwrapped, kSingleKey, kTwoKeys };
+
+void BM_AeadWrapperOverhead(benchmark::State& state, AeadWrapping wrapping) {
+  std::unique_ptr<KeysetHandle> keyset_handle;
+  int num_keys = wrapping == AeadWrapping::kTwoKeys ? 2 : 1;
+  if (!CheckOk(state, NewKeyset(AeadKeyTemplates::Aes128Gcm(), num_keys,
+                                &keyset_handle))) {
+    return;
+  }
+  auto aead_result =
+      wrapping == AeadWrapping::kUnwrapped
+          ? Registry::GetPrimitive<Aead>(
+                KeysetUtil::GetKeyset(*keyset_handle).key(0).key_data())
+          : keyset_handle->GetPrimitive<Aead>();
+  if (!CheckOk(state, aead_result.status())) return;
+  const auto& aead = aead_result.ValueOrDie();
+  std::string plaintext = RandomMessage(64);
+  for (auto _ : state) {
+    auto result = aead->Encrypt(plaintext, kAssociatedData);
+    if (!CheckOk(state, result.status())) return;
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetBytesProcessed(state.iterations() * plaintext.size());
+}
+BENCHMARK_CAPTURE(BM_AeadWrapperOverhead, Unwrapped, AeadWrapping::kUnwrapped);
+BENCHMARK_CAPTURE(BM_AeadWrapperOverhead, SingleKey, AeadWrapping::kSingleKey);
+BENCHMARK_CAPTURE(BM_AeadWrapperOverhead, TwoKeys, AeadWrapping::kTwoKeys);
+
+void BM_WrappedMacVerify(benchmark::State& state) {
+  std::unique_ptr<KeysetHandle> keyset_handle;
+  if (!CheckOk(state, NewKeyset(MacKeyTemplates::HmacSha256(), state.range(0),
+                                &keyset_handle))) {
+    return;
+  }
+  auto mac_result = keyset_handle->GetPrimitive<Mac>();
+  if (!CheckOk(state, mac_result.status())) return;
+  const auto& mac = mac_result.ValueOrDie();
+  std::string data = RandomMessage(state.range(1));
+  auto tag = mac->ComputeMac(data);
+  if (!CheckOk(state, tag.status())) return;
+  for (auto _ : state) {
+    if (!CheckOk(state, mac->VerifyMac(tag.ValueOrDie(), data))) return;
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_WrappedMacVerify)->Apply(KeysetSizes);
+
+// Hybrid encryption with a single ECIES P-256 key, as hybrid encryption
+// always uses the primary.
+void BM_HybridEncryptDecrypt(benchmark::State& state) {
+  std::unique_ptr<KeysetHandle> private_keyset_handle;
+  const KeyTemplate& key_template =
+      HybridKeyTemplates::EciesP256HkdfHmacSha256Aes128Gcm();
+  if (!CheckOk(state, NewKeyset(key_template, 1, &private_keyset_handle))) {
+    return;
+  }
+  auto public_keyset_handle = private_keyset_handle->GetPublicKeysetHandle();
+  if (!CheckOk(state, public_keyset_handle.status())) return;
+  auto encrypt_result =
+      public_keyset_handle.ValueOrDie()->GetPrimitive<HybridEncrypt>();
+  if (!CheckOk(state, encrypt_result.status())) return;
+  auto decrypt_result = private_keyset_handle->GetPrimitive<HybridDecrypt>();
+  if (!CheckOk(state, decrypt_result.status())) return;
+  std::string plaintext = RandomMessage(state.range(0));
+  for (auto _ : state) {
+    auto ciphertext =
+        encrypt_result.ValueOrDie()->Encrypt(plaintext, kAssociatedData);
+    if (!CheckOk(state, ciphertext.status())) return;
+    auto result = decrypt_result.ValueOrDie()->Decrypt(
+        ciphertext.ValueOrDie(), kAssociatedData);
+    if (!CheckOk(state, result.status())) return;
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetBytesProcessed(state.iterations() * plaintext.size());
+}
+BENCHMARK(BM_HybridEncryptDecrypt)->Apply(MessageSizes);
+
+}  // namespace
+}  // namespace benchmarks
+}  // namespace tink
+}  // namespace crypto
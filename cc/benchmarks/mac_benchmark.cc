@@ -0,0 +1,92 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Benchmarks of HmacBoringSsl.  The arguments of each benchmark are the
+// message size in bytes and the key size in bytes.
+
+#include <memory>
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "tink/benchmarks/benchmark_util.h"
+#include "tink/mac.h"
+#include "tink/subtle/common_enums.h"
+#include "tink/subtle/hmac_boringssl.h"
+#include "tink/subtle/random.h"
+
+namespace crypto {
+namespace tink {
+namespace benchmarks {
+namespace {
+
+using subtle::HashType;
+
+void HmacKeySizes(benchmark::internal::Benchmark* benchmark) {
+  MessageAndKeySizes(benchmark, {16, 32, 64});
+}
+
+// Creates a new HMAC with a full-size tag and a random key of the size
+// given by the second argument of 'state'.
+std::unique_ptr<Mac> NewHmacOrSkip(benchmark::State& state,
+                                   HashType hash_type, uint32_t tag_size) {
+  auto mac_result = subtle::HmacBoringSsl::New(
+      hash_type, tag_size, subtle::Random::GetRandomBytes(state.range(1)));
+  if (!CheckOk(state, mac_result.status())) return nullptr;
+  return std::move(mac_result.ValueOrDie());
+}
+
+void BM_HmacCompute(benchmark::State& state, HashType hash_type,
+                    uint32_t tag_size) {
+  auto mac = NewHmacOrSkip(state, hash_type, tag_size);
+  if (mac == nullptr) return;
+  std::string data = RandomMessage(state.range(0));
+  for (auto _ : state) {
+    auto result = mac->ComputeMac(data);
+    if (!CheckOk(state, result.status())) return;
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK_CAPTURE(BM_HmacCompute, Sha1, HashType::SHA1, 20)
+    ->Apply(HmacKeySizes);
+BENCHMARK_CAPTURE(BM_HmacCompute, Sha256, HashType::SHA256, 32)
+    ->Apply(HmacKeySizes);
+BENCHMARK_CAPTURE(BM_HmacCompute, Sha512, HashType::SHA512, 64)
+    ->Apply(HmacKeySizes);
+
+void BM_HmacVerify(benchmark::State& state, HashType hash_type,
+                   uint32_t tag_size) {
+  auto mac = NewHmacOrSkip(state, hash_type, tag_size);
+  if (mac == nullptr) return;
+  std::string data = RandomMessage(state.range(0));
+  auto tag = mac->ComputeMac(data);
+  if (!CheckOk(state, tag.status())) return;
+  for (auto _ : state) {
+    if (!CheckOk(state, mac->VerifyMac(tag.ValueOrDie(), data))) return;
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK_CAPTURE(BM_HmacVerify, Sha1, HashType::SHA1, 20)
+    ->Apply(HmacKeySizes);
+BENCHMARK_CAPTURE(BM_HmacVerify, Sha256, HashType::SHA256, 32)
+    ->Apply(HmacKeySizes);
+BENCHMARK_CAPTURE(BM_HmacVerify, Sha512, HashType::SHA512, 64)
+    ->Apply(HmacKeySizes);
+
+}  // namespace
+}  // namespace benchmarks
+}  // namespace tink
+}  // namespace crypto
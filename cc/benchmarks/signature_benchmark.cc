@@ -0,0 +1,224 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Benchmarks of the digital signature primitives in tink/subtle.
+// The first argument of each benchmark is the message size in bytes;
+// the RSA benchmarks take the modulus size in bits as second argument.
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "absl/synchronization/mutex.h"
+#include "openssl/bn.h"
+#include "openssl/rsa.h"
+#include "tink/benchmarks/benchmark_util.h"
+#include "tink/public_key_sign.h"
+#include "tink/public_key_verify.h"
+#include "tink/subtle/common_enums.h"
+#include "tink/subtle/ecdsa_sign_boringssl.h"
+#include "tink/subtle/ecdsa_verify_boringssl.h"
+#include "tink/subtle/ed25519_sign_boringssl.h"
+#include "tink/subtle/ed25519_verify_boringssl.h"
+#include "tink/subtle/rsa_ssa_pkcs1_sign_boringssl.h"
+#include "tink/subtle/rsa_ssa_pkcs1_verify_boringssl.h"
+#include "tink/subtle/rsa_ssa_pss_sign_boringssl.h"
+#include "tink/subtle/rsa_ssa_pss_verify_boringssl.h"
+#include "tink/subtle/subtle_util_boringssl.h"
+#include "tink/util/status.h"
+
+namespace crypto {
+namespace tink {
+namespace benchmarks {
+namespace {
+
+using subtle::EcdsaSignatureEncoding;
+using subtle::EllipticCurveType;
+using subtle::HashType;
+using subtle::SubtleUtilBoringSSL;
+
+// A signer and a verifier for the same key pair.
+struct SignaturePair {
+  std::unique_ptr<PublicKeySign> signer;
+  std::unique_ptr<PublicKeyVerify> verifier;
+};
+
+// Creates a SignaturePair for the arguments of 'state'.
+using NewSignaturePairFunction = util::Status (*)(
+    const benchmark::State& state, SignaturePair* pair);
+
+util::Status NewEcdsa(EllipticCurveType curve, HashType hash_type,
+                      EcdsaSignatureEncoding encoding, SignaturePair* pair) {
+  auto key_result = SubtleUtilBoringSSL::GetNewEcKey(curve);
+  if (!key_result.ok()) return key_result.status();
+  const auto& key = key_result.ValueOrDie();
+  auto signer_result = subtle::EcdsaSignBoringSsl::New(key, hash_type,
+                                                       encoding);
+  if (!signer_result.ok()) return signer_result.status();
+  auto verifier_result = subtle::EcdsaVerifyBoringSsl::New(key, hash_type,
+                                                           encoding);
+  if (!verifier_result.ok()) return verifier_result.status();
+  pair->signer = std::move(signer_result.ValueOrDie());
+  pair->verifier = std::move(verifier_result.ValueOrDie());
+  return util::OkStatus();
+}
+
+util::Status NewEcdsaP256(const benchmark::State& state, SignaturePair* pair) {
+  return NewEcdsa(EllipticCurveType::NIST_P256, HashType::SHA256,
+                  EcdsaSignatureEncoding::DER, pair);
+}
+
+util::Status NewEcdsaP256Ieee(const benchmark::State& state,
+                              SignaturePair* pair) {
+  return NewEcdsa(EllipticCurveType::NIST_P256, HashType::SHA256,
+                  EcdsaSignatureEncoding::IEEE_P1363, pair);
+}
+
+util::Status NewEcdsaP384(const benchmark::State& state, SignaturePair* pair) {
+  return NewEcdsa(EllipticCurveType::NIST_P384, HashType::SHA512,
+                  EcdsaSignatureEncoding::DER, pair);
+}
+
+util::Status NewEcdsaP521(const benchmark::State& state, SignaturePair* pair) {
+  return NewEcdsa(EllipticCurveType::NIST_P521, HashType::SHA512,
+                  EcdsaSignatureEncoding::DER, pair);
+}
+
+util::Status NewEd25519(const benchmark::State& state, SignaturePair* pair) {
+  auto key = SubtleUtilBoringSSL::GetNewEd25519Key();
+  auto signer_result =
+      subtle::Ed25519SignBoringSsl::New(key->private_key + key->public_key);
+  if (!signer_result.ok()) return signer_result.status();
+  auto verifier_result = subtle::Ed25519VerifyBoringSsl::New(key->public_key);
+  if (!verifier_result.ok()) return verifier_result.status();
+  pair->signer = std::move(signer_result.ValueOrDie());
+  pair->verifier = std::move(verifier_result.ValueOrDie());
+  return util::OkStatus();
+}
+
+struct RsaKeyPair {
+  SubtleUtilBoringSSL::RsaPrivateKey private_key;
+  SubtleUtilBoringSSL::RsaPublicKey public_key;
+};
+
+// Returns an RSA key pair with a modulus of 'modulus_size_in_bits' and
+// public exponent F4.  RSA key generation takes long enough to distort the
+// benchmark runs, so the key pairs are generated once per process.
+util::Status GetRsaKeyPair(int modulus_size_in_bits, RsaKeyPair* key_pair) {
+  static absl::Mutex* mutex = new absl::Mutex();
+  static std::map<int, RsaKeyPair>* key_pairs =
+      new std::map<int, RsaKeyPair>();
+  absl::MutexLock lock(mutex);
+  auto found = key_pairs->find(modulus_size_in_bits);
+  if (found == key_pairs->end()) {
+    bssl::UniquePtr<BIGNUM> e(BN_new());
+    BN_set_word(e.get(), RSA_F4);
+    RsaKeyPair new_key_pair;
+    auto status = SubtleUtilBoringSSL::GetNewRsaKeyPair(
+        modulus_size_in_bits, e.get(), &new_key_pair.private_key,
+        &new_key_pair.public_key);
+    if (!status.ok()) return status;
+    found = key_pairs->emplace(modulus_size_in_bits, new_key_pair).first;
+  }
+  *key_pair = found->second;
+  return util::OkStatus();
+}
+
+util::Status NewRsaSsaPss(const benchmark::State& state, SignaturePair* pair) {
+  RsaKeyPair key_pair;
+  auto status = GetRsaKeyPair(state.range(1), &key_pair);
+  if (!status.ok()) return status;
+  SubtleUtilBoringSSL::RsaSsaPssParams params;
+  params.sig_hash = HashType::SHA256;
+  params.mgf1_hash = HashType::SHA256;
+  params.salt_length = 32;
+  auto signer_result =
+      subtle::RsaSsaPssSignBoringSsl::New(key_pair.private_key, params);
+  if (!signer_result.ok()) return signer_result.status();
+  auto verifier_result =
+      subtle::RsaSsaPssVerifyBoringSsl::New(key_pair.public_key, params);
+  if (!verifier_result.ok()) return verifier_result.status();
+  pair->signer = std::move(signer_result.ValueOrDie());
+  pair->verifier = std::move(verifier_result.ValueOrDie());
+  return util::OkStatus();
+}
+
+util::Status NewRsaSsaPkcs1(const benchmark::State& state,
+                            SignaturePair* pair) {
+  RsaKeyPair key_pair;
+  auto status = GetRsaKeyPair(state.range(1), &key_pair);
+  if (!status.ok()) return status;
+  SubtleUtilBoringSSL::RsaSsaPkcs1Params params;
+  params.hash_type = HashType::SHA256;
+  auto signer_result =
+      subtle::RsaSsaPkcs1SignBoringSsl::New(key_pair.private_key, params);
+  if (!signer_result.ok()) return signer_result.status();
+  auto verifier_result =
+      subtle::RsaSsaPkcs1VerifyBoringSsl::New(key_pair.public_key, params);
+  if (!verifier_result.ok()) return verifier_result.status();
+  pair->signer = std::move(signer_result.ValueOrDie());
+  pair->verifier = std::move(verifier_result.ValueOrDie());
+  return util::OkStatus();
+}
+
+void RsaModulusSizes(benchmark::internal::Benchmark* benchmark) {
+  MessageAndKeySizes(benchmark, {2048, 3072, 4096});
+  benchmark->ArgNames({"bytes", "modulus_bits"});
+}
+
+void BM_Sign(benchmark::State& state, NewSignaturePairFunction new_pair) {
+  SignaturePair pair;
+  if (!CheckOk(state, new_pair(state, &pair))) return;
+  std::string data = RandomMessage(state.range(0));
+  for (auto _ : state) {
+    auto result = pair.signer->Sign(data);
+    if (!CheckOk(state, result.status())) return;
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+void BM_Verify(benchmark::State& state, NewSignaturePairFunction new_pair) {
+  SignaturePair pair;
+  if (!CheckOk(state, new_pair(state, &pair))) return;
+  std::string data = RandomMessage(state.range(0));
+  auto signature = pair.signer->Sign(data);
+  if (!CheckOk(state, signature.status())) return;
+  for (auto _ : state) {
+    if (!CheckOk(state, pair.verifier->Verify(signature.ValueOrDie(), data))) {
+      return;
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+#define SIGNATURE_BENCHMARKS(name, new_pair, arguments)              \
+  BENCHMARK_CAPTURE(BM_Sign, name, new_pair)->Apply(arguments);      \
+  BENCHMARK_CAPTURE(BM_Verify, name, new_pair)->Apply(arguments)
+
+SIGNATURE_BENCHMARKS(EcdsaP256, &NewEcdsaP256, MessageSizes);
+SIGNATURE_BENCHMARKS(EcdsaP256Ieee, &NewEcdsaP256Ieee, MessageSizes);
+SIGNATURE_BENCHMARKS(EcdsaP384, &NewEcdsaP384, MessageSizes);
+SIGNATURE_BENCHMARKS(EcdsaP521, &NewEcdsaP521, MessageSizes);
+SIGNATURE_BENCHMARKS(Ed25519, &NewEd25519, MessageSizes);
+SIGNATURE_BENCHMARKS(RsaSsaPss, &NewRsaSsaPss, RsaModulusSizes);
+SIGNATURE_BENCHMARKS(RsaSsaPkcs1, &NewRsaSsaPkcs1, RsaModulusSizes);
+
+}  // namespace
+}  // namespace benchmarks
+}  // namespace tink
+}  // namespace crypto
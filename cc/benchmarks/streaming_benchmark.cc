@@ -0,0 +1,175 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Benchmarks of StreamingAeadEncryptingStream.  The arguments of each
+// benchmark are the message size in bytes and the plaintext segment size.
+//
+// The segments are encrypted with AES-GCM by a local StreamSegmentEncrypter,
+// and written to an OutputStream that discards them, so that the benchmark
+// measures the cost of the encryption and of the stream itself.
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/string_view.h"
+#include "tink/aead.h"
+#include "tink/benchmarks/benchmark_util.h"
+#include "tink/output_stream.h"
+#include "tink/subtle/aes_gcm_boringssl.h"
+#include "tink/subtle/random.h"
+#include "tink/subtle/stream_segment_encrypter.h"
+#include "tink/subtle/streaming_aead_encrypting_stream.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+namespace benchmarks {
+namespace {
+
+// Size of the AES-GCM nonce and tag added to each segment.
+const int kSegmentOverhead = 12 + 16;
+const int kHeaderSize = 16;
+
+// Encrypts each segment with AES-GCM, binding the segment number and the
+// last segment flag as associated data.
+class AesGcmSegmentEncrypter : public subtle::StreamSegmentEncrypter {
+ public:
+  AesGcmSegmentEncrypter(std::unique_ptr<Aead> aead, int plaintext_segment_size)
+      : aead_(std::move(aead)),
+        plaintext_segment_size_(plaintext_segment_size),
+        segment_number_(0) {
+    std::string header = subtle::Random::GetRandomBytes(kHeaderSize);
+    header_.assign(header.begin(), header.end());
+  }
+
+  util::Status EncryptSegment(
+      const std::vector<uint8_t>& plaintext, bool is_last_segment,
+      std::vector<uint8_t>* ciphertext_buffer) override {
+    std::string associated_data(reinterpret_cast<const char*>(&segment_number_),
+                                sizeof(segment_number_));
+    associated_data.push_back(is_last_segment ? 1 : 0);
+    auto ciphertext = aead_->Encrypt(
+        absl::string_view(reinterpret_cast<const char*>(plaintext.data()),
+                          plaintext.size()),
+        associated_data);
+    if (!ciphertext.ok()) return ciphertext.status();
+    ciphertext_buffer->assign(ciphertext.ValueOrDie().begin(),
+                              ciphertext.ValueOrDie().end());
+    IncSegmentNumber();
+    return util::OkStatus();
+  }
+
+  const std::vector<uint8_t>& get_header() const override { return header_; }
+
+  int64_t get_segment_number() const override { return segment_number_; }
+
+  int get_plaintext_segment_size() const override {
+    return plaintext_segment_size_;
+  }
+
+  int get_ciphertext_segment_size() const override {
+    return plaintext_segment_size_ + kSegmentOverhead;
+  }
+
+  int get_ciphertext_offset() const override { return kHeaderSize; }
+
+ protected:
+  void IncSegmentNumber() override { segment_number_++; }
+
+ private:
+  std::unique_ptr<Aead> aead_;
+  std::vector<uint8_t> header_;
+  int plaintext_segment_size_;
+  int64_t segment_number_;
+};
+
+// An OutputStream that discards everything written to it.
+class NullOutputStream : public OutputStream {
+ public:
+  NullOutputStream() : buffer_(64 * 1024), position_(0) {}
+
+  util::StatusOr<int> Next(void** data) override {
+    *data = buffer_.data();
+    position_ += buffer_.size();
+    return static_cast<int>(buffer_.size());
+  }
+
+  void BackUp(int count) override { position_ -= count; }
+
+  util::Status Close() override { return util::OkStatus(); }
+
+  int64_t Position() const override { return position_; }
+
+ private:
+  std::vector<uint8_t> buffer_;
+  int64_t position_;
+};
+
+void SegmentSizes(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"bytes", "segment_size"});
+  for (int64_t segment_size : {4 * 1024, 1024 * 1024}) {
+    benchmark->Args({0, segment_size});
+    for (int64_t size = 16; size <= kMaxMessageSize; size *= 16) {
+      benchmark->Args({size, segment_size});
+    }
+  }
+  Threads(benchmark);
+}
+
+// Writes 'plaintext' to 'stream' and closes it.
+util::Status WriteAndClose(absl::string_view plaintext, OutputStream* stream) {
+  while (!plaintext.empty()) {
+    void* buffer;
+    auto next_result = stream->Next(&buffer);
+    if (!next_result.ok()) return next_result.status();
+    int count = std::min<int64_t>(next_result.ValueOrDie(), plaintext.size());
+    std::memcpy(buffer, plaintext.data(), count);
+    stream->BackUp(next_result.ValueOrDie() - count);
+    plaintext.remove_prefix(count);
+  }
+  return stream->Close();
+}
+
+void BM_StreamingEncrypt(benchmark::State& state) {
+  std::string key = subtle::Random::GetRandomBytes(16);
+  std::string plaintext = RandomMessage(state.range(0));
+  for (auto _ : state) {
+    auto aead_result = subtle::AesGcmBoringSsl::New(key);
+    if (!CheckOk(state, aead_result.status())) return;
+    auto stream_result = subtle::StreamingAeadEncryptingStream::New(
+        absl::make_unique<AesGcmSegmentEncrypter>(
+            std::move(aead_result.ValueOrDie()), state.range(1)),
+        absl::make_unique<NullOutputStream>());
+    if (!CheckOk(state, stream_result.status())) return;
+    if (!CheckOk(state, WriteAndClose(plaintext,
+                                      stream_result.ValueOrDie().get()))) {
+      return;
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * plaintext.size());
+}
+BENCHMARK(BM_StreamingEncrypt)->Apply(SegmentSizes);
+
+}  // namespace
+}  // namespace benchmarks
+}  // namespace tink
+}  // namespace crypto
@@ -40,6 +40,7 @@ void uint32_as_big_endian(uint32_t value, char* buf) {
 const int CryptoFormat::kNonRawPrefixSize;
 const int CryptoFormat::kLegacyPrefixSize;
 const uint8_t CryptoFormat::kLegacyStartByte;
+const absl::string_view CryptoFormat::kLegacySuffix("\x00", 1);
 
 const int CryptoFormat::kTinkPrefixSize;
 const uint8_t CryptoFormat::kTinkStartByte;
@@ -52,6 +52,8 @@ TEST_F(CryptoFormatTest, testConstants) {
   EXPECT_EQ(0x01, CryptoFormat::kTinkStartByte);
   EXPECT_EQ(0x00, CryptoFormat::kLegacyStartByte);
   EXPECT_EQ("", CryptoFormat::kRawPrefix);
+  EXPECT_EQ(std::string(1, CryptoFormat::kLegacyStartByte),
+            CryptoFormat::kLegacySuffix);
 }
 
 TEST_F(CryptoFormatTest, testTinkPrefix) {
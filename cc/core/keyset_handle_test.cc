@@ -24,6 +24,7 @@
 #include "tink/binary_keyset_reader.h"
 #include "tink/cleartext_keyset_handle.h"
 #include "tink/config/tink_config.h"
+#include "tink/crypto_format.h"
 #include "tink/json_keyset_reader.h"
 #include "tink/json_keyset_writer.h"
 #include "tink/signature/ecdsa_sign_key_manager.h"
@@ -420,6 +421,72 @@ TEST_F(KeysetHandleTest, GetPrimitive) {
   EXPECT_EQ(aead->Decrypt(raw_encryption, aad).ValueOrDie(), plaintext);
 }
 
+// Tests that GetPrimitiveLazily() creates only the primary eagerly, so that
+// an invalid non-primary key makes only its own ciphertexts fail.
+TEST_F(KeysetHandleTest, GetPrimitiveLazily) {
+  Keyset keyset;
+  KeyData key_data_0 =
+      *Registry::NewKeyData(AeadKeyTemplates::Aes128Gcm()).ValueOrDie();
+  AddKeyData(key_data_0, /*key_id=*/0,
+             google::crypto::tink::OutputPrefixType::TINK,
+             KeyStatusType::ENABLED, &keyset);
+  KeyData key_data_1 =
+      *Registry::NewKeyData(AeadKeyTemplates::Aes256Gcm()).ValueOrDie();
+  AddKeyData(key_data_1, /*key_id=*/1,
+             google::crypto::tink::OutputPrefixType::TINK,
+             KeyStatusType::ENABLED, &keyset);
+  KeyData key_data_2 =
+      *Registry::NewKeyData(AeadKeyTemplates::Aes256Gcm()).ValueOrDie();
+  AddKeyData(key_data_2, /*key_id=*/2,
+             google::crypto::tink::OutputPrefixType::RAW,
+             KeyStatusType::ENABLED, &keyset);
+  KeyData invalid_key_data = key_data_0;
+  invalid_key_data.set_value("not a serialized AesGcmKey");
+  AddKeyData(invalid_key_data, /*key_id=*/3,
+             google::crypto::tink::OutputPrefixType::TINK,
+             KeyStatusType::ENABLED, &keyset);
+  keyset.set_primary_key_id(1);
+  std::unique_ptr<KeysetHandle> keyset_handle =
+      KeysetUtil::GetKeysetHandle(keyset);
+
+  // The invalid key makes the eager creation fail.
+  EXPECT_FALSE(keyset_handle->GetPrimitive<Aead>().ok());
+
+  auto aead_result = keyset_handle->GetPrimitiveLazily<Aead>();
+  ASSERT_TRUE(aead_result.ok()) << aead_result.status();
+  std::unique_ptr<Aead> aead = std::move(aead_result.ValueOrDie());
+
+  std::string plaintext = "plaintext";
+  std::string aad = "aad";
+  std::string encryption = aead->Encrypt(plaintext, aad).ValueOrDie();
+  EXPECT_EQ(aead->Decrypt(encryption, aad).ValueOrDie(), plaintext);
+
+  // Ciphertexts of the non-primary keys are decrypted.
+  Keyset::Key key_0;
+  key_0.set_key_id(0);
+  key_0.set_output_prefix_type(google::crypto::tink::OutputPrefixType::TINK);
+  std::string prefix_0 = CryptoFormat::get_output_prefix(key_0).ValueOrDie();
+  std::unique_ptr<Aead> aead_0 =
+      Registry::GetPrimitive<Aead>(key_data_0).ValueOrDie();
+  std::string encryption_0 =
+      prefix_0 + aead_0->Encrypt(plaintext, aad).ValueOrDie();
+  EXPECT_EQ(aead->Decrypt(encryption_0, aad).ValueOrDie(), plaintext);
+  EXPECT_EQ(aead->Decrypt(encryption_0, aad).ValueOrDie(), plaintext);
+
+  std::unique_ptr<Aead> raw_aead =
+      Registry::GetPrimitive<Aead>(key_data_2).ValueOrDie();
+  std::string raw_encryption = raw_aead->Encrypt(plaintext, aad).ValueOrDie();
+  EXPECT_EQ(aead->Decrypt(raw_encryption, aad).ValueOrDie(), plaintext);
+
+  // The invalid key only fails the ciphertexts with its prefix.
+  Keyset::Key key_3;
+  key_3.set_key_id(3);
+  key_3.set_output_prefix_type(google::crypto::tink::OutputPrefixType::TINK);
+  std::string prefix_3 = CryptoFormat::get_output_prefix(key_3).ValueOrDie();
+  EXPECT_FALSE(aead->Decrypt(prefix_3 + "some ciphertext", aad).ok());
+  EXPECT_EQ(aead->Decrypt(encryption, aad).ValueOrDie(), plaintext);
+}
+
 // Tests that GetPrimitive(nullptr) fails with a non-ok status.
 TEST_F(KeysetHandleTest, GetPrimitiveNullptrKeyManager) {
   Keyset keyset;
@@ -0,0 +1,189 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/keyset_reloader.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "tink/aead.h"
+#include "tink/binary_keyset_reader.h"
+#include "tink/keyset_handle.h"
+#include "tink/keyset_reader.h"
+#include "tink/monitoring/monitoring.h"
+#include "tink/util/secret_data.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "openssl/sha.h"
+#include "proto/tink.pb.h"
+
+namespace crypto {
+namespace tink {
+
+// static
+util::StatusOr<std::unique_ptr<KeysetReloader>> KeysetReloader::New(
+    Loader loader, Publisher publisher, absl::Duration poll_interval) {
+  if (loader.read == nullptr || loader.parse == nullptr ||
+      publisher == nullptr) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+                        "loader and publisher must be non-NULL");
+  }
+  std::unique_ptr<KeysetReloader> reloader(new KeysetReloader(
+      std::move(loader), std::move(publisher), Monitoring::GetSink()));
+  auto status = reloader->Reload();
+  if (!status.ok()) return status;
+  if (poll_interval > absl::ZeroDuration()) {
+    reloader->poll_thread_ =
+        std::thread(&KeysetReloader::PollLoop, reloader.get(), poll_interval);
+  }
+  return std::move(reloader);
+}
+
+// static
+KeysetReloader::Loader KeysetReloader::EncryptedKeysetLoader(
+    KeysetReaderFactory reader_factory, std::shared_ptr<Aead> master_key_aead) {
+  Loader loader;
+  loader.read = [reader_factory]() -> util::StatusOr<std::string> {
+    auto reader_result = reader_factory();
+    if (!reader_result.ok()) return reader_result.status();
+    auto encrypted_keyset_result = reader_result.ValueOrDie()->ReadEncrypted();
+    if (!encrypted_keyset_result.ok()) {
+      return encrypted_keyset_result.status();
+    }
+    return encrypted_keyset_result.ValueOrDie()->SerializeAsString();
+  };
+  loader.parse = [master_key_aead](absl::string_view serialized)
+      -> util::StatusOr<std::unique_ptr<KeysetHandle>> {
+    auto reader_result = BinaryKeysetReader::New(serialized);
+    if (!reader_result.ok()) return reader_result.status();
+    return KeysetHandle::Read(std::move(reader_result.ValueOrDie()),
+                              *master_key_aead);
+  };
+  return loader;
+}
+
+KeysetReloader::KeysetReloader(Loader loader, Publisher publisher,
+                               std::shared_ptr<MonitoringSink> sink)
+    : loader_(std::move(loader)),
+      publisher_(std::move(publisher)),
+      sink_(std::move(sink)),
+      current_primary_key_id_(0),
+      stats_{0, 0, 0, 0, 0},
+      stopping_(false) {}
+
+KeysetReloader::~KeysetReloader() {
+  {
+    absl::MutexLock lock(&poll_mutex_);
+    stopping_ = true;
+  }
+  if (poll_thread_.joinable()) poll_thread_.join();
+}
+
+util::Status KeysetReloader::Reload() {
+  absl::MutexLock lock(&reload_mutex_);
+  return LoadAndPublish();
+}
+
+util::Status KeysetReloader::LoadAndPublish() {
+  MonitoredOperation operation(sink_.get(), "keyset",
+                               MonitoringOperation::kReloadKeyset, 0);
+  auto start = std::chrono::steady_clock::now();
+  auto latency_ns = [start]() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+  };
+  auto read_result = loader_.read();
+  if (!read_result.ok()) {
+    operation.RecordFailure();
+    RecordReload(false, false, latency_ns());
+    return read_result.status();
+  }
+  // The bytes may be a cleartext keyset, so they are wiped once they have
+  // been parsed; only their digest is kept.
+  std::string bytes = std::move(read_result.ValueOrDie());
+  uint8_t digest_bytes[SHA256_DIGEST_LENGTH];
+  SHA256(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size(),
+         digest_bytes);
+  std::string digest(reinterpret_cast<const char*>(digest_bytes),
+                     sizeof(digest_bytes));
+  if (digest == current_digest_) {
+    util::SafeZeroString(&bytes);
+    operation.RecordSuccess(current_primary_key_id_);
+    RecordReload(true, false, latency_ns());
+    return util::OkStatus();
+  }
+  auto handle_result = loader_.parse(bytes);
+  util::SafeZeroString(&bytes);
+  if (!handle_result.ok()) {
+    operation.RecordFailure();
+    RecordReload(false, false, latency_ns());
+    return handle_result.status();
+  }
+  std::unique_ptr<KeysetHandle> handle = std::move(handle_result.ValueOrDie());
+  uint32_t primary_key_id = handle->get_keyset().primary_key_id();
+  auto status = publisher_(*handle);
+  if (!status.ok()) {
+    operation.RecordFailure(primary_key_id);
+    RecordReload(false, false, latency_ns());
+    return status;
+  }
+  current_digest_ = std::move(digest);
+  current_primary_key_id_ = primary_key_id;
+  operation.RecordSuccess(primary_key_id);
+  RecordReload(true, true, latency_ns());
+  return util::OkStatus();
+}
+
+void KeysetReloader::RecordReload(bool success, bool published,
+                                  int64_t latency_ns) {
+  absl::MutexLock lock(&stats_mutex_);
+  stats_.reload_count++;
+  if (!success) stats_.failure_count++;
+  if (published) stats_.publish_count++;
+  stats_.last_reload_latency_ns = latency_ns;
+  stats_.max_reload_latency_ns =
+      std::max(stats_.max_reload_latency_ns, latency_ns);
+}
+
+KeysetReloader::Stats KeysetReloader::GetStats() const {
+  absl::MutexLock lock(&stats_mutex_);
+  return stats_;
+}
+
+bool KeysetReloader::Stopping() const { return stopping_; }
+
+void KeysetReloader::PollLoop(absl::Duration poll_interval) {
+  while (true) {
+    {
+      absl::MutexLock lock(&poll_mutex_);
+      if (poll_mutex_.AwaitWithTimeout(
+              absl::Condition(this, &KeysetReloader::Stopping),
+              poll_interval)) {
+        return;
+      }
+    }
+    // Failures are reflected in the stats, and the current keyset stays.
+    Reload().IgnoreError();
+  }
+}
+
+}  // namespace tink
+}  // namespace crypto
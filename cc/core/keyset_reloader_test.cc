@@ -0,0 +1,268 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/keyset_reloader.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "tink/binary_keyset_reader.h"
+#include "tink/keyset_handle.h"
+#include "tink/monitoring/histogram_monitoring_sink.h"
+#include "tink/monitoring/monitoring.h"
+#include "tink/util/keyset_util.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "tink/util/test_util.h"
+#include "proto/tink.pb.h"
+
+namespace crypto {
+namespace tink {
+namespace {
+
+using crypto::tink::test::AddTinkKey;
+using crypto::tink::test::DummyAead;
+using google::crypto::tink::EncryptedKeyset;
+using google::crypto::tink::KeyData;
+using google::crypto::tink::Keyset;
+using google::crypto::tink::KeyStatusType;
+
+Keyset GetKeyset(uint32_t primary_key_id) {
+  Keyset keyset;
+  Keyset::Key key;
+  AddTinkKey("some key type", primary_key_id, key, KeyStatusType::ENABLED,
+             KeyData::SYMMETRIC, &keyset);
+  keyset.set_primary_key_id(primary_key_id);
+  return keyset;
+}
+
+// A keyset source whose content can be changed by the test.
+class FakeSource {
+ public:
+  void Set(uint32_t primary_key_id) {
+    absl::MutexLock lock(&mutex_);
+    status_ = util::OkStatus();
+    keyset_ = GetKeyset(primary_key_id);
+  }
+
+  void SetError() {
+    absl::MutexLock lock(&mutex_);
+    status_ = util::Status(util::error::UNAVAILABLE, "source unavailable");
+  }
+
+  KeysetReloader::Loader GetLoader() {
+    KeysetReloader::Loader loader;
+    loader.read = [this]() -> util::StatusOr<std::string> {
+      absl::MutexLock lock(&mutex_);
+      if (!status_.ok()) return status_;
+      return keyset_.SerializeAsString();
+    };
+    loader.parse = [this](absl::string_view serialized)
+        -> util::StatusOr<std::unique_ptr<KeysetHandle>> {
+      absl::MutexLock lock(&mutex_);
+      parse_count_++;
+      Keyset keyset;
+      if (!keyset.ParseFromArray(serialized.data(), serialized.size())) {
+        return util::Status(util::error::INVALID_ARGUMENT,
+                            "could not parse keyset");
+      }
+      return KeysetUtil::GetKeysetHandle(keyset);
+    };
+    return loader;
+  }
+
+  int parse_count() {
+    absl::MutexLock lock(&mutex_);
+    return parse_count_;
+  }
+
+ private:
+  absl::Mutex mutex_;
+  util::Status status_ GUARDED_BY(mutex_);
+  Keyset keyset_ GUARDED_BY(mutex_);
+  int parse_count_ GUARDED_BY(mutex_) = 0;
+};
+
+// Records the primary key ids of the published keysets.
+class Published {
+ public:
+  KeysetReloader::Publisher GetPublisher() {
+    return [this](const KeysetHandle& handle) {
+      absl::MutexLock lock(&mutex_);
+      if (fail_) {
+        return util::Status(util::error::INVALID_ARGUMENT, "publish failed");
+      }
+      ids_.push_back(KeysetUtil::GetKeyset(handle).primary_key_id());
+      return util::OkStatus();
+    };
+  }
+
+  void SetFail(bool fail) {
+    absl::MutexLock lock(&mutex_);
+    fail_ = fail;
+  }
+
+  std::vector<uint32_t> ids() {
+    absl::MutexLock lock(&mutex_);
+    return ids_;
+  }
+
+ private:
+  absl::Mutex mutex_;
+  bool fail_ GUARDED_BY(mutex_) = false;
+  std::vector<uint32_t> ids_ GUARDED_BY(mutex_);
+};
+
+TEST(KeysetReloaderTest, ReloadPublishesChanges) {
+  FakeSource source;
+  source.Set(1);
+  Published published;
+  auto reloader_result = KeysetReloader::New(
+      source.GetLoader(), published.GetPublisher(), absl::ZeroDuration());
+  ASSERT_TRUE(reloader_result.ok()) << reloader_result.status();
+  auto reloader = std::move(reloader_result.ValueOrDie());
+  EXPECT_EQ(std::vector<uint32_t>({1}), published.ids());
+
+  // Unchanged keyset, which is not even parsed.
+  EXPECT_TRUE(reloader->Reload().ok());
+  EXPECT_EQ(std::vector<uint32_t>({1}), published.ids());
+  EXPECT_EQ(1, source.parse_count());
+
+  source.Set(2);
+  EXPECT_TRUE(reloader->Reload().ok());
+  EXPECT_EQ(std::vector<uint32_t>({1, 2}), published.ids());
+
+  auto stats = reloader->GetStats();
+  EXPECT_EQ(3, stats.reload_count);
+  EXPECT_EQ(0, stats.failure_count);
+  EXPECT_EQ(2, stats.publish_count);
+  EXPECT_LE(stats.last_reload_latency_ns, stats.max_reload_latency_ns);
+}
+
+TEST(KeysetReloaderTest, FailuresKeepTheCurrentKeyset) {
+  FakeSource source;
+  source.Set(1);
+  Published published;
+  auto reloader = std::move(KeysetReloader::New(source.GetLoader(),
+                                                published.GetPublisher(),
+                                                absl::ZeroDuration())
+                                .ValueOrDie());
+  source.SetError();
+  EXPECT_EQ(util::error::UNAVAILABLE, reloader->Reload().error_code());
+
+  source.Set(2);
+  published.SetFail(true);
+  EXPECT_EQ(util::error::INVALID_ARGUMENT, reloader->Reload().error_code());
+
+  // The keyset that failed to publish is retried.
+  published.SetFail(false);
+  EXPECT_TRUE(reloader->Reload().ok());
+  EXPECT_EQ(std::vector<uint32_t>({1, 2}), published.ids());
+
+  auto stats = reloader->GetStats();
+  EXPECT_EQ(4, stats.reload_count);
+  EXPECT_EQ(2, stats.failure_count);
+  EXPECT_EQ(2, stats.publish_count);
+}
+
+TEST(KeysetReloaderTest, InitialLoadMustSucceed) {
+  FakeSource source;
+  source.SetError();
+  Published published;
+  EXPECT_FALSE(KeysetReloader::New(source.GetLoader(),
+                                   published.GetPublisher(),
+                                   absl::ZeroDuration())
+                   .ok());
+  EXPECT_FALSE(KeysetReloader::New(KeysetReloader::Loader(),
+                                   published.GetPublisher(),
+                                   absl::ZeroDuration())
+                   .ok());
+}
+
+TEST(KeysetReloaderTest, Polling) {
+  FakeSource source;
+  source.Set(1);
+  Published published;
+  auto reloader = std::move(KeysetReloader::New(source.GetLoader(),
+                                                published.GetPublisher(),
+                                                absl::Milliseconds(1))
+                                .ValueOrDie());
+  source.Set(2);
+  while (published.ids().size() < 2) absl::SleepFor(absl::Milliseconds(1));
+  EXPECT_EQ(std::vector<uint32_t>({1, 2}), published.ids());
+  EXPECT_LE(2, reloader->GetStats().reload_count);
+}
+
+TEST(KeysetReloaderTest, Monitoring) {
+  auto sink = std::make_shared<HistogramMonitoringSink>();
+  Monitoring::SetSink(sink);
+  FakeSource source;
+  source.Set(1);
+  Published published;
+  auto reloader = std::move(KeysetReloader::New(source.GetLoader(),
+                                                published.GetPublisher(),
+                                                absl::ZeroDuration())
+                                .ValueOrDie());
+  Monitoring::SetSink(nullptr);
+  source.SetError();
+  reloader->Reload().IgnoreError();
+
+  auto metrics = sink->Snapshot();
+  ASSERT_EQ(2, metrics.size());
+  EXPECT_EQ("keyset", metrics[0].primitive);
+  EXPECT_EQ(MonitoringOperation::kReloadKeyset, metrics[0].operation);
+  EXPECT_EQ(0, metrics[0].key_id);
+  EXPECT_FALSE(metrics[0].success);
+  EXPECT_EQ(1, metrics[1].key_id);
+  EXPECT_TRUE(metrics[1].success);
+}
+
+TEST(KeysetReloaderTest, EncryptedKeysetLoader) {
+  auto master_key_aead = std::make_shared<DummyAead>("master key");
+  Keyset keyset = GetKeyset(42);
+  EncryptedKeyset encrypted_keyset;
+  encrypted_keyset.set_encrypted_keyset(
+      master_key_aead->Encrypt(keyset.SerializeAsString(), "").ValueOrDie());
+  std::string serialized = encrypted_keyset.SerializeAsString();
+  auto loader = KeysetReloader::EncryptedKeysetLoader(
+      [serialized]() -> util::StatusOr<std::unique_ptr<KeysetReader>> {
+        auto reader_result = BinaryKeysetReader::New(serialized);
+        if (!reader_result.ok()) return reader_result.status();
+        return std::unique_ptr<KeysetReader>(
+            std::move(reader_result.ValueOrDie()));
+      },
+      master_key_aead);
+  auto read_result = loader.read();
+  ASSERT_TRUE(read_result.ok()) << read_result.status();
+  // What is read, and compared between reloads, is the ciphertext.
+  EXPECT_EQ(serialized, read_result.ValueOrDie());
+  auto handle_result = loader.parse(read_result.ValueOrDie());
+  ASSERT_TRUE(handle_result.ok()) << handle_result.status();
+  EXPECT_EQ(keyset.SerializeAsString(),
+            KeysetUtil::GetKeyset(*handle_result.ValueOrDie())
+                .SerializeAsString());
+}
+
+}  // namespace
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,294 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/primitive_intern_cache.h"
+
+#include <algorithm>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "tink/aead.h"
+#include "tink/deterministic_aead.h"
+#include "tink/hybrid_decrypt.h"
+#include "tink/hybrid_encrypt.h"
+#include "tink/mac.h"
+#include "tink/public_key_sign.h"
+#include "tink/public_key_verify.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "openssl/sha.h"
+#include "proto/tink.pb.h"
+
+namespace crypto {
+namespace tink {
+
+using crypto::tink::util::Status;
+using crypto::tink::util::StatusOr;
+using google::crypto::tink::KeyData;
+
+constexpr int PrimitiveInternCache::kNumShards;
+
+namespace {
+
+// Shards do not sweep expired entries before they have this many.
+constexpr size_t kMinSweepSize = 64;
+
+class SharedAead : public Aead {
+ public:
+  explicit SharedAead(std::shared_ptr<Aead> aead) : aead_(std::move(aead)) {}
+
+  StatusOr<std::string> Encrypt(
+      absl::string_view plaintext,
+      absl::string_view associated_data) const override {
+    return aead_->Encrypt(plaintext, associated_data);
+  }
+
+  StatusOr<std::string> Decrypt(
+      absl::string_view ciphertext,
+      absl::string_view associated_data) const override {
+    return aead_->Decrypt(ciphertext, associated_data);
+  }
+
+ private:
+  const std::shared_ptr<Aead> aead_;
+};
+
+class SharedDeterministicAead : public DeterministicAead {
+ public:
+  explicit SharedDeterministicAead(std::shared_ptr<DeterministicAead> daead)
+      : daead_(std::move(daead)) {}
+
+  StatusOr<std::string> EncryptDeterministically(
+      absl::string_view plaintext,
+      absl::string_view associated_data) const override {
+    return daead_->EncryptDeterministically(plaintext, associated_data);
+  }
+
+  StatusOr<std::string> DecryptDeterministically(
+      absl::string_view ciphertext,
+      absl::string_view associated_data) const override {
+    return daead_->DecryptDeterministically(ciphertext, associated_data);
+  }
+
+ private:
+  const std::shared_ptr<DeterministicAead> daead_;
+};
+
+class SharedHybridDecrypt : public HybridDecrypt {
+ public:
+  explicit SharedHybridDecrypt(std::shared_ptr<HybridDecrypt> decrypt)
+      : decrypt_(std::move(decrypt)) {}
+
+  StatusOr<std::string> Decrypt(
+      absl::string_view ciphertext,
+      absl::string_view context_info) const override {
+    return decrypt_->Decrypt(ciphertext, context_info);
+  }
+
+ private:
+  const std::shared_ptr<HybridDecrypt> decrypt_;
+};
+
+class SharedHybridEncrypt : public HybridEncrypt {
+ public:
+  explicit SharedHybridEncrypt(std::shared_ptr<HybridEncrypt> encrypt)
+      : encrypt_(std::move(encrypt)) {}
+
+  StatusOr<std::string> Encrypt(
+      absl::string_view plaintext,
+      absl::string_view context_info) const override {
+    return encrypt_->Encrypt(plaintext, context_info);
+  }
+
+ private:
+  const std::shared_ptr<HybridEncrypt> encrypt_;
+};
+
+class SharedMac : public Mac {
+ public:
+  explicit SharedMac(std::shared_ptr<Mac> mac) : mac_(std::move(mac)) {}
+
+  StatusOr<std::string> ComputeMac(absl::string_view data) const override {
+    return mac_->ComputeMac(data);
+  }
+
+  Status VerifyMac(absl::string_view mac_value,
+                   absl::string_view data) const override {
+    return mac_->VerifyMac(mac_value, data);
+  }
+
+  StatusOr<std::string> ComputeMacMultipart(
+      absl::Span<const absl::string_view> data_pieces) const override {
+    return mac_->ComputeMacMultipart(data_pieces);
+  }
+
+  Status VerifyMacMultipart(
+      absl::string_view mac_value,
+      absl::Span<const absl::string_view> data_pieces) const override {
+    return mac_->VerifyMacMultipart(mac_value, data_pieces);
+  }
+
+ private:
+  const std::shared_ptr<Mac> mac_;
+};
+
+class SharedPublicKeySign : public PublicKeySign {
+ public:
+  explicit SharedPublicKeySign(std::shared_ptr<PublicKeySign> sign)
+      : sign_(std::move(sign)) {}
+
+  StatusOr<std::string> Sign(absl::string_view data) const override {
+    return sign_->Sign(data);
+  }
+
+  StatusOr<std::string> SignMultipart(
+      absl::Span<const absl::string_view> data_pieces) const override {
+    return sign_->SignMultipart(data_pieces);
+  }
+
+ private:
+  const std::shared_ptr<PublicKeySign> sign_;
+};
+
+class SharedPublicKeyVerify : public PublicKeyVerify {
+ public:
+  explicit SharedPublicKeyVerify(std::shared_ptr<PublicKeyVerify> verify)
+      : verify_(std::move(verify)) {}
+
+  Status Verify(absl::string_view signature,
+                absl::string_view data) const override {
+    return verify_->Verify(signature, data);
+  }
+
+  Status VerifyMultipart(
+      absl::string_view signature,
+      absl::Span<const absl::string_view> data_pieces) const override {
+    return verify_->VerifyMultipart(signature, data_pieces);
+  }
+
+ private:
+  const std::shared_ptr<PublicKeyVerify> verify_;
+};
+
+}  // namespace
+
+#define TINK_DEFINE_SHARED_PRIMITIVE(P)                             \
+  constexpr bool SharedPrimitive<P>::kSupported;                    \
+  std::unique_ptr<P> SharedPrimitive<P>::Wrap(                      \
+      std::shared_ptr<P> primitive) {                               \
+    return std::unique_ptr<P>(new Shared##P(std::move(primitive))); \
+  }
+
+TINK_DEFINE_SHARED_PRIMITIVE(Aead)
+TINK_DEFINE_SHARED_PRIMITIVE(DeterministicAead)
+TINK_DEFINE_SHARED_PRIMITIVE(HybridDecrypt)
+TINK_DEFINE_SHARED_PRIMITIVE(HybridEncrypt)
+TINK_DEFINE_SHARED_PRIMITIVE(Mac)
+TINK_DEFINE_SHARED_PRIMITIVE(PublicKeySign)
+TINK_DEFINE_SHARED_PRIMITIVE(PublicKeyVerify)
+
+#undef TINK_DEFINE_SHARED_PRIMITIVE
+
+// static
+PrimitiveInternCache& PrimitiveInternCache::Global() {
+  static PrimitiveInternCache* cache = new PrimitiveInternCache();
+  return *cache;
+}
+
+PrimitiveInternCache::PrimitiveInternCache() : enabled_(false) {
+  for (Shard& shard : shards_) {
+    absl::MutexLock lock(&shard.mutex);
+    shard.sweep_size = kMinSweepSize;
+    shard.hit_count = 0;
+    shard.miss_count = 0;
+  }
+}
+
+std::string PrimitiveInternCache::CacheKey(const char* type_id_name,
+                                           const KeyData& key_data,
+                                           Shard** shard) {
+  const std::string& value = key_data.value();
+  uint8_t digest[SHA256_DIGEST_LENGTH];
+  SHA256(reinterpret_cast<const uint8_t*>(value.data()), value.size(),
+         digest);
+  *shard = &shards_[digest[0] % kNumShards];
+  // The type url and the type name cannot contain '\0'.
+  return absl::StrCat(
+      key_data.type_url(), absl::string_view("\0", 1), type_id_name,
+      absl::string_view("\0", 1),
+      absl::string_view(reinterpret_cast<const char*>(digest),
+                        sizeof(digest)));
+}
+
+std::shared_ptr<void> PrimitiveInternCache::Find(Shard* shard,
+                                                 const std::string& key) {
+  absl::MutexLock lock(&shard->mutex);
+  auto it = shard->entries.find(key);
+  if (it == shard->entries.end()) return nullptr;
+  std::shared_ptr<void> primitive = it->second.lock();
+  if (primitive != nullptr) shard->hit_count++;
+  return primitive;
+}
+
+std::shared_ptr<void> PrimitiveInternCache::Insert(
+    Shard* shard, const std::string& key, std::shared_ptr<void> primitive) {
+  absl::MutexLock lock(&shard->mutex);
+  std::weak_ptr<void>& entry = shard->entries[key];
+  std::shared_ptr<void> existing = entry.lock();
+  if (existing != nullptr) {
+    // Another thread created the instance first; this lookup ends up
+    // sharing it, and 'primitive' is dropped.
+    shard->hit_count++;
+    return existing;
+  }
+  shard->miss_count++;
+  entry = primitive;
+  if (shard->entries.size() >= shard->sweep_size) {
+    for (auto it = shard->entries.begin(); it != shard->entries.end();) {
+      if (it->second.expired()) {
+        it = shard->entries.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    shard->sweep_size = std::max(kMinSweepSize, 2 * shard->entries.size());
+  }
+  return primitive;
+}
+
+void PrimitiveInternCache::Clear() {
+  for (Shard& shard : shards_) {
+    absl::MutexLock lock(&shard.mutex);
+    shard.entries.clear();
+    shard.sweep_size = kMinSweepSize;
+  }
+}
+
+PrimitiveInternCache::Stats PrimitiveInternCache::GetStats() const {
+  Stats stats = {0, 0, 0};
+  for (const Shard& shard : shards_) {
+    absl::MutexLock lock(&shard.mutex);
+    stats.hit_count += shard.hit_count;
+    stats.miss_count += shard.miss_count;
+    stats.entry_count += shard.entries.size();
+  }
+  return stats;
+}
+
+}  // namespace tink
+}  // namespace crypto
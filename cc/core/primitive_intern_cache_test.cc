@@ -0,0 +1,353 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/primitive_intern_cache.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tink/aead.h"
+#include "tink/input_stream.h"
+#include "tink/key_manager.h"
+#include "tink/output_stream.h"
+#include "tink/registry.h"
+#include "tink/streaming_aead.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "proto/tink.pb.h"
+
+namespace crypto {
+namespace tink {
+namespace {
+
+using crypto::tink::util::Status;
+using crypto::tink::util::StatusOr;
+using google::crypto::tink::KeyData;
+
+const char kKeyType[] = "type.googleapis.com/google.crypto.tink.TestKey";
+
+// An Aead that keeps track of the number of live instances.
+class CountingAead : public Aead {
+ public:
+  CountingAead(absl::string_view name, std::atomic<int>* live_count)
+      : name_(name), live_count_(live_count) {
+    (*live_count_)++;
+  }
+
+  ~CountingAead() override { (*live_count_)--; }
+
+  StatusOr<std::string> Encrypt(
+      absl::string_view plaintext,
+      absl::string_view associated_data) const override {
+    return absl::StrCat(name_, ":", plaintext);
+  }
+
+  StatusOr<std::string> Decrypt(
+      absl::string_view ciphertext,
+      absl::string_view associated_data) const override {
+    return Status(util::error::UNIMPLEMENTED, "not implemented");
+  }
+
+ private:
+  const std::string name_;
+  std::atomic<int>* live_count_;
+};
+
+class UnimplementedStreamingAead : public StreamingAead {
+ public:
+  StatusOr<std::unique_ptr<OutputStream>> NewEncryptingStream(
+      std::unique_ptr<OutputStream> ciphertext_destination,
+      absl::string_view associated_data) override {
+    return Status(util::error::UNIMPLEMENTED, "not implemented");
+  }
+
+  StatusOr<std::unique_ptr<InputStream>> NewDecryptingStream(
+      std::unique_ptr<InputStream> ciphertext_source,
+      absl::string_view associated_data) override {
+    return Status(util::error::UNIMPLEMENTED, "not implemented");
+  }
+};
+
+KeyData NewKeyData(absl::string_view value) {
+  KeyData key_data;
+  key_data.set_type_url(kKeyType);
+  key_data.set_value(std::string(value));
+  key_data.set_key_material_type(KeyData::SYMMETRIC);
+  return key_data;
+}
+
+class PrimitiveInternCacheTest : public ::testing::Test {
+ protected:
+  PrimitiveInternCacheTest() : create_count_(0), live_count_(0) {}
+
+  StatusOr<std::unique_ptr<Aead>> GetAead(const KeyData& key_data) {
+    return cache_.GetOrCreate<Aead>(
+        key_data, [this, &key_data]() -> StatusOr<std::unique_ptr<Aead>> {
+          create_count_++;
+          return {absl::make_unique<CountingAead>(key_data.value(),
+                                                  &live_count_)};
+        });
+  }
+
+  PrimitiveInternCache cache_;
+  std::atomic<int> create_count_;
+  std::atomic<int> live_count_;
+};
+
+TEST_F(PrimitiveInternCacheTest, DisabledByDefault) {
+  EXPECT_FALSE(cache_.enabled());
+  KeyData key_data = NewKeyData("key");
+  auto aead1 = GetAead(key_data);
+  ASSERT_TRUE(aead1.ok()) << aead1.status();
+  auto aead2 = GetAead(key_data);
+  ASSERT_TRUE(aead2.ok()) << aead2.status();
+  EXPECT_EQ(2, create_count_);
+  EXPECT_EQ(2, live_count_);
+  EXPECT_EQ(0, cache_.GetStats().entry_count);
+}
+
+TEST_F(PrimitiveInternCacheTest, SharesInstanceForSameKey) {
+  cache_.SetEnabled(true);
+  KeyData key_data = NewKeyData("key");
+  auto aead1 = GetAead(key_data);
+  ASSERT_TRUE(aead1.ok()) << aead1.status();
+  auto aead2 = GetAead(key_data);
+  ASSERT_TRUE(aead2.ok()) << aead2.status();
+  EXPECT_EQ(1, create_count_);
+  EXPECT_EQ(1, live_count_);
+  EXPECT_NE(aead1.ValueOrDie().get(), aead2.ValueOrDie().get());
+  auto ciphertext = aead2.ValueOrDie()->Encrypt("plaintext", "ad");
+  ASSERT_TRUE(ciphertext.ok()) << ciphertext.status();
+  EXPECT_EQ("key:plaintext", ciphertext.ValueOrDie());
+
+  PrimitiveInternCache::Stats stats = cache_.GetStats();
+  EXPECT_EQ(1, stats.hit_count);
+  EXPECT_EQ(1, stats.miss_count);
+  EXPECT_EQ(1, stats.entry_count);
+}
+
+TEST_F(PrimitiveInternCacheTest, DoesNotShareDifferentKeys) {
+  cache_.SetEnabled(true);
+  KeyData other_type = NewKeyData("key");
+  other_type.set_type_url(absl::StrCat(kKeyType, "2"));
+  auto aead1 = GetAead(NewKeyData("key"));
+  auto aead2 = GetAead(NewKeyData("other key"));
+  auto aead3 = GetAead(other_type);
+  ASSERT_TRUE(aead1.ok() && aead2.ok() && aead3.ok());
+  EXPECT_EQ(3, create_count_);
+  EXPECT_EQ(3, live_count_);
+}
+
+TEST_F(PrimitiveInternCacheTest, HoldsOnlyWeakReferences) {
+  cache_.SetEnabled(true);
+  KeyData key_data = NewKeyData("key");
+  {
+    auto aead1 = GetAead(key_data);
+    auto aead2 = GetAead(key_data);
+    ASSERT_TRUE(aead1.ok() && aead2.ok());
+    EXPECT_EQ(1, live_count_);
+  }
+  EXPECT_EQ(0, live_count_);
+  auto aead = GetAead(key_data);
+  ASSERT_TRUE(aead.ok()) << aead.status();
+  EXPECT_EQ(2, create_count_);
+  EXPECT_EQ(1, live_count_);
+}
+
+TEST_F(PrimitiveInternCacheTest, RemovesExpiredEntries) {
+  cache_.SetEnabled(true);
+  for (int i = 0; i < 10000; i++) {
+    auto aead = GetAead(NewKeyData(absl::StrCat("key ", i)));
+    ASSERT_TRUE(aead.ok()) << aead.status();
+  }
+  EXPECT_EQ(0, live_count_);
+  EXPECT_LT(cache_.GetStats().entry_count, 10000 / 4);
+  cache_.Clear();
+  EXPECT_EQ(0, cache_.GetStats().entry_count);
+}
+
+TEST_F(PrimitiveInternCacheTest, DoesNotCacheErrors) {
+  cache_.SetEnabled(true);
+  KeyData key_data = NewKeyData("key");
+  int attempts = 0;
+  for (int i = 0; i < 2; i++) {
+    auto result = cache_.GetOrCreate<Aead>(
+        key_data, [&attempts]() -> StatusOr<std::unique_ptr<Aead>> {
+          attempts++;
+          return Status(util::error::INVALID_ARGUMENT, "bad key");
+        });
+    EXPECT_FALSE(result.ok());
+    EXPECT_EQ(util::error::INVALID_ARGUMENT, result.status().error_code());
+  }
+  EXPECT_EQ(2, attempts);
+  auto aead = GetAead(key_data);
+  EXPECT_TRUE(aead.ok()) << aead.status();
+}
+
+TEST_F(PrimitiveInternCacheTest, DoesNotInternStreamingAead) {
+  cache_.SetEnabled(true);
+  KeyData key_data = NewKeyData("key");
+  int create_count = 0;
+  std::vector<std::unique_ptr<StreamingAead>> primitives;
+  for (int i = 0; i < 2; i++) {
+    auto result = cache_.GetOrCreate<StreamingAead>(
+        key_data,
+        [&create_count]() -> StatusOr<std::unique_ptr<StreamingAead>> {
+          create_count++;
+          return {absl::make_unique<UnimplementedStreamingAead>()};
+        });
+    ASSERT_TRUE(result.ok()) << result.status();
+    primitives.push_back(std::move(result.ValueOrDie()));
+  }
+  EXPECT_EQ(2, create_count);
+  EXPECT_EQ(0, cache_.GetStats().entry_count);
+}
+
+TEST_F(PrimitiveInternCacheTest, ConcurrentLookups) {
+  cache_.SetEnabled(true);
+  KeyData key_data = NewKeyData("key");
+  auto held = GetAead(key_data);
+  ASSERT_TRUE(held.ok()) << held.status();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; t++) {
+    threads.emplace_back([this, &key_data]() {
+      for (int i = 0; i < 100; i++) {
+        auto aead = GetAead(key_data);
+        EXPECT_TRUE(aead.ok()) << aead.status();
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  EXPECT_EQ(1, create_count_);
+  EXPECT_EQ(800, cache_.GetStats().hit_count);
+}
+
+TEST_F(PrimitiveInternCacheTest, RacingCreationsCountOneMiss) {
+  cache_.SetEnabled(true);
+  KeyData key_data = NewKeyData("key");
+  // Both lookups miss, and both create an instance before either inserts
+  // it; the second insertion finds the first instance, which is a hit.
+  std::atomic<int> creating(0);
+  auto create = [this, &key_data,
+                 &creating]() -> StatusOr<std::unique_ptr<Aead>> {
+    create_count_++;
+    creating++;
+    while (creating < 2) std::this_thread::yield();
+    return {absl::make_unique<CountingAead>(key_data.value(), &live_count_)};
+  };
+  std::vector<std::unique_ptr<Aead>> aeads(2);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 2; t++) {
+    threads.emplace_back([this, &key_data, &create, &aeads, t]() {
+      auto aead = cache_.GetOrCreate<Aead>(key_data, create);
+      ASSERT_TRUE(aead.ok()) << aead.status();
+      aeads[t] = std::move(aead.ValueOrDie());
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  EXPECT_EQ(2, create_count_);
+  EXPECT_EQ(1, live_count_);
+  EXPECT_EQ(1, cache_.GetStats().miss_count);
+  EXPECT_EQ(1, cache_.GetStats().hit_count);
+}
+
+class UnimplementedKeyFactory : public KeyFactory {
+ public:
+  StatusOr<std::unique_ptr<portable_proto::MessageLite>> NewKey(
+      const portable_proto::MessageLite& key_format) const override {
+    return Status(util::error::UNIMPLEMENTED, "not implemented");
+  }
+
+  StatusOr<std::unique_ptr<portable_proto::MessageLite>> NewKey(
+      absl::string_view serialized_key_format) const override {
+    return Status(util::error::UNIMPLEMENTED, "not implemented");
+  }
+
+  StatusOr<std::unique_ptr<KeyData>> NewKeyData(
+      absl::string_view serialized_key_format) const override {
+    return Status(util::error::UNIMPLEMENTED, "not implemented");
+  }
+};
+
+// A key manager that builds a CountingAead for every call.
+class CountingAeadKeyManager : public KeyManager<Aead> {
+ public:
+  CountingAeadKeyManager(std::atomic<int>* create_count,
+                         std::atomic<int>* live_count)
+      : key_type_(kKeyType),
+        create_count_(create_count),
+        live_count_(live_count) {}
+
+  StatusOr<std::unique_ptr<Aead>> GetPrimitive(
+      const KeyData& key_data) const override {
+    (*create_count_)++;
+    return {absl::make_unique<CountingAead>(key_data.value(), live_count_)};
+  }
+
+  StatusOr<std::unique_ptr<Aead>> GetPrimitive(
+      const portable_proto::MessageLite& key) const override {
+    return Status(util::error::UNIMPLEMENTED, "not implemented");
+  }
+
+  uint32_t get_version() const override { return 0; }
+
+  const std::string& get_key_type() const override { return key_type_; }
+
+  const KeyFactory& get_key_factory() const override { return key_factory_; }
+
+ private:
+  const std::string key_type_;
+  UnimplementedKeyFactory key_factory_;
+  std::atomic<int>* create_count_;
+  std::atomic<int>* live_count_;
+};
+
+TEST_F(PrimitiveInternCacheTest, RegistryGetPrimitive) {
+  Registry::Reset();
+  std::atomic<int> create_count(0);
+  std::atomic<int> live_count(0);
+  ASSERT_TRUE(Registry::RegisterKeyManager(
+                  absl::make_unique<CountingAeadKeyManager>(&create_count,
+                                                            &live_count),
+                  /* new_key_allowed= */ false)
+                  .ok());
+  KeyData key_data = NewKeyData("key");
+
+  PrimitiveInternCache::Global().SetEnabled(true);
+  auto aead1 = Registry::GetPrimitive<Aead>(key_data);
+  auto aead2 = Registry::GetPrimitive<Aead>(key_data);
+  PrimitiveInternCache::Global().SetEnabled(false);
+  ASSERT_TRUE(aead1.ok()) << aead1.status();
+  ASSERT_TRUE(aead2.ok()) << aead2.status();
+  EXPECT_EQ(1, create_count);
+  EXPECT_EQ(1, live_count);
+
+  auto aead3 = Registry::GetPrimitive<Aead>(key_data);
+  ASSERT_TRUE(aead3.ok()) << aead3.status();
+  EXPECT_EQ(2, create_count);
+  Registry::Reset();
+}
+
+}  // namespace
+}  // namespace tink
+}  // namespace crypto
@@ -14,11 +14,15 @@
 //
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <atomic>
 #include <thread>  // NOLINT(build/c++11)
+#include <vector>
 
 #include "tink/primitive_set.h"
 #include "tink/crypto_format.h"
 #include "tink/mac.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
 #include "tink/util/test_util.h"
 #include "gtest/gtest.h"
 #include "proto/tink.pb.h"
@@ -155,6 +159,7 @@ TEST_F(PrimitiveSetTest, Basic) {
 
   PrimitiveSet<Mac> primitive_set;
   EXPECT_TRUE(primitive_set.get_primary() == nullptr);
+  EXPECT_EQ(0, primitive_set.size());
   EXPECT_EQ(util::error::NOT_FOUND,
             primitive_set.get_raw_primitives().status().error_code());
   EXPECT_EQ(util::error::NOT_FOUND,
@@ -186,7 +191,7 @@ TEST_F(PrimitiveSetTest, Basic) {
   EXPECT_FALSE(add_primitive_result.ok());
   EXPECT_EQ(util::error::INVALID_ARGUMENT,
             add_primitive_result.status().error_code());
-
+  EXPECT_EQ(6, primitive_set.size());
 
   std::string data = "some data";
 
@@ -205,6 +210,7 @@ TEST_F(PrimitiveSetTest, Basic) {
               primitives[0]->get_primitive().ComputeMac(data).ValueOrDie());
     EXPECT_EQ(KeyStatusType::ENABLED, primitives[0]->get_status());
     EXPECT_EQ(OutputPrefixType::RAW, primitives[0]->get_output_prefix_type());
+    EXPECT_EQ(key_id_4, primitives[0]->get_key_id());
     EXPECT_EQ(DummyMac(mac_name_5).ComputeMac(data).ValueOrDie(),
               primitives[1]->get_primitive().ComputeMac(data).ValueOrDie());
     EXPECT_EQ(KeyStatusType::DISABLED, primitives[1]->get_status());
@@ -344,6 +350,105 @@ TEST_F(PrimitiveSetTest, PrimaryKeyWithIdCollisions) {
 }
 
 
+TEST_F(PrimitiveSetTest, LazyPrimitive) {
+  PrimitiveSet<Mac> mac_set;
+  Keyset::Key key;
+  key.set_output_prefix_type(OutputPrefixType::TINK);
+  key.set_key_id(42);
+  key.set_status(KeyStatusType::ENABLED);
+  int factory_calls = 0;
+  auto add_result = mac_set.AddLazyPrimitive(
+      [&factory_calls]() -> util::StatusOr<std::unique_ptr<Mac>> {
+        factory_calls++;
+        return std::unique_ptr<Mac>(new DummyMac("lazy MAC"));
+      },
+      key);
+  ASSERT_TRUE(add_result.ok()) << add_result.status();
+  auto entry = add_result.ValueOrDie();
+  EXPECT_TRUE(entry->is_lazy());
+  EXPECT_EQ(42, entry->get_key_id());
+  EXPECT_EQ(0, factory_calls);
+
+  for (int i = 0; i < 3; i++) {
+    auto primitive_result = entry->GetOrCreatePrimitive();
+    ASSERT_TRUE(primitive_result.ok()) << primitive_result.status();
+    EXPECT_EQ(&entry->get_primitive(), primitive_result.ValueOrDie());
+    EXPECT_EQ(DummyMac("lazy MAC").ComputeMac("data").ValueOrDie(),
+              entry->get_primitive().ComputeMac("data").ValueOrDie());
+  }
+  EXPECT_EQ(1, factory_calls);
+
+  // Eager entries return their primitive.
+  key.set_key_id(43);
+  std::unique_ptr<Mac> eager_mac(new DummyMac("eager MAC"));
+  auto eager_result = mac_set.AddPrimitive(std::move(eager_mac), key);
+  ASSERT_TRUE(eager_result.ok()) << eager_result.status();
+  EXPECT_FALSE(eager_result.ValueOrDie()->is_lazy());
+  auto eager_primitive_result =
+      eager_result.ValueOrDie()->GetOrCreatePrimitive();
+  ASSERT_TRUE(eager_primitive_result.ok());
+  EXPECT_EQ(&eager_result.ValueOrDie()->get_primitive(),
+            eager_primitive_result.ValueOrDie());
+}
+
+TEST_F(PrimitiveSetTest, LazyPrimitiveFailure) {
+  PrimitiveSet<Mac> mac_set;
+  Keyset::Key key;
+  key.set_output_prefix_type(OutputPrefixType::RAW);
+  key.set_key_id(42);
+  key.set_status(KeyStatusType::ENABLED);
+  int factory_calls = 0;
+  auto add_result = mac_set.AddLazyPrimitive(
+      [&factory_calls]() -> util::StatusOr<std::unique_ptr<Mac>> {
+        factory_calls++;
+        return util::Status(util::error::INVALID_ARGUMENT, "bad key");
+      },
+      key);
+  ASSERT_TRUE(add_result.ok()) << add_result.status();
+  for (int i = 0; i < 3; i++) {
+    auto primitive_result = add_result.ValueOrDie()->GetOrCreatePrimitive();
+    EXPECT_FALSE(primitive_result.ok());
+    EXPECT_EQ(util::error::INVALID_ARGUMENT,
+              primitive_result.status().error_code());
+  }
+  EXPECT_EQ(1, factory_calls);
+
+  // Null factories are rejected.
+  EXPECT_FALSE(mac_set.AddLazyPrimitive(nullptr, key).ok());
+}
+
+TEST_F(PrimitiveSetTest, LazyPrimitiveConcurrentCreation) {
+  PrimitiveSet<Mac> mac_set;
+  Keyset::Key key;
+  key.set_output_prefix_type(OutputPrefixType::TINK);
+  key.set_key_id(42);
+  key.set_status(KeyStatusType::ENABLED);
+  std::atomic<int> factory_calls(0);
+  auto add_result = mac_set.AddLazyPrimitive(
+      [&factory_calls]() -> util::StatusOr<std::unique_ptr<Mac>> {
+        factory_calls++;
+        return std::unique_ptr<Mac>(new DummyMac("lazy MAC"));
+      },
+      key);
+  ASSERT_TRUE(add_result.ok()) << add_result.status();
+  auto entry = add_result.ValueOrDie();
+
+  const int kThreads = 8;
+  std::vector<Mac*> created(kThreads, nullptr);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreads; i++) {
+    threads.emplace_back([entry, &created, i]() {
+      auto primitive_result = entry->GetOrCreatePrimitive();
+      if (primitive_result.ok()) created[i] = primitive_result.ValueOrDie();
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  EXPECT_EQ(1, factory_calls.load());
+  for (int i = 0; i < kThreads; i++) {
+    EXPECT_EQ(&entry->get_primitive(), created[i]);
+  }
+}
+
 }  // namespace
 }  // namespace tink
 }  // namespace crypto
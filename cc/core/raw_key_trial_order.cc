@@ -0,0 +1,74 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/raw_key_trial_order.h"
+
+#include <atomic>
+
+namespace crypto {
+namespace tink {
+
+namespace {
+
+thread_local const RawKeyHint* current_hint = nullptr;
+
+std::atomic<int> next_shard(0);
+
+}  // namespace
+
+constexpr int RawKeyTrialOrder::kShards;
+constexpr int RawKeyTrialOrder::kRecentKeys;
+
+RawKeyHint::RawKeyHint(uint32_t key_id)
+    : key_id_(key_id), previous_(current_hint) {
+  current_hint = this;
+}
+
+RawKeyHint::~RawKeyHint() { current_hint = previous_; }
+
+// static
+const RawKeyHint* RawKeyHint::Current() { return current_hint; }
+
+int RawKeyTrialOrder::HintedIndex() const {
+  const RawKeyHint* hint = RawKeyHint::Current();
+  if (hint == nullptr) return -1;
+  auto found = index_by_key_id_.find(hint->key_id());
+  if (found == index_by_key_id_.end()) return -1;
+  return found->second;
+}
+
+RawKeyTrialOrder::Shard& RawKeyTrialOrder::CurrentShard() const {
+  thread_local int shard_index =
+      next_shard.fetch_add(1, std::memory_order_relaxed) % kShards;
+  return shards_[shard_index];
+}
+
+void RawKeyTrialOrder::RecordSuccess(int index) const {
+  Shard& shard = CurrentShard();
+  if (shard.recent[0].load(std::memory_order_relaxed) == index) return;
+  // Shift the entries before 'index' (or all of them, if 'index' is not
+  // among them) one position back, and put 'index' in front.
+  int previous = index;
+  for (int i = 0; i < kRecentKeys; i++) {
+    int current = shard.recent[i].load(std::memory_order_relaxed);
+    shard.recent[i].store(previous, std::memory_order_relaxed);
+    if (current == index) break;
+    previous = current;
+  }
+}
+
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,154 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/raw_key_trial_order.h"
+
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "tink/mac.h"
+#include "tink/primitive_set.h"
+#include "tink/util/test_util.h"
+#include "proto/tink.pb.h"
+
+namespace crypto {
+namespace tink {
+namespace {
+
+using ::crypto::tink::test::DummyMac;
+using ::google::crypto::tink::KeyStatusType;
+using ::google::crypto::tink::Keyset;
+using ::google::crypto::tink::OutputPrefixType;
+
+// Returns a primitive set with RAW keys with ids 100, 101, ...
+std::unique_ptr<PrimitiveSet<Mac>> NewRawSet(int num_keys) {
+  auto mac_set = absl::make_unique<PrimitiveSet<Mac>>();
+  for (int i = 0; i < num_keys; i++) {
+    Keyset::Key key;
+    key.set_output_prefix_type(OutputPrefixType::RAW);
+    key.set_key_id(100 + i);
+    key.set_status(KeyStatusType::ENABLED);
+    auto add_result =
+        mac_set->AddPrimitive(absl::make_unique<DummyMac>("mac"), key);
+    EXPECT_TRUE(add_result.ok()) << add_result.status();
+  }
+  return mac_set;
+}
+
+// Runs TryKeys() where only 'good_index' succeeds, and returns the indexes
+// in the order in which they were tried.
+std::vector<int> Trials(const RawKeyTrialOrder& order, int good_index) {
+  std::vector<int> trials;
+  int index = order.TryKeys([&trials, good_index](int i) {
+    trials.push_back(i);
+    return i == good_index;
+  });
+  EXPECT_EQ(good_index, index);
+  return trials;
+}
+
+TEST(RawKeyTrialOrderTest, NoRawKeys) {
+  auto mac_set = absl::make_unique<PrimitiveSet<Mac>>();
+  EXPECT_EQ(nullptr, RawPrimitivesOrNull(mac_set.get()));
+  RawKeyTrialOrder order(RawPrimitivesOrNull(mac_set.get()));
+  EXPECT_EQ(-1, order.TryKeys([](int i) { return true; }));
+}
+
+TEST(RawKeyTrialOrderTest, SetOrderInitially) {
+  auto mac_set = NewRawSet(4);
+  RawKeyTrialOrder order(RawPrimitivesOrNull(mac_set.get()));
+  EXPECT_EQ(std::vector<int>({0, 1, 2, 3}), Trials(order, -1));
+  EXPECT_EQ(std::vector<int>({0, 1, 2}), Trials(order, 2));
+}
+
+TEST(RawKeyTrialOrderTest, MostRecentlySuccessfulFirst) {
+  auto mac_set = NewRawSet(6);
+  RawKeyTrialOrder order(RawPrimitivesOrNull(mac_set.get()));
+  Trials(order, 5);
+  EXPECT_EQ(std::vector<int>({5}), Trials(order, 5));
+  EXPECT_EQ(std::vector<int>({5, 0, 1, 2, 3}), Trials(order, 3));
+  EXPECT_EQ(std::vector<int>({3, 5}), Trials(order, 5));
+  EXPECT_EQ(std::vector<int>({5, 3, 0, 1, 2, 4}), Trials(order, -1));
+}
+
+TEST(RawKeyTrialOrderTest, RecentKeysAreBounded) {
+  const int kNumKeys = RawKeyTrialOrder::kRecentKeys + 2;
+  auto mac_set = NewRawSet(kNumKeys);
+  RawKeyTrialOrder order(RawPrimitivesOrNull(mac_set.get()));
+  for (int i = 0; i < kNumKeys; i++) Trials(order, i);
+  // Key 0 and 1 were evicted from the recent keys.
+  auto trials = Trials(order, 0);
+  EXPECT_EQ(RawKeyTrialOrder::kRecentKeys + 1, trials.size());
+  EXPECT_EQ(kNumKeys - 1, trials[0]);
+}
+
+TEST(RawKeyTrialOrderTest, Hint) {
+  auto mac_set = NewRawSet(4);
+  RawKeyTrialOrder order(RawPrimitivesOrNull(mac_set.get()));
+  EXPECT_EQ(nullptr, RawKeyHint::Current());
+  {
+    RawKeyHint hint(102);
+    EXPECT_EQ(&hint, RawKeyHint::Current());
+    EXPECT_EQ(std::vector<int>({2}), Trials(order, 2));
+    {
+      RawKeyHint inner_hint(103);
+      EXPECT_EQ(103, RawKeyHint::Current()->key_id());
+      EXPECT_EQ(std::vector<int>({3, 2, 0}), Trials(order, 0));
+    }
+    EXPECT_EQ(102, RawKeyHint::Current()->key_id());
+  }
+  EXPECT_EQ(nullptr, RawKeyHint::Current());
+  {
+    // Unknown key ids are ignored.
+    RawKeyHint hint(42);
+    EXPECT_EQ(std::vector<int>({0}), Trials(order, 0));
+  }
+}
+
+TEST(RawKeyTrialOrderTest, HintIsPerThread) {
+  RawKeyHint hint(101);
+  std::thread thread([]() { EXPECT_EQ(nullptr, RawKeyHint::Current()); });
+  thread.join();
+}
+
+TEST(RawKeyTrialOrderTest, ConcurrentTrials) {
+  const int kNumKeys = 20;
+  auto mac_set = NewRawSet(kNumKeys);
+  RawKeyTrialOrder order(RawPrimitivesOrNull(mac_set.get()));
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; t++) {
+    threads.emplace_back([&order, t]() {
+      for (int i = 0; i < 1000; i++) {
+        int good_index = (t + i) % kNumKeys;
+        std::vector<bool> tried(kNumKeys, false);
+        int index = order.TryKeys([&tried, good_index](int index_to_try) {
+          // Every index is tried at most once.
+          EXPECT_FALSE(tried[index_to_try]);
+          tried[index_to_try] = true;
+          return index_to_try == good_index;
+        });
+        EXPECT_EQ(good_index, index);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+}
+
+}  // namespace
+}  // namespace tink
+}  // namespace crypto
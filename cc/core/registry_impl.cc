@@ -69,6 +69,8 @@ void RegistryImpl::Reset() {
   type_url_to_info_.clear();
   name_to_catalogue_map_.clear();
   primitive_to_wrapper_.clear();
+  // Key managers registered later may build different primitives.
+  PrimitiveInternCache::Global().Clear();
 }
 
 }  // namespace tink
@@ -25,6 +25,7 @@
 #include "tink/catalogue.h"
 #include "tink/core/registry_impl.h"
 #include "tink/key_manager.h"
+#include "tink/primitive_intern_cache.h"
 #include "tink/primitive_set.h"
 #include "tink/primitive_wrapper.h"
 #include "tink/util/errors.h"
@@ -307,7 +308,14 @@ crypto::tink::util::StatusOr<std::unique_ptr<P>> RegistryImpl::GetPrimitive(
     const google::crypto::tink::KeyData& key_data) const {
   auto key_manager_result = get_key_manager<P>(key_data.type_url());
   if (key_manager_result.ok()) {
-    return key_manager_result.ValueOrDie()->GetPrimitive(key_data);
+    const KeyManager<P>* key_manager = key_manager_result.ValueOrDie();
+    // Shares the primitive with the other users of 'key_data', if interning
+    // is enabled.
+    return PrimitiveInternCache::Global().GetOrCreate<P>(
+        key_data,
+        [key_manager, &key_data]() {
+          return key_manager->GetPrimitive(key_data);
+        });
   }
   return key_manager_result.status();
 }
@@ -0,0 +1,140 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/reloading_primitive.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "tink/aead.h"
+#include "tink/aead/aead_config.h"
+#include "tink/aead/aead_key_templates.h"
+#include "tink/keyset_handle.h"
+#include "tink/keyset_reloader.h"
+#include "tink/util/keyset_util.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "proto/tink.pb.h"
+
+namespace crypto {
+namespace tink {
+namespace {
+
+using google::crypto::tink::Keyset;
+
+class ReloadingPrimitiveTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    auto status = AeadConfig::Register();
+    ASSERT_TRUE(status.ok()) << status;
+    Rotate();
+  }
+
+  // Replaces the keyset of the source with a fresh one.
+  void Rotate() {
+    auto handle =
+        std::move(KeysetHandle::GenerateNew(AeadKeyTemplates::Aes128Gcm())
+                      .ValueOrDie());
+    absl::MutexLock lock(&mutex_);
+    keyset_ = KeysetUtil::GetKeyset(*handle);
+  }
+
+  KeysetReloader::Loader GetLoader() {
+    KeysetReloader::Loader loader;
+    loader.read = [this]() -> util::StatusOr<std::string> {
+      absl::MutexLock lock(&mutex_);
+      return keyset_.SerializeAsString();
+    };
+    loader.parse = [](absl::string_view serialized)
+        -> util::StatusOr<std::unique_ptr<KeysetHandle>> {
+      Keyset keyset;
+      if (!keyset.ParseFromArray(serialized.data(), serialized.size())) {
+        return util::Status(util::error::INVALID_ARGUMENT,
+                            "could not parse keyset");
+      }
+      return KeysetUtil::GetKeysetHandle(keyset);
+    };
+    return loader;
+  }
+
+  absl::Mutex mutex_;
+  Keyset keyset_ GUARDED_BY(mutex_);
+};
+
+TEST_F(ReloadingPrimitiveTest, Rotation) {
+  auto reloading_result =
+      ReloadingPrimitive<Aead>::New(GetLoader(), absl::ZeroDuration());
+  ASSERT_TRUE(reloading_result.ok()) << reloading_result.status();
+  auto reloading = std::move(reloading_result.ValueOrDie());
+
+  std::shared_ptr<Aead> old_aead = reloading->Get();
+  std::string old_ciphertext =
+      old_aead->Encrypt("plaintext", "ad").ValueOrDie();
+
+  // Reloading an unchanged keyset keeps the primitive.
+  EXPECT_TRUE(reloading->Reload().ok());
+  EXPECT_EQ(old_aead, reloading->Get());
+
+  Rotate();
+  EXPECT_TRUE(reloading->Reload().ok());
+  std::shared_ptr<Aead> new_aead = reloading->Get();
+  EXPECT_NE(old_aead, new_aead);
+  EXPECT_FALSE(new_aead->Decrypt(old_ciphertext, "ad").ok());
+  // The old primitive remains usable by whoever still holds it.
+  EXPECT_EQ("plaintext", old_aead->Decrypt(old_ciphertext, "ad").ValueOrDie());
+
+  auto stats = reloading->GetStats();
+  EXPECT_EQ(3, stats.reload_count);
+  EXPECT_EQ(2, stats.publish_count);
+}
+
+TEST_F(ReloadingPrimitiveTest, ConcurrentUseDuringReloads) {
+  auto reloading = std::move(
+      ReloadingPrimitive<Aead>::New(GetLoader(), absl::Milliseconds(1))
+          .ValueOrDie());
+  std::atomic<bool> stop(false);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&reloading, &stop]() {
+      while (!stop) {
+        std::shared_ptr<Aead> aead = reloading->Get();
+        auto ciphertext = aead->Encrypt("plaintext", "ad");
+        ASSERT_TRUE(ciphertext.ok()) << ciphertext.status();
+        auto plaintext = aead->Decrypt(ciphertext.ValueOrDie(), "ad");
+        ASSERT_TRUE(plaintext.ok()) << plaintext.status();
+        EXPECT_EQ("plaintext", plaintext.ValueOrDie());
+      }
+    });
+  }
+  for (int i = 0; i < 20; i++) {
+    Rotate();
+    EXPECT_TRUE(reloading->Reload().ok());
+  }
+  stop = true;
+  for (auto& thread : threads) thread.join();
+  EXPECT_LE(21, reloading->GetStats().publish_count);
+}
+
+}  // namespace
+}  // namespace tink
+}  // namespace crypto
@@ -19,6 +19,7 @@
 
 #include <vector>
 
+#include "absl/strings/string_view.h"
 #include "tink/util/statusor.h"
 #include "proto/tink.pb.h"
 
@@ -35,6 +36,9 @@ class CryptoFormat {
   // Legacy prefix starts with \x00 and followed by a 4-byte key id.
   static const int kLegacyPrefixSize = kNonRawPrefixSize;
   static const uint8_t kLegacyStartByte = 0x00;
+  // Signatures and MACs of Legacy keys are computed over the data followed
+  // by kLegacyStartByte, i.e. by this one-byte suffix.
+  static const absl::string_view kLegacySuffix;
 
   // Tink prefix starts with \x01 and followed by a 4-byte key id.
   static const int kTinkPrefixSize = kNonRawPrefixSize;
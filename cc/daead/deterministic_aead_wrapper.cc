@@ -18,7 +18,9 @@
 
 #include "tink/crypto_format.h"
 #include "tink/deterministic_aead.h"
+#include "tink/monitoring/monitoring.h"
 #include "tink/primitive_set.h"
+#include "tink/raw_key_trial_order.h"
 #include "tink/subtle/subtle_util_boringssl.h"
 #include "tink/util/status.h"
 #include "tink/util/statusor.h"
@@ -43,7 +45,10 @@ class  DeterministicAeadSetWrapper : public DeterministicAead {
  public:
   explicit DeterministicAeadSetWrapper(
       std::unique_ptr<PrimitiveSet<DeterministicAead>> daead_set)
-      : daead_set_(std::move(daead_set)) {}
+      : daead_set_(std::move(daead_set)),
+        raw_primitives_(RawPrimitivesOrNull(daead_set_.get())),
+        raw_key_trial_order_(raw_primitives_),
+        monitoring_sink_(Monitoring::GetSink()) {}
 
   crypto::tink::util::StatusOr<std::string> EncryptDeterministically(
       absl::string_view plaintext,
@@ -57,6 +62,9 @@ class  DeterministicAeadSetWrapper : public DeterministicAead {
 
  private:
   std::unique_ptr<PrimitiveSet<DeterministicAead>> daead_set_;
+  const PrimitiveSet<DeterministicAead>::Primitives* raw_primitives_;
+  RawKeyTrialOrder raw_key_trial_order_;
+  std::shared_ptr<MonitoringSink> monitoring_sink_;
 };
 
 util::StatusOr<std::string> DeterministicAeadSetWrapper::EncryptDeterministically(
@@ -65,12 +73,20 @@ util::StatusOr<std::string> DeterministicAeadSetWrapper::EncryptDeterministicall
   // regardless of whether the size is 0.
   plaintext = subtle::SubtleUtilBoringSSL::EnsureNonNull(plaintext);
   associated_data = subtle::SubtleUtilBoringSSL::EnsureNonNull(associated_data);
+  MonitoredOperation operation(monitoring_sink_.get(), "daead",
+                               MonitoringOperation::kEncrypt,
+                               plaintext.size());
 
+  auto primary = daead_set_->get_primary();
   auto encrypt_result =
-      daead_set_->get_primary()->get_primitive().EncryptDeterministically(
+      primary->get_primitive().EncryptDeterministically(
           plaintext, associated_data);
-  if (!encrypt_result.ok()) return encrypt_result.status();
-  const std::string& key_id = daead_set_->get_primary()->get_identifier();
+  if (!encrypt_result.ok()) {
+    operation.RecordFailure(primary->get_key_id());
+    return encrypt_result.status();
+  }
+  operation.RecordSuccess(primary->get_key_id());
+  const std::string& key_id = primary->get_identifier();
   return key_id + encrypt_result.ValueOrDie();
 }
 
@@ -79,6 +95,9 @@ util::StatusOr<std::string> DeterministicAeadSetWrapper::DecryptDeterministicall
   // BoringSSL expects a non-null pointer for plaintext and additional_data,
   // regardless of whether the size is 0.
   associated_data = subtle::SubtleUtilBoringSSL::EnsureNonNull(associated_data);
+  MonitoredOperation operation(monitoring_sink_.get(), "daead",
+                               MonitoringOperation::kDecrypt,
+                               ciphertext.size());
 
   if (ciphertext.length() > CryptoFormat::kNonRawPrefixSize) {
     const std::string& key_id = std::string(
@@ -88,10 +107,13 @@ util::StatusOr<std::string> DeterministicAeadSetWrapper::DecryptDeterministicall
       absl::string_view raw_ciphertext =
           ciphertext.substr(CryptoFormat::kNonRawPrefixSize);
       for (auto& daead_entry : *(primitives_result.ValueOrDie())) {
-        DeterministicAead& daead = daead_entry->get_primitive();
+        auto daead_result = daead_entry->GetOrCreatePrimitive();
+        if (!daead_result.ok()) continue;
+        DeterministicAead& daead = *daead_result.ValueOrDie();
         auto decrypt_result =
             daead.DecryptDeterministically(raw_ciphertext, associated_data);
         if (decrypt_result.ok()) {
+          operation.RecordSuccess(daead_entry->get_key_id());
           return std::move(decrypt_result.ValueOrDie());
         } else {
           // LOG that a matching key didn't decrypt the ciphertext.
@@ -101,18 +123,26 @@ util::StatusOr<std::string> DeterministicAeadSetWrapper::DecryptDeterministicall
   }
 
   // No matching key succeeded with decryption, try all RAW keys.
-  auto raw_primitives_result = daead_set_->get_raw_primitives();
-  if (raw_primitives_result.ok()) {
-    for (auto& daead_entry : *(raw_primitives_result.ValueOrDie())) {
-      DeterministicAead& daead = daead_entry->get_primitive();
-      auto decrypt_result =
-          daead.DecryptDeterministically(ciphertext, associated_data);
-      if (decrypt_result.ok()) {
-        return std::move(decrypt_result.ValueOrDie());
-      }
-    }
+  std::string plaintext;
+  int index = raw_key_trial_order_.TryKeys([&](int i) {
+    operation.AddRawTrial();
+    auto daead_result = (*raw_primitives_)[i]->GetOrCreatePrimitive();
+    if (!daead_result.ok()) return false;
+    auto decrypt_result = daead_result.ValueOrDie()->DecryptDeterministically(
+        ciphertext, associated_data);
+    if (!decrypt_result.ok()) return false;
+    plaintext = std::move(decrypt_result.ValueOrDie());
+    return true;
+  });
+  if (index >= 0) {
+    operation.RecordSuccess((*raw_primitives_)[index]->get_key_id());
+    return std::move(plaintext);
   }
-  return util::Status(util::error::INVALID_ARGUMENT, "decryption failed");
+  operation.RecordFailure();
+  static const util::StaticStatus* kDecryptionFailed =
+      new util::StaticStatus(util::error::INVALID_ARGUMENT,
+                             "decryption failed");
+  return *kDecryptionFailed;
 }
 
 }  // anonymous namespace
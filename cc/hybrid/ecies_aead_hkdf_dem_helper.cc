@@ -21,6 +21,7 @@
 #include "tink/key_manager.h"
 #include "tink/registry.h"
 #include "tink/util/protobuf_helper.h"
+#include "tink/util/secret_data.h"
 #include "tink/util/statusor.h"
 #include "proto/aes_ctr_hmac_aead.pb.h"
 #include "proto/aes_gcm.pb.h"
@@ -51,6 +52,8 @@ StatusOr<std::unique_ptr<EciesAeadHkdfDemHelper>> EciesAeadHkdfDemHelper::New(
                     "Invalid AesGcmKeyFormat in DEM key template");
     }
     helper->dem_key_size_in_bytes_ = key_format.key_size();
+    // AES-GCM DEMs use 12-byte IVs and 16-byte tags.
+    helper->dem_ciphertext_overhead_in_bytes_ = 12 + 16;
   } else if (dem_type_url ==
              "type.googleapis.com/google.crypto.tink.AesCtrHmacAeadKey") {
     helper->dem_key_type_ = AES_CTR_HMAC_AEAD_KEY;
@@ -63,6 +66,9 @@ StatusOr<std::unique_ptr<EciesAeadHkdfDemHelper>> EciesAeadHkdfDemHelper::New(
         key_format.aes_ctr_key_format().key_size();
     helper->dem_key_size_in_bytes_ = helper->aes_ctr_key_size_in_bytes_ +
                                      key_format.hmac_key_format().key_size();
+    helper->dem_ciphertext_overhead_in_bytes_ =
+        key_format.aes_ctr_key_format().params().iv_size() +
+        key_format.hmac_key_format().params().tag_size();
   } else {
     return ToStatusF(util::error::INVALID_ARGUMENT,
                      "Unsupported DEM key type '%s'.", dem_type_url.c_str());
@@ -78,7 +84,7 @@ StatusOr<std::unique_ptr<EciesAeadHkdfDemHelper>> EciesAeadHkdfDemHelper::New(
 }
 
 StatusOr<std::unique_ptr<Aead>> EciesAeadHkdfDemHelper::GetAead(
-    const std::string& symmetric_key_value) const {
+    const util::SecretData& symmetric_key_value) const {
   if (symmetric_key_value.size() != dem_key_size_in_bytes_) {
     return Status(util::error::INTERNAL, "Wrong length of symmetric key.");
   }
@@ -87,29 +93,54 @@ StatusOr<std::unique_ptr<Aead>> EciesAeadHkdfDemHelper::GetAead(
   if (!new_key_result.ok()) return new_key_result.status();
   auto new_key = std::move(new_key_result.ValueOrDie());
   if (!ReplaceKeyBytes(symmetric_key_value, new_key.get())) {
+    ZeroKeyBytes(new_key.get());
     return Status(util::error::INTERNAL, "Generation of DEM-key failed.");
   }
-  return dem_key_manager_->GetPrimitive(*new_key);
+  auto aead_result = dem_key_manager_->GetPrimitive(*new_key);
+  ZeroKeyBytes(new_key.get());
+  return aead_result;
 }
 
 bool EciesAeadHkdfDemHelper::ReplaceKeyBytes(
-    const std::string& key_bytes, portable_proto::MessageLite* proto) const {
+    const util::SecretData& key_bytes,
+    portable_proto::MessageLite* proto) const {
+  absl::string_view key_view = util::SecretDataAsStringView(key_bytes);
   if (dem_key_type_ == AES_GCM_KEY) {
     AesGcmKey* key = static_cast<AesGcmKey*>(proto);
-    key->set_key_value(key_bytes);
+    // Zero the random key set by NewKey() before it is replaced, since
+    // set_key_value() may free its buffer.
+    util::SafeZeroString(key->mutable_key_value());
+    key->mutable_key_value()->assign(key_view.data(), key_view.size());
     return true;
   } else if (dem_key_type_ == AES_CTR_HMAC_AEAD_KEY) {
     AesCtrHmacAeadKey* key = static_cast<AesCtrHmacAeadKey*>(proto);
     auto aes_ctr_key = key->mutable_aes_ctr_key();
-    aes_ctr_key->set_key_value(key_bytes.substr(0, aes_ctr_key_size_in_bytes_));
+    util::SafeZeroString(aes_ctr_key->mutable_key_value());
+    absl::string_view aes_ctr_key_value =
+        key_view.substr(0, aes_ctr_key_size_in_bytes_);
+    aes_ctr_key->mutable_key_value()->assign(aes_ctr_key_value.data(),
+                                             aes_ctr_key_value.size());
     auto hmac_key = key->mutable_hmac_key();
-    hmac_key->set_key_value(
-        key_bytes.substr(aes_ctr_key_size_in_bytes_,
-                         key_bytes.size() - aes_ctr_key_size_in_bytes_));
+    util::SafeZeroString(hmac_key->mutable_key_value());
+    absl::string_view hmac_key_value =
+        key_view.substr(aes_ctr_key_size_in_bytes_);
+    hmac_key->mutable_key_value()->assign(hmac_key_value.data(),
+                                          hmac_key_value.size());
     return true;
   }
   return false;
 }
 
+void EciesAeadHkdfDemHelper::ZeroKeyBytes(
+    portable_proto::MessageLite* proto) const {
+  if (dem_key_type_ == AES_GCM_KEY) {
+    util::SafeZeroString(static_cast<AesGcmKey*>(proto)->mutable_key_value());
+  } else if (dem_key_type_ == AES_CTR_HMAC_AEAD_KEY) {
+    AesCtrHmacAeadKey* key = static_cast<AesCtrHmacAeadKey*>(proto);
+    util::SafeZeroString(key->mutable_aes_ctr_key()->mutable_key_value());
+    util::SafeZeroString(key->mutable_hmac_key()->mutable_key_value());
+  }
+}
+
 }  // namespace tink
 }  // namespace crypto
@@ -21,6 +21,7 @@
 #include "tink/aead.h"
 #include "tink/key_manager.h"
 #include "tink/util/protobuf_helper.h"
+#include "tink/util/secret_data.h"
 #include "tink/util/statusor.h"
 #include "proto/tink.pb.h"
 
@@ -40,11 +41,17 @@ class EciesAeadHkdfDemHelper {
     return dem_key_size_in_bytes_;
   }
 
+  // Returns the number of bytes that the DEM adds to each plaintext,
+  // i.e. the sizes of its IV and of its tag.
+  uint32_t dem_ciphertext_overhead_in_bytes() const {
+    return dem_ciphertext_overhead_in_bytes_;
+  }
+
   // Creates and returns a new Aead-primitive that uses
   // the key material given in 'symmetric_key', which must
   // be of length dem_key_size_in_bytes().
   crypto::tink::util::StatusOr<std::unique_ptr<Aead>> GetAead(
-      const std::string& symmetric_key_value) const;
+      const util::SecretData& symmetric_key_value) const;
 
  private:
   enum DemKeyType {
@@ -57,12 +64,16 @@ class EciesAeadHkdfDemHelper {
       const google::crypto::tink::KeyTemplate& dem_key_template)
       : dem_key_template_(dem_key_template) {}
 
-  bool ReplaceKeyBytes(const std::string& key_bytes,
+  bool ReplaceKeyBytes(const util::SecretData& key_bytes,
                        portable_proto::MessageLite* key) const;
 
+  // Zeroes the key bytes in 'key', once the primitive has been created.
+  void ZeroKeyBytes(portable_proto::MessageLite* key) const;
+
   google::crypto::tink::KeyTemplate dem_key_template_;
   DemKeyType dem_key_type_;
   uint32_t dem_key_size_in_bytes_;
+  uint32_t dem_ciphertext_overhead_in_bytes_;
   uint32_t aes_ctr_key_size_in_bytes_ = 0;
   const KeyManager<Aead>* dem_key_manager_;  // not owned
 };
@@ -0,0 +1,128 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/hybrid/ecies_aead_hkdf_multi_recipient_decrypt.h"
+
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "tink/aead.h"
+#include "tink/hybrid_decrypt.h"
+#include "tink/hybrid/ecies_aead_hkdf_dem_helper.h"
+#include "tink/subtle/ec_util.h"
+#include "tink/subtle/ecies_hkdf_recipient_kem_boringssl.h"
+#include "tink/util/enums.h"
+#include "tink/util/secret_data.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "proto/ecies_aead_hkdf.pb.h"
+
+using google::crypto::tink::EciesAeadHkdfPrivateKey;
+
+namespace crypto {
+namespace tink {
+
+// static
+util::StatusOr<std::unique_ptr<HybridDecrypt>>
+EciesAeadHkdfMultiRecipientDecrypt::New(
+    const EciesAeadHkdfPrivateKey& recipient_key) {
+  util::Status status = Validate(recipient_key);
+  if (!status.ok()) return status;
+  const auto& params = recipient_key.public_key().params();
+
+  auto kem_result = subtle::EciesHkdfRecipientKemBoringSsl::New(
+      util::Enums::ProtoToSubtle(params.kem_params().curve_type()),
+      recipient_key.key_value());
+  if (!kem_result.ok()) return kem_result.status();
+
+  auto dem_result =
+      EciesAeadHkdfDemHelper::New(params.dem_params().aead_dem());
+  if (!dem_result.ok()) return dem_result.status();
+
+  auto kem_bytes_size_result = subtle::EcUtil::EncodingSizeInBytes(
+      util::Enums::ProtoToSubtle(params.kem_params().curve_type()),
+      util::Enums::ProtoToSubtle(params.ec_point_format()));
+  if (!kem_bytes_size_result.ok()) return kem_bytes_size_result.status();
+
+  std::unique_ptr<HybridDecrypt> hybrid_decrypt(
+      new EciesAeadHkdfMultiRecipientDecrypt(
+          recipient_key, std::move(kem_result.ValueOrDie()),
+          std::move(dem_result.ValueOrDie()),
+          kem_bytes_size_result.ValueOrDie()));
+  return std::move(hybrid_decrypt);
+}
+
+util::StatusOr<std::string> EciesAeadHkdfMultiRecipientDecrypt::Decrypt(
+    absl::string_view ciphertext, absl::string_view context_info) const {
+  // The header is the KEM bytes and the encrypted DEM key.
+  size_t header_size = kem_bytes_size_ +
+                       dem_helper_->dem_key_size_in_bytes() +
+                       dem_helper_->dem_ciphertext_overhead_in_bytes();
+  if (ciphertext.size() < header_size) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+                        "ciphertext too short");
+  }
+  auto dem_key_result =
+      DecryptDemKey(ciphertext.substr(0, header_size), context_info);
+  if (!dem_key_result.ok()) return dem_key_result.status();
+
+  // Use the DEM key to decrypt the payload.
+  auto aead_result = dem_helper_->GetAead(dem_key_result.ValueOrDie());
+  if (!aead_result.ok()) return aead_result.status();
+  return aead_result.ValueOrDie()->Decrypt(ciphertext.substr(header_size),
+                                           "");  // empty aad
+}
+
+util::StatusOr<util::SecretData>
+EciesAeadHkdfMultiRecipientDecrypt::DecryptDemKey(
+    absl::string_view header, absl::string_view context_info) const {
+  const auto& params = recipient_key_.public_key().params();
+  // Use KEM to get a symmetric key.
+  auto symmetric_key_result = recipient_kem_->GenerateKey(
+      header.substr(0, kem_bytes_size_),
+      util::Enums::ProtoToSubtle(params.kem_params().hkdf_hash_type()),
+      params.kem_params().hkdf_salt(),
+      context_info,
+      dem_helper_->dem_key_size_in_bytes(),
+      util::Enums::ProtoToSubtle(params.ec_point_format()));
+  if (!symmetric_key_result.ok()) return symmetric_key_result.status();
+
+  // Decrypt the DEM key with the symmetric key.
+  auto aead_result = dem_helper_->GetAead(symmetric_key_result.ValueOrDie());
+  if (!aead_result.ok()) return aead_result.status();
+  auto decrypt_result = aead_result.ValueOrDie()->Decrypt(
+      header.substr(kem_bytes_size_), "");  // empty aad
+  if (!decrypt_result.ok()) return decrypt_result.status();
+  util::SecretData dem_key =
+      util::SecretDataFromStringView(decrypt_result.ValueOrDie());
+  util::SafeZeroString(&decrypt_result.ValueOrDie());
+  return std::move(dem_key);
+}
+
+// static
+util::Status EciesAeadHkdfMultiRecipientDecrypt::Validate(
+    const EciesAeadHkdfPrivateKey& key) {
+  if (!key.has_public_key() || !key.public_key().has_params()
+      || key.public_key().x().empty() || key.public_key().y().empty()
+      || key.key_value().empty()) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+          "Invalid EciesAeadHkdfPrivateKey: missing required fields.");
+  }
+  return util::Status::OK;
+}
+
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,142 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/hybrid/ecies_aead_hkdf_multi_recipient_decrypt.h"
+
+#include <memory>
+#include <string>
+
+#include "absl/memory/memory.h"
+#include "tink/aead/aes_ctr_hmac_aead_key_manager.h"
+#include "tink/aead/aes_gcm_key_manager.h"
+#include "tink/hybrid/ecies_aead_hkdf_multi_recipient_encrypt.h"
+#include "tink/hybrid_decrypt.h"
+#include "tink/registry.h"
+#include "tink/subtle/random.h"
+#include "tink/util/statusor.h"
+#include "tink/util/test_util.h"
+#include "proto/aes_ctr_hmac_aead.pb.h"
+#include "proto/common.pb.h"
+#include "proto/ecies_aead_hkdf.pb.h"
+#include "gtest/gtest.h"
+
+using crypto::tink::subtle::Random;
+using google::crypto::tink::AesCtrHmacAeadKeyFormat;
+using google::crypto::tink::EciesAeadHkdfPrivateKey;
+using google::crypto::tink::EcPointFormat;
+using google::crypto::tink::EllipticCurveType;
+using google::crypto::tink::HashType;
+
+namespace crypto {
+namespace tink {
+namespace {
+
+class EciesAeadHkdfMultiRecipientDecryptTest : public ::testing::Test {
+ protected:
+  static void SetUpTestCase() {
+    ASSERT_TRUE(Registry::RegisterKeyManager(
+                    absl::make_unique<AesGcmKeyManager>(), true)
+                    .ok());
+    ASSERT_TRUE(Registry::RegisterKeyManager(
+                    absl::make_unique<AesCtrHmacAeadKeyManager>(), true)
+                    .ok());
+  }
+
+  // Returns the ciphertext of 'plaintext' for 'key' as the only recipient.
+  static std::string Encrypt(const EciesAeadHkdfPrivateKey& key,
+                             absl::string_view plaintext) {
+    auto multi_recipient_encrypt =
+        std::move(EciesAeadHkdfMultiRecipientEncrypt::New({key.public_key()})
+                      .ValueOrDie());
+    auto ciphertext =
+        multi_recipient_encrypt->Encrypt(plaintext, "context").ValueOrDie();
+    return EciesAeadHkdfMultiRecipientEncrypt::RecipientCiphertext(ciphertext,
+                                                                   0);
+  }
+};
+
+TEST_F(EciesAeadHkdfMultiRecipientDecryptTest, InvalidKeys) {
+  EciesAeadHkdfPrivateKey recipient_key;
+  auto result = EciesAeadHkdfMultiRecipientDecrypt::New(recipient_key);
+  EXPECT_FALSE(result.ok());
+  EXPECT_EQ(util::error::INVALID_ARGUMENT, result.status().error_code());
+  EXPECT_PRED_FORMAT2(testing::IsSubstring, "missing required fields",
+                      result.status().error_message());
+}
+
+TEST_F(EciesAeadHkdfMultiRecipientDecryptTest, AesCtrHmacDem) {
+  auto key = test::GetEciesAesGcmHkdfTestKey(EllipticCurveType::NIST_P256,
+                                             EcPointFormat::UNCOMPRESSED,
+                                             HashType::SHA256, 16);
+  // Replace the AES-GCM DEM by AES-CTR-HMAC, with 16-byte IVs and tags.
+  AesCtrHmacAeadKeyFormat key_format;
+  key_format.mutable_aes_ctr_key_format()->set_key_size(16);
+  key_format.mutable_aes_ctr_key_format()->mutable_params()->set_iv_size(16);
+  key_format.mutable_hmac_key_format()->set_key_size(32);
+  key_format.mutable_hmac_key_format()->mutable_params()->set_hash(
+      HashType::SHA256);
+  key_format.mutable_hmac_key_format()->mutable_params()->set_tag_size(16);
+  auto dem = key.mutable_public_key()
+                 ->mutable_params()
+                 ->mutable_dem_params()
+                 ->mutable_aead_dem();
+  dem->set_type_url(
+      "type.googleapis.com/google.crypto.tink.AesCtrHmacAeadKey");
+  dem->set_value(key_format.SerializeAsString());
+
+  std::string plaintext = Random::GetRandomBytes(1000);
+  std::string ciphertext = Encrypt(key, plaintext);
+  auto hybrid_decrypt =
+      std::move(EciesAeadHkdfMultiRecipientDecrypt::New(key).ValueOrDie());
+  auto result = hybrid_decrypt->Decrypt(ciphertext, "context");
+  ASSERT_TRUE(result.ok()) << result.status();
+  EXPECT_EQ(plaintext, result.ValueOrDie());
+}
+
+TEST_F(EciesAeadHkdfMultiRecipientDecryptTest, InvalidCiphertexts) {
+  auto key = test::GetEciesAesGcmHkdfTestKey(EllipticCurveType::NIST_P256,
+                                             EcPointFormat::UNCOMPRESSED,
+                                             HashType::SHA256, 32);
+  auto hybrid_decrypt =
+      std::move(EciesAeadHkdfMultiRecipientDecrypt::New(key).ValueOrDie());
+  std::string ciphertext = Encrypt(key, "some plaintext");
+  ASSERT_TRUE(hybrid_decrypt->Decrypt(ciphertext, "context").ok());
+
+  {  // Too short for a header.
+    auto result = hybrid_decrypt->Decrypt(ciphertext.substr(0, 100),
+                                          "context");
+    EXPECT_FALSE(result.ok());
+    EXPECT_EQ(util::error::INVALID_ARGUMENT, result.status().error_code());
+    EXPECT_PRED_FORMAT2(testing::IsSubstring, "ciphertext too short",
+                        result.status().error_message());
+  }
+
+  // Every modified byte, in the header or in the payload, is detected.
+  for (size_t i = 0; i < ciphertext.size(); i++) {
+    std::string modified = ciphertext;
+    modified[i] ^= 1;
+    EXPECT_FALSE(hybrid_decrypt->Decrypt(modified, "context").ok())
+        << "at " << i;
+  }
+  EXPECT_FALSE(
+      hybrid_decrypt->Decrypt(ciphertext.substr(0, ciphertext.size() - 1),
+                              "context")
+          .ok());
+}
+
+}  // namespace
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,147 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/hybrid/ecies_aead_hkdf_multi_recipient_encrypt.h"
+
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/types/span.h"
+#include "tink/aead.h"
+#include "tink/hybrid/ecies_aead_hkdf_dem_helper.h"
+#include "tink/subtle/ecies_hkdf_sender_kem_boringssl.h"
+#include "tink/subtle/random.h"
+#include "tink/util/enums.h"
+#include "tink/util/secret_data.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "proto/ecies_aead_hkdf.pb.h"
+
+using google::crypto::tink::EciesAeadHkdfPublicKey;
+
+namespace crypto {
+namespace tink {
+
+// static
+util::StatusOr<std::unique_ptr<EciesAeadHkdfMultiRecipientEncrypt>>
+EciesAeadHkdfMultiRecipientEncrypt::New(
+    const std::vector<EciesAeadHkdfPublicKey>& recipient_keys) {
+  if (recipient_keys.empty()) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+                        "At least one recipient key is required.");
+  }
+  std::string dem =
+      recipient_keys[0].params().dem_params().aead_dem().SerializeAsString();
+  std::vector<Recipient> recipients;
+  recipients.reserve(recipient_keys.size());
+  for (const auto& key : recipient_keys) {
+    util::Status status = Validate(key);
+    if (!status.ok()) return status;
+    if (key.params().dem_params().aead_dem().SerializeAsString() != dem) {
+      return util::Status(util::error::INVALID_ARGUMENT,
+                          "All recipient keys must have the same DEM.");
+    }
+    auto kem_result = subtle::EciesHkdfSenderKemBoringSsl::New(
+        util::Enums::ProtoToSubtle(key.params().kem_params().curve_type()),
+        key.x(), key.y());
+    if (!kem_result.ok()) return kem_result.status();
+    recipients.push_back({key, std::move(kem_result.ValueOrDie())});
+  }
+
+  auto dem_result = EciesAeadHkdfDemHelper::New(
+      recipient_keys[0].params().dem_params().aead_dem());
+  if (!dem_result.ok()) return dem_result.status();
+
+  return absl::WrapUnique(new EciesAeadHkdfMultiRecipientEncrypt(
+      std::move(recipients), std::move(dem_result.ValueOrDie())));
+}
+
+util::StatusOr<EciesAeadHkdfMultiRecipientEncrypt::Ciphertext>
+EciesAeadHkdfMultiRecipientEncrypt::Encrypt(
+    absl::string_view plaintext, absl::string_view context_info) const {
+  util::SecretData dem_key(dem_helper_->dem_key_size_in_bytes());
+  subtle::Random::GetRandomBytes(absl::MakeSpan(
+      reinterpret_cast<char*>(dem_key.data()), dem_key.size()));
+
+  // Encrypt the plaintext once, for all recipients.
+  auto aead_result = dem_helper_->GetAead(dem_key);
+  if (!aead_result.ok()) return aead_result.status();
+  auto payload_result =
+      aead_result.ValueOrDie()->Encrypt(plaintext, "");  // empty aad
+  if (!payload_result.ok()) return payload_result.status();
+
+  Ciphertext ciphertext;
+  ciphertext.payload = std::move(payload_result.ValueOrDie());
+  ciphertext.recipient_headers.reserve(recipients_.size());
+  for (const Recipient& recipient : recipients_) {
+    auto header_result = EncryptDemKey(recipient, dem_key, context_info);
+    if (!header_result.ok()) return header_result.status();
+    ciphertext.recipient_headers.push_back(
+        std::move(header_result.ValueOrDie()));
+  }
+  return std::move(ciphertext);
+}
+
+util::StatusOr<std::string> EciesAeadHkdfMultiRecipientEncrypt::EncryptDemKey(
+    const Recipient& recipient, const util::SecretData& dem_key,
+    absl::string_view context_info) const {
+  // Use KEM to get a symmetric key.
+  auto kem_key_result = recipient.kem->GenerateKey(
+      util::Enums::ProtoToSubtle(
+          recipient.key.params().kem_params().hkdf_hash_type()),
+      recipient.key.params().kem_params().hkdf_salt(),
+      context_info,
+      dem_helper_->dem_key_size_in_bytes(),
+      util::Enums::ProtoToSubtle(recipient.key.params().ec_point_format()));
+  if (!kem_key_result.ok()) return kem_key_result.status();
+  auto kem_key = std::move(kem_key_result.ValueOrDie());
+
+  // Encrypt the DEM key with the symmetric key.
+  auto aead_result = dem_helper_->GetAead(kem_key->get_symmetric_key());
+  if (!aead_result.ok()) return aead_result.status();
+  auto encrypt_result = aead_result.ValueOrDie()->Encrypt(
+      util::SecretDataAsStringView(dem_key), "");  // empty aad
+  if (!encrypt_result.ok()) return encrypt_result.status();
+
+  // Prepend the encrypted DEM key with a KEM component.
+  std::string header = kem_key->get_kem_bytes();
+  header.append(encrypt_result.ValueOrDie());
+  return header;
+}
+
+// static
+std::string EciesAeadHkdfMultiRecipientEncrypt::RecipientCiphertext(
+    const Ciphertext& ciphertext, int recipient) {
+  const std::string& header = ciphertext.recipient_headers[recipient];
+  std::string result;
+  result.reserve(header.size() + ciphertext.payload.size());
+  result.append(header);
+  result.append(ciphertext.payload);
+  return result;
+}
+
+// static
+util::Status EciesAeadHkdfMultiRecipientEncrypt::Validate(
+    const EciesAeadHkdfPublicKey& key) {
+  if (key.x().empty() || key.y().empty() || !key.has_params()) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+        "Invalid EciesAeadHkdfPublicKey: missing required fields.");
+  }
+  return util::Status::OK;
+}
+
+}  // namespace tink
+}  // namespace crypto
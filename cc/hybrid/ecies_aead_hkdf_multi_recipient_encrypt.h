@@ -0,0 +1,107 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_HYBRID_ECIES_AEAD_HKDF_MULTI_RECIPIENT_ENCRYPT_H_
+#define TINK_HYBRID_ECIES_AEAD_HKDF_MULTI_RECIPIENT_ENCRYPT_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "tink/hybrid/ecies_aead_hkdf_dem_helper.h"
+#include "tink/subtle/ecies_hkdf_sender_kem_boringssl.h"
+#include "tink/util/secret_data.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "proto/ecies_aead_hkdf.pb.h"
+
+namespace crypto {
+namespace tink {
+
+// Hybrid encryption of one plaintext for many recipients, which have
+// ECIES-AEAD-HKDF keys with the same DEM.
+//
+// The plaintext is encrypted only once, with the DEM under a random key,
+// which gives the "payload".  For each recipient that DEM key is then
+// encrypted as EciesAeadHkdfHybridEncrypt encrypts plaintexts: with the DEM
+// under a key from the ECIES KEM, which gives the recipient's "header".
+// A message thus costs one encryption of the plaintext, plus one KEM
+// operation and one encryption of a key per recipient.
+//
+// The ciphertext for a recipient is its header followed by the payload;
+// EciesAeadHkdfMultiRecipientDecrypt decrypts it with the private key of
+// the recipient.  The payload may also be sent separately, and be appended
+// to the header by the recipient.
+//
+// Like all hybrid encryption this does not authenticate the sender; note
+// that every recipient learns the DEM key, and thus could replace the
+// payload received by the others.
+class EciesAeadHkdfMultiRecipientEncrypt {
+ public:
+  struct Ciphertext {
+    // The header of each recipient, in the order of the recipient keys.
+    std::vector<std::string> recipient_headers;
+    std::string payload;
+  };
+
+  // Returns a primitive that encrypts for the recipients of
+  // 'recipient_keys', which must not be empty.
+  static crypto::tink::util::StatusOr<
+      std::unique_ptr<EciesAeadHkdfMultiRecipientEncrypt>>
+  New(const std::vector<google::crypto::tink::EciesAeadHkdfPublicKey>&
+          recipient_keys);
+
+  // Encrypts 'plaintext' for all the recipients.  'context_info' is bound
+  // to each header as in EciesAeadHkdfHybridEncrypt, and must be passed to
+  // the decryption.
+  crypto::tink::util::StatusOr<Ciphertext> Encrypt(
+      absl::string_view plaintext, absl::string_view context_info) const;
+
+  // Returns the ciphertext for the recipient with the index 'recipient'.
+  static std::string RecipientCiphertext(const Ciphertext& ciphertext,
+                                         int recipient);
+
+  int recipient_count() const { return recipients_.size(); }
+
+ private:
+  struct Recipient {
+    google::crypto::tink::EciesAeadHkdfPublicKey key;
+    std::unique_ptr<subtle::EciesHkdfSenderKemBoringSsl> kem;
+  };
+
+  static crypto::tink::util::Status Validate(
+      const google::crypto::tink::EciesAeadHkdfPublicKey& key);
+
+  EciesAeadHkdfMultiRecipientEncrypt(
+      std::vector<Recipient> recipients,
+      std::unique_ptr<EciesAeadHkdfDemHelper> dem_helper)
+      : recipients_(std::move(recipients)),
+        dem_helper_(std::move(dem_helper)) {}
+
+  // Returns the header of 'recipient' for 'dem_key'.
+  crypto::tink::util::StatusOr<std::string> EncryptDemKey(
+      const Recipient& recipient, const util::SecretData& dem_key,
+      absl::string_view context_info) const;
+
+  const std::vector<Recipient> recipients_;
+  const std::unique_ptr<EciesAeadHkdfDemHelper> dem_helper_;
+};
+
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_HYBRID_ECIES_AEAD_HKDF_MULTI_RECIPIENT_ENCRYPT_H_
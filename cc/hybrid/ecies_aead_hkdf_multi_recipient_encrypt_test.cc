@@ -0,0 +1,184 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/hybrid/ecies_aead_hkdf_multi_recipient_encrypt.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "tink/aead/aes_gcm_key_manager.h"
+#include "tink/hybrid/ecies_aead_hkdf_multi_recipient_decrypt.h"
+#include "tink/hybrid_decrypt.h"
+#include "tink/registry.h"
+#include "tink/subtle/random.h"
+#include "tink/util/statusor.h"
+#include "tink/util/test_util.h"
+#include "proto/common.pb.h"
+#include "proto/ecies_aead_hkdf.pb.h"
+#include "gtest/gtest.h"
+
+using crypto::tink::subtle::Random;
+using google::crypto::tink::EciesAeadHkdfPrivateKey;
+using google::crypto::tink::EciesAeadHkdfPublicKey;
+using google::crypto::tink::EcPointFormat;
+using google::crypto::tink::EllipticCurveType;
+using google::crypto::tink::HashType;
+
+namespace crypto {
+namespace tink {
+namespace {
+
+class EciesAeadHkdfMultiRecipientEncryptTest : public ::testing::Test {
+ protected:
+  static void SetUpTestCase() {
+    ASSERT_TRUE(Registry::RegisterKeyManager(
+                    absl::make_unique<AesGcmKeyManager>(), true)
+                    .ok());
+  }
+
+  // Returns recipient keys on various curves, all with an AES-GCM DEM
+  // with 'aes_gcm_key_size' byte keys.
+  static std::vector<EciesAeadHkdfPrivateKey> NewRecipientKeys(
+      uint32_t aes_gcm_key_size) {
+    std::vector<EciesAeadHkdfPrivateKey> keys;
+    keys.push_back(test::GetEciesAesGcmHkdfTestKey(
+        EllipticCurveType::NIST_P256, EcPointFormat::UNCOMPRESSED,
+        HashType::SHA256, aes_gcm_key_size));
+    keys.push_back(test::GetEciesAesGcmHkdfTestKey(
+        EllipticCurveType::NIST_P384, EcPointFormat::COMPRESSED,
+        HashType::SHA512, aes_gcm_key_size));
+    keys.push_back(test::GetEciesAesGcmHkdfTestKey(
+        EllipticCurveType::NIST_P256, EcPointFormat::COMPRESSED,
+        HashType::SHA256, aes_gcm_key_size));
+    return keys;
+  }
+
+  static std::vector<EciesAeadHkdfPublicKey> PublicKeys(
+      const std::vector<EciesAeadHkdfPrivateKey>& keys) {
+    std::vector<EciesAeadHkdfPublicKey> public_keys;
+    for (const auto& key : keys) public_keys.push_back(key.public_key());
+    return public_keys;
+  }
+};
+
+TEST_F(EciesAeadHkdfMultiRecipientEncryptTest, InvalidKeys) {
+  {  // No recipients.
+    auto result = EciesAeadHkdfMultiRecipientEncrypt::New({});
+    EXPECT_FALSE(result.ok());
+    EXPECT_EQ(util::error::INVALID_ARGUMENT, result.status().error_code());
+  }
+
+  {  // A key without fields.
+    std::vector<EciesAeadHkdfPublicKey> keys =
+        PublicKeys(NewRecipientKeys(16));
+    keys.push_back(EciesAeadHkdfPublicKey());
+    auto result = EciesAeadHkdfMultiRecipientEncrypt::New(keys);
+    EXPECT_FALSE(result.ok());
+    EXPECT_EQ(util::error::INVALID_ARGUMENT, result.status().error_code());
+    EXPECT_PRED_FORMAT2(testing::IsSubstring, "missing required fields",
+                        result.status().error_message());
+  }
+
+  {  // Different DEMs.
+    std::vector<EciesAeadHkdfPublicKey> keys =
+        PublicKeys(NewRecipientKeys(16));
+    keys.push_back(test::GetEciesAesGcmHkdfTestKey(
+                       EllipticCurveType::NIST_P256,
+                       EcPointFormat::UNCOMPRESSED, HashType::SHA256, 32)
+                       .public_key());
+    auto result = EciesAeadHkdfMultiRecipientEncrypt::New(keys);
+    EXPECT_FALSE(result.ok());
+    EXPECT_EQ(util::error::INVALID_ARGUMENT, result.status().error_code());
+    EXPECT_PRED_FORMAT2(testing::IsSubstring, "same DEM",
+                        result.status().error_message());
+  }
+}
+
+TEST_F(EciesAeadHkdfMultiRecipientEncryptTest, EncryptDecrypt) {
+  std::string context_info = "some context info";
+  for (uint32_t aes_gcm_key_size : {16, 32}) {
+    for (uint32_t plaintext_size : {0, 1, 100, 100000}) {
+      SCOPED_TRACE(plaintext_size);
+      std::vector<EciesAeadHkdfPrivateKey> keys =
+          NewRecipientKeys(aes_gcm_key_size);
+      auto encrypt_result =
+          EciesAeadHkdfMultiRecipientEncrypt::New(PublicKeys(keys));
+      ASSERT_TRUE(encrypt_result.ok()) << encrypt_result.status();
+      auto multi_recipient_encrypt = std::move(encrypt_result.ValueOrDie());
+      EXPECT_EQ(keys.size(), multi_recipient_encrypt->recipient_count());
+
+      std::string plaintext = Random::GetRandomBytes(plaintext_size);
+      auto ciphertext_result =
+          multi_recipient_encrypt->Encrypt(plaintext, context_info);
+      ASSERT_TRUE(ciphertext_result.ok()) << ciphertext_result.status();
+      const auto& ciphertext = ciphertext_result.ValueOrDie();
+      ASSERT_EQ(keys.size(), ciphertext.recipient_headers.size());
+      // The plaintext is encrypted once, with a 12-byte IV and a 16-byte tag.
+      EXPECT_EQ(plaintext_size + 12 + 16, ciphertext.payload.size());
+
+      for (int i = 0; i < keys.size(); i++) {
+        auto decrypt_result = EciesAeadHkdfMultiRecipientDecrypt::New(keys[i]);
+        ASSERT_TRUE(decrypt_result.ok()) << decrypt_result.status();
+        auto hybrid_decrypt = std::move(decrypt_result.ValueOrDie());
+        std::string recipient_ciphertext =
+            EciesAeadHkdfMultiRecipientEncrypt::RecipientCiphertext(ciphertext,
+                                                                    i);
+        EXPECT_EQ(ciphertext.recipient_headers[i] + ciphertext.payload,
+                  recipient_ciphertext);
+
+        auto plaintext_result =
+            hybrid_decrypt->Decrypt(recipient_ciphertext, context_info);
+        ASSERT_TRUE(plaintext_result.ok()) << plaintext_result.status();
+        EXPECT_EQ(plaintext, plaintext_result.ValueOrDie());
+
+        // The headers of the other recipients are not for this key.
+        int other = (i + 1) % keys.size();
+        EXPECT_FALSE(hybrid_decrypt
+                         ->Decrypt(ciphertext.recipient_headers[other] +
+                                       ciphertext.payload,
+                                   context_info)
+                         .ok());
+        // Nor is a different context info.
+        EXPECT_FALSE(
+            hybrid_decrypt->Decrypt(recipient_ciphertext, "other context")
+                .ok());
+      }
+    }
+  }
+}
+
+TEST_F(EciesAeadHkdfMultiRecipientEncryptTest, FreshDemKeyPerMessage) {
+  std::vector<EciesAeadHkdfPrivateKey> keys = NewRecipientKeys(16);
+  auto multi_recipient_encrypt =
+      std::move(EciesAeadHkdfMultiRecipientEncrypt::New(PublicKeys(keys))
+                    .ValueOrDie());
+  auto hybrid_decrypt =
+      std::move(EciesAeadHkdfMultiRecipientDecrypt::New(keys[0]).ValueOrDie());
+  auto first = multi_recipient_encrypt->Encrypt("first", "").ValueOrDie();
+  auto second = multi_recipient_encrypt->Encrypt("second", "").ValueOrDie();
+  EXPECT_NE(first.recipient_headers[0], second.recipient_headers[0]);
+  // The header of one message does not decrypt the payload of another.
+  EXPECT_FALSE(
+      hybrid_decrypt
+          ->Decrypt(first.recipient_headers[0] + second.payload, "")
+          .ok());
+}
+
+}  // namespace
+}  // namespace tink
+}  // namespace crypto
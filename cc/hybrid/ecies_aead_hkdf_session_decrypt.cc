@@ -0,0 +1,237 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/hybrid/ecies_aead_hkdf_session_decrypt.h"
+
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "tink/aead.h"
+#include "tink/hybrid/ecies_aead_hkdf_dem_helper.h"
+#include "tink/hybrid/ecies_aead_hkdf_session_encrypt.h"
+#include "tink/subtle/common_enums.h"
+#include "tink/subtle/ec_util.h"
+#include "tink/subtle/ecies_hkdf_recipient_kem_boringssl.h"
+#include "tink/util/enums.h"
+#include "tink/util/secret_data.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "proto/ecies_aead_hkdf.pb.h"
+
+using google::crypto::tink::EciesAeadHkdfPrivateKey;
+
+namespace crypto {
+namespace tink {
+
+namespace {
+
+constexpr int kSessionIdSize = EciesAeadHkdfSessionEncrypt::kSessionIdSize;
+constexpr int kSequenceNumberSize =
+    EciesAeadHkdfSessionEncrypt::kSequenceNumberSize;
+
+uint64_t LoadBigEndian64(absl::string_view bytes) {
+  uint64_t value = 0;
+  for (int i = 0; i < 8; i++) {
+    value = (value << 8) | static_cast<uint8_t>(bytes[i]);
+  }
+  return value;
+}
+
+}  // namespace
+
+// static
+util::StatusOr<std::unique_ptr<EciesAeadHkdfSessionDecrypt>>
+EciesAeadHkdfSessionDecrypt::New(const EciesAeadHkdfPrivateKey& recipient_key,
+                                 const Options& options) {
+  util::Status status = Validate(recipient_key);
+  if (!status.ok()) return status;
+  if (options.max_sessions == 0) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+                        "max_sessions must be positive");
+  }
+  const auto& params = recipient_key.public_key().params();
+
+  auto kem_result = subtle::EciesHkdfRecipientKemBoringSsl::New(
+      util::Enums::ProtoToSubtle(params.kem_params().curve_type()),
+      recipient_key.key_value());
+  if (!kem_result.ok()) return kem_result.status();
+
+  auto dem_result =
+      EciesAeadHkdfDemHelper::New(params.dem_params().aead_dem());
+  if (!dem_result.ok()) return dem_result.status();
+
+  auto kem_bytes_size_result = subtle::EcUtil::EncodingSizeInBytes(
+      util::Enums::ProtoToSubtle(params.kem_params().curve_type()),
+      util::Enums::ProtoToSubtle(params.ec_point_format()));
+  if (!kem_bytes_size_result.ok()) return kem_bytes_size_result.status();
+
+  return absl::WrapUnique(new EciesAeadHkdfSessionDecrypt(
+      recipient_key, std::move(kem_result.ValueOrDie()),
+      std::move(dem_result.ValueOrDie()), kem_bytes_size_result.ValueOrDie(),
+      options.max_sessions));
+}
+
+util::StatusOr<EciesAeadHkdfSessionDecrypt::Record>
+EciesAeadHkdfSessionDecrypt::Decrypt(absl::string_view record,
+                                     absl::string_view context_info) const {
+  if (record.empty()) {
+    static const util::StaticStatus* kRecordTooShort =
+        new util::StaticStatus(util::error::INVALID_ARGUMENT,
+                               "record too short");
+    return *kRecordTooShort;
+  }
+  Record result;
+  absl::string_view sequence_number;
+  absl::string_view dem_ciphertext;
+  std::shared_ptr<const Aead> dem;
+  bool self_contained = false;
+  uint8_t record_type = static_cast<uint8_t>(record[0]);
+  if (record_type == EciesAeadHkdfSessionEncrypt::kCompactRecord) {
+    if (record.size() < 1 + kSessionIdSize + kSequenceNumberSize) {
+      static const util::StaticStatus* kRecordTooShort =
+          new util::StaticStatus(util::error::INVALID_ARGUMENT,
+                                 "record too short");
+      return *kRecordTooShort;
+    }
+    absl::string_view session_id = record.substr(1, kSessionIdSize);
+    sequence_number =
+        record.substr(1 + kSessionIdSize, kSequenceNumberSize);
+    dem_ciphertext = record.substr(1 + kSessionIdSize + kSequenceNumberSize);
+    auto dem_result = FindSession(session_id, context_info);
+    if (!dem_result.ok()) return dem_result.status();
+    dem = std::move(dem_result.ValueOrDie());
+    result.session_id = std::string(session_id);
+  } else if (record_type ==
+             EciesAeadHkdfSessionEncrypt::kSelfContainedRecord) {
+    if (record.size() < 1 + kSequenceNumberSize + kem_bytes_size_) {
+      static const util::StaticStatus* kRecordTooShort =
+          new util::StaticStatus(util::error::INVALID_ARGUMENT,
+                                 "record too short");
+      return *kRecordTooShort;
+    }
+    sequence_number = record.substr(1, kSequenceNumberSize);
+    absl::string_view kem_bytes =
+        record.substr(1 + kSequenceNumberSize, kem_bytes_size_);
+    dem_ciphertext = record.substr(1 + kSequenceNumberSize + kem_bytes_size_);
+    auto dem_result =
+        DeriveSession(kem_bytes, context_info, &result.session_id);
+    if (!dem_result.ok()) return dem_result.status();
+    dem = std::move(dem_result.ValueOrDie());
+    self_contained = true;
+  } else {
+    return util::Status(util::error::INVALID_ARGUMENT,
+                        "unknown record type");
+  }
+
+  std::string associated_data = result.session_id;
+  associated_data.append(sequence_number.data(), sequence_number.size());
+  auto decrypt_result = dem->Decrypt(dem_ciphertext, associated_data);
+  if (!decrypt_result.ok()) return decrypt_result.status();
+  // Only now, so that forged self-contained records (which anyone can
+  // create from the public key) cannot evict the cached sessions.
+  if (self_contained) {
+    AddSession(result.session_id, context_info, std::move(dem));
+  }
+  result.plaintext = std::move(decrypt_result.ValueOrDie());
+  result.sequence_number = LoadBigEndian64(sequence_number);
+  return std::move(result);
+}
+
+util::StatusOr<std::shared_ptr<const Aead>>
+EciesAeadHkdfSessionDecrypt::DeriveSession(absl::string_view kem_bytes,
+                                           absl::string_view context_info,
+                                           std::string* session_id) const {
+  const auto& params = recipient_key_.public_key().params();
+  subtle::HashType hash =
+      util::Enums::ProtoToSubtle(params.kem_params().hkdf_hash_type());
+  auto secret_result = recipient_kem_->GenerateKey(
+      kem_bytes, hash, params.kem_params().hkdf_salt(), context_info,
+      EciesAeadHkdfSessionEncrypt::kSessionSecretSize,
+      util::Enums::ProtoToSubtle(params.ec_point_format()));
+  if (!secret_result.ok()) return secret_result.status();
+  util::SecretData dem_key;
+  util::Status status = EciesAeadHkdfSessionEncrypt::DeriveSessionKeys(
+      hash, secret_result.ValueOrDie(),
+      dem_helper_->dem_key_size_in_bytes(), session_id, &dem_key);
+  if (!status.ok()) return status;
+  auto aead_result = dem_helper_->GetAead(dem_key);
+  if (!aead_result.ok()) return aead_result.status();
+  return std::shared_ptr<const Aead>(std::move(aead_result.ValueOrDie()));
+}
+
+void EciesAeadHkdfSessionDecrypt::AddSession(
+    const std::string& session_id, absl::string_view context_info,
+    std::shared_ptr<const Aead> dem) const {
+  absl::MutexLock lock(&mutex_);
+  auto found = index_.find(session_id);
+  if (found != index_.end()) {
+    // The session id is derived from the session secret, so this is the
+    // same session, e.g. a resumed one.
+    lru_.splice(lru_.begin(), lru_, found->second);
+    return;
+  }
+  lru_.push_front(Session{session_id, std::string(context_info),
+                          std::move(dem)});
+  index_.emplace(lru_.front().session_id, lru_.begin());
+  if (lru_.size() > max_sessions_) {
+    index_.erase(lru_.back().session_id);
+    lru_.pop_back();
+    evictions_++;
+  }
+}
+
+util::StatusOr<std::shared_ptr<const Aead>>
+EciesAeadHkdfSessionDecrypt::FindSession(
+    absl::string_view session_id, absl::string_view context_info) const {
+  absl::MutexLock lock(&mutex_);
+  auto found = index_.find(session_id);
+  if (found == index_.end()) {
+    misses_++;
+    static const util::StaticStatus* kUnknownSession = new util::StaticStatus(
+        util::error::NOT_FOUND, "unknown session");
+    return *kUnknownSession;
+  }
+  if (found->second->context_info != context_info) {
+    static const util::StaticStatus* kDecryptionFailed =
+        new util::StaticStatus(util::error::INVALID_ARGUMENT,
+                               "decryption failed");
+    return *kDecryptionFailed;
+  }
+  hits_++;
+  lru_.splice(lru_.begin(), lru_, found->second);
+  return found->second->dem;
+}
+
+EciesAeadHkdfSessionDecrypt::CacheStats
+EciesAeadHkdfSessionDecrypt::GetCacheStats() const {
+  absl::MutexLock lock(&mutex_);
+  return {hits_, misses_, evictions_, static_cast<int64_t>(lru_.size())};
+}
+
+// static
+util::Status EciesAeadHkdfSessionDecrypt::Validate(
+    const EciesAeadHkdfPrivateKey& key) {
+  if (!key.has_public_key() || !key.public_key().has_params()
+      || key.public_key().x().empty() || key.public_key().y().empty()
+      || key.key_value().empty()) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+        "Invalid EciesAeadHkdfPrivateKey: missing required fields.");
+  }
+  return util::Status::OK;
+}
+
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,147 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_HYBRID_ECIES_AEAD_HKDF_SESSION_DECRYPT_H_
+#define TINK_HYBRID_ECIES_AEAD_HKDF_SESSION_DECRYPT_H_
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/hash/hash.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "tink/aead.h"
+#include "tink/hybrid/ecies_aead_hkdf_dem_helper.h"
+#include "tink/subtle/ecies_hkdf_recipient_kem_boringssl.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "proto/ecies_aead_hkdf.pb.h"
+
+namespace crypto {
+namespace tink {
+
+// Decryption of the records of EciesAeadHkdfSessionEncrypt.
+//
+// A self-contained record costs a KEM operation, and (once its DEM
+// ciphertext has been authenticated) adds its session to a bounded LRU
+// cache; a compact record of a cached session costs only a
+// lookup and a symmetric decryption.  A compact record of a session that
+// is not cached (never seen, or evicted) fails with NOT_FOUND, so that the
+// caller can ask the sender for a self-contained record.
+//
+// The methods are thread-safe.
+class EciesAeadHkdfSessionDecrypt {
+ public:
+  struct Options {
+    // The maximum number of cached sessions.
+    size_t max_sessions = 1000;
+  };
+
+  struct Record {
+    std::string plaintext;
+    std::string session_id;
+    uint64_t sequence_number;
+  };
+
+  struct CacheStats {
+    int64_t hits;
+    // Compact records of sessions that were not cached.
+    int64_t misses;
+    int64_t evictions;
+    // The number of cached sessions.
+    int64_t size;
+  };
+
+  // Returns a primitive that decrypts records with 'recipient_key'.
+  static crypto::tink::util::StatusOr<
+      std::unique_ptr<EciesAeadHkdfSessionDecrypt>>
+  New(const google::crypto::tink::EciesAeadHkdfPrivateKey& recipient_key,
+      const Options& options);
+
+  // Decrypts 'record', which must have been encrypted with the same
+  // 'context_info' as the session.
+  crypto::tink::util::StatusOr<Record> Decrypt(
+      absl::string_view record, absl::string_view context_info) const;
+
+  CacheStats GetCacheStats() const;
+
+ private:
+  struct Session {
+    std::string session_id;
+    std::string context_info;
+    std::shared_ptr<const Aead> dem;
+  };
+
+  static crypto::tink::util::Status Validate(
+      const google::crypto::tink::EciesAeadHkdfPrivateKey& key);
+
+  EciesAeadHkdfSessionDecrypt(
+      const google::crypto::tink::EciesAeadHkdfPrivateKey& recipient_key,
+      std::unique_ptr<subtle::EciesHkdfRecipientKemBoringSsl> recipient_kem,
+      std::unique_ptr<EciesAeadHkdfDemHelper> dem_helper,
+      size_t kem_bytes_size, size_t max_sessions)
+      : recipient_key_(recipient_key),
+        recipient_kem_(std::move(recipient_kem)),
+        dem_helper_(std::move(dem_helper)),
+        kem_bytes_size_(kem_bytes_size),
+        max_sessions_(max_sessions) {}
+
+  // Derives the session of the self-contained record with 'kem_bytes',
+  // and returns its DEM.  The cache is not touched, since the record has
+  // not been authenticated yet.
+  crypto::tink::util::StatusOr<std::shared_ptr<const Aead>> DeriveSession(
+      absl::string_view kem_bytes, absl::string_view context_info,
+      std::string* session_id) const;
+
+  // Adds the session of an authenticated self-contained record to the
+  // cache, or marks it as the most recently used if it is cached already.
+  void AddSession(const std::string& session_id,
+                  absl::string_view context_info,
+                  std::shared_ptr<const Aead> dem) const
+      LOCKS_EXCLUDED(mutex_);
+
+  // Returns the DEM of the cached session with 'session_id', which must
+  // have been started with 'context_info'.
+  crypto::tink::util::StatusOr<std::shared_ptr<const Aead>> FindSession(
+      absl::string_view session_id, absl::string_view context_info) const;
+
+  const google::crypto::tink::EciesAeadHkdfPrivateKey recipient_key_;
+  const std::unique_ptr<subtle::EciesHkdfRecipientKemBoringSsl>
+      recipient_kem_;
+  const std::unique_ptr<EciesAeadHkdfDemHelper> dem_helper_;
+  const size_t kem_bytes_size_;
+  const size_t max_sessions_;
+
+  mutable absl::Mutex mutex_;
+  // The cached sessions, the most recently used first.
+  mutable std::list<Session> lru_ GUARDED_BY(mutex_);
+  // The elements of 'lru_', by their session ids.
+  mutable std::unordered_map<absl::string_view, std::list<Session>::iterator,
+                             absl::Hash<absl::string_view>>
+      index_ GUARDED_BY(mutex_);
+  mutable int64_t hits_ GUARDED_BY(mutex_) = 0;
+  mutable int64_t misses_ GUARDED_BY(mutex_) = 0;
+  mutable int64_t evictions_ GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_HYBRID_ECIES_AEAD_HKDF_SESSION_DECRYPT_H_
@@ -0,0 +1,219 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/hybrid/ecies_aead_hkdf_session_decrypt.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "tink/aead/aes_gcm_key_manager.h"
+#include "tink/hybrid/ecies_aead_hkdf_session_encrypt.h"
+#include "tink/registry.h"
+#include "tink/subtle/random.h"
+#include "tink/util/statusor.h"
+#include "tink/util/test_util.h"
+#include "proto/common.pb.h"
+#include "proto/ecies_aead_hkdf.pb.h"
+#include "gtest/gtest.h"
+
+using crypto::tink::subtle::Random;
+using google::crypto::tink::EciesAeadHkdfPrivateKey;
+using google::crypto::tink::EcPointFormat;
+using google::crypto::tink::EllipticCurveType;
+using google::crypto::tink::HashType;
+
+namespace crypto {
+namespace tink {
+namespace {
+
+class EciesAeadHkdfSessionDecryptTest : public ::testing::Test {
+ protected:
+  static void SetUpTestCase() {
+    ASSERT_TRUE(Registry::RegisterKeyManager(
+                    absl::make_unique<AesGcmKeyManager>(), true)
+                    .ok());
+  }
+
+  void SetUp() override {
+    key_ = test::GetEciesAesGcmHkdfTestKey(EllipticCurveType::NIST_P256,
+                                           EcPointFormat::COMPRESSED,
+                                           HashType::SHA256, 32);
+    session_encrypt_ = std::move(
+        EciesAeadHkdfSessionEncrypt::New(key_.public_key()).ValueOrDie());
+  }
+
+  std::unique_ptr<EciesAeadHkdfSessionDecrypt> NewDecrypt(
+      size_t max_sessions) {
+    EciesAeadHkdfSessionDecrypt::Options options;
+    options.max_sessions = max_sessions;
+    return std::move(
+        EciesAeadHkdfSessionDecrypt::New(key_, options).ValueOrDie());
+  }
+
+  EciesAeadHkdfPrivateKey key_;
+  std::unique_ptr<EciesAeadHkdfSessionEncrypt> session_encrypt_;
+};
+
+TEST_F(EciesAeadHkdfSessionDecryptTest, InvalidArguments) {
+  EciesAeadHkdfSessionDecrypt::Options options;
+  auto result =
+      EciesAeadHkdfSessionDecrypt::New(EciesAeadHkdfPrivateKey(), options);
+  EXPECT_FALSE(result.ok());
+  EXPECT_PRED_FORMAT2(testing::IsSubstring, "missing required fields",
+                      result.status().error_message());
+
+  options.max_sessions = 0;
+  auto no_cache_result = EciesAeadHkdfSessionDecrypt::New(key_, options);
+  EXPECT_FALSE(no_cache_result.ok());
+  EXPECT_EQ(util::error::INVALID_ARGUMENT,
+            no_cache_result.status().error_code());
+}
+
+TEST_F(EciesAeadHkdfSessionDecryptTest, EncryptDecrypt) {
+  auto session_decrypt = NewDecrypt(10);
+  auto session =
+      std::move(session_encrypt_->NewSession("context").ValueOrDie());
+  for (uint64_t i = 0; i < 100; i++) {
+    std::string plaintext = Random::GetRandomBytes(i * 3);
+    std::string record = session->Encrypt(plaintext).ValueOrDie();
+    auto result = session_decrypt->Decrypt(record, "context");
+    ASSERT_TRUE(result.ok()) << result.status();
+    EXPECT_EQ(plaintext, result.ValueOrDie().plaintext);
+    EXPECT_EQ(session->session_id(), result.ValueOrDie().session_id);
+    EXPECT_EQ(i, result.ValueOrDie().sequence_number);
+  }
+  auto stats = session_decrypt->GetCacheStats();
+  EXPECT_EQ(99, stats.hits);
+  EXPECT_EQ(0, stats.misses);
+  EXPECT_EQ(1, stats.size);
+}
+
+TEST_F(EciesAeadHkdfSessionDecryptTest, UnknownSessions) {
+  auto session_decrypt = NewDecrypt(2);
+  std::vector<std::unique_ptr<EciesAeadHkdfSession>> sessions;
+  for (int i = 0; i < 3; i++) {
+    sessions.push_back(
+        std::move(session_encrypt_->NewSession("context").ValueOrDie()));
+    ASSERT_TRUE(session_decrypt
+                    ->Decrypt(sessions[i]->Encrypt("first").ValueOrDie(),
+                              "context")
+                    .ok());
+  }
+
+  // The first session has been evicted.
+  std::string record = sessions[0]->Encrypt("plaintext").ValueOrDie();
+  auto result = session_decrypt->Decrypt(record, "context");
+  EXPECT_FALSE(result.ok());
+  EXPECT_EQ(util::error::NOT_FOUND, result.status().error_code());
+  auto stats = session_decrypt->GetCacheStats();
+  EXPECT_EQ(1, stats.evictions);
+  EXPECT_EQ(1, stats.misses);
+  EXPECT_EQ(2, stats.size);
+
+  // A self-contained record resumes it.
+  record = sessions[0]->EncryptSelfContained("resumed").ValueOrDie();
+  result = session_decrypt->Decrypt(record, "context");
+  ASSERT_TRUE(result.ok()) << result.status();
+  EXPECT_EQ("resumed", result.ValueOrDie().plaintext);
+  record = sessions[0]->Encrypt("plaintext").ValueOrDie();
+  EXPECT_TRUE(session_decrypt->Decrypt(record, "context").ok());
+
+  // The sessions are not shared between recipients.
+  auto other_decrypt = NewDecrypt(2);
+  result = other_decrypt->Decrypt(record, "context");
+  EXPECT_EQ(util::error::NOT_FOUND, result.status().error_code());
+}
+
+TEST_F(EciesAeadHkdfSessionDecryptTest, ForgedRecordsDoNotEvictSessions) {
+  auto session_decrypt = NewDecrypt(2);
+  std::vector<std::unique_ptr<EciesAeadHkdfSession>> sessions;
+  for (int i = 0; i < 2; i++) {
+    sessions.push_back(
+        std::move(session_encrypt_->NewSession("context").ValueOrDie()));
+    ASSERT_TRUE(session_decrypt
+                    ->Decrypt(sessions[i]->Encrypt("first").ValueOrDie(),
+                              "context")
+                    .ok());
+  }
+
+  // Self-contained records with valid KEM bytes (anyone can make them from
+  // the public key), but a DEM ciphertext that does not authenticate.
+  for (int i = 0; i < 10; i++) {
+    auto forger =
+        std::move(session_encrypt_->NewSession("context").ValueOrDie());
+    std::string forged = forger->EncryptSelfContained("forged").ValueOrDie();
+    forged.back() ^= 1;
+    EXPECT_FALSE(session_decrypt->Decrypt(forged, "context").ok());
+  }
+  auto stats = session_decrypt->GetCacheStats();
+  EXPECT_EQ(0, stats.evictions);
+  EXPECT_EQ(2, stats.size);
+  for (const auto& session : sessions) {
+    std::string record = session->Encrypt("plaintext").ValueOrDie();
+    EXPECT_TRUE(session_decrypt->Decrypt(record, "context").ok());
+  }
+}
+
+TEST_F(EciesAeadHkdfSessionDecryptTest, InvalidRecords) {
+  auto session_decrypt = NewDecrypt(10);
+  auto session =
+      std::move(session_encrypt_->NewSession("context").ValueOrDie());
+  std::string self_contained = session->Encrypt("plaintext").ValueOrDie();
+  std::string compact = session->Encrypt("plaintext").ValueOrDie();
+
+  // The wrong context_info.
+  EXPECT_FALSE(session_decrypt->Decrypt(self_contained, "other").ok());
+  ASSERT_TRUE(session_decrypt->Decrypt(self_contained, "context").ok());
+  EXPECT_FALSE(session_decrypt->Decrypt(compact, "other").ok());
+
+  {  // Truncated records.
+    for (size_t size : {0, 1, 10}) {
+      auto result = session_decrypt->Decrypt(compact.substr(0, size),
+                                             "context");
+      EXPECT_FALSE(result.ok());
+      EXPECT_EQ(util::error::INVALID_ARGUMENT, result.status().error_code());
+    }
+    EXPECT_FALSE(session_decrypt
+                     ->Decrypt(compact.substr(0, compact.size() - 1),
+                               "context")
+                     .ok());
+  }
+
+  {  // Unknown record type.
+    std::string modified = compact;
+    modified[0] = 0x03;
+    auto result = session_decrypt->Decrypt(modified, "context");
+    EXPECT_PRED_FORMAT2(testing::IsSubstring, "unknown record type",
+                        result.status().error_message());
+  }
+
+  // Every modified byte is detected, including the sequence number.
+  for (const std::string& record : {self_contained, compact}) {
+    for (size_t i = 1; i < record.size(); i++) {
+      std::string modified = record;
+      modified[i] ^= 1;
+      EXPECT_FALSE(session_decrypt->Decrypt(modified, "context").ok())
+          << "at " << i;
+    }
+  }
+  ASSERT_TRUE(session_decrypt->Decrypt(compact, "context").ok());
+}
+
+}  // namespace
+}  // namespace tink
+}  // namespace crypto
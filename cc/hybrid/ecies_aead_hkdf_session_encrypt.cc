@@ -0,0 +1,176 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/hybrid/ecies_aead_hkdf_session_encrypt.h"
+
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "tink/aead.h"
+#include "tink/hybrid/ecies_aead_hkdf_dem_helper.h"
+#include "tink/subtle/common_enums.h"
+#include "tink/subtle/ecies_hkdf_sender_kem_boringssl.h"
+#include "tink/subtle/hkdf.h"
+#include "tink/util/enums.h"
+#include "tink/util/secret_data.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "proto/ecies_aead_hkdf.pb.h"
+
+using google::crypto::tink::EciesAeadHkdfPublicKey;
+
+namespace crypto {
+namespace tink {
+
+namespace {
+
+// The HKDF info for the session id and the DEM key.
+constexpr char kSessionKeysInfo[] = "EciesAeadHkdfSession";
+
+void AppendBigEndian64(uint64_t value, std::string* out) {
+  for (int i = 7; i >= 0; i--) {
+    out->push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+  }
+}
+
+}  // namespace
+
+constexpr int EciesAeadHkdfSessionEncrypt::kSessionIdSize;
+constexpr int EciesAeadHkdfSessionEncrypt::kSequenceNumberSize;
+constexpr uint8_t EciesAeadHkdfSessionEncrypt::kSelfContainedRecord;
+constexpr uint8_t EciesAeadHkdfSessionEncrypt::kCompactRecord;
+constexpr uint64_t EciesAeadHkdfSessionEncrypt::kMaxRecordsPerSession;
+constexpr int EciesAeadHkdfSessionEncrypt::kSessionSecretSize;
+
+// static
+util::StatusOr<std::unique_ptr<EciesAeadHkdfSessionEncrypt>>
+EciesAeadHkdfSessionEncrypt::New(
+    const EciesAeadHkdfPublicKey& recipient_key) {
+  util::Status status = Validate(recipient_key);
+  if (!status.ok()) return status;
+
+  auto kem_result = subtle::EciesHkdfSenderKemBoringSsl::New(
+      util::Enums::ProtoToSubtle(
+          recipient_key.params().kem_params().curve_type()),
+      recipient_key.x(), recipient_key.y());
+  if (!kem_result.ok()) return kem_result.status();
+
+  auto dem_result = EciesAeadHkdfDemHelper::New(
+      recipient_key.params().dem_params().aead_dem());
+  if (!dem_result.ok()) return dem_result.status();
+
+  return absl::WrapUnique(new EciesAeadHkdfSessionEncrypt(
+      recipient_key, std::move(kem_result.ValueOrDie()),
+      std::move(dem_result.ValueOrDie())));
+}
+
+util::StatusOr<std::unique_ptr<EciesAeadHkdfSession>>
+EciesAeadHkdfSessionEncrypt::NewSession(
+    absl::string_view context_info) const {
+  const auto& kem_params = recipient_key_.params().kem_params();
+  subtle::HashType hash =
+      util::Enums::ProtoToSubtle(kem_params.hkdf_hash_type());
+  auto kem_key_result = sender_kem_->GenerateKey(
+      hash, kem_params.hkdf_salt(), context_info, kSessionSecretSize,
+      util::Enums::ProtoToSubtle(recipient_key_.params().ec_point_format()));
+  if (!kem_key_result.ok()) return kem_key_result.status();
+  auto kem_key = std::move(kem_key_result.ValueOrDie());
+
+  std::string session_id;
+  util::SecretData dem_key;
+  util::Status status = DeriveSessionKeys(
+      hash, kem_key->get_symmetric_key(),
+      dem_helper_->dem_key_size_in_bytes(), &session_id, &dem_key);
+  if (!status.ok()) return status;
+  auto aead_result = dem_helper_->GetAead(dem_key);
+  if (!aead_result.ok()) return aead_result.status();
+
+  return absl::WrapUnique(new EciesAeadHkdfSession(
+      std::move(session_id), kem_key->get_kem_bytes(),
+      std::move(aead_result.ValueOrDie())));
+}
+
+// static
+util::Status EciesAeadHkdfSessionEncrypt::DeriveSessionKeys(
+    subtle::HashType hash, const util::SecretData& session_secret,
+    uint32_t dem_key_size, std::string* session_id,
+    util::SecretData* dem_key) {
+  auto keys_result = subtle::Hkdf::ExpandHkdfPrk(
+      hash, session_secret, kSessionKeysInfo, kSessionIdSize + dem_key_size);
+  if (!keys_result.ok()) return keys_result.status();
+  const util::SecretData& keys = keys_result.ValueOrDie();
+  session_id->assign(reinterpret_cast<const char*>(keys.data()),
+                     kSessionIdSize);
+  dem_key->assign(keys.begin() + kSessionIdSize, keys.end());
+  return util::Status::OK;
+}
+
+// static
+util::Status EciesAeadHkdfSessionEncrypt::Validate(
+    const EciesAeadHkdfPublicKey& key) {
+  if (key.x().empty() || key.y().empty() || !key.has_params()) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+        "Invalid EciesAeadHkdfPublicKey: missing required fields.");
+  }
+  return util::Status::OK;
+}
+
+util::StatusOr<std::string> EciesAeadHkdfSession::Encrypt(
+    absl::string_view plaintext) {
+  return EncryptRecord(plaintext, /* self_contained= */ false);
+}
+
+util::StatusOr<std::string> EciesAeadHkdfSession::EncryptSelfContained(
+    absl::string_view plaintext) {
+  return EncryptRecord(plaintext, /* self_contained= */ true);
+}
+
+util::StatusOr<std::string> EciesAeadHkdfSession::EncryptRecord(
+    absl::string_view plaintext, bool self_contained) {
+  uint64_t sequence_number =
+      next_sequence_number_.fetch_add(1, std::memory_order_relaxed);
+  if (sequence_number >= EciesAeadHkdfSessionEncrypt::kMaxRecordsPerSession) {
+    return util::Status(util::error::RESOURCE_EXHAUSTED,
+                        "The session has no sequence numbers left; "
+                        "start a new session.");
+  }
+  self_contained = self_contained || sequence_number == 0;
+
+  std::string associated_data = session_id_;
+  AppendBigEndian64(sequence_number, &associated_data);
+  auto encrypt_result = dem_->Encrypt(plaintext, associated_data);
+  if (!encrypt_result.ok()) return encrypt_result.status();
+  const std::string& dem_ciphertext = encrypt_result.ValueOrDie();
+
+  std::string record;
+  if (self_contained) {
+    record.reserve(1 + EciesAeadHkdfSessionEncrypt::kSequenceNumberSize +
+                   kem_bytes_.size() + dem_ciphertext.size());
+    record.push_back(EciesAeadHkdfSessionEncrypt::kSelfContainedRecord);
+    record.append(associated_data, session_id_.size(),
+                  std::string::npos);  // the sequence number
+    record.append(kem_bytes_);
+  } else {
+    record.reserve(1 + associated_data.size() + dem_ciphertext.size());
+    record.push_back(EciesAeadHkdfSessionEncrypt::kCompactRecord);
+    record.append(associated_data);
+  }
+  record.append(dem_ciphertext);
+  return record;
+}
+
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,157 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_HYBRID_ECIES_AEAD_HKDF_SESSION_ENCRYPT_H_
+#define TINK_HYBRID_ECIES_AEAD_HKDF_SESSION_ENCRYPT_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "tink/aead.h"
+#include "tink/hybrid/ecies_aead_hkdf_dem_helper.h"
+#include "tink/subtle/common_enums.h"
+#include "tink/subtle/ecies_hkdf_sender_kem_boringssl.h"
+#include "tink/util/secret_data.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "proto/ecies_aead_hkdf.pb.h"
+
+namespace crypto {
+namespace tink {
+
+class EciesAeadHkdfSession;
+
+// Hybrid encryption of a sequence of records for the owner of an
+// ECIES-AEAD-HKDF key, with one KEM operation for the whole sequence
+// instead of one per record.
+//
+// NewSession() does the KEM operation of EciesAeadHkdfHybridEncrypt once,
+// with 'context_info' as HKDF info, which gives a 32-byte session secret.
+// HKDF-Expand of the secret then gives a session id and a DEM key.  Each record of the session is then encrypted
+// with the DEM only, with the session id and its sequence number as
+// associated data.  Records thus cost a symmetric encryption each, and
+// most of them only carry the session id instead of the KEM bytes:
+//
+//   self-contained record: 0x01 || sequence number || KEM bytes || DEM ct
+//   compact record:        0x02 || session id || sequence number || DEM ct
+//
+// where the session id has kSessionIdSize bytes and the sequence number is
+// 8 bytes big-endian.  EciesAeadHkdfSessionDecrypt decrypts the records;
+// it learns the session from a self-contained record, and keeps it in a
+// bounded cache for the compact ones.
+//
+// Like all hybrid encryption this does not authenticate the sender.  The
+// sequence number is authenticated, but replays and gaps are for the
+// recipient to detect.
+class EciesAeadHkdfSessionEncrypt {
+ public:
+  static constexpr int kSessionIdSize = 16;
+  static constexpr int kSequenceNumberSize = 8;
+  static constexpr uint8_t kSelfContainedRecord = 0x01;
+  static constexpr uint8_t kCompactRecord = 0x02;
+  // The number of records of a session.  The DEMs use random IVs, so the
+  // number of encryptions under one key is bounded.
+  static constexpr uint64_t kMaxRecordsPerSession = 1ULL << 32;
+
+  // Returns a primitive that starts sessions with the owner of
+  // 'recipient_key'.
+  static crypto::tink::util::StatusOr<
+      std::unique_ptr<EciesAeadHkdfSessionEncrypt>>
+  New(const google::crypto::tink::EciesAeadHkdfPublicKey& recipient_key);
+
+  // Starts a new session, which costs one KEM operation.  'context_info'
+  // is bound to the session as in EciesAeadHkdfHybridEncrypt, and must be
+  // passed to the decryption of each record.
+  crypto::tink::util::StatusOr<std::unique_ptr<EciesAeadHkdfSession>>
+  NewSession(absl::string_view context_info) const;
+
+ private:
+  friend class EciesAeadHkdfSessionDecrypt;
+
+  static constexpr int kSessionSecretSize = 32;
+
+  static crypto::tink::util::Status Validate(
+      const google::crypto::tink::EciesAeadHkdfPublicKey& key);
+
+  // Derives the session id and the DEM key of a session from its secret.
+  static crypto::tink::util::Status DeriveSessionKeys(
+      subtle::HashType hash, const util::SecretData& session_secret,
+      uint32_t dem_key_size, std::string* session_id,
+      util::SecretData* dem_key);
+
+  EciesAeadHkdfSessionEncrypt(
+      const google::crypto::tink::EciesAeadHkdfPublicKey& recipient_key,
+      std::unique_ptr<subtle::EciesHkdfSenderKemBoringSsl> sender_kem,
+      std::unique_ptr<EciesAeadHkdfDemHelper> dem_helper)
+      : recipient_key_(recipient_key),
+        sender_kem_(std::move(sender_kem)),
+        dem_helper_(std::move(dem_helper)) {}
+
+  const google::crypto::tink::EciesAeadHkdfPublicKey recipient_key_;
+  const std::unique_ptr<subtle::EciesHkdfSenderKemBoringSsl> sender_kem_;
+  const std::unique_ptr<EciesAeadHkdfDemHelper> dem_helper_;
+};
+
+// A session of EciesAeadHkdfSessionEncrypt.  It is thread-safe: records
+// encrypted concurrently get distinct sequence numbers.
+class EciesAeadHkdfSession {
+ public:
+  // Encrypts 'plaintext' as the next record of the session.  The first
+  // record (sequence number 0) is self-contained, the others are compact.
+  crypto::tink::util::StatusOr<std::string> Encrypt(
+      absl::string_view plaintext);
+
+  // Like Encrypt(), but the record is always self-contained, e.g. to
+  // resume a session with a recipient that has lost it.
+  crypto::tink::util::StatusOr<std::string> EncryptSelfContained(
+      absl::string_view plaintext);
+
+  const std::string& session_id() const { return session_id_; }
+
+  // The number of records encrypted so far.
+  uint64_t record_count() const {
+    uint64_t count = next_sequence_number_.load(std::memory_order_relaxed);
+    return count < EciesAeadHkdfSessionEncrypt::kMaxRecordsPerSession
+               ? count
+               : EciesAeadHkdfSessionEncrypt::kMaxRecordsPerSession;
+  }
+
+ private:
+  friend class EciesAeadHkdfSessionEncrypt;
+
+  EciesAeadHkdfSession(std::string session_id, std::string kem_bytes,
+                       std::unique_ptr<Aead> dem)
+      : session_id_(std::move(session_id)),
+        kem_bytes_(std::move(kem_bytes)),
+        dem_(std::move(dem)),
+        next_sequence_number_(0) {}
+
+  crypto::tink::util::StatusOr<std::string> EncryptRecord(
+      absl::string_view plaintext, bool self_contained);
+
+  const std::string session_id_;
+  const std::string kem_bytes_;
+  const std::unique_ptr<Aead> dem_;
+  std::atomic<uint64_t> next_sequence_number_;
+};
+
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_HYBRID_ECIES_AEAD_HKDF_SESSION_ENCRYPT_H_
@@ -0,0 +1,166 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/hybrid/ecies_aead_hkdf_session_encrypt.h"
+
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "tink/aead/aes_gcm_key_manager.h"
+#include "tink/registry.h"
+#include "tink/subtle/ec_util.h"
+#include "tink/util/statusor.h"
+#include "tink/util/test_util.h"
+#include "proto/common.pb.h"
+#include "proto/ecies_aead_hkdf.pb.h"
+#include "gtest/gtest.h"
+
+using google::crypto::tink::EciesAeadHkdfPublicKey;
+using google::crypto::tink::EcPointFormat;
+using google::crypto::tink::EllipticCurveType;
+using google::crypto::tink::HashType;
+
+namespace crypto {
+namespace tink {
+namespace {
+
+constexpr int kSessionIdSize = EciesAeadHkdfSessionEncrypt::kSessionIdSize;
+constexpr int kSequenceNumberSize =
+    EciesAeadHkdfSessionEncrypt::kSequenceNumberSize;
+// The IV and the tag of AES-GCM.
+constexpr int kDemOverhead = 12 + 16;
+
+class EciesAeadHkdfSessionEncryptTest : public ::testing::Test {
+ protected:
+  static void SetUpTestCase() {
+    ASSERT_TRUE(Registry::RegisterKeyManager(
+                    absl::make_unique<AesGcmKeyManager>(), true)
+                    .ok());
+  }
+
+  EciesAeadHkdfPublicKey public_key_ =
+      test::GetEciesAesGcmHkdfTestKey(EllipticCurveType::NIST_P256,
+                                      EcPointFormat::UNCOMPRESSED,
+                                      HashType::SHA256, 16)
+          .public_key();
+};
+
+TEST_F(EciesAeadHkdfSessionEncryptTest, InvalidKeys) {
+  EciesAeadHkdfPublicKey key;
+  auto result = EciesAeadHkdfSessionEncrypt::New(key);
+  EXPECT_FALSE(result.ok());
+  EXPECT_EQ(util::error::INVALID_ARGUMENT, result.status().error_code());
+  EXPECT_PRED_FORMAT2(testing::IsSubstring, "missing required fields",
+                      result.status().error_message());
+}
+
+TEST_F(EciesAeadHkdfSessionEncryptTest, RecordFormat) {
+  auto session_encrypt =
+      std::move(EciesAeadHkdfSessionEncrypt::New(public_key_).ValueOrDie());
+  auto session =
+      std::move(session_encrypt->NewSession("context").ValueOrDie());
+  EXPECT_EQ(kSessionIdSize, session->session_id().size());
+  EXPECT_EQ(0, session->record_count());
+  int kem_bytes_size =
+      subtle::EcUtil::EncodingSizeInBytes(
+          subtle::EllipticCurveType::NIST_P256,
+          subtle::EcPointFormat::UNCOMPRESSED)
+          .ValueOrDie();
+
+  std::string plaintext = "some plaintext";
+  // The first record is self-contained.
+  std::string record = session->Encrypt(plaintext).ValueOrDie();
+  EXPECT_EQ(EciesAeadHkdfSessionEncrypt::kSelfContainedRecord, record[0]);
+  EXPECT_EQ(std::string(kSequenceNumberSize, '\0'),
+            record.substr(1, kSequenceNumberSize));
+  EXPECT_EQ(1 + kSequenceNumberSize + kem_bytes_size + kDemOverhead +
+                plaintext.size(),
+            record.size());
+
+  // The next ones are compact.
+  for (int i = 1; i < 300; i++) {
+    record = session->Encrypt(plaintext).ValueOrDie();
+    EXPECT_EQ(EciesAeadHkdfSessionEncrypt::kCompactRecord, record[0]);
+    EXPECT_EQ(session->session_id(), record.substr(1, kSessionIdSize));
+    std::string sequence_number(kSequenceNumberSize, '\0');
+    sequence_number[6] = static_cast<char>(i >> 8);
+    sequence_number[7] = static_cast<char>(i & 0xff);
+    EXPECT_EQ(sequence_number,
+              record.substr(1 + kSessionIdSize, kSequenceNumberSize));
+    EXPECT_EQ(1 + kSessionIdSize + kSequenceNumberSize + kDemOverhead +
+                  plaintext.size(),
+              record.size());
+  }
+
+  // Unless a self-contained one is asked for.
+  record = session->EncryptSelfContained(plaintext).ValueOrDie();
+  EXPECT_EQ(EciesAeadHkdfSessionEncrypt::kSelfContainedRecord, record[0]);
+  EXPECT_EQ(301, session->record_count());
+}
+
+TEST_F(EciesAeadHkdfSessionEncryptTest, SessionsAreDistinct) {
+  auto session_encrypt =
+      std::move(EciesAeadHkdfSessionEncrypt::New(public_key_).ValueOrDie());
+  std::set<std::string> session_ids;
+  for (int i = 0; i < 20; i++) {
+    auto session =
+        std::move(session_encrypt->NewSession("context").ValueOrDie());
+    EXPECT_TRUE(session_ids.insert(session->session_id()).second);
+  }
+}
+
+TEST_F(EciesAeadHkdfSessionEncryptTest, ConcurrentRecords) {
+  auto session_encrypt =
+      std::move(EciesAeadHkdfSessionEncrypt::New(public_key_).ValueOrDie());
+  auto session =
+      std::move(session_encrypt->NewSession("context").ValueOrDie());
+  constexpr int kThreadCount = 4;
+  constexpr int kRecordsPerThread = 100;
+  std::vector<std::vector<std::string>> records(kThreadCount);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreadCount; t++) {
+    threads.emplace_back([&session, &records, t]() {
+      for (int i = 0; i < kRecordsPerThread; i++) {
+        records[t].push_back(session->Encrypt("plaintext").ValueOrDie());
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  // Each record got its own sequence number.
+  std::set<std::string> sequence_numbers;
+  for (const auto& thread_records : records) {
+    for (const std::string& record : thread_records) {
+      int offset =
+          record[0] == EciesAeadHkdfSessionEncrypt::kCompactRecord
+              ? 1 + kSessionIdSize
+              : 1;
+      EXPECT_TRUE(sequence_numbers
+                      .insert(record.substr(offset, kSequenceNumberSize))
+                      .second);
+    }
+  }
+  EXPECT_EQ(kThreadCount * kRecordsPerThread, sequence_numbers.size());
+  EXPECT_EQ(kThreadCount * kRecordsPerThread, session->record_count());
+}
+
+}  // namespace
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,111 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/hybrid/ecies_hkdf_aes_gcm_streaming_hybrid_decrypt.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tink/input_stream.h"
+#include "tink/streaming_hybrid_decrypt.h"
+#include "tink/subtle/aes_gcm_stream_segment_decrypter.h"
+#include "tink/subtle/ec_util.h"
+#include "tink/subtle/ecies_hkdf_recipient_kem_boringssl.h"
+#include "tink/subtle/streaming_aead_decrypting_stream.h"
+#include "tink/util/enums.h"
+#include "tink/util/secret_data.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "proto/ecies_hkdf_aes_gcm_streaming.pb.h"
+
+using google::crypto::tink::EciesHkdfAesGcmStreamingParams;
+using google::crypto::tink::EciesHkdfAesGcmStreamingPrivateKey;
+
+namespace crypto {
+namespace tink {
+
+// static
+util::StatusOr<std::unique_ptr<StreamingHybridDecrypt>>
+EciesHkdfAesGcmStreamingHybridDecrypt::New(
+    const EciesHkdfAesGcmStreamingPrivateKey& recipient_key) {
+  util::Status status = Validate(recipient_key);
+  if (!status.ok()) return status;
+  const auto& params = recipient_key.public_key().params();
+
+  auto kem_result = subtle::EciesHkdfRecipientKemBoringSsl::New(
+      util::Enums::ProtoToSubtle(params.kem_params().curve_type()),
+      recipient_key.key_value());
+  if (!kem_result.ok()) return kem_result.status();
+
+  // The header of a stream are the KEM bytes.
+  auto header_size_result = subtle::EcUtil::EncodingSizeInBytes(
+      util::Enums::ProtoToSubtle(params.kem_params().curve_type()),
+      util::Enums::ProtoToSubtle(params.ec_point_format()));
+  if (!header_size_result.ok()) return header_size_result.status();
+
+  std::unique_ptr<StreamingHybridDecrypt> hybrid_decrypt(
+      new EciesHkdfAesGcmStreamingHybridDecrypt(
+          params, header_size_result.ValueOrDie(),
+          std::move(kem_result.ValueOrDie())));
+  return std::move(hybrid_decrypt);
+}
+
+util::StatusOr<std::unique_ptr<InputStream>>
+EciesHkdfAesGcmStreamingHybridDecrypt::NewDecryptingStream(
+    std::unique_ptr<InputStream> ciphertext_source,
+    absl::string_view context_info) const {
+  // The symmetric key is derived once the stream reads its header.
+  std::shared_ptr<const subtle::EciesHkdfRecipientKemBoringSsl> kem =
+      recipient_kem_;
+  EciesHkdfAesGcmStreamingParams params = params_;
+  std::string info(context_info);
+  auto key_from_header = [kem, params, info](
+      const std::vector<uint8_t>& header)
+      -> util::StatusOr<util::SecretData> {
+    return kem->GenerateKey(
+        absl::string_view(reinterpret_cast<const char*>(header.data()),
+                          header.size()),
+        util::Enums::ProtoToSubtle(params.kem_params().hkdf_hash_type()),
+        params.kem_params().hkdf_salt(),
+        info,
+        params.derived_key_size(),
+        util::Enums::ProtoToSubtle(params.ec_point_format()));
+  };
+  auto decrypter_result = subtle::AesGcmStreamSegmentDecrypter::New(
+      header_size_, params_.ciphertext_segment_size(), key_from_header);
+  if (!decrypter_result.ok()) return decrypter_result.status();
+
+  return subtle::StreamingAeadDecryptingStream::New(
+      std::move(decrypter_result.ValueOrDie()),
+      std::move(ciphertext_source));
+}
+
+// static
+util::Status EciesHkdfAesGcmStreamingHybridDecrypt::Validate(
+    const EciesHkdfAesGcmStreamingPrivateKey& key) {
+  if (!key.has_public_key() || !key.public_key().has_params()
+      || key.public_key().x().empty() || key.public_key().y().empty()
+      || key.key_value().empty()) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+        "Invalid EciesHkdfAesGcmStreamingPrivateKey: "
+        "missing required fields.");
+  }
+  return util::Status::OK;
+}
+
+}  // namespace tink
+}  // namespace crypto
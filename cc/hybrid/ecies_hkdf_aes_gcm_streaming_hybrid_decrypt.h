@@ -0,0 +1,72 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_HYBRID_ECIES_HKDF_AES_GCM_STREAMING_HYBRID_DECRYPT_H_
+#define TINK_HYBRID_ECIES_HKDF_AES_GCM_STREAMING_HYBRID_DECRYPT_H_
+
+#include <memory>
+
+#include "absl/strings/string_view.h"
+#include "tink/input_stream.h"
+#include "tink/streaming_hybrid_decrypt.h"
+#include "tink/subtle/ecies_hkdf_recipient_kem_boringssl.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "proto/ecies_hkdf_aes_gcm_streaming.pb.h"
+
+namespace crypto {
+namespace tink {
+
+// Streaming ECIES decryption with HKDF-KEM (key encapsulation mechanism)
+// and segmented AES-GCM as DEM (data encapsulation mechanism),
+// cf. EciesHkdfAesGcmStreamingHybridEncrypt.
+class EciesHkdfAesGcmStreamingHybridDecrypt : public StreamingHybridDecrypt {
+ public:
+  // Returns a StreamingHybridDecrypt-primitive that uses the key material
+  // given in 'recipient_key'.
+  static crypto::tink::util::StatusOr<std::unique_ptr<StreamingHybridDecrypt>>
+  New(const google::crypto::tink::EciesHkdfAesGcmStreamingPrivateKey&
+          recipient_key);
+
+  crypto::tink::util::StatusOr<std::unique_ptr<crypto::tink::InputStream>>
+  NewDecryptingStream(
+      std::unique_ptr<crypto::tink::InputStream> ciphertext_source,
+      absl::string_view context_info) const override;
+
+  ~EciesHkdfAesGcmStreamingHybridDecrypt() override {}
+
+ private:
+  static crypto::tink::util::Status Validate(
+      const google::crypto::tink::EciesHkdfAesGcmStreamingPrivateKey& key);
+
+  EciesHkdfAesGcmStreamingHybridDecrypt(
+      const google::crypto::tink::EciesHkdfAesGcmStreamingParams& params,
+      int header_size,
+      std::unique_ptr<subtle::EciesHkdfRecipientKemBoringSsl> recipient_kem)
+      : params_(params), header_size_(header_size),
+        recipient_kem_(std::move(recipient_kem)) {}
+
+  google::crypto::tink::EciesHkdfAesGcmStreamingParams params_;
+  int header_size_;
+  // Shared with the decrypting streams, which may outlive this primitive.
+  std::shared_ptr<const subtle::EciesHkdfRecipientKemBoringSsl>
+      recipient_kem_;
+};
+
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_HYBRID_ECIES_HKDF_AES_GCM_STREAMING_HYBRID_DECRYPT_H_
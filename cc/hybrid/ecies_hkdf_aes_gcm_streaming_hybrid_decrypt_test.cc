@@ -0,0 +1,190 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/hybrid/ecies_hkdf_aes_gcm_streaming_hybrid_decrypt.h"
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "tink/hybrid/ecies_hkdf_aes_gcm_streaming_hybrid_encrypt.h"
+#include "tink/hybrid/ecies_hkdf_aes_gcm_streaming_private_key_manager.h"
+#include "tink/streaming_hybrid_decrypt.h"
+#include "tink/streaming_hybrid_encrypt.h"
+#include "tink/subtle/random.h"
+#include "tink/util/istream_input_stream.h"
+#include "tink/util/ostream_output_stream.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "proto/common.pb.h"
+#include "proto/ecies_hkdf_aes_gcm_streaming.pb.h"
+
+using google::crypto::tink::EciesHkdfAesGcmStreamingKeyFormat;
+using google::crypto::tink::EciesHkdfAesGcmStreamingPrivateKey;
+using google::crypto::tink::EcPointFormat;
+using google::crypto::tink::EllipticCurveType;
+using google::crypto::tink::HashType;
+
+namespace crypto {
+namespace tink {
+namespace {
+
+EciesHkdfAesGcmStreamingPrivateKey NewKey(EllipticCurveType curve,
+                                          EcPointFormat point_format,
+                                          HashType hash_type,
+                                          int derived_key_size,
+                                          int ciphertext_segment_size) {
+  EciesHkdfAesGcmStreamingKeyFormat key_format;
+  auto params = key_format.mutable_params();
+  params->mutable_kem_params()->set_curve_type(curve);
+  params->mutable_kem_params()->set_hkdf_hash_type(hash_type);
+  params->mutable_kem_params()->set_hkdf_salt("some salt");
+  params->set_ec_point_format(point_format);
+  params->set_derived_key_size(derived_key_size);
+  params->set_ciphertext_segment_size(ciphertext_segment_size);
+  EciesHkdfAesGcmStreamingPrivateKeyManager key_manager;
+  auto key_result = key_manager.get_key_factory().NewKey(key_format);
+  EXPECT_TRUE(key_result.ok()) << key_result.status();
+  return *static_cast<EciesHkdfAesGcmStreamingPrivateKey*>(
+      key_result.ValueOrDie().get());
+}
+
+std::string Encrypt(const StreamingHybridEncrypt& hybrid_encrypt,
+                    absl::string_view plaintext,
+                    absl::string_view context_info) {
+  auto ct_stream = absl::make_unique<std::stringstream>();
+  std::stringbuf* ct_buf = ct_stream->rdbuf();
+  auto enc_stream_result = hybrid_encrypt.NewEncryptingStream(
+      absl::make_unique<util::OstreamOutputStream>(std::move(ct_stream)),
+      context_info);
+  EXPECT_TRUE(enc_stream_result.ok()) << enc_stream_result.status();
+  auto enc_stream = std::move(enc_stream_result.ValueOrDie());
+  while (!plaintext.empty()) {
+    void* buffer;
+    auto next_result = enc_stream->Next(&buffer);
+    EXPECT_TRUE(next_result.ok()) << next_result.status();
+    int size = next_result.ValueOrDie();
+    int copied = std::min<int>(size, plaintext.size());
+    memcpy(buffer, plaintext.data(), copied);
+    plaintext.remove_prefix(copied);
+    if (copied < size) enc_stream->BackUp(size - copied);
+  }
+  EXPECT_TRUE(enc_stream->Close().ok());
+  return ct_buf->str();
+}
+
+util::StatusOr<std::string> Decrypt(
+    const StreamingHybridDecrypt& hybrid_decrypt,
+    absl::string_view ciphertext, absl::string_view context_info) {
+  auto dec_stream_result = hybrid_decrypt.NewDecryptingStream(
+      absl::make_unique<util::IstreamInputStream>(
+          absl::make_unique<std::stringstream>(std::string(ciphertext))),
+      context_info);
+  if (!dec_stream_result.ok()) return dec_stream_result.status();
+  auto dec_stream = std::move(dec_stream_result.ValueOrDie());
+  std::string plaintext;
+  const void* buffer;
+  while (true) {
+    auto next_result = dec_stream->Next(&buffer);
+    if (!next_result.ok()) {
+      if (next_result.status().error_code() == util::error::OUT_OF_RANGE) {
+        return plaintext;
+      }
+      return next_result.status();
+    }
+    plaintext.append(static_cast<const char*>(buffer),
+                     next_result.ValueOrDie());
+  }
+}
+
+TEST(EciesHkdfAesGcmStreamingHybridDecryptTest, InvalidKeys) {
+  EciesHkdfAesGcmStreamingPrivateKey key =
+      NewKey(EllipticCurveType::NIST_P256, EcPointFormat::UNCOMPRESSED,
+             HashType::SHA256, 16, 1024);
+  {  // Missing private key value.
+    auto bad_key = key;
+    bad_key.clear_key_value();
+    EXPECT_FALSE(EciesHkdfAesGcmStreamingHybridDecrypt::New(bad_key).ok());
+  }
+  {  // Missing public key.
+    auto bad_key = key;
+    bad_key.clear_public_key();
+    EXPECT_FALSE(EciesHkdfAesGcmStreamingHybridDecrypt::New(bad_key).ok());
+  }
+  {  // Unknown curve.
+    auto bad_key = key;
+    bad_key.mutable_public_key()->mutable_params()->mutable_kem_params()
+        ->set_curve_type(EllipticCurveType::UNKNOWN_CURVE);
+    EXPECT_FALSE(EciesHkdfAesGcmStreamingHybridDecrypt::New(bad_key).ok());
+  }
+}
+
+TEST(EciesHkdfAesGcmStreamingHybridDecryptTest, EncryptDecrypt) {
+  std::string context_info = "some context info";
+  for (auto curve : {EllipticCurveType::NIST_P256,
+                     EllipticCurveType::NIST_P384,
+                     EllipticCurveType::NIST_P521}) {
+    for (auto point_format : {EcPointFormat::UNCOMPRESSED,
+                              EcPointFormat::COMPRESSED}) {
+      for (int derived_key_size : {16, 32}) {
+        EciesHkdfAesGcmStreamingPrivateKey key =
+            NewKey(curve, point_format, HashType::SHA256, derived_key_size,
+                   512);
+        auto hybrid_encrypt = std::move(
+            EciesHkdfAesGcmStreamingHybridEncrypt::New(key.public_key())
+                .ValueOrDie());
+        auto hybrid_decrypt = std::move(
+            EciesHkdfAesGcmStreamingHybridDecrypt::New(key).ValueOrDie());
+        for (int plaintext_size : {0, 1, 100, 400, 1000, 5000}) {
+          SCOPED_TRACE(absl::StrCat("curve = ", curve, ", format = ",
+                                    point_format, ", key size = ",
+                                    derived_key_size, ", plaintext size = ",
+                                    plaintext_size));
+          std::string plaintext = subtle::Random::GetRandomBytes(
+              plaintext_size);
+          std::string ciphertext =
+              Encrypt(*hybrid_encrypt, plaintext, context_info);
+          auto decrypt_result =
+              Decrypt(*hybrid_decrypt, ciphertext, context_info);
+          ASSERT_TRUE(decrypt_result.ok()) << decrypt_result.status();
+          EXPECT_EQ(plaintext, decrypt_result.ValueOrDie());
+
+          // Wrong context_info.
+          EXPECT_FALSE(
+              Decrypt(*hybrid_decrypt, ciphertext, "other context").ok());
+          // Modified ciphertext.
+          for (int pos : {0, static_cast<int>(ciphertext.size()) - 1}) {
+            std::string modified = ciphertext;
+            modified[pos] ^= 1;
+            EXPECT_FALSE(
+                Decrypt(*hybrid_decrypt, modified, context_info).ok());
+          }
+          // Truncated ciphertext.
+          EXPECT_FALSE(Decrypt(*hybrid_decrypt,
+                               ciphertext.substr(0, ciphertext.size() - 1),
+                               context_info).ok());
+        }
+      }
+    }
+  }
+}
+
+}  // namespace
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,98 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/hybrid/ecies_hkdf_aes_gcm_streaming_hybrid_encrypt.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tink/output_stream.h"
+#include "tink/streaming_hybrid_encrypt.h"
+#include "tink/subtle/aes_gcm_stream_segment_encrypter.h"
+#include "tink/subtle/ecies_hkdf_sender_kem_boringssl.h"
+#include "tink/subtle/streaming_aead_encrypting_stream.h"
+#include "tink/util/enums.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "proto/ecies_hkdf_aes_gcm_streaming.pb.h"
+
+using google::crypto::tink::EciesHkdfAesGcmStreamingPublicKey;
+using crypto::tink::util::Status;
+using crypto::tink::util::StatusOr;
+
+namespace crypto {
+namespace tink {
+
+// static
+StatusOr<std::unique_ptr<StreamingHybridEncrypt>>
+EciesHkdfAesGcmStreamingHybridEncrypt::New(
+    const EciesHkdfAesGcmStreamingPublicKey& recipient_key) {
+  Status status = Validate(recipient_key);
+  if (!status.ok()) return status;
+
+  auto kem_result = subtle::EciesHkdfSenderKemBoringSsl::New(
+      util::Enums::ProtoToSubtle(
+          recipient_key.params().kem_params().curve_type()),
+      recipient_key.x(), recipient_key.y());
+  if (!kem_result.ok()) return kem_result.status();
+
+  std::unique_ptr<StreamingHybridEncrypt> hybrid_encrypt(
+      new EciesHkdfAesGcmStreamingHybridEncrypt(
+          recipient_key, std::move(kem_result.ValueOrDie())));
+  return std::move(hybrid_encrypt);
+}
+
+StatusOr<std::unique_ptr<OutputStream>>
+EciesHkdfAesGcmStreamingHybridEncrypt::NewEncryptingStream(
+    std::unique_ptr<OutputStream> ciphertext_destination,
+    absl::string_view context_info) const {
+  const auto& params = recipient_key_.params();
+  // Use KEM to get the symmetric key of this stream.
+  auto kem_key_result = sender_kem_->GenerateKey(
+      util::Enums::ProtoToSubtle(params.kem_params().hkdf_hash_type()),
+      params.kem_params().hkdf_salt(),
+      context_info,
+      params.derived_key_size(),
+      util::Enums::ProtoToSubtle(params.ec_point_format()));
+  if (!kem_key_result.ok()) return kem_key_result.status();
+  auto kem_key = std::move(kem_key_result.ValueOrDie());
+
+  // The KEM bytes are the header of the stream.
+  std::string kem_bytes = kem_key->get_kem_bytes();
+  auto encrypter_result = subtle::AesGcmStreamSegmentEncrypter::New(
+      kem_key->get_symmetric_key(),
+      std::vector<uint8_t>(kem_bytes.begin(), kem_bytes.end()),
+      params.ciphertext_segment_size());
+  if (!encrypter_result.ok()) return encrypter_result.status();
+
+  return subtle::StreamingAeadEncryptingStream::New(
+      std::move(encrypter_result.ValueOrDie()),
+      std::move(ciphertext_destination));
+}
+
+// static
+Status EciesHkdfAesGcmStreamingHybridEncrypt::Validate(
+    const EciesHkdfAesGcmStreamingPublicKey& key) {
+  if (key.x().empty() || key.y().empty() || !key.has_params()) {
+    return Status(util::error::INVALID_ARGUMENT,
+        "Invalid EciesHkdfAesGcmStreamingPublicKey: missing required fields.");
+  }
+  return Status::OK;
+}
+
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,72 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_HYBRID_ECIES_HKDF_AES_GCM_STREAMING_HYBRID_ENCRYPT_H_
+#define TINK_HYBRID_ECIES_HKDF_AES_GCM_STREAMING_HYBRID_ENCRYPT_H_
+
+#include <memory>
+
+#include "absl/strings/string_view.h"
+#include "tink/output_stream.h"
+#include "tink/streaming_hybrid_encrypt.h"
+#include "tink/subtle/ecies_hkdf_sender_kem_boringssl.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "proto/ecies_hkdf_aes_gcm_streaming.pb.h"
+
+namespace crypto {
+namespace tink {
+
+// Streaming ECIES encryption with HKDF-KEM (key encapsulation mechanism)
+// and segmented AES-GCM as DEM (data encapsulation mechanism).
+//
+// Each stream starts with fresh KEM bytes, from which the recipient derives
+// the AES-GCM key of the stream; the rest of the stream are the segments
+// produced by subtle::AesGcmStreamSegmentEncrypter.  'context_info' is the
+// HKDF info, and is thus bound to the derived key.
+class EciesHkdfAesGcmStreamingHybridEncrypt : public StreamingHybridEncrypt {
+ public:
+  // Returns a StreamingHybridEncrypt-primitive that uses the key material
+  // given in 'recipient_key'.
+  static crypto::tink::util::StatusOr<std::unique_ptr<StreamingHybridEncrypt>>
+  New(const google::crypto::tink::EciesHkdfAesGcmStreamingPublicKey&
+          recipient_key);
+
+  crypto::tink::util::StatusOr<std::unique_ptr<crypto::tink::OutputStream>>
+  NewEncryptingStream(
+      std::unique_ptr<crypto::tink::OutputStream> ciphertext_destination,
+      absl::string_view context_info) const override;
+
+  ~EciesHkdfAesGcmStreamingHybridEncrypt() override {}
+
+ private:
+  static crypto::tink::util::Status Validate(
+      const google::crypto::tink::EciesHkdfAesGcmStreamingPublicKey& key);
+
+  EciesHkdfAesGcmStreamingHybridEncrypt(
+      const google::crypto::tink::EciesHkdfAesGcmStreamingPublicKey&
+          recipient_key,
+      std::unique_ptr<subtle::EciesHkdfSenderKemBoringSsl> sender_kem)
+      : recipient_key_(recipient_key), sender_kem_(std::move(sender_kem)) {}
+
+  google::crypto::tink::EciesHkdfAesGcmStreamingPublicKey recipient_key_;
+  std::unique_ptr<subtle::EciesHkdfSenderKemBoringSsl> sender_kem_;
+};
+
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_HYBRID_ECIES_HKDF_AES_GCM_STREAMING_HYBRID_ENCRYPT_H_
@@ -0,0 +1,163 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/hybrid/ecies_hkdf_aes_gcm_streaming_private_key_manager.h"
+
+#include "gtest/gtest.h"
+#include "tink/hybrid/ecies_hkdf_aes_gcm_streaming_public_key_manager.h"
+#include "tink/hybrid/hybrid_key_templates.h"
+#include "tink/streaming_hybrid_decrypt.h"
+#include "tink/streaming_hybrid_encrypt.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "proto/aes_eax.pb.h"
+#include "proto/common.pb.h"
+#include "proto/ecies_hkdf_aes_gcm_streaming.pb.h"
+#include "proto/tink.pb.h"
+
+namespace crypto {
+namespace tink {
+
+using google::crypto::tink::AesEaxKey;
+using google::crypto::tink::EciesHkdfAesGcmStreamingKeyFormat;
+using google::crypto::tink::EciesHkdfAesGcmStreamingPrivateKey;
+using google::crypto::tink::EciesHkdfAesGcmStreamingPublicKey;
+using google::crypto::tink::EllipticCurveType;
+using google::crypto::tink::KeyData;
+
+namespace {
+
+class EciesHkdfAesGcmStreamingPrivateKeyManagerTest : public ::testing::Test {
+ protected:
+  EciesHkdfAesGcmStreamingKeyFormat KeyFormat() {
+    EciesHkdfAesGcmStreamingKeyFormat key_format;
+    EXPECT_TRUE(key_format.ParseFromString(
+        HybridKeyTemplates::EciesP256HkdfHmacSha256Aes128GcmStreaming4KB()
+            .value()));
+    return key_format;
+  }
+
+  std::string ecies_private_key_type =
+      "type.googleapis.com/"
+      "google.crypto.tink.EciesHkdfAesGcmStreamingPrivateKey";
+  std::string ecies_public_key_type =
+      "type.googleapis.com/"
+      "google.crypto.tink.EciesHkdfAesGcmStreamingPublicKey";
+};
+
+TEST_F(EciesHkdfAesGcmStreamingPrivateKeyManagerTest, testBasic) {
+  EciesHkdfAesGcmStreamingPrivateKeyManager key_manager;
+
+  EXPECT_EQ(0, key_manager.get_version());
+  EXPECT_EQ(ecies_private_key_type, key_manager.get_key_type());
+  EXPECT_TRUE(key_manager.DoesSupport(key_manager.get_key_type()));
+
+  EciesHkdfAesGcmStreamingPublicKeyManager public_key_manager;
+  EXPECT_EQ(ecies_public_key_type, public_key_manager.get_key_type());
+}
+
+TEST_F(EciesHkdfAesGcmStreamingPrivateKeyManagerTest, testKeyMessageErrors) {
+  EciesHkdfAesGcmStreamingPrivateKeyManager key_manager;
+
+  {  // Bad protobuffer.
+    AesEaxKey key;
+    auto result = key_manager.GetPrimitive(key);
+    EXPECT_FALSE(result.ok());
+    EXPECT_EQ(util::error::INVALID_ARGUMENT, result.status().error_code());
+    EXPECT_PRED_FORMAT2(testing::IsSubstring, "not supported",
+                        result.status().error_message());
+  }
+
+  {  // Bad version.
+    EciesHkdfAesGcmStreamingPrivateKey key;
+    key.set_version(1);
+    auto result = key_manager.GetPrimitive(key);
+    EXPECT_FALSE(result.ok());
+    EXPECT_EQ(util::error::INVALID_ARGUMENT, result.status().error_code());
+    EXPECT_PRED_FORMAT2(testing::IsSubstring, "version",
+                        result.status().error_message());
+  }
+}
+
+TEST_F(EciesHkdfAesGcmStreamingPrivateKeyManagerTest, testKeyFormatErrors) {
+  EciesHkdfAesGcmStreamingPrivateKeyManager key_manager;
+  const KeyFactory& key_factory = key_manager.get_key_factory();
+
+  {  // Missing params.
+    EciesHkdfAesGcmStreamingKeyFormat key_format;
+    EXPECT_FALSE(key_factory.NewKey(key_format).ok());
+  }
+
+  {  // Unknown curve.
+    auto key_format = KeyFormat();
+    key_format.mutable_params()->mutable_kem_params()->set_curve_type(
+        EllipticCurveType::UNKNOWN_CURVE);
+    EXPECT_FALSE(key_factory.NewKey(key_format).ok());
+  }
+
+  {  // Invalid derived key size.
+    auto key_format = KeyFormat();
+    key_format.mutable_params()->set_derived_key_size(24);
+    auto result = key_factory.NewKey(key_format);
+    EXPECT_FALSE(result.ok());
+    EXPECT_EQ(util::error::INVALID_ARGUMENT, result.status().error_code());
+  }
+
+  {  // Ciphertext segments that leave no room for the header and a tag.
+    auto key_format = KeyFormat();
+    key_format.mutable_params()->set_ciphertext_segment_size(65 + 16);
+    auto result = key_factory.NewKey(key_format);
+    EXPECT_FALSE(result.ok());
+    EXPECT_PRED_FORMAT2(testing::IsSubstring, "too small",
+                        result.status().error_message());
+  }
+}
+
+TEST_F(EciesHkdfAesGcmStreamingPrivateKeyManagerTest, testPrimitives) {
+  EciesHkdfAesGcmStreamingPrivateKeyManager key_manager;
+  EciesHkdfAesGcmStreamingPublicKeyManager public_key_manager;
+  const KeyFactory& key_factory = key_manager.get_key_factory();
+  auto key_format = KeyFormat();
+
+  auto new_key_result = key_factory.NewKey(key_format);
+  ASSERT_TRUE(new_key_result.ok()) << new_key_result.status();
+  auto* key = static_cast<EciesHkdfAesGcmStreamingPrivateKey*>(
+      new_key_result.ValueOrDie().get());
+  EXPECT_EQ(0, key->version());
+  EXPECT_EQ(key_format.params().SerializeAsString(),
+            key->public_key().params().SerializeAsString());
+  EXPECT_FALSE(key->key_value().empty());
+
+  auto decrypt_result = key_manager.GetPrimitive(*key);
+  EXPECT_TRUE(decrypt_result.ok()) << decrypt_result.status();
+
+  // The public key data matches the public key of the private key.
+  auto public_key_data_result =
+      dynamic_cast<const PrivateKeyFactory&>(key_factory)
+          .GetPublicKeyData(key->SerializeAsString());
+  ASSERT_TRUE(public_key_data_result.ok()) << public_key_data_result.status();
+  auto public_key_data = std::move(public_key_data_result.ValueOrDie());
+  EXPECT_EQ(ecies_public_key_type, public_key_data->type_url());
+  EXPECT_EQ(KeyData::ASYMMETRIC_PUBLIC, public_key_data->key_material_type());
+  EXPECT_EQ(key->public_key().SerializeAsString(), public_key_data->value());
+
+  auto encrypt_result = public_key_manager.GetPrimitive(*public_key_data);
+  EXPECT_TRUE(encrypt_result.ok()) << encrypt_result.status();
+}
+
+}  // namespace
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,137 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/hybrid/ecies_hkdf_aes_gcm_streaming_public_key_manager.h"
+
+#include <limits>
+
+#include "absl/strings/string_view.h"
+#include "tink/hybrid/ecies_hkdf_aes_gcm_streaming_hybrid_encrypt.h"
+#include "tink/key_manager.h"
+#include "tink/streaming_hybrid_encrypt.h"
+#include "tink/subtle/ec_util.h"
+#include "tink/util/enums.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "tink/util/validation.h"
+#include "proto/common.pb.h"
+#include "proto/ecies_hkdf_aes_gcm_streaming.pb.h"
+#include "proto/tink.pb.h"
+
+namespace crypto {
+namespace tink {
+
+using crypto::tink::util::Status;
+using crypto::tink::util::StatusOr;
+using google::crypto::tink::EciesHkdfAesGcmStreamingKeyFormat;
+using google::crypto::tink::EciesHkdfAesGcmStreamingParams;
+using google::crypto::tink::EciesHkdfAesGcmStreamingPublicKey;
+using google::crypto::tink::EcPointFormat;
+using google::crypto::tink::EllipticCurveType;
+using google::crypto::tink::HashType;
+
+constexpr uint32_t EciesHkdfAesGcmStreamingPublicKeyManager::kVersion;
+
+EciesHkdfAesGcmStreamingPublicKeyManager::
+    EciesHkdfAesGcmStreamingPublicKeyManager()
+    : key_factory_(KeyFactory::AlwaysFailingFactory(
+          util::Status(util::error::UNIMPLEMENTED,
+                       "Operation not supported for public keys, please use "
+                       "EciesHkdfAesGcmStreamingPrivateKeyManager."))) {}
+
+const KeyFactory&
+EciesHkdfAesGcmStreamingPublicKeyManager::get_key_factory() const {
+  return *key_factory_;
+}
+
+uint32_t EciesHkdfAesGcmStreamingPublicKeyManager::get_version() const {
+  return kVersion;
+}
+
+StatusOr<std::unique_ptr<StreamingHybridEncrypt>>
+EciesHkdfAesGcmStreamingPublicKeyManager::GetPrimitiveFromKey(
+    const EciesHkdfAesGcmStreamingPublicKey& recipient_key) const {
+  Status status = Validate(recipient_key);
+  if (!status.ok()) return status;
+  auto ecies_result =
+      EciesHkdfAesGcmStreamingHybridEncrypt::New(recipient_key);
+  if (!ecies_result.ok()) return ecies_result.status();
+  return std::move(ecies_result.ValueOrDie());
+}
+
+// static
+Status EciesHkdfAesGcmStreamingPublicKeyManager::Validate(
+    const EciesHkdfAesGcmStreamingParams& params) {
+  // Validate KEM params.
+  if (!params.has_kem_params()) {
+    return Status(util::error::INVALID_ARGUMENT, "Missing kem_params.");
+  }
+  if (params.kem_params().curve_type() == EllipticCurveType::UNKNOWN_CURVE ||
+      params.kem_params().hkdf_hash_type() == HashType::UNKNOWN_HASH) {
+    return Status(util::error::INVALID_ARGUMENT, "Invalid kem_params.");
+  }
+
+  // Validate EC point format.
+  if (params.ec_point_format() == EcPointFormat::UNKNOWN_FORMAT) {
+    return Status(util::error::INVALID_ARGUMENT, "Unknown EC point format.");
+  }
+
+  // Validate DEM params.
+  if (params.derived_key_size() != 16 && params.derived_key_size() != 32) {
+    return Status(util::error::INVALID_ARGUMENT,
+                  "derived_key_size must be 16 or 32.");
+  }
+  // The first segment shares its space with the header (the KEM bytes),
+  // and must still hold at least one byte of plaintext besides the tag.
+  auto header_size_result = subtle::EcUtil::EncodingSizeInBytes(
+      util::Enums::ProtoToSubtle(params.kem_params().curve_type()),
+      util::Enums::ProtoToSubtle(params.ec_point_format()));
+  if (!header_size_result.ok()) return header_size_result.status();
+  if (params.ciphertext_segment_size() <=
+      header_size_result.ValueOrDie() + 16) {
+    return Status(util::error::INVALID_ARGUMENT,
+                  "ciphertext_segment_size too small.");
+  }
+  if (params.ciphertext_segment_size() >
+      std::numeric_limits<int32_t>::max()) {
+    return Status(util::error::INVALID_ARGUMENT,
+                  "ciphertext_segment_size too large.");
+  }
+  return Status::OK;
+}
+
+// static
+Status EciesHkdfAesGcmStreamingPublicKeyManager::Validate(
+    const EciesHkdfAesGcmStreamingPublicKey& key) {
+  Status status = ValidateVersion(key.version(), kVersion);
+  if (!status.ok()) return status;
+  if (!key.has_params()) {
+    return Status(util::error::INVALID_ARGUMENT, "Missing params.");
+  }
+  return Validate(key.params());
+}
+
+// static
+Status EciesHkdfAesGcmStreamingPublicKeyManager::Validate(
+    const EciesHkdfAesGcmStreamingKeyFormat& key_format) {
+  if (!key_format.has_params()) {
+    return Status(util::error::INVALID_ARGUMENT, "Missing params.");
+  }
+  return Validate(key_format.params());
+}
+
+}  // namespace tink
+}  // namespace crypto
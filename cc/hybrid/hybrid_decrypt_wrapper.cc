@@ -18,7 +18,9 @@
 
 #include "tink/crypto_format.h"
 #include "tink/hybrid_decrypt.h"
+#include "tink/monitoring/monitoring.h"
 #include "tink/primitive_set.h"
+#include "tink/raw_key_trial_order.h"
 #include "tink/subtle/subtle_util_boringssl.h"
 #include "tink/util/status.h"
 #include "tink/util/statusor.h"
@@ -32,7 +34,10 @@ class HybridDecryptSetWrapper : public HybridDecrypt {
  public:
   explicit HybridDecryptSetWrapper(
       std::unique_ptr<PrimitiveSet<HybridDecrypt>> hybrid_decrypt_set)
-      : hybrid_decrypt_set_(std::move(hybrid_decrypt_set)) {}
+      : hybrid_decrypt_set_(std::move(hybrid_decrypt_set)),
+        raw_primitives_(RawPrimitivesOrNull(hybrid_decrypt_set_.get())),
+        raw_key_trial_order_(raw_primitives_),
+        monitoring_sink_(Monitoring::GetSink()) {}
 
   crypto::tink::util::StatusOr<std::string> Decrypt(
       absl::string_view ciphertext,
@@ -42,6 +47,9 @@ class HybridDecryptSetWrapper : public HybridDecrypt {
 
  private:
   std::unique_ptr<PrimitiveSet<HybridDecrypt>> hybrid_decrypt_set_;
+  const PrimitiveSet<HybridDecrypt>::Primitives* raw_primitives_;
+  RawKeyTrialOrder raw_key_trial_order_;
+  std::shared_ptr<MonitoringSink> monitoring_sink_;
 };
 
 util::StatusOr<std::string> HybridDecryptSetWrapper::Decrypt(
@@ -50,6 +58,9 @@ util::StatusOr<std::string> HybridDecryptSetWrapper::Decrypt(
   // BoringSSL expects a non-null pointer for context_info,
   // regardless of whether the size is 0.
   context_info = subtle::SubtleUtilBoringSSL::EnsureNonNull(context_info);
+  MonitoredOperation operation(monitoring_sink_.get(), "hybrid_decrypt",
+                               MonitoringOperation::kDecrypt,
+                               ciphertext.size());
 
   if (ciphertext.length() > CryptoFormat::kNonRawPrefixSize) {
     const std::string& key_id = std::string(ciphertext.substr(0,
@@ -59,10 +70,14 @@ util::StatusOr<std::string> HybridDecryptSetWrapper::Decrypt(
       absl::string_view raw_ciphertext =
           ciphertext.substr(CryptoFormat::kNonRawPrefixSize);
       for (auto& hybrid_decrypt_entry : *(primitives_result.ValueOrDie())) {
-        HybridDecrypt& hybrid_decrypt = hybrid_decrypt_entry->get_primitive();
+        auto hybrid_decrypt_result =
+            hybrid_decrypt_entry->GetOrCreatePrimitive();
+        if (!hybrid_decrypt_result.ok()) continue;
+        HybridDecrypt& hybrid_decrypt = *hybrid_decrypt_result.ValueOrDie();
         auto decrypt_result =
             hybrid_decrypt.Decrypt(raw_ciphertext, context_info);
         if (decrypt_result.ok()) {
+          operation.RecordSuccess(hybrid_decrypt_entry->get_key_id());
           return std::move(decrypt_result.ValueOrDie());
         } else {
           // LOG that a matching key didn't decrypt the ciphertext.
@@ -72,17 +87,27 @@ util::StatusOr<std::string> HybridDecryptSetWrapper::Decrypt(
   }
 
   // No matching key succeeded with decryption, try all RAW keys.
-  auto raw_primitives_result = hybrid_decrypt_set_->get_raw_primitives();
-  if (raw_primitives_result.ok()) {
-    for (auto& hybrid_decrypt_entry : *(raw_primitives_result.ValueOrDie())) {
-        HybridDecrypt& hybrid_decrypt = hybrid_decrypt_entry->get_primitive();
-      auto decrypt_result = hybrid_decrypt.Decrypt(ciphertext, context_info);
-      if (decrypt_result.ok()) {
-        return std::move(decrypt_result.ValueOrDie());
-      }
-    }
+  std::string plaintext;
+  int index = raw_key_trial_order_.TryKeys([&](int i) {
+    operation.AddRawTrial();
+    auto hybrid_decrypt_result =
+        (*raw_primitives_)[i]->GetOrCreatePrimitive();
+    if (!hybrid_decrypt_result.ok()) return false;
+    auto decrypt_result =
+        hybrid_decrypt_result.ValueOrDie()->Decrypt(ciphertext, context_info);
+    if (!decrypt_result.ok()) return false;
+    plaintext = std::move(decrypt_result.ValueOrDie());
+    return true;
+  });
+  if (index >= 0) {
+    operation.RecordSuccess((*raw_primitives_)[index]->get_key_id());
+    return std::move(plaintext);
   }
-  return util::Status(util::error::INVALID_ARGUMENT, "decryption failed");
+  operation.RecordFailure();
+  static const util::StaticStatus* kDecryptionFailed =
+      new util::StaticStatus(util::error::INVALID_ARGUMENT,
+                             "decryption failed");
+  return *kDecryptionFailed;
 }
 
 util::Status Validate(PrimitiveSet<HybridDecrypt>* hybrid_decrypt_set) {
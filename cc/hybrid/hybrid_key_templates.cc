@@ -19,6 +19,7 @@
 #include "absl/strings/string_view.h"
 #include "tink/aead/aead_key_templates.h"
 #include "proto/ecies_aead_hkdf.pb.h"
+#include "proto/ecies_hkdf_aes_gcm_streaming.pb.h"
 #include "proto/common.pb.h"
 #include "proto/tink.pb.h"
 
@@ -27,6 +28,7 @@ namespace tink {
 namespace {
 
 using google::crypto::tink::EciesAeadHkdfKeyFormat;
+using google::crypto::tink::EciesHkdfAesGcmStreamingKeyFormat;
 using google::crypto::tink::EcPointFormat;
 using google::crypto::tink::EllipticCurveType;
 using google::crypto::tink::HashType;
@@ -55,6 +57,31 @@ KeyTemplate* NewEciesAeadHkdfKeyTemplate(
   return key_template;
 }
 
+KeyTemplate* NewEciesHkdfAesGcmStreamingKeyTemplate(
+    EllipticCurveType curve_type,
+    HashType hkdf_hash_type,
+    EcPointFormat ec_point_format,
+    int derived_key_size,
+    int ciphertext_segment_size,
+    absl::string_view hkdf_salt) {
+  KeyTemplate* key_template = new KeyTemplate;
+  key_template->set_type_url(
+      "type.googleapis.com/"
+      "google.crypto.tink.EciesHkdfAesGcmStreamingPrivateKey");
+  key_template->set_output_prefix_type(OutputPrefixType::TINK);
+  EciesHkdfAesGcmStreamingKeyFormat key_format;
+  auto params = key_format.mutable_params();
+  params->set_ec_point_format(ec_point_format);
+  params->set_derived_key_size(derived_key_size);
+  params->set_ciphertext_segment_size(ciphertext_segment_size);
+  auto kem_params = params->mutable_kem_params();
+  kem_params->set_curve_type(curve_type);
+  kem_params->set_hkdf_hash_type(hkdf_hash_type);
+  kem_params->set_hkdf_salt(std::string(hkdf_salt));
+  key_format.SerializeToString(key_template->mutable_value());
+  return key_template;
+}
+
 }  // anonymous namespace
 
 // static
@@ -80,6 +107,16 @@ HybridKeyTemplates::EciesP256HkdfHmacSha256Aes128CtrHmacSha256() {
   return *key_template;
 }
 
+// static
+const KeyTemplate&
+HybridKeyTemplates::EciesP256HkdfHmacSha256Aes128GcmStreaming4KB() {
+  static const KeyTemplate* key_template =
+      NewEciesHkdfAesGcmStreamingKeyTemplate(
+          EllipticCurveType::NIST_P256, HashType::SHA256,
+          EcPointFormat::UNCOMPRESSED, /* derived_key_size= */ 16,
+          /* ciphertext_segment_size= */ 4096, /* hkdf_salt= */ "");
+  return *key_template;
+}
 
 }  // namespace tink
 }  // namespace crypto
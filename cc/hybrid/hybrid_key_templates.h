@@ -57,6 +57,17 @@ class HybridKeyTemplates {
   //   - OutputPrefixType: TINK
   static const google::crypto::tink::KeyTemplate&
   EciesP256HkdfHmacSha256Aes128CtrHmacSha256();
+
+  // Returns a KeyTemplate that generates new instances of
+  // EciesHkdfAesGcmStreamingPrivateKey, i.e. keys for StreamingHybridEncrypt
+  // and StreamingHybridDecrypt, with the following parameters:
+  //   - KEM: ECDH over NIST P-256, with uncompressed points
+  //   - KDF: HKDF-HMAC-SHA256 with an empty salt
+  //   - derived key size: 16 bytes (AES128-GCM)
+  //   - ciphertext segment size: 4096 bytes
+  //   - OutputPrefixType: TINK
+  static const google::crypto::tink::KeyTemplate&
+  EciesP256HkdfHmacSha256Aes128GcmStreaming4KB();
 };
 
 }  // namespace tink
@@ -18,9 +18,11 @@
 
 #include "tink/aead/aead_key_templates.h"
 #include "tink/hybrid/ecies_aead_hkdf_private_key_manager.h"
+#include "tink/hybrid/ecies_hkdf_aes_gcm_streaming_private_key_manager.h"
 #include "tink/hybrid/hybrid_config.h"
 #include "proto/common.pb.h"
 #include "proto/ecies_aead_hkdf.pb.h"
+#include "proto/ecies_hkdf_aes_gcm_streaming.pb.h"
 #include "proto/tink.pb.h"
 #include "gtest/gtest.h"
 
@@ -29,6 +31,7 @@ namespace tink {
 namespace {
 
 using google::crypto::tink::EciesAeadHkdfKeyFormat;
+using google::crypto::tink::EciesHkdfAesGcmStreamingKeyFormat;
 using google::crypto::tink::EcPointFormat;
 using google::crypto::tink::EllipticCurveType;
 using google::crypto::tink::HashType;
@@ -118,6 +121,39 @@ TEST_F(HybridKeyTemplatesTest, testEciesAeadHkdf) {
   }
 }
 
+TEST_F(HybridKeyTemplatesTest, testEciesHkdfAesGcmStreaming) {
+  std::string type_url =
+      "type.googleapis.com/"
+      "google.crypto.tink.EciesHkdfAesGcmStreamingPrivateKey";
+
+  // Check that returned template is correct.
+  const KeyTemplate& key_template =
+      HybridKeyTemplates::EciesP256HkdfHmacSha256Aes128GcmStreaming4KB();
+  EXPECT_EQ(type_url, key_template.type_url());
+  EXPECT_EQ(OutputPrefixType::TINK, key_template.output_prefix_type());
+  EciesHkdfAesGcmStreamingKeyFormat key_format;
+  EXPECT_TRUE(key_format.ParseFromString(key_template.value()));
+  EXPECT_EQ(EcPointFormat::UNCOMPRESSED,
+            key_format.params().ec_point_format());
+  EXPECT_EQ(16, key_format.params().derived_key_size());
+  EXPECT_EQ(4096, key_format.params().ciphertext_segment_size());
+  auto kem_params = key_format.params().kem_params();
+  EXPECT_EQ(EllipticCurveType::NIST_P256, kem_params.curve_type());
+  EXPECT_EQ(HashType::SHA256, kem_params.hkdf_hash_type());
+  EXPECT_EQ("", kem_params.hkdf_salt());
+
+  // Check that reference to the same object is returned.
+  const KeyTemplate& key_template_2 =
+      HybridKeyTemplates::EciesP256HkdfHmacSha256Aes128GcmStreaming4KB();
+  EXPECT_EQ(&key_template, &key_template_2);
+
+  // Check that the template works with the key manager.
+  EciesHkdfAesGcmStreamingPrivateKeyManager key_manager;
+  EXPECT_EQ(key_manager.get_key_type(), key_template.type_url());
+  auto new_key_result = key_manager.get_key_factory().NewKey(key_format);
+  EXPECT_TRUE(new_key_result.ok()) << new_key_result.status();
+}
+
 }  // namespace
 }  // namespace tink
 }  // namespace crypto
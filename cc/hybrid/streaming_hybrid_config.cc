@@ -0,0 +1,46 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/hybrid/streaming_hybrid_config.h"
+
+#include "absl/memory/memory.h"
+#include "tink/hybrid/ecies_hkdf_aes_gcm_streaming_private_key_manager.h"
+#include "tink/hybrid/ecies_hkdf_aes_gcm_streaming_public_key_manager.h"
+#include "tink/hybrid/streaming_hybrid_decrypt_wrapper.h"
+#include "tink/hybrid/streaming_hybrid_encrypt_wrapper.h"
+#include "tink/registry.h"
+#include "tink/util/status.h"
+
+namespace crypto {
+namespace tink {
+
+// static
+util::Status StreamingHybridConfig::Register() {
+  auto status = Registry::RegisterKeyManager(
+      absl::make_unique<EciesHkdfAesGcmStreamingPrivateKeyManager>(), true);
+  if (!status.ok()) return status;
+  status = Registry::RegisterKeyManager(
+      absl::make_unique<EciesHkdfAesGcmStreamingPublicKeyManager>(), true);
+  if (!status.ok()) return status;
+  status = Registry::RegisterPrimitiveWrapper(
+      absl::make_unique<StreamingHybridDecryptWrapper>());
+  if (!status.ok()) return status;
+  return Registry::RegisterPrimitiveWrapper(
+      absl::make_unique<StreamingHybridEncryptWrapper>());
+}
+
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,51 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_HYBRID_STREAMING_HYBRID_CONFIG_H_
+#define TINK_HYBRID_STREAMING_HYBRID_CONFIG_H_
+
+#include "tink/util/status.h"
+
+namespace crypto {
+namespace tink {
+
+///////////////////////////////////////////////////////////////////////////////
+// Static methods for registering with the Registry all key types of
+// StreamingHybridEncrypt and StreamingHybridDecrypt, together with the
+// wrappers of their primitive sets.
+//
+// The streaming key types have no catalogue, so unlike HybridConfig there
+// is no RegistryConfig; the key managers are registered directly:
+//
+//   auto status = StreamingHybridConfig::Register();
+//   if (!status.ok()) { /* fail with error */ }
+//   auto handle_result = KeysetHandle::GenerateNew(
+//        HybridKeyTemplates::EciesP256HkdfHmacSha256Aes128GcmStreaming4KB());
+class StreamingHybridConfig {
+ public:
+  // Registers key managers and wrappers for all implementations of
+  // StreamingHybridEncrypt and StreamingHybridDecrypt from the current
+  // Tink release.
+  static crypto::tink::util::Status Register();
+
+ private:
+  StreamingHybridConfig() {}
+};
+
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_HYBRID_STREAMING_HYBRID_CONFIG_H_
@@ -0,0 +1,141 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/hybrid/streaming_hybrid_config.h"
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "absl/memory/memory.h"
+#include "tink/hybrid/hybrid_key_templates.h"
+#include "tink/keyset_handle.h"
+#include "tink/registry.h"
+#include "tink/streaming_hybrid_decrypt.h"
+#include "tink/streaming_hybrid_encrypt.h"
+#include "tink/subtle/random.h"
+#include "tink/util/istream_input_stream.h"
+#include "tink/util/ostream_output_stream.h"
+#include "tink/util/status.h"
+
+namespace crypto {
+namespace tink {
+namespace {
+
+class StreamingHybridConfigTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    Registry::Reset();
+  }
+};
+
+TEST_F(StreamingHybridConfigTest, testRegister) {
+  std::string decrypt_key_type =
+      "type.googleapis.com/"
+      "google.crypto.tink.EciesHkdfAesGcmStreamingPrivateKey";
+  std::string encrypt_key_type =
+      "type.googleapis.com/"
+      "google.crypto.tink.EciesHkdfAesGcmStreamingPublicKey";
+
+  // No key manager before registration.
+  EXPECT_FALSE(
+      Registry::get_key_manager<StreamingHybridDecrypt>(decrypt_key_type)
+          .ok());
+  EXPECT_FALSE(
+      Registry::get_key_manager<StreamingHybridEncrypt>(encrypt_key_type)
+          .ok());
+
+  auto status = StreamingHybridConfig::Register();
+  EXPECT_TRUE(status.ok()) << status;
+  EXPECT_TRUE(
+      Registry::get_key_manager<StreamingHybridDecrypt>(decrypt_key_type)
+          .ok());
+  EXPECT_TRUE(
+      Registry::get_key_manager<StreamingHybridEncrypt>(encrypt_key_type)
+          .ok());
+
+  // Registering again is fine.
+  status = StreamingHybridConfig::Register();
+  EXPECT_TRUE(status.ok()) << status;
+}
+
+TEST_F(StreamingHybridConfigTest, testEncryptDecryptWithKeysetHandle) {
+  ASSERT_TRUE(StreamingHybridConfig::Register().ok());
+  auto private_handle_result = KeysetHandle::GenerateNew(
+      HybridKeyTemplates::EciesP256HkdfHmacSha256Aes128GcmStreaming4KB());
+  ASSERT_TRUE(private_handle_result.ok()) << private_handle_result.status();
+  auto private_handle = std::move(private_handle_result.ValueOrDie());
+  auto public_handle_result = private_handle->GetPublicKeysetHandle();
+  ASSERT_TRUE(public_handle_result.ok()) << public_handle_result.status();
+  auto public_handle = std::move(public_handle_result.ValueOrDie());
+
+  auto encrypt_result =
+      public_handle->GetPrimitive<StreamingHybridEncrypt>();
+  ASSERT_TRUE(encrypt_result.ok()) << encrypt_result.status();
+  auto decrypt_result =
+      private_handle->GetPrimitive<StreamingHybridDecrypt>();
+  ASSERT_TRUE(decrypt_result.ok()) << decrypt_result.status();
+
+  // Several segments of 4KB.
+  std::string plaintext = subtle::Random::GetRandomBytes(20000);
+  std::string context_info = "some context info";
+
+  auto ct_stream = absl::make_unique<std::stringstream>();
+  std::stringbuf* ct_buf = ct_stream->rdbuf();
+  auto enc_stream_result =
+      encrypt_result.ValueOrDie()->NewEncryptingStream(
+          absl::make_unique<util::OstreamOutputStream>(std::move(ct_stream)),
+          context_info);
+  ASSERT_TRUE(enc_stream_result.ok()) << enc_stream_result.status();
+  auto enc_stream = std::move(enc_stream_result.ValueOrDie());
+  absl::string_view remaining = plaintext;
+  while (!remaining.empty()) {
+    void* buffer;
+    auto next_result = enc_stream->Next(&buffer);
+    ASSERT_TRUE(next_result.ok()) << next_result.status();
+    int size = std::min<int>(next_result.ValueOrDie(), remaining.size());
+    memcpy(buffer, remaining.data(), size);
+    remaining.remove_prefix(size);
+    enc_stream->BackUp(next_result.ValueOrDie() - size);
+  }
+  ASSERT_TRUE(enc_stream->Close().ok());
+
+  auto dec_stream_result =
+      decrypt_result.ValueOrDie()->NewDecryptingStream(
+          absl::make_unique<util::IstreamInputStream>(
+              absl::make_unique<std::stringstream>(ct_buf->str())),
+          context_info);
+  ASSERT_TRUE(dec_stream_result.ok()) << dec_stream_result.status();
+  auto dec_stream = std::move(dec_stream_result.ValueOrDie());
+  std::string decrypted;
+  const void* buffer;
+  while (true) {
+    auto next_result = dec_stream->Next(&buffer);
+    if (!next_result.ok()) {
+      EXPECT_EQ(util::error::OUT_OF_RANGE,
+                next_result.status().error_code()) << next_result.status();
+      break;
+    }
+    decrypted.append(static_cast<const char*>(buffer),
+                     next_result.ValueOrDie());
+  }
+  EXPECT_EQ(plaintext, decrypted);
+}
+
+}  // namespace
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,199 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/hybrid/streaming_hybrid_decrypt_wrapper.h"
+
+#include <algorithm>
+#include <string>
+
+#include "tink/crypto_format.h"
+#include "tink/input_stream.h"
+#include "tink/primitive_set.h"
+#include "tink/streaming_hybrid_decrypt.h"
+#include "tink/subtle/subtle_util_boringssl.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+
+namespace {
+
+util::Status Validate(
+    PrimitiveSet<StreamingHybridDecrypt>* hybrid_decrypt_set) {
+  if (hybrid_decrypt_set == nullptr) {
+    return util::Status(util::error::INTERNAL,
+                        "hybrid_decrypt_set must be non-NULL");
+  }
+  if (hybrid_decrypt_set->get_primary() == nullptr) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+                        "hybrid_decrypt_set has no primary");
+  }
+  return util::Status::OK;
+}
+
+// Appends bytes from 'input_stream' to 'contents', until 'contents' has
+// 'size' bytes or the end of 'input_stream' is reached.
+util::Status ReadFromStream(InputStream* input_stream, int size,
+                            std::string* contents) {
+  while (contents->size() < size) {
+    const void* buffer;
+    auto next_result = input_stream->Next(&buffer);
+    if (!next_result.ok()) {
+      if (next_result.status().error_code() == util::error::OUT_OF_RANGE) {
+        return util::Status::OK;
+      }
+      return next_result.status();
+    }
+    int available_bytes = next_result.ValueOrDie();
+    int count =
+        std::min(available_bytes, size - static_cast<int>(contents->size()));
+    contents->append(static_cast<const char*>(buffer), count);
+    if (available_bytes > count) {
+      input_stream->BackUp(available_bytes - count);
+    }
+  }
+  return util::Status::OK;
+}
+
+// An InputStream that returns 'prefix' and then the rest of 'source'.
+// Puts back the bytes that were read from a stream to look for a key
+// prefix, when the stream turns out to be the ciphertext of a RAW key.
+class PrefixedInputStream : public InputStream {
+ public:
+  PrefixedInputStream(std::string prefix, std::unique_ptr<InputStream> source)
+      : prefix_(std::move(prefix)),
+        source_(std::move(source)),
+        source_start_(source_->Position()),
+        prefix_offset_(0),
+        last_from_prefix_(0) {}
+
+  util::StatusOr<int> Next(const void** data) override {
+    if (prefix_offset_ < prefix_.size()) {
+      *data = prefix_.data() + prefix_offset_;
+      last_from_prefix_ = prefix_.size() - prefix_offset_;
+      prefix_offset_ = prefix_.size();
+      return last_from_prefix_;
+    }
+    last_from_prefix_ = 0;
+    return source_->Next(data);
+  }
+
+  void BackUp(int count) override {
+    if (last_from_prefix_ == 0) {
+      source_->BackUp(count);
+      return;
+    }
+    int actual_count = std::min(std::max(count, 0), last_from_prefix_);
+    prefix_offset_ -= actual_count;
+    last_from_prefix_ -= actual_count;
+  }
+
+  int64_t Position() const override {
+    return prefix_offset_ + (source_->Position() - source_start_);
+  }
+
+ private:
+  const std::string prefix_;
+  const std::unique_ptr<InputStream> source_;
+  const int64_t source_start_;
+  int prefix_offset_;     // # bytes of prefix_ already returned
+  int last_from_prefix_;  // # bytes of prefix_ returned by the last Next()
+};
+
+class StreamingHybridDecryptSetWrapper : public StreamingHybridDecrypt {
+ public:
+  explicit StreamingHybridDecryptSetWrapper(
+      std::unique_ptr<PrimitiveSet<StreamingHybridDecrypt>>
+          hybrid_decrypt_set)
+      : hybrid_decrypt_set_(std::move(hybrid_decrypt_set)) {}
+
+  crypto::tink::util::StatusOr<std::unique_ptr<crypto::tink::InputStream>>
+  NewDecryptingStream(
+      std::unique_ptr<crypto::tink::InputStream> ciphertext_source,
+      absl::string_view context_info) const override;
+
+  ~StreamingHybridDecryptSetWrapper() override {}
+
+ private:
+  std::unique_ptr<PrimitiveSet<StreamingHybridDecrypt>> hybrid_decrypt_set_;
+};
+
+util::StatusOr<std::unique_ptr<InputStream>>
+StreamingHybridDecryptSetWrapper::NewDecryptingStream(
+    std::unique_ptr<InputStream> ciphertext_source,
+    absl::string_view context_info) const {
+  if (ciphertext_source == nullptr) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+                        "ciphertext_source must be non-null");
+  }
+  // BoringSSL expects a non-null pointer for context_info,
+  // regardless of whether the size is 0.
+  context_info = subtle::SubtleUtilBoringSSL::EnsureNonNull(context_info);
+
+  std::string key_id;
+  auto status = ReadFromStream(ciphertext_source.get(),
+                               CryptoFormat::kNonRawPrefixSize, &key_id);
+  if (!status.ok()) return status;
+  if (key_id.size() == CryptoFormat::kNonRawPrefixSize) {
+    auto primitives_result = hybrid_decrypt_set_->get_primitives(key_id);
+    if (primitives_result.ok()) {
+      for (auto& hybrid_decrypt_entry : *(primitives_result.ValueOrDie())) {
+        auto hybrid_decrypt_result =
+            hybrid_decrypt_entry->GetOrCreatePrimitive();
+        if (!hybrid_decrypt_result.ok()) continue;
+        return hybrid_decrypt_result.ValueOrDie()->NewDecryptingStream(
+            std::move(ciphertext_source), context_info);
+      }
+    }
+  }
+
+  // No key matches the prefix, so the stream is decrypted with a RAW key,
+  // from its very beginning.
+  auto raw_primitives_result = hybrid_decrypt_set_->get_raw_primitives();
+  if (raw_primitives_result.ok()) {
+    for (auto& hybrid_decrypt_entry : *(raw_primitives_result.ValueOrDie())) {
+      auto hybrid_decrypt_result =
+          hybrid_decrypt_entry->GetOrCreatePrimitive();
+      if (!hybrid_decrypt_result.ok()) continue;
+      std::unique_ptr<InputStream> raw_ciphertext_source(
+          new PrefixedInputStream(std::move(key_id),
+                                  std::move(ciphertext_source)));
+      return hybrid_decrypt_result.ValueOrDie()->NewDecryptingStream(
+          std::move(raw_ciphertext_source), context_info);
+    }
+  }
+  static const util::StaticStatus* kDecryptionFailed =
+      new util::StaticStatus(util::error::INVALID_ARGUMENT,
+                             "decryption failed");
+  return *kDecryptionFailed;
+}
+
+}  // anonymous namespace
+
+util::StatusOr<std::unique_ptr<StreamingHybridDecrypt>>
+StreamingHybridDecryptWrapper::Wrap(
+    std::unique_ptr<PrimitiveSet<StreamingHybridDecrypt>> primitive_set)
+    const {
+  util::Status status = Validate(primitive_set.get());
+  if (!status.ok()) return status;
+  std::unique_ptr<StreamingHybridDecrypt> hybrid_decrypt(
+      new StreamingHybridDecryptSetWrapper(std::move(primitive_set)));
+  return std::move(hybrid_decrypt);
+}
+
+}  // namespace tink
+}  // namespace crypto
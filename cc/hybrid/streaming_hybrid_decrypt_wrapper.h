@@ -0,0 +1,48 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_HYBRID_STREAMING_HYBRID_DECRYPT_WRAPPER_H_
+#define TINK_HYBRID_STREAMING_HYBRID_DECRYPT_WRAPPER_H_
+
+#include "tink/primitive_set.h"
+#include "tink/primitive_wrapper.h"
+#include "tink/streaming_hybrid_decrypt.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+
+// Wraps a set of StreamingHybridDecrypt-instances that correspond to
+// a keyset, and combines them into a single StreamingHybridDecrypt-primitive,
+// that for actual decryption uses the instance that matches the prefix of
+// the ciphertext stream.
+//
+// Unlike HybridDecryptWrapper, this wrapper cannot try several keys on the
+// same ciphertext, since it does not buffer the stream: the first key with
+// a matching prefix is used, and a stream without a matching prefix is
+// decrypted with the first RAW key of the keyset.
+class StreamingHybridDecryptWrapper
+    : public PrimitiveWrapper<StreamingHybridDecrypt> {
+ public:
+  util::StatusOr<std::unique_ptr<StreamingHybridDecrypt>> Wrap(
+      std::unique_ptr<PrimitiveSet<StreamingHybridDecrypt>> primitive_set)
+      const override;
+};
+
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_HYBRID_STREAMING_HYBRID_DECRYPT_WRAPPER_H_
@@ -0,0 +1,191 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/hybrid/streaming_hybrid_decrypt_wrapper.h"
+
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "tink/input_stream.h"
+#include "tink/primitive_set.h"
+#include "tink/streaming_hybrid_decrypt.h"
+#include "tink/util/istream_input_stream.h"
+#include "tink/util/status.h"
+#include "tink/util/test_util.h"
+
+using crypto::tink::test::DummyStreamingHybridDecrypt;
+using crypto::tink::util::IstreamInputStream;
+using google::crypto::tink::Keyset;
+using google::crypto::tink::OutputPrefixType;
+
+namespace crypto {
+namespace tink {
+namespace {
+
+// Decrypts 'ciphertext' with 'hybrid_decrypt', reading the ciphertext in
+// chunks of 'chunk_size' bytes.
+util::StatusOr<std::string> Decrypt(
+    const StreamingHybridDecrypt& hybrid_decrypt,
+    absl::string_view ciphertext, absl::string_view context_info,
+    int chunk_size) {
+  auto dec_stream_result = hybrid_decrypt.NewDecryptingStream(
+      absl::make_unique<IstreamInputStream>(
+          absl::make_unique<std::stringstream>(std::string(ciphertext)),
+          chunk_size),
+      context_info);
+  if (!dec_stream_result.ok()) return dec_stream_result.status();
+  auto dec_stream = std::move(dec_stream_result.ValueOrDie());
+  std::string plaintext;
+  const void* buffer;
+  while (true) {
+    auto next_result = dec_stream->Next(&buffer);
+    if (!next_result.ok()) {
+      if (next_result.status().error_code() == util::error::OUT_OF_RANGE) {
+        break;
+      }
+      return next_result.status();
+    }
+    plaintext.append(static_cast<const char*>(buffer),
+                     next_result.ValueOrDie());
+  }
+  return plaintext;
+}
+
+class StreamingHybridDecryptSetWrapperTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    Keyset::Key* key = keyset_.add_key();
+    key->set_output_prefix_type(OutputPrefixType::RAW);
+    key->set_key_id(1234543);
+    key = keyset_.add_key();
+    key->set_output_prefix_type(OutputPrefixType::LEGACY);
+    key->set_key_id(726329);
+    key = keyset_.add_key();
+    key->set_output_prefix_type(OutputPrefixType::TINK);
+    key->set_key_id(7213743);
+
+    auto hybrid_decrypt_set =
+        absl::make_unique<PrimitiveSet<StreamingHybridDecrypt>>();
+    for (int i = 0; i < 3; i++) {
+      auto entry_result = hybrid_decrypt_set->AddPrimitive(
+          absl::make_unique<DummyStreamingHybridDecrypt>(
+              absl::StrCat("hybrid_", i)),
+          keyset_.key(i));
+      ASSERT_TRUE(entry_result.ok());
+      prefixes_.push_back(entry_result.ValueOrDie()->get_identifier());
+      // The last key is the primary.
+      hybrid_decrypt_set->set_primary(entry_result.ValueOrDie());
+    }
+    auto hybrid_decrypt_result = StreamingHybridDecryptWrapper().Wrap(
+        std::move(hybrid_decrypt_set));
+    ASSERT_TRUE(hybrid_decrypt_result.ok()) << hybrid_decrypt_result.status();
+    hybrid_decrypt_ = std::move(hybrid_decrypt_result.ValueOrDie());
+  }
+
+  // Returns the ciphertext of the dummy primitive of the i-th key.
+  std::string Ciphertext(int i) {
+    return absl::StrCat(prefixes_[i], "DummyStreamingHybrid:hybrid_", i,
+                        context_info_, plaintext_);
+  }
+
+  Keyset keyset_;
+  std::vector<std::string> prefixes_;
+  std::unique_ptr<StreamingHybridDecrypt> hybrid_decrypt_;
+  std::string plaintext_ = "some_plaintext";
+  std::string context_info_ = "some_context";
+};
+
+TEST_F(StreamingHybridDecryptSetWrapperTest, InvalidSets) {
+  {  // hybrid_decrypt_set is nullptr.
+    auto hybrid_decrypt_result =
+        StreamingHybridDecryptWrapper().Wrap(nullptr);
+    EXPECT_FALSE(hybrid_decrypt_result.ok());
+    EXPECT_EQ(util::error::INTERNAL,
+              hybrid_decrypt_result.status().error_code());
+    EXPECT_PRED_FORMAT2(testing::IsSubstring, "non-NULL",
+                        hybrid_decrypt_result.status().error_message());
+  }
+
+  {  // hybrid_decrypt_set has no primary primitive.
+    auto hybrid_decrypt_result = StreamingHybridDecryptWrapper().Wrap(
+        absl::make_unique<PrimitiveSet<StreamingHybridDecrypt>>());
+    EXPECT_FALSE(hybrid_decrypt_result.ok());
+    EXPECT_EQ(util::error::INVALID_ARGUMENT,
+              hybrid_decrypt_result.status().error_code());
+    EXPECT_PRED_FORMAT2(testing::IsSubstring, "no primary",
+                        hybrid_decrypt_result.status().error_message());
+  }
+}
+
+TEST_F(StreamingHybridDecryptSetWrapperTest, DecryptsWithMatchingKey) {
+  for (int chunk_size : {1, 3, 4096}) {
+    for (int i = 0; i < 3; i++) {
+      SCOPED_TRACE(absl::StrCat("key = ", i, ", chunk_size = ", chunk_size));
+      auto decrypt_result = Decrypt(*hybrid_decrypt_, Ciphertext(i),
+                                    context_info_, chunk_size);
+      EXPECT_TRUE(decrypt_result.ok()) << decrypt_result.status();
+      EXPECT_EQ(plaintext_, decrypt_result.ValueOrDie());
+    }
+  }
+}
+
+TEST_F(StreamingHybridDecryptSetWrapperTest, DecryptionFailures) {
+  // A matching prefix, but the wrong context_info.
+  auto decrypt_result = Decrypt(*hybrid_decrypt_, Ciphertext(1),
+                                "other_context", 4096);
+  EXPECT_FALSE(decrypt_result.ok());
+
+  // No matching prefix: decrypted by the RAW key, which fails.
+  std::string ciphertext = Ciphertext(1).substr(prefixes_[1].size());
+  decrypt_result = Decrypt(*hybrid_decrypt_, ciphertext, context_info_, 4096);
+  EXPECT_FALSE(decrypt_result.ok());
+  EXPECT_PRED_FORMAT2(testing::IsSubstring, "Corrupted header",
+                      decrypt_result.status().error_message());
+
+  // A ciphertext shorter than a prefix.
+  decrypt_result = Decrypt(*hybrid_decrypt_, "abc", context_info_, 4096);
+  EXPECT_FALSE(decrypt_result.ok());
+}
+
+TEST_F(StreamingHybridDecryptSetWrapperTest, NoRawKey) {
+  auto hybrid_decrypt_set =
+      absl::make_unique<PrimitiveSet<StreamingHybridDecrypt>>();
+  auto entry_result = hybrid_decrypt_set->AddPrimitive(
+      absl::make_unique<DummyStreamingHybridDecrypt>("hybrid_2"),
+      keyset_.key(2));
+  ASSERT_TRUE(entry_result.ok());
+  hybrid_decrypt_set->set_primary(entry_result.ValueOrDie());
+  auto hybrid_decrypt = std::move(StreamingHybridDecryptWrapper().Wrap(
+      std::move(hybrid_decrypt_set)).ValueOrDie());
+
+  auto decrypt_result = Decrypt(*hybrid_decrypt, Ciphertext(2),
+                                context_info_, 4096);
+  EXPECT_TRUE(decrypt_result.ok()) << decrypt_result.status();
+  decrypt_result = Decrypt(*hybrid_decrypt, Ciphertext(1),
+                           context_info_, 4096);
+  EXPECT_FALSE(decrypt_result.ok());
+  EXPECT_EQ(util::error::INVALID_ARGUMENT,
+            decrypt_result.status().error_code());
+  EXPECT_PRED_FORMAT2(testing::IsSubstring, "decryption failed",
+                      decrypt_result.status().error_message());
+}
+
+}  // namespace
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,126 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/hybrid/streaming_hybrid_encrypt_wrapper.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include "tink/output_stream.h"
+#include "tink/primitive_set.h"
+#include "tink/streaming_hybrid_encrypt.h"
+#include "tink/subtle/subtle_util_boringssl.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+
+namespace {
+
+util::Status Validate(
+    PrimitiveSet<StreamingHybridEncrypt>* hybrid_encrypt_set) {
+  if (hybrid_encrypt_set == nullptr) {
+    return util::Status(util::error::INTERNAL,
+                        "hybrid_encrypt_set must be non-NULL");
+  }
+  if (hybrid_encrypt_set->get_primary() == nullptr) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+                        "hybrid_encrypt_set has no primary");
+  }
+  return util::Status::OK;
+}
+
+// Writes 'contents' to 'output_stream', backing up the unused space.
+util::Status WriteToStream(const std::string& contents,
+                           OutputStream* output_stream) {
+  int pos = 0;
+  while (pos < contents.size()) {
+    void* buffer;
+    auto next_result = output_stream->Next(&buffer);
+    if (!next_result.ok()) return next_result.status();
+    int available_space = next_result.ValueOrDie();
+    int count =
+        std::min(available_space, static_cast<int>(contents.size()) - pos);
+    memcpy(buffer, contents.data() + pos, count);
+    if (available_space > count) {
+      output_stream->BackUp(available_space - count);
+    }
+    pos += count;
+  }
+  return util::Status::OK;
+}
+
+// Returns a StreamingHybridEncrypt-primitive that uses the primary
+// StreamingHybridEncrypt-instance provided in 'hybrid_encrypt_set',
+// which must be non-NULL (and must contain a primary instance).
+class StreamingHybridEncryptSetWrapper : public StreamingHybridEncrypt {
+ public:
+  explicit StreamingHybridEncryptSetWrapper(
+      std::unique_ptr<PrimitiveSet<StreamingHybridEncrypt>>
+          hybrid_encrypt_set)
+      : hybrid_encrypt_set_(std::move(hybrid_encrypt_set)) {}
+
+  crypto::tink::util::StatusOr<std::unique_ptr<crypto::tink::OutputStream>>
+  NewEncryptingStream(
+      std::unique_ptr<crypto::tink::OutputStream> ciphertext_destination,
+      absl::string_view context_info) const override;
+
+  ~StreamingHybridEncryptSetWrapper() override {}
+
+ private:
+  std::unique_ptr<PrimitiveSet<StreamingHybridEncrypt>> hybrid_encrypt_set_;
+};
+
+util::StatusOr<std::unique_ptr<OutputStream>>
+StreamingHybridEncryptSetWrapper::NewEncryptingStream(
+    std::unique_ptr<OutputStream> ciphertext_destination,
+    absl::string_view context_info) const {
+  if (ciphertext_destination == nullptr) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+                        "ciphertext_destination must be non-null");
+  }
+  // BoringSSL expects a non-null pointer for context_info,
+  // regardless of whether the size is 0.
+  context_info = subtle::SubtleUtilBoringSSL::EnsureNonNull(context_info);
+
+  auto primary = hybrid_encrypt_set_->get_primary();
+  auto hybrid_encrypt_result = primary->GetOrCreatePrimitive();
+  if (!hybrid_encrypt_result.ok()) return hybrid_encrypt_result.status();
+  // The key prefix goes in front of the stream written by the primitive.
+  auto status = WriteToStream(primary->get_identifier(),
+                              ciphertext_destination.get());
+  if (!status.ok()) return status;
+  return hybrid_encrypt_result.ValueOrDie()->NewEncryptingStream(
+      std::move(ciphertext_destination), context_info);
+}
+
+}  // anonymous namespace
+
+util::StatusOr<std::unique_ptr<StreamingHybridEncrypt>>
+StreamingHybridEncryptWrapper::Wrap(
+    std::unique_ptr<PrimitiveSet<StreamingHybridEncrypt>> primitive_set)
+    const {
+  util::Status status = Validate(primitive_set.get());
+  if (!status.ok()) return status;
+  std::unique_ptr<StreamingHybridEncrypt> hybrid_encrypt(
+      new StreamingHybridEncryptSetWrapper(std::move(primitive_set)));
+  return std::move(hybrid_encrypt);
+}
+
+}  // namespace tink
+}  // namespace crypto
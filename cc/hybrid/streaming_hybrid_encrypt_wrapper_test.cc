@@ -0,0 +1,129 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/hybrid/streaming_hybrid_encrypt_wrapper.h"
+
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "absl/memory/memory.h"
+#include "tink/output_stream.h"
+#include "tink/primitive_set.h"
+#include "tink/streaming_hybrid_encrypt.h"
+#include "tink/util/ostream_output_stream.h"
+#include "tink/util/status.h"
+#include "tink/util/test_util.h"
+
+using crypto::tink::test::DummyStreamingHybridEncrypt;
+using crypto::tink::util::OstreamOutputStream;
+using google::crypto::tink::Keyset;
+using google::crypto::tink::OutputPrefixType;
+
+namespace crypto {
+namespace tink {
+namespace {
+
+// Encrypts 'plaintext' with 'hybrid_encrypt', and returns the ciphertext.
+std::string Encrypt(const StreamingHybridEncrypt& hybrid_encrypt,
+                    absl::string_view plaintext,
+                    absl::string_view context_info) {
+  auto ct_stream = absl::make_unique<std::stringstream>();
+  std::stringbuf* ct_buf = ct_stream->rdbuf();
+  auto enc_stream_result = hybrid_encrypt.NewEncryptingStream(
+      absl::make_unique<OstreamOutputStream>(std::move(ct_stream)),
+      context_info);
+  EXPECT_TRUE(enc_stream_result.ok()) << enc_stream_result.status();
+  auto enc_stream = std::move(enc_stream_result.ValueOrDie());
+  void* buffer;
+  auto next_result = enc_stream->Next(&buffer);
+  EXPECT_TRUE(next_result.ok()) << next_result.status();
+  EXPECT_GE(next_result.ValueOrDie(), plaintext.size());
+  memcpy(buffer, plaintext.data(), plaintext.size());
+  enc_stream->BackUp(next_result.ValueOrDie() - plaintext.size());
+  EXPECT_TRUE(enc_stream->Close().ok());
+  return ct_buf->str();
+}
+
+TEST(StreamingHybridEncryptSetWrapperTest, InvalidSets) {
+  {  // hybrid_encrypt_set is nullptr.
+    auto hybrid_encrypt_result =
+        StreamingHybridEncryptWrapper().Wrap(nullptr);
+    EXPECT_FALSE(hybrid_encrypt_result.ok());
+    EXPECT_EQ(util::error::INTERNAL,
+              hybrid_encrypt_result.status().error_code());
+    EXPECT_PRED_FORMAT2(testing::IsSubstring, "non-NULL",
+                        hybrid_encrypt_result.status().error_message());
+  }
+
+  {  // hybrid_encrypt_set has no primary primitive.
+    auto hybrid_encrypt_result = StreamingHybridEncryptWrapper().Wrap(
+        absl::make_unique<PrimitiveSet<StreamingHybridEncrypt>>());
+    EXPECT_FALSE(hybrid_encrypt_result.ok());
+    EXPECT_EQ(util::error::INVALID_ARGUMENT,
+              hybrid_encrypt_result.status().error_code());
+    EXPECT_PRED_FORMAT2(testing::IsSubstring, "no primary",
+                        hybrid_encrypt_result.status().error_message());
+  }
+}
+
+TEST(StreamingHybridEncryptSetWrapperTest, EncryptsWithPrimary) {
+  Keyset keyset;
+  Keyset::Key* key = keyset.add_key();
+  key->set_output_prefix_type(OutputPrefixType::TINK);
+  key->set_key_id(1234543);
+  key = keyset.add_key();
+  key->set_output_prefix_type(OutputPrefixType::RAW);
+  key->set_key_id(726329);
+
+  std::string plaintext = "some_plaintext";
+  std::string context_info = "some_context";
+  for (int primary : {0, 1}) {
+    auto hybrid_encrypt_set =
+        absl::make_unique<PrimitiveSet<StreamingHybridEncrypt>>();
+    auto entry_result = hybrid_encrypt_set->AddPrimitive(
+        absl::make_unique<DummyStreamingHybridEncrypt>("hybrid_0"),
+        keyset.key(0));
+    ASSERT_TRUE(entry_result.ok());
+    auto* entry_0 = entry_result.ValueOrDie();
+    entry_result = hybrid_encrypt_set->AddPrimitive(
+        absl::make_unique<DummyStreamingHybridEncrypt>("hybrid_1"),
+        keyset.key(1));
+    ASSERT_TRUE(entry_result.ok());
+    auto* primary_entry = primary == 0 ? entry_0 : entry_result.ValueOrDie();
+    hybrid_encrypt_set->set_primary(primary_entry);
+    std::string prefix = primary_entry->get_identifier();
+
+    auto hybrid_encrypt_result = StreamingHybridEncryptWrapper().Wrap(
+        std::move(hybrid_encrypt_set));
+    ASSERT_TRUE(hybrid_encrypt_result.ok()) << hybrid_encrypt_result.status();
+    auto hybrid_encrypt = std::move(hybrid_encrypt_result.ValueOrDie());
+
+    // The ciphertext is the prefix of the primary key, followed by
+    // the stream written by the primary primitive.
+    std::string expected_ciphertext = prefix;
+    expected_ciphertext.append(Encrypt(
+        DummyStreamingHybridEncrypt(primary == 0 ? "hybrid_0" : "hybrid_1"),
+        plaintext, context_info));
+    EXPECT_EQ(primary == 0 ? 5 : 0, prefix.size());
+    EXPECT_EQ(expected_ciphertext,
+              Encrypt(*hybrid_encrypt, plaintext, context_info));
+  }
+}
+
+}  // namespace
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,85 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/integration/fakekms/fake_kms_client.h"
+
+#include <cstring>
+
+#include "absl/strings/match.h"
+#include "tink/aead.h"
+#include "tink/util/errors.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+namespace integration {
+namespace fakekms {
+
+using crypto::tink::util::Status;
+using crypto::tink::util::StatusOr;
+
+constexpr char FakeKmsClient::kKeyUriPrefix[];
+
+namespace {
+
+// An Aead that forwards all requests to a key in a FakeKmsServer.
+class FakeKmsAead : public Aead {
+ public:
+  FakeKmsAead(absl::string_view key_name,
+              std::shared_ptr<FakeKmsServer> server)
+      : key_name_(key_name), server_(std::move(server)) {}
+
+  StatusOr<std::string> Encrypt(
+      absl::string_view plaintext,
+      absl::string_view associated_data) const override {
+    return server_->Encrypt(key_name_, plaintext, associated_data);
+  }
+
+  StatusOr<std::string> Decrypt(
+      absl::string_view ciphertext,
+      absl::string_view associated_data) const override {
+    return server_->Decrypt(key_name_, ciphertext, associated_data);
+  }
+
+ private:
+  std::string key_name_;
+  std::shared_ptr<FakeKmsServer> server_;
+};
+
+}  // namespace
+
+bool FakeKmsClient::DoesSupport(absl::string_view key_uri) const {
+  return absl::StartsWith(key_uri, kKeyUriPrefix) &&
+      key_uri.size() > strlen(kKeyUriPrefix);
+}
+
+StatusOr<std::unique_ptr<Aead>> FakeKmsClient::GetAead(
+    absl::string_view key_uri) const {
+  if (!DoesSupport(key_uri)) {
+    return ToStatusF(util::error::INVALID_ARGUMENT,
+                     "Key URI '%s' not supported.",
+                     std::string(key_uri).c_str());
+  }
+  absl::string_view key_name = key_uri.substr(strlen(kKeyUriPrefix));
+  std::unique_ptr<Aead> aead(new FakeKmsAead(key_name, server_));
+  return std::move(aead);
+}
+
+}  // namespace fakekms
+}  // namespace integration
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,59 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_INTEGRATION_FAKEKMS_FAKE_KMS_CLIENT_H_
+#define TINK_INTEGRATION_FAKEKMS_FAKE_KMS_CLIENT_H_
+
+#include <memory>
+
+#include "absl/strings/string_view.h"
+#include "tink/aead.h"
+#include "tink/integration/fakekms/fake_kms_server.h"
+#include "tink/kms_client.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+namespace integration {
+namespace fakekms {
+
+// FakeKmsClient is an implementation of KmsClient that talks
+// to an in-process FakeKmsServer.
+// It supports key URIs of the form "fake-kms://<key name>".
+class FakeKmsClient : public KmsClient {
+ public:
+  static constexpr char kKeyUriPrefix[] = "fake-kms://";
+
+  explicit FakeKmsClient(std::shared_ptr<FakeKmsServer> server)
+      : server_(std::move(server)) {}
+
+  bool DoesSupport(absl::string_view key_uri) const override;
+
+  crypto::tink::util::StatusOr<std::unique_ptr<Aead>> GetAead(
+      absl::string_view key_uri) const override;
+
+  ~FakeKmsClient() override {}
+
+ private:
+  std::shared_ptr<FakeKmsServer> server_;
+};
+
+}  // namespace fakekms
+}  // namespace integration
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_INTEGRATION_FAKEKMS_FAKE_KMS_CLIENT_H_
@@ -0,0 +1,99 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/integration/fakekms/fake_kms_client.h"
+
+#include "gtest/gtest.h"
+#include "absl/time/time.h"
+#include "tink/integration/fakekms/fake_kms_server.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+namespace integration {
+namespace fakekms {
+namespace {
+
+TEST(FakeKmsClientTest, DoesSupport) {
+  FakeKmsClient client(std::make_shared<FakeKmsServer>(absl::ZeroDuration()));
+  EXPECT_TRUE(client.DoesSupport("fake-kms://some-key"));
+  EXPECT_FALSE(client.DoesSupport("fake-kms://"));
+  EXPECT_FALSE(client.DoesSupport("aws-kms://some-key"));
+  EXPECT_FALSE(client.DoesSupport(""));
+}
+
+TEST(FakeKmsClientTest, EncryptDecrypt) {
+  auto server = std::make_shared<FakeKmsServer>(absl::ZeroDuration());
+  ASSERT_TRUE(server->CreateKey("key-1").ok());
+  FakeKmsClient client(server);
+  auto aead_result = client.GetAead("fake-kms://key-1");
+  ASSERT_TRUE(aead_result.ok()) << aead_result.status();
+  auto aead = std::move(aead_result.ValueOrDie());
+
+  std::string plaintext = "some plaintext";
+  std::string aad = "some aad";
+  auto encrypt_result = aead->Encrypt(plaintext, aad);
+  ASSERT_TRUE(encrypt_result.ok()) << encrypt_result.status();
+  auto decrypt_result = aead->Decrypt(encrypt_result.ValueOrDie(), aad);
+  ASSERT_TRUE(decrypt_result.ok()) << decrypt_result.status();
+  EXPECT_EQ(plaintext, decrypt_result.ValueOrDie());
+  EXPECT_EQ(2, server->request_count());
+
+  decrypt_result = aead->Decrypt(encrypt_result.ValueOrDie(), "other aad");
+  EXPECT_FALSE(decrypt_result.ok());
+  EXPECT_EQ(3, server->request_count());
+}
+
+TEST(FakeKmsClientTest, KeysAreIndependent) {
+  auto server = std::make_shared<FakeKmsServer>(absl::ZeroDuration());
+  ASSERT_TRUE(server->CreateKey("key-1").ok());
+  ASSERT_TRUE(server->CreateKey("key-2").ok());
+  FakeKmsClient client(server);
+  auto aead_1 = std::move(client.GetAead("fake-kms://key-1").ValueOrDie());
+  auto aead_2 = std::move(client.GetAead("fake-kms://key-2").ValueOrDie());
+  auto encrypt_result = aead_1->Encrypt("plaintext", "aad");
+  ASSERT_TRUE(encrypt_result.ok()) << encrypt_result.status();
+  EXPECT_FALSE(aead_2->Decrypt(encrypt_result.ValueOrDie(), "aad").ok());
+}
+
+TEST(FakeKmsClientTest, Errors) {
+  auto server = std::make_shared<FakeKmsServer>(absl::ZeroDuration());
+  ASSERT_TRUE(server->CreateKey("key-1").ok());
+  auto status = server->CreateKey("key-1");
+  EXPECT_EQ(util::error::ALREADY_EXISTS, status.error_code());
+  status = server->CreateKey("");
+  EXPECT_EQ(util::error::INVALID_ARGUMENT, status.error_code());
+
+  FakeKmsClient client(server);
+  auto aead_result = client.GetAead("aws-kms://key-1");
+  EXPECT_FALSE(aead_result.ok());
+  EXPECT_EQ(util::error::INVALID_ARGUMENT,
+            aead_result.status().error_code());
+
+  auto unknown_aead_result = client.GetAead("fake-kms://unknown-key");
+  ASSERT_TRUE(unknown_aead_result.ok()) << unknown_aead_result.status();
+  auto encrypt_result =
+      unknown_aead_result.ValueOrDie()->Encrypt("plaintext", "aad");
+  EXPECT_FALSE(encrypt_result.ok());
+  EXPECT_EQ(util::error::NOT_FOUND, encrypt_result.status().error_code());
+}
+
+}  // namespace
+}  // namespace fakekms
+}  // namespace integration
+}  // namespace tink
+}  // namespace crypto
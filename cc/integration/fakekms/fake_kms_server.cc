@@ -0,0 +1,89 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/integration/fakekms/fake_kms_server.h"
+
+#include "absl/time/clock.h"
+#include "tink/subtle/aes_gcm_boringssl.h"
+#include "tink/subtle/random.h"
+#include "tink/util/errors.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+namespace integration {
+namespace fakekms {
+
+using crypto::tink::util::Status;
+using crypto::tink::util::StatusOr;
+
+namespace {
+
+const int kKeySizeInBytes = 32;
+
+}  // namespace
+
+Status FakeKmsServer::CreateKey(absl::string_view key_name) {
+  if (key_name.empty()) {
+    return Status(util::error::INVALID_ARGUMENT, "Key name cannot be empty.");
+  }
+  auto aead_result = subtle::AesGcmBoringSsl::New(
+      subtle::Random::GetRandomBytes(kKeySizeInBytes));
+  if (!aead_result.ok()) return aead_result.status();
+  absl::MutexLock lock(&mutex_);
+  if (!keys_.emplace(std::string(key_name),
+                     std::move(aead_result.ValueOrDie())).second) {
+    return ToStatusF(util::error::ALREADY_EXISTS,
+                     "Key '%s' already exists.",
+                     std::string(key_name).c_str());
+  }
+  return util::OkStatus();
+}
+
+StatusOr<const Aead*> FakeKmsServer::HandleRequest(absl::string_view key_name) {
+  request_count_++;
+  absl::SleepFor(latency_);
+  absl::MutexLock lock(&mutex_);
+  auto found = keys_.find(std::string(key_name));
+  if (found == keys_.end()) {
+    return ToStatusF(util::error::NOT_FOUND, "Key '%s' not found.",
+                     std::string(key_name).c_str());
+  }
+  // Keys are never removed, so the pointer stays valid.
+  return static_cast<const Aead*>(found->second.get());
+}
+
+StatusOr<std::string> FakeKmsServer::Encrypt(
+    absl::string_view key_name, absl::string_view plaintext,
+    absl::string_view associated_data) {
+  auto key_result = HandleRequest(key_name);
+  if (!key_result.ok()) return key_result.status();
+  return key_result.ValueOrDie()->Encrypt(plaintext, associated_data);
+}
+
+StatusOr<std::string> FakeKmsServer::Decrypt(
+    absl::string_view key_name, absl::string_view ciphertext,
+    absl::string_view associated_data) {
+  auto key_result = HandleRequest(key_name);
+  if (!key_result.ok()) return key_result.status();
+  return key_result.ValueOrDie()->Decrypt(ciphertext, associated_data);
+}
+
+}  // namespace fakekms
+}  // namespace integration
+}  // namespace tink
+}  // namespace crypto
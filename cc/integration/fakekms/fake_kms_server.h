@@ -0,0 +1,84 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_INTEGRATION_FAKEKMS_FAKE_KMS_SERVER_H_
+#define TINK_INTEGRATION_FAKEKMS_FAKE_KMS_SERVER_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "tink/aead.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+namespace integration {
+namespace fakekms {
+
+// An in-process stand-in for a remote key management service, meant
+// for tests and benchmarks that need a KMS without network access.
+//
+// The server holds named AES-GCM keys, and serves encryption and
+// decryption requests for them.  Each request is delayed by a configurable
+// latency, which simulates the network round-trip, and is counted,
+// so that the effect of latency hiding and request coalescing
+// in the clients can be measured.
+class FakeKmsServer {
+ public:
+  // Creates a server which delays each request by 'latency'.
+  explicit FakeKmsServer(absl::Duration latency)
+      : latency_(latency), request_count_(0) {}
+
+  // Creates a new key with the specified 'key_name'.
+  crypto::tink::util::Status CreateKey(absl::string_view key_name)
+      LOCKS_EXCLUDED(mutex_);
+
+  crypto::tink::util::StatusOr<std::string> Encrypt(
+      absl::string_view key_name, absl::string_view plaintext,
+      absl::string_view associated_data) LOCKS_EXCLUDED(mutex_);
+
+  crypto::tink::util::StatusOr<std::string> Decrypt(
+      absl::string_view key_name, absl::string_view ciphertext,
+      absl::string_view associated_data) LOCKS_EXCLUDED(mutex_);
+
+  // Returns the number of Encrypt- and Decrypt-requests served so far.
+  int64_t request_count() const { return request_count_; }
+
+ private:
+  // Simulates a round-trip, and returns the key named 'key_name'.
+  crypto::tink::util::StatusOr<const Aead*> HandleRequest(
+      absl::string_view key_name) LOCKS_EXCLUDED(mutex_);
+
+  const absl::Duration latency_;
+  std::atomic<int64_t> request_count_;
+  absl::Mutex mutex_;
+  std::unordered_map<std::string, std::unique_ptr<Aead>> keys_
+      GUARDED_BY(mutex_);
+};
+
+}  // namespace fakekms
+}  // namespace integration
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_INTEGRATION_FAKEKMS_FAKE_KMS_SERVER_H_
@@ -75,11 +75,28 @@ class KeysetHandle {
   crypto::tink::util::StatusOr<std::unique_ptr<P>> GetPrimitive(
       const KeyManager<P>* custom_manager) const;
 
+  // Like GetPrimitive(), but only the primitive of the primary key is
+  // created right away; the primitives of the other keys are created
+  // (thread-safely, at most once) the first time a ciphertext, MAC or
+  // signature with a matching prefix is processed, or a RAW key is tried.
+  // This makes the creation cost proportional to the keys actually used,
+  // which matters for keysets with many old keys of expensive key types
+  // (e.g. RSA, whose keys are checked when the primitive is created).
+  //
+  // Errors in non-primary keys are not reported by this function; such
+  // keys fail to process any input instead.  The KeyManagers in the
+  // global registry must stay registered for the lifetime of the
+  // returned primitive.  Primitives whose wrappers use only the primary
+  // (e.g. HybridEncrypt, PublicKeySign) are unaffected.
+  template <class P>
+  crypto::tink::util::StatusOr<std::unique_ptr<P>> GetPrimitiveLazily() const;
+
  private:
   // The classes below need access to get_keyset();
   friend class CleartextKeysetHandle;
   friend class NoSecretKeysetHandle;
   friend class KeysetManager;
+  friend class KeysetReloader;
   friend class RegistryImpl;
 
   // KeysetUtil::GetKeyset() provides access to get_keyset().
@@ -107,9 +124,13 @@ class KeysetHandle {
   //
   // The returned set is usually later "wrapped" into a class that
   // implements the corresponding Primitive-interface.
+  //
+  // If 'lazy' is true, the non-primary entries are added with
+  // PrimitiveSet::AddLazyPrimitive(), and created via the registry.
   template <class P>
   crypto::tink::util::StatusOr<std::unique_ptr<PrimitiveSet<P>>>
-      GetPrimitives(const KeyManager<P>* custom_manager) const;
+      GetPrimitives(const KeyManager<P>* custom_manager,
+                    bool lazy = false) const;
 
   google::crypto::tink::Keyset keyset_;
 };
@@ -119,12 +140,21 @@ class KeysetHandle {
 
 template <class P>
 crypto::tink::util::StatusOr<std::unique_ptr<PrimitiveSet<P>>>
-KeysetHandle::GetPrimitives(const KeyManager<P>* custom_manager) const {
+KeysetHandle::GetPrimitives(const KeyManager<P>* custom_manager,
+                            bool lazy) const {
   crypto::tink::util::Status status = ValidateKeyset(get_keyset());
   if (!status.ok()) return status;
   std::unique_ptr<PrimitiveSet<P>> primitives(new PrimitiveSet<P>());
   for (const google::crypto::tink::Keyset::Key& key : get_keyset().key()) {
     if (key.status() == google::crypto::tink::KeyStatusType::ENABLED) {
+      if (lazy && key.key_id() != get_keyset().primary_key_id()) {
+        google::crypto::tink::KeyData key_data = key.key_data();
+        auto entry_result = primitives->AddLazyPrimitive(
+            [key_data]() { return Registry::GetPrimitive<P>(key_data); },
+            key);
+        if (!entry_result.ok()) return entry_result.status();
+        continue;
+      }
       std::unique_ptr<P> primitive;
       if (custom_manager != nullptr &&
           custom_manager->DoesSupport(key.key_data().type_url())) {
@@ -170,6 +200,16 @@ crypto::tink::util::StatusOr<std::unique_ptr<P>> KeysetHandle::GetPrimitive(
   return Registry::Wrap<P>(std::move(primitives_result.ValueOrDie()));
 }
 
+template <class P>
+crypto::tink::util::StatusOr<std::unique_ptr<P>>
+KeysetHandle::GetPrimitiveLazily() const {
+  auto primitives_result = this->GetPrimitives<P>(nullptr, /*lazy=*/true);
+  if (!primitives_result.ok()) {
+    return primitives_result.status();
+  }
+  return Registry::Wrap<P>(std::move(primitives_result.ValueOrDie()));
+}
+
 
 }  // namespace tink
 }  // namespace crypto
@@ -0,0 +1,144 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_KEYSET_RELOADER_H_
+#define TINK_KEYSET_RELOADER_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+
+#include "absl/base/thread_annotations.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "tink/aead.h"
+#include "tink/keyset_handle.h"
+#include "tink/keyset_reader.h"
+#include "tink/monitoring/monitoring.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+
+// Keeps a keyset loaded from some source (e.g. a file, or a file encrypted
+// with a KMS key) up to date, and hands every new version of the keyset
+// to a publisher, e.g. ReloadingPrimitive<P>, which builds the primitive
+// for it.
+//
+// The keyset is loaded once by New(), and then again on every call to
+// Reload() (e.g. when the source notifies about a change) and, optionally,
+// periodically on a background thread.  A reload whose source bytes are
+// identical to those of the current keyset (compared by their SHA-256
+// digest) is neither parsed nor published.  A failed reload keeps the
+// current keyset.
+//
+// Every reload is reported to the MonitoringSink that is set when the
+// reloader is created, as a "keyset" kReloadKeyset-event with the
+// primary key id of the loaded keyset and the latency of the reload.
+class KeysetReloader {
+ public:
+  // Loads the keyset from the source, in two steps: 'read' returns the
+  // raw bytes of the source (e.g. the content of a file), and 'parse'
+  // builds the keyset from bytes returned by 'read'.
+  struct Loader {
+    std::function<crypto::tink::util::StatusOr<std::string>()> read;
+    std::function<crypto::tink::util::StatusOr<std::unique_ptr<KeysetHandle>>(
+        absl::string_view)>
+        parse;
+  };
+  // Builds and publishes whatever is derived from a new keyset.
+  using Publisher =
+      std::function<crypto::tink::util::Status(const KeysetHandle&)>;
+  // Returns a new reader for the source of the keyset.
+  using KeysetReaderFactory = std::function<
+      crypto::tink::util::StatusOr<std::unique_ptr<KeysetReader>>()>;
+
+  struct Stats {
+    // Number of reloads, including the initial load.
+    int64_t reload_count;
+    // Number of reloads that failed to load or to publish the keyset.
+    int64_t failure_count;
+    // Number of keysets published, including the initial one.
+    int64_t publish_count;
+    int64_t last_reload_latency_ns;
+    int64_t max_reload_latency_ns;
+  };
+
+  // Loads the keyset with 'loader', and publishes it with 'publisher'.
+  // If 'poll_interval' is positive, the keyset is then reloaded every
+  // 'poll_interval' on a background thread.  Fails if the initial load
+  // fails.
+  static crypto::tink::util::StatusOr<std::unique_ptr<KeysetReloader>> New(
+      Loader loader, Publisher publisher, absl::Duration poll_interval);
+
+  // Returns a Loader that reads an EncryptedKeyset with a reader returned
+  // by 'reader_factory', and decrypts it with 'master_key_aead'.  The bytes
+  // it compares are those of the EncryptedKeyset, i.e. ciphertext, so an
+  // unchanged keyset is not decrypted.
+  static Loader EncryptedKeysetLoader(KeysetReaderFactory reader_factory,
+                                      std::shared_ptr<Aead> master_key_aead);
+
+  KeysetReloader(const KeysetReloader&) = delete;
+  KeysetReloader& operator=(const KeysetReloader&) = delete;
+
+  // Stops and joins the background thread, if any.
+  ~KeysetReloader();
+
+  // Reloads the keyset, and publishes it if it has changed.  Concurrent
+  // reloads are serialized.
+  crypto::tink::util::Status Reload() LOCKS_EXCLUDED(reload_mutex_);
+
+  Stats GetStats() const LOCKS_EXCLUDED(stats_mutex_);
+
+ private:
+  KeysetReloader(Loader loader, Publisher publisher,
+                 std::shared_ptr<MonitoringSink> sink);
+
+  crypto::tink::util::Status LoadAndPublish()
+      EXCLUSIVE_LOCKS_REQUIRED(reload_mutex_);
+  void RecordReload(bool success, bool published, int64_t latency_ns)
+      LOCKS_EXCLUDED(stats_mutex_);
+
+  bool Stopping() const EXCLUSIVE_LOCKS_REQUIRED(poll_mutex_);
+  void PollLoop(absl::Duration poll_interval) LOCKS_EXCLUDED(poll_mutex_);
+
+  const Loader loader_;
+  const Publisher publisher_;
+  const std::shared_ptr<MonitoringSink> sink_;
+
+  absl::Mutex reload_mutex_;
+  // The SHA-256 digest of the source bytes of the keyset published last,
+  // empty before the first publication.
+  std::string current_digest_ GUARDED_BY(reload_mutex_);
+  // The primary key id of the keyset published last.
+  uint32_t current_primary_key_id_ GUARDED_BY(reload_mutex_);
+
+  mutable absl::Mutex stats_mutex_;
+  Stats stats_ GUARDED_BY(stats_mutex_);
+
+  absl::Mutex poll_mutex_;
+  bool stopping_ GUARDED_BY(poll_mutex_);
+  std::thread poll_thread_;
+};
+
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_KEYSET_RELOADER_H_
@@ -17,7 +17,9 @@
 #ifndef TINK_MAC_H_
 #define TINK_MAC_H_
 
+#include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "tink/util/status.h"
 #include "tink/util/statusor.h"
 
@@ -40,6 +42,23 @@ class Mac {
       absl::string_view mac_value,
       absl::string_view data) const = 0;
 
+  // Computes and returns the MAC for the concatenation of 'data_pieces',
+  // e.g. ComputeMacMultipart({header, body}).  The default implementation
+  // concatenates the pieces; implementations that process the data
+  // incrementally override it to avoid the copy.
+  virtual crypto::tink::util::StatusOr<std::string> ComputeMacMultipart(
+      absl::Span<const absl::string_view> data_pieces) const {
+    return ComputeMac(absl::StrJoin(data_pieces, ""));
+  }
+
+  // Verifies if 'mac' is a correct MAC for the concatenation of
+  // 'data_pieces'.  See ComputeMacMultipart().
+  virtual crypto::tink::util::Status VerifyMacMultipart(
+      absl::string_view mac_value,
+      absl::Span<const absl::string_view> data_pieces) const {
+    return VerifyMac(mac_value, absl::StrJoin(data_pieces, ""));
+  }
+
   virtual ~Mac() {}
 };
 
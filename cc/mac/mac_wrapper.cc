@@ -18,7 +18,9 @@
 
 #include "tink/crypto_format.h"
 #include "tink/mac.h"
+#include "tink/monitoring/monitoring.h"
 #include "tink/primitive_set.h"
+#include "tink/raw_key_trial_order.h"
 #include "tink/subtle/subtle_util_boringssl.h"
 #include "tink/util/status.h"
 #include "tink/util/statusor.h"
@@ -34,7 +36,10 @@ namespace {
 class MacSetWrapper : public Mac {
  public:
   explicit MacSetWrapper(std::unique_ptr<PrimitiveSet<Mac>> mac_set)
-      : mac_set_(std::move(mac_set)) {}
+      : mac_set_(std::move(mac_set)),
+        raw_primitives_(RawPrimitivesOrNull(mac_set_.get())),
+        raw_key_trial_order_(raw_primitives_),
+        monitoring_sink_(Monitoring::GetSink()) {}
 
   crypto::tink::util::StatusOr<std::string> ComputeMac(
       absl::string_view data) const override;
@@ -46,6 +51,9 @@ class MacSetWrapper : public Mac {
 
  private:
   std::unique_ptr<PrimitiveSet<Mac>> mac_set_;
+  const PrimitiveSet<Mac>::Primitives* raw_primitives_;
+  RawKeyTrialOrder raw_key_trial_order_;
+  std::shared_ptr<MonitoringSink> monitoring_sink_;
 };
 
 util::Status Validate(PrimitiveSet<Mac>* mac_set) {
@@ -64,17 +72,20 @@ util::StatusOr<std::string> MacSetWrapper::ComputeMac(
   // BoringSSL expects a non-null pointer for data,
   // regardless of whether the size is 0.
   data = subtle::SubtleUtilBoringSSL::EnsureNonNull(data);
+  MonitoredOperation operation(monitoring_sink_.get(), "mac",
+                               MonitoringOperation::kComputeMac, data.size());
 
   auto primary = mac_set_->get_primary();
-  std::string local_data;
-  if (primary->get_output_prefix_type() == OutputPrefixType::LEGACY) {
-    local_data = std::string(data);
-    local_data.append(
-        reinterpret_cast<const char*>(&CryptoFormat::kLegacyStartByte), 1);
-    data = local_data;
+  auto compute_mac_result =
+      primary->get_output_prefix_type() == OutputPrefixType::LEGACY
+          ? primary->get_primitive().ComputeMacMultipart(
+                {data, CryptoFormat::kLegacySuffix})
+          : primary->get_primitive().ComputeMac(data);
+  if (!compute_mac_result.ok()) {
+    operation.RecordFailure(primary->get_key_id());
+    return compute_mac_result.status();
   }
-  auto compute_mac_result = primary->get_primitive().ComputeMac(data);
-  if (!compute_mac_result.ok()) return compute_mac_result.status();
+  operation.RecordSuccess(primary->get_key_id());
   const std::string& key_id = primary->get_identifier();
   return key_id + compute_mac_result.ValueOrDie();
 }
@@ -84,6 +95,8 @@ util::Status MacSetWrapper::VerifyMac(
     absl::string_view data) const {
   data = subtle::SubtleUtilBoringSSL::EnsureNonNull(data);
   mac_value = subtle::SubtleUtilBoringSSL::EnsureNonNull(mac_value);
+  MonitoredOperation operation(monitoring_sink_.get(), "mac",
+                               MonitoringOperation::kVerifyMac, data.size());
 
   if (mac_value.length() > CryptoFormat::kNonRawPrefixSize) {
     const std::string& key_id = std::string(mac_value.substr(0,
@@ -92,16 +105,17 @@ util::Status MacSetWrapper::VerifyMac(
     if (primitives_result.ok()) {
       absl::string_view raw_mac_value =
           mac_value.substr(CryptoFormat::kNonRawPrefixSize);
-      std::string local_data;
       for (auto& mac_entry : *(primitives_result.ValueOrDie())) {
-        if (mac_entry->get_output_prefix_type() == OutputPrefixType::LEGACY) {
-          local_data = std::string(data);
-          local_data.append(1, CryptoFormat::kLegacyStartByte);
-          data = local_data;
-        }
-        Mac& mac = mac_entry->get_primitive();
-        util::Status status = mac.VerifyMac(raw_mac_value, data);
+        auto mac_result = mac_entry->GetOrCreatePrimitive();
+        if (!mac_result.ok()) continue;
+        Mac& mac = *mac_result.ValueOrDie();
+        util::Status status =
+            mac_entry->get_output_prefix_type() == OutputPrefixType::LEGACY
+                ? mac.VerifyMacMultipart(raw_mac_value,
+                                         {data, CryptoFormat::kLegacySuffix})
+                : mac.VerifyMac(raw_mac_value, data);
         if (status.ok()) {
+          operation.RecordSuccess(mac_entry->get_key_id());
           return status;
         } else {
           // TODO(przydatek): LOG that a matching key didn't verify the MAC.
@@ -111,17 +125,103 @@ util::Status MacSetWrapper::VerifyMac(
   }
 
   // No matching key succeeded with verification, try all RAW keys.
-  auto raw_primitives_result = mac_set_->get_raw_primitives();
-  if (raw_primitives_result.ok()) {
-    for (auto& mac_entry : *(raw_primitives_result.ValueOrDie())) {
-        Mac& mac = mac_entry->get_primitive();
-        util::Status status = mac.VerifyMac(mac_value, data);
-      if (status.ok()) {
-        return status;
-      }
-    }
+  int index = raw_key_trial_order_.TryKeys([&](int i) {
+    operation.AddRawTrial();
+    auto mac_result = (*raw_primitives_)[i]->GetOrCreatePrimitive();
+    if (!mac_result.ok()) return false;
+    return mac_result.ValueOrDie()->VerifyMac(mac_value, data).ok();
+  });
+  if (index >= 0) {
+    operation.RecordSuccess((*raw_primitives_)[index]->get_key_id());
+    return util::Status::OK;
   }
-  return util::Status(util::error::INVALID_ARGUMENT, "verification failed");
+  operation.RecordFailure();
+  static const util::StaticStatus* kVerificationFailed =
+      new util::StaticStatus(util::error::INVALID_ARGUMENT,
+                             "verification failed");
+  return *kVerificationFailed;
+}
+
+// The wrapper for a set with a single key, which is then the primary.
+// Binds the key's Mac and prefix at construction, see SingleKeyAeadWrapper.
+class SingleKeyMacWrapper : public Mac {
+ public:
+  explicit SingleKeyMacWrapper(std::unique_ptr<PrimitiveSet<Mac>> mac_set)
+      : mac_set_(std::move(mac_set)),
+        mac_(&mac_set_->get_primary()->get_primitive()),
+        prefix_(mac_set_->get_primary()->get_identifier()),
+        key_id_(mac_set_->get_primary()->get_key_id()),
+        is_legacy_(mac_set_->get_primary()->get_output_prefix_type() ==
+                   OutputPrefixType::LEGACY),
+        monitoring_sink_(Monitoring::GetSink()) {}
+
+  crypto::tink::util::StatusOr<std::string> ComputeMac(
+      absl::string_view data) const override;
+
+  crypto::tink::util::Status VerifyMac(absl::string_view mac_value,
+                                       absl::string_view data) const override;
+
+  ~SingleKeyMacWrapper() override {}
+
+ private:
+  std::unique_ptr<PrimitiveSet<Mac>> mac_set_;
+  const Mac* mac_;  // Owned by mac_set_.
+  const std::string prefix_;
+  const uint32_t key_id_;
+  const bool is_legacy_;
+  std::shared_ptr<MonitoringSink> monitoring_sink_;
+};
+
+util::StatusOr<std::string> SingleKeyMacWrapper::ComputeMac(
+    absl::string_view data) const {
+  data = subtle::SubtleUtilBoringSSL::EnsureNonNull(data);
+  MonitoredOperation operation(monitoring_sink_.get(), "mac",
+                               MonitoringOperation::kComputeMac, data.size());
+  auto compute_mac_result =
+      is_legacy_
+          ? mac_->ComputeMacMultipart({data, CryptoFormat::kLegacySuffix})
+          : mac_->ComputeMac(data);
+  if (!compute_mac_result.ok()) {
+    operation.RecordFailure(key_id_);
+    return compute_mac_result.status();
+  }
+  operation.RecordSuccess(key_id_);
+  std::string mac_value = std::move(compute_mac_result.ValueOrDie());
+  // Like SingleKeyAeadWrapper::Encrypt(), copies unless the key is RAW.
+  mac_value.insert(0, prefix_);
+  return std::move(mac_value);
+}
+
+util::Status SingleKeyMacWrapper::VerifyMac(absl::string_view mac_value,
+                                            absl::string_view data) const {
+  data = subtle::SubtleUtilBoringSSL::EnsureNonNull(data);
+  mac_value = subtle::SubtleUtilBoringSSL::EnsureNonNull(mac_value);
+  MonitoredOperation operation(monitoring_sink_.get(), "mac",
+                               MonitoringOperation::kVerifyMac, data.size());
+  if (prefix_.empty()) {
+    operation.AddRawTrial();
+  } else if (mac_value.size() <= prefix_.size() ||
+             mac_value.substr(0, prefix_.size()) != prefix_) {
+    operation.RecordFailure();
+    static const util::StaticStatus* kVerificationFailed =
+        new util::StaticStatus(util::error::INVALID_ARGUMENT,
+                               "verification failed");
+    return *kVerificationFailed;
+  }
+  absl::string_view raw_mac_value = mac_value.substr(prefix_.size());
+  util::Status status =
+      is_legacy_ ? mac_->VerifyMacMultipart(raw_mac_value,
+                                            {data, CryptoFormat::kLegacySuffix})
+                 : mac_->VerifyMac(raw_mac_value, data);
+  if (!status.ok()) {
+    operation.RecordFailure();
+    static const util::StaticStatus* kVerificationFailed =
+        new util::StaticStatus(util::error::INVALID_ARGUMENT,
+                               "verification failed");
+    return *kVerificationFailed;
+  }
+  operation.RecordSuccess(key_id_);
+  return util::Status::OK;
 }
 
 }  // namespace
@@ -130,7 +230,12 @@ util::StatusOr<std::unique_ptr<Mac>> MacWrapper::Wrap(
       std::unique_ptr<PrimitiveSet<Mac>> mac_set) const {
   util::Status status = Validate(mac_set.get());
   if (!status.ok()) return status;
-  std::unique_ptr<Mac> mac(new MacSetWrapper(std::move(mac_set)));
+  std::unique_ptr<Mac> mac;
+  if (mac_set->size() == 1) {
+    mac.reset(new SingleKeyMacWrapper(std::move(mac_set)));
+  } else {
+    mac.reset(new MacSetWrapper(std::move(mac_set)));
+  }
   return std::move(mac);
 }
 
@@ -33,6 +33,8 @@ namespace tink {
 // instances, depending on the context:
 //   * Mac::ComputeMac(...) uses the primary instance from the set
 //   * Mac::VerifyMac(...) uses the instance that matches the MAC prefix.
+// Sets with a single instance get a specialized wrapper with the same
+// behaviour, which binds the instance and its prefix once.
 class MacWrapper : public PrimitiveWrapper<Mac> {
  public:
   util::StatusOr<std::unique_ptr<Mac>> Wrap(
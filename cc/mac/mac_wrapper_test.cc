@@ -103,6 +103,36 @@ TEST(MacWrapperTest, Basic) {
                       status.error_message());
 }
 
+TEST(MacWrapperTest, SingleKey) {
+  for (OutputPrefixType output_prefix_type :
+       {OutputPrefixType::TINK, OutputPrefixType::RAW}) {
+    Keyset::Key key;
+    key.set_output_prefix_type(output_prefix_type);
+    key.set_key_id(1234);
+    std::unique_ptr<PrimitiveSet<Mac>> mac_set(new PrimitiveSet<Mac>());
+    std::unique_ptr<Mac> mac(new DummyMac("mac"));
+    auto entry_result = mac_set->AddPrimitive(std::move(mac), key);
+    ASSERT_TRUE(entry_result.ok()) << entry_result.status();
+    mac_set->set_primary(entry_result.ValueOrDie());
+    std::string prefix = entry_result.ValueOrDie()->get_identifier();
+
+    auto mac_result = MacWrapper().Wrap(std::move(mac_set));
+    ASSERT_TRUE(mac_result.ok()) << mac_result.status();
+    mac = std::move(mac_result.ValueOrDie());
+    std::string data = "Some data to authenticate";
+    auto compute_mac_result = mac->ComputeMac(data);
+    ASSERT_TRUE(compute_mac_result.ok()) << compute_mac_result.status();
+    std::string mac_value = compute_mac_result.ValueOrDie();
+    EXPECT_EQ(prefix + DummyMac("mac").ComputeMac(data).ValueOrDie(),
+              mac_value);
+    auto status = mac->VerifyMac(mac_value, data);
+    EXPECT_TRUE(status.ok()) << status;
+    EXPECT_FALSE(mac->VerifyMac(mac_value, "other data").ok());
+    EXPECT_FALSE(mac->VerifyMac("some bad mac", data).ok());
+    EXPECT_FALSE(mac->VerifyMac(prefix, data).ok());
+  }
+}
+
 TEST(MacWrapperTest, testLegacyAuthentication) {
   // Prepare a set for the wrapper.
   Keyset::Key key;
@@ -0,0 +1,279 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/monitoring/histogram_monitoring_sink.h"
+
+#include <atomic>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+
+#include "absl/memory/memory.h"
+#include "absl/synchronization/mutex.h"
+#include "tink/monitoring/monitoring.h"
+
+namespace crypto {
+namespace tink {
+
+constexpr int HistogramMonitoringSink::kLatencyBuckets;
+
+namespace {
+
+std::atomic<uint64_t> next_sink_id(1);
+
+// The sinks that have not been destroyed, by id, so that an exiting thread
+// only hands its shards back to sinks that still exist.
+absl::Mutex* LiveSinksMutex() {
+  static absl::Mutex* mutex = new absl::Mutex();
+  return mutex;
+}
+
+std::unordered_map<uint64_t, HistogramMonitoringSink*>* LiveSinks() {
+  static auto* sinks =
+      new std::unordered_map<uint64_t, HistogramMonitoringSink*>();
+  return sinks;
+}
+
+// Set when the ThreadShards of the current thread has been destroyed;
+// events recorded after that (e.g. by other thread_local objects) go to
+// the shared shard of exited threads.
+thread_local bool thread_shards_destroyed = false;
+
+struct CellKey {
+  const char* primitive;
+  MonitoringOperation operation;
+  uint32_t key_id;
+  bool success;
+
+  bool operator==(const CellKey& other) const {
+    return primitive == other.primitive && operation == other.operation &&
+           key_id == other.key_id && success == other.success;
+  }
+};
+
+struct CellKeyHash {
+  size_t operator()(const CellKey& key) const {
+    size_t hash = std::hash<const void*>()(key.primitive);
+    hash = hash * 31 + static_cast<size_t>(key.operation);
+    hash = hash * 31 + key.key_id;
+    return hash * 2 + (key.success ? 1 : 0);
+  }
+};
+
+}  // namespace
+
+// The counters written by a single thread.
+class HistogramMonitoringSink::Shard {
+ public:
+  struct Cell {
+    Cell() : count(0), num_bytes(0), raw_trials(0) {
+      for (auto& bucket : latency_histogram) bucket.store(0);
+    }
+
+    std::atomic<int64_t> count;
+    std::atomic<int64_t> num_bytes;
+    std::atomic<int64_t> raw_trials;
+    std::array<std::atomic<int64_t>, kLatencyBuckets> latency_histogram;
+  };
+
+  // Must only be called by the thread owning this shard.
+  void Record(const MonitoringEvent& event) {
+    CellKey key = {event.primitive, event.operation, event.key_id,
+                   event.success};
+    Cell* cell;
+    // The owning thread is the only one modifying 'cells_', so it can
+    // look up without the lock; the lock excludes concurrent Snapshot()s
+    // while a new cell is inserted.
+    auto found = cells_.find(key);
+    if (found != cells_.end()) {
+      cell = found->second.get();
+    } else {
+      auto new_cell = absl::make_unique<Cell>();
+      cell = new_cell.get();
+      absl::MutexLock lock(&mutex_);
+      cells_.emplace(key, std::move(new_cell));
+    }
+    cell->count.fetch_add(1, std::memory_order_relaxed);
+    cell->num_bytes.fetch_add(event.num_bytes, std::memory_order_relaxed);
+    cell->raw_trials.fetch_add(event.raw_trials, std::memory_order_relaxed);
+    cell->latency_histogram[LatencyBucket(event.latency_ns)].fetch_add(
+        1, std::memory_order_relaxed);
+  }
+
+  // Adds the counters of 'other' to this shard.  'other' must no longer
+  // be written to, e.g. because its thread has exited.
+  void Absorb(const Shard& other) {
+    absl::MutexLock lock(&mutex_);
+    for (const auto& entry : other.cells_) {
+      std::unique_ptr<Cell>& cell = cells_[entry.first];
+      if (cell == nullptr) cell = absl::make_unique<Cell>();
+      const Cell& other_cell = *entry.second;
+      cell->count.fetch_add(other_cell.count.load(std::memory_order_relaxed),
+                            std::memory_order_relaxed);
+      cell->num_bytes.fetch_add(
+          other_cell.num_bytes.load(std::memory_order_relaxed),
+          std::memory_order_relaxed);
+      cell->raw_trials.fetch_add(
+          other_cell.raw_trials.load(std::memory_order_relaxed),
+          std::memory_order_relaxed);
+      for (int i = 0; i < kLatencyBuckets; i++) {
+        cell->latency_histogram[i].fetch_add(
+            other_cell.latency_histogram[i].load(std::memory_order_relaxed),
+            std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Adds the counters of this shard to 'totals'.
+  template <class Totals>
+  void AddTo(Totals* totals) const {
+    absl::MutexLock lock(&mutex_);
+    for (const auto& entry : cells_) {
+      const CellKey& key = entry.first;
+      const Cell& cell = *entry.second;
+      Metric& metric = (*totals)[std::make_tuple(
+          std::string(key.primitive), static_cast<int>(key.operation),
+          key.key_id, key.success)];
+      metric.count += cell.count.load(std::memory_order_relaxed);
+      metric.num_bytes += cell.num_bytes.load(std::memory_order_relaxed);
+      metric.raw_trials += cell.raw_trials.load(std::memory_order_relaxed);
+      for (int i = 0; i < kLatencyBuckets; i++) {
+        metric.latency_histogram[i] +=
+            cell.latency_histogram[i].load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+ private:
+  mutable absl::Mutex mutex_;
+  std::unordered_map<CellKey, std::unique_ptr<Cell>, CellKeyHash> cells_;
+};
+
+class HistogramMonitoringSink::ThreadShards {
+ public:
+  ~ThreadShards() {
+    thread_shards_destroyed = true;
+    // Holding LiveSinksMutex() keeps the sinks from being destroyed while
+    // their shards are released.
+    absl::MutexLock lock(LiveSinksMutex());
+    for (const auto& entry : by_sink_id_) {
+      auto sink = LiveSinks()->find(entry.first);
+      // A destroyed sink has already destroyed the shard.
+      if (sink != LiveSinks()->end()) {
+        sink->second->ReleaseShard(entry.second);
+      }
+    }
+  }
+
+  // The shards are owned by the sinks.
+  std::unordered_map<uint64_t, Shard*> by_sink_id_;
+};
+
+HistogramMonitoringSink::HistogramMonitoringSink()
+    : id_(next_sink_id.fetch_add(1)), exited_shard_(new Shard()) {
+  absl::MutexLock lock(LiveSinksMutex());
+  (*LiveSinks())[id_] = this;
+}
+
+HistogramMonitoringSink::~HistogramMonitoringSink() {
+  absl::MutexLock lock(LiveSinksMutex());
+  LiveSinks()->erase(id_);
+}
+
+// static
+int HistogramMonitoringSink::LatencyBucket(int64_t latency_ns) {
+  int bucket = 0;
+  while (latency_ns > 0 && bucket < kLatencyBuckets - 1) {
+    latency_ns >>= 1;
+    bucket++;
+  }
+  return bucket;
+}
+
+// static
+int64_t HistogramMonitoringSink::LatencyBucketLimitNs(int bucket) {
+  return static_cast<int64_t>(1) << bucket;
+}
+
+HistogramMonitoringSink::Shard*
+HistogramMonitoringSink::GetShardForCurrentThread() {
+  if (thread_shards_destroyed) return nullptr;
+  thread_local ThreadShards thread_shards;
+  auto found = thread_shards.by_sink_id_.find(id_);
+  if (found != thread_shards.by_sink_id_.end()) return found->second;
+  auto shard = absl::make_unique<Shard>();
+  Shard* result = shard.get();
+  {
+    absl::MutexLock lock(&shards_mutex_);
+    shards_.push_back(std::move(shard));
+  }
+  thread_shards.by_sink_id_[id_] = result;
+  return result;
+}
+
+void HistogramMonitoringSink::ReleaseShard(Shard* shard) {
+  absl::MutexLock lock(&shards_mutex_);
+  exited_shard_->Absorb(*shard);
+  for (auto it = shards_.begin(); it != shards_.end(); ++it) {
+    if (it->get() == shard) {
+      shards_.erase(it);
+      break;
+    }
+  }
+}
+
+void HistogramMonitoringSink::Record(const MonitoringEvent& event) {
+  Shard* shard = GetShardForCurrentThread();
+  if (shard == nullptr) {
+    // Holding the lock makes this thread the only writer of the shard.
+    absl::MutexLock lock(&shards_mutex_);
+    exited_shard_->Record(event);
+    return;
+  }
+  shard->Record(event);
+}
+
+std::vector<HistogramMonitoringSink::Metric>
+HistogramMonitoringSink::Snapshot() const {
+  std::map<std::tuple<std::string, int, uint32_t, bool>, Metric> totals;
+  {
+    absl::MutexLock lock(&shards_mutex_);
+    for (const auto& shard : shards_) {
+      shard->AddTo(&totals);
+    }
+    exited_shard_->AddTo(&totals);
+  }
+  std::vector<Metric> metrics;
+  metrics.reserve(totals.size());
+  for (auto& entry : totals) {
+    Metric& metric = entry.second;
+    metric.primitive = std::get<0>(entry.first);
+    metric.operation =
+        static_cast<MonitoringOperation>(std::get<1>(entry.first));
+    metric.key_id = std::get<2>(entry.first);
+    metric.success = std::get<3>(entry.first);
+    metrics.push_back(metric);
+  }
+  return metrics;
+}
+
+int64_t HistogramMonitoringSink::GetThreadShardCount() const {
+  absl::MutexLock lock(&shards_mutex_);
+  return shards_.size();
+}
+
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,107 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_MONITORING_HISTOGRAM_MONITORING_SINK_H_
+#define TINK_MONITORING_HISTOGRAM_MONITORING_SINK_H_
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "tink/monitoring/monitoring.h"
+
+namespace crypto {
+namespace tink {
+
+// An in-process MonitoringSink, which aggregates the events into counters
+// and latency histograms that can be scraped with Snapshot().
+//
+// Every recording thread writes to its own shard of counters with relaxed
+// atomic increments, so that recording threads never contend with each
+// other; a lock is taken only the first time a thread records an event
+// for a given (primitive, operation, key id, outcome) combination.
+// When a thread exits, its shard is folded into a shard shared by the
+// exited threads, so that memory and the cost of Snapshot() grow with the
+// number of live threads rather than with all threads ever seen.
+// Snapshot() sums up the shards of all live threads and the shared one.
+class HistogramMonitoringSink : public MonitoringSink {
+ public:
+  // Bucket i of a latency histogram counts the operations whose latency
+  // in nanoseconds is in [2^(i-1), 2^i); bucket 0 counts zero latencies,
+  // and the last bucket also counts everything above its range.
+  static constexpr int kLatencyBuckets = 40;
+
+  // Aggregated counters for one (primitive, operation, key id, outcome).
+  struct Metric {
+    std::string primitive;
+    MonitoringOperation operation;
+    uint32_t key_id;
+    bool success;
+    int64_t count;
+    int64_t num_bytes;
+    int64_t raw_trials;
+    std::array<int64_t, kLatencyBuckets> latency_histogram;
+  };
+
+  HistogramMonitoringSink();
+  ~HistogramMonitoringSink() override;
+
+  void Record(const MonitoringEvent& event) override;
+
+  // Returns the current values of all the counters, sorted by
+  // (primitive, operation, key id, outcome).
+  std::vector<Metric> Snapshot() const LOCKS_EXCLUDED(shards_mutex_);
+
+  // Returns the number of live threads that have a shard of this sink.
+  int64_t GetThreadShardCount() const LOCKS_EXCLUDED(shards_mutex_);
+
+  // Returns the upper bound (exclusive) of the latency range
+  // of the given bucket, in nanoseconds.
+  static int64_t LatencyBucketLimitNs(int bucket);
+
+  // Returns the index of the latency bucket for 'latency_ns'.
+  static int LatencyBucket(int64_t latency_ns);
+
+ private:
+  class Shard;
+  class ThreadShards;
+
+  // Returns nullptr if the thread-local shards of the current thread have
+  // already been destroyed, i.e. the thread is exiting.
+  Shard* GetShardForCurrentThread() LOCKS_EXCLUDED(shards_mutex_);
+
+  // Folds the shard of an exiting thread into 'exited_shard_', and
+  // destroys it.
+  void ReleaseShard(Shard* shard) LOCKS_EXCLUDED(shards_mutex_);
+
+  // Distinguishes the sinks in the thread-local shard caches.
+  const uint64_t id_;
+  mutable absl::Mutex shards_mutex_;
+  // The shards of the live threads.
+  std::vector<std::unique_ptr<Shard>> shards_ GUARDED_BY(shards_mutex_);
+  // The counters of the exited threads, and of events recorded while a
+  // thread was exiting.
+  const std::unique_ptr<Shard> exited_shard_ GUARDED_BY(shards_mutex_);
+};
+
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_MONITORING_HISTOGRAM_MONITORING_SINK_H_
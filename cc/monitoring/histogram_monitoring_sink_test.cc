@@ -0,0 +1,163 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/monitoring/histogram_monitoring_sink.h"
+
+#include <cstdint>
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/synchronization/notification.h"
+#include "tink/monitoring/monitoring.h"
+
+namespace crypto {
+namespace tink {
+namespace {
+
+MonitoringEvent Event(const char* primitive, MonitoringOperation operation,
+                      uint32_t key_id, bool success, int64_t latency_ns) {
+  MonitoringEvent event;
+  event.primitive = primitive;
+  event.operation = operation;
+  event.key_id = key_id;
+  event.num_bytes = 100;
+  event.success = success;
+  event.raw_trials = 2;
+  event.latency_ns = latency_ns;
+  return event;
+}
+
+TEST(HistogramMonitoringSinkTest, Empty) {
+  HistogramMonitoringSink sink;
+  EXPECT_TRUE(sink.Snapshot().empty());
+}
+
+TEST(HistogramMonitoringSinkTest, LatencyBuckets) {
+  EXPECT_EQ(0, HistogramMonitoringSink::LatencyBucket(0));
+  EXPECT_EQ(1, HistogramMonitoringSink::LatencyBucket(1));
+  EXPECT_EQ(2, HistogramMonitoringSink::LatencyBucket(2));
+  EXPECT_EQ(2, HistogramMonitoringSink::LatencyBucket(3));
+  EXPECT_EQ(11, HistogramMonitoringSink::LatencyBucket(1024));
+  EXPECT_EQ(HistogramMonitoringSink::kLatencyBuckets - 1,
+            HistogramMonitoringSink::LatencyBucket(INT64_MAX));
+  for (int64_t latency : {1, 5, 1000, 123456789}) {
+    int bucket = HistogramMonitoringSink::LatencyBucket(latency);
+    EXPECT_LT(latency, HistogramMonitoringSink::LatencyBucketLimitNs(bucket));
+    EXPECT_GE(latency,
+              HistogramMonitoringSink::LatencyBucketLimitNs(bucket - 1));
+  }
+}
+
+TEST(HistogramMonitoringSinkTest, AggregatesEvents) {
+  HistogramMonitoringSink sink;
+  sink.Record(Event("mac", MonitoringOperation::kVerifyMac, 7, true, 3));
+  sink.Record(Event("aead", MonitoringOperation::kDecrypt, 7, true, 1000));
+  sink.Record(Event("aead", MonitoringOperation::kDecrypt, 7, true, 1000));
+  sink.Record(Event("aead", MonitoringOperation::kDecrypt, 0, false, 5));
+
+  auto metrics = sink.Snapshot();
+  ASSERT_EQ(3, metrics.size());
+  EXPECT_EQ("aead", metrics[0].primitive);
+  EXPECT_EQ(0, metrics[0].key_id);
+  EXPECT_FALSE(metrics[0].success);
+  EXPECT_EQ(1, metrics[0].count);
+
+  EXPECT_EQ("aead", metrics[1].primitive);
+  EXPECT_EQ(MonitoringOperation::kDecrypt, metrics[1].operation);
+  EXPECT_EQ(7, metrics[1].key_id);
+  EXPECT_TRUE(metrics[1].success);
+  EXPECT_EQ(2, metrics[1].count);
+  EXPECT_EQ(200, metrics[1].num_bytes);
+  EXPECT_EQ(4, metrics[1].raw_trials);
+  EXPECT_EQ(2, metrics[1].latency_histogram[
+                   HistogramMonitoringSink::LatencyBucket(1000)]);
+
+  EXPECT_EQ("mac", metrics[2].primitive);
+  EXPECT_EQ(MonitoringOperation::kVerifyMac, metrics[2].operation);
+  EXPECT_EQ(1, metrics[2].count);
+}
+
+TEST(HistogramMonitoringSinkTest, ConcurrentRecording) {
+  const int kThreadCount = 8;
+  const int kEventsPerThread = 10000;
+  HistogramMonitoringSink sink;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreadCount; i++) {
+    threads.emplace_back([&sink, i]() {
+      for (int j = 0; j < kEventsPerThread; j++) {
+        sink.Record(Event("aead", MonitoringOperation::kEncrypt, i % 2, true,
+                          j));
+      }
+    });
+  }
+  // Snapshots taken concurrently with the recording must not crash.
+  for (int i = 0; i < 10; i++) sink.Snapshot();
+  for (auto& thread : threads) thread.join();
+
+  auto metrics = sink.Snapshot();
+  ASSERT_EQ(2, metrics.size());
+  for (const auto& metric : metrics) {
+    EXPECT_EQ(kThreadCount / 2 * kEventsPerThread, metric.count);
+    int64_t histogram_total = 0;
+    for (int64_t bucket : metric.latency_histogram) histogram_total += bucket;
+    EXPECT_EQ(metric.count, histogram_total);
+  }
+}
+
+TEST(HistogramMonitoringSinkTest, ShardsOfExitedThreadsAreFolded) {
+  const int kRounds = 50;
+  const int kThreadCount = 4;
+  HistogramMonitoringSink sink;
+  sink.Record(Event("aead", MonitoringOperation::kEncrypt, 1, true, 5));
+  for (int round = 0; round < kRounds; round++) {
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kThreadCount; i++) {
+      threads.emplace_back([&sink]() {
+        sink.Record(Event("aead", MonitoringOperation::kEncrypt, 1, true, 5));
+      });
+    }
+    for (auto& thread : threads) thread.join();
+    // Only the shard of the main thread is left.
+    EXPECT_EQ(1, sink.GetThreadShardCount());
+  }
+
+  auto metrics = sink.Snapshot();
+  ASSERT_EQ(1, metrics.size());
+  EXPECT_EQ(kRounds * kThreadCount + 1, metrics[0].count);
+  EXPECT_EQ((kRounds * kThreadCount + 1) * 100, metrics[0].num_bytes);
+  EXPECT_EQ(kRounds * kThreadCount + 1,
+            metrics[0].latency_histogram[
+                HistogramMonitoringSink::LatencyBucket(5)]);
+}
+
+TEST(HistogramMonitoringSinkTest, ThreadsMayOutliveTheSink) {
+  std::unique_ptr<HistogramMonitoringSink> sink(new HistogramMonitoringSink());
+  absl::Notification sink_destroyed;
+  std::thread thread([&sink, &sink_destroyed]() {
+    sink->Record(Event("mac", MonitoringOperation::kComputeMac, 1, true, 5));
+    sink_destroyed.WaitForNotification();
+  });
+  while (sink->GetThreadShardCount() == 0) std::this_thread::yield();
+  sink.reset();
+  sink_destroyed.Notify();
+  thread.join();
+}
+
+}  // namespace
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,46 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/monitoring/monitoring.h"
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+
+namespace crypto {
+namespace tink {
+
+namespace {
+
+absl::Mutex* sink_mutex = new absl::Mutex();
+std::shared_ptr<MonitoringSink>* sink GUARDED_BY(*sink_mutex) =
+    new std::shared_ptr<MonitoringSink>();
+
+}  // namespace
+
+// static
+void Monitoring::SetSink(std::shared_ptr<MonitoringSink> new_sink) {
+  absl::MutexLock lock(sink_mutex);
+  *sink = std::move(new_sink);
+}
+
+// static
+std::shared_ptr<MonitoringSink> Monitoring::GetSink() {
+  absl::MutexLock lock(sink_mutex);
+  return *sink;
+}
+
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,140 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_MONITORING_MONITORING_H_
+#define TINK_MONITORING_MONITORING_H_
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <memory>
+
+namespace crypto {
+namespace tink {
+
+// The operations reported by the primitive wrappers and KeysetReloader.
+enum class MonitoringOperation {
+  kEncrypt,
+  kDecrypt,
+  kComputeMac,
+  kVerifyMac,
+  kVerify,
+  kReloadKeyset,
+};
+
+// Describes a single operation of a wrapped primitive.
+struct MonitoringEvent {
+  // Name of the primitive, e.g. "aead" or "mac".  Points to a string
+  // with static storage duration.
+  const char* primitive;
+  MonitoringOperation operation;
+  // Id of the key that performed the operation, 0 if no key succeeded.
+  uint32_t key_id;
+  // Size of the main input of the operation (plaintext, ciphertext, data).
+  int64_t num_bytes;
+  bool success;
+  // Number of RAW keys tried before the operation succeeded or failed.
+  int raw_trials;
+  int64_t latency_ns;
+};
+
+// Receives the events reported by the primitive wrappers.
+// Implementations must be thread-safe, and should be cheap, as Record()
+// is called synchronously on the path of every operation.
+class MonitoringSink {
+ public:
+  virtual void Record(const MonitoringEvent& event) = 0;
+
+  virtual ~MonitoringSink() {}
+};
+
+// Process-wide registration of the MonitoringSink used by the wrappers
+// (AeadWrapper, MacWrapper, DeterministicAeadWrapper, HybridDecryptWrapper,
+// PublicKeyVerifyWrapper) and by KeysetReloader.
+//
+// The sink is captured when a primitive set is wrapped (or a reloader is
+// created), i.e. primitives obtained before SetSink() was called remain
+// unmonitored.  Monitoring is
+// disabled by default, in which case the wrappers do not read the clock
+// and the overhead is a single pointer comparison per operation.
+class Monitoring {
+ public:
+  // Sets the sink for subsequently wrapped primitives; nullptr disables
+  // monitoring.
+  static void SetSink(std::shared_ptr<MonitoringSink> sink);
+
+  // Returns the current sink, or nullptr if monitoring is disabled.
+  static std::shared_ptr<MonitoringSink> GetSink();
+};
+
+// Helper for the wrappers that collects a MonitoringEvent over the course
+// of one operation.  Does nothing if 'sink' is nullptr.
+class MonitoredOperation {
+ public:
+  MonitoredOperation(MonitoringSink* sink, const char* primitive,
+                     MonitoringOperation operation, int64_t num_bytes)
+      : sink_(sink) {
+    if (sink_ == nullptr) return;
+    event_.primitive = primitive;
+    event_.operation = operation;
+    event_.key_id = 0;
+    event_.num_bytes = num_bytes;
+    event_.success = false;
+    event_.raw_trials = 0;
+    event_.latency_ns = 0;
+    start_ = std::chrono::steady_clock::now();
+  }
+
+  MonitoredOperation(const MonitoredOperation&) = delete;
+  MonitoredOperation& operator=(const MonitoredOperation&) = delete;
+
+  // Notes that a RAW key is being tried.
+  void AddRawTrial() {
+    if (sink_ != nullptr) event_.raw_trials++;
+  }
+
+  // Reports the operation as successfully completed with key 'key_id'.
+  void RecordSuccess(uint32_t key_id) {
+    if (sink_ == nullptr) return;
+    event_.key_id = key_id;
+    event_.success = true;
+    Record();
+  }
+
+  // Reports the operation as failed.  'key_id' is the key of the primary
+  // for operations that use it, and 0 otherwise.
+  void RecordFailure(uint32_t key_id = 0) {
+    if (sink_ == nullptr) return;
+    event_.key_id = key_id;
+    event_.success = false;
+    Record();
+  }
+
+ private:
+  void Record() {
+    event_.latency_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start_).count();
+    sink_->Record(event_);
+  }
+
+  MonitoringSink* const sink_;
+  MonitoringEvent event_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_MONITORING_MONITORING_H_
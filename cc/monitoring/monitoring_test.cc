@@ -0,0 +1,88 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/monitoring/monitoring.h"
+
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace crypto {
+namespace tink {
+namespace {
+
+class RecordingSink : public MonitoringSink {
+ public:
+  void Record(const MonitoringEvent& event) override {
+    events.push_back(event);
+  }
+
+  std::vector<MonitoringEvent> events;
+};
+
+TEST(MonitoringTest, SetAndGetSink) {
+  EXPECT_EQ(nullptr, Monitoring::GetSink());
+  auto sink = std::make_shared<RecordingSink>();
+  Monitoring::SetSink(sink);
+  EXPECT_EQ(sink, Monitoring::GetSink());
+  Monitoring::SetSink(nullptr);
+  EXPECT_EQ(nullptr, Monitoring::GetSink());
+}
+
+TEST(MonitoredOperationTest, RecordSuccess) {
+  RecordingSink sink;
+  {
+    MonitoredOperation operation(&sink, "aead", MonitoringOperation::kDecrypt,
+                                 42);
+    operation.AddRawTrial();
+    operation.AddRawTrial();
+    operation.RecordSuccess(1234);
+  }
+  ASSERT_EQ(1, sink.events.size());
+  const MonitoringEvent& event = sink.events[0];
+  EXPECT_STREQ("aead", event.primitive);
+  EXPECT_EQ(MonitoringOperation::kDecrypt, event.operation);
+  EXPECT_EQ(1234, event.key_id);
+  EXPECT_EQ(42, event.num_bytes);
+  EXPECT_TRUE(event.success);
+  EXPECT_EQ(2, event.raw_trials);
+  EXPECT_GE(event.latency_ns, 0);
+}
+
+TEST(MonitoredOperationTest, RecordFailure) {
+  RecordingSink sink;
+  MonitoredOperation operation(&sink, "mac", MonitoringOperation::kVerifyMac,
+                               7);
+  operation.RecordFailure();
+  ASSERT_EQ(1, sink.events.size());
+  EXPECT_STREQ("mac", sink.events[0].primitive);
+  EXPECT_EQ(0, sink.events[0].key_id);
+  EXPECT_FALSE(sink.events[0].success);
+  EXPECT_EQ(0, sink.events[0].raw_trials);
+}
+
+TEST(MonitoredOperationTest, NullSink) {
+  MonitoredOperation operation(nullptr, "aead", MonitoringOperation::kEncrypt,
+                               1);
+  operation.AddRawTrial();
+  operation.RecordSuccess(1);
+  operation.RecordFailure(1);
+}
+
+}  // namespace
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,187 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_PRIMITIVE_INTERN_CACHE_H_
+#define TINK_PRIMITIVE_INTERN_CACHE_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "tink/util/statusor.h"
+#include "proto/tink.pb.h"
+
+namespace crypto {
+namespace tink {
+
+class Aead;
+class DeterministicAead;
+class HybridDecrypt;
+class HybridEncrypt;
+class Mac;
+class PublicKeySign;
+class PublicKeyVerify;
+
+// Implements the primitive interface P by forwarding every call to an
+// instance of P that is shared with other SharedPrimitive<P>s.  Only
+// interfaces whose operations are const, and thus safe to call from
+// several threads, have a forwarding implementation; the primitives of
+// all other interfaces (e.g. StreamingAead) are never interned.
+template <class P>
+struct SharedPrimitive {
+  static constexpr bool kSupported = false;
+  static std::unique_ptr<P> Wrap(std::shared_ptr<P> primitive) {
+    return nullptr;
+  }
+};
+
+#define TINK_DECLARE_SHARED_PRIMITIVE(P)                          \
+  template <>                                                     \
+  struct SharedPrimitive<P> {                                     \
+    static constexpr bool kSupported = true;                      \
+    static std::unique_ptr<P> Wrap(std::shared_ptr<P> primitive); \
+  }
+
+TINK_DECLARE_SHARED_PRIMITIVE(Aead);
+TINK_DECLARE_SHARED_PRIMITIVE(DeterministicAead);
+TINK_DECLARE_SHARED_PRIMITIVE(HybridDecrypt);
+TINK_DECLARE_SHARED_PRIMITIVE(HybridEncrypt);
+TINK_DECLARE_SHARED_PRIMITIVE(Mac);
+TINK_DECLARE_SHARED_PRIMITIVE(PublicKeySign);
+TINK_DECLARE_SHARED_PRIMITIVE(PublicKeyVerify);
+
+#undef TINK_DECLARE_SHARED_PRIMITIVE
+
+// A process-wide cache that lets all the users of a key share a single
+// instance of its primitive, e.g. when many components of a process load
+// the same keyset and call KeysetHandle::GetPrimitive() independently.
+// Sharing avoids repeating the key setup (e.g. expanding an AES key or
+// parsing an RSA key) and keeping a copy of the expanded key material per
+// user.
+//
+// Interning is off by default, and is enabled with
+//
+//   PrimitiveInternCache::Global().SetEnabled(true);
+//
+// Then Registry::GetPrimitive<P>(key_data) looks up the primitive by the
+// type url of 'key_data', the primitive type P and the SHA-256 hash of
+// the serialized key, and returns a SharedPrimitive<P> that forwards to
+// the instance that is already in use, if there is one.  The cache only
+// holds weak references: an instance is destroyed, as without the cache,
+// when its last user releases it.
+//
+// The returned primitives are not instances of the classes of the key
+// managers, so callers that dynamic_cast primitives to extension
+// interfaces (e.g. subtle::PooledAead) should not enable interning.
+//
+// The cache is split into kNumShards shards, each with its own mutex, so
+// that concurrent lookups of different keys rarely contend.
+class PrimitiveInternCache {
+ public:
+  struct Stats {
+    // Number of lookups that returned an instance already in use,
+    // including those that lost a race to create the same instance.
+    int64_t hit_count;
+    // Number of lookups whose new instance was added to the cache.
+    int64_t miss_count;
+    // Number of entries, including those whose instance has been
+    // destroyed but that have not been removed yet.
+    int64_t entry_count;
+  };
+
+  static constexpr int kNumShards = 16;
+
+  static PrimitiveInternCache& Global();
+
+  PrimitiveInternCache();
+  PrimitiveInternCache(const PrimitiveInternCache&) = delete;
+  PrimitiveInternCache& operator=(const PrimitiveInternCache&) = delete;
+
+  void SetEnabled(bool enabled) { enabled_.store(enabled); }
+  bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  // Returns the primitive for 'key_data'.  If interning is enabled and P
+  // has a SharedPrimitive implementation, this is a SharedPrimitive<P>
+  // for the instance in use for 'key_data', or for a new instance
+  // returned by 'create' if there is none.  Otherwise it is the result
+  // of 'create'.
+  template <class P, class Factory>
+  crypto::tink::util::StatusOr<std::unique_ptr<P>> GetOrCreate(
+      const google::crypto::tink::KeyData& key_data, Factory create);
+
+  // Removes all entries, without affecting the primitives in use.
+  void Clear();
+
+  Stats GetStats() const;
+
+ private:
+  struct Shard {
+    mutable absl::Mutex mutex;
+    std::unordered_map<std::string, std::weak_ptr<void>> entries
+        GUARDED_BY(mutex);
+    // Expired entries are removed when the shard grows to this size.
+    size_t sweep_size GUARDED_BY(mutex);
+    int64_t hit_count GUARDED_BY(mutex);
+    int64_t miss_count GUARDED_BY(mutex);
+  };
+
+  // Returns the cache key for the primitive P of 'key_data', and sets
+  // 'shard' to the shard that holds it.
+  std::string CacheKey(const char* type_id_name,
+                       const google::crypto::tink::KeyData& key_data,
+                       Shard** shard);
+
+  // Returns the instance for 'key', or nullptr if it has been destroyed
+  // or was never added.
+  std::shared_ptr<void> Find(Shard* shard, const std::string& key);
+
+  // Adds 'primitive' for 'key', unless another thread has added a live
+  // instance for it in the meantime; returns the instance to use.
+  std::shared_ptr<void> Insert(Shard* shard, const std::string& key,
+                               std::shared_ptr<void> primitive);
+
+  std::atomic<bool> enabled_;
+  std::array<Shard, kNumShards> shards_;
+};
+
+template <class P, class Factory>
+crypto::tink::util::StatusOr<std::unique_ptr<P>>
+PrimitiveInternCache::GetOrCreate(
+    const google::crypto::tink::KeyData& key_data, Factory create) {
+  if (!SharedPrimitive<P>::kSupported || !enabled()) return create();
+  Shard* shard;
+  std::string key = CacheKey(typeid(P).name(), key_data, &shard);
+  std::shared_ptr<void> found = Find(shard, key);
+  if (found == nullptr) {
+    crypto::tink::util::StatusOr<std::unique_ptr<P>> created = create();
+    if (!created.ok()) return created.status();
+    found = Insert(shard, key,
+                   std::shared_ptr<P>(std::move(created.ValueOrDie())));
+  }
+  return SharedPrimitive<P>::Wrap(std::static_pointer_cast<P>(found));
+}
+
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_PRIMITIVE_INTERN_CACHE_H_
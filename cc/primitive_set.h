@@ -17,9 +17,11 @@
 #ifndef TINK_PRIMITIVE_SET_H_
 #define TINK_PRIMITIVE_SET_H_
 
+#include <functional>
 #include <unordered_map>
 #include <vector>
 
+#include "absl/base/call_once.h"
 #include "absl/memory/memory.h"
 #include "absl/synchronization/mutex.h"
 #include "tink/crypto_format.h"
@@ -46,6 +48,11 @@ namespace tink {
 // the set is used, and upon decryption the ciphertext's prefix
 // determines the identifier of the primitive from the set.
 //
+// Entries can also be added lazily (AddLazyPrimitive()), in which case
+// the primitive is created by a factory the first time the entry is
+// used.  Code that uses the entries of a set which may contain lazy
+// entries must obtain the primitives via Entry::GetOrCreatePrimitive().
+//
 // PrimitiveSet is a public class to allow its use in implementations
 // of custom primitives.
 template <class P>
@@ -57,16 +64,64 @@ class PrimitiveSet {
    public:
     Entry(std::unique_ptr<P2> primitive, const std::string& identifier,
           google::crypto::tink::KeyStatusType status,
-          google::crypto::tink::OutputPrefixType output_prefix_type)
+          google::crypto::tink::OutputPrefixType output_prefix_type,
+          uint32_t key_id = 0)
         : primitive_(std::move(primitive)),
           identifier_(identifier),
           status_(status),
-          output_prefix_type_(output_prefix_type) {}
+          output_prefix_type_(output_prefix_type),
+          key_id_(key_id),
+          is_lazy_(false) {}
+
+    // Creates an entry whose primitive is created by 'factory' on the
+    // first call to GetOrCreatePrimitive().
+    Entry(std::function<
+              crypto::tink::util::StatusOr<std::unique_ptr<P2>>()> factory,
+          const std::string& identifier,
+          google::crypto::tink::KeyStatusType status,
+          google::crypto::tink::OutputPrefixType output_prefix_type,
+          uint32_t key_id = 0)
+        : factory_(std::move(factory)),
+          identifier_(identifier),
+          status_(status),
+          output_prefix_type_(output_prefix_type),
+          key_id_(key_id),
+          is_lazy_(true) {}
 
+    // Returns the primitive of this entry.  Must not be called on a lazy
+    // entry before GetOrCreatePrimitive() returned successfully for it.
     P2& get_primitive() const { return *primitive_; }
 
+    // Returns the primitive of this entry, creating it first if this is
+    // a lazy entry.  Thread-safe: the factory of a lazy entry runs at most
+    // once, and if it fails, its status is returned by all the calls.
+    crypto::tink::util::StatusOr<P2*> GetOrCreatePrimitive() const {
+      if (!is_lazy_) return primitive_.get();
+      absl::call_once(create_once_, [this]() {
+        auto primitive_result = factory_();
+        if (!primitive_result.ok()) {
+          create_status_ = primitive_result.status();
+        } else if (primitive_result.ValueOrDie() == nullptr) {
+          create_status_ = crypto::tink::util::Status(
+              crypto::tink::util::error::INTERNAL,
+              "The factory returned a null primitive.");
+        } else {
+          primitive_ = std::move(primitive_result.ValueOrDie());
+        }
+        // Releases whatever the factory holds, e.g. a copy of the key.
+        factory_ = nullptr;
+      });
+      if (primitive_ == nullptr) return create_status_;
+      return primitive_.get();
+    }
+
+    // Returns true if the primitive of this entry is created on first use.
+    bool is_lazy() const { return is_lazy_; }
+
     const std::string& get_identifier() const { return identifier_; }
 
+    uint32_t get_key_id() const { return key_id_; }
+
     google::crypto::tink::KeyStatusType get_status() const {
       return status_;
     }
@@ -77,10 +132,18 @@ class PrimitiveSet {
     }
 
    private:
-    std::unique_ptr<P> primitive_;
+    // For lazy entries, 'primitive_', 'create_status_' and 'factory_'
+    // are only accessed under 'create_once_'.
+    mutable std::unique_ptr<P> primitive_;
+    mutable std::function<
+        crypto::tink::util::StatusOr<std::unique_ptr<P2>>()> factory_;
+    mutable crypto::tink::util::Status create_status_;
+    mutable absl::once_flag create_once_;
     std::string identifier_;
     google::crypto::tink::KeyStatusType status_;
     google::crypto::tink::OutputPrefixType output_prefix_type_;
+    uint32_t key_id_;
+    bool is_lazy_;
   };
 
   typedef std::vector<std::unique_ptr<Entry<P>>> Primitives;
@@ -102,7 +165,31 @@ class PrimitiveSet {
     primitives_[identifier].push_back(
         absl::make_unique<Entry<P>>(std::move(primitive),
                                     identifier, key.status(),
-                                    key.output_prefix_type()));
+                                    key.output_prefix_type(),
+                                    key.key_id()));
+    return primitives_[identifier].back().get();
+  }
+
+  // Adds to this set an entry for the specified 'key', whose primitive
+  // is created by 'factory' the first time the entry is used, see
+  // Entry::GetOrCreatePrimitive().
+  crypto::tink::util::StatusOr<Entry<P>*> AddLazyPrimitive(
+      std::function<crypto::tink::util::StatusOr<std::unique_ptr<P>>()>
+          factory,
+      google::crypto::tink::Keyset::Key key) {
+    auto identifier_result = CryptoFormat::get_output_prefix(key);
+    if (!identifier_result.ok()) return identifier_result.status();
+    if (factory == nullptr) {
+      return ToStatusF(crypto::tink::util::error::INVALID_ARGUMENT,
+                       "The factory must be non-null.");
+    }
+    std::string identifier = identifier_result.ValueOrDie();
+    absl::MutexLock lock(&primitives_mutex_);
+    primitives_[identifier].push_back(
+        absl::make_unique<Entry<P>>(std::move(factory),
+                                    identifier, key.status(),
+                                    key.output_prefix_type(),
+                                    key.key_id()));
     return primitives_[identifier].back().get();
   }
 
@@ -131,6 +218,14 @@ class PrimitiveSet {
   // Returns the entry with the primary primitive.
   const Entry<P>* get_primary() const { return primary_; }
 
+  // Returns the number of entries in this set.
+  size_t size() {
+    absl::MutexLock lock(&primitives_mutex_);
+    size_t size = 0;
+    for (const auto& entry : primitives_) size += entry.second.size();
+    return size;
+  }
+
  private:
   typedef std::unordered_map<std::string, Primitives>
       CiphertextPrefixToPrimitivesMap;
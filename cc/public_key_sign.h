@@ -17,7 +17,9 @@
 #ifndef TINK_PUBLIC_KEY_SIGN_H_
 #define TINK_PUBLIC_KEY_SIGN_H_
 
+#include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "tink/util/statusor.h"
 
 namespace crypto {
@@ -37,6 +39,14 @@ class PublicKeySign {
   virtual crypto::tink::util::StatusOr<std::string> Sign(
       absl::string_view data) const = 0;
 
+  // Computes the signature for the concatenation of 'data_pieces'.
+  // The default implementation concatenates the pieces; implementations
+  // that hash the data incrementally override it to avoid the copy.
+  virtual crypto::tink::util::StatusOr<std::string> SignMultipart(
+      absl::Span<const absl::string_view> data_pieces) const {
+    return Sign(absl::StrJoin(data_pieces, ""));
+  }
+
   virtual ~PublicKeySign() {}
 };
 
@@ -17,7 +17,9 @@
 #ifndef TINK_PUBLIC_KEY_VERIFY_H_
 #define TINK_PUBLIC_KEY_VERIFY_H_
 
+#include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "tink/util/status.h"
 
 namespace crypto {
@@ -38,6 +40,16 @@ class PublicKeyVerify {
       absl::string_view signature,
       absl::string_view data) const = 0;
 
+  // Verifies that 'signature' is a digital signature for the concatenation
+  // of 'data_pieces'.  The default implementation concatenates the pieces;
+  // implementations that hash the data incrementally override it to avoid
+  // the copy.
+  virtual crypto::tink::util::Status VerifyMultipart(
+      absl::string_view signature,
+      absl::Span<const absl::string_view> data_pieces) const {
+    return Verify(signature, absl::StrJoin(data_pieces, ""));
+  }
+
   virtual ~PublicKeyVerify() {}
 };
 
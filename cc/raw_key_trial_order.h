@@ -0,0 +1,169 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_RAW_KEY_TRIAL_ORDER_H_
+#define TINK_RAW_KEY_TRIAL_ORDER_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <unordered_map>
+
+#include "tink/primitive_set.h"
+
+namespace crypto {
+namespace tink {
+
+// Hints the primitive set wrappers which RAW key to try first for the
+// operations done by the current thread while the hint is in scope, e.g.
+// when the key id of a legacy ciphertext is stored next to it:
+//
+//   {
+//     RawKeyHint hint(key_id);
+//     auto plaintext = aead->Decrypt(ciphertext, associated_data);
+//   }
+//
+// A hint never changes the result of an operation: if the hinted key
+// does not succeed, or is not a RAW key of the set, the other RAW keys
+// are tried as usual.  Hints can be nested; the innermost one applies.
+class RawKeyHint {
+ public:
+  explicit RawKeyHint(uint32_t key_id);
+  ~RawKeyHint();
+
+  RawKeyHint(const RawKeyHint&) = delete;
+  RawKeyHint& operator=(const RawKeyHint&) = delete;
+
+  // Returns the innermost hint of the current thread, or nullptr.
+  static const RawKeyHint* Current();
+
+  uint32_t key_id() const { return key_id_; }
+
+ private:
+  const uint32_t key_id_;
+  const RawKeyHint* const previous_;
+};
+
+// Decides in which order the primitive set wrappers try the RAW keys of a
+// set: first the key of the current RawKeyHint, then the keys that most
+// recently succeeded for the current thread, and finally the remaining
+// keys in the order of the set.
+//
+// The recently successful keys are tracked in kShards shards of
+// kRecentKeys entries each, so that threads see mostly their own history
+// without contending on shared state; every thread is assigned a shard
+// when it first uses a RawKeyTrialOrder.  The updates are relaxed and may
+// race, which can only affect the order of the trials, not their outcome.
+class RawKeyTrialOrder {
+ public:
+  static constexpr int kShards = 16;
+  static constexpr int kRecentKeys = 4;
+
+  // Creates a trial order for 'raw_primitives', the RAW entries of
+  // a primitive set as returned by RawPrimitivesOrNull(), which may be
+  // nullptr.
+  template <class Primitives>
+  explicit RawKeyTrialOrder(const Primitives* raw_primitives)
+      : num_keys_(raw_primitives == nullptr ? 0 : raw_primitives->size()) {
+    for (int i = 0; i < num_keys_; i++) {
+      index_by_key_id_.emplace((*raw_primitives)[i]->get_key_id(), i);
+    }
+    for (auto& shard : shards_) {
+      for (auto& index : shard.recent) index.store(-1);
+    }
+  }
+
+  RawKeyTrialOrder(const RawKeyTrialOrder&) = delete;
+  RawKeyTrialOrder& operator=(const RawKeyTrialOrder&) = delete;
+
+  // Calls 'try_key' with the indexes of the RAW entries in trial order,
+  // until it returns true, and returns that index.  Every index is tried
+  // at most once; returns -1 if 'try_key' returned false for all of them.
+  template <class TryKey>
+  int TryKeys(const TryKey& try_key) const;
+
+ private:
+  struct alignas(64) Shard {
+    std::atomic<int> recent[kRecentKeys];
+  };
+
+  // Returns the index of the key of the current RawKeyHint, or -1.
+  int HintedIndex() const;
+
+  // Returns the shard of the calling thread.
+  Shard& CurrentShard() const;
+
+  // Moves 'index' to the front of the recent keys of the current shard.
+  void RecordSuccess(int index) const;
+
+  const int num_keys_;
+  std::unordered_map<uint32_t, int> index_by_key_id_;
+  mutable std::array<Shard, kShards> shards_;
+};
+
+// Returns the RAW entries of 'primitive_set', or nullptr if it has none.
+// The entries are owned by 'primitive_set'.
+template <class P>
+const typename PrimitiveSet<P>::Primitives* RawPrimitivesOrNull(
+    PrimitiveSet<P>* primitive_set) {
+  auto raw_primitives_result = primitive_set->get_raw_primitives();
+  if (!raw_primitives_result.ok()) return nullptr;
+  return raw_primitives_result.ValueOrDie();
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Implementation details of templated methods follow.
+
+template <class TryKey>
+int RawKeyTrialOrder::TryKeys(const TryKey& try_key) const {
+  // The indexes that were already tried, at most one per source.
+  int tried[1 + kRecentKeys];
+  int num_tried = 0;
+  auto already_tried = [&tried, &num_tried](int index) {
+    for (int i = 0; i < num_tried; i++) {
+      if (tried[i] == index) return true;
+    }
+    return false;
+  };
+  auto try_once = [&](int index) {
+    tried[num_tried++] = index;
+    if (!try_key(index)) return false;
+    RecordSuccess(index);
+    return true;
+  };
+
+  int hinted_index = HintedIndex();
+  if (hinted_index >= 0 && try_once(hinted_index)) return hinted_index;
+  const Shard& shard = CurrentShard();
+  for (int i = 0; i < kRecentKeys; i++) {
+    int index = shard.recent[i].load(std::memory_order_relaxed);
+    if (index < 0 || index >= num_keys_ || already_tried(index)) continue;
+    if (try_once(index)) return index;
+  }
+  for (int index = 0; index < num_keys_; index++) {
+    if (already_tried(index)) continue;
+    if (try_key(index)) {
+      RecordSuccess(index);
+      return index;
+    }
+  }
+  return -1;
+}
+
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_RAW_KEY_TRIAL_ORDER_H_
@@ -0,0 +1,101 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_RELOADING_PRIMITIVE_H_
+#define TINK_RELOADING_PRIMITIVE_H_
+
+#include <memory>
+#include <utility>
+
+#include "absl/time/time.h"
+#include "tink/keyset_handle.h"
+#include "tink/keyset_reloader.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+
+// A handle to the primitive of a keyset that is reloaded from its source
+// (see KeysetReloader), so that a key rotation reaches all the users of
+// the primitive without restarting them.  For example:
+//
+//   auto reloading_aead = std::move(ReloadingPrimitive<Aead>::New(
+//       KeysetReloader::EncryptedKeysetLoader(reader_factory, kms_aead),
+//       absl::Minutes(1)).ValueOrDie());
+//   ...
+//   auto ciphertext = reloading_aead->Get()->Encrypt(plaintext, ad);
+//
+// Every new version of the keyset is turned into a primitive on the
+// reloading thread, and then published with an atomic pointer swap.
+// Get() never waits for a reload, and the primitive it returns stays
+// valid (and keeps using the keyset it was built from) for as long as the
+// caller holds it, even if a new version is published in the meantime.
+template <class P>
+class ReloadingPrimitive {
+ public:
+  // Loads the keyset with 'loader' and builds its primitive; if
+  // 'poll_interval' is positive, the keyset is then reloaded every
+  // 'poll_interval'.  Fails if the initial load fails.
+  static crypto::tink::util::StatusOr<std::unique_ptr<ReloadingPrimitive<P>>>
+  New(KeysetReloader::Loader loader, absl::Duration poll_interval) {
+    std::unique_ptr<ReloadingPrimitive<P>> reloading(
+        new ReloadingPrimitive<P>());
+    ReloadingPrimitive<P>* reloading_ptr = reloading.get();
+    auto reloader_result = KeysetReloader::New(
+        std::move(loader),
+        [reloading_ptr](const KeysetHandle& handle) {
+          return reloading_ptr->Publish(handle);
+        },
+        poll_interval);
+    if (!reloader_result.ok()) return reloader_result.status();
+    reloading->reloader_ = std::move(reloader_result.ValueOrDie());
+    return std::move(reloading);
+  }
+
+  ReloadingPrimitive(const ReloadingPrimitive&) = delete;
+  ReloadingPrimitive& operator=(const ReloadingPrimitive&) = delete;
+
+  // Returns the primitive of the current version of the keyset.
+  std::shared_ptr<P> Get() const { return std::atomic_load(&primitive_); }
+
+  // Reloads the keyset now, e.g. when its source has been changed.
+  crypto::tink::util::Status Reload() { return reloader_->Reload(); }
+
+  KeysetReloader::Stats GetStats() const { return reloader_->GetStats(); }
+
+ private:
+  ReloadingPrimitive() {}
+
+  crypto::tink::util::Status Publish(const KeysetHandle& handle) {
+    auto primitive_result = handle.GetPrimitive<P>();
+    if (!primitive_result.ok()) return primitive_result.status();
+    std::shared_ptr<P> primitive(std::move(primitive_result.ValueOrDie()));
+    std::atomic_store(&primitive_, std::move(primitive));
+    return crypto::tink::util::OkStatus();
+  }
+
+  // Only accessed with std::atomic_load() and std::atomic_store().
+  std::shared_ptr<P> primitive_;
+  // Declared last, so that the reloader stops before 'primitive_' is
+  // destroyed.
+  std::unique_ptr<KeysetReloader> reloader_;
+};
+
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_RELOADING_PRIMITIVE_H_
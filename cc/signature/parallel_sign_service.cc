@@ -0,0 +1,148 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/signature/parallel_sign_service.h"
+
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/notification.h"
+#include "tink/public_key_sign.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+
+// static
+util::StatusOr<std::unique_ptr<ParallelSignService>> ParallelSignService::New(
+    int num_workers, int max_queue_size) {
+  if (num_workers <= 0) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+                        "num_workers must be positive");
+  }
+  if (max_queue_size <= 0) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+                        "max_queue_size must be positive");
+  }
+  std::unique_ptr<ParallelSignService> service(
+      new ParallelSignService(num_workers, max_queue_size));
+  return std::move(service);
+}
+
+ParallelSignService::ParallelSignService(int num_workers, int max_queue_size)
+    : next_key_worker_(0) {
+  workers_.reserve(num_workers);
+  for (int i = 0; i < num_workers; i++) {
+    workers_.push_back(absl::make_unique<util::ThreadPool>(1, max_queue_size));
+  }
+}
+
+ParallelSignService::~ParallelSignService() {
+  // Drain the workers while the keys are still alive.
+  workers_.clear();
+}
+
+util::Status ParallelSignService::AddKey(absl::string_view key_name,
+                                         std::unique_ptr<PublicKeySign> signer,
+                                         int num_key_workers) {
+  if (signer == nullptr) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+                        "signer must be non-NULL");
+  }
+  if (num_key_workers <= 0 || num_key_workers > num_workers()) {
+    return util::Status(
+        util::error::INVALID_ARGUMENT,
+        absl::StrCat("num_key_workers must be between 1 and ", num_workers()));
+  }
+  auto key = absl::make_unique<Key>();
+  key->signer = std::move(signer);
+  key->next_worker = 0;
+  absl::MutexLock lock(&keys_mutex_);
+  if (keys_.find(std::string(key_name)) != keys_.end()) {
+    return util::Status(util::error::ALREADY_EXISTS,
+                        absl::StrCat("key '", key_name, "' already exists"));
+  }
+  for (int i = 0; i < num_key_workers; i++) {
+    key->workers.push_back(workers_[next_key_worker_].get());
+    next_key_worker_ = (next_key_worker_ + 1) % num_workers();
+  }
+  keys_.emplace(std::string(key_name), std::move(key));
+  return util::OkStatus();
+}
+
+util::Status ParallelSignService::Schedule(absl::string_view key_name,
+                                           absl::string_view data,
+                                           DoneCallback done,
+                                           bool block) const {
+  const Key* key;
+  {
+    absl::MutexLock lock(&keys_mutex_);
+    auto found = keys_.find(std::string(key_name));
+    if (found == keys_.end()) {
+      return util::Status(util::error::NOT_FOUND,
+                          absl::StrCat("key '", key_name, "' not found"));
+    }
+    // The keys are never removed, so 'key' stays valid.
+    key = found->second.get();
+  }
+  util::ThreadPool* worker =
+      key->workers[key->next_worker.fetch_add(1, std::memory_order_relaxed) %
+                   key->workers.size()];
+  std::string data_copy(data);
+  auto closure = [key, data_copy, done]() {
+    done(key->signer->Sign(data_copy));
+  };
+  if (!block) {
+    if (!worker->TrySchedule(std::move(closure))) {
+      return util::Status(util::error::RESOURCE_EXHAUSTED,
+                          "the signing queue is full");
+    }
+    return util::OkStatus();
+  }
+  worker->Schedule(std::move(closure));
+  return util::OkStatus();
+}
+
+util::Status ParallelSignService::SignAsync(absl::string_view key_name,
+                                            absl::string_view data,
+                                            DoneCallback done) const {
+  return Schedule(key_name, data, std::move(done), /*block=*/true);
+}
+
+util::Status ParallelSignService::TrySignAsync(absl::string_view key_name,
+                                               absl::string_view data,
+                                               DoneCallback done) const {
+  return Schedule(key_name, data, std::move(done), /*block=*/false);
+}
+
+util::StatusOr<std::string> ParallelSignService::Sign(
+    absl::string_view key_name, absl::string_view data) const {
+  absl::Notification finished;
+  util::StatusOr<std::string> result;
+  auto status = SignAsync(key_name, data,
+                          [&finished, &result](util::StatusOr<std::string> r) {
+                            result = std::move(r);
+                            finished.Notify();
+                          });
+  if (!status.ok()) return status;
+  finished.WaitForNotification();
+  return result;
+}
+
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,128 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_SIGNATURE_PARALLEL_SIGN_SERVICE_H_
+#define TINK_SIGNATURE_PARALLEL_SIGN_SERVICE_H_
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "tink/public_key_sign.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "tink/util/thread_pool.h"
+
+namespace crypto {
+namespace tink {
+
+// An asynchronous front-end, which executes the Sign-operations of
+// several PublicKeySign primitives (e.g. RSA signers, whose private key
+// operations take milliseconds) on a fixed set of worker threads.
+//
+// Each key is served by a fixed subset of the workers, so that the state
+// of the key (e.g. the Montgomery contexts of an RSA key) stays in the
+// caches of the cores running these workers.  The keys are spread over
+// the workers in the order they are added.
+//
+// Every worker has a bounded queue of pending requests.  SignAsync()
+// blocks while the queue of the selected worker is full, TrySignAsync()
+// fails with RESOURCE_EXHAUSTED instead, so that callers can shed load.
+//
+// The destructor waits until all the requests scheduled so far have been
+// executed.
+class ParallelSignService {
+ public:
+  using DoneCallback =
+      std::function<void(crypto::tink::util::StatusOr<std::string>)>;
+
+  // Returns a service with 'num_workers' worker threads, each of which
+  // queues at most 'max_queue_size' requests.
+  static crypto::tink::util::StatusOr<std::unique_ptr<ParallelSignService>>
+  New(int num_workers, int max_queue_size);
+
+  ParallelSignService(const ParallelSignService&) = delete;
+  ParallelSignService& operator=(const ParallelSignService&) = delete;
+
+  ~ParallelSignService();
+
+  // Adds 'signer' under the name 'key_name'.  The requests for the key
+  // are executed by 'num_key_workers' of the workers, which must be
+  // between 1 and the number of workers.
+  crypto::tink::util::Status AddKey(absl::string_view key_name,
+                                    std::unique_ptr<PublicKeySign> signer,
+                                    int num_key_workers)
+      LOCKS_EXCLUDED(keys_mutex_);
+
+  // Signs 'data' with the key 'key_name', and passes the signature to
+  // 'done' on a worker thread.  Blocks while the queue of the worker
+  // is full.  Returns an error (and does not invoke 'done') if the key
+  // is unknown.  'done' must not call SignAsync().
+  crypto::tink::util::Status SignAsync(absl::string_view key_name,
+                                       absl::string_view data,
+                                       DoneCallback done) const
+      LOCKS_EXCLUDED(keys_mutex_);
+
+  // Same as SignAsync(), but fails with RESOURCE_EXHAUSTED (and does not
+  // invoke 'done') if the queue of the worker is full.
+  crypto::tink::util::Status TrySignAsync(absl::string_view key_name,
+                                          absl::string_view data,
+                                          DoneCallback done) const
+      LOCKS_EXCLUDED(keys_mutex_);
+
+  // Signs 'data' with the key 'key_name' on a worker thread, and waits
+  // for the result.
+  crypto::tink::util::StatusOr<std::string> Sign(absl::string_view key_name,
+                                                 absl::string_view data) const
+      LOCKS_EXCLUDED(keys_mutex_);
+
+  int num_workers() const { return workers_.size(); }
+
+ private:
+  struct Key {
+    std::unique_ptr<PublicKeySign> signer;
+    std::vector<util::ThreadPool*> workers;
+    // Round-robin position in 'workers'.
+    mutable std::atomic<uint32_t> next_worker;
+  };
+
+  ParallelSignService(int num_workers, int max_queue_size);
+
+  crypto::tink::util::Status Schedule(absl::string_view key_name,
+                                      absl::string_view data,
+                                      DoneCallback done, bool block) const
+      LOCKS_EXCLUDED(keys_mutex_);
+
+  mutable absl::Mutex keys_mutex_;
+  std::unordered_map<std::string, std::unique_ptr<Key>> keys_
+      GUARDED_BY(keys_mutex_);
+  // The worker at which the next key added starts.
+  int next_key_worker_ GUARDED_BY(keys_mutex_);
+  // Declared last, so that the workers are drained before the keys are
+  // destroyed.
+  std::vector<std::unique_ptr<util::ThreadPool>> workers_;
+};
+
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_SIGNATURE_PARALLEL_SIGN_SERVICE_H_
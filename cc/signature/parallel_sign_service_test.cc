@@ -0,0 +1,178 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/signature/parallel_sign_service.h"
+
+#include <set>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+
+#include "gtest/gtest.h"
+#include "absl/memory/memory.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "tink/public_key_sign.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "tink/util/test_util.h"
+
+namespace crypto {
+namespace tink {
+namespace {
+
+using crypto::tink::test::DummyPublicKeySign;
+
+// A PublicKeySign that records the threads it signs on, and optionally
+// blocks until released.
+class RecordingSign : public PublicKeySign {
+ public:
+  explicit RecordingSign(absl::Notification* release = nullptr)
+      : release_(release) {}
+
+  util::StatusOr<std::string> Sign(absl::string_view data) const override {
+    if (release_ != nullptr) release_->WaitForNotification();
+    absl::MutexLock lock(&mutex_);
+    threads_.insert(std::this_thread::get_id());
+    return std::string(data);
+  }
+
+  int num_threads() const {
+    absl::MutexLock lock(&mutex_);
+    return threads_.size();
+  }
+
+ private:
+  absl::Notification* release_;
+  mutable absl::Mutex mutex_;
+  mutable std::set<std::thread::id> threads_ GUARDED_BY(mutex_);
+};
+
+TEST(ParallelSignServiceTest, InvalidArguments) {
+  EXPECT_FALSE(ParallelSignService::New(0, 10).ok());
+  EXPECT_FALSE(ParallelSignService::New(2, 0).ok());
+  auto service = std::move(ParallelSignService::New(2, 10).ValueOrDie());
+  EXPECT_FALSE(service->AddKey("key", nullptr, 1).ok());
+  EXPECT_FALSE(
+      service->AddKey("key", absl::make_unique<DummyPublicKeySign>("a"), 0)
+          .ok());
+  EXPECT_FALSE(
+      service->AddKey("key", absl::make_unique<DummyPublicKeySign>("a"), 3)
+          .ok());
+  EXPECT_TRUE(
+      service->AddKey("key", absl::make_unique<DummyPublicKeySign>("a"), 2)
+          .ok());
+  EXPECT_EQ(util::error::ALREADY_EXISTS,
+            service->AddKey("key", absl::make_unique<DummyPublicKeySign>("b"), 1)
+                .error_code());
+  EXPECT_EQ(util::error::NOT_FOUND,
+            service->Sign("unknown key", "data").status().error_code());
+}
+
+TEST(ParallelSignServiceTest, SignsWithTheRightKey) {
+  auto service = std::move(ParallelSignService::New(3, 10).ValueOrDie());
+  ASSERT_TRUE(
+      service->AddKey("a", absl::make_unique<DummyPublicKeySign>("a"), 1).ok());
+  ASSERT_TRUE(
+      service->AddKey("b", absl::make_unique<DummyPublicKeySign>("b"), 2).ok());
+  const int kRequestCount = 100;
+  absl::BlockingCounter pending(2 * kRequestCount);
+  for (int i = 0; i < kRequestCount; i++) {
+    std::string data = std::to_string(i);
+    for (std::string key_name : {"a", "b"}) {
+      std::string expected =
+          DummyPublicKeySign(key_name).Sign(data).ValueOrDie();
+      auto status = service->SignAsync(
+          key_name, data,
+          [expected, &pending](util::StatusOr<std::string> result) {
+            EXPECT_TRUE(result.ok()) << result.status();
+            EXPECT_EQ(expected, result.ValueOrDie());
+            pending.DecrementCount();
+          });
+      EXPECT_TRUE(status.ok()) << status;
+    }
+  }
+  pending.Wait();
+  EXPECT_EQ(DummyPublicKeySign("a").Sign("x").ValueOrDie(),
+            service->Sign("a", "x").ValueOrDie());
+}
+
+TEST(ParallelSignServiceTest, KeysStayOnTheirWorkers) {
+  auto service = std::move(ParallelSignService::New(4, 100).ValueOrDie());
+  auto one_worker_sign = absl::make_unique<RecordingSign>();
+  auto two_workers_sign = absl::make_unique<RecordingSign>();
+  const RecordingSign* one_worker = one_worker_sign.get();
+  const RecordingSign* two_workers = two_workers_sign.get();
+  ASSERT_TRUE(service->AddKey("one", std::move(one_worker_sign), 1).ok());
+  ASSERT_TRUE(service->AddKey("two", std::move(two_workers_sign), 2).ok());
+  for (int i = 0; i < 50; i++) {
+    ASSERT_TRUE(service->Sign("one", "data").ok());
+    ASSERT_TRUE(service->Sign("two", "data").ok());
+  }
+  EXPECT_EQ(1, one_worker->num_threads());
+  EXPECT_EQ(2, two_workers->num_threads());
+}
+
+TEST(ParallelSignServiceTest, BackPressure) {
+  absl::Notification release;
+  auto service = std::move(ParallelSignService::New(1, 2).ValueOrDie());
+  ASSERT_TRUE(
+      service->AddKey("key", absl::make_unique<RecordingSign>(&release), 1)
+          .ok());
+  absl::BlockingCounter pending(3);
+  auto done = [&pending](util::StatusOr<std::string> result) {
+    EXPECT_TRUE(result.ok());
+    pending.DecrementCount();
+  };
+  // The first request blocks the worker, once it has been dequeued.
+  ASSERT_TRUE(service->TrySignAsync("key", "data", done).ok());
+  util::Status status;
+  int accepted = 1;
+  while ((status = service->TrySignAsync("key", "data", done)).ok()) {
+    accepted++;
+    ASSERT_LE(accepted, 3);
+  }
+  EXPECT_EQ(util::error::RESOURCE_EXHAUSTED, status.error_code());
+  // The worker may not have dequeued the first request yet.
+  while (accepted < 3) {
+    if (service->TrySignAsync("key", "data", done).ok()) accepted++;
+  }
+  release.Notify();
+  pending.Wait();
+}
+
+TEST(ParallelSignServiceTest, DestructorDrainsQueues) {
+  std::atomic<int> signed_count(0);
+  {
+    auto service = std::move(ParallelSignService::New(2, 1000).ValueOrDie());
+    ASSERT_TRUE(
+        service->AddKey("key", absl::make_unique<DummyPublicKeySign>("a"), 2)
+            .ok());
+    for (int i = 0; i < 200; i++) {
+      ASSERT_TRUE(service
+                      ->SignAsync("key", "data",
+                                  [&signed_count](util::StatusOr<std::string>) {
+                                    signed_count++;
+                                  })
+                      .ok());
+    }
+  }
+  EXPECT_EQ(200, signed_count.load());
+}
+
+}  // namespace
+}  // namespace tink
+}  // namespace crypto
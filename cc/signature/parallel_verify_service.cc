@@ -0,0 +1,95 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/signature/parallel_verify_service.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/synchronization/blocking_counter.h"
+#include "tink/public_key_verify.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+
+// static
+util::StatusOr<std::unique_ptr<ParallelVerifyService>>
+ParallelVerifyService::New(std::unique_ptr<PublicKeyVerify> verifier,
+                           int num_threads, int min_chunk_size) {
+  if (verifier == nullptr) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+                        "verifier must be non-NULL");
+  }
+  if (num_threads <= 0) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+                        "num_threads must be positive");
+  }
+  if (min_chunk_size <= 0) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+                        "min_chunk_size must be positive");
+  }
+  std::unique_ptr<ParallelVerifyService> service(new ParallelVerifyService(
+      std::move(verifier), num_threads, min_chunk_size));
+  return std::move(service);
+}
+
+ParallelVerifyService::ParallelVerifyService(
+    std::unique_ptr<PublicKeyVerify> verifier, int num_threads,
+    int min_chunk_size)
+    : verifier_(std::move(verifier)),
+      min_chunk_size_(min_chunk_size),
+      pool_(num_threads) {}
+
+std::vector<util::Status> ParallelVerifyService::VerifyBatch(
+    absl::Span<const SignedData> batch) const {
+  std::vector<util::Status> results(batch.size());
+  auto verify_chunk = [this, batch, &results](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      results[i] = verifier_->Verify(batch[i].signature, batch[i].data);
+    }
+  };
+  // One chunk per worker thread, plus one for the calling thread.
+  size_t max_chunks = pool_.num_threads() + 1;
+  size_t num_chunks =
+      std::max<size_t>(1, std::min(max_chunks, batch.size() / min_chunk_size_));
+  size_t chunk_size = (batch.size() + num_chunks - 1) / num_chunks;
+  // Rounding the chunk size up may leave fewer chunks than planned, e.g.
+  // 3 chunks of 3 (not 4 chunks) for 9 signatures; no chunk is empty.
+  if (chunk_size > 0) {
+    num_chunks = (batch.size() + chunk_size - 1) / chunk_size;
+  }
+  if (num_chunks <= 1) {
+    verify_chunk(0, batch.size());
+    return results;
+  }
+  absl::BlockingCounter pending(num_chunks - 1);
+  for (size_t chunk = 1; chunk < num_chunks; chunk++) {
+    size_t begin = chunk * chunk_size;
+    size_t end = std::min(batch.size(), begin + chunk_size);
+    pool_.Schedule([&verify_chunk, &pending, begin, end]() {
+      verify_chunk(begin, end);
+      pending.DecrementCount();
+    });
+  }
+  verify_chunk(0, chunk_size);
+  pending.Wait();
+  return results;
+}
+
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,71 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_SIGNATURE_PARALLEL_VERIFY_SERVICE_H_
+#define TINK_SIGNATURE_PARALLEL_VERIFY_SERVICE_H_
+
+#include <memory>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "tink/public_key_verify.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "tink/util/thread_pool.h"
+
+namespace crypto {
+namespace tink {
+
+// A batch front-end for a PublicKeyVerify primitive (e.g. an RSA verifier),
+// which verifies the signatures of a batch on a pool of worker threads.
+//
+// A batch is split into contiguous chunks of at least 'min_chunk_size'
+// signatures, one per worker thread at most; the calling thread verifies
+// one of the chunks itself.  Small batches are thus verified on the calling
+// thread only, without any synchronization.
+class ParallelVerifyService {
+ public:
+  struct SignedData {
+    absl::string_view signature;
+    absl::string_view data;
+  };
+
+  // Returns a service that verifies with 'verifier' on 'num_threads'
+  // worker threads (and the calling thread).
+  static crypto::tink::util::StatusOr<std::unique_ptr<ParallelVerifyService>>
+  New(std::unique_ptr<PublicKeyVerify> verifier, int num_threads,
+      int min_chunk_size);
+
+  // Verifies all the signatures of 'batch', and returns the result of
+  // each verification, in the order of 'batch'.  Thread-safe.
+  std::vector<crypto::tink::util::Status> VerifyBatch(
+      absl::Span<const SignedData> batch) const;
+
+ private:
+  ParallelVerifyService(std::unique_ptr<PublicKeyVerify> verifier,
+                        int num_threads, int min_chunk_size);
+
+  const std::unique_ptr<PublicKeyVerify> verifier_;
+  const size_t min_chunk_size_;
+  // Declared last, so that it is destroyed (and drained) first.
+  mutable util::ThreadPool pool_;
+};
+
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_SIGNATURE_PARALLEL_VERIFY_SERVICE_H_
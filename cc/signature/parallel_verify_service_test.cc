@@ -0,0 +1,122 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/signature/parallel_verify_service.h"
+
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/memory/memory.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "tink/util/test_util.h"
+
+namespace crypto {
+namespace tink {
+namespace {
+
+using crypto::tink::test::DummyPublicKeySign;
+using crypto::tink::test::DummyPublicKeyVerify;
+
+TEST(ParallelVerifyServiceTest, InvalidArguments) {
+  EXPECT_FALSE(ParallelVerifyService::New(nullptr, 2, 1).ok());
+  EXPECT_FALSE(ParallelVerifyService::New(
+                   absl::make_unique<DummyPublicKeyVerify>("a"), 0, 1)
+                   .ok());
+  EXPECT_FALSE(ParallelVerifyService::New(
+                   absl::make_unique<DummyPublicKeyVerify>("a"), 2, 0)
+                   .ok());
+}
+
+TEST(ParallelVerifyServiceTest, VerifyBatch) {
+  auto service = std::move(ParallelVerifyService::New(
+                               absl::make_unique<DummyPublicKeyVerify>("a"),
+                               3, 4)
+                               .ValueOrDie());
+  DummyPublicKeySign signer("a");
+  // Batches smaller than, equal to, and larger than a chunk, with sizes
+  // that do not divide evenly.
+  for (int batch_size : {0, 1, 3, 4, 7, 8, 9, 17, 100, 101}) {
+    std::vector<std::string> data(batch_size);
+    std::vector<std::string> signatures(batch_size);
+    std::vector<ParallelVerifyService::SignedData> batch(batch_size);
+    for (int i = 0; i < batch_size; i++) {
+      data[i] = std::to_string(i);
+      // Every third signature is invalid.
+      signatures[i] = i % 3 == 2 ? "invalid" : signer.Sign(data[i]).ValueOrDie();
+      batch[i] = {signatures[i], data[i]};
+    }
+    auto results = service->VerifyBatch(batch);
+    ASSERT_EQ(batch_size, results.size());
+    for (int i = 0; i < batch_size; i++) {
+      EXPECT_EQ(i % 3 != 2, results[i].ok()) << "batch_size " << batch_size
+                                              << ", index " << i;
+    }
+  }
+}
+
+TEST(ParallelVerifyServiceTest, ChunksRoundedUp) {
+  // With 7 workers, 9 signatures would be 8 planned chunks of 2, i.e. only
+  // 5 non-empty ones; every signature must still be verified exactly once.
+  auto service = std::move(ParallelVerifyService::New(
+                               absl::make_unique<DummyPublicKeyVerify>("a"),
+                               7, 1)
+                               .ValueOrDie());
+  DummyPublicKeySign signer("a");
+  for (int batch_size : {2, 9, 10, 15, 17}) {
+    std::vector<std::string> data(batch_size);
+    std::vector<std::string> signatures(batch_size);
+    std::vector<ParallelVerifyService::SignedData> batch(batch_size);
+    for (int i = 0; i < batch_size; i++) {
+      data[i] = std::to_string(i);
+      signatures[i] = i % 2 ? "invalid" : signer.Sign(data[i]).ValueOrDie();
+      batch[i] = {signatures[i], data[i]};
+    }
+    auto results = service->VerifyBatch(batch);
+    ASSERT_EQ(batch_size, results.size());
+    for (int i = 0; i < batch_size; i++) {
+      EXPECT_EQ(i % 2 == 0, results[i].ok()) << "batch_size " << batch_size
+                                              << ", index " << i;
+    }
+  }
+}
+
+TEST(ParallelVerifyServiceTest, ConcurrentBatches) {
+  auto service = std::move(ParallelVerifyService::New(
+                               absl::make_unique<DummyPublicKeyVerify>("a"),
+                               2, 1)
+                               .ValueOrDie());
+  std::string signature = DummyPublicKeySign("a").Sign("data").ValueOrDie();
+  std::vector<ParallelVerifyService::SignedData> batch(
+      50, ParallelVerifyService::SignedData{signature, "data"});
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&service, &batch]() {
+      for (int i = 0; i < 20; i++) {
+        for (const auto& status : service->VerifyBatch(batch)) {
+          EXPECT_TRUE(status.ok()) << status;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+}
+
+}  // namespace
+}  // namespace tink
+}  // namespace crypto
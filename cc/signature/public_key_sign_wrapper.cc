@@ -64,13 +64,11 @@ util::StatusOr<std::string> PublicKeySignSetWrapper::Sign(
   data = subtle::SubtleUtilBoringSSL::EnsureNonNull(data);
 
   auto primary = public_key_sign_set_->get_primary();
-  std::string local_data;
-  if (primary->get_output_prefix_type() == OutputPrefixType::LEGACY) {
-    local_data = std::string(data);
-    local_data.append(1, CryptoFormat::kLegacyStartByte);
-    data = local_data;
-  }
-  auto sign_result = primary->get_primitive().Sign(data);
+  auto sign_result =
+      primary->get_output_prefix_type() == OutputPrefixType::LEGACY
+          ? primary->get_primitive().SignMultipart(
+                {data, CryptoFormat::kLegacySuffix})
+          : primary->get_primitive().Sign(data);
   if (!sign_result.ok()) return sign_result.status();
   const std::string& key_id = primary->get_identifier();
   return key_id + sign_result.ValueOrDie();
@@ -17,7 +17,9 @@
 #include "tink/signature/public_key_verify_wrapper.h"
 
 #include "tink/crypto_format.h"
+#include "tink/monitoring/monitoring.h"
 #include "tink/primitive_set.h"
+#include "tink/raw_key_trial_order.h"
 #include "tink/public_key_verify.h"
 #include "tink/subtle/subtle_util_boringssl.h"
 #include "tink/util/status.h"
@@ -47,7 +49,10 @@ class PublicKeyVerifySetWrapper : public PublicKeyVerify {
  public:
   explicit PublicKeyVerifySetWrapper(
       std::unique_ptr<PrimitiveSet<PublicKeyVerify>> public_key_verify_set)
-      : public_key_verify_set_(std::move(public_key_verify_set)) {}
+      : public_key_verify_set_(std::move(public_key_verify_set)),
+        raw_primitives_(RawPrimitivesOrNull(public_key_verify_set_.get())),
+        raw_key_trial_order_(raw_primitives_),
+        monitoring_sink_(Monitoring::GetSink()) {}
 
   crypto::tink::util::Status Verify(absl::string_view signature,
                                     absl::string_view data) const override;
@@ -56,6 +61,9 @@ class PublicKeyVerifySetWrapper : public PublicKeyVerify {
 
  private:
   std::unique_ptr<PrimitiveSet<PublicKeyVerify>> public_key_verify_set_;
+  const PrimitiveSet<PublicKeyVerify>::Primitives* raw_primitives_;
+  RawKeyTrialOrder raw_key_trial_order_;
+  std::shared_ptr<MonitoringSink> monitoring_sink_;
 };
 
 util::Status PublicKeyVerifySetWrapper::Verify(
@@ -65,10 +73,13 @@ util::Status PublicKeyVerifySetWrapper::Verify(
   // regardless of whether the size is 0.
   data = subtle::SubtleUtilBoringSSL::EnsureNonNull(data);
   signature = subtle::SubtleUtilBoringSSL::EnsureNonNull(signature);
+  MonitoredOperation operation(monitoring_sink_.get(), "public_key_verify",
+                               MonitoringOperation::kVerify, data.size());
 
   if (signature.length() <= CryptoFormat::kNonRawPrefixSize) {
     // This also rejects raw signatures with size of 4 bytes or fewer.
     // We're not aware of any schemes that output signatures that small.
+    operation.RecordFailure();
     return util::Status(util::error::INVALID_ARGUMENT, "Signature too short.");
   }
   const std::string& key_id = std::string(
@@ -77,17 +88,17 @@ util::Status PublicKeyVerifySetWrapper::Verify(
   if (primitives_result.ok()) {
     absl::string_view raw_signature =
         signature.substr(CryptoFormat::kNonRawPrefixSize);
-    std::string local_data;
     for (auto& entry : *(primitives_result.ValueOrDie())) {
-      if (entry->get_output_prefix_type() == OutputPrefixType::LEGACY) {
-        local_data = std::string(data);
-        local_data.append(1, CryptoFormat::kLegacyStartByte);
-        data = local_data;
-      }
-      auto& public_key_verify = entry->get_primitive();
+      auto public_key_verify_result = entry->GetOrCreatePrimitive();
+      if (!public_key_verify_result.ok()) continue;
+      auto& public_key_verify = *public_key_verify_result.ValueOrDie();
       auto verify_result =
-          public_key_verify.Verify(raw_signature, data);
+          entry->get_output_prefix_type() == OutputPrefixType::LEGACY
+              ? public_key_verify.VerifyMultipart(
+                    raw_signature, {data, CryptoFormat::kLegacySuffix})
+              : public_key_verify.Verify(raw_signature, data);
       if (verify_result.ok()) {
+        operation.RecordSuccess(entry->get_key_id());
         return util::Status::OK;
       } else {
         // LOG that a matching key didn't verify the signature.
@@ -96,17 +107,18 @@ util::Status PublicKeyVerifySetWrapper::Verify(
   }
 
   // No matching key succeeded with verification, try all RAW keys.
-  auto raw_primitives_result = public_key_verify_set_->get_raw_primitives();
-  if (raw_primitives_result.ok()) {
-    for (auto& public_key_verify_entry :
-             *(raw_primitives_result.ValueOrDie())) {
-      auto& public_key_verify = public_key_verify_entry->get_primitive();
-      auto verify_result = public_key_verify.Verify(signature, data);
-      if (verify_result.ok()) {
-        return util::Status::OK;
-      }
-    }
+  int index = raw_key_trial_order_.TryKeys([&](int i) {
+    operation.AddRawTrial();
+    auto public_key_verify_result =
+        (*raw_primitives_)[i]->GetOrCreatePrimitive();
+    if (!public_key_verify_result.ok()) return false;
+    return public_key_verify_result.ValueOrDie()->Verify(signature, data).ok();
+  });
+  if (index >= 0) {
+    operation.RecordSuccess((*raw_primitives_)[index]->get_key_id());
+    return util::Status::OK;
   }
+  operation.RecordFailure();
   return util::Status(util::error::INVALID_ARGUMENT, "Invalid signature.");
 }
 
@@ -0,0 +1,55 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_STREAMING_HYBRID_DECRYPT_H_
+#define TINK_STREAMING_HYBRID_DECRYPT_H_
+
+#include <memory>
+
+#include "absl/strings/string_view.h"
+#include "tink/input_stream.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+
+///////////////////////////////////////////////////////////////////////////////
+// The interface for streaming hybrid decryption.
+//
+// This is the streaming counterpart of HybridDecrypt, cf. the
+// StreamingHybridEncrypt-interface for the security properties.
+class StreamingHybridDecrypt {
+ public:
+  // Returns a wrapper around 'ciphertext_source', such that reading via the
+  // wrapper decrypts the underlying ciphertext, checking that it was
+  // encrypted with 'context_info', and the read bytes are bytes of the
+  // resulting plaintext.  Each plaintext byte is returned only after the
+  // segment containing it has been authenticated; an error is returned if
+  // the ciphertext was modified or truncated.
+  // Position() of the wrapper returns the number of read plaintext bytes.
+  virtual crypto::tink::util::StatusOr<
+      std::unique_ptr<crypto::tink::InputStream>>
+  NewDecryptingStream(
+      std::unique_ptr<crypto::tink::InputStream> ciphertext_source,
+      absl::string_view context_info) const = 0;
+
+  virtual ~StreamingHybridDecrypt() {}
+};
+
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_STREAMING_HYBRID_DECRYPT_H_
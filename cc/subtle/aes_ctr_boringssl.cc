@@ -17,8 +17,9 @@
 #include "tink/subtle/aes_ctr_boringssl.h"
 
 #include <string>
-#include <vector>
+#include <utility>
 
+#include "absl/types/span.h"
 #include "openssl/err.h"
 #include "openssl/evp.h"
 #include "tink/subtle/ind_cpa_cipher.h"
@@ -46,7 +47,9 @@ static const EVP_CIPHER* GetCipherForKeySize(uint32_t size_in_bytes) {
 
 AesCtrBoringSsl::AesCtrBoringSsl(absl::string_view key_value,
                                  uint8_t iv_size, const EVP_CIPHER* cipher)
-    : key_(key_value), iv_size_(iv_size), cipher_(cipher) {}
+    : key_(util::SecretDataFromStringView(key_value)),
+      iv_size_(iv_size),
+      cipher_(cipher) {}
 
 util::StatusOr<std::unique_ptr<IndCpaCipher>> AesCtrBoringSsl::New(
     absl::string_view key_value, uint8_t iv_size) {
@@ -73,42 +76,47 @@ util::StatusOr<std::string> AesCtrBoringSsl::Encrypt(
     return util::Status(util::error::INTERNAL,
                         "could not initialize EVP_CIPHER_CTX");
   }
-  const std::string iv = Random::GetRandomBytes(iv_size_);
+  size_t ciphertext_size = iv_size_ + plaintext.size();
+  // The IV and the ciphertext are written directly into the result, which
+  // is the only allocation per message.  The extra byte keeps &ct[written]
+  // valid for empty plaintexts.
+  std::string ct;
+  ct.resize(ciphertext_size + 1);
+  Random::GetRandomBytes(absl::MakeSpan(&ct[0], iv_size_));
   // OpenSSL expects that the IV must be a full block.
   uint8_t iv_block[BLOCK_SIZE];
   memset(iv_block, 0, sizeof(iv_block));
-  memcpy(iv_block, iv.data(), iv.size());
+  memcpy(iv_block, ct.data(), iv_size_);
   int ret = EVP_EncryptInit_ex(ctx.get(), cipher_, nullptr /* engine */,
                                reinterpret_cast<const uint8_t*>(key_.data()),
                                iv_block);
   if (ret != 1) {
     return util::Status(util::error::INTERNAL, "could not initialize ctx");
   }
-  size_t ciphertext_size = iv.size() + plaintext.size();
-  // Allocates 1 byte more than necessary because we may potentially access
-  // &ct[ciphertext_size] causing vector range check error.
-  std::vector<uint8_t> ct(ciphertext_size + 1);
-  memcpy(&ct[0], reinterpret_cast<const uint8_t*>(iv.data()), iv.size());
-  size_t written = iv.size();
+  size_t written = iv_size_;
   int len;
-  ret = EVP_EncryptUpdate(ctx.get(), &ct[written], &len,
+  ret = EVP_EncryptUpdate(ctx.get(),
+                          reinterpret_cast<uint8_t*>(&ct[written]), &len,
                           reinterpret_cast<const uint8_t*>(plaintext.data()),
                           plaintext.size());
   if (ret != 1) {
-    util::Status(util::error::INTERNAL, "encryption failed");
+    return util::Status(util::error::INTERNAL, "encryption failed");
   }
   written += len;
 
   if (written != ciphertext_size) {
-    util::Status(util::error::INTERNAL, "incorrect ciphertext size");
+    return util::Status(util::error::INTERNAL, "incorrect ciphertext size");
   }
-  return std::string(reinterpret_cast<const char*>(&ct[0]), written);
+  ct.resize(written);
+  return std::move(ct);
 }
 
 util::StatusOr<std::string> AesCtrBoringSsl::Decrypt(
     absl::string_view ciphertext) const {
   if (ciphertext.size() < iv_size_) {
-    return util::Status(util::error::INTERNAL, "ciphertext too short");
+    static const util::StaticStatus* kCiphertextTooShort =
+        new util::StaticStatus(util::error::INTERNAL, "ciphertext too short");
+    return *kCiphertextTooShort;
   }
 
   bssl::UniquePtr<EVP_CIPHER_CTX> ctx(EVP_CIPHER_CTX_new());
@@ -130,25 +138,29 @@ util::StatusOr<std::string> AesCtrBoringSsl::Decrypt(
   }
 
   size_t plaintext_size = ciphertext.size() - iv_size_;
-  // Allocates 1 byte more than necessary because we may potentially access
-  // &pt[plaintext_size] causing vector range check error.
-  std::vector<uint8_t> pt(plaintext_size + 1);
+  // The plaintext is written directly into the result; the extra byte
+  // keeps &pt[0] valid for empty plaintexts.
+  std::string pt;
+  pt.resize(plaintext_size + 1);
   size_t read = iv_size_;
   size_t written = 0;
   int len;
   ret = EVP_DecryptUpdate(
-      ctx.get(), &pt[written], &len,
+      ctx.get(), reinterpret_cast<uint8_t*>(&pt[written]), &len,
       reinterpret_cast<const uint8_t*>(&ciphertext.data()[read]),
       plaintext_size);
   if (ret != 1) {
-    util::Status(util::error::INTERNAL, "decryption failed");
+    static const util::StaticStatus* kDecryptionFailed =
+        new util::StaticStatus(util::error::INTERNAL, "decryption failed");
+    return *kDecryptionFailed;
   }
   written += len;
 
   if (written != plaintext_size) {
     return util::Status(util::error::INTERNAL, "incorrect plaintext size");
   }
-  return std::string(reinterpret_cast<const char*>(&pt[0]), written);
+  pt.resize(written);
+  return std::move(pt);
 }
 
 }  // namespace subtle
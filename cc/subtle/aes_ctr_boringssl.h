@@ -21,6 +21,7 @@
 
 #include "absl/strings/string_view.h"
 #include "tink/subtle/ind_cpa_cipher.h"
+#include "tink/util/secret_data.h"
 #include "tink/util/status.h"
 #include "tink/util/statusor.h"
 #include "openssl/evp.h"
@@ -50,7 +51,7 @@ class AesCtrBoringSsl : public IndCpaCipher {
   AesCtrBoringSsl(absl::string_view key_value, uint8_t iv_size,
                   const EVP_CIPHER *cipher);
 
-  const std::string key_;
+  const crypto::tink::util::SecretData key_;
   uint8_t iv_size_;
   // cipher_ is a singleton owned by BoringSsl.
   const EVP_CIPHER *cipher_;
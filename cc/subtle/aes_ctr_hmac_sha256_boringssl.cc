@@ -0,0 +1,257 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/subtle/aes_ctr_hmac_sha256_boringssl.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#include "absl/types/span.h"
+#include "openssl/evp.h"
+#include "openssl/hmac.h"
+#include "tink/aead.h"
+#include "tink/subtle/random.h"
+#include "tink/subtle/subtle_util_boringssl.h"
+#include "tink/util/errors.h"
+#include "tink/util/secret_data.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+
+namespace crypto {
+namespace tink {
+namespace subtle {
+
+constexpr size_t AesCtrHmacSha256BoringSsl::kChunkSize;
+
+namespace {
+
+const EVP_CIPHER* GetCipherForKeySize(uint32_t size_in_bytes) {
+  switch (size_in_bytes) {
+    case 16:
+      return EVP_aes_128_ctr();
+    case 32:
+      return EVP_aes_256_ctr();
+    default:
+      return nullptr;
+  }
+}
+
+void LongToBigEndian(uint64_t value, uint8_t bytes[8]) {
+  for (int i = 7; i >= 0; i--) {
+    bytes[i] = value & 0xff;
+    value >>= 8;
+  }
+}
+
+util::Status HmacFailed() {
+  return util::Status(util::error::INTERNAL,
+                      "BoringSSL failed to compute HMAC");
+}
+
+}  // namespace
+
+// static
+util::StatusOr<std::unique_ptr<Aead>> AesCtrHmacSha256BoringSsl::New(
+    absl::string_view aes_key_value, uint8_t iv_size,
+    absl::string_view hmac_key_value, uint8_t tag_size) {
+  const EVP_CIPHER* cipher = GetCipherForKeySize(aes_key_value.size());
+  if (cipher == nullptr) {
+    return util::Status(util::error::INTERNAL, "invalid key size");
+  }
+  if (iv_size < MIN_IV_SIZE_IN_BYTES || iv_size > BLOCK_SIZE) {
+    return util::Status(util::error::INTERNAL, "invalid iv size");
+  }
+  if (hmac_key_value.size() < MIN_HMAC_KEY_SIZE_IN_BYTES) {
+    return util::Status(util::error::INTERNAL, "invalid HMAC key size");
+  }
+  if (tag_size < MIN_TAG_SIZE_IN_BYTES ||
+      tag_size > EVP_MD_size(EVP_sha256())) {
+    return util::Status(util::error::INTERNAL, "invalid tag size");
+  }
+  std::unique_ptr<Aead> aead(new AesCtrHmacSha256BoringSsl(
+      aes_key_value, iv_size, cipher, hmac_key_value, tag_size));
+  return std::move(aead);
+}
+
+AesCtrHmacSha256BoringSsl::AesCtrHmacSha256BoringSsl(
+    absl::string_view aes_key_value, uint8_t iv_size,
+    const EVP_CIPHER* cipher, absl::string_view hmac_key_value,
+    uint8_t tag_size)
+    : aes_key_(util::SecretDataFromStringView(aes_key_value)),
+      iv_size_(iv_size),
+      cipher_(cipher),
+      hmac_key_(util::SecretDataFromStringView(hmac_key_value)),
+      tag_size_(tag_size) {}
+
+util::StatusOr<std::string> AesCtrHmacSha256BoringSsl::Encrypt(
+    absl::string_view plaintext,
+    absl::string_view additional_data) const {
+  // BoringSSL expects a non-null pointer for plaintext and additional_data,
+  // regardless of whether the size is 0.
+  plaintext = SubtleUtilBoringSSL::EnsureNonNull(plaintext);
+  additional_data = SubtleUtilBoringSSL::EnsureNonNull(additional_data);
+
+  bssl::UniquePtr<EVP_CIPHER_CTX> ctx(EVP_CIPHER_CTX_new());
+  if (ctx.get() == nullptr) {
+    return util::Status(util::error::INTERNAL,
+                        "could not initialize EVP_CIPHER_CTX");
+  }
+  // The IV, the ciphertext and the tag are written directly into the
+  // result, which is never empty since iv_size_ > 0.
+  std::string ct;
+  ct.resize(iv_size_ + plaintext.size() + tag_size_);
+  uint8_t* out = reinterpret_cast<uint8_t*>(&ct[0]);
+  Random::GetRandomBytes(absl::MakeSpan(&ct[0], iv_size_));
+  // OpenSSL expects that the IV must be a full block.
+  uint8_t iv_block[BLOCK_SIZE];
+  memset(iv_block, 0, sizeof(iv_block));
+  memcpy(iv_block, out, iv_size_);
+  if (EVP_EncryptInit_ex(ctx.get(), cipher_, nullptr /* engine */,
+                         aes_key_.data(), iv_block) != 1) {
+    return util::Status(util::error::INTERNAL, "could not initialize ctx");
+  }
+
+  bssl::ScopedHMAC_CTX hmac;
+  if (HMAC_Init_ex(hmac.get(), hmac_key_.data(), hmac_key_.size(),
+                   EVP_sha256(), nullptr) != 1 ||
+      HMAC_Update(hmac.get(),
+                  reinterpret_cast<const uint8_t*>(additional_data.data()),
+                  additional_data.size()) != 1 ||
+      HMAC_Update(hmac.get(), out, iv_size_) != 1) {
+    return HmacFailed();
+  }
+
+  const uint8_t* in = reinterpret_cast<const uint8_t*>(plaintext.data());
+  uint8_t* ct_out = out + iv_size_;
+  for (size_t offset = 0; offset < plaintext.size(); offset += kChunkSize) {
+    size_t chunk_size = std::min(kChunkSize, plaintext.size() - offset);
+    int len;
+    if (EVP_EncryptUpdate(ctx.get(), ct_out + offset, &len, in + offset,
+                          chunk_size) != 1 ||
+        static_cast<size_t>(len) != chunk_size) {
+      return util::Status(util::error::INTERNAL, "encryption failed");
+    }
+    if (HMAC_Update(hmac.get(), ct_out + offset, chunk_size) != 1) {
+      return HmacFailed();
+    }
+  }
+
+  uint8_t aad_size_in_bits[8];
+  LongToBigEndian(additional_data.size() * 8, aad_size_in_bits);
+  uint8_t tag[EVP_MAX_MD_SIZE];
+  unsigned int tag_len;
+  if (HMAC_Update(hmac.get(), aad_size_in_bits,
+                  sizeof(aad_size_in_bits)) != 1 ||
+      HMAC_Final(hmac.get(), tag, &tag_len) != 1) {
+    return HmacFailed();
+  }
+  memcpy(ct_out + plaintext.size(), tag, tag_size_);
+  return std::move(ct);
+}
+
+util::StatusOr<std::string> AesCtrHmacSha256BoringSsl::Decrypt(
+    absl::string_view ciphertext,
+    absl::string_view additional_data) const {
+  // BoringSSL expects a non-null pointer for additional_data,
+  // regardless of whether the size is 0.
+  additional_data = SubtleUtilBoringSSL::EnsureNonNull(additional_data);
+
+  if (ciphertext.size() < iv_size_ + tag_size_) {
+    static const util::StaticStatus* kCiphertextTooShort =
+        new util::StaticStatus(util::error::INTERNAL, "ciphertext too short");
+    return *kCiphertextTooShort;
+  }
+
+  bssl::UniquePtr<EVP_CIPHER_CTX> ctx(EVP_CIPHER_CTX_new());
+  if (ctx.get() == nullptr) {
+    return util::Status(util::error::INTERNAL,
+                        "could not initialize EVP_CIPHER_CTX");
+  }
+  const uint8_t* in = reinterpret_cast<const uint8_t*>(ciphertext.data());
+  uint8_t iv_block[BLOCK_SIZE];
+  memset(iv_block, 0, sizeof(iv_block));
+  memcpy(iv_block, in, iv_size_);
+  if (EVP_DecryptInit_ex(ctx.get(), cipher_, nullptr /* engine */,
+                         aes_key_.data(), iv_block) != 1) {
+    return util::Status(util::error::INTERNAL,
+                        "could not initialize key or iv");
+  }
+
+  bssl::ScopedHMAC_CTX hmac;
+  if (HMAC_Init_ex(hmac.get(), hmac_key_.data(), hmac_key_.size(),
+                   EVP_sha256(), nullptr) != 1 ||
+      HMAC_Update(hmac.get(),
+                  reinterpret_cast<const uint8_t*>(additional_data.data()),
+                  additional_data.size()) != 1 ||
+      HMAC_Update(hmac.get(), in, iv_size_) != 1) {
+    return HmacFailed();
+  }
+
+  // Each chunk is authenticated and decrypted while it is in the cache;
+  // the plaintext is zeroed below if the tag turns out to be invalid, so
+  // that no unauthenticated plaintext is left in freed memory.
+  size_t plaintext_size = ciphertext.size() - iv_size_ - tag_size_;
+  std::string pt;
+  pt.resize(plaintext_size);
+  const uint8_t* ct_in = in + iv_size_;
+  uint8_t* out = reinterpret_cast<uint8_t*>(&pt[0]);
+  for (size_t offset = 0; offset < plaintext_size; offset += kChunkSize) {
+    size_t chunk_size = std::min(kChunkSize, plaintext_size - offset);
+    if (HMAC_Update(hmac.get(), ct_in + offset, chunk_size) != 1) {
+      util::SafeZeroString(&pt);
+      return HmacFailed();
+    }
+    int len;
+    if (EVP_DecryptUpdate(ctx.get(), out + offset, &len, ct_in + offset,
+                          chunk_size) != 1 ||
+        static_cast<size_t>(len) != chunk_size) {
+      util::SafeZeroString(&pt);
+      static const util::StaticStatus* kDecryptionFailed =
+          new util::StaticStatus(util::error::INTERNAL, "decryption failed");
+      return *kDecryptionFailed;
+    }
+  }
+
+  uint8_t aad_size_in_bits[8];
+  LongToBigEndian(additional_data.size() * 8, aad_size_in_bits);
+  uint8_t tag[EVP_MAX_MD_SIZE];
+  unsigned int tag_len;
+  if (HMAC_Update(hmac.get(), aad_size_in_bits,
+                  sizeof(aad_size_in_bits)) != 1 ||
+      HMAC_Final(hmac.get(), tag, &tag_len) != 1) {
+    util::SafeZeroString(&pt);
+    return HmacFailed();
+  }
+  const uint8_t* expected_tag = ct_in + plaintext_size;
+  uint8_t diff = 0;
+  for (uint32_t i = 0; i < tag_size_; i++) {
+    diff |= tag[i] ^ expected_tag[i];
+  }
+  if (diff != 0) {
+    util::SafeZeroString(&pt);
+    static const util::StaticStatus* kVerificationFailed =
+        new util::StaticStatus(util::error::INVALID_ARGUMENT,
+                               "verification failed");
+    return *kVerificationFailed;
+  }
+  return std::move(pt);
+}
+
+}  // namespace subtle
+}  // namespace tink
+}  // namespace crypto
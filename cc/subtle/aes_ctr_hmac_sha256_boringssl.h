@@ -0,0 +1,90 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_SUBTLE_AES_CTR_HMAC_SHA256_BORINGSSL_H_
+#define TINK_SUBTLE_AES_CTR_HMAC_SHA256_BORINGSSL_H_
+
+#include <memory>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "tink/aead.h"
+#include "tink/util/secret_data.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "openssl/evp.h"
+
+namespace crypto {
+namespace tink {
+namespace subtle {
+
+// AES-CTR followed by HMAC-SHA256, i.e. the same construction and the same
+// ciphertext format as EncryptThenAuthenticate over an AesCtrBoringSsl and an
+// HmacBoringSsl with HashType::SHA256: (iv || ctr ciphertext || tag), with
+// the tag computed over (additional_data || iv || ctr ciphertext || t),
+// where t is the length of additional_data in bits as a 64-bit big-endian
+// integer.  The two primitives are interchangeable for the same keys.
+//
+// Unlike the composition, which encrypts the whole message and then reads
+// the whole ciphertext again to compute the MAC, this class makes a single
+// pass over the message: it encrypts (or decrypts) kChunkSize bytes at a
+// time, and feeds each chunk of ciphertext to HMAC while it is still in the
+// L1 cache.  For messages larger than the cache this roughly halves the
+// memory traffic.  Decrypt releases the plaintext only if the tag is valid.
+class AesCtrHmacSha256BoringSsl : public Aead {
+ public:
+  static crypto::tink::util::StatusOr<std::unique_ptr<Aead>> New(
+      absl::string_view aes_key_value, uint8_t iv_size,
+      absl::string_view hmac_key_value, uint8_t tag_size);
+
+  crypto::tink::util::StatusOr<std::string> Encrypt(
+      absl::string_view plaintext,
+      absl::string_view additional_data) const override;
+
+  crypto::tink::util::StatusOr<std::string> Decrypt(
+      absl::string_view ciphertext,
+      absl::string_view additional_data) const override;
+
+  virtual ~AesCtrHmacSha256BoringSsl() {}
+
+  // The number of bytes that are encrypted before they are passed to HMAC.
+  // The plaintext and the ciphertext of a chunk fit into L1 together.
+  static constexpr size_t kChunkSize = 8192;
+
+ private:
+  static const uint8_t MIN_IV_SIZE_IN_BYTES = 12;
+  static const uint8_t MIN_TAG_SIZE_IN_BYTES = 10;
+  static const uint8_t MIN_HMAC_KEY_SIZE_IN_BYTES = 16;
+  static const uint8_t BLOCK_SIZE = 16;
+
+  AesCtrHmacSha256BoringSsl(absl::string_view aes_key_value,
+                            uint8_t iv_size, const EVP_CIPHER* cipher,
+                            absl::string_view hmac_key_value,
+                            uint8_t tag_size);
+
+  const crypto::tink::util::SecretData aes_key_;
+  uint8_t iv_size_;
+  // cipher_ is a singleton owned by BoringSsl.
+  const EVP_CIPHER* cipher_;
+  const crypto::tink::util::SecretData hmac_key_;
+  uint8_t tag_size_;
+};
+
+}  // namespace subtle
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_SUBTLE_AES_CTR_HMAC_SHA256_BORINGSSL_H_
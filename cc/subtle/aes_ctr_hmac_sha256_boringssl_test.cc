@@ -0,0 +1,184 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/subtle/aes_ctr_hmac_sha256_boringssl.h"
+
+#include <string>
+#include <vector>
+
+#include "tink/aead.h"
+#include "tink/subtle/aes_ctr_boringssl.h"
+#include "tink/subtle/common_enums.h"
+#include "tink/subtle/encrypt_then_authenticate.h"
+#include "tink/subtle/hmac_boringssl.h"
+#include "tink/subtle/random.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "tink/util/test_util.h"
+#include "gtest/gtest.h"
+
+namespace crypto {
+namespace tink {
+namespace subtle {
+namespace {
+
+const int kIvSize = 16;
+const int kTagSize = 16;
+
+// The composition that AesCtrHmacSha256BoringSsl replaces.
+std::unique_ptr<Aead> NewEncryptThenAuthenticate(const std::string& aes_key,
+                                                 const std::string& hmac_key) {
+  auto cipher = AesCtrBoringSsl::New(aes_key, kIvSize);
+  EXPECT_TRUE(cipher.ok()) << cipher.status();
+  auto mac = HmacBoringSsl::New(HashType::SHA256, kTagSize, hmac_key);
+  EXPECT_TRUE(mac.ok()) << mac.status();
+  auto aead = EncryptThenAuthenticate::New(std::move(cipher.ValueOrDie()),
+                                           std::move(mac.ValueOrDie()),
+                                           kTagSize);
+  EXPECT_TRUE(aead.ok()) << aead.status();
+  return std::move(aead.ValueOrDie());
+}
+
+class AesCtrHmacSha256BoringSslTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    aes_key_ = Random::GetRandomBytes(32);
+    hmac_key_ = Random::GetRandomBytes(32);
+    auto aead = AesCtrHmacSha256BoringSsl::New(aes_key_, kIvSize, hmac_key_,
+                                               kTagSize);
+    ASSERT_TRUE(aead.ok()) << aead.status();
+    fused_ = std::move(aead.ValueOrDie());
+    composed_ = NewEncryptThenAuthenticate(aes_key_, hmac_key_);
+  }
+
+  // Sizes around the chunk boundaries.
+  std::vector<size_t> MessageSizes() {
+    const size_t chunk = AesCtrHmacSha256BoringSsl::kChunkSize;
+    return {0, 1, 15, 16, 17, chunk - 1, chunk, chunk + 1, 3 * chunk + 7};
+  }
+
+  std::string aes_key_;
+  std::string hmac_key_;
+  std::unique_ptr<Aead> fused_;
+  std::unique_ptr<Aead> composed_;
+};
+
+TEST_F(AesCtrHmacSha256BoringSslTest, EncryptDecrypt) {
+  std::string aad = "Some data to authenticate.";
+  for (size_t size : MessageSizes()) {
+    std::string message = Random::GetRandomBytes(size);
+    auto ct = fused_->Encrypt(message, aad);
+    ASSERT_TRUE(ct.ok()) << ct.status();
+    EXPECT_EQ(size + kIvSize + kTagSize, ct.ValueOrDie().size());
+    auto pt = fused_->Decrypt(ct.ValueOrDie(), aad);
+    ASSERT_TRUE(pt.ok()) << pt.status();
+    EXPECT_EQ(message, pt.ValueOrDie());
+  }
+}
+
+TEST_F(AesCtrHmacSha256BoringSslTest, InteroperatesWithEncryptThenAuthenticate) {
+  for (size_t size : MessageSizes()) {
+    std::string message = Random::GetRandomBytes(size);
+    std::string aad = Random::GetRandomBytes(size % 100);
+    auto fused_ct = fused_->Encrypt(message, aad);
+    ASSERT_TRUE(fused_ct.ok()) << fused_ct.status();
+    auto composed_pt = composed_->Decrypt(fused_ct.ValueOrDie(), aad);
+    ASSERT_TRUE(composed_pt.ok()) << composed_pt.status();
+    EXPECT_EQ(message, composed_pt.ValueOrDie());
+
+    auto composed_ct = composed_->Encrypt(message, aad);
+    ASSERT_TRUE(composed_ct.ok()) << composed_ct.status();
+    auto fused_pt = fused_->Decrypt(composed_ct.ValueOrDie(), aad);
+    ASSERT_TRUE(fused_pt.ok()) << fused_pt.status();
+    EXPECT_EQ(message, fused_pt.ValueOrDie());
+  }
+}
+
+TEST_F(AesCtrHmacSha256BoringSslTest, RfcVector) {
+  // The SHA256 vector of encrypt_then_authenticate_test.cc: the RFC uses
+  // CBC, so only the tag can be checked.
+  auto aead = AesCtrHmacSha256BoringSsl::New(
+      test::HexDecodeOrDie("101112131415161718191a1b1c1d1e1f"), 16,
+      test::HexDecodeOrDie("000102030405060708090a0b0c0d0e0f"), 16);
+  ASSERT_TRUE(aead.ok()) << aead.status();
+  std::string ct = test::HexDecodeOrDie(
+      "1af38c2dc2b96ffdd86694092341bc04"
+      "c80edfa32ddf39d5ef00c0b468834279"
+      "a2e46a1b8049f792f76bfe54b903a9c9"
+      "a94ac9b47ad2655c5f10f9aef71427e2"
+      "fc6f9b3f399a221489f16362c7032336"
+      "09d45ac69864e3321cf82935ac4096c8"
+      "6e133314c54019e8ca7980dfa4b9cf1b"
+      "384c486f3a54c51078158ee5d79de59f"
+      "bd34d848b3d69550a67646344427ade5"
+      "4b8851ffb598f7f80074b9473c82e2db"
+      "652c3fa36b0a7c5b3219fab3a30bc1c4");
+  std::string aad = test::HexDecodeOrDie(
+      "546865207365636f6e64207072696e63"
+      "69706c65206f66204175677573746520"
+      "4b6572636b686f666673");
+  auto pt = aead.ValueOrDie()->Decrypt(ct, aad);
+  EXPECT_TRUE(pt.ok()) << pt.status();
+}
+
+TEST_F(AesCtrHmacSha256BoringSslTest, ModifiedCiphertext) {
+  std::string message = Random::GetRandomBytes(
+      AesCtrHmacSha256BoringSsl::kChunkSize + 5);
+  std::string aad = "aad";
+  auto ct = fused_->Encrypt(message, aad);
+  ASSERT_TRUE(ct.ok()) << ct.status();
+  std::string ciphertext = ct.ValueOrDie();
+  for (size_t i = 0; i < ciphertext.size(); i += 97) {
+    std::string modified = ciphertext;
+    modified[i] ^= 1;
+    EXPECT_FALSE(fused_->Decrypt(modified, aad).ok()) << "byte " << i;
+  }
+  EXPECT_FALSE(fused_->Decrypt(ciphertext, "aae").ok());
+  EXPECT_FALSE(
+      fused_->Decrypt(ciphertext.substr(0, ciphertext.size() - 1), aad).ok());
+  EXPECT_FALSE(fused_->Decrypt(ciphertext.substr(0, kIvSize + kTagSize - 1),
+                               aad).ok());
+}
+
+TEST_F(AesCtrHmacSha256BoringSslTest, InvalidParameters) {
+  std::string aes_key = Random::GetRandomBytes(16);
+  std::string hmac_key = Random::GetRandomBytes(16);
+  EXPECT_TRUE(
+      AesCtrHmacSha256BoringSsl::New(aes_key, 12, hmac_key, 10).ok());
+  EXPECT_TRUE(
+      AesCtrHmacSha256BoringSsl::New(aes_key, 16, hmac_key, 32).ok());
+  // AES key size.
+  EXPECT_FALSE(AesCtrHmacSha256BoringSsl::New(Random::GetRandomBytes(24), 16,
+                                              hmac_key, 16).ok());
+  // IV size.
+  EXPECT_FALSE(
+      AesCtrHmacSha256BoringSsl::New(aes_key, 11, hmac_key, 16).ok());
+  EXPECT_FALSE(
+      AesCtrHmacSha256BoringSsl::New(aes_key, 17, hmac_key, 16).ok());
+  // HMAC key size.
+  EXPECT_FALSE(AesCtrHmacSha256BoringSsl::New(
+                   aes_key, 16, Random::GetRandomBytes(15), 16).ok());
+  // Tag size.
+  EXPECT_FALSE(
+      AesCtrHmacSha256BoringSsl::New(aes_key, 16, hmac_key, 9).ok());
+  EXPECT_FALSE(
+      AesCtrHmacSha256BoringSsl::New(aes_key, 16, hmac_key, 33).ok());
+}
+
+}  // namespace
+}  // namespace subtle
+}  // namespace tink
+}  // namespace crypto
@@ -550,7 +550,9 @@ crypto::tink::util::StatusOr<std::string> AesEaxAesni::Decrypt(
 
   size_t ct_size = ciphertext.size();
   if (ct_size < nonce_size_ + TAG_SIZE) {
-    return util::Status(util::error::INTERNAL, "Ciphertext too short");
+    static const util::StaticStatus* kCiphertextTooShort =
+        new util::StaticStatus(util::error::INTERNAL, "Ciphertext too short");
+    return *kCiphertextTooShort;
   }
   size_t out_size = ct_size - TAG_SIZE - nonce_size_;
   absl::string_view nonce = ciphertext.substr(0, nonce_size_);
@@ -560,7 +562,9 @@ crypto::tink::util::StatusOr<std::string> AesEaxAesni::Decrypt(
   bool result = RawDecrypt(nonce, encrypted, additional_data,
                            reinterpret_cast<uint8_t*>(&res[0]), out_size);
   if (!result) {
-    return util::Status(util::error::INTERNAL, "Decryption failed");
+    static const util::StaticStatus* kDecryptionFailed =
+        new util::StaticStatus(util::error::INTERNAL, "Decryption failed");
+    return *kDecryptionFailed;
   } else {
     return std::move(res);
   }
@@ -17,9 +17,10 @@
 #include "tink/subtle/aes_eax_boringssl.h"
 
 #include <string>
-#include <vector>
 #include <memory>
+#include <utility>
 
+#include "absl/types/span.h"
 #include "openssl/err.h"
 #include "openssl/evp.h"
 #include "tink/aead.h"
@@ -235,9 +236,10 @@ crypto::tink::util::StatusOr<std::string> AesEaxBoringSsl::Encrypt(
 
   size_t ciphertext_size = plaintext.size() + nonce_size_ + TAG_SIZE;
   std::string ciphertext(ciphertext_size, '\0');
+  // The nonce is written directly in front of the ciphertext.
+  Random::GetRandomBytes(absl::MakeSpan(&ciphertext[0], nonce_size_));
   uint8_t N[BLOCK_SIZE];
-  const std::string nonce = Random::GetRandomBytes(nonce_size_);
-  Omac(nonce, 0, N);
+  Omac(absl::string_view(ciphertext.data(), nonce_size_), 0, N);
   uint8_t H[BLOCK_SIZE];
   Omac(additional_data, 1, H);
   uint8_t* ct_start = reinterpret_cast<uint8_t*>(&ciphertext[nonce_size_]);
@@ -247,7 +249,6 @@ crypto::tink::util::StatusOr<std::string> AesEaxBoringSsl::Encrypt(
   Omac(ct_start, plaintext.size(), 2, mac);
   XorBlock(mac, N, mac);
   XorBlock(mac, H, mac);
-  memmove(&ciphertext[0], nonce.data(), nonce_size_);
   memmove(&ciphertext[ciphertext_size - TAG_SIZE], mac, TAG_SIZE);
   return std::move(ciphertext);
 }
@@ -261,7 +262,9 @@ crypto::tink::util::StatusOr<std::string> AesEaxBoringSsl::Decrypt(
 
   size_t ct_size = ciphertext.size();
   if (ct_size < nonce_size_ + TAG_SIZE) {
-    return util::Status(util::error::INTERNAL, "Ciphertext too short");
+    static const util::StaticStatus* kCiphertextTooShort =
+        new util::StaticStatus(util::error::INTERNAL, "Ciphertext too short");
+    return *kCiphertextTooShort;
   }
   size_t out_size = ct_size - TAG_SIZE - nonce_size_;
   absl::string_view nonce = ciphertext.substr(0, nonce_size_);
@@ -277,7 +280,9 @@ crypto::tink::util::StatusOr<std::string> AesEaxBoringSsl::Decrypt(
   XorBlock(mac, H, mac);
   const uint8_t *sig = reinterpret_cast<const uint8_t*>(tag.data());
   if (!EqualBlocks(mac, sig)) {
-    return util::Status(util::error::INTERNAL, "Tag mismatch");
+    static const util::StaticStatus* kTagMismatch =
+        new util::StaticStatus(util::error::INTERNAL, "Tag mismatch");
+    return *kTagMismatch;
   }
   std::string res(out_size, '\0');
   CtrCrypt(N, reinterpret_cast<const uint8_t*>(encrypted.data()),
@@ -17,9 +17,11 @@
 #include "tink/subtle/aes_gcm_boringssl.h"
 
 #include <string>
-#include <vector>
+#include <utility>
 
+#include "absl/types/span.h"
 #include "tink/aead.h"
+#include "tink/subtle/buffer_pool.h"
 #include "tink/subtle/random.h"
 #include "tink/util/errors.h"
 #include "tink/util/status.h"
@@ -67,36 +69,35 @@ util::StatusOr<std::unique_ptr<Aead>> AesGcmBoringSsl::New(
   return util::StatusOr<std::unique_ptr<Aead>>(std::move(aead));
 }
 
-util::StatusOr<std::string> AesGcmBoringSsl::Encrypt(
-    absl::string_view plaintext, absl::string_view additional_data) const {
-  const std::string iv = Random::GetRandomBytes(IV_SIZE_IN_BYTES);
-  // TODO(bleichen): Check if it is OK to work on a std::string.
-  //   This is unclear since some compiler may use copy-on-write.
-  std::vector<uint8_t> ct(iv.size() + plaintext.size() + TAG_SIZE_IN_BYTES);
-  memcpy(ct.data(), iv.data(), iv.size());
+util::Status AesGcmBoringSsl::Seal(absl::string_view plaintext,
+                                   absl::string_view additional_data,
+                                   uint8_t* out) const {
+  // The IV is written directly in front of the ciphertext.
+  Random::GetRandomBytes(
+      absl::MakeSpan(reinterpret_cast<char*>(out), IV_SIZE_IN_BYTES));
   size_t len;
   if (EVP_AEAD_CTX_seal(
-          ctx_.get(), ct.data() + iv.size(), &len, ct.size() - iv.size(),
-          reinterpret_cast<const uint8_t*>(iv.data()), iv.size(),
+          ctx_.get(), out + IV_SIZE_IN_BYTES, &len,
+          plaintext.size() + TAG_SIZE_IN_BYTES, out, IV_SIZE_IN_BYTES,
           reinterpret_cast<const uint8_t*>(plaintext.data()), plaintext.size(),
           reinterpret_cast<const uint8_t*>(additional_data.data()),
           additional_data.size()) != 1) {
     return util::Status(util::error::INTERNAL, "Encryption failed");
   }
-  return std::string(reinterpret_cast<const char*>(ct.data()), iv.size() + len);
-}
-
-util::StatusOr<std::string> AesGcmBoringSsl::Decrypt(
-    absl::string_view ciphertext, absl::string_view additional_data) const {
-  if (ciphertext.size() < IV_SIZE_IN_BYTES + TAG_SIZE_IN_BYTES) {
-    return util::Status(util::error::INTERNAL, "Ciphertext too short");
+  if (len != plaintext.size() + TAG_SIZE_IN_BYTES) {
+    return util::Status(util::error::INTERNAL, "Incorrect ciphertext size");
   }
+  return util::OkStatus();
+}
 
-  std::vector<uint8_t> pt(ciphertext.size() - IV_SIZE_IN_BYTES -
-                          TAG_SIZE_IN_BYTES);
+util::Status AesGcmBoringSsl::Open(absl::string_view ciphertext,
+                                   absl::string_view additional_data,
+                                   uint8_t* out) const {
+  size_t plaintext_size =
+      ciphertext.size() - IV_SIZE_IN_BYTES - TAG_SIZE_IN_BYTES;
   size_t len;
   if (EVP_AEAD_CTX_open(
-          ctx_.get(), pt.data(), &len, pt.size(),
+          ctx_.get(), out, &len, plaintext_size,
           // The nonce is the first |IV_SIZE_IN_BYTES| bytes of |ciphertext|.
           reinterpret_cast<const uint8_t*>(ciphertext.data()), IV_SIZE_IN_BYTES,
           // The input is the remainder.
@@ -105,9 +106,72 @@ util::StatusOr<std::string> AesGcmBoringSsl::Decrypt(
           ciphertext.size() - IV_SIZE_IN_BYTES,
           reinterpret_cast<const uint8_t*>(additional_data.data()),
           additional_data.size()) != 1) {
-    return util::Status(util::error::INTERNAL, "Authentication failed");
+    static const util::StaticStatus* kAuthenticationFailed =
+        new util::StaticStatus(util::error::INTERNAL, "Authentication failed");
+    return *kAuthenticationFailed;
+  }
+  if (len != plaintext_size) {
+    return util::Status(util::error::INTERNAL, "Incorrect plaintext size");
+  }
+  return util::OkStatus();
+}
+
+util::StatusOr<std::string> AesGcmBoringSsl::Encrypt(
+    absl::string_view plaintext, absl::string_view additional_data) const {
+  // The ciphertext is written directly into the result, which is the only
+  // allocation per message.
+  std::string ciphertext;
+  ciphertext.resize(IV_SIZE_IN_BYTES + plaintext.size() + TAG_SIZE_IN_BYTES);
+  auto status = Seal(plaintext, additional_data,
+                     reinterpret_cast<uint8_t*>(&ciphertext[0]));
+  if (!status.ok()) return status;
+  return std::move(ciphertext);
+}
+
+util::StatusOr<std::string> AesGcmBoringSsl::Decrypt(
+    absl::string_view ciphertext, absl::string_view additional_data) const {
+  if (ciphertext.size() < IV_SIZE_IN_BYTES + TAG_SIZE_IN_BYTES) {
+    static const util::StaticStatus* kCiphertextTooShort =
+        new util::StaticStatus(util::error::INTERNAL, "Ciphertext too short");
+    return *kCiphertextTooShort;
+  }
+  // The extra byte keeps the output pointer valid for empty plaintexts.
+  size_t plaintext_size =
+      ciphertext.size() - IV_SIZE_IN_BYTES - TAG_SIZE_IN_BYTES;
+  std::string plaintext;
+  plaintext.resize(plaintext_size + 1);
+  auto status = Open(ciphertext, additional_data,
+                     reinterpret_cast<uint8_t*>(&plaintext[0]));
+  if (!status.ok()) return status;
+  plaintext.resize(plaintext_size);
+  return std::move(plaintext);
+}
+
+util::StatusOr<PooledBuffer> AesGcmBoringSsl::EncryptToBuffer(
+    absl::string_view plaintext, absl::string_view additional_data,
+    BufferPool* pool) const {
+  PooledBuffer ciphertext =
+      pool->Get(IV_SIZE_IN_BYTES + plaintext.size() + TAG_SIZE_IN_BYTES);
+  auto status = Seal(plaintext, additional_data, ciphertext.data());
+  if (!status.ok()) return status;
+  return std::move(ciphertext);
+}
+
+util::StatusOr<PooledBuffer> AesGcmBoringSsl::DecryptToBuffer(
+    absl::string_view ciphertext, absl::string_view additional_data,
+    BufferPool* pool) const {
+  if (ciphertext.size() < IV_SIZE_IN_BYTES + TAG_SIZE_IN_BYTES) {
+    static const util::StaticStatus* kCiphertextTooShort =
+        new util::StaticStatus(util::error::INTERNAL, "Ciphertext too short");
+    return *kCiphertextTooShort;
   }
-  return std::string(reinterpret_cast<const char*>(pt.data()), len);
+  // Pooled buffers are never smaller than 2^BufferPool::kMinSizeClass
+  // bytes, so data() is valid even for empty plaintexts.
+  PooledBuffer plaintext =
+      pool->Get(ciphertext.size() - IV_SIZE_IN_BYTES - TAG_SIZE_IN_BYTES);
+  auto status = Open(ciphertext, additional_data, plaintext.data());
+  if (!status.ok()) return status;
+  return std::move(plaintext);
 }
 
 }  // namespace subtle
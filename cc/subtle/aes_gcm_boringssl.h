@@ -21,6 +21,8 @@
 
 #include "absl/strings/string_view.h"
 #include "tink/aead.h"
+#include "tink/subtle/buffer_pool.h"
+#include "tink/subtle/pooled_aead.h"
 #include "tink/util/status.h"
 #include "tink/util/statusor.h"
 #include "openssl/aead.h"
@@ -29,7 +31,7 @@ namespace crypto {
 namespace tink {
 namespace subtle {
 
-class AesGcmBoringSsl : public Aead {
+class AesGcmBoringSsl : public Aead, public PooledAead {
  public:
   static crypto::tink::util::StatusOr<std::unique_ptr<Aead>> New(
       absl::string_view key_value);
@@ -42,6 +44,14 @@ class AesGcmBoringSsl : public Aead {
       absl::string_view ciphertext,
       absl::string_view additional_data) const override;
 
+  crypto::tink::util::StatusOr<PooledBuffer> EncryptToBuffer(
+      absl::string_view plaintext, absl::string_view additional_data,
+      BufferPool* pool) const override;
+
+  crypto::tink::util::StatusOr<PooledBuffer> DecryptToBuffer(
+      absl::string_view ciphertext, absl::string_view additional_data,
+      BufferPool* pool) const override;
+
   virtual ~AesGcmBoringSsl() {}
 
  private:
@@ -51,6 +61,18 @@ class AesGcmBoringSsl : public Aead {
   AesGcmBoringSsl() {}
   crypto::tink::util::Status Init(absl::string_view key_value);
 
+  // Encrypts into 'out', which must have room for IV_SIZE_IN_BYTES +
+  // plaintext.size() + TAG_SIZE_IN_BYTES bytes.
+  crypto::tink::util::Status Seal(absl::string_view plaintext,
+                                  absl::string_view additional_data,
+                                  uint8_t* out) const;
+  // Decrypts 'ciphertext', which must be at least IV_SIZE_IN_BYTES +
+  // TAG_SIZE_IN_BYTES bytes long, into 'out', which must have room for the
+  // remaining ciphertext.size() - IV_SIZE_IN_BYTES - TAG_SIZE_IN_BYTES bytes.
+  crypto::tink::util::Status Open(absl::string_view ciphertext,
+                                  absl::string_view additional_data,
+                                  uint8_t* out) const;
+
   bssl::ScopedEVP_AEAD_CTX ctx_;
 };
 
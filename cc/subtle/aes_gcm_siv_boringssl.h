@@ -22,6 +22,8 @@
 #include "absl/strings/string_view.h"
 #include "openssl/aead.h"
 #include "tink/aead.h"
+#include "tink/subtle/buffer_pool.h"
+#include "tink/subtle/pooled_aead.h"
 #include "tink/util/status.h"
 #include "tink/util/statusor.h"
 
@@ -46,7 +48,7 @@ namespace subtle {
 // https://cyber.biu.ac.il/aes-gcm-siv/
 // or Section 6.3 of this paper:
 // https://eprint.iacr.org/2017/702.pdf
-class AesGcmSivBoringSsl : public Aead {
+class AesGcmSivBoringSsl : public Aead, public PooledAead {
  public:
   static crypto::tink::util::StatusOr<std::unique_ptr<Aead>> New(
       absl::string_view key_value);
@@ -59,6 +61,14 @@ class AesGcmSivBoringSsl : public Aead {
       absl::string_view ciphertext,
       absl::string_view additional_data) const override;
 
+  crypto::tink::util::StatusOr<PooledBuffer> EncryptToBuffer(
+      absl::string_view plaintext, absl::string_view additional_data,
+      BufferPool* pool) const override;
+
+  crypto::tink::util::StatusOr<PooledBuffer> DecryptToBuffer(
+      absl::string_view ciphertext, absl::string_view additional_data,
+      BufferPool* pool) const override;
+
   ~AesGcmSivBoringSsl() override {}
 
  private:
@@ -68,6 +78,18 @@ class AesGcmSivBoringSsl : public Aead {
   AesGcmSivBoringSsl() {}
   crypto::tink::util::Status Init(absl::string_view key_value);
 
+  // Encrypts into 'out', which must have room for IV_SIZE_IN_BYTES +
+  // plaintext.size() + TAG_SIZE_IN_BYTES bytes.
+  crypto::tink::util::Status Seal(absl::string_view plaintext,
+                                  absl::string_view additional_data,
+                                  uint8_t* out) const;
+  // Decrypts 'ciphertext', which must be at least IV_SIZE_IN_BYTES +
+  // TAG_SIZE_IN_BYTES bytes long, into 'out', which must have room for the
+  // remaining ciphertext.size() - IV_SIZE_IN_BYTES - TAG_SIZE_IN_BYTES bytes.
+  crypto::tink::util::Status Open(absl::string_view ciphertext,
+                                  absl::string_view additional_data,
+                                  uint8_t* out) const;
+
   bssl::ScopedEVP_AEAD_CTX ctx_;
 };
 
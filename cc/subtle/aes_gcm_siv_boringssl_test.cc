@@ -23,6 +23,8 @@
 #include "absl/strings/str_cat.h"
 #include "openssl/err.h"
 #include "include/rapidjson/document.h"
+#include "tink/subtle/buffer_pool.h"
+#include "tink/subtle/pooled_aead.h"
 #include "tink/subtle/wycheproof_util.h"
 #include "tink/util/status.h"
 #include "tink/util/statusor.h"
@@ -52,6 +54,34 @@ TEST(AesGcmSivBoringSslTest, Basic) {
   EXPECT_EQ(pt.ValueOrDie(), message);
 }
 
+TEST(AesGcmSivBoringSslTest, PooledBuffers) {
+  std::string key(test::HexDecodeOrDie("000102030405060708090a0b0c0d0e0f"));
+  auto cipher = std::move(AesGcmSivBoringSsl::New(key).ValueOrDie());
+  auto pooled = dynamic_cast<const PooledAead*>(cipher.get());
+  ASSERT_NE(nullptr, pooled);
+  BufferPool pool(BufferPool::kDefaultMaxBuffersPerClass);
+  std::string aad = "Some data to authenticate.";
+  for (const std::string& message : {std::string(""),
+                                     std::string("Some data to encrypt.")}) {
+    auto ct = pooled->EncryptToBuffer(message, aad, &pool);
+    ASSERT_TRUE(ct.ok()) << ct.status();
+    EXPECT_EQ(message.size() + 28, ct.ValueOrDie().size());
+    // The outputs of both interfaces are interchangeable.
+    auto pt = cipher->Decrypt(ct.ValueOrDie().AsStringView(), aad);
+    ASSERT_TRUE(pt.ok()) << pt.status();
+    EXPECT_EQ(message, pt.ValueOrDie());
+    auto pooled_pt = pooled->DecryptToBuffer(
+        cipher->Encrypt(message, aad).ValueOrDie(), aad, &pool);
+    ASSERT_TRUE(pooled_pt.ok()) << pooled_pt.status();
+    EXPECT_EQ(message, pooled_pt.ValueOrDie().AsStringView());
+
+    std::string modified(ct.ValueOrDie().AsStringView());
+    modified[modified.size() - 1] ^= 1;
+    EXPECT_FALSE(pooled->DecryptToBuffer(modified, aad, &pool).ok());
+  }
+  EXPECT_FALSE(pooled->DecryptToBuffer("too short", aad, &pool).ok());
+}
+
 TEST(AesGcmSivBoringSslTest, Sizes) {
   std::string key(test::HexDecodeOrDie("000102030405060708090a0b0c0d0e0f"));
   auto res = AesGcmSivBoringSsl::New(key);
@@ -0,0 +1,161 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/subtle/aes_gcm_stream_segment_decrypter.h"
+
+#include <utility>
+
+#include "absl/types/span.h"
+#include "tink/subtle/aes_gcm_stream_segment_encrypter.h"
+#include "tink/subtle/stream_segment_decrypter.h"
+#include "tink/util/secret_data.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "openssl/aead.h"
+
+namespace crypto {
+namespace tink {
+namespace subtle {
+
+namespace {
+
+const int kTagSizeInBytes = AesGcmStreamSegmentEncrypter::kTagSizeInBytes;
+const int kNonceSizeInBytes = AesGcmStreamSegmentEncrypter::kNonceSizeInBytes;
+
+const EVP_AEAD* GetAeadForKeySize(uint32_t size_in_bytes) {
+  switch (size_in_bytes) {
+    case 16:
+      return EVP_aead_aes_128_gcm();
+    case 32:
+      return EVP_aead_aes_256_gcm();
+    default:
+      return nullptr;
+  }
+}
+
+}  // namespace
+
+// static
+util::StatusOr<std::unique_ptr<StreamSegmentDecrypter>>
+AesGcmStreamSegmentDecrypter::New(int header_size,
+                                  int ciphertext_segment_size,
+                                  KeyFromHeader key_from_header) {
+  if (header_size <= 0) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+                        "header_size must be positive");
+  }
+  if (ciphertext_segment_size <= header_size + kTagSizeInBytes) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+                        "ciphertext_segment_size too small");
+  }
+  if (key_from_header == nullptr) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+                        "key_from_header must be non-null");
+  }
+  std::unique_ptr<StreamSegmentDecrypter> decrypter(
+      new AesGcmStreamSegmentDecrypter(header_size, ciphertext_segment_size,
+                                       std::move(key_from_header)));
+  return std::move(decrypter);
+}
+
+util::Status AesGcmStreamSegmentDecrypter::Init(
+    const std::vector<uint8_t>& header) {
+  if (initialized_) {
+    return util::Status(util::error::FAILED_PRECONDITION,
+                        "decrypter already initialized");
+  }
+  if (header.size() != header_size_) {
+    return util::Status(util::error::INVALID_ARGUMENT, "wrong header size");
+  }
+  auto key_result = key_from_header_(header);
+  if (!key_result.ok()) return key_result.status();
+  const util::SecretData& key = key_result.ValueOrDie();
+  const EVP_AEAD* aead = GetAeadForKeySize(key.size());
+  if (aead == nullptr) {
+    return util::Status(util::error::INTERNAL, "invalid key size");
+  }
+  if (EVP_AEAD_CTX_init(ctx_.get(), aead, key.data(), key.size(),
+                        EVP_AEAD_DEFAULT_TAG_LENGTH, nullptr) != 1) {
+    return util::Status(util::error::INTERNAL,
+                        "could not initialize EVP_AEAD_CTX");
+  }
+  initialized_ = true;
+  return util::Status::OK;
+}
+
+util::Status AesGcmStreamSegmentDecrypter::DecryptSegment(
+    const std::vector<uint8_t>& ciphertext,
+    int64_t segment_number,
+    bool is_last_segment,
+    std::vector<uint8_t>* plaintext_buffer) {
+  if (ciphertext.size() < kTagSizeInBytes) {
+    return util::Status(util::error::INVALID_ARGUMENT, "segment too short");
+  }
+  // The extra byte keeps the output pointer valid for empty segments.
+  plaintext_buffer->resize(ciphertext.size() - kTagSizeInBytes + 1);
+  auto status = DecryptSegmentAt(
+      ciphertext, segment_number, is_last_segment,
+      absl::MakeSpan(plaintext_buffer->data(),
+                     ciphertext.size() - kTagSizeInBytes));
+  if (!status.ok()) return status;
+  plaintext_buffer->resize(ciphertext.size() - kTagSizeInBytes);
+  return util::Status::OK;
+}
+
+util::Status AesGcmStreamSegmentDecrypter::DecryptSegmentAt(
+    absl::Span<const uint8_t> ciphertext,
+    int64_t segment_number,
+    bool is_last_segment,
+    absl::Span<uint8_t> plaintext) const {
+  if (!initialized_) {
+    return util::Status(util::error::FAILED_PRECONDITION,
+                        "decrypter not initialized");
+  }
+  int max_ciphertext_size = ciphertext_segment_size_;
+  if (segment_number == 0) max_ciphertext_size -= get_ciphertext_offset();
+  if (ciphertext.size() > max_ciphertext_size) {
+    return util::Status(util::error::INVALID_ARGUMENT, "segment too long");
+  }
+  if (ciphertext.size() < kTagSizeInBytes) {
+    return util::Status(util::error::INVALID_ARGUMENT, "segment too short");
+  }
+  if (plaintext.size() != ciphertext.size() - kTagSizeInBytes) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+                        "wrong plaintext size");
+  }
+  uint8_t nonce[kNonceSizeInBytes];
+  auto status = AesGcmStreamSegmentEncrypter::ComputeNonce(
+      segment_number, is_last_segment, nonce);
+  if (!status.ok()) return status;
+  size_t len;
+  if (EVP_AEAD_CTX_open(ctx_.get(), plaintext.data(), &len, plaintext.size(),
+                        nonce, kNonceSizeInBytes, ciphertext.data(),
+                        ciphertext.size(), nullptr, 0) != 1) {
+    static const util::StaticStatus* kAuthenticationFailed =
+        new util::StaticStatus(util::error::INVALID_ARGUMENT,
+                               "Authentication failed");
+    return *kAuthenticationFailed;
+  }
+  return util::Status::OK;
+}
+
+int AesGcmStreamSegmentDecrypter::get_plaintext_segment_size() const {
+  return ciphertext_segment_size_ - kTagSizeInBytes;
+}
+
+}  // namespace subtle
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,102 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_SUBTLE_AES_GCM_STREAM_SEGMENT_DECRYPTER_H_
+#define TINK_SUBTLE_AES_GCM_STREAM_SEGMENT_DECRYPTER_H_
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "tink/subtle/stream_segment_decrypter.h"
+#include "tink/util/secret_data.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "openssl/aead.h"
+
+namespace crypto {
+namespace tink {
+namespace subtle {
+
+// The StreamSegmentDecrypter for streams encrypted by
+// AesGcmStreamSegmentEncrypter.  The key of the stream is recovered from
+// the stream header by a caller-provided function, e.g. a KEM decapsulation.
+class AesGcmStreamSegmentDecrypter : public StreamSegmentDecrypter {
+ public:
+  // Returns the 16- or 32-byte AES-GCM key of the stream with the given
+  // header.
+  using KeyFromHeader = std::function<util::StatusOr<util::SecretData>(
+      const std::vector<uint8_t>& header)>;
+
+  // Returns a decrypter for one stream, whose header has 'header_size'
+  // bytes and whose ciphertext segments have 'ciphertext_segment_size'
+  // bytes.
+  static util::StatusOr<std::unique_ptr<StreamSegmentDecrypter>> New(
+      int header_size, int ciphertext_segment_size,
+      KeyFromHeader key_from_header);
+
+  // -----------------------
+  // Methods of StreamSegmentDecrypter-interface implemented by this class.
+  util::Status Init(const std::vector<uint8_t>& header) override;
+
+  util::Status DecryptSegment(
+      const std::vector<uint8_t>& ciphertext,
+      int64_t segment_number,
+      bool is_last_segment,
+      std::vector<uint8_t>* plaintext_buffer) override;
+
+  // Safe to call concurrently: the AES-GCM context is only read.
+  util::Status DecryptSegmentAt(
+      absl::Span<const uint8_t> ciphertext,
+      int64_t segment_number,
+      bool is_last_segment,
+      absl::Span<uint8_t> plaintext) const override;
+
+  int get_header_size() const override {
+    return header_size_;
+  }
+
+  int get_plaintext_segment_size() const override;
+
+  int get_ciphertext_segment_size() const override {
+    return ciphertext_segment_size_;
+  }
+
+  int get_ciphertext_offset() const override {
+    return header_size_;
+  }
+
+ private:
+  AesGcmStreamSegmentDecrypter(int header_size, int ciphertext_segment_size,
+                               KeyFromHeader key_from_header)
+      : header_size_(header_size),
+        ciphertext_segment_size_(ciphertext_segment_size),
+        key_from_header_(std::move(key_from_header)),
+        initialized_(false) {}
+
+  bssl::ScopedEVP_AEAD_CTX ctx_;
+  const int header_size_;
+  const int ciphertext_segment_size_;
+  const KeyFromHeader key_from_header_;
+  bool initialized_;
+};
+
+}  // namespace subtle
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_SUBTLE_AES_GCM_STREAM_SEGMENT_DECRYPTER_H_
@@ -0,0 +1,188 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/subtle/aes_gcm_stream_segment_decrypter.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/types/span.h"
+#include "tink/subtle/aes_gcm_stream_segment_encrypter.h"
+#include "tink/subtle/random.h"
+#include "tink/util/secret_data.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+namespace subtle {
+namespace {
+
+const int kHeaderSize = 65;
+const int kSegmentSize = 256;
+
+std::vector<uint8_t> GetBytes(int size) {
+  std::string bytes = Random::GetRandomBytes(size);
+  return std::vector<uint8_t>(bytes.begin(), bytes.end());
+}
+
+// Returns a KeyFromHeader that returns 'key' for 'header', and fails
+// for any other header.
+AesGcmStreamSegmentDecrypter::KeyFromHeader FixedKey(
+    const util::SecretData& key, const std::vector<uint8_t>& header) {
+  return [key, header](const std::vector<uint8_t>& actual_header)
+      -> util::StatusOr<util::SecretData> {
+    if (actual_header != header) {
+      return util::Status(util::error::INVALID_ARGUMENT, "unknown header");
+    }
+    return key;
+  };
+}
+
+class AesGcmStreamSegmentDecrypterTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    key_ = util::SecretDataFromStringView(Random::GetRandomBytes(16));
+    header_ = GetBytes(kHeaderSize);
+    auto encrypter = std::move(
+        AesGcmStreamSegmentEncrypter::New(key_, header_, kSegmentSize)
+        .ValueOrDie());
+    // Three segments, the last one shorter.
+    plaintexts_ = {GetBytes(kSegmentSize - 16 - kHeaderSize),
+                   GetBytes(kSegmentSize - 16), GetBytes(17)};
+    for (int i = 0; i < plaintexts_.size(); i++) {
+      std::vector<uint8_t> ciphertext;
+      ASSERT_TRUE(encrypter->EncryptSegment(
+          plaintexts_[i], i == plaintexts_.size() - 1, &ciphertext).ok());
+      ciphertexts_.push_back(ciphertext);
+    }
+  }
+
+  std::unique_ptr<StreamSegmentDecrypter> GetDecrypter() {
+    return std::move(AesGcmStreamSegmentDecrypter::New(
+        kHeaderSize, kSegmentSize, FixedKey(key_, header_)).ValueOrDie());
+  }
+
+  util::SecretData key_;
+  std::vector<uint8_t> header_;
+  std::vector<std::vector<uint8_t>> plaintexts_;
+  std::vector<std::vector<uint8_t>> ciphertexts_;
+};
+
+TEST_F(AesGcmStreamSegmentDecrypterTest, InvalidParameters) {
+  auto key_from_header = FixedKey(key_, header_);
+  EXPECT_FALSE(AesGcmStreamSegmentDecrypter::New(0, kSegmentSize,
+                                                 key_from_header).ok());
+  EXPECT_FALSE(AesGcmStreamSegmentDecrypter::New(kHeaderSize, kHeaderSize + 16,
+                                                 key_from_header).ok());
+  EXPECT_FALSE(AesGcmStreamSegmentDecrypter::New(kHeaderSize, kSegmentSize,
+                                                 nullptr).ok());
+}
+
+TEST_F(AesGcmStreamSegmentDecrypterTest, Layout) {
+  auto decrypter = GetDecrypter();
+  EXPECT_EQ(kHeaderSize, decrypter->get_header_size());
+  EXPECT_EQ(kSegmentSize, decrypter->get_ciphertext_segment_size());
+  EXPECT_EQ(kSegmentSize - 16, decrypter->get_plaintext_segment_size());
+  EXPECT_EQ(kHeaderSize, decrypter->get_ciphertext_offset());
+}
+
+TEST_F(AesGcmStreamSegmentDecrypterTest, DecryptSegments) {
+  auto decrypter = GetDecrypter();
+  ASSERT_TRUE(decrypter->Init(header_).ok());
+  std::vector<uint8_t> plaintext;
+  for (int i = 0; i < ciphertexts_.size(); i++) {
+    auto status = decrypter->DecryptSegment(
+        ciphertexts_[i], i, i == ciphertexts_.size() - 1, &plaintext);
+    EXPECT_TRUE(status.ok()) << status;
+    EXPECT_EQ(plaintexts_[i], plaintext);
+  }
+}
+
+TEST_F(AesGcmStreamSegmentDecrypterTest, WrongPosition) {
+  auto decrypter = GetDecrypter();
+  ASSERT_TRUE(decrypter->Init(header_).ok());
+  std::vector<uint8_t> plaintext;
+  // Wrong segment number.
+  EXPECT_FALSE(decrypter->DecryptSegment(ciphertexts_[1], 2, false,
+                                         &plaintext).ok());
+  // Truncation: a segment that is not the last one, decrypted as the last.
+  EXPECT_FALSE(decrypter->DecryptSegment(ciphertexts_[1], 1, true,
+                                         &plaintext).ok());
+  // Extension: the last segment, decrypted as not the last.
+  EXPECT_FALSE(decrypter->DecryptSegment(ciphertexts_[2], 2, false,
+                                         &plaintext).ok());
+  // Modified ciphertext.
+  std::vector<uint8_t> modified = ciphertexts_[1];
+  modified[5] ^= 1;
+  EXPECT_FALSE(decrypter->DecryptSegment(modified, 1, false,
+                                         &plaintext).ok());
+  // Too long for the first segment.
+  EXPECT_FALSE(decrypter->DecryptSegment(ciphertexts_[1], 0, false,
+                                         &plaintext).ok());
+  // Too short to hold a tag.
+  EXPECT_FALSE(decrypter->DecryptSegment(GetBytes(15), 1, true,
+                                         &plaintext).ok());
+}
+
+TEST_F(AesGcmStreamSegmentDecrypterTest, DecryptSegmentAt) {
+  auto decrypter = GetDecrypter();
+  std::vector<uint8_t> plaintext(ciphertexts_[2].size() - 16);
+  auto status = decrypter->DecryptSegmentAt(ciphertexts_[2], 2, true,
+                                            absl::MakeSpan(plaintext));
+  EXPECT_EQ(util::error::FAILED_PRECONDITION, status.error_code());
+
+  ASSERT_TRUE(decrypter->Init(header_).ok());
+  for (int i = ciphertexts_.size() - 1; i >= 0; i--) {
+    plaintext.resize(ciphertexts_[i].size() - 16);
+    status = decrypter->DecryptSegmentAt(
+        ciphertexts_[i], i, i == ciphertexts_.size() - 1,
+        absl::MakeSpan(plaintext));
+    EXPECT_TRUE(status.ok()) << status;
+    EXPECT_EQ(plaintexts_[i], plaintext);
+  }
+  // Wrong position, and wrong output size.
+  plaintext.resize(ciphertexts_[1].size() - 16);
+  EXPECT_FALSE(decrypter->DecryptSegmentAt(ciphertexts_[1], 2, false,
+                                           absl::MakeSpan(plaintext)).ok());
+  plaintext.resize(ciphertexts_[1].size());
+  EXPECT_FALSE(decrypter->DecryptSegmentAt(ciphertexts_[1], 1, false,
+                                           absl::MakeSpan(plaintext)).ok());
+}
+
+TEST_F(AesGcmStreamSegmentDecrypterTest, InitErrors) {
+  std::vector<uint8_t> plaintext;
+  auto decrypter = GetDecrypter();
+  auto status = decrypter->DecryptSegment(ciphertexts_[0], 0, false,
+                                          &plaintext);
+  EXPECT_EQ(util::error::FAILED_PRECONDITION, status.error_code());
+
+  // The error of key_from_header is returned.
+  std::vector<uint8_t> other_header = GetBytes(kHeaderSize);
+  status = decrypter->Init(other_header);
+  EXPECT_FALSE(status.ok());
+  EXPECT_EQ("unknown header", status.error_message());
+
+  EXPECT_FALSE(decrypter->Init(GetBytes(kHeaderSize - 1)).ok());
+  EXPECT_TRUE(decrypter->Init(header_).ok());
+  EXPECT_FALSE(decrypter->Init(header_).ok());
+}
+
+}  // namespace
+}  // namespace subtle
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,134 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/subtle/aes_gcm_stream_segment_encrypter.h"
+
+#include <cstring>
+#include <utility>
+
+#include "absl/types/span.h"
+#include "tink/subtle/stream_segment_encrypter.h"
+#include "tink/util/secret_data.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "openssl/aead.h"
+
+namespace crypto {
+namespace tink {
+namespace subtle {
+
+namespace {
+
+const EVP_AEAD* GetAeadForKeySize(uint32_t size_in_bytes) {
+  switch (size_in_bytes) {
+    case 16:
+      return EVP_aead_aes_128_gcm();
+    case 32:
+      return EVP_aead_aes_256_gcm();
+    default:
+      return nullptr;
+  }
+}
+
+}  // namespace
+
+// static
+util::StatusOr<std::unique_ptr<StreamSegmentEncrypter>>
+AesGcmStreamSegmentEncrypter::New(const util::SecretData& key,
+                                  std::vector<uint8_t> header,
+                                  int ciphertext_segment_size) {
+  const EVP_AEAD* aead = GetAeadForKeySize(key.size());
+  if (aead == nullptr) {
+    return util::Status(util::error::INVALID_ARGUMENT, "invalid key size");
+  }
+  if (ciphertext_segment_size <=
+      static_cast<int>(header.size()) + kTagSizeInBytes) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+                        "ciphertext_segment_size too small");
+  }
+  std::unique_ptr<AesGcmStreamSegmentEncrypter> encrypter(
+      new AesGcmStreamSegmentEncrypter(std::move(header),
+                                       ciphertext_segment_size));
+  if (EVP_AEAD_CTX_init(encrypter->ctx_.get(), aead, key.data(), key.size(),
+                        EVP_AEAD_DEFAULT_TAG_LENGTH, nullptr) != 1) {
+    return util::Status(util::error::INTERNAL,
+                        "could not initialize EVP_AEAD_CTX");
+  }
+  return {std::move(encrypter)};
+}
+
+// static
+util::Status AesGcmStreamSegmentEncrypter::ComputeNonce(int64_t segment_number,
+                                                        bool is_last_segment,
+                                                        uint8_t* nonce) {
+  if (segment_number < 0 || segment_number > 0xffffffffLL) {
+    return util::Status(util::error::OUT_OF_RANGE, "too many segments");
+  }
+  memset(nonce, 0, kNonceSizeInBytes - 5);
+  nonce[kNonceSizeInBytes - 5] = (segment_number >> 24) & 0xff;
+  nonce[kNonceSizeInBytes - 4] = (segment_number >> 16) & 0xff;
+  nonce[kNonceSizeInBytes - 3] = (segment_number >> 8) & 0xff;
+  nonce[kNonceSizeInBytes - 2] = segment_number & 0xff;
+  nonce[kNonceSizeInBytes - 1] = is_last_segment ? 1 : 0;
+  return util::Status::OK;
+}
+
+util::Status AesGcmStreamSegmentEncrypter::EncryptSegment(
+    const std::vector<uint8_t>& plaintext,
+    bool is_last_segment,
+    std::vector<uint8_t>* ciphertext_buffer) {
+  // The extra byte keeps the output pointer valid for empty segments.
+  ciphertext_buffer->resize(plaintext.size() + kTagSizeInBytes + 1);
+  auto status = EncryptSegmentAt(
+      plaintext, segment_number_, is_last_segment,
+      absl::MakeSpan(ciphertext_buffer->data(),
+                     plaintext.size() + kTagSizeInBytes));
+  if (!status.ok()) return status;
+  ciphertext_buffer->resize(plaintext.size() + kTagSizeInBytes);
+  IncSegmentNumber();
+  return util::Status::OK;
+}
+
+util::Status AesGcmStreamSegmentEncrypter::EncryptSegmentAt(
+    absl::Span<const uint8_t> plaintext,
+    int64_t segment_number,
+    bool is_last_segment,
+    absl::Span<uint8_t> ciphertext) const {
+  int max_plaintext_size = get_plaintext_segment_size();
+  if (segment_number == 0) max_plaintext_size -= get_ciphertext_offset();
+  if (plaintext.size() > max_plaintext_size) {
+    return util::Status(util::error::INVALID_ARGUMENT, "segment too long");
+  }
+  if (ciphertext.size() != plaintext.size() + kTagSizeInBytes) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+                        "wrong ciphertext size");
+  }
+  uint8_t nonce[kNonceSizeInBytes];
+  auto status = ComputeNonce(segment_number, is_last_segment, nonce);
+  if (!status.ok()) return status;
+  size_t len;
+  if (EVP_AEAD_CTX_seal(ctx_.get(), ciphertext.data(), &len,
+                        ciphertext.size(), nonce, kNonceSizeInBytes,
+                        plaintext.data(), plaintext.size(),
+                        nullptr, 0) != 1) {
+    return util::Status(util::error::INTERNAL, "Encryption failed");
+  }
+  return util::Status::OK;
+}
+
+}  // namespace subtle
+}  // namespace tink
+}  // namespace crypto
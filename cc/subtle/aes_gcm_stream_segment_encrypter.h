@@ -0,0 +1,118 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_SUBTLE_AES_GCM_STREAM_SEGMENT_ENCRYPTER_H_
+#define TINK_SUBTLE_AES_GCM_STREAM_SEGMENT_ENCRYPTER_H_
+
+#include <memory>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "tink/subtle/stream_segment_encrypter.h"
+#include "tink/util/secret_data.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "openssl/aead.h"
+
+namespace crypto {
+namespace tink {
+namespace subtle {
+
+// A StreamSegmentEncrypter that encrypts each segment with AES-GCM, under
+// a key that must be unique to the stream, e.g. a key derived from the
+// stream header by a KEM.  Since the key is never reused, the nonce of a
+// segment is just its position in the stream:
+//
+//   nonce = 0x00^7 || segment_number (4 bytes, big endian) || last_flag
+//
+// where last_flag is 1 for the last segment and 0 otherwise.  A ciphertext
+// segment is the AES-GCM ciphertext of the plaintext segment followed by
+// its 16-byte tag; the ciphertext offset equals the size of the header.
+class AesGcmStreamSegmentEncrypter : public StreamSegmentEncrypter {
+ public:
+  static const int kNonceSizeInBytes = 12;
+  static const int kTagSizeInBytes = 16;
+
+  // Returns an encrypter for one stream, with the given 16- or 32-byte
+  // 'key' and 'header', and ciphertext segments of
+  // 'ciphertext_segment_size' bytes.
+  static util::StatusOr<std::unique_ptr<StreamSegmentEncrypter>> New(
+      const util::SecretData& key, std::vector<uint8_t> header,
+      int ciphertext_segment_size);
+
+  // Writes the nonce of the given segment to 'nonce', which must have room
+  // for kNonceSizeInBytes bytes.  Fails if the segment number does not
+  // fit into the nonce.
+  static util::Status ComputeNonce(int64_t segment_number,
+                                   bool is_last_segment, uint8_t* nonce);
+
+  // -----------------------
+  // Methods of StreamSegmentEncrypter-interface implemented by this class.
+  util::Status EncryptSegment(
+      const std::vector<uint8_t>& plaintext,
+      bool is_last_segment,
+      std::vector<uint8_t>* ciphertext_buffer) override;
+
+  // Safe to call concurrently: the AES-GCM context is only read.
+  util::Status EncryptSegmentAt(
+      absl::Span<const uint8_t> plaintext,
+      int64_t segment_number,
+      bool is_last_segment,
+      absl::Span<uint8_t> ciphertext) const override;
+
+  const std::vector<uint8_t>& get_header() const override {
+    return header_;
+  }
+
+  int64_t get_segment_number() const override {
+    return segment_number_;
+  }
+
+  int get_plaintext_segment_size() const override {
+    return ciphertext_segment_size_ - kTagSizeInBytes;
+  }
+
+  int get_ciphertext_segment_size() const override {
+    return ciphertext_segment_size_;
+  }
+
+  int get_ciphertext_offset() const override {
+    return header_.size();
+  }
+
+ protected:
+  void IncSegmentNumber() override {
+    segment_number_++;
+  }
+
+ private:
+  AesGcmStreamSegmentEncrypter(std::vector<uint8_t> header,
+                               int ciphertext_segment_size)
+      : header_(std::move(header)),
+        ciphertext_segment_size_(ciphertext_segment_size),
+        segment_number_(0) {}
+
+  bssl::ScopedEVP_AEAD_CTX ctx_;
+  const std::vector<uint8_t> header_;
+  const int ciphertext_segment_size_;
+  int64_t segment_number_;
+};
+
+}  // namespace subtle
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_SUBTLE_AES_GCM_STREAM_SEGMENT_ENCRYPTER_H_
@@ -0,0 +1,161 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/subtle/aes_gcm_stream_segment_encrypter.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/types/span.h"
+#include "tink/subtle/random.h"
+#include "tink/util/secret_data.h"
+#include "tink/util/status.h"
+
+namespace crypto {
+namespace tink {
+namespace subtle {
+namespace {
+
+util::SecretData GetKey(int size) {
+  return util::SecretDataFromStringView(Random::GetRandomBytes(size));
+}
+
+std::vector<uint8_t> GetBytes(int size) {
+  std::string bytes = Random::GetRandomBytes(size);
+  return std::vector<uint8_t>(bytes.begin(), bytes.end());
+}
+
+TEST(AesGcmStreamSegmentEncrypterTest, InvalidParameters) {
+  std::vector<uint8_t> header = GetBytes(65);
+  EXPECT_FALSE(AesGcmStreamSegmentEncrypter::New(GetKey(24), header, 4096)
+               .ok());
+  // The first segment must hold at least one byte of plaintext.
+  EXPECT_FALSE(AesGcmStreamSegmentEncrypter::New(GetKey(16), header, 65 + 16)
+               .ok());
+  EXPECT_TRUE(AesGcmStreamSegmentEncrypter::New(GetKey(16), header, 65 + 17)
+              .ok());
+  EXPECT_TRUE(AesGcmStreamSegmentEncrypter::New(GetKey(32), header, 4096)
+              .ok());
+}
+
+TEST(AesGcmStreamSegmentEncrypterTest, Layout) {
+  std::vector<uint8_t> header = GetBytes(65);
+  auto encrypter = std::move(
+      AesGcmStreamSegmentEncrypter::New(GetKey(16), header, 4096)
+      .ValueOrDie());
+  EXPECT_EQ(header, encrypter->get_header());
+  EXPECT_EQ(4096, encrypter->get_ciphertext_segment_size());
+  EXPECT_EQ(4096 - 16, encrypter->get_plaintext_segment_size());
+  EXPECT_EQ(65, encrypter->get_ciphertext_offset());
+  EXPECT_EQ(0, encrypter->get_segment_number());
+
+  std::vector<uint8_t> ciphertext;
+  // The first segment is shorter, since it shares space with the header.
+  auto status = encrypter->EncryptSegment(GetBytes(4096 - 16 - 64), false,
+                                          &ciphertext);
+  EXPECT_FALSE(status.ok());
+  EXPECT_EQ(0, encrypter->get_segment_number());
+  status = encrypter->EncryptSegment(GetBytes(4096 - 16 - 65), false,
+                                     &ciphertext);
+  EXPECT_TRUE(status.ok()) << status;
+  EXPECT_EQ(4096 - 65, ciphertext.size());
+  EXPECT_EQ(1, encrypter->get_segment_number());
+
+  status = encrypter->EncryptSegment(GetBytes(4096 - 16), false, &ciphertext);
+  EXPECT_TRUE(status.ok()) << status;
+  EXPECT_EQ(4096, ciphertext.size());
+  status = encrypter->EncryptSegment(GetBytes(0), true, &ciphertext);
+  EXPECT_TRUE(status.ok()) << status;
+  EXPECT_EQ(16, ciphertext.size());
+  EXPECT_EQ(3, encrypter->get_segment_number());
+}
+
+TEST(AesGcmStreamSegmentEncrypterTest, SegmentsUseDistinctNonces) {
+  util::SecretData key = GetKey(32);
+  std::vector<uint8_t> header = GetBytes(65);
+  std::vector<uint8_t> plaintext = GetBytes(100);
+  auto encrypter = std::move(
+      AesGcmStreamSegmentEncrypter::New(key, header, 4096).ValueOrDie());
+  std::vector<uint8_t> ct0, ct1;
+  EXPECT_TRUE(encrypter->EncryptSegment(plaintext, false, &ct0).ok());
+  EXPECT_TRUE(encrypter->EncryptSegment(plaintext, false, &ct1).ok());
+  EXPECT_NE(ct0, ct1);
+
+  // The same position, but as the last segment.
+  auto other_encrypter = std::move(
+      AesGcmStreamSegmentEncrypter::New(key, header, 4096).ValueOrDie());
+  std::vector<uint8_t> ct0_last;
+  EXPECT_TRUE(other_encrypter->EncryptSegment(plaintext, true, &ct0_last)
+              .ok());
+  EXPECT_NE(ct0, ct0_last);
+}
+
+TEST(AesGcmStreamSegmentEncrypterTest, EncryptSegmentAt) {
+  util::SecretData key = GetKey(16);
+  std::vector<uint8_t> header = GetBytes(65);
+  auto sequential = std::move(
+      AesGcmStreamSegmentEncrypter::New(key, header, 4096).ValueOrDie());
+  auto positional = std::move(
+      AesGcmStreamSegmentEncrypter::New(key, header, 4096).ValueOrDie());
+  std::vector<std::vector<uint8_t>> plaintexts = {
+      GetBytes(4096 - 16 - 65), GetBytes(4096 - 16), GetBytes(10)};
+  std::vector<std::vector<uint8_t>> expected(plaintexts.size());
+  for (int i = 0; i < plaintexts.size(); i++) {
+    ASSERT_TRUE(sequential->EncryptSegment(
+        plaintexts[i], i == plaintexts.size() - 1, &expected[i]).ok());
+  }
+  // Positional encryption matches sequential encryption in any order,
+  // and leaves the segment number alone.
+  for (int i = plaintexts.size() - 1; i >= 0; i--) {
+    std::vector<uint8_t> ciphertext(plaintexts[i].size() + 16);
+    auto status = positional->EncryptSegmentAt(
+        plaintexts[i], i, i == plaintexts.size() - 1,
+        absl::MakeSpan(ciphertext));
+    EXPECT_TRUE(status.ok()) << status;
+    EXPECT_EQ(expected[i], ciphertext);
+  }
+  EXPECT_EQ(0, positional->get_segment_number());
+
+  std::vector<uint8_t> ciphertext(4096);
+  // Too long for the first segment.
+  EXPECT_FALSE(positional->EncryptSegmentAt(
+      plaintexts[1], 0, false, absl::MakeSpan(ciphertext)).ok());
+  // Wrong output size.
+  EXPECT_FALSE(positional->EncryptSegmentAt(
+      plaintexts[2], 2, true, absl::MakeSpan(ciphertext)).ok());
+}
+
+TEST(AesGcmStreamSegmentEncrypterTest, ComputeNonce) {
+  uint8_t nonce[AesGcmStreamSegmentEncrypter::kNonceSizeInBytes];
+  EXPECT_TRUE(
+      AesGcmStreamSegmentEncrypter::ComputeNonce(0x01020304, true, nonce).ok());
+  std::vector<uint8_t> expected = {0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 1};
+  EXPECT_EQ(expected, std::vector<uint8_t>(nonce, nonce + 12));
+
+  EXPECT_TRUE(
+      AesGcmStreamSegmentEncrypter::ComputeNonce(0xffffffff, false, nonce)
+      .ok());
+  auto status =
+      AesGcmStreamSegmentEncrypter::ComputeNonce(0x100000000, false, nonce);
+  EXPECT_FALSE(status.ok());
+  EXPECT_EQ(util::error::OUT_OF_RANGE, status.error_code());
+}
+
+}  // namespace
+}  // namespace subtle
+}  // namespace tink
+}  // namespace crypto
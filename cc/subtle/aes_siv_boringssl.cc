@@ -16,15 +16,21 @@
 
 #include "tink/subtle/aes_siv_boringssl.h"
 
+#include <algorithm>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/types/span.h"
 #include "tink/deterministic_aead.h"
 #include "tink/util/errors.h"
+#include "tink/util/secret_data.h"
 #include "tink/util/status.h"
 #include "tink/util/statusor.h"
 #include "openssl/err.h"
 #include "openssl/aes.h"
+#include "openssl/cipher.h"
+#include "openssl/mem.h"
 
 namespace crypto {
 namespace tink {
@@ -39,6 +45,166 @@ static void XorBlock(
   }
 }
 
+namespace {
+
+// The number of values whose CMACs are computed together in a batch.
+constexpr int kLanes = 8;
+
+// The number of CTR key stream blocks generated together in a batch.
+constexpr size_t kKeyStreamBlocks = 64;
+
+// The last step of the S2V of one value of a batch, a CMAC over the
+// value, which is split into blocks of 16 bytes.  The last one or two
+// blocks are prepared in 'tail' by PrepareCmacLane().
+struct CmacLane {
+  const uint8_t* msg;
+  size_t block_count;
+  // The index of the first block that is taken from 'tail'.
+  size_t tail_start;
+  size_t next_block;
+  size_t value_index;
+  uint8_t tail[32];
+
+  const uint8_t* Block(size_t i) const {
+    return i < tail_start ? msg + 16 * i : tail + 16 * (i - tail_start);
+  }
+};
+
+// Sets up 'lane' for the last step of the S2V of 'msg' (RFC 5297, 2.4),
+// given the S2V-value 'd' of the associated data and d2 = dbl(d): the
+// CMAC of (msg xorend d) if 'msg' has at least 16 bytes, otherwise the
+// CMAC of (d2 xor pad(msg)).  The CMAC padding and subkeys are applied
+// to the tail, so that the lane only needs to chain the blocks.
+void PrepareCmacLane(const uint8_t* msg, size_t size, const uint8_t d[16],
+                     const uint8_t d2[16], const uint8_t cmac_k1[16],
+                     const uint8_t cmac_k2[16], CmacLane* lane) {
+  lane->msg = msg;
+  lane->next_block = 0;
+  if (size < 16) {
+    lane->block_count = 1;
+    lane->tail_start = 0;
+    XorBlock(d2, cmac_k1, lane->tail);
+    for (size_t i = 0; i < size; i++) lane->tail[i] ^= msg[i];
+    lane->tail[size] ^= 0x80;
+    return;
+  }
+  lane->block_count = (size + 15) / 16;
+  lane->tail_start = lane->block_count >= 2 ? lane->block_count - 2 : 0;
+  size_t tail_size = size - 16 * lane->tail_start;
+  memcpy(lane->tail, msg + 16 * lane->tail_start, tail_size);
+  memset(lane->tail + tail_size, 0, sizeof(lane->tail) - tail_size);
+  for (int i = 0; i < 16; i++) lane->tail[tail_size - 16 + i] ^= d[i];
+  size_t last_offset = 16 * (lane->block_count - 1 - lane->tail_start);
+  uint8_t* last = lane->tail + last_offset;
+  size_t last_size = tail_size - last_offset;
+  if (last_size == 16) {
+    XorBlock(last, cmac_k1, last);
+  } else {
+    last[last_size] ^= 0x80;
+    XorBlock(last, cmac_k2, last);
+  }
+}
+
+// Encrypts 'count' blocks in place with an AES-ECB context.
+bool EncryptBlocks(EVP_CIPHER_CTX* ctx, uint8_t* blocks, size_t count) {
+  int len;
+  return EVP_EncryptUpdate(ctx, blocks, &len, blocks, 16 * count) == 1;
+}
+
+void IncrementCounter(uint8_t counter[16]) {
+  for (int i = 15; i >= 0; i--) {
+    if (++counter[i] != 0) break;
+  }
+}
+
+// A value to encrypt or decrypt with AES-CTR, as in
+// AesSivBoringSsl::CtrCrypt().
+struct CtrSegment {
+  const uint8_t* siv;
+  const uint8_t* in;
+  uint8_t* out;
+  size_t size;
+};
+
+// Applies AES-CTR to the segments get_segment(0), ...,
+// get_segment(count - 1), generating the key streams of several segments
+// with one call to the AES-ECB context 'ctx'.
+template <typename GetSegment>
+bool CtrCryptBatch(EVP_CIPHER_CTX* ctx, size_t count,
+                   GetSegment get_segment) {
+  uint8_t key_stream[16 * kKeyStreamBlocks];
+  // The parts of segments whose key streams are in 'key_stream'.
+  CtrSegment pending[kKeyStreamBlocks];
+  size_t pending_count = 0;
+  size_t block_count = 0;
+  auto flush = [&]() {
+    if (!EncryptBlocks(ctx, key_stream, block_count)) return false;
+    const uint8_t* key = key_stream;
+    for (size_t i = 0; i < pending_count; i++) {
+      const CtrSegment& part = pending[i];
+      for (size_t j = 0; j < part.size; j++) {
+        part.out[j] = part.in[j] ^ key[j];
+      }
+      key += 16 * ((part.size + 15) / 16);
+    }
+    pending_count = 0;
+    block_count = 0;
+    return true;
+  };
+  for (size_t i = 0; i < count; i++) {
+    CtrSegment segment = get_segment(i);
+    uint8_t counter[16];
+    memcpy(counter, segment.siv, 16);
+    counter[8] &= 0x7f;
+    counter[12] &= 0x7f;
+    size_t done = 0;
+    while (done < segment.size) {
+      if (block_count == kKeyStreamBlocks && !flush()) return false;
+      size_t blocks = std::min((segment.size - done + 15) / 16,
+                               kKeyStreamBlocks - block_count);
+      size_t size = std::min(16 * blocks, segment.size - done);
+      for (size_t j = 0; j < blocks; j++) {
+        memcpy(key_stream + 16 * (block_count + j), counter, 16);
+        IncrementCounter(counter);
+      }
+      pending[pending_count++] = {nullptr, segment.in + done,
+                                  segment.out + done, size};
+      block_count += blocks;
+      done += size;
+    }
+  }
+  bool ok = block_count == 0 || flush();
+  OPENSSL_cleanse(key_stream, sizeof(key_stream));
+  return ok;
+}
+
+// Returns an AES-256-ECB context for 'key', or nullptr.
+bssl::UniquePtr<EVP_CIPHER_CTX> NewAesEcbContext(const uint8_t* key) {
+  bssl::UniquePtr<EVP_CIPHER_CTX> ctx(EVP_CIPHER_CTX_new());
+  if (ctx == nullptr ||
+      EVP_EncryptInit_ex(ctx.get(), EVP_aes_256_ecb(), nullptr, key,
+                         nullptr) != 1 ||
+      EVP_CIPHER_CTX_set_padding(ctx.get(), 0) != 1) {
+    return nullptr;
+  }
+  return ctx;
+}
+
+// Checks that 'offsets' are the offsets of a column of values in 'data'.
+util::Status ValidateColumn(absl::string_view data,
+                            absl::Span<const int64_t> offsets) {
+  for (size_t i = 0; i < offsets.size(); i++) {
+    if (offsets[i] < 0 || static_cast<uint64_t>(offsets[i]) > data.size() ||
+        (i > 0 && offsets[i] < offsets[i - 1])) {
+      return util::Status(util::error::INVALID_ARGUMENT,
+                          "invalid offsets of a column");
+    }
+  }
+  return util::Status::OK;
+}
+
+}  // namespace
+
 // static
 crypto::tink::util::StatusOr<std::unique_ptr<DeterministicAead>>
 AesSivBoringSsl::New(absl::string_view key_value) {
@@ -72,6 +238,10 @@ bool AesSivBoringSsl::SetKey(absl::string_view key) {
   memcpy(cmac_k1_, block, BLOCK_SIZE);
   MultiplyByX(block);
   memcpy(cmac_k2_, block, BLOCK_SIZE);
+  memset(block, 0, BLOCK_SIZE);
+  Cmac(block, BLOCK_SIZE, cmac_zero_x_);
+  MultiplyByX(cmac_zero_x_);
+  key_ = util::SecretDataFromStringView(key);
   return true;
 }
 
@@ -159,18 +329,18 @@ void AesSivBoringSsl::CmacLong(
   EncryptBlock(block, mac);
 }
 
+void AesSivBoringSsl::S2vAad(const uint8_t* aad, size_t aad_size,
+                             uint8_t d[BLOCK_SIZE]) const {
+  uint8_t aad_mac[BLOCK_SIZE];
+  Cmac(aad, aad_size, aad_mac);
+  XorBlock(cmac_zero_x_, aad_mac, d);
+}
+
 void AesSivBoringSsl::S2v(const uint8_t* aad, size_t aad_size,
                           const uint8_t* msg, size_t msg_size,
                           uint8_t siv[BLOCK_SIZE]) const {
-  // This stuff could be precomputed.
   uint8_t block[BLOCK_SIZE];
-  memset(block, 0, BLOCK_SIZE);
-  Cmac(block, BLOCK_SIZE, block);
-  MultiplyByX(block);
-
-  uint8_t aad_mac[BLOCK_SIZE];
-  Cmac(aad, aad_size, aad_mac);
-  XorBlock(block, aad_mac, block);
+  S2vAad(aad, aad_size, block);
 
   if (msg_size >= BLOCK_SIZE) {
     CmacLong(msg, msg_size, block, siv);
@@ -194,37 +364,220 @@ util::StatusOr<std::string> AesSivBoringSsl::EncryptDeterministically(
       plaintext.size(),
       siv);
   size_t ciphertext_size = plaintext.size() + BLOCK_SIZE;
-  std::vector<uint8_t> ct(ciphertext_size);
-  memcpy(ct.data(), siv, BLOCK_SIZE);
+  // The ciphertext is written directly into the result, which is the only
+  // allocation per message.
+  std::string ct;
+  ct.resize(ciphertext_size);
+  uint8_t* out = reinterpret_cast<uint8_t*>(&ct[0]);
+  memcpy(out, siv, BLOCK_SIZE);
   CtrCrypt(siv, reinterpret_cast<const uint8_t*>(plaintext.data()),
-           ct.data() + BLOCK_SIZE, plaintext.size());
-  return std::string(reinterpret_cast<const char*>(ct.data()), ciphertext_size);
+           out + BLOCK_SIZE, plaintext.size());
+  return std::move(ct);
 }
 
 util::StatusOr<std::string> AesSivBoringSsl::DecryptDeterministically(
     absl::string_view ciphertext,
     absl::string_view additional_data) const {
   if (ciphertext.size() < BLOCK_SIZE) {
-    return util::Status(util::error::INVALID_ARGUMENT, "ciphertext too short");
+    static const util::StaticStatus* kCiphertextTooShort =
+        new util::StaticStatus(util::error::INVALID_ARGUMENT,
+                               "ciphertext too short");
+    return *kCiphertextTooShort;
   }
   size_t plaintext_size = ciphertext.size() - BLOCK_SIZE;
-  std::vector<uint8_t> pt(plaintext_size);
-  const uint8_t *siv = reinterpret_cast<const uint8_t*>(&ciphertext[0]);
-  const uint8_t *ct = reinterpret_cast<const uint8_t*>(&ciphertext[BLOCK_SIZE]);
-  CtrCrypt(siv, ct, pt.data(), plaintext_size);
+  // The plaintext is written directly into the result.
+  std::string pt;
+  pt.resize(plaintext_size);
+  uint8_t* out = reinterpret_cast<uint8_t*>(&pt[0]);
+  const uint8_t *siv = reinterpret_cast<const uint8_t*>(ciphertext.data());
+  const uint8_t *ct = siv + BLOCK_SIZE;
+  CtrCrypt(siv, ct, out, plaintext_size);
 
   uint8_t s2v[BLOCK_SIZE];
   S2v(reinterpret_cast<const uint8_t*>(additional_data.data()),
-      additional_data.size(), pt.data(), plaintext_size, s2v);
+      additional_data.size(), out, plaintext_size, s2v);
   // Compare the siv from the ciphertext with the recomputed siv
   uint8_t diff = 0;
   for (int i = 0; i < BLOCK_SIZE; ++i) {
     diff |= siv[i] ^ s2v[i];
   }
   if (diff != 0) {
-    return util::Status(util::error::INVALID_ARGUMENT, "invalid ciphertext");
+    static const util::StaticStatus* kInvalidCiphertext =
+        new util::StaticStatus(util::error::INVALID_ARGUMENT,
+                               "invalid ciphertext");
+    return *kInvalidCiphertext;
+  }
+  return std::move(pt);
+}
+
+bool AesSivBoringSsl::S2vBatch(EVP_CIPHER_CTX* ctx, const uint8_t* data,
+                               absl::Span<const int64_t> offsets,
+                               const uint8_t d[BLOCK_SIZE],
+                               uint8_t* sivs) const {
+  size_t count = offsets.empty() ? 0 : offsets.size() - 1;
+  uint8_t d2[BLOCK_SIZE];
+  memcpy(d2, d, BLOCK_SIZE);
+  MultiplyByX(d2);
+  CmacLane lanes[kLanes];
+  // The CMAC states of the lanes, contiguous so that they are encrypted
+  // with a single call.
+  uint8_t states[kLanes * BLOCK_SIZE];
+  int active = 0;
+  size_t next_value = 0;
+  bool ok = true;
+  while (ok) {
+    while (active < kLanes && next_value < count) {
+      PrepareCmacLane(data + offsets[next_value],
+                      offsets[next_value + 1] - offsets[next_value], d, d2,
+                      cmac_k1_, cmac_k2_, &lanes[active]);
+      lanes[active].value_index = next_value;
+      memset(states + BLOCK_SIZE * active, 0, BLOCK_SIZE);
+      active++;
+      next_value++;
+    }
+    if (active == 0) break;
+    for (int i = 0; i < active; i++) {
+      uint8_t* state = states + BLOCK_SIZE * i;
+      XorBlock(state, lanes[i].Block(lanes[i].next_block++), state);
+    }
+    ok = EncryptBlocks(ctx, states, active);
+    // Lanes that are done are replaced by the last active lane.
+    for (int i = 0; i < active;) {
+      if (lanes[i].next_block < lanes[i].block_count) {
+        i++;
+        continue;
+      }
+      memcpy(sivs + BLOCK_SIZE * lanes[i].value_index,
+             states + BLOCK_SIZE * i, BLOCK_SIZE);
+      active--;
+      if (i != active) {
+        lanes[i] = lanes[active];
+        memcpy(states + BLOCK_SIZE * i, states + BLOCK_SIZE * active,
+               BLOCK_SIZE);
+      }
+    }
+  }
+  OPENSSL_cleanse(lanes, sizeof(lanes));
+  OPENSSL_cleanse(states, sizeof(states));
+  return ok;
+}
+
+util::Status AesSivBoringSsl::NewEcbContexts(
+    bssl::UniquePtr<EVP_CIPHER_CTX>* k1_ctx,
+    bssl::UniquePtr<EVP_CIPHER_CTX>* k2_ctx) const {
+  *k1_ctx = NewAesEcbContext(key_.data());
+  *k2_ctx = NewAesEcbContext(key_.data() + key_.size() / 2);
+  if (*k1_ctx == nullptr || *k2_ctx == nullptr) {
+    return util::Status(util::error::INTERNAL,
+                        "could not initialize the AES-ECB contexts");
+  }
+  return util::Status::OK;
+}
+
+util::Status AesSivBoringSsl::EncryptDeterministicallyBatch(
+    absl::string_view plaintexts, absl::Span<const int64_t> plaintext_offsets,
+    absl::string_view associated_data, std::string* ciphertexts,
+    std::vector<int64_t>* ciphertext_offsets) const {
+  auto status = ValidateColumn(plaintexts, plaintext_offsets);
+  if (!status.ok()) return status;
+  bssl::UniquePtr<EVP_CIPHER_CTX> k1_ctx;
+  bssl::UniquePtr<EVP_CIPHER_CTX> k2_ctx;
+  status = NewEcbContexts(&k1_ctx, &k2_ctx);
+  if (!status.ok()) return status;
+
+  size_t count = plaintext_offsets.empty() ? 0 : plaintext_offsets.size() - 1;
+  ciphertext_offsets->resize(count + 1);
+  (*ciphertext_offsets)[0] = 0;
+  for (size_t i = 0; i < count; i++) {
+    (*ciphertext_offsets)[i + 1] = (*ciphertext_offsets)[i] + BLOCK_SIZE +
+                                   plaintext_offsets[i + 1] -
+                                   plaintext_offsets[i];
+  }
+  // All the ciphertexts are written directly into a single buffer.
+  ciphertexts->resize((*ciphertext_offsets)[count]);
+  uint8_t* out = reinterpret_cast<uint8_t*>(&(*ciphertexts)[0]);
+  const uint8_t* in = reinterpret_cast<const uint8_t*>(plaintexts.data());
+
+  uint8_t d[BLOCK_SIZE];
+  S2vAad(reinterpret_cast<const uint8_t*>(associated_data.data()),
+         associated_data.size(), d);
+  std::vector<uint8_t> sivs(BLOCK_SIZE * count);
+  if (!S2vBatch(k1_ctx.get(), in, plaintext_offsets, d, sivs.data())) {
+    return util::Status(util::error::INTERNAL, "AES-ECB failed");
+  }
+  for (size_t i = 0; i < count; i++) {
+    memcpy(out + (*ciphertext_offsets)[i], &sivs[BLOCK_SIZE * i], BLOCK_SIZE);
+  }
+  bool ok = CtrCryptBatch(k2_ctx.get(), count, [&](size_t i) {
+    uint8_t* ciphertext = out + (*ciphertext_offsets)[i];
+    return CtrSegment{ciphertext, in + plaintext_offsets[i],
+                      ciphertext + BLOCK_SIZE,
+                      static_cast<size_t>(plaintext_offsets[i + 1] -
+                                          plaintext_offsets[i])};
+  });
+  if (!ok) return util::Status(util::error::INTERNAL, "AES-ECB failed");
+  return util::Status::OK;
+}
+
+util::Status AesSivBoringSsl::DecryptDeterministicallyBatch(
+    absl::string_view ciphertexts,
+    absl::Span<const int64_t> ciphertext_offsets,
+    absl::string_view associated_data, std::string* plaintexts,
+    std::vector<int64_t>* plaintext_offsets) const {
+  plaintexts->clear();
+  plaintext_offsets->clear();
+  auto status = ValidateColumn(ciphertexts, ciphertext_offsets);
+  if (!status.ok()) return status;
+  size_t count =
+      ciphertext_offsets.empty() ? 0 : ciphertext_offsets.size() - 1;
+  std::vector<int64_t> offsets(count + 1);
+  offsets[0] = 0;
+  for (size_t i = 0; i < count; i++) {
+    int64_t size = ciphertext_offsets[i + 1] - ciphertext_offsets[i];
+    if (size < static_cast<int64_t>(BLOCK_SIZE)) {
+      return ToStatusF(util::error::INVALID_ARGUMENT,
+                       "ciphertext %zu too short", i);
+    }
+    offsets[i + 1] = offsets[i] + size - BLOCK_SIZE;
+  }
+  bssl::UniquePtr<EVP_CIPHER_CTX> k1_ctx;
+  bssl::UniquePtr<EVP_CIPHER_CTX> k2_ctx;
+  status = NewEcbContexts(&k1_ctx, &k2_ctx);
+  if (!status.ok()) return status;
+
+  std::string result;
+  result.resize(offsets[count]);
+  uint8_t* out = reinterpret_cast<uint8_t*>(&result[0]);
+  const uint8_t* in = reinterpret_cast<const uint8_t*>(ciphertexts.data());
+  bool ok = CtrCryptBatch(k2_ctx.get(), count, [&](size_t i) {
+    const uint8_t* ciphertext = in + ciphertext_offsets[i];
+    return CtrSegment{ciphertext, ciphertext + BLOCK_SIZE, out + offsets[i],
+                      static_cast<size_t>(offsets[i + 1] - offsets[i])};
+  });
+  uint8_t d[BLOCK_SIZE];
+  S2vAad(reinterpret_cast<const uint8_t*>(associated_data.data()),
+         associated_data.size(), d);
+  std::vector<uint8_t> sivs(BLOCK_SIZE * count);
+  if (!ok || !S2vBatch(k1_ctx.get(), out, offsets, d, sivs.data())) {
+    util::SafeZeroString(&result);
+    return util::Status(util::error::INTERNAL, "AES-ECB failed");
+  }
+  // Compare the sivs from the ciphertexts with the recomputed sivs
+  for (size_t i = 0; i < count; i++) {
+    const uint8_t* siv = in + ciphertext_offsets[i];
+    uint8_t diff = 0;
+    for (int j = 0; j < BLOCK_SIZE; ++j) {
+      diff |= siv[j] ^ sivs[BLOCK_SIZE * i + j];
+    }
+    if (diff != 0) {
+      util::SafeZeroString(&result);
+      return ToStatusF(util::error::INVALID_ARGUMENT,
+                       "invalid ciphertext %zu", i);
+    }
   }
-  return std::string(reinterpret_cast<const char*>(pt.data()), plaintext_size);
+  *plaintexts = std::move(result);
+  *plaintext_offsets = std::move(offsets);
+  return util::Status::OK;
 }
 
 }  // namespace subtle
@@ -18,12 +18,18 @@
 #define TINK_SUBTLE_AES_SIV_BORINGSSL_H_
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "tink/deterministic_aead.h"
+#include "tink/subtle/batch_deterministic_aead.h"
+#include "tink/util/secret_data.h"
 #include "tink/util/status.h"
 #include "tink/util/statusor.h"
 #include "openssl/aes.h"
+#include "openssl/cipher.h"
 
 namespace crypto {
 namespace tink {
@@ -51,7 +57,18 @@ namespace subtle {
 // Since 192-bit AES keys are not supported by tink for voodoo reasons
 // and RFC 5297 only supports same size encryption and MAC keys this
 // implies that keys must be 64 bytes (2*256 bits) long.
-class AesSivBoringSsl : public DeterministicAead {
+//
+// Batches:
+// ========
+// The BatchDeterministicAead methods compute the S2V of up to 8
+// values at a time, so that the AES blocks of different values are
+// encrypted together, and generate the CTR key streams of many values
+// at a time.  With AES-NI, BoringSSL pipelines the AES rounds of such
+// independent blocks, which is much faster for short values than the
+// dependent blocks of a single CMAC.  The S2V of the associated data,
+// which is the same for all the values, is computed once per batch.
+class AesSivBoringSsl : public DeterministicAead,
+                        public BatchDeterministicAead {
  public:
   static crypto::tink::util::StatusOr<std::unique_ptr<DeterministicAead>>
   New(absl::string_view key_value);
@@ -64,6 +81,17 @@ class AesSivBoringSsl : public DeterministicAead {
       absl::string_view ciphertext,
       absl::string_view additional_data) const override;
 
+  crypto::tink::util::Status EncryptDeterministicallyBatch(
+      absl::string_view plaintexts, absl::Span<const int64_t> plaintext_offsets,
+      absl::string_view associated_data, std::string* ciphertexts,
+      std::vector<int64_t>* ciphertext_offsets) const override;
+
+  crypto::tink::util::Status DecryptDeterministicallyBatch(
+      absl::string_view ciphertexts,
+      absl::Span<const int64_t> ciphertext_offsets,
+      absl::string_view associated_data, std::string* plaintexts,
+      std::vector<int64_t>* plaintext_offsets) const override;
+
   virtual ~AesSivBoringSsl() {}
 
   static bool IsValidKeySizeInBytes(size_t size) {
@@ -105,13 +133,37 @@ class AesSivBoringSsl : public DeterministicAead {
   // This functions is incorrectly named "doubling" in section 2.3 of RFC 5297.
   static void MultiplyByX(uint8_t block[BLOCK_SIZE]);
 
+  // Computes the part of S2V that only depends on the associated data,
+  // i.e. dbl(CMAC(0)) xor CMAC(aad), the "D" of RFC 5297, 2.4.
+  void S2vAad(const uint8_t* aad, size_t aad_size,
+              uint8_t d[BLOCK_SIZE]) const;
+
   void S2v(const uint8_t* aad, size_t aad_size,
            const uint8_t* msg, size_t msg_size,
            uint8_t siv[BLOCK_SIZE]) const;
+
+  // Computes the SIVs of the values of the column ('data', 'offsets'),
+  // all with the S2vAad() 'd', into sivs[0], sivs[BLOCK_SIZE], ...,
+  // using 'ctx', an AES-ECB context with the key of k1_.
+  bool S2vBatch(EVP_CIPHER_CTX* ctx, const uint8_t* data,
+                absl::Span<const int64_t> offsets,
+                const uint8_t d[BLOCK_SIZE], uint8_t* sivs) const;
+
+  // Returns AES-ECB contexts with the keys of k1_ and k2_, which are
+  // created for each batch, since EVP_CIPHER_CTXs cannot be shared
+  // between threads.
+  crypto::tink::util::Status NewEcbContexts(
+      bssl::UniquePtr<EVP_CIPHER_CTX>* k1_ctx,
+      bssl::UniquePtr<EVP_CIPHER_CTX>* k2_ctx) const;
+
   AES_KEY k1_;
   AES_KEY k2_;
+  // The bytes of k1_ and k2_, for the AES-ECB contexts of batches.
+  crypto::tink::util::SecretData key_;
   uint8_t cmac_k1_[BLOCK_SIZE];
   uint8_t cmac_k2_[BLOCK_SIZE];
+  // dbl(CMAC(0)), the first step of every S2V.
+  uint8_t cmac_zero_x_[BLOCK_SIZE];
 };
 
 }  // namespace subtle
@@ -16,9 +16,11 @@
 
 #include "tink/subtle/aes_siv_boringssl.h"
 
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "tink/subtle/batch_deterministic_aead.h"
 #include "tink/subtle/wycheproof_util.h"
 #include "tink/util/status.h"
 #include "tink/util/statusor.h"
@@ -167,6 +169,152 @@ TEST(AesSivBoringSslTest, testDecryptModification) {
   }
 }
 
+const BatchDeterministicAead* AsBatch(const DeterministicAead& daead) {
+  return dynamic_cast<const BatchDeterministicAead*>(&daead);
+}
+
+std::unique_ptr<DeterministicAead> NewTestAesSiv() {
+  std::string key(test::HexDecodeOrDie(
+      "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"
+      "00112233445566778899aabbccddeefff0f1f2f3f4f5f6f7f8f9fafbfcfdfeff"));
+  return std::move(AesSivBoringSsl::New(key).ValueOrDie());
+}
+
+// Returns a column whose values have the given sizes, starting at 'base'
+// (like a slice of an Arrow array).
+std::string NewColumn(const std::vector<size_t>& sizes, int64_t base,
+                      std::vector<int64_t>* offsets) {
+  std::string data(base, 'x');
+  offsets->assign(1, base);
+  for (size_t i = 0; i < sizes.size(); i++) {
+    for (size_t j = 0; j < sizes[i]; j++) {
+      data.push_back(static_cast<char>(i * 31 + j * 7));
+    }
+    offsets->push_back(data.size());
+  }
+  return data;
+}
+
+absl::string_view Value(absl::string_view data,
+                        const std::vector<int64_t>& offsets, size_t i) {
+  return data.substr(offsets[i], offsets[i + 1] - offsets[i]);
+}
+
+TEST(AesSivBoringSslTest, testBatchMatchesSingleValues) {
+  auto cipher = NewTestAesSiv();
+  const BatchDeterministicAead* batch = AsBatch(*cipher);
+  ASSERT_NE(nullptr, batch);
+  std::vector<size_t> sizes;
+  for (size_t size = 0; size < 70; size++) sizes.push_back(size);
+  // Long values are mixed with short ones, and need more than one
+  // key stream batch.
+  sizes.insert(sizes.begin() + 10, 1000);
+  sizes.push_back(5000);
+  sizes.push_back(3);
+  std::string aad = "Additional data";
+  for (int64_t base : {0, 5}) {
+    std::vector<int64_t> offsets;
+    std::string plaintexts = NewColumn(sizes, base, &offsets);
+    std::string ciphertexts;
+    std::vector<int64_t> ciphertext_offsets;
+    auto status = batch->EncryptDeterministicallyBatch(
+        plaintexts, offsets, aad, &ciphertexts, &ciphertext_offsets);
+    ASSERT_TRUE(status.ok()) << status;
+    ASSERT_EQ(offsets.size(), ciphertext_offsets.size());
+    EXPECT_EQ(0, ciphertext_offsets[0]);
+    EXPECT_EQ(ciphertexts.size(), ciphertext_offsets.back());
+    for (size_t i = 0; i < sizes.size(); i++) {
+      auto ct = cipher->EncryptDeterministically(
+          Value(plaintexts, offsets, i), aad);
+      ASSERT_TRUE(ct.ok()) << ct.status();
+      EXPECT_EQ(test::HexEncode(ct.ValueOrDie()),
+                test::HexEncode(Value(ciphertexts, ciphertext_offsets, i)))
+          << "value " << i << " of size " << sizes[i];
+    }
+
+    std::string decrypted;
+    std::vector<int64_t> decrypted_offsets;
+    status = batch->DecryptDeterministicallyBatch(
+        ciphertexts, ciphertext_offsets, aad, &decrypted, &decrypted_offsets);
+    ASSERT_TRUE(status.ok()) << status;
+    ASSERT_EQ(offsets.size(), decrypted_offsets.size());
+    for (size_t i = 0; i < sizes.size(); i++) {
+      EXPECT_EQ(Value(plaintexts, offsets, i),
+                Value(decrypted, decrypted_offsets, i));
+    }
+  }
+}
+
+TEST(AesSivBoringSslTest, testBatchEmptyColumns) {
+  auto cipher = NewTestAesSiv();
+  const BatchDeterministicAead* batch = AsBatch(*cipher);
+  std::string output = "old content";
+  std::vector<int64_t> output_offsets = {1, 2, 3};
+  std::vector<int64_t> no_values = {0};
+  EXPECT_TRUE(batch->EncryptDeterministicallyBatch("", no_values, "aad",
+                                                  &output, &output_offsets)
+                  .ok());
+  EXPECT_EQ("", output);
+  EXPECT_EQ(no_values, output_offsets);
+  EXPECT_TRUE(batch->DecryptDeterministicallyBatch("", no_values, "aad",
+                                                  &output, &output_offsets)
+                  .ok());
+  EXPECT_EQ("", output);
+  EXPECT_EQ(no_values, output_offsets);
+}
+
+TEST(AesSivBoringSslTest, testBatchInvalidOffsets) {
+  auto cipher = NewTestAesSiv();
+  const BatchDeterministicAead* batch = AsBatch(*cipher);
+  std::string output;
+  std::vector<int64_t> output_offsets;
+  std::string data(40, 'a');
+  for (const std::vector<int64_t>& offsets :
+       std::vector<std::vector<int64_t>>{{-1, 10}, {0, 41}, {20, 10, 30}}) {
+    EXPECT_FALSE(batch->EncryptDeterministicallyBatch(data, offsets, "aad",
+                                                     &output, &output_offsets)
+                     .ok());
+    EXPECT_FALSE(batch->DecryptDeterministicallyBatch(data, offsets, "aad",
+                                                     &output, &output_offsets)
+                     .ok());
+  }
+  // Ciphertexts have at least 16 bytes.
+  std::vector<int64_t> offsets = {0, 20, 35};
+  EXPECT_FALSE(batch->DecryptDeterministicallyBatch(data, offsets, "aad",
+                                                   &output, &output_offsets)
+                   .ok());
+}
+
+TEST(AesSivBoringSslTest, testBatchDecryptModification) {
+  auto cipher = NewTestAesSiv();
+  const BatchDeterministicAead* batch = AsBatch(*cipher);
+  std::vector<int64_t> offsets;
+  std::string plaintexts = NewColumn({5, 20, 0, 33}, 0, &offsets);
+  std::string ciphertexts;
+  std::vector<int64_t> ciphertext_offsets;
+  ASSERT_TRUE(batch
+                  ->EncryptDeterministicallyBatch(plaintexts, offsets, "aad",
+                                                  &ciphertexts,
+                                                  &ciphertext_offsets)
+                  .ok());
+  std::string decrypted;
+  std::vector<int64_t> decrypted_offsets;
+  EXPECT_FALSE(batch
+                   ->DecryptDeterministicallyBatch(
+                       ciphertexts, ciphertext_offsets, "other aad",
+                       &decrypted, &decrypted_offsets)
+                   .ok());
+  for (size_t i = 0; i < ciphertexts.size(); i++) {
+    std::string modified = ciphertexts;
+    modified[i] ^= 1;
+    auto status = batch->DecryptDeterministicallyBatch(
+        modified, ciphertext_offsets, "aad", &decrypted, &decrypted_offsets);
+    EXPECT_FALSE(status.ok()) << "modified byte " << i;
+    EXPECT_TRUE(decrypted.empty());
+    EXPECT_TRUE(decrypted_offsets.empty());
+  }
+}
+
 // Test with test vectors from project Wycheproof.
 void WycheproofTest(const rapidjson::Document &root) {
   for (const rapidjson::Value& test_group : root["testGroups"].GetArray()) {
@@ -0,0 +1,75 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_SUBTLE_BATCH_DETERMINISTIC_AEAD_H_
+#define TINK_SUBTLE_BATCH_DETERMINISTIC_AEAD_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "tink/util/status.h"
+
+namespace crypto {
+namespace tink {
+namespace subtle {
+
+// Optional interface of the deterministic AEAD primitives in tink/subtle
+// that can process a whole column of values at once, e.g. to tokenize a
+// column of a table.  It is implemented by AesSivBoringSsl, and can be
+// reached from the DeterministicAead returned by its New() with
+//
+//   auto batch = dynamic_cast<const BatchDeterministicAead*>(daead.get());
+//
+// Columns are in the layout of Arrow's (large) binary arrays: value i of
+// a column with the offsets 'offsets' is
+//
+//   data.substr(offsets[i], offsets[i + 1] - offsets[i])
+//
+// for 0 <= i < offsets.size() - 1, where the offsets are non-decreasing
+// and within 'data'.  All the values of a column are processed with the
+// same associated data, and the outputs are the same as those of
+// EncryptDeterministically() and DecryptDeterministically() on each value.
+class BatchDeterministicAead {
+ public:
+  // Encrypts the values of the column ('plaintexts', 'plaintext_offsets')
+  // into the column ('*ciphertexts', '*ciphertext_offsets'), replacing
+  // the content of the latter.
+  virtual crypto::tink::util::Status EncryptDeterministicallyBatch(
+      absl::string_view plaintexts, absl::Span<const int64_t> plaintext_offsets,
+      absl::string_view associated_data, std::string* ciphertexts,
+      std::vector<int64_t>* ciphertext_offsets) const = 0;
+
+  // Decrypts the values of the column ('ciphertexts', 'ciphertext_offsets')
+  // into the column ('*plaintexts', '*plaintext_offsets'), replacing the
+  // content of the latter.  Fails, leaving both outputs empty, if any of
+  // the values cannot be decrypted.
+  virtual crypto::tink::util::Status DecryptDeterministicallyBatch(
+      absl::string_view ciphertexts,
+      absl::Span<const int64_t> ciphertext_offsets,
+      absl::string_view associated_data, std::string* plaintexts,
+      std::vector<int64_t>* plaintext_offsets) const = 0;
+
+  virtual ~BatchDeterministicAead() {}
+};
+
+}  // namespace subtle
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_SUBTLE_BATCH_DETERMINISTIC_AEAD_H_
@@ -0,0 +1,279 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/subtle/buffer_pool.h"
+
+#include <atomic>
+#include <unordered_map>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/synchronization/mutex.h"
+#include "openssl/mem.h"
+
+namespace crypto {
+namespace tink {
+namespace subtle {
+
+namespace {
+
+std::atomic<uint64_t> next_pool_id(0);
+
+// The pools that have not been destroyed, by id, so that an exiting thread
+// only hands its free lists back to pools that still exist.
+absl::Mutex* LivePoolsMutex() {
+  static absl::Mutex* mutex = new absl::Mutex();
+  return mutex;
+}
+
+std::unordered_map<uint64_t, BufferPool*>* LivePools() {
+  static auto* pools = new std::unordered_map<uint64_t, BufferPool*>();
+  return pools;
+}
+
+// Set when the ThreadFreeLists of the current thread has been destroyed;
+// buffers released after that (e.g. by other thread_local objects) bypass
+// the free lists of the thread.
+thread_local bool thread_free_lists_destroyed = false;
+
+}  // namespace
+
+PooledBuffer::PooledBuffer(PooledBuffer&& other)
+    : pool_(other.pool_),
+      data_(other.data_),
+      size_(other.size_),
+      capacity_(other.capacity_) {
+  other.pool_ = nullptr;
+  other.data_ = nullptr;
+  other.size_ = 0;
+  other.capacity_ = 0;
+}
+
+PooledBuffer& PooledBuffer::operator=(PooledBuffer&& other) {
+  if (this != &other) {
+    Release();
+    pool_ = other.pool_;
+    data_ = other.data_;
+    size_ = other.size_;
+    capacity_ = other.capacity_;
+    other.pool_ = nullptr;
+    other.data_ = nullptr;
+    other.size_ = 0;
+    other.capacity_ = 0;
+  }
+  return *this;
+}
+
+void PooledBuffer::resize(size_t size) {
+  if (size > capacity_) size = capacity_;
+  size_ = size;
+}
+
+void PooledBuffer::Release() {
+  if (data_ == nullptr) return;
+  // The whole capacity is zeroed, since the buffer may have been larger
+  // before the last resize().
+  OPENSSL_cleanse(data_, capacity_);
+  if (pool_ != nullptr) {
+    pool_->Return(data_, capacity_);
+  } else {
+    delete[] data_;
+  }
+  pool_ = nullptr;
+  data_ = nullptr;
+  size_ = 0;
+  capacity_ = 0;
+}
+
+constexpr int BufferPool::kMinSizeClass;
+constexpr int BufferPool::kMaxSizeClass;
+constexpr size_t BufferPool::kDefaultMaxBuffersPerClass;
+constexpr int BufferPool::kNumSizeClasses;
+
+class BufferPool::ThreadFreeLists {
+ public:
+  ~ThreadFreeLists() {
+    thread_free_lists_destroyed = true;
+    // Holding LivePoolsMutex() keeps the pools from being destroyed while
+    // their free lists are released.
+    absl::MutexLock lock(LivePoolsMutex());
+    for (const auto& entry : by_pool_id_) {
+      auto pool = LivePools()->find(entry.first);
+      // A destroyed pool has already freed the free lists.
+      if (pool != LivePools()->end()) {
+        pool->second->ReleaseFreeLists(entry.second);
+      }
+    }
+  }
+
+  // The free lists are owned by the pools.
+  std::unordered_map<uint64_t, FreeLists*> by_pool_id_;
+};
+
+BufferPool::BufferPool(size_t max_buffers_per_class)
+    : id_(next_pool_id.fetch_add(1)),
+      max_buffers_per_class_(max_buffers_per_class),
+      shared_count_(0) {
+  absl::MutexLock lock(LivePoolsMutex());
+  (*LivePools())[id_] = this;
+}
+
+BufferPool::~BufferPool() {
+  {
+    absl::MutexLock lock(LivePoolsMutex());
+    LivePools()->erase(id_);
+  }
+  absl::MutexLock lock(&free_lists_mutex_);
+  for (auto& free_lists : free_lists_) {
+    for (auto& buffers : free_lists->buffers) {
+      for (uint8_t* data : buffers) delete[] data;
+    }
+  }
+  for (auto& buffers : shared_.buffers) {
+    for (uint8_t* data : buffers) delete[] data;
+  }
+}
+
+// static
+BufferPool* BufferPool::Default() {
+  static BufferPool* pool = new BufferPool(kDefaultMaxBuffersPerClass);
+  return pool;
+}
+
+// static
+int BufferPool::SizeClass(size_t size) {
+  int size_class = kMinSizeClass;
+  while (size_class <= kMaxSizeClass &&
+         (static_cast<size_t>(1) << size_class) < size) {
+    size_class++;
+  }
+  return size_class;
+}
+
+PooledBuffer BufferPool::Get(size_t size) {
+  int size_class = SizeClass(size);
+  if (size_class > kMaxSizeClass) {
+    return PooledBuffer(nullptr, new uint8_t[size], size, size);
+  }
+  size_t capacity = static_cast<size_t>(1) << size_class;
+  int index = size_class - kMinSizeClass;
+  uint8_t* data = nullptr;
+  FreeLists* free_lists = GetFreeListsForCurrentThread();
+  if (free_lists != nullptr && !free_lists->buffers[index].empty()) {
+    std::vector<uint8_t*>& buffers = free_lists->buffers[index];
+    data = buffers.back();
+    buffers.pop_back();
+    free_lists->cached_bytes.store(
+        free_lists->cached_bytes.load(std::memory_order_relaxed) - capacity,
+        std::memory_order_relaxed);
+  } else {
+    data = TakeShared(index);
+  }
+  if (data == nullptr) data = new uint8_t[capacity];
+  return PooledBuffer(this, data, size, capacity);
+}
+
+void BufferPool::Return(uint8_t* data, size_t capacity) {
+  // 'capacity' is a power of two, so this is the class it was taken from.
+  int index = SizeClass(capacity) - kMinSizeClass;
+  FreeLists* free_lists = GetFreeListsForCurrentThread();
+  if (free_lists == nullptr) {
+    absl::MutexLock lock(&free_lists_mutex_);
+    ReturnShared(data, index);
+    return;
+  }
+  std::vector<uint8_t*>& buffers = free_lists->buffers[index];
+  if (buffers.size() < max_buffers_per_class_) {
+    buffers.push_back(data);
+    free_lists->cached_bytes.store(
+        free_lists->cached_bytes.load(std::memory_order_relaxed) + capacity,
+        std::memory_order_relaxed);
+  } else {
+    delete[] data;
+  }
+}
+
+uint8_t* BufferPool::TakeShared(int index) {
+  if (shared_count_.load(std::memory_order_relaxed) == 0) return nullptr;
+  absl::MutexLock lock(&free_lists_mutex_);
+  std::vector<uint8_t*>& buffers = shared_.buffers[index];
+  if (buffers.empty()) return nullptr;
+  uint8_t* data = buffers.back();
+  buffers.pop_back();
+  shared_count_.fetch_sub(1, std::memory_order_relaxed);
+  shared_.cached_bytes.fetch_sub(static_cast<size_t>(1)
+                                     << (index + kMinSizeClass),
+                                 std::memory_order_relaxed);
+  return data;
+}
+
+void BufferPool::ReturnShared(uint8_t* data, int index) {
+  std::vector<uint8_t*>& buffers = shared_.buffers[index];
+  if (buffers.size() < max_buffers_per_class_) {
+    buffers.push_back(data);
+    shared_count_.fetch_add(1, std::memory_order_relaxed);
+    shared_.cached_bytes.fetch_add(static_cast<size_t>(1)
+                                       << (index + kMinSizeClass),
+                                   std::memory_order_relaxed);
+  } else {
+    delete[] data;
+  }
+}
+
+void BufferPool::ReleaseFreeLists(FreeLists* free_lists) {
+  absl::MutexLock lock(&free_lists_mutex_);
+  for (int index = 0; index < kNumSizeClasses; index++) {
+    for (uint8_t* data : free_lists->buffers[index]) {
+      ReturnShared(data, index);
+    }
+  }
+  for (auto it = free_lists_.begin(); it != free_lists_.end(); ++it) {
+    if (it->get() == free_lists) {
+      free_lists_.erase(it);
+      break;
+    }
+  }
+}
+
+BufferPool::FreeLists* BufferPool::GetFreeListsForCurrentThread() {
+  if (thread_free_lists_destroyed) return nullptr;
+  thread_local ThreadFreeLists thread_free_lists;
+  auto found = thread_free_lists.by_pool_id_.find(id_);
+  if (found != thread_free_lists.by_pool_id_.end()) return found->second;
+  auto free_lists = absl::make_unique<FreeLists>();
+  FreeLists* result = free_lists.get();
+  {
+    absl::MutexLock lock(&free_lists_mutex_);
+    free_lists_.push_back(std::move(free_lists));
+  }
+  thread_free_lists.by_pool_id_[id_] = result;
+  return result;
+}
+
+BufferPool::Stats BufferPool::GetStats() const {
+  absl::MutexLock lock(&free_lists_mutex_);
+  Stats stats = {shared_.cached_bytes.load(std::memory_order_relaxed),
+                 static_cast<int64_t>(free_lists_.size())};
+  for (const auto& free_lists : free_lists_) {
+    stats.cached_bytes +=
+        free_lists->cached_bytes.load(std::memory_order_relaxed);
+  }
+  return stats;
+}
+
+}  // namespace subtle
+}  // namespace tink
+}  // namespace crypto
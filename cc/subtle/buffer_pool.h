@@ -0,0 +1,178 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_SUBTLE_BUFFER_POOL_H_
+#define TINK_SUBTLE_BUFFER_POOL_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+
+namespace crypto {
+namespace tink {
+namespace subtle {
+
+class BufferPool;
+
+// A buffer of bytes taken from a BufferPool.  When the buffer is
+// destroyed, its content is zeroed and the memory goes back to the pool,
+// so that the next buffer of the same size class is taken without a heap
+// allocation.  A PooledBuffer must not outlive its pool.
+class PooledBuffer {
+ public:
+  // An empty buffer, which does not belong to any pool.
+  PooledBuffer() : pool_(nullptr), data_(nullptr), size_(0), capacity_(0) {}
+
+  PooledBuffer(PooledBuffer&& other);
+  PooledBuffer& operator=(PooledBuffer&& other);
+  PooledBuffer(const PooledBuffer&) = delete;
+  PooledBuffer& operator=(const PooledBuffer&) = delete;
+
+  ~PooledBuffer() { Release(); }
+
+  uint8_t* data() { return data_; }
+  const uint8_t* data() const { return data_; }
+  size_t size() const { return size_; }
+  size_t capacity() const { return capacity_; }
+
+  // Changes the size of the buffer, which must not exceed capacity().
+  // The content up to the smaller of the two sizes is kept.
+  void resize(size_t size);
+
+  absl::string_view AsStringView() const {
+    return absl::string_view(reinterpret_cast<const char*>(data_), size_);
+  }
+
+ private:
+  friend class BufferPool;
+
+  PooledBuffer(BufferPool* pool, uint8_t* data, size_t size, size_t capacity)
+      : pool_(pool), data_(data), size_(size), capacity_(capacity) {}
+
+  // Zeroes the content, and returns the memory to the pool.
+  void Release();
+
+  BufferPool* pool_;
+  uint8_t* data_;
+  size_t size_;
+  size_t capacity_;
+};
+
+// A pool of byte buffers for the outputs of the primitives in tink/subtle,
+// for callers that encrypt or decrypt many messages and want to avoid a
+// heap allocation of the size of the message per operation.
+//
+// The capacities of the buffers are powers of two, from 2^kMinSizeClass
+// to 2^kMaxSizeClass bytes; larger buffers are allocated and freed
+// directly.  Released buffers are kept on free lists of the releasing
+// thread, one per size class and with at most 'max_buffers_per_class'
+// buffers each, so that taking and returning buffers never contends
+// between threads.  When a thread exits, the buffers on its free lists
+// move to shared free lists of the pool, with the same bound per size
+// class, from which threads whose own free list is empty take them.  So
+// the cached memory is bounded by the number of live threads, whatever
+// the number of threads that have used the pool.
+class BufferPool {
+ public:
+  struct Stats {
+    // Bytes of the buffers on the free lists of all threads, including
+    // the shared free lists.
+    int64_t cached_bytes;
+    // Number of live threads that have free lists for this pool.
+    int64_t thread_count;
+  };
+
+  static constexpr int kMinSizeClass = 6;   // 64 bytes
+  static constexpr int kMaxSizeClass = 22;  // 4 MB
+  static constexpr size_t kDefaultMaxBuffersPerClass = 8;
+
+  explicit BufferPool(size_t max_buffers_per_class);
+  BufferPool(const BufferPool&) = delete;
+  BufferPool& operator=(const BufferPool&) = delete;
+
+  // Frees the cached buffers.  All the buffers taken from the pool must
+  // have been released.
+  ~BufferPool();
+
+  // Returns a pool shared by the whole process, which is never destroyed.
+  static BufferPool* Default();
+
+  // Returns a buffer of 'size' bytes, whose content is unspecified.
+  PooledBuffer Get(size_t size);
+
+  // Returns the size class of a buffer of 'size' bytes, i.e. the smallest
+  // n >= kMinSizeClass with 2^n >= size; larger than kMaxSizeClass if the
+  // buffer is not pooled.
+  static int SizeClass(size_t size);
+
+  Stats GetStats() const LOCKS_EXCLUDED(free_lists_mutex_);
+
+ private:
+  friend class PooledBuffer;
+
+  static constexpr int kNumSizeClasses = kMaxSizeClass - kMinSizeClass + 1;
+
+  // The free lists of one thread.  Only used by that thread, except in the
+  // destructor of the pool.
+  struct FreeLists {
+    std::vector<uint8_t*> buffers[kNumSizeClasses];
+    // Only written by the owning thread; read by GetStats().
+    std::atomic<int64_t> cached_bytes{0};
+  };
+
+  // The free lists of the current thread for all the pools it has used,
+  // which go back to their pools when the thread exits.
+  class ThreadFreeLists;
+
+  // Returns nullptr while the current thread is exiting.
+  FreeLists* GetFreeListsForCurrentThread();
+  void Return(uint8_t* data, size_t capacity);
+
+  // Takes a buffer of the size class with the given index from shared_,
+  // or returns nullptr if there is none.
+  uint8_t* TakeShared(int index) LOCKS_EXCLUDED(free_lists_mutex_);
+  // Puts a buffer on shared_, or frees it if the list is full.
+  void ReturnShared(uint8_t* data, int index)
+      EXCLUSIVE_LOCKS_REQUIRED(free_lists_mutex_);
+  // Moves the buffers of an exiting thread to shared_, and frees
+  // 'free_lists'.
+  void ReleaseFreeLists(FreeLists* free_lists)
+      LOCKS_EXCLUDED(free_lists_mutex_);
+
+  const uint64_t id_;
+  const size_t max_buffers_per_class_;
+
+  mutable absl::Mutex free_lists_mutex_;
+  std::vector<std::unique_ptr<FreeLists>> free_lists_
+      GUARDED_BY(free_lists_mutex_);
+  // The buffers of threads that have exited.
+  FreeLists shared_ GUARDED_BY(free_lists_mutex_);
+  // The number of buffers on shared_, so that Get() only locks
+  // free_lists_mutex_ if there is one.
+  std::atomic<int64_t> shared_count_;
+};
+
+}  // namespace subtle
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_SUBTLE_BUFFER_POOL_H_
@@ -0,0 +1,195 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/subtle/buffer_pool.h"
+
+#include <cstring>
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/synchronization/notification.h"
+
+namespace crypto {
+namespace tink {
+namespace subtle {
+namespace {
+
+TEST(BufferPoolTest, SizeClass) {
+  EXPECT_EQ(BufferPool::kMinSizeClass, BufferPool::SizeClass(0));
+  EXPECT_EQ(BufferPool::kMinSizeClass, BufferPool::SizeClass(64));
+  EXPECT_EQ(7, BufferPool::SizeClass(65));
+  EXPECT_EQ(10, BufferPool::SizeClass(1024));
+  EXPECT_EQ(BufferPool::kMaxSizeClass,
+            BufferPool::SizeClass(size_t{1} << BufferPool::kMaxSizeClass));
+  EXPECT_LT(BufferPool::kMaxSizeClass,
+            BufferPool::SizeClass((size_t{1} << BufferPool::kMaxSizeClass) +
+                                  1));
+}
+
+TEST(BufferPoolTest, GetAndResize) {
+  BufferPool pool(4);
+  PooledBuffer buffer = pool.Get(100);
+  EXPECT_EQ(100, buffer.size());
+  EXPECT_EQ(128, buffer.capacity());
+  memset(buffer.data(), 'a', buffer.size());
+  buffer.resize(3);
+  EXPECT_EQ("aaa", buffer.AsStringView());
+  buffer.resize(1000);
+  EXPECT_EQ(128, buffer.size());
+
+  PooledBuffer empty = pool.Get(0);
+  EXPECT_EQ(0, empty.size());
+  EXPECT_NE(nullptr, empty.data());
+}
+
+TEST(BufferPoolTest, ReleasedBuffersAreZeroedAndReused) {
+  BufferPool pool(4);
+  uint8_t* data;
+  {
+    PooledBuffer buffer = pool.Get(1000);
+    data = buffer.data();
+    memset(data, 0xff, buffer.size());
+    // Shrinking must not keep the rest of the content from being zeroed.
+    buffer.resize(10);
+  }
+  PooledBuffer buffer = pool.Get(600);
+  ASSERT_EQ(data, buffer.data());
+  for (size_t i = 0; i < buffer.capacity(); i++) {
+    ASSERT_EQ(0, buffer.data()[i]) << "at " << i;
+  }
+  // Another size class gets another buffer.
+  PooledBuffer other = pool.Get(100);
+  EXPECT_NE(data, other.data());
+}
+
+TEST(BufferPoolTest, MaxBuffersPerClass) {
+  BufferPool pool(2);
+  std::vector<PooledBuffer> buffers;
+  for (int i = 0; i < 3; i++) buffers.push_back(pool.Get(64));
+  std::vector<const uint8_t*> data;
+  for (const auto& buffer : buffers) data.push_back(buffer.data());
+  // Only the first two released buffers are kept.
+  buffers.clear();
+  PooledBuffer first = pool.Get(64);
+  PooledBuffer second = pool.Get(64);
+  EXPECT_EQ(data[1], first.data());
+  EXPECT_EQ(data[0], second.data());
+}
+
+TEST(BufferPoolTest, LargeBuffersAreNotPooled) {
+  BufferPool pool(4);
+  size_t size = (size_t{1} << BufferPool::kMaxSizeClass) + 1;
+  PooledBuffer buffer = pool.Get(size);
+  EXPECT_EQ(size, buffer.size());
+  EXPECT_EQ(size, buffer.capacity());
+  buffer.data()[size - 1] = 1;
+}
+
+TEST(BufferPoolTest, Move) {
+  BufferPool pool(4);
+  PooledBuffer buffer = pool.Get(10);
+  uint8_t* data = buffer.data();
+  PooledBuffer moved(std::move(buffer));
+  EXPECT_EQ(data, moved.data());
+  EXPECT_EQ(10, moved.size());
+  EXPECT_EQ(nullptr, buffer.data());  // NOLINT(bugprone-use-after-move)
+  EXPECT_EQ(0, buffer.size());        // NOLINT(bugprone-use-after-move)
+
+  PooledBuffer assigned = pool.Get(20);
+  uint8_t* released = assigned.data();
+  assigned = std::move(moved);
+  EXPECT_EQ(data, assigned.data());
+  // The buffer replaced by the assignment went back to the pool.
+  EXPECT_EQ(released, pool.Get(30).data());
+}
+
+TEST(BufferPoolTest, FreeListsArePerThread) {
+  BufferPool pool(4);
+  uint8_t* data = pool.Get(64).data();
+  std::thread thread([&pool, data]() {
+    // The buffer released by the main thread is not on this thread's list.
+    PooledBuffer buffer = pool.Get(64);
+    EXPECT_NE(data, buffer.data());
+  });
+  thread.join();
+  EXPECT_EQ(data, pool.Get(64).data());
+}
+
+TEST(BufferPoolTest, BuffersOfExitedThreadsAreReused) {
+  BufferPool pool(4);
+  uint8_t* data;
+  std::thread thread([&pool, &data]() { data = pool.Get(64).data(); });
+  thread.join();
+  BufferPool::Stats stats = pool.GetStats();
+  EXPECT_EQ(64, stats.cached_bytes);
+  EXPECT_EQ(0, stats.thread_count);
+  // The main thread has no buffer of its own, and takes the shared one.
+  EXPECT_EQ(data, pool.Get(64).data());
+}
+
+TEST(BufferPoolTest, FootprintIsBoundedUnderThreadChurn) {
+  constexpr size_t kMaxBuffersPerClass = 2;
+  BufferPool pool(kMaxBuffersPerClass);
+  const std::vector<size_t> sizes = {64, 1000, 100000};
+  int64_t max_cached_bytes = 0;
+  for (size_t size : sizes) {
+    max_cached_bytes += kMaxBuffersPerClass
+                        << BufferPool::SizeClass(size);
+  }
+  for (int round = 0; round < 50; round++) {
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+      threads.emplace_back([&pool, &sizes]() {
+        std::vector<PooledBuffer> buffers;
+        for (int i = 0; i < 4; i++) {
+          for (size_t size : sizes) buffers.push_back(pool.Get(size));
+        }
+      });
+    }
+    for (auto& thread : threads) thread.join();
+    BufferPool::Stats stats = pool.GetStats();
+    ASSERT_EQ(0, stats.thread_count) << "round " << round;
+    ASSERT_LE(stats.cached_bytes, max_cached_bytes) << "round " << round;
+  }
+}
+
+TEST(BufferPoolTest, ThreadsMayOutliveThePool) {
+  std::unique_ptr<BufferPool> pool(new BufferPool(4));
+  absl::Notification pool_destroyed;
+  std::thread thread([&pool, &pool_destroyed]() {
+    pool->Get(64);
+    pool_destroyed.WaitForNotification();
+  });
+  while (pool->GetStats().thread_count == 0) std::this_thread::yield();
+  pool.reset();
+  pool_destroyed.Notify();
+  thread.join();
+}
+
+TEST(BufferPoolTest, Default) {
+  EXPECT_NE(nullptr, BufferPool::Default());
+  EXPECT_EQ(BufferPool::Default(), BufferPool::Default());
+  PooledBuffer buffer = BufferPool::Default()->Get(16);
+  EXPECT_EQ(16, buffer.size());
+}
+
+}  // namespace
+}  // namespace subtle
+}  // namespace tink
+}  // namespace crypto
@@ -120,23 +120,23 @@ EcdsaSignBoringSsl::EcdsaSignBoringSsl(bssl::UniquePtr<EC_KEY> key,
 
 util::StatusOr<std::string> EcdsaSignBoringSsl::Sign(
     absl::string_view data) const {
-  // BoringSSL expects a non-null pointer for data,
-  // regardless of whether the size is 0.
-  data = SubtleUtilBoringSSL::EnsureNonNull(data);
+  return SignMultipart(absl::MakeConstSpan(&data, 1));
+}
 
+util::StatusOr<std::string> EcdsaSignBoringSsl::SignMultipart(
+    absl::Span<const absl::string_view> data_pieces) const {
   // Compute the digest.
-  unsigned int digest_size;
-  uint8_t digest[EVP_MAX_MD_SIZE];
-  if (1 != EVP_Digest(data.data(), data.size(), digest, &digest_size, hash_,
-                  nullptr)) {
+  auto digest_result = boringssl::ComputeHash(data_pieces, *hash_);
+  if (!digest_result.ok()) {
     return util::Status(util::error::INTERNAL, "Could not compute digest.");
   }
+  const std::vector<uint8_t>& digest = digest_result.ValueOrDie();
 
   // Compute the signature.
   std::vector<uint8_t> buffer(ECDSA_size(key_.get()));
   unsigned int sig_length;
-  if (1 != ECDSA_sign(0 /* unused */, digest, digest_size, buffer.data(),
-                  &sig_length, key_.get())) {
+  if (1 != ECDSA_sign(0 /* unused */, digest.data(), digest.size(),
+                      buffer.data(), &sig_length, key_.get())) {
     return util::Status(util::error::INTERNAL, "Signing failed.");
   }
 
@@ -20,6 +20,7 @@
 #include <memory>
 
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "tink/subtle/common_enums.h"
 #include "tink/subtle/subtle_util_boringssl.h"
 #include "tink/public_key_sign.h"
@@ -42,6 +43,11 @@ class EcdsaSignBoringSsl : public PublicKeySign {
   crypto::tink::util::StatusOr<std::string> Sign(
       absl::string_view data) const override;
 
+  // Computes the signature for the concatenation of 'data_pieces',
+  // hashing the pieces incrementally.
+  crypto::tink::util::StatusOr<std::string> SignMultipart(
+      absl::Span<const absl::string_view> data_pieces) const override;
+
   virtual ~EcdsaSignBoringSsl() {}
 
  private:
@@ -74,6 +74,28 @@ TEST_F(EcdsaSignBoringSslTest, testBasicSigning) {
   }
 }
 
+TEST_F(EcdsaSignBoringSslTest, testMultipartSigning) {
+  auto ec_key = SubtleUtilBoringSSL::GetNewEcKey(EllipticCurveType::NIST_P256)
+                    .ValueOrDie();
+  auto signer = std::move(
+      EcdsaSignBoringSsl::New(ec_key, HashType::SHA256,
+                              EcdsaSignatureEncoding::DER).ValueOrDie());
+  auto verifier = std::move(
+      EcdsaVerifyBoringSsl::New(ec_key, HashType::SHA256,
+                                EcdsaSignatureEncoding::DER).ValueOrDie());
+
+  std::string message = "some data to be signed";
+  absl::string_view head = absl::string_view(message).substr(0, 4);
+  absl::string_view tail = absl::string_view(message).substr(4);
+  std::string signature = signer->SignMultipart({head, tail}).ValueOrDie();
+  EXPECT_TRUE(verifier->Verify(signature, message).ok());
+  EXPECT_TRUE(verifier->VerifyMultipart(signature, {head, "", tail}).ok());
+  EXPECT_FALSE(verifier->VerifyMultipart(signature, {tail, head}).ok());
+
+  signature = signer->Sign(message).ValueOrDie();
+  EXPECT_TRUE(verifier->VerifyMultipart(signature, {head, tail}).ok());
+}
+
 TEST_F(EcdsaSignBoringSslTest, testEncodingsMismatch) {
   subtle::EcdsaSignatureEncoding encodings[2] = {
       EcdsaSignatureEncoding::DER, EcdsaSignatureEncoding::IEEE_P1363};
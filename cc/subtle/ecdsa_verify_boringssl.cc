@@ -16,6 +16,8 @@
 
 #include "tink/subtle/ecdsa_verify_boringssl.h"
 
+#include <vector>
+
 #include "absl/strings/str_cat.h"
 #include "openssl/bn.h"
 #include "openssl/ec.h"
@@ -128,17 +130,18 @@ EcdsaVerifyBoringSsl::EcdsaVerifyBoringSsl(EC_KEY* key, const EVP_MD* hash,
 util::Status EcdsaVerifyBoringSsl::Verify(
     absl::string_view signature,
     absl::string_view data) const {
-  // BoringSSL expects a non-null pointer for data,
-  // regardless of whether the size is 0.
-  data = SubtleUtilBoringSSL::EnsureNonNull(data);
+  return VerifyMultipart(signature, absl::MakeConstSpan(&data, 1));
+}
 
+util::Status EcdsaVerifyBoringSsl::VerifyMultipart(
+    absl::string_view signature,
+    absl::Span<const absl::string_view> data_pieces) const {
   // Compute the digest.
-  unsigned int digest_size;
-  uint8_t digest[EVP_MAX_MD_SIZE];
-  if (1 != EVP_Digest(data.data(), data.size(), digest, &digest_size, hash_,
-                  nullptr)) {
+  auto digest_result = boringssl::ComputeHash(data_pieces, *hash_);
+  if (!digest_result.ok()) {
     return util::Status(util::error::INTERNAL, "Could not compute digest.");
   }
+  const std::vector<uint8_t>& digest = digest_result.ValueOrDie();
 
   std::string derSig(signature);
   if (encoding_ == subtle::EcdsaSignatureEncoding::IEEE_P1363) {
@@ -150,7 +153,7 @@ util::Status EcdsaVerifyBoringSsl::Verify(
   }
 
   // Verify the signature.
-  if (1 != ECDSA_verify(0 /* unused */, digest, digest_size,
+  if (1 != ECDSA_verify(0 /* unused */, digest.data(), digest.size(),
                         reinterpret_cast<const uint8_t*>(derSig.data()),
                         derSig.size(), key_.get())) {
     // signature is invalid
@@ -20,6 +20,7 @@
 #include <memory>
 
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "tink/subtle/common_enums.h"
 #include "tink/subtle/subtle_util_boringssl.h"
 #include "tink/public_key_verify.h"
@@ -47,6 +48,12 @@ class EcdsaVerifyBoringSsl : public PublicKeyVerify {
       absl::string_view signature,
       absl::string_view data) const override;
 
+  // Verifies the signature of the concatenation of 'data_pieces',
+  // hashing the pieces incrementally.
+  crypto::tink::util::Status VerifyMultipart(
+      absl::string_view signature,
+      absl::Span<const absl::string_view> data_pieces) const override;
+
   virtual ~EcdsaVerifyBoringSsl() {}
 
  private:
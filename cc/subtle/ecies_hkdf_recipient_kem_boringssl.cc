@@ -21,6 +21,7 @@
 #include "tink/subtle/hkdf.h"
 #include "tink/subtle/subtle_util_boringssl.h"
 #include "tink/util/errors.h"
+#include "tink/util/secret_data.h"
 #include "openssl/bn.h"
 #include "openssl/ec.h"
 
@@ -45,9 +46,10 @@ EciesHkdfRecipientKemBoringSsl::New(
 
 EciesHkdfRecipientKemBoringSsl::EciesHkdfRecipientKemBoringSsl(
     EllipticCurveType curve, const std::string& priv_key_value)
-    : curve_(curve), priv_key_value_(priv_key_value) {}
+    : curve_(curve),
+      priv_key_value_(util::SecretDataFromStringView(priv_key_value)) {}
 
-util::StatusOr<std::string> EciesHkdfRecipientKemBoringSsl::GenerateKey(
+util::StatusOr<util::SecretData> EciesHkdfRecipientKemBoringSsl::GenerateKey(
     absl::string_view kem_bytes,
     HashType hash,
     absl::string_view hkdf_salt,
@@ -64,16 +66,17 @@ util::StatusOr<std::string> EciesHkdfRecipientKemBoringSsl::GenerateKey(
   bssl::UniquePtr<EC_POINT> pub_key =
       std::move(status_or_ec_point.ValueOrDie());
   bssl::UniquePtr<BIGNUM> priv_key(
-      BN_bin2bn(reinterpret_cast<const unsigned char*>(priv_key_value_.data()),
-                priv_key_value_.size(), nullptr));
+      BN_bin2bn(priv_key_value_.data(), priv_key_value_.size(), nullptr));
   auto status_or_string = SubtleUtilBoringSSL::ComputeEcdhSharedSecret(
       curve_, priv_key.get(), pub_key.get());
   if (!status_or_string.ok()) {
     return status_or_string.status();
   }
-  std::string shared_secret(status_or_string.ValueOrDie());
-  return Hkdf::ComputeEciesHkdfSymmetricKey(
+  std::string& shared_secret = status_or_string.ValueOrDie();
+  auto symmetric_key = Hkdf::ComputeEciesHkdfSymmetricKey(
       hash, kem_bytes, shared_secret, hkdf_salt, hkdf_info, key_size_in_bytes);
+  util::SafeZeroString(&shared_secret);
+  return symmetric_key;
 }
 
 }  // namespace subtle
@@ -19,6 +19,7 @@
 
 #include "absl/strings/string_view.h"
 #include "tink/subtle/common_enums.h"
+#include "tink/util/secret_data.h"
 #include "tink/util/statusor.h"
 #include "openssl/ec.h"
 
@@ -39,7 +40,7 @@ class EciesHkdfRecipientKemBoringSsl {
   // Computes the ecdh's shared secret from our private key and peer's encoded
   // public key, then uses hkdf to derive the symmetric key from the shared
   // secret, hkdf info and hkdf salt.
-  crypto::tink::util::StatusOr<std::string> GenerateKey(
+  crypto::tink::util::StatusOr<crypto::tink::util::SecretData> GenerateKey(
       absl::string_view kem_bytes,
       HashType hash,
       absl::string_view hkdf_salt,
@@ -53,7 +54,7 @@ class EciesHkdfRecipientKemBoringSsl {
       const std::string& priv_key_value);
 
   EllipticCurveType curve_;
-  std::string priv_key_value_;
+  crypto::tink::util::SecretData priv_key_value_;
   bssl::UniquePtr<EC_GROUP> ec_group_;
 };
 
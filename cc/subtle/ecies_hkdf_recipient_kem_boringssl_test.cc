@@ -17,6 +17,7 @@
 #include "tink/subtle/ecies_hkdf_recipient_kem_boringssl.h"
 
 #include "tink/subtle/common_enums.h"
+#include "tink/util/secret_data.h"
 #include "tink/util/status.h"
 #include "tink/util/statusor.h"
 #include "tink/util/test_util.h"
@@ -62,7 +63,8 @@ TEST_F(EciesHkdfRecipientKemBoringSslTest, testBasic) {
             test.point_format);
     EXPECT_TRUE(status_or_string.ok());
 
-    EXPECT_EQ(test.out_key_hex, test::HexEncode(status_or_string.ValueOrDie()));
+    EXPECT_EQ(test.out_key_hex, test::HexEncode(util::SecretDataAsStringView(
+                                    status_or_string.ValueOrDie())));
   }
 }
 
@@ -20,6 +20,7 @@
 #include "tink/subtle/common_enums.h"
 #include "tink/subtle/hkdf.h"
 #include "tink/subtle/subtle_util_boringssl.h"
+#include "tink/util/secret_data.h"
 #include "openssl/bn.h"
 
 
@@ -27,15 +28,16 @@ namespace crypto {
 namespace tink {
 namespace subtle {
 
-EciesHkdfSenderKemBoringSsl::KemKey::KemKey(const std::string& kem_bytes,
-                                            const std::string& symmetric_key)
+EciesHkdfSenderKemBoringSsl::KemKey::KemKey(
+    const std::string& kem_bytes, const util::SecretData& symmetric_key)
     : kem_bytes_(kem_bytes), symmetric_key_(symmetric_key) {}
 
 std::string EciesHkdfSenderKemBoringSsl::KemKey::KemKey::get_kem_bytes() {
   return kem_bytes_;
 }
 
-std::string EciesHkdfSenderKemBoringSsl::KemKey::KemKey::get_symmetric_key() {
+const util::SecretData&
+EciesHkdfSenderKemBoringSsl::KemKey::KemKey::get_symmetric_key() {
   return symmetric_key_;
 }
 
@@ -97,14 +99,15 @@ EciesHkdfSenderKemBoringSsl::GenerateKey(
   if (!status_or_string_shared_secret.ok()) {
     return status_or_string_shared_secret.status();
   }
-  std::string shared_secret(status_or_string_shared_secret.ValueOrDie());
-  auto status_or_string_symmetric_key = Hkdf::ComputeEciesHkdfSymmetricKey(
+  std::string& shared_secret = status_or_string_shared_secret.ValueOrDie();
+  auto status_or_symmetric_key = Hkdf::ComputeEciesHkdfSymmetricKey(
       hash, kem_bytes, shared_secret, hkdf_salt, hkdf_info, key_size_in_bytes);
-  if (!status_or_string_symmetric_key.ok()) {
-    return status_or_string_symmetric_key.status();
+  util::SafeZeroString(&shared_secret);
+  if (!status_or_symmetric_key.ok()) {
+    return status_or_symmetric_key.status();
   }
-  std::string symmetric_key(status_or_string_symmetric_key.ValueOrDie());
-  auto kem_key = absl::make_unique<KemKey>(kem_bytes, symmetric_key);
+  auto kem_key = absl::make_unique<KemKey>(
+      kem_bytes, status_or_symmetric_key.ValueOrDie());
   return std::move(kem_key);
 }
 
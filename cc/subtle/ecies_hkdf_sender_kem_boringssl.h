@@ -19,6 +19,7 @@
 
 #include "absl/strings/string_view.h"
 #include "tink/subtle/common_enums.h"
+#include "tink/util/secret_data.h"
 #include "tink/util/statusor.h"
 #include "openssl/ec.h"
 
@@ -35,14 +36,14 @@ class EciesHkdfSenderKemBoringSsl {
    public:
     KemKey() {}
     explicit KemKey(const std::string& kem_bytes,
-                    const std::string& symmetric_key);
+                    const crypto::tink::util::SecretData& symmetric_key);
     std::string get_kem_bytes();
 
-    std::string get_symmetric_key();
+    const crypto::tink::util::SecretData& get_symmetric_key();
 
    private:
     std::string kem_bytes_;
-    std::string symmetric_key_;
+    crypto::tink::util::SecretData symmetric_key_;
   };
 
   // Constructs a sender KEM for the specified curve and recipient's
@@ -20,6 +20,7 @@
 #include "tink/subtle/common_enums.h"
 #include "tink/subtle/ecies_hkdf_recipient_kem_boringssl.h"
 #include "tink/subtle/subtle_util_boringssl.h"
+#include "tink/util/secret_data.h"
 #include "tink/util/status.h"
 #include "tink/util/statusor.h"
 #include "tink/util/test_util.h"
@@ -73,8 +74,10 @@ TEST_F(EciesHkdfSenderKemBoringSslTest, testSenderRecipientBasic) {
         test::HexDecodeOrDie(test.info_hex),
         test.out_len, test.point_format);
     std::cout << test::HexEncode(kem_key->get_kem_bytes()) << std::endl;
-    EXPECT_EQ(test::HexEncode(kem_key->get_symmetric_key()),
-              test::HexEncode(status_or_shared_secret.ValueOrDie()));
+    EXPECT_EQ(test::HexEncode(
+                  util::SecretDataAsStringView(kem_key->get_symmetric_key())),
+              test::HexEncode(util::SecretDataAsStringView(
+                  status_or_shared_secret.ValueOrDie())));
   }
 }
 
@@ -44,7 +44,7 @@ util::StatusOr<std::unique_ptr<PublicKeySign>> Ed25519SignBoringSsl::New(
 }
 
 Ed25519SignBoringSsl::Ed25519SignBoringSsl(absl::string_view private_key)
-    : private_key_(private_key) {}
+    : private_key_(util::SecretDataFromStringView(private_key)) {}
 
 util::StatusOr<std::string> Ed25519SignBoringSsl::Sign(
     absl::string_view data) const {
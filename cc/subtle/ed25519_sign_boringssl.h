@@ -22,6 +22,7 @@
 #include "absl/strings/string_view.h"
 #include "openssl/curve25519.h"
 #include "tink/public_key_sign.h"
+#include "tink/util/secret_data.h"
 #include "tink/util/statusor.h"
 
 namespace crypto {
@@ -40,7 +41,7 @@ class Ed25519SignBoringSsl : public PublicKeySign {
   ~Ed25519SignBoringSsl() override = default;
 
  private:
-  const std::string private_key_;
+  const crypto::tink::util::SecretData private_key_;
 
   explicit Ed25519SignBoringSsl(absl::string_view private_key);
 };
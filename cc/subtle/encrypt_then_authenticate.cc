@@ -64,12 +64,12 @@ util::StatusOr<std::string> EncryptThenAuthenticate::Encrypt(
   if (!ct.ok()) {
     return ct.status();
   }
-  std::string ciphertext(ct.ValueOrDie());
-  std::string toAuthData(additional_data);
-  toAuthData.append(ciphertext);
+  std::string ciphertext = std::move(ct.ValueOrDie());
   uint64_t aad_size_in_bits = additional_data.size() * 8;
-  toAuthData.append(longToBigEndianStr(aad_size_in_bits));
-  auto tag = mac_->ComputeMac(toAuthData);
+  std::string aad_size = longToBigEndianStr(aad_size_in_bits);
+  // The MAC is computed over additional_data || ciphertext || aad_size,
+  // without concatenating the pieces.
+  auto tag = mac_->ComputeMacMultipart({additional_data, ciphertext, aad_size});
   if (!tag.ok()) {
     return tag.status();
   }
@@ -87,17 +87,18 @@ util::StatusOr<std::string> EncryptThenAuthenticate::Decrypt(
   additional_data = SubtleUtilBoringSSL::EnsureNonNull(additional_data);
 
   if (ciphertext.size() < tag_size_) {
-    return util::Status(util::error::INTERNAL, "ciphertext too short");
+    static const util::StaticStatus* kCiphertextTooShort =
+        new util::StaticStatus(util::error::INTERNAL, "ciphertext too short");
+    return *kCiphertextTooShort;
   }
 
-  std::string payload = std::string(ciphertext.data(), ciphertext.size())
-                            .substr(0, ciphertext.size() - tag_size_);
-  std::string toAuthData(additional_data);
-  toAuthData.append(payload);
+  absl::string_view payload =
+      ciphertext.substr(0, ciphertext.size() - tag_size_);
   uint64_t aad_size_in_bits = additional_data.size() * 8;
-  toAuthData.append(longToBigEndianStr(aad_size_in_bits));
-  auto verified = mac_->VerifyMac(
-      ciphertext.substr(ciphertext.size() - tag_size_, tag_size_), toAuthData);
+  std::string aad_size = longToBigEndianStr(aad_size_in_bits);
+  auto verified = mac_->VerifyMacMultipart(
+      ciphertext.substr(ciphertext.size() - tag_size_, tag_size_),
+      {additional_data, payload, aad_size});
   if (!verified.ok()) {
     return verified;
   }
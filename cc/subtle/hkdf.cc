@@ -18,6 +18,7 @@
 
 #include "tink/subtle/subtle_util_boringssl.h"
 #include "tink/subtle/common_enums.h"
+#include "tink/util/secret_data.h"
 #include "tink/util/status.h"
 #include "tink/util/statusor.h"
 #include "openssl/evp.h"
@@ -49,17 +50,71 @@ util::StatusOr<std::string> Hkdf::ComputeHkdf(HashType hash,
 }
 
 // static
-util::StatusOr<std::string> Hkdf::ComputeEciesHkdfSymmetricKey(
+util::StatusOr<util::SecretData> Hkdf::ComputeHkdfPrk(HashType hash,
+                                                      absl::string_view ikm,
+                                                      absl::string_view salt) {
+  auto status_or_evp_md = SubtleUtilBoringSSL::EvpHash(hash);
+  if (!status_or_evp_md.ok()) {
+    return status_or_evp_md.status();
+  }
+  util::SecretData prk(EVP_MAX_MD_SIZE);
+  size_t prk_len;
+  if (1 != HKDF_extract(
+               prk.data(), &prk_len, status_or_evp_md.ValueOrDie(),
+               reinterpret_cast<const uint8_t *>(ikm.data()), ikm.size(),
+               reinterpret_cast<const uint8_t *>(salt.data()), salt.size())) {
+    return util::Status(util::error::INTERNAL,
+                        "BoringSSL's HKDF_extract failed");
+  }
+  prk.resize(prk_len);
+  return std::move(prk);
+}
+
+// static
+util::StatusOr<util::SecretData> Hkdf::ExpandHkdfPrk(
+    HashType hash,
+    const util::SecretData& prk,
+    absl::string_view info,
+    size_t out_len) {
+  auto status_or_evp_md = SubtleUtilBoringSSL::EvpHash(hash);
+  if (!status_or_evp_md.ok()) {
+    return status_or_evp_md.status();
+  }
+  util::SecretData out_key(out_len);
+  if (1 != HKDF_expand(
+               out_key.data(), out_len, status_or_evp_md.ValueOrDie(),
+               prk.data(), prk.size(),
+               reinterpret_cast<const uint8_t *>(info.data()), info.size())) {
+    return util::Status(util::error::INTERNAL,
+                        "BoringSSL's HKDF_expand failed");
+  }
+  return std::move(out_key);
+}
+
+// static
+util::StatusOr<util::SecretData> Hkdf::ComputeEciesHkdfSymmetricKey(
     HashType hash,
     absl::string_view kem_bytes,
     absl::string_view shared_secret,
     absl::string_view salt,
     absl::string_view info,
     size_t out_len) {
-  std::string ikm(kem_bytes);
-  std::string shared_secret_string(shared_secret);
-  ikm.append(shared_secret_string);
-  return Hkdf::ComputeHkdf(hash, ikm, salt, info, out_len);
+  auto status_or_evp_md = SubtleUtilBoringSSL::EvpHash(hash);
+  if (!status_or_evp_md.ok()) {
+    return status_or_evp_md.status();
+  }
+  util::SecretData ikm;
+  ikm.reserve(kem_bytes.size() + shared_secret.size());
+  ikm.insert(ikm.end(), kem_bytes.begin(), kem_bytes.end());
+  ikm.insert(ikm.end(), shared_secret.begin(), shared_secret.end());
+  util::SecretData out_key(out_len);
+  if (1 != HKDF(out_key.data(), out_len, status_or_evp_md.ValueOrDie(),
+                ikm.data(), ikm.size(),
+                reinterpret_cast<const uint8_t *>(salt.data()), salt.size(),
+                reinterpret_cast<const uint8_t *>(info.data()), info.size())) {
+    return util::Status(util::error::INTERNAL, "BoringSSL's HKDF failed");
+  }
+  return std::move(out_key);
 }
 
 }  // namespace subtle
@@ -19,6 +19,7 @@
 
 #include "absl/strings/string_view.h"
 #include "tink/subtle/common_enums.h"
+#include "tink/util/secret_data.h"
 #include "tink/util/status.h"
 #include "tink/util/statusor.h"
 
@@ -36,11 +37,35 @@ class Hkdf {
       absl::string_view info,
       size_t out_len);
 
+  // Computes the pseudorandom key of HKDF (the "extract" step of RFC5869).
+  // Deriving many keys from the same 'ikm' and 'salt' with
+  // ExpandHkdfPrk() saves one HMAC-computation per key, compared to
+  // ComputeHkdf().
+  static crypto::tink::util::StatusOr<crypto::tink::util::SecretData>
+  ComputeHkdfPrk(
+      HashType hash,
+      absl::string_view ikm,
+      absl::string_view salt);
+
+  // Computes a key from a pseudorandom key computed by ComputeHkdfPrk()
+  // with the same 'hash' (the "expand" step of RFC5869), i.e.
+  // ExpandHkdfPrk(hash, ComputeHkdfPrk(hash, ikm, salt), info, out_len)
+  // is equal to ComputeHkdf(hash, ikm, salt, info, out_len).
+  static crypto::tink::util::StatusOr<crypto::tink::util::SecretData>
+  ExpandHkdfPrk(
+      HashType hash,
+      const crypto::tink::util::SecretData& prk,
+      absl::string_view info,
+      size_t out_len);
+
   // Computes symmetric key for ECIES with HKDF from the provided parameters.
   // This function follows Shoup's recommendation of including ECIES
   // ephemeral KEM bytes into the commputation of the symmetric key
   // (cf. http://eprint.iacr.org/2001/112.pdf, Sections 15.6 and 15.6.1)
-  static crypto::tink::util::StatusOr<std::string> ComputeEciesHkdfSymmetricKey(
+  // The key, and the copy of 'shared_secret' it is derived from, are kept
+  // in SecretData.
+  static crypto::tink::util::StatusOr<crypto::tink::util::SecretData>
+  ComputeEciesHkdfSymmetricKey(
       HashType hash,
       absl::string_view kem_bytes,
       absl::string_view shared_secret,
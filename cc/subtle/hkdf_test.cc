@@ -16,6 +16,7 @@
 
 #include "tink/subtle/hkdf.h"
 #include "tink/subtle/common_enums.h"
+#include "tink/util/secret_data.h"
 #include "tink/util/status.h"
 #include "tink/util/statusor.h"
 #include "tink/util/test_util.h"
@@ -111,6 +112,33 @@ TEST_F(HkdfTest, testLongOutput) {
   EXPECT_EQ(status_or_string.status().error_message(),
             "BoringSSL's HKDF failed");
 }
+
+TEST_F(HkdfTest, testExtractAndExpand) {
+  for (const TestVector& test : test_vector) {
+    auto status_or_prk =
+        Hkdf::ComputeHkdfPrk(test.hash_type, test::HexDecodeOrDie(test.ikm_hex),
+                             test::HexDecodeOrDie(test.salt_hex));
+    ASSERT_TRUE(status_or_prk.ok()) << status_or_prk.status();
+    auto status_or_key = Hkdf::ExpandHkdfPrk(
+        test.hash_type, status_or_prk.ValueOrDie(),
+        test::HexDecodeOrDie(test.info_hex), test.out_len);
+    ASSERT_TRUE(status_or_key.ok()) << status_or_key.status();
+    EXPECT_EQ(test.out_key_hex, test::HexEncode(util::SecretDataAsStringView(
+                                    status_or_key.ValueOrDie())));
+  }
+}
+
+TEST_F(HkdfTest, testExpandLongOutput) {
+  TestVector test = test_vector[0];
+  auto status_or_prk =
+      Hkdf::ComputeHkdfPrk(test.hash_type, test::HexDecodeOrDie(test.ikm_hex),
+                           test::HexDecodeOrDie(test.salt_hex));
+  ASSERT_TRUE(status_or_prk.ok()) << status_or_prk.status();
+  auto status_or_key =
+      Hkdf::ExpandHkdfPrk(test.hash_type, status_or_prk.ValueOrDie(),
+                          test::HexDecodeOrDie(test.info_hex), 255 * 32 + 1);
+  EXPECT_FALSE(status_or_key.ok());
+}
 }  // namespace
 }  // namespace subtle
 }  // namespace tink
@@ -57,48 +57,70 @@ util::StatusOr<std::unique_ptr<Mac>> HmacBoringSsl::New(
 
 HmacBoringSsl::HmacBoringSsl(const EVP_MD* md, uint32_t tag_size,
                              const std::string& key_value)
-    : md_(md), tag_size_(tag_size), key_value_(key_value) {}
+    : md_(md),
+      tag_size_(tag_size),
+      key_value_(util::SecretDataFromStringView(key_value)) {}
 
-util::StatusOr<std::string> HmacBoringSsl::ComputeMac(
-    absl::string_view data) const {
-  // BoringSSL expects a non-null pointer for data,
-  // regardless of whether the size is 0.
-  data = SubtleUtilBoringSSL::EnsureNonNull(data);
-
-  uint8_t buf[EVP_MAX_MD_SIZE];
-  unsigned int out_len;
-  const uint8_t* res = HMAC(md_, key_value_.data(), key_value_.size(),
-                            reinterpret_cast<const uint8_t*>(data.data()),
-                            data.size(), buf, &out_len);
-  if (res == nullptr) {
+util::Status HmacBoringSsl::ComputeHmac(
+    absl::Span<const absl::string_view> data_pieces, uint8_t* buf) const {
+  bssl::ScopedHMAC_CTX ctx;
+  if (HMAC_Init_ex(ctx.get(), key_value_.data(), key_value_.size(), md_,
+                   nullptr) != 1) {
     // TODO(bleichen): We expect that BoringSSL supports the
     //   hashes that we use. Maybe we should have a status that indicates
     //   such mismatches between expected and actual behaviour.
     return util::Status(util::error::INTERNAL,
                         "BoringSSL failed to compute HMAC");
   }
+  for (absl::string_view piece : data_pieces) {
+    // BoringSSL expects a non-null pointer for data,
+    // regardless of whether the size is 0.
+    piece = SubtleUtilBoringSSL::EnsureNonNull(piece);
+    if (HMAC_Update(ctx.get(), reinterpret_cast<const uint8_t*>(piece.data()),
+                    piece.size()) != 1) {
+      return util::Status(util::error::INTERNAL,
+                          "BoringSSL failed to compute HMAC");
+    }
+  }
+  unsigned int out_len;
+  if (HMAC_Final(ctx.get(), buf, &out_len) != 1) {
+    return util::Status(util::error::INTERNAL,
+                        "BoringSSL failed to compute HMAC");
+  }
+  return util::Status::OK;
+}
+
+util::StatusOr<std::string> HmacBoringSsl::ComputeMac(
+    absl::string_view data) const {
+  return ComputeMacMultipart(absl::MakeConstSpan(&data, 1));
+}
+
+util::StatusOr<std::string> HmacBoringSsl::ComputeMacMultipart(
+    absl::Span<const absl::string_view> data_pieces) const {
+  uint8_t buf[EVP_MAX_MD_SIZE];
+  util::Status status = ComputeHmac(data_pieces, buf);
+  if (!status.ok()) return status;
   return std::string(reinterpret_cast<char*>(buf), tag_size_);
 }
 
 util::Status HmacBoringSsl::VerifyMac(
     absl::string_view mac,
     absl::string_view data) const {
-  // BoringSSL expects a non-null pointer for data,
-  // regardless of whether the size is 0.
-  data = SubtleUtilBoringSSL::EnsureNonNull(data);
+  return VerifyMacMultipart(mac, absl::MakeConstSpan(&data, 1));
+}
 
+util::Status HmacBoringSsl::VerifyMacMultipart(
+    absl::string_view mac,
+    absl::Span<const absl::string_view> data_pieces) const {
   if (mac.size() != tag_size_) {
-    return util::Status(util::error::INVALID_ARGUMENT, "incorrect tag size");
+    static const util::StaticStatus* kIncorrectTagSize =
+        new util::StaticStatus(util::error::INVALID_ARGUMENT,
+                               "incorrect tag size");
+    return *kIncorrectTagSize;
   }
   uint8_t buf[EVP_MAX_MD_SIZE];
-  unsigned int out_len;
-  const uint8_t* res = HMAC(md_, key_value_.data(), key_value_.size(),
-                            reinterpret_cast<const uint8_t*>(data.data()),
-                            data.size(), buf, &out_len);
-  if (res == nullptr) {
-    return util::Status(util::error::INTERNAL,
-                        "BoringSSL failed to compute HMAC");
-  }
+  util::Status status = ComputeHmac(data_pieces, buf);
+  if (!status.ok()) return status;
   uint8_t diff = 0;
   for (uint32_t i = 0; i < tag_size_; i++) {
     diff |= buf[i] ^ static_cast<uint8_t>(mac[i]);
@@ -106,7 +128,10 @@ util::Status HmacBoringSsl::VerifyMac(
   if (diff == 0) {
     return util::Status::OK;
   } else {
-    return util::Status(util::error::INVALID_ARGUMENT, "verification failed");
+    static const util::StaticStatus* kVerificationFailed =
+        new util::StaticStatus(util::error::INVALID_ARGUMENT,
+                               "verification failed");
+    return *kVerificationFailed;
   }
 }
 
@@ -20,8 +20,10 @@
 #include <memory>
 
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "tink/mac.h"
 #include "tink/subtle/common_enums.h"
+#include "tink/util/secret_data.h"
 #include "tink/util/status.h"
 #include "tink/util/statusor.h"
 #include "openssl/evp.h"
@@ -46,6 +48,15 @@ class HmacBoringSsl : public Mac {
       absl::string_view mac,
       absl::string_view data) const override;
 
+  // Computes the HMAC for the concatenation of 'data_pieces', hashing
+  // the pieces incrementally.
+  crypto::tink::util::StatusOr<std::string> ComputeMacMultipart(
+      absl::Span<const absl::string_view> data_pieces) const override;
+
+  crypto::tink::util::Status VerifyMacMultipart(
+      absl::string_view mac,
+      absl::Span<const absl::string_view> data_pieces) const override;
+
   virtual ~HmacBoringSsl() {}
 
  private:
@@ -55,10 +66,15 @@ class HmacBoringSsl : public Mac {
   HmacBoringSsl(const EVP_MD* md, uint32_t tag_size,
                 const std::string& key_value);
 
+  // Writes the untruncated HMAC of the concatenation of 'data_pieces'
+  // to 'buf', which must have room for EVP_MAX_MD_SIZE bytes.
+  crypto::tink::util::Status ComputeHmac(
+      absl::Span<const absl::string_view> data_pieces, uint8_t* buf) const;
+
   // HmacBoringSsl is not owner of md (it is owned by BoringSSL).
   const EVP_MD* md_;
   uint32_t tag_size_;
-  std::string key_value_;
+  const crypto::tink::util::SecretData key_value_;
 };
 
 }  // namespace subtle
@@ -78,6 +78,27 @@ TEST_F(HmacBoringSslTest, testBasic) {
   }
 }
 
+TEST_F(HmacBoringSslTest, testMultipart) {
+  std::string key(test::HexDecodeOrDie("000102030405060708090a0b0c0d0e0f"));
+  auto hmac_result = HmacBoringSsl::New(HashType::SHA256, 32, key);
+  EXPECT_TRUE(hmac_result.ok()) << hmac_result.status();
+  auto hmac = std::move(hmac_result.ValueOrDie());
+  std::string data = "Some data to test.";
+  std::string tag = hmac->ComputeMac(data).ValueOrDie();
+  for (size_t split = 0; split <= data.size(); split++) {
+    absl::string_view head = absl::string_view(data).substr(0, split);
+    absl::string_view tail = absl::string_view(data).substr(split);
+    auto res = hmac->ComputeMacMultipart({head, absl::string_view(), tail});
+    EXPECT_TRUE(res.ok()) << res.status().ToString();
+    EXPECT_EQ(tag, res.ValueOrDie());
+    EXPECT_TRUE(hmac->VerifyMacMultipart(tag, {head, tail}).ok());
+    EXPECT_FALSE(hmac->VerifyMacMultipart(tag, {head, tail, "x"}).ok());
+  }
+  // No pieces at all are the empty data.
+  EXPECT_EQ(hmac->ComputeMac("").ValueOrDie(),
+            hmac->ComputeMacMultipart({}).ValueOrDie());
+}
+
 TEST_F(HmacBoringSslTest, testModification) {
   std::string key(test::HexDecodeOrDie("000102030405060708090a0b0c0d0e0f"));
   auto hmac_result = HmacBoringSsl::New(HashType::SHA1, 16, key);
@@ -20,7 +20,9 @@
 #include "tink/input_stream.h"
 #include "tink/output_stream.h"
 #include "tink/streaming_aead.h"
+#include "tink/subtle/stream_segment_decrypter.h"
 #include "tink/subtle/stream_segment_encrypter.h"
+#include "tink/subtle/streaming_aead_decrypting_stream.h"
 #include "tink/subtle/streaming_aead_encrypting_stream.h"
 #include "tink/util/statusor.h"
 
@@ -40,7 +42,8 @@ crypto::tink::util::StatusOr<std::unique_ptr<crypto::tink::InputStream>>
     NonceBasedStreamingAead::NewDecryptingStream(
         std::unique_ptr<crypto::tink::InputStream> ciphertext_source,
         absl::string_view associated_data) {
-  return util::Status(util::error::UNIMPLEMENTED, "Not implemented yet");
+  return StreamingAeadDecryptingStream::New(
+      NewSegmentDecrypter(associated_data), std::move(ciphertext_source));
 }
 
 }  // namespace subtle
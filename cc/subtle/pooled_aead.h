@@ -0,0 +1,59 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_SUBTLE_POOLED_AEAD_H_
+#define TINK_SUBTLE_POOLED_AEAD_H_
+
+#include "absl/strings/string_view.h"
+#include "tink/subtle/buffer_pool.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+namespace subtle {
+
+// Optional interface of the AEAD primitives in tink/subtle that can write
+// their outputs into buffers taken from a BufferPool, instead of into a
+// newly allocated std::string.  It is implemented by AesGcmBoringSsl,
+// AesGcmSivBoringSsl and XChacha20Poly1305BoringSsl, and can be reached
+// from the Aead returned by their New() with
+//
+//   auto pooled = dynamic_cast<const PooledAead*>(aead.get());
+//
+// The ciphertexts are the same as those of Aead::Encrypt(), and both
+// kinds of outputs can be decrypted with either interface.
+class PooledAead {
+ public:
+  // Encrypts 'plaintext' with 'additional_data' as associated data into
+  // a buffer taken from 'pool'.
+  virtual crypto::tink::util::StatusOr<PooledBuffer> EncryptToBuffer(
+      absl::string_view plaintext, absl::string_view additional_data,
+      BufferPool* pool) const = 0;
+
+  // Decrypts 'ciphertext' with 'additional_data' as associated data into
+  // a buffer taken from 'pool'.
+  virtual crypto::tink::util::StatusOr<PooledBuffer> DecryptToBuffer(
+      absl::string_view ciphertext, absl::string_view additional_data,
+      BufferPool* pool) const = 0;
+
+  virtual ~PooledAead() {}
+};
+
+}  // namespace subtle
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_SUBTLE_POOLED_AEAD_H_
@@ -32,6 +32,11 @@ std::string Random::GetRandomBytes(size_t length) {
   return std::string(reinterpret_cast<const char *>(buf.get()), length);
 }
 
+// static
+void Random::GetRandomBytes(absl::Span<char> buffer) {
+  RAND_bytes(reinterpret_cast<uint8_t *>(buffer.data()), buffer.size());
+}
+
 }  // namespace subtle
 }  // namespace tink
 }  // namespace crypto
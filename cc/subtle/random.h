@@ -20,6 +20,8 @@
 #include <string>
 #include <memory>
 
+#include "absl/types/span.h"
+
 namespace crypto {
 namespace tink {
 namespace subtle {
@@ -28,6 +30,9 @@ class Random {
  public:
   // Returns a random std::string of desired length.
   static std::string GetRandomBytes(size_t length);
+
+  // Fills 'buffer' with random bytes.
+  static void GetRandomBytes(absl::Span<char> buffer);
 };
 
 }  // namespace subtle
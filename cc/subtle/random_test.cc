@@ -16,6 +16,7 @@
 
 #include "tink/subtle/random.h"
 #include "gtest/gtest.h"
+#include "absl/types/span.h"
 
 namespace crypto {
 namespace tink {
@@ -35,6 +36,19 @@ TEST_F(RandomTest, testBasic) {
   EXPECT_EQ(numTests, rand_strings.size());
 }
 
+TEST_F(RandomTest, testBuffer) {
+  int numTests = 32;
+  std::set<std::string> rand_strings;
+  for (int i = 0; i < numTests; i++) {
+    std::string s(16, '\0');
+    Random::GetRandomBytes(absl::MakeSpan(&s[0], s.size()));
+    rand_strings.insert(s);
+  }
+  EXPECT_EQ(numTests, rand_strings.size());
+  // Empty buffers are allowed.
+  Random::GetRandomBytes(absl::Span<char>());
+}
+
 }  // namespace
 }  // namespace subtle
 }  // namespace tink
@@ -83,8 +83,12 @@ RsaSsaPkcs1SignBoringSsl::RsaSsaPkcs1SignBoringSsl(
 
 util::StatusOr<std::string> RsaSsaPkcs1SignBoringSsl::Sign(
     absl::string_view data) const {
-  data = SubtleUtilBoringSSL::EnsureNonNull(data);
-  auto digest_or = boringssl::ComputeHash(data, *sig_hash_);
+  return SignMultipart(absl::MakeConstSpan(&data, 1));
+}
+
+util::StatusOr<std::string> RsaSsaPkcs1SignBoringSsl::SignMultipart(
+    absl::Span<const absl::string_view> data_pieces) const {
+  auto digest_or = boringssl::ComputeHash(data_pieces, *sig_hash_);
   if (!digest_or.ok()) return digest_or.status();
   std::vector<uint8_t> digest = std::move(digest_or.ValueOrDie());
 
@@ -20,6 +20,7 @@
 #include <memory>
 
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "openssl/base.h"
 #include "openssl/ec.h"
 #include "openssl/rsa.h"
@@ -46,6 +47,11 @@ class RsaSsaPkcs1SignBoringSsl : public PublicKeySign {
   crypto::tink::util::StatusOr<std::string> Sign(
       absl::string_view data) const override;
 
+  // Computes the signature for the concatenation of 'data_pieces',
+  // hashing the pieces incrementally.
+  crypto::tink::util::StatusOr<std::string> SignMultipart(
+      absl::Span<const absl::string_view> data_pieces) const override;
+
   ~RsaSsaPkcs1SignBoringSsl() override = default;
 
  private:
@@ -20,6 +20,7 @@
 #include <memory>
 
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "openssl/evp.h"
 #include "openssl/rsa.h"
 #include "tink/public_key_verify.h"
@@ -46,6 +47,12 @@ class RsaSsaPkcs1VerifyBoringSsl : public PublicKeyVerify {
   crypto::tink::util::Status Verify(absl::string_view signature,
                                     absl::string_view data) const override;
 
+  // Verifies the signature of the concatenation of 'data_pieces',
+  // hashing the pieces incrementally.
+  crypto::tink::util::Status VerifyMultipart(
+      absl::string_view signature,
+      absl::Span<const absl::string_view> data_pieces) const override;
+
   ~RsaSsaPkcs1VerifyBoringSsl() override = default;
 
  private:
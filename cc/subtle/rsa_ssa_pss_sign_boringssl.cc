@@ -88,8 +88,12 @@ RsaSsaPssSignBoringSsl::RsaSsaPssSignBoringSsl(bssl::UniquePtr<RSA> private_key,
 
 util::StatusOr<std::string> RsaSsaPssSignBoringSsl::Sign(
     absl::string_view data) const {
-  data = SubtleUtilBoringSSL::EnsureNonNull(data);
-  auto digest_or = boringssl::ComputeHash(data, *sig_hash_);
+  return SignMultipart(absl::MakeConstSpan(&data, 1));
+}
+
+util::StatusOr<std::string> RsaSsaPssSignBoringSsl::SignMultipart(
+    absl::Span<const absl::string_view> data_pieces) const {
+  auto digest_or = boringssl::ComputeHash(data_pieces, *sig_hash_);
   if (!digest_or.ok()) return digest_or.status();
   std::vector<uint8_t> digest = std::move(digest_or.ValueOrDie());
 
@@ -69,6 +69,26 @@ TEST_F(RsaPssSignBoringsslTest, EncodesPss) {
       IsOk());
 }
 
+TEST_F(RsaPssSignBoringsslTest, SignsMultipart) {
+  SubtleUtilBoringSSL::RsaSsaPssParams params{/*sig_hash=*/HashType::SHA256,
+                                              /*mgf1_hash=*/HashType::SHA256,
+                                              /*salt_length=*/32};
+
+  auto signer_or = RsaSsaPssSignBoringSsl::New(private_key_, params);
+  ASSERT_THAT(signer_or.status(), IsOk());
+  auto signature_or = signer_or.ValueOrDie()->SignMultipart({"test", "data"});
+  ASSERT_THAT(signature_or.status(), IsOk());
+
+  auto verifier_or = RsaSsaPssVerifyBoringSsl::New(public_key_, params);
+  ASSERT_THAT(verifier_or.status(), IsOk());
+  EXPECT_THAT(
+      verifier_or.ValueOrDie()->Verify(signature_or.ValueOrDie(), "testdata"),
+      IsOk());
+  EXPECT_THAT(verifier_or.ValueOrDie()->VerifyMultipart(
+                  signature_or.ValueOrDie(), {"te", "stda", "ta"}),
+              IsOk());
+}
+
 TEST_F(RsaPssSignBoringsslTest, EncodesPssWithSeparateHashes) {
   SubtleUtilBoringSSL::RsaSsaPssParams params{/*sig_hash=*/HashType::SHA256,
                                               /*mgf1_hash=*/HashType::SHA1,
@@ -82,11 +82,13 @@ RsaSsaPssVerifyBoringSsl::RsaSsaPssVerifyBoringSsl(bssl::UniquePtr<RSA> rsa,
 
 util::Status RsaSsaPssVerifyBoringSsl::Verify(absl::string_view signature,
                                               absl::string_view data) const {
-  // BoringSSL expects a non-null pointer for data,
-  // regardless of whether the size is 0.
-  data = SubtleUtilBoringSSL::EnsureNonNull(data);
+  return VerifyMultipart(signature, absl::MakeConstSpan(&data, 1));
+}
 
-  auto digest_result = boringssl::ComputeHash(data, *sig_hash_);
+util::Status RsaSsaPssVerifyBoringSsl::VerifyMultipart(
+    absl::string_view signature,
+    absl::Span<const absl::string_view> data_pieces) const {
+  auto digest_result = boringssl::ComputeHash(data_pieces, *sig_hash_);
   if (!digest_result.ok()) return digest_result.status();
   auto digest = std::move(digest_result.ValueOrDie());
 
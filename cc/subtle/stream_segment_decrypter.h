@@ -0,0 +1,91 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_SUBTLE_STREAM_SEGMENT_DECRYPTER_H_
+#define TINK_SUBTLE_STREAM_SEGMENT_DECRYPTER_H_
+
+#include <vector>
+
+#include "absl/types/span.h"
+#include "tink/util/status.h"
+
+namespace crypto {
+namespace tink {
+namespace subtle {
+
+// StreamSegmentDecrypter is a helper class that decrypts individual
+// segments of a stream, i.e. the counterpart of StreamSegmentEncrypter,
+// whose documentation describes the layout of the ciphertext stream.
+//
+// Instances of this are passed to an ...DecryptingStream. Each instance
+// of a segment decrypter is used to decrypt one stream: the symmetric
+// key of the stream is recovered from its header by Init().
+class StreamSegmentDecrypter {
+ public:
+  // Initializes this decrypter with the 'header' of the ciphertext stream,
+  // which must be get_header_size() bytes long.  Must be called once,
+  // before any call to DecryptSegment().
+  virtual util::Status Init(const std::vector<uint8_t>& header) = 0;
+
+  // Decrypts 'ciphertext' as the segment number 'segment_number', and
+  // writes the resulting plaintext to 'plaintext_buffer', adjusting its
+  // size as needed.  'ciphertext' and 'plaintext_buffer' must refer to
+  // distinct and non-overlapping space.
+  // Fails if the segment was modified, or was not encrypted as the segment
+  // with the given number and last-segment flag.
+  virtual util::Status DecryptSegment(
+      const std::vector<uint8_t>& ciphertext,
+      int64_t segment_number,
+      bool is_last_segment,
+      std::vector<uint8_t>* plaintext_buffer) = 0;
+
+  // Same as DecryptSegment(), but writes the plaintext to 'plaintext',
+  // which must be exactly get_ciphertext_segment_size() -
+  // get_plaintext_segment_size() bytes shorter than 'ciphertext'.
+  // Unlike DecryptSegment(), this may be called concurrently from several
+  // threads once Init() has returned, so that the segments of a stream
+  // can be decrypted in parallel.  Decrypters that do not support this
+  // return UNIMPLEMENTED.
+  virtual util::Status DecryptSegmentAt(
+      absl::Span<const uint8_t> ciphertext,
+      int64_t segment_number,
+      bool is_last_segment,
+      absl::Span<uint8_t> plaintext) const {
+    return util::Status(util::error::UNIMPLEMENTED,
+                        "positional decryption not supported");
+  }
+
+  // Returns the size (in bytes) of the header of the ciphertext stream.
+  virtual int get_header_size() const = 0;
+
+  // Returns the size (in bytes) of a plaintext segment.
+  virtual int get_plaintext_segment_size() const = 0;
+
+  // Returns the size (in bytes) of a ciphertext segment.
+  virtual int get_ciphertext_segment_size() const = 0;
+
+  // Returns the offset (in bytes) of the ciphertext within an encrypted stream.
+  // The offset is not smaller than the size of the header.
+  virtual int get_ciphertext_offset() const = 0;
+
+  virtual ~StreamSegmentDecrypter() {}
+};
+
+}  // namespace subtle
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_SUBTLE_STREAM_SEGMENT_DECRYPTER_H_
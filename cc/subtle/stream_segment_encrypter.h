@@ -19,6 +19,7 @@
 
 #include <vector>
 
+#include "absl/types/span.h"
 #include "tink/util/status.h"
 
 namespace crypto {
@@ -75,6 +76,24 @@ class StreamSegmentEncrypter {
       bool is_last_segment,
       std::vector<uint8_t>* ciphertext_buffer) = 0;
 
+  // Encrypts 'plaintext' as the segment with number 'segment_number',
+  // without using or changing the current segment number, and writes the
+  // ciphertext to 'ciphertext', which must be exactly
+  // get_ciphertext_segment_size() - get_plaintext_segment_size() bytes
+  // longer than 'plaintext'.
+  // Unlike EncryptSegment(), this may be called concurrently from several
+  // threads, so that the segments of a stream with a known layout can be
+  // encrypted in parallel.  Encrypters that do not support this return
+  // UNIMPLEMENTED.
+  virtual util::Status EncryptSegmentAt(
+      absl::Span<const uint8_t> plaintext,
+      int64_t segment_number,
+      bool is_last_segment,
+      absl::Span<uint8_t> ciphertext) const {
+    return util::Status(util::error::UNIMPLEMENTED,
+                        "positional encryption not supported");
+  }
+
   // Returns the header of the ciphertext stream.
   virtual const std::vector<uint8_t>& get_header() const = 0;
 
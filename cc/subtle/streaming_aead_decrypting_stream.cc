@@ -0,0 +1,181 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/subtle/streaming_aead_decrypting_stream.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "absl/memory/memory.h"
+#include "tink/input_stream.h"
+#include "tink/subtle/stream_segment_decrypter.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+using crypto::tink::InputStream;
+using crypto::tink::util::Status;
+using crypto::tink::util::StatusOr;
+
+namespace crypto {
+namespace tink {
+namespace subtle {
+
+namespace {
+
+// Appends bytes from 'input_stream' to 'contents', until 'contents' has
+// 'size' bytes or the end of 'input_stream' is reached.  Bytes obtained
+// from input_stream->Next() but not needed are backed up.
+// In case of errors other than the end of the stream returns the first
+// non-OK status of input_stream->Next()-operation.
+util::Status ReadFromStream(InputStream* input_stream, int size,
+                            std::vector<uint8_t>* contents) {
+  const void* buffer;
+  while (contents->size() < size) {
+    auto next_result = input_stream->Next(&buffer);
+    if (!next_result.ok()) {
+      if (next_result.status().error_code() == util::error::OUT_OF_RANGE) {
+        return Status::OK;
+      }
+      return next_result.status();
+    }
+    int available_bytes = next_result.ValueOrDie();
+    int used_bytes =
+        std::min(available_bytes, size - static_cast<int>(contents->size()));
+    const uint8_t* bytes = static_cast<const uint8_t*>(buffer);
+    contents->insert(contents->end(), bytes, bytes + used_bytes);
+    if (available_bytes > used_bytes) {
+      input_stream->BackUp(available_bytes - used_bytes);
+    }
+  }
+  return Status::OK;
+}
+
+}  // anonymous namespace
+
+// static
+StatusOr<std::unique_ptr<InputStream>> StreamingAeadDecryptingStream::New(
+    std::unique_ptr<StreamSegmentDecrypter> segment_decrypter,
+    std::unique_ptr<InputStream> ciphertext_source) {
+  if (segment_decrypter == nullptr) {
+    return Status(util::error::INVALID_ARGUMENT,
+                  "segment_decrypter must be non-null");
+  }
+  if (ciphertext_source == nullptr) {
+    return Status(util::error::INVALID_ARGUMENT,
+                  "ciphertext_source must be non-null");
+  }
+  int first_segment_size =
+      segment_decrypter->get_ciphertext_segment_size() -
+      segment_decrypter->get_ciphertext_offset();
+  if (first_segment_size <= 0) {
+    return Status(util::error::INTERNAL,
+                  "Size of the first segment must be greater than 0.");
+  }
+  std::unique_ptr<StreamingAeadDecryptingStream> dec_stream(
+      new StreamingAeadDecryptingStream());
+  dec_stream->segment_decrypter_ = std::move(segment_decrypter);
+  dec_stream->ct_source_ = std::move(ciphertext_source);
+  dec_stream->position_ = 0;
+  dec_stream->segment_number_ = 0;
+  dec_stream->pt_buffer_offset_ = 0;
+  dec_stream->last_returned_ = 0;
+  dec_stream->header_read_ = false;
+  dec_stream->last_segment_read_ = false;
+  return {std::move(dec_stream)};
+}
+
+Status StreamingAeadDecryptingStream::ReadHeader() {
+  int header_size = segment_decrypter_->get_header_size();
+  ct_buffer_.clear();
+  auto status = ReadFromStream(ct_source_.get(), header_size, &ct_buffer_);
+  if (!status.ok()) return status;
+  if (ct_buffer_.size() < header_size) {
+    return Status(util::error::INVALID_ARGUMENT,
+                  "Could not read stream header");
+  }
+  status = segment_decrypter_->Init(ct_buffer_);
+  ct_buffer_.clear();
+  return status;
+}
+
+Status StreamingAeadDecryptingStream::ReadAndDecryptSegment() {
+  int segment_size = segment_decrypter_->get_ciphertext_segment_size();
+  if (segment_number_ == 0) {
+    segment_size -= segment_decrypter_->get_ciphertext_offset();
+  }
+  // Reading one byte past the segment tells whether it is the last one.
+  // The extra byte, if any, stays at the front of ct_buffer_ for the next
+  // segment.
+  auto status = ReadFromStream(ct_source_.get(), segment_size + 1,
+                               &ct_buffer_);
+  if (!status.ok()) return status;
+  bool is_last_segment = ct_buffer_.size() <= segment_size;
+  uint8_t next_byte = 0;
+  if (!is_last_segment) {
+    next_byte = ct_buffer_.back();
+    ct_buffer_.pop_back();
+  }
+  status = segment_decrypter_->DecryptSegment(
+      ct_buffer_, segment_number_, is_last_segment, &pt_buffer_);
+  if (!status.ok()) return status;
+  ct_buffer_.clear();
+  if (!is_last_segment) ct_buffer_.push_back(next_byte);
+  segment_number_++;
+  last_segment_read_ = is_last_segment;
+  pt_buffer_offset_ = 0;
+  return Status::OK;
+}
+
+StatusOr<int> StreamingAeadDecryptingStream::Next(const void** data) {
+  if (!status_.ok()) return status_;
+  if (!header_read_) {
+    status_ = ReadHeader();
+    if (!status_.ok()) return status_;
+    header_read_ = true;
+  }
+  // Decrypt the next segment once the current one has been returned.
+  // Only the last segment may be empty.
+  while (pt_buffer_offset_ == pt_buffer_.size()) {
+    if (last_segment_read_) {
+      last_returned_ = 0;
+      status_ = Status(util::error::OUT_OF_RANGE, "EOF");
+      return status_;
+    }
+    status_ = ReadAndDecryptSegment();
+    if (!status_.ok()) return status_;
+  }
+  *data = pt_buffer_.data() + pt_buffer_offset_;
+  last_returned_ = pt_buffer_.size() - pt_buffer_offset_;
+  pt_buffer_offset_ = pt_buffer_.size();
+  position_ += last_returned_;
+  return last_returned_;
+}
+
+void StreamingAeadDecryptingStream::BackUp(int count) {
+  if (!status_.ok() || count < 1) return;
+  int actual_count = std::min(count, last_returned_);
+  last_returned_ -= actual_count;
+  pt_buffer_offset_ -= actual_count;
+  position_ -= actual_count;
+}
+
+int64_t StreamingAeadDecryptingStream::Position() const {
+  return position_;
+}
+
+}  // namespace subtle
+}  // namespace tink
+}  // namespace crypto
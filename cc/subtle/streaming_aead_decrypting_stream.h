@@ -0,0 +1,82 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_SUBTLE_STREAMING_AEAD_DECRYPTING_STREAM_H_
+#define TINK_SUBTLE_STREAMING_AEAD_DECRYPTING_STREAM_H_
+
+#include <memory>
+#include <vector>
+
+#include "tink/input_stream.h"
+#include "tink/subtle/stream_segment_decrypter.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+namespace subtle {
+
+class StreamingAeadDecryptingStream : public InputStream {
+ public:
+  // A factory that produces decrypting streams.
+  // The returned stream is a wrapper around 'ciphertext_source', which
+  // must be positioned at the header of the ciphertext stream, such that
+  // reading via the wrapper returns the plaintext decrypted by
+  // 'segment_decrypter'.  Segments are read and decrypted one at a time,
+  // so the memory used does not depend on the length of the stream.
+  static
+  crypto::tink::util::StatusOr<std::unique_ptr<crypto::tink::InputStream>>
+      New(std::unique_ptr<StreamSegmentDecrypter> segment_decrypter,
+          std::unique_ptr<crypto::tink::InputStream> ciphertext_source);
+
+  // -----------------------
+  // Methods of InputStream-interface implemented by this class.
+  crypto::tink::util::StatusOr<int> Next(const void** data) override;
+  void BackUp(int count) override;
+  int64_t Position() const override;
+
+ private:
+  StreamingAeadDecryptingStream() {}
+
+  // Reads the header from ct_source_ and initializes segment_decrypter_.
+  crypto::tink::util::Status ReadHeader();
+
+  // Reads the next ciphertext segment and decrypts it into pt_buffer_.
+  crypto::tink::util::Status ReadAndDecryptSegment();
+
+  std::unique_ptr<StreamSegmentDecrypter> segment_decrypter_;
+  std::unique_ptr<crypto::tink::InputStream> ct_source_;
+  std::vector<uint8_t> ct_buffer_;  // ciphertext buffer
+  std::vector<uint8_t> pt_buffer_;  // plaintext buffer
+  int64_t position_;  // number of plaintext bytes read from this stream
+  int64_t segment_number_;  // number of the next segment to decrypt
+  crypto::tink::util::Status status_;  // status of the stream
+
+  // Counters that describe the state of the data in pt_buffer_.
+  int pt_buffer_offset_;  // # bytes in pt_buffer_ already returned
+  int last_returned_;     // # bytes returned by the last Next()
+
+  // Flags that indicate whether the header has been read, and whether
+  // the last segment has been decrypted.
+  bool header_read_;
+  bool last_segment_read_;
+};
+
+}  // namespace subtle
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_SUBTLE_STREAMING_AEAD_DECRYPTING_STREAM_H_
@@ -0,0 +1,338 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/subtle/streaming_aead_decrypting_stream.h"
+
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tink/input_stream.h"
+#include "tink/subtle/random.h"
+#include "tink/subtle/stream_segment_decrypter.h"
+#include "tink/util/istream_input_stream.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+using crypto::tink::InputStream;
+using crypto::tink::util::IstreamInputStream;
+using crypto::tink::util::Status;
+
+namespace crypto {
+namespace tink {
+namespace subtle {
+namespace {
+
+// Size of the per-segment tag added upon encryption.
+const int kSegmentTagSize = sizeof(int64_t) + 1;
+
+// Bytes for marking whether a given segment is the last one.
+const char kLastSegment = 'l';
+const char kNotLastSegment = 'n';
+
+// Byte that fills the header.
+const char kHeaderByte = 'h';
+
+// Generates the ciphertext of 'plaintext' in the format of the
+// DummyStreamSegmentEncrypter of streaming_aead_encrypting_stream_test:
+// each segment is the plaintext followed by the segment number and
+// a marker byte indicating whether the segment is the last one.
+std::string GenerateCiphertext(absl::string_view plaintext,
+                               int pt_segment_size, int header_size,
+                               int ct_offset) {
+  std::string ct(header_size, kHeaderByte);
+  int64_t seg_no = 0;
+  int pos = 0;
+  do {
+    int seg_len = pt_segment_size;
+    if (pos == 0) {  // The first segment.
+      seg_len -= ct_offset;
+    }
+    if (seg_len > plaintext.size() - pos) {  // The last segment.
+      seg_len = plaintext.size() - pos;
+    }
+    ct.append(plaintext.substr(pos, seg_len).data(), seg_len);
+    pos += seg_len;
+    ct.append(reinterpret_cast<const char*>(&seg_no), sizeof(seg_no));
+    ct.append(1, pos < plaintext.size() ? kNotLastSegment : kLastSegment);
+    seg_no++;
+  } while (pos < plaintext.size());
+  return ct;
+}
+
+// A dummy decrypter for the ciphertexts generated by GenerateCiphertext().
+class DummyStreamSegmentDecrypter : public StreamSegmentDecrypter {
+ public:
+  DummyStreamSegmentDecrypter(int pt_segment_size,
+                              int header_size,
+                              int ct_offset) :
+      pt_segment_size_(pt_segment_size),
+      header_size_(header_size),
+      ct_offset_(ct_offset) {}
+
+  util::Status Init(const std::vector<uint8_t>& header) override {
+    if (header.size() != header_size_) {
+      return Status(util::error::INVALID_ARGUMENT, "wrong header size");
+    }
+    for (uint8_t b : header) {
+      if (b != kHeaderByte) {
+        return Status(util::error::INVALID_ARGUMENT, "corrupted header");
+      }
+    }
+    return Status::OK;
+  }
+
+  util::Status DecryptSegment(
+      const std::vector<uint8_t>& ciphertext,
+      int64_t segment_number,
+      bool is_last_segment,
+      std::vector<uint8_t>* plaintext_buffer) override {
+    if (ciphertext.size() < kSegmentTagSize) {
+      return Status(util::error::INVALID_ARGUMENT, "segment too short");
+    }
+    int pt_size = ciphertext.size() - kSegmentTagSize;
+    int64_t seg_no;
+    memcpy(&seg_no, ciphertext.data() + pt_size, sizeof(seg_no));
+    char marker = is_last_segment ? kLastSegment : kNotLastSegment;
+    if (seg_no != segment_number || ciphertext.back() != marker) {
+      return Status(util::error::INVALID_ARGUMENT, "wrong segment");
+    }
+    plaintext_buffer->assign(ciphertext.begin(), ciphertext.begin() + pt_size);
+    return Status::OK;
+  }
+
+  int get_header_size() const override {
+    return header_size_;
+  }
+
+  int get_plaintext_segment_size() const override {
+    return pt_segment_size_;
+  }
+
+  int get_ciphertext_segment_size() const override {
+    return pt_segment_size_ + kSegmentTagSize;
+  }
+
+  int get_ciphertext_offset() const override {
+    return ct_offset_;
+  }
+
+ private:
+  int pt_segment_size_;
+  int header_size_;
+  int ct_offset_;
+};   // class DummyStreamSegmentDecrypter
+
+// Returns a decrypting stream for 'ciphertext', which reads the ciphertext
+// in chunks of 'chunk_size' bytes.
+std::unique_ptr<InputStream> GetDecryptingStream(
+    absl::string_view ciphertext, int pt_segment_size, int header_size,
+    int ct_offset, int chunk_size) {
+  auto ct_stream =
+      absl::make_unique<std::stringstream>(std::string(ciphertext));
+  std::unique_ptr<InputStream> ct_source(
+      absl::make_unique<IstreamInputStream>(std::move(ct_stream), chunk_size));
+  auto seg_dec = absl::make_unique<DummyStreamSegmentDecrypter>(
+      pt_segment_size, header_size, ct_offset);
+  auto dec_stream = std::move(StreamingAeadDecryptingStream::New(
+      std::move(seg_dec), std::move(ct_source)).ValueOrDie());
+  EXPECT_EQ(0, dec_stream->Position());
+  return dec_stream;
+}
+
+// Reads all of 'input_stream' into 'contents'.  Returns the first non-OK
+// status of input_stream->Next(), other than the end of the stream.
+Status ReadAll(InputStream* input_stream, std::string* contents) {
+  contents->clear();
+  const void* buffer;
+  while (true) {
+    auto next_result = input_stream->Next(&buffer);
+    if (!next_result.ok()) {
+      if (next_result.status().error_code() == util::error::OUT_OF_RANGE) {
+        return Status::OK;
+      }
+      return next_result.status();
+    }
+    contents->append(static_cast<const char*>(buffer),
+                     next_result.ValueOrDie());
+  }
+}
+
+class StreamingAeadDecryptingStreamTest : public ::testing::Test {
+};
+
+TEST_F(StreamingAeadDecryptingStreamTest, ReadingStreams) {
+  std::vector<int> pt_sizes = {0, 10, 100, 1000, 10000, 100000};
+  std::vector<int> pt_segment_sizes = {64, 100, 128, 1000, 1024};
+  std::vector<int> header_sizes = {5, 10, 32};
+  std::vector<int> ct_offset_deltas = {0, 1, 5, 15};
+  std::vector<int> chunk_sizes = {1, 7, 4096};
+  for (auto pt_size : pt_sizes) {
+    for (auto pt_segment_size : pt_segment_sizes) {
+      for (auto header_size : header_sizes) {
+        for (auto offset_delta : ct_offset_deltas) {
+          for (auto chunk_size : chunk_sizes) {
+            SCOPED_TRACE(absl::StrCat("pt_size = ", pt_size,
+                                      ", pt_segment_size = ", pt_segment_size,
+                                      ", header_size = ", header_size,
+                                      ", offset_delta = ", offset_delta,
+                                      ", chunk_size = ", chunk_size));
+            int ct_offset = header_size + offset_delta;
+            std::string pt = Random::GetRandomBytes(pt_size);
+            std::string ct = GenerateCiphertext(pt, pt_segment_size,
+                                                header_size, ct_offset);
+            auto dec_stream = GetDecryptingStream(
+                ct, pt_segment_size, header_size, ct_offset, chunk_size);
+            std::string decrypted;
+            auto status = ReadAll(dec_stream.get(), &decrypted);
+            EXPECT_TRUE(status.ok()) << status;
+            EXPECT_EQ(pt, decrypted);
+            EXPECT_EQ(pt_size, dec_stream->Position());
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST_F(StreamingAeadDecryptingStreamTest, EmptyPlaintext) {
+  int pt_segment_size = 512;
+  int header_size = 64;
+  std::string ct = GenerateCiphertext("", pt_segment_size, header_size,
+                                      header_size);
+  EXPECT_EQ(header_size + kSegmentTagSize, ct.size());
+  auto dec_stream = GetDecryptingStream(ct, pt_segment_size, header_size,
+                                        header_size, /* chunk_size = */ 100);
+  const void* buffer;
+  auto next_result = dec_stream->Next(&buffer);
+  EXPECT_FALSE(next_result.ok());
+  EXPECT_EQ(util::error::OUT_OF_RANGE, next_result.status().error_code());
+  EXPECT_EQ(0, dec_stream->Position());
+}
+
+TEST_F(StreamingAeadDecryptingStreamTest, NextAfterBackup) {
+  int pt_segment_size = 512;
+  int header_size = 64;
+  int part1_size = 123;
+  std::string pt = Random::GetRandomBytes(2000);
+  std::string ct = GenerateCiphertext(pt, pt_segment_size, header_size,
+                                      header_size);
+  auto dec_stream = GetDecryptingStream(ct, pt_segment_size, header_size,
+                                        header_size, /* chunk_size = */ 100);
+
+  // The first buffer holds the first segment.
+  const void* buffer;
+  auto next_result = dec_stream->Next(&buffer);
+  EXPECT_TRUE(next_result.ok()) << next_result.status();
+  int buffer_size = pt_segment_size - header_size;
+  EXPECT_EQ(buffer_size, next_result.ValueOrDie());
+  EXPECT_EQ(buffer_size, dec_stream->Position());
+  EXPECT_EQ(pt.substr(0, buffer_size),
+            std::string(static_cast<const char*>(buffer), buffer_size));
+
+  // Back up all but part1_size bytes, and get them again.
+  dec_stream->BackUp(buffer_size - part1_size);
+  EXPECT_EQ(part1_size, dec_stream->Position());
+  const void* backedup_buffer;
+  next_result = dec_stream->Next(&backedup_buffer);
+  EXPECT_TRUE(next_result.ok()) << next_result.status();
+  EXPECT_EQ(buffer_size - part1_size, next_result.ValueOrDie());
+  EXPECT_EQ(static_cast<const uint8_t*>(buffer) + part1_size,
+            static_cast<const uint8_t*>(backedup_buffer));
+
+  // Backing up more than the last buffer backs up just that buffer.
+  dec_stream->BackUp(buffer_size);
+  EXPECT_EQ(part1_size, dec_stream->Position());
+
+  // The rest of the plaintext follows.
+  std::string rest;
+  auto status = ReadAll(dec_stream.get(), &rest);
+  EXPECT_TRUE(status.ok()) << status;
+  EXPECT_EQ(pt.substr(part1_size), rest);
+  EXPECT_EQ(pt.size(), dec_stream->Position());
+}
+
+TEST_F(StreamingAeadDecryptingStreamTest, TruncatedStream) {
+  int pt_segment_size = 100;
+  int header_size = 10;
+  std::string pt = Random::GetRandomBytes(1000);
+  std::string ct = GenerateCiphertext(pt, pt_segment_size, header_size,
+                                      header_size);
+  int ct_segment_size = pt_segment_size + kSegmentTagSize;
+  // Truncations at a segment boundary, within a segment, and of the header.
+  for (int ct_size : {3 * ct_segment_size,
+                      3 * ct_segment_size + 20,
+                      header_size / 2}) {
+    SCOPED_TRACE(absl::StrCat("ct_size = ", ct_size));
+    auto dec_stream = GetDecryptingStream(ct.substr(0, ct_size),
+                                          pt_segment_size, header_size,
+                                          header_size, /* chunk_size = */ 64);
+    std::string decrypted;
+    auto status = ReadAll(dec_stream.get(), &decrypted);
+    EXPECT_FALSE(status.ok());
+    EXPECT_EQ(util::error::INVALID_ARGUMENT, status.error_code());
+    // Only authenticated segments were returned.
+    EXPECT_EQ(pt.substr(0, decrypted.size()), decrypted);
+
+    // The stream keeps failing.
+    const void* buffer;
+    auto next_result = dec_stream->Next(&buffer);
+    EXPECT_FALSE(next_result.ok());
+    EXPECT_EQ(status, next_result.status());
+  }
+}
+
+TEST_F(StreamingAeadDecryptingStreamTest, CorruptedHeader) {
+  int pt_segment_size = 100;
+  int header_size = 10;
+  std::string pt = Random::GetRandomBytes(1000);
+  std::string ct = GenerateCiphertext(pt, pt_segment_size, header_size,
+                                      header_size);
+  ct[3] ^= 1;
+  auto dec_stream = GetDecryptingStream(ct, pt_segment_size, header_size,
+                                        header_size, /* chunk_size = */ 64);
+  const void* buffer;
+  auto next_result = dec_stream->Next(&buffer);
+  EXPECT_FALSE(next_result.ok());
+  EXPECT_EQ(util::error::INVALID_ARGUMENT, next_result.status().error_code());
+  EXPECT_EQ(0, dec_stream->Position());
+}
+
+TEST_F(StreamingAeadDecryptingStreamTest, NullArguments) {
+  auto seg_dec = absl::make_unique<DummyStreamSegmentDecrypter>(100, 10, 10);
+  auto result = StreamingAeadDecryptingStream::New(std::move(seg_dec),
+                                                   nullptr);
+  EXPECT_FALSE(result.ok());
+  EXPECT_EQ(util::error::INVALID_ARGUMENT, result.status().error_code());
+
+  std::unique_ptr<InputStream> ct_source(absl::make_unique<IstreamInputStream>(
+      absl::make_unique<std::stringstream>("ciphertext")));
+  auto null_decrypter_result =
+      StreamingAeadDecryptingStream::New(nullptr, std::move(ct_source));
+  EXPECT_FALSE(null_decrypter_result.ok());
+  EXPECT_EQ(util::error::INVALID_ARGUMENT,
+            null_decrypter_result.status().error_code());
+}
+
+}  // namespace
+}  // namespace subtle
+}  // namespace tink
+}  // namespace crypto
@@ -562,6 +562,34 @@ util::StatusOr<std::vector<uint8_t>> ComputeHash(absl::string_view input,
   return digest;
 }
 
+util::StatusOr<std::vector<uint8_t>> ComputeHash(
+    absl::Span<const absl::string_view> input_pieces, const EVP_MD &hasher) {
+  bssl::ScopedEVP_MD_CTX ctx;
+  if (EVP_DigestInit_ex(ctx.get(), &hasher, /*impl=*/nullptr) != 1) {
+    return util::Status(util::error::INTERNAL,
+                        absl::StrCat("Openssl internal error computing hash: ",
+                                     SubtleUtilBoringSSL::GetErrors()));
+  }
+  for (absl::string_view piece : input_pieces) {
+    piece = SubtleUtilBoringSSL::EnsureNonNull(piece);
+    if (EVP_DigestUpdate(ctx.get(), piece.data(), piece.size()) != 1) {
+      return util::Status(
+          util::error::INTERNAL,
+          absl::StrCat("Openssl internal error computing hash: ",
+                       SubtleUtilBoringSSL::GetErrors()));
+    }
+  }
+  std::vector<uint8_t> digest(EVP_MAX_MD_SIZE);
+  uint32_t digest_length = 0;
+  if (EVP_DigestFinal_ex(ctx.get(), digest.data(), &digest_length) != 1) {
+    return util::Status(util::error::INTERNAL,
+                        absl::StrCat("Openssl internal error computing hash: ",
+                                     SubtleUtilBoringSSL::GetErrors()));
+  }
+  digest.resize(digest_length);
+  return digest;
+}
+
 }  // namespace boringssl
 
 }  // namespace subtle
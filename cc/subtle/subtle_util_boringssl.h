@@ -20,6 +20,7 @@
 #include <vector>
 
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "openssl/bn.h"
 #include "openssl/err.h"
 #include "openssl/evp.h"
@@ -194,6 +195,11 @@ namespace boringssl {
 util::StatusOr<std::vector<uint8_t>> ComputeHash(absl::string_view input,
                                                  const EVP_MD &hasher);
 
+// Computes hash of the concatenation of 'input_pieces' using the hash
+// function 'hasher', without copying the pieces.
+util::StatusOr<std::vector<uint8_t>> ComputeHash(
+    absl::Span<const absl::string_view> input_pieces, const EVP_MD &hasher);
+
 }  // namespace boringssl
 
 }  // namespace subtle
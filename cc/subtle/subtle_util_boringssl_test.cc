@@ -504,6 +504,24 @@ TEST_P(ComputeHashSamplesTest, ComputesHash) {
   EXPECT_THAT(hash, StrEq(expected_hash));
 }
 
+TEST_P(ComputeHashSamplesTest, ComputesHashOfPieces) {
+  const EVP_MD* hasher =
+      SubtleUtilBoringSSL::EvpHash(std::get<0>(GetParam())).ValueOrDie();
+  std::string data = absl::HexStringToBytes(std::get<1>(GetParam()));
+  std::string expected_hash = absl::HexStringToBytes(std::get<2>(GetParam()));
+
+  for (size_t split = 0; split <= data.size(); split++) {
+    absl::string_view pieces[] = {absl::string_view(data).substr(0, split),
+                                  absl::string_view(),
+                                  absl::string_view(data).substr(split)};
+    auto hash_or = boringssl::ComputeHash(pieces, *hasher);
+    ASSERT_THAT(hash_or.status(), IsOk());
+    std::string hash(reinterpret_cast<char*>(hash_or.ValueOrDie().data()),
+                     hash_or.ValueOrDie().size());
+    EXPECT_THAT(hash, StrEq(expected_hash)) << "split at " << split;
+  }
+}
+
 }  // namespace
 }  // namespace subtle
 }  // namespace tink
@@ -17,11 +17,13 @@
 #include "tink/subtle/xchacha20_poly1305_boringssl.h"
 
 #include <string>
-#include <vector>
+#include <utility>
 
+#include "absl/types/span.h"
+#include "openssl/aead.h"
 #include "openssl/err.h"
-#include "openssl/evp.h"
 #include "tink/aead.h"
+#include "tink/subtle/buffer_pool.h"
 #include "tink/subtle/random.h"
 #include "tink/subtle/subtle_util_boringssl.h"
 #include "tink/util/errors.h"
@@ -36,12 +38,7 @@ static const bool IsValidKeySize(uint32_t size_in_bytes) {
   return size_in_bytes == 32;
 }
 
-XChacha20Poly1305BoringSsl::XChacha20Poly1305BoringSsl(
-    absl::string_view key_value, const EVP_AEAD* aead)
-    : key_(key_value), aead_(aead) {}
-
-util::StatusOr<std::unique_ptr<Aead>> XChacha20Poly1305BoringSsl::New(
-    absl::string_view key_value) {
+util::Status XChacha20Poly1305BoringSsl::Init(absl::string_view key_value) {
   if (!IsValidKeySize(key_value.size())) {
     return util::Status(util::error::INTERNAL, "Invalid key size");
   }
@@ -51,99 +48,144 @@ util::StatusOr<std::unique_ptr<Aead>> XChacha20Poly1305BoringSsl::New(
     return util::Status(util::error::INTERNAL, "Failed to get EVP_AEAD");
   }
 
-  std::unique_ptr<Aead> aead(new XChacha20Poly1305BoringSsl(key_value, cipher));
-  return std::move(aead);
-}
-
-util::StatusOr<std::string> XChacha20Poly1305BoringSsl::Encrypt(
-    absl::string_view plaintext, absl::string_view additional_data) const {
-  bssl::UniquePtr<EVP_AEAD_CTX> ctx(
-      EVP_AEAD_CTX_new(aead_, reinterpret_cast<const uint8_t*>(key_.data()),
-                       key_.size(), TAG_SIZE));
-  if (ctx.get() == nullptr) {
+  if (EVP_AEAD_CTX_init(ctx_.get(), cipher,
+                        reinterpret_cast<const uint8_t*>(key_value.data()),
+                        key_value.size(), TAG_SIZE, nullptr) != 1) {
     return util::Status(util::error::INTERNAL,
                         "could not initialize EVP_AEAD_CTX");
   }
+  return util::OkStatus();
+}
 
+util::StatusOr<std::unique_ptr<Aead>> XChacha20Poly1305BoringSsl::New(
+    absl::string_view key_value) {
+  std::unique_ptr<XChacha20Poly1305BoringSsl> aead(
+      new XChacha20Poly1305BoringSsl);
+  auto status = aead->Init(key_value);
+  if (!status.ok()) {
+    return status;
+  }
+  return util::StatusOr<std::unique_ptr<Aead>>(std::move(aead));
+}
+
+util::Status XChacha20Poly1305BoringSsl::Seal(
+    absl::string_view plaintext, absl::string_view additional_data,
+    uint8_t* out) const {
   // BoringSSL expects a non-null pointer for plaintext and additional_data,
   // regardless of whether the size is 0.
   plaintext = SubtleUtilBoringSSL::EnsureNonNull(plaintext);
   additional_data = SubtleUtilBoringSSL::EnsureNonNull(additional_data);
 
-  const std::string nonce = Random::GetRandomBytes(NONCE_SIZE);
-  if (nonce.size() != NONCE_SIZE) {
-    return util::Status(util::error::INTERNAL,
-                        "Failed to get enough random bytes for nonce");
-  }
-
-  size_t ciphertext_size = nonce.size() + plaintext.size() + TAG_SIZE;
-
-  // Write the nonce in the output buffer.
-  std::vector<uint8_t> ct(ciphertext_size + 1);
-  memcpy(&ct[0], reinterpret_cast<const uint8_t*>(nonce.data()), nonce.size());
-  size_t written = nonce.size();
+  // The nonce is written directly in front of the ciphertext.
+  Random::GetRandomBytes(
+      absl::MakeSpan(reinterpret_cast<char*>(out), NONCE_SIZE));
 
   // Encrypt the plaintext and store it after the nonce.
   size_t out_len = 0;
   int ret = EVP_AEAD_CTX_seal(
-      ctx.get(), &ct[written], &out_len, ciphertext_size - written,
-      reinterpret_cast<const uint8_t*>(nonce.data()), nonce.size(),
+      ctx_.get(), out + NONCE_SIZE, &out_len, plaintext.size() + TAG_SIZE,
+      out, NONCE_SIZE,
       reinterpret_cast<const uint8_t*>(plaintext.data()), plaintext.size(),
       reinterpret_cast<const uint8_t*>(additional_data.data()),
       additional_data.size());
   if (ret != 1) {
     return util::Status(util::error::INTERNAL, "EVP_AEAD_CTX_seal failed");
   }
-  written += out_len;
 
   // Verify that all the expected data has been written.
-  if (written != ciphertext_size) {
+  if (out_len != plaintext.size() + TAG_SIZE) {
     return util::Status(util::error::INTERNAL, "Incorrect ciphertext size");
   }
-  return std::string(reinterpret_cast<const char*>(&ct[0]), written);
+  return util::OkStatus();
 }
 
-util::StatusOr<std::string> XChacha20Poly1305BoringSsl::Decrypt(
-    absl::string_view ciphertext, absl::string_view additional_data) const {
+util::Status XChacha20Poly1305BoringSsl::Open(
+    absl::string_view ciphertext, absl::string_view additional_data,
+    uint8_t* out) const {
   // BoringSSL expects a non-null pointer for additional_data,
   // regardless of whether the size is 0.
   additional_data = SubtleUtilBoringSSL::EnsureNonNull(additional_data);
 
-  if (ciphertext.size() < NONCE_SIZE + TAG_SIZE) {
-    return util::Status(util::error::INTERNAL, "Ciphertext too short");
-  }
-
-  bssl::UniquePtr<EVP_AEAD_CTX> ctx(
-      EVP_AEAD_CTX_new(aead_, reinterpret_cast<const uint8_t*>(key_.data()),
-                       key_.size(), TAG_SIZE));
-  if (ctx.get() == nullptr) {
-    return util::Status(util::error::INTERNAL,
-                        "could not initialize EVP_AEAD_CTX");
-  }
-
   size_t out_size = ciphertext.size() - NONCE_SIZE - TAG_SIZE;
-  std::vector<uint8_t> out(out_size + 1);
-
   absl::string_view nonce = ciphertext.substr(0, NONCE_SIZE);
   absl::string_view encrypted =
       ciphertext.substr(NONCE_SIZE, out_size + TAG_SIZE);
 
   size_t len = 0;
   int ret = EVP_AEAD_CTX_open(
-      ctx.get(), &out[0], &len, out_size,
+      ctx_.get(), out, &len, out_size,
       reinterpret_cast<const uint8_t*>(nonce.data()), nonce.size(),
       reinterpret_cast<const uint8_t*>(encrypted.data()), encrypted.size(),
       reinterpret_cast<const uint8_t*>(additional_data.data()),
       additional_data.size());
   if (ret != 1) {
-    return util::Status(util::error::INTERNAL, "EVP_AEAD_CTX_open failed");
+    static const util::StaticStatus* kOpenFailed =
+        new util::StaticStatus(util::error::INTERNAL,
+                               "EVP_AEAD_CTX_open failed");
+    return *kOpenFailed;
   }
 
   if (len != out_size) {
     return util::Status(util::error::INTERNAL, "Incorrect output size");
   }
+  return util::OkStatus();
+}
+
+util::StatusOr<std::string> XChacha20Poly1305BoringSsl::Encrypt(
+    absl::string_view plaintext, absl::string_view additional_data) const {
+  // The nonce and the ciphertext are written directly into the result,
+  // which is the only allocation per message.
+  std::string ct;
+  ct.resize(NONCE_SIZE + plaintext.size() + TAG_SIZE);
+  auto status =
+      Seal(plaintext, additional_data, reinterpret_cast<uint8_t*>(&ct[0]));
+  if (!status.ok()) return status;
+  return std::move(ct);
+}
+
+util::StatusOr<std::string> XChacha20Poly1305BoringSsl::Decrypt(
+    absl::string_view ciphertext, absl::string_view additional_data) const {
+  if (ciphertext.size() < NONCE_SIZE + TAG_SIZE) {
+    static const util::StaticStatus* kCiphertextTooShort =
+        new util::StaticStatus(util::error::INTERNAL, "Ciphertext too short");
+    return *kCiphertextTooShort;
+  }
 
-  return std::string(reinterpret_cast<const char*>(&out[0]), out_size);
+  size_t out_size = ciphertext.size() - NONCE_SIZE - TAG_SIZE;
+  // The plaintext is written directly into the result; the extra byte
+  // keeps the output pointer valid for empty plaintexts.
+  std::string out;
+  out.resize(out_size + 1);
+  auto status =
+      Open(ciphertext, additional_data, reinterpret_cast<uint8_t*>(&out[0]));
+  if (!status.ok()) return status;
+  out.resize(out_size);
+  return std::move(out);
+}
+
+util::StatusOr<PooledBuffer> XChacha20Poly1305BoringSsl::EncryptToBuffer(
+    absl::string_view plaintext, absl::string_view additional_data,
+    BufferPool* pool) const {
+  PooledBuffer ct = pool->Get(NONCE_SIZE + plaintext.size() + TAG_SIZE);
+  auto status = Seal(plaintext, additional_data, ct.data());
+  if (!status.ok()) return status;
+  return std::move(ct);
+}
+
+util::StatusOr<PooledBuffer> XChacha20Poly1305BoringSsl::DecryptToBuffer(
+    absl::string_view ciphertext, absl::string_view additional_data,
+    BufferPool* pool) const {
+  if (ciphertext.size() < NONCE_SIZE + TAG_SIZE) {
+    static const util::StaticStatus* kCiphertextTooShort =
+        new util::StaticStatus(util::error::INTERNAL, "Ciphertext too short");
+    return *kCiphertextTooShort;
+  }
+  // Pooled buffers are never smaller than 2^BufferPool::kMinSizeClass
+  // bytes, so data() is valid even for empty plaintexts.
+  PooledBuffer out = pool->Get(ciphertext.size() - NONCE_SIZE - TAG_SIZE);
+  auto status = Open(ciphertext, additional_data, out.data());
+  if (!status.ok()) return status;
+  return std::move(out);
 }
 
 }  // namespace subtle
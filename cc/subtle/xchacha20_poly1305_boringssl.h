@@ -20,8 +20,10 @@
 #include <memory>
 
 #include "absl/strings/string_view.h"
-#include "openssl/evp.h"
+#include "openssl/aead.h"
 #include "tink/aead.h"
+#include "tink/subtle/buffer_pool.h"
+#include "tink/subtle/pooled_aead.h"
 #include "tink/util/status.h"
 #include "tink/util/statusor.h"
 
@@ -29,7 +31,7 @@ namespace crypto {
 namespace tink {
 namespace subtle {
 
-class XChacha20Poly1305BoringSsl : public Aead {
+class XChacha20Poly1305BoringSsl : public Aead, public PooledAead {
  public:
   // Constructs a new Aead cipher for XChacha20-Poly1305.
   // Currently supported key size is 256 bits.
@@ -46,6 +48,14 @@ class XChacha20Poly1305BoringSsl : public Aead {
       absl::string_view ciphertext,
       absl::string_view additional_data) const override;
 
+  crypto::tink::util::StatusOr<PooledBuffer> EncryptToBuffer(
+      absl::string_view plaintext, absl::string_view additional_data,
+      BufferPool* pool) const override;
+
+  crypto::tink::util::StatusOr<PooledBuffer> DecryptToBuffer(
+      absl::string_view ciphertext, absl::string_view additional_data,
+      BufferPool* pool) const override;
+
   virtual ~XChacha20Poly1305BoringSsl() {}
 
  private:
@@ -53,11 +63,24 @@ class XChacha20Poly1305BoringSsl : public Aead {
   static const int NONCE_SIZE = 24;
   static const int TAG_SIZE = 16;
 
-  XChacha20Poly1305BoringSsl() = delete;
-  XChacha20Poly1305BoringSsl(absl::string_view key_value, const EVP_AEAD* aead);
+  XChacha20Poly1305BoringSsl() {}
+  crypto::tink::util::Status Init(absl::string_view key_value);
+
+  // Encrypts into 'out', which must have room for NONCE_SIZE +
+  // plaintext.size() + TAG_SIZE bytes.
+  crypto::tink::util::Status Seal(absl::string_view plaintext,
+                                  absl::string_view additional_data,
+                                  uint8_t* out) const;
+  // Decrypts 'ciphertext', which must be at least NONCE_SIZE +
+  // TAG_SIZE bytes long, into 'out', which must have room for the
+  // remaining ciphertext.size() - NONCE_SIZE - TAG_SIZE bytes.
+  crypto::tink::util::Status Open(absl::string_view ciphertext,
+                                  absl::string_view additional_data,
+                                  uint8_t* out) const;
 
-  const std::string key_;
-  const EVP_AEAD* aead_;
+  // Initialized once in Init(), so that Encrypt() and Decrypt() do not
+  // have to set up a context (and allocate) for every message.
+  bssl::ScopedEVP_AEAD_CTX ctx_;
 };
 
 }  // namespace subtle
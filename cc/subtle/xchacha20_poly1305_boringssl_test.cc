@@ -22,6 +22,8 @@
 #include "gtest/gtest.h"
 #include "absl/strings/str_cat.h"
 #include "openssl/err.h"
+#include "tink/subtle/buffer_pool.h"
+#include "tink/subtle/pooled_aead.h"
 #include "tink/util/status.h"
 #include "tink/util/statusor.h"
 #include "tink/util/test_util.h"
@@ -48,6 +50,63 @@ TEST(XChacha20Poly1305BoringSslTest, testBasic) {
   EXPECT_EQ(pt.ValueOrDie(), message);
 }
 
+TEST(XChacha20Poly1305BoringSslTest, testPooledBuffers) {
+  std::string key(test::HexDecodeOrDie(
+      "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"));
+  auto cipher = std::move(XChacha20Poly1305BoringSsl::New(key).ValueOrDie());
+  auto pooled = dynamic_cast<const PooledAead*>(cipher.get());
+  ASSERT_NE(nullptr, pooled);
+  BufferPool pool(BufferPool::kDefaultMaxBuffersPerClass);
+  std::string aad = "Some data to authenticate.";
+  for (const std::string& message : {std::string(""),
+                                     std::string("Some data to encrypt.")}) {
+    auto ct = pooled->EncryptToBuffer(message, aad, &pool);
+    ASSERT_TRUE(ct.ok()) << ct.status();
+    EXPECT_EQ(message.size() + 40, ct.ValueOrDie().size());
+    // The outputs of both interfaces are interchangeable.
+    auto pt = cipher->Decrypt(ct.ValueOrDie().AsStringView(), aad);
+    ASSERT_TRUE(pt.ok()) << pt.status();
+    EXPECT_EQ(message, pt.ValueOrDie());
+    auto pooled_pt = pooled->DecryptToBuffer(
+        cipher->Encrypt(message, aad).ValueOrDie(), aad, &pool);
+    ASSERT_TRUE(pooled_pt.ok()) << pooled_pt.status();
+    EXPECT_EQ(message, pooled_pt.ValueOrDie().AsStringView());
+
+    std::string modified(ct.ValueOrDie().AsStringView());
+    modified[modified.size() - 1] ^= 1;
+    EXPECT_FALSE(pooled->DecryptToBuffer(modified, aad, &pool).ok());
+  }
+  EXPECT_FALSE(pooled->DecryptToBuffer("too short", aad, &pool).ok());
+}
+
+// The context is set up once per key, so a cipher must be reusable for
+// many messages of different sizes.
+TEST(XChacha20Poly1305BoringSslTest, testManyMessages) {
+  std::string key(test::HexDecodeOrDie(
+      "000102030405060708090a0b0c0d0e0f000102030405060708090a0b0c0d0e0f"));
+  auto res = XChacha20Poly1305BoringSsl::New(key);
+  EXPECT_TRUE(res.ok()) << res.status();
+  auto cipher = std::move(res.ValueOrDie());
+  std::vector<std::string> ciphertexts;
+  for (int i = 0; i < 100; i++) {
+    std::string message(i, 'a' + i % 26);
+    std::string aad = absl::StrCat("aad ", i);
+    auto ct = cipher->Encrypt(message, aad);
+    ASSERT_TRUE(ct.ok()) << ct.status();
+    EXPECT_EQ(ct.ValueOrDie().size(), message.size() + 24 + 16);
+    ciphertexts.push_back(ct.ValueOrDie());
+  }
+  for (int i = 0; i < 100; i++) {
+    auto pt = cipher->Decrypt(ciphertexts[i], absl::StrCat("aad ", i));
+    ASSERT_TRUE(pt.ok()) << pt.status();
+    EXPECT_EQ(pt.ValueOrDie(), std::string(i, 'a' + i % 26));
+    // Nonces are random, so no two ciphertexts share a prefix.
+    if (i > 0) {
+      EXPECT_NE(ciphertexts[i].substr(0, 24), ciphertexts[i - 1].substr(0, 24));
+    }
+  }
+}
+
 TEST(XChacha20Poly1305BoringSslTest, testModification) {
   std::string key(test::HexDecodeOrDie(
       "000102030405060708090a0b0c0d0e0f000102030405060708090a0b0c0d0e0f"));
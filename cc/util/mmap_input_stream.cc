@@ -0,0 +1,131 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/util/mmap_input_stream.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+
+#include "tink/input_stream.h"
+#include "tink/util/errors.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+namespace util {
+
+namespace {
+
+// Attempts to close file descriptor fd, while ignoring EINTR.
+int close_ignoring_eintr(int fd) {
+  int result;
+  do {
+    result = close(fd);
+  } while (result < 0 && errno == EINTR);
+  return result;
+}
+
+}  // anonymous namespace
+
+MmapInputStream::MmapInputStream(int file_descriptor, int window_size)
+    : status_(Status::OK),
+      fd_(file_descriptor),
+      window_size_(window_size > 0 ? window_size : 1024 * 1024),  // 1 MB
+      mapping_(nullptr),
+      file_size_(-1),
+      position_(0),
+      window_start_(0),
+      window_end_(0),
+      read_ahead_end_(0) {}
+
+Status MmapInputStream::Map() {
+  struct stat file_stat;
+  if (fstat(fd_, &file_stat) != 0) {
+    return ToStatusF(util::error::INTERNAL, "I/O error upon fstat: %d", errno);
+  }
+  if (!S_ISREG(file_stat.st_mode)) {
+    return Status(util::error::INVALID_ARGUMENT, "not a regular file");
+  }
+  file_size_ = file_stat.st_size;
+  if (file_size_ == 0) return Status::OK;  // Nothing to map.
+  void* mapping = mmap(nullptr, file_size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+  if (mapping == MAP_FAILED) {
+    return ToStatusF(util::error::INTERNAL, "I/O error upon mmap: %d", errno);
+  }
+  // Only a hint, hence errors are ignored.
+  madvise(mapping, file_size_, MADV_SEQUENTIAL);
+  mapping_ = static_cast<const uint8_t*>(mapping);
+  return Status::OK;
+}
+
+crypto::tink::util::StatusOr<int> MmapInputStream::Next(const void** data) {
+  if (!status_.ok()) return status_;
+  if (file_size_ < 0) {  // possible only at the first call to Next()
+    status_ = Map();
+    if (!status_.ok()) return status_;
+  }
+  if (position_ == window_end_) {
+    if (position_ >= file_size_) {
+      status_ = Status(util::error::OUT_OF_RANGE, "EOF");
+      return status_;
+    }
+    window_end_ = std::min<int64_t>(position_ + window_size_, file_size_);
+    // Ask the kernel to start reading the window after this one, so that
+    // it is (mostly) in memory when it is returned.
+    int64_t read_ahead_end =
+        std::min<int64_t>(window_end_ + window_size_, file_size_);
+    if (read_ahead_end_ < read_ahead_end) {
+      static const int64_t page_size = sysconf(_SC_PAGESIZE);
+      int64_t start = std::max(read_ahead_end_, window_end_);
+      start -= start % page_size;
+      madvise(const_cast<uint8_t*>(mapping_) + start, read_ahead_end - start,
+              MADV_WILLNEED);
+      read_ahead_end_ = read_ahead_end;
+    }
+  }
+  // Returns the rest of the current window, i.e. exactly the backed-up
+  // bytes, if any.
+  int count = window_end_ - position_;
+  window_start_ = position_;
+  position_ = window_end_;
+  *data = mapping_ + window_start_;
+  return count;
+}
+
+void MmapInputStream::BackUp(int count) {
+  if (!status_.ok() || count < 1) return;
+  position_ -= std::min<int64_t>(count, position_ - window_start_);
+}
+
+MmapInputStream::~MmapInputStream() {
+  if (mapping_ != nullptr) {
+    munmap(const_cast<uint8_t*>(mapping_), file_size_);
+  }
+  close_ignoring_eintr(fd_);
+}
+
+int64_t MmapInputStream::Position() const {
+  return position_;
+}
+
+}  // namespace util
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,73 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_UTIL_MMAP_INPUT_STREAM_H_
+#define TINK_UTIL_MMAP_INPUT_STREAM_H_
+
+#include <cstdint>
+
+#include "tink/input_stream.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+namespace util {
+
+// An InputStream that reads a regular file via a memory mapping.
+// Unlike FileInputStream, which copies the contents into its own buffer,
+// Next() returns windows directly into the mapping, and the kernel is
+// asked to read ahead of the current window.
+//
+// The file is read from its beginning, regardless of the current offset
+// of the file descriptor.  The file must not be truncated while it is
+// read, as accessing a mapped page past the end of a file raises SIGBUS.
+class MmapInputStream : public crypto::tink::InputStream {
+ public:
+  // Constructs an InputStream that will read from the file specified
+  // via 'file_descriptor', returning windows of the specified size, if any
+  // (if no legal 'window_size' is given, a reasonable default will be used).
+  // Takes the ownership of the file, and will close it upon destruction.
+  explicit MmapInputStream(int file_descriptor, int window_size = -1);
+
+  ~MmapInputStream() override;
+
+  crypto::tink::util::StatusOr<int> Next(const void** data) override;
+
+  void BackUp(int count) override;
+
+  int64_t Position() const override;
+
+ private:
+  // Maps the file; called by the first call to Next().
+  util::Status Map();
+
+  util::Status status_;
+  int fd_;
+  const int window_size_;
+  const uint8_t* mapping_;  // nullptr until the first call to Next()
+  int64_t file_size_;
+  int64_t position_;        // current position in the file
+  int64_t window_start_;    // position at which the last Next() started
+  int64_t window_end_;      // end of the current window
+  int64_t read_ahead_end_;  // end of the range requested from the kernel
+};
+
+}  // namespace util
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_UTIL_MMAP_INPUT_STREAM_H_
@@ -0,0 +1,186 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/util/mmap_input_stream.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tink/subtle/random.h"
+#include "tink/util/status.h"
+#include "tink/util/test_util.h"
+
+namespace crypto {
+namespace tink {
+namespace {
+
+// Creates a new test file with the specified 'filename', writes 'size' random
+// bytes to the file, and returns a file descriptor for reading from the file.
+// A copy of the bytes written to the file is returned in 'file_contents'.
+int GetTestFileDescriptor(
+    absl::string_view filename, int size, std::string* file_contents) {
+  std::string full_filename =
+      absl::StrCat(crypto::tink::test::TmpDir(), "/", filename);
+  (*file_contents) = subtle::Random::GetRandomBytes(size);
+  mode_t mode = S_IWUSR | S_IRUSR | S_IRGRP | S_IROTH;
+  int fd = open(full_filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, mode);
+  if (fd == -1) {
+    std::clog << "Cannot create file " << full_filename
+              << " error: " << errno << std::endl;
+    exit(1);
+  }
+  if (write(fd, file_contents->data(), size) != size) {
+    std::clog << "Failed to write " << size << " bytes to file "
+              << full_filename << " error: " << errno << std::endl;
+    exit(1);
+  }
+  close(fd);
+  fd = open(full_filename.c_str(), O_RDONLY);
+  if (fd == -1) {
+    std::clog << "Cannot re-open file " << full_filename
+              << " error: " << errno << std::endl;
+    exit(1);
+  }
+  return fd;
+}
+
+// Reads the specified 'input_stream' until no more bytes can be read,
+// and puts the read bytes into 'contents'.
+// Returns the status of the last input_stream->Next()-operation.
+util::Status ReadTillEnd(util::MmapInputStream* input_stream,
+                         std::string* contents) {
+  contents->clear();
+  const void* buffer;
+  auto next_result = input_stream->Next(&buffer);
+  while (next_result.ok()) {
+    contents->append(static_cast<const char*>(buffer),
+                     next_result.ValueOrDie());
+    next_result = input_stream->Next(&buffer);
+  }
+  return next_result.status();
+}
+
+TEST(MmapInputStreamTest, ReadingStreams) {
+  std::vector<int> stream_sizes = {0, 10, 100, 1000, 10000, 100000, 1000000,
+                                   3 * 1024 * 1024 + 17};
+  for (auto stream_size : stream_sizes) {
+    std::string file_contents;
+    std::string filename = absl::StrCat(stream_size, "_mmap_reading_test.bin");
+    int input_fd = GetTestFileDescriptor(filename, stream_size, &file_contents);
+    auto input_stream = absl::make_unique<util::MmapInputStream>(input_fd);
+    std::string stream_contents;
+    auto status = ReadTillEnd(input_stream.get(), &stream_contents);
+    EXPECT_EQ(util::error::OUT_OF_RANGE, status.error_code());
+    EXPECT_EQ("EOF", status.error_message());
+    EXPECT_EQ(file_contents, stream_contents);
+    EXPECT_EQ(stream_size, input_stream->Position());
+  }
+}
+
+TEST(MmapInputStreamTest, CustomWindowSizes) {
+  std::vector<int> window_sizes = {1, 10, 100, 1000, 10000, 4096, 65536};
+  int stream_size = 100000;
+  for (auto window_size : window_sizes) {
+    std::string file_contents;
+    std::string filename =
+        absl::StrCat(window_size, "_mmap_window_size_test.bin");
+    int input_fd = GetTestFileDescriptor(filename, stream_size, &file_contents);
+    auto input_stream =
+        absl::make_unique<util::MmapInputStream>(input_fd, window_size);
+    const void* buffer;
+    auto next_result = input_stream->Next(&buffer);
+    EXPECT_TRUE(next_result.ok()) << next_result.status();
+    EXPECT_EQ(window_size, next_result.ValueOrDie());
+    EXPECT_EQ(file_contents.substr(0, window_size),
+              std::string(static_cast<const char*>(buffer), window_size));
+    std::string rest;
+    EXPECT_EQ(util::error::OUT_OF_RANGE,
+              ReadTillEnd(input_stream.get(), &rest).error_code());
+    EXPECT_EQ(file_contents.substr(window_size), rest);
+  }
+}
+
+TEST(MmapInputStreamTest, BackupAndPosition) {
+  int stream_size = 100000;
+  int window_size = 1234;
+  const void* buffer;
+  std::string file_contents;
+  std::string filename = absl::StrCat(window_size, "_mmap_backup_test.bin");
+  int input_fd = GetTestFileDescriptor(filename, stream_size, &file_contents);
+
+  auto input_stream =
+      absl::make_unique<util::MmapInputStream>(input_fd, window_size);
+  EXPECT_EQ(0, input_stream->Position());
+  auto next_result = input_stream->Next(&buffer);
+  EXPECT_TRUE(next_result.ok()) << next_result.status();
+  EXPECT_EQ(window_size, next_result.ValueOrDie());
+  EXPECT_EQ(window_size, input_stream->Position());
+
+  // BackUp several times, but in total fewer bytes than returned by Next().
+  std::vector<int> backup_sizes = {0, 1, 5, 0, 10, 100, -42, 400, 20, -100};
+  int total_backup_size = 0;
+  for (auto backup_size : backup_sizes) {
+    input_stream->BackUp(backup_size);
+    total_backup_size += std::max(0, backup_size);
+    EXPECT_EQ(window_size - total_backup_size, input_stream->Position());
+  }
+  // Call Next(), it should return exactly the backed up bytes.
+  next_result = input_stream->Next(&buffer);
+  EXPECT_TRUE(next_result.ok()) << next_result.status();
+  EXPECT_EQ(total_backup_size, next_result.ValueOrDie());
+  EXPECT_EQ(window_size, input_stream->Position());
+  EXPECT_EQ(
+      file_contents.substr(window_size - total_backup_size, total_backup_size),
+      std::string(static_cast<const char*>(buffer), total_backup_size));
+
+  // Call Next() again, it should return the second window.
+  next_result = input_stream->Next(&buffer);
+  EXPECT_TRUE(next_result.ok()) << next_result.status();
+  EXPECT_EQ(window_size, next_result.ValueOrDie());
+  EXPECT_EQ(2 * window_size, input_stream->Position());
+
+  // BackUp more than the returned window_size.
+  input_stream->BackUp(window_size / 2);
+  input_stream->BackUp(window_size);
+  EXPECT_EQ(window_size, input_stream->Position());
+  next_result = input_stream->Next(&buffer);
+  EXPECT_TRUE(next_result.ok()) << next_result.status();
+  EXPECT_EQ(window_size, next_result.ValueOrDie());
+  EXPECT_EQ(file_contents.substr(window_size, window_size),
+            std::string(static_cast<const char*>(buffer), window_size));
+}
+
+TEST(MmapInputStreamTest, NotARegularFile) {
+  int pipe_fds[2];
+  ASSERT_EQ(0, pipe(pipe_fds));
+  auto input_stream = absl::make_unique<util::MmapInputStream>(pipe_fds[0]);
+  const void* buffer;
+  auto next_result = input_stream->Next(&buffer);
+  EXPECT_EQ(util::error::INVALID_ARGUMENT, next_result.status().error_code());
+  close(pipe_fds[1]);
+}
+
+}  // namespace
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,143 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/util/mmap_output_stream.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+
+#include "tink/output_stream.h"
+#include "tink/util/errors.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+namespace util {
+
+namespace {
+
+// Attempts to close file descriptor fd, while ignoring EINTR.
+int close_ignoring_eintr(int fd) {
+  int result;
+  do {
+    result = close(fd);
+  } while (result < 0 && errno == EINTR);
+  return result;
+}
+
+// Returns 'window_size' rounded up to a multiple of the page size,
+// as mmap() requires page-aligned file offsets.
+int PageAlignedWindowSize(int window_size) {
+  static const int page_size = sysconf(_SC_PAGESIZE);
+  if (window_size <= 0) window_size = 1024 * 1024;  // 1 MB
+  return (window_size + page_size - 1) / page_size * page_size;
+}
+
+}  // anonymous namespace
+
+MmapOutputStream::MmapOutputStream(int file_descriptor, int window_size)
+    : status_(Status::OK),
+      fd_(file_descriptor),
+      window_size_(PageAlignedWindowSize(window_size)),
+      window_(nullptr),
+      window_start_(0),
+      position_(0),
+      next_start_(0) {}
+
+Status MmapOutputStream::MapNextWindow() {
+  int64_t start = 0;
+  if (window_ != nullptr) {
+    start = window_start_ + window_size_;
+    munmap(window_, window_size_);
+    window_ = nullptr;
+  }
+  if (ftruncate(fd_, start + window_size_) != 0) {
+    return ToStatusF(util::error::INTERNAL, "I/O error upon truncate: %d",
+                     errno);
+  }
+  void* window = mmap(nullptr, window_size_, PROT_READ | PROT_WRITE,
+                      MAP_SHARED, fd_, start);
+  if (window == MAP_FAILED) {
+    return ToStatusF(util::error::INTERNAL, "I/O error upon mmap: %d", errno);
+  }
+  window_ = static_cast<uint8_t*>(window);
+  window_start_ = start;
+  return Status::OK;
+}
+
+crypto::tink::util::StatusOr<int> MmapOutputStream::Next(void** data) {
+  if (!status_.ok()) return status_;
+  if (window_ == nullptr || position_ == window_start_ + window_size_) {
+    status_ = MapNextWindow();
+    if (!status_.ok()) return status_;
+  }
+  // Returns the rest of the current window, including any backed-up space.
+  int count = window_start_ + window_size_ - position_;
+  *data = window_ + (position_ - window_start_);
+  next_start_ = position_;
+  position_ += count;
+  return count;
+}
+
+void MmapOutputStream::BackUp(int count) {
+  if (!status_.ok() || count < 1) return;
+  position_ -= std::min<int64_t>(count, position_ - next_start_);
+}
+
+MmapOutputStream::~MmapOutputStream() {
+  if (status_.ok()) {
+    Close().IgnoreError();
+    return;
+  }
+  // Close() has been called, or an error occurred.
+  if (window_ != nullptr) munmap(window_, window_size_);
+  if (fd_ >= 0) close_ignoring_eintr(fd_);
+}
+
+Status MmapOutputStream::Close() {
+  if (!status_.ok()) return status_;
+  if (window_ != nullptr) {
+    munmap(window_, window_size_);
+    window_ = nullptr;
+  }
+  // Cuts off the unused part of the last window.
+  if (ftruncate(fd_, position_) != 0) {
+    status_ = ToStatusF(
+        util::error::INTERNAL, "I/O error upon truncate: %d", errno);
+    return status_;
+  }
+  int result = close_ignoring_eintr(fd_);
+  fd_ = -1;
+  if (result == -1) {
+    status_ = ToStatusF(
+        util::error::INTERNAL, "I/O error upon close: %d", errno);
+    return status_;
+  }
+  status_ = Status(util::error::FAILED_PRECONDITION, "Stream closed");
+  return Status::OK;
+}
+
+int64_t MmapOutputStream::Position() const {
+  return position_;
+}
+
+}  // namespace util
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,76 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_UTIL_MMAP_OUTPUT_STREAM_H_
+#define TINK_UTIL_MMAP_OUTPUT_STREAM_H_
+
+#include <cstdint>
+
+#include "tink/output_stream.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+namespace util {
+
+// An OutputStream that writes a regular file via a memory mapping.
+// Unlike FileOutputStream, which collects the data in its own buffer and
+// then copies it to the file with write(), Next() returns windows
+// directly into a shared mapping of the file.  The file is extended
+// with ftruncate() one window at a time, and cut to the number of bytes
+// written upon Close().
+//
+// The file is written from its beginning, regardless of the current
+// offset of the file descriptor; any previous contents are replaced.
+// A shared writable mapping requires the file to be opened with O_RDWR.
+class MmapOutputStream : public crypto::tink::OutputStream {
+ public:
+  // Constructs an OutputStream that will write to the file specified
+  // via 'file_descriptor', returning windows of the specified size, if any
+  // (if no legal 'window_size' is given, a reasonable default will be used;
+  // the size is rounded up to a multiple of the page size).
+  // Takes the ownership of the file, and will close it upon destruction.
+  explicit MmapOutputStream(int file_descriptor, int window_size = -1);
+
+  ~MmapOutputStream() override;
+
+  crypto::tink::util::StatusOr<int> Next(void** data) override;
+
+  void BackUp(int count) override;
+
+  crypto::tink::util::Status Close() override;
+
+  int64_t Position() const override;
+
+ private:
+  // Replaces the current window by the one that follows it.
+  util::Status MapNextWindow();
+
+  util::Status status_;
+  int fd_;
+  const int window_size_;
+  uint8_t* window_;       // mapping of the current window, or nullptr
+  int64_t window_start_;  // position of window_ in the file
+  int64_t position_;      // current position in the file
+  int64_t next_start_;    // position at which the last Next() started
+};
+
+}  // namespace util
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_UTIL_MMAP_OUTPUT_STREAM_H_
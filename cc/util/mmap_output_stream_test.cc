@@ -0,0 +1,221 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/util/mmap_output_stream.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tink/subtle/random.h"
+#include "tink/util/status.h"
+#include "tink/util/test_util.h"
+
+namespace crypto {
+namespace tink {
+namespace {
+
+// Creates a new test file with the specified 'filename', ready for writing.
+// The stream maps the file, hence it is opened for reading, too.
+int GetTestFileDescriptor(absl::string_view filename) {
+  std::string full_filename =
+      absl::StrCat(crypto::tink::test::TmpDir(), "/", filename);
+  mode_t mode = S_IWUSR | S_IRUSR | S_IRGRP | S_IROTH;
+  int fd = open(full_filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, mode);
+  if (fd == -1) {
+    std::clog << "Cannot create file " << full_filename
+              << " error: " << errno << std::endl;
+    exit(1);
+  }
+  return fd;
+}
+
+// Writes 'contents' the specified 'output_stream', and closes the stream.
+// Returns the status of output_stream->Close()-operation, or a non-OK status
+// of a prior output_stream->Next()-operation, if any.
+util::Status WriteToStream(util::MmapOutputStream* output_stream,
+                           absl::string_view contents) {
+  void* buffer;
+  int pos = 0;
+  int remaining = contents.length();
+  int available_space = 0;
+  int available_bytes = 0;
+  while (remaining > 0) {
+    auto next_result = output_stream->Next(&buffer);
+    if (!next_result.ok()) return next_result.status();
+    available_space = next_result.ValueOrDie();
+    available_bytes = std::min(available_space, remaining);
+    memcpy(buffer, contents.data() + pos, available_bytes);
+    remaining -= available_bytes;
+    pos += available_bytes;
+  }
+  if (available_space > available_bytes) {
+    output_stream->BackUp(available_space - available_bytes);
+  }
+  return output_stream->Close();
+}
+
+// Reads the test file specified by 'filename', and returns its contents.
+std::string ReadFile(std::string filename) {
+  std::string full_filename =
+      absl::StrCat(crypto::tink::test::TmpDir(), "/", filename);
+  int fd = open(full_filename.c_str(), O_RDONLY);
+  if (fd == -1) {
+    std::clog << "Cannot open file " << full_filename
+              << " error: " << errno << std::endl;
+    exit(1);
+  }
+  std::string contents;
+  int buffer_size = 128 * 1024;
+  auto buffer = absl::make_unique<uint8_t[]>(buffer_size);
+  int read_result = read(fd, buffer.get(), buffer_size);
+  while (read_result > 0) {
+    contents.append(reinterpret_cast<const char*>(buffer.get()), read_result);
+    read_result = read(fd, buffer.get(), buffer_size);
+  }
+  close(fd);
+  return contents;
+}
+
+TEST(MmapOutputStreamTest, WritingStreams) {
+  std::vector<int> stream_sizes = {0, 10, 100, 1000, 10000, 100000, 1000000,
+                                   3 * 1024 * 1024 + 17};
+  for (auto stream_size : stream_sizes) {
+    std::string stream_contents = subtle::Random::GetRandomBytes(stream_size);
+    std::string filename = absl::StrCat(stream_size, "_mmap_writing_test.bin");
+    int output_fd = GetTestFileDescriptor(filename);
+    auto output_stream = absl::make_unique<util::MmapOutputStream>(output_fd);
+    auto status = WriteToStream(output_stream.get(), stream_contents);
+    EXPECT_TRUE(status.ok()) << status;
+    EXPECT_EQ(stream_size, output_stream->Position());
+    EXPECT_EQ(stream_contents, ReadFile(filename));
+  }
+}
+
+TEST(MmapOutputStreamTest, CustomWindowSizes) {
+  int page_size = sysconf(_SC_PAGESIZE);
+  std::vector<int> window_sizes = {1, 100, page_size, page_size + 1,
+                                   10 * page_size};
+  int stream_size = 1024 * 1024 + 5;
+  std::string stream_contents = subtle::Random::GetRandomBytes(stream_size);
+  for (auto window_size : window_sizes) {
+    std::string filename =
+        absl::StrCat(window_size, "_mmap_window_size_test.bin");
+    int output_fd = GetTestFileDescriptor(filename);
+    auto output_stream =
+        absl::make_unique<util::MmapOutputStream>(output_fd, window_size);
+    void* buffer;
+    auto next_result = output_stream->Next(&buffer);
+    EXPECT_TRUE(next_result.ok()) << next_result.status();
+    // Windows are rounded up to whole pages.
+    int expected_size = (window_size + page_size - 1) / page_size * page_size;
+    EXPECT_EQ(expected_size, next_result.ValueOrDie());
+    output_stream->BackUp(expected_size);
+    auto status = WriteToStream(output_stream.get(), stream_contents);
+    EXPECT_TRUE(status.ok()) << status;
+    EXPECT_EQ(stream_contents, ReadFile(filename));
+  }
+}
+
+TEST(MmapOutputStreamTest, BackupAndPosition) {
+  int page_size = sysconf(_SC_PAGESIZE);
+  void* buffer;
+  std::string stream_contents = subtle::Random::GetRandomBytes(3 * page_size);
+  std::string filename = "mmap_backup_test.bin";
+  int output_fd = GetTestFileDescriptor(filename);
+  auto output_stream =
+      absl::make_unique<util::MmapOutputStream>(output_fd, page_size);
+  EXPECT_EQ(0, output_stream->Position());
+  auto next_result = output_stream->Next(&buffer);
+  EXPECT_TRUE(next_result.ok()) << next_result.status();
+  EXPECT_EQ(page_size, next_result.ValueOrDie());
+  EXPECT_EQ(page_size, output_stream->Position());
+  std::memcpy(buffer, stream_contents.data(), page_size);
+
+  // BackUp several times, but in total fewer bytes than returned by Next().
+  std::vector<int> backup_sizes = {0, 1, 5, 0, 10, 100, -42, 400, 20, -100};
+  int total_backup_size = 0;
+  for (auto backup_size : backup_sizes) {
+    output_stream->BackUp(backup_size);
+    total_backup_size += std::max(0, backup_size);
+    EXPECT_EQ(page_size - total_backup_size, output_stream->Position());
+  }
+  // Call Next(), it should return exactly the backed up space.
+  next_result = output_stream->Next(&buffer);
+  EXPECT_TRUE(next_result.ok()) << next_result.status();
+  EXPECT_EQ(total_backup_size, next_result.ValueOrDie());
+  EXPECT_EQ(page_size, output_stream->Position());
+  std::memcpy(buffer, stream_contents.data() + page_size - total_backup_size,
+              total_backup_size);
+
+  // BackUp more than returned by Next(); only its space is backed up.
+  next_result = output_stream->Next(&buffer);
+  EXPECT_TRUE(next_result.ok()) << next_result.status();
+  EXPECT_EQ(page_size, next_result.ValueOrDie());
+  std::memcpy(buffer, stream_contents.data() + page_size, page_size);
+  output_stream->BackUp(page_size / 2);
+  output_stream->BackUp(2 * page_size);
+  EXPECT_EQ(page_size, output_stream->Position());
+
+  auto status = WriteToStream(output_stream.get(),
+                              absl::string_view(stream_contents).substr(
+                                  page_size));
+  EXPECT_TRUE(status.ok()) << status;
+  EXPECT_EQ(stream_contents, ReadFile(filename));
+
+  // The stream is closed.
+  EXPECT_FALSE(output_stream->Next(&buffer).ok());
+  EXPECT_FALSE(output_stream->Close().ok());
+}
+
+TEST(MmapOutputStreamTest, ReplacesPreviousContents) {
+  std::string filename = "mmap_replace_test.bin";
+  int output_fd = GetTestFileDescriptor(filename);
+  std::string old_contents = subtle::Random::GetRandomBytes(100000);
+  ASSERT_EQ(old_contents.size(),
+            write(output_fd, old_contents.data(), old_contents.size()));
+  auto output_stream = absl::make_unique<util::MmapOutputStream>(output_fd);
+  std::string stream_contents = subtle::Random::GetRandomBytes(1000);
+  auto status = WriteToStream(output_stream.get(), stream_contents);
+  EXPECT_TRUE(status.ok()) << status;
+  EXPECT_EQ(stream_contents, ReadFile(filename));
+}
+
+TEST(MmapOutputStreamTest, WriteOnlyDescriptor) {
+  std::string full_filename =
+      absl::StrCat(crypto::tink::test::TmpDir(), "/mmap_write_only_test.bin");
+  int output_fd = open(full_filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC,
+                       S_IWUSR | S_IRUSR);
+  ASSERT_NE(-1, output_fd);
+  // A shared writable mapping requires a descriptor opened for reading.
+  auto output_stream = absl::make_unique<util::MmapOutputStream>(output_fd);
+  void* buffer;
+  auto next_result = output_stream->Next(&buffer);
+  EXPECT_EQ(util::error::INTERNAL, next_result.status().error_code());
+  EXPECT_FALSE(output_stream->Close().ok());
+}
+
+}  // namespace
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,339 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/util/parallel_file_crypter.h"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <functional>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "tink/subtle/stream_segment_decrypter.h"
+#include "tink/subtle/stream_segment_encrypter.h"
+#include "tink/util/errors.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "tink/util/thread_pool.h"
+
+namespace crypto {
+namespace tink {
+namespace util {
+
+namespace {
+
+// Each thread reads and writes about this many bytes at a time.
+constexpr int64_t kBatchSize = 1 << 20;  // 1 MB
+
+// Positions of the segments of a stream, in the plaintext and in the
+// ciphertext file.  The first segment is shorter than the others by
+// 'ciphertext_offset' bytes, of which 'header_size' hold the header.
+class SegmentLayout {
+ public:
+  SegmentLayout(int header_size, int ciphertext_offset,
+                int plaintext_segment_size, int ciphertext_segment_size)
+      : header_size_(header_size),
+        first_plaintext_size_(plaintext_segment_size - ciphertext_offset),
+        plaintext_segment_size_(plaintext_segment_size),
+        first_ciphertext_size_(ciphertext_segment_size - ciphertext_offset),
+        ciphertext_segment_size_(ciphertext_segment_size) {}
+
+  int64_t header_size() const { return header_size_; }
+  int64_t overhead() const {
+    return ciphertext_segment_size_ - plaintext_segment_size_;
+  }
+
+  // Offset of segment 'i' in the plaintext.
+  int64_t PlaintextOffset(int64_t i) const {
+    if (i == 0) return 0;
+    return first_plaintext_size_ + (i - 1) * plaintext_segment_size_;
+  }
+
+  // Offset of segment 'i' in the ciphertext file.
+  int64_t CiphertextOffset(int64_t i) const {
+    if (i == 0) return header_size_;
+    return header_size_ + first_ciphertext_size_ +
+           (i - 1) * ciphertext_segment_size_;
+  }
+
+  // Number of segments of a plaintext of 'size' bytes.  Only an empty
+  // plaintext has an empty segment.
+  int64_t SegmentCountForPlaintext(int64_t size) const {
+    return SegmentCount(size, first_plaintext_size_, plaintext_segment_size_);
+  }
+
+  // Number of segments of a ciphertext file of 'size' bytes
+  // (including the header).
+  int64_t SegmentCountForCiphertext(int64_t size) const {
+    return SegmentCount(size - header_size_, first_ciphertext_size_,
+                        ciphertext_segment_size_);
+  }
+
+ private:
+  static int64_t SegmentCount(int64_t size, int64_t first_size,
+                              int64_t segment_size) {
+    if (size <= first_size) return 1;
+    return 1 + (size - first_size + segment_size - 1) / segment_size;
+  }
+
+  const int64_t header_size_;
+  const int64_t first_plaintext_size_;
+  const int64_t plaintext_segment_size_;
+  const int64_t first_ciphertext_size_;
+  const int64_t ciphertext_segment_size_;
+};
+
+// Reads exactly 'count' bytes at 'offset' of 'fd', while ignoring EINTR.
+util::Status ReadFully(int fd, uint8_t* buf, int64_t count, int64_t offset) {
+  while (count > 0) {
+    ssize_t result = pread(fd, buf, count, offset);
+    if (result < 0 && errno == EINTR) continue;
+    if (result < 0) {
+      return ToStatusF(util::error::INTERNAL, "I/O error upon read: %d",
+                       errno);
+    }
+    if (result == 0) {
+      return util::Status(util::error::INTERNAL,
+                          "I/O error: unexpected end of file");
+    }
+    buf += result;
+    count -= result;
+    offset += result;
+  }
+  return util::Status::OK;
+}
+
+// Writes 'count' bytes at 'offset' of 'fd', while ignoring EINTR.
+util::Status WriteFully(int fd, const uint8_t* buf, int64_t count,
+                        int64_t offset) {
+  while (count > 0) {
+    ssize_t result = pwrite(fd, buf, count, offset);
+    if (result < 0 && errno == EINTR) continue;
+    if (result <= 0) {
+      return ToStatusF(util::error::INTERNAL, "I/O error upon write: %d",
+                       errno);
+    }
+    buf += result;
+    count -= result;
+    offset += result;
+  }
+  return util::Status::OK;
+}
+
+util::StatusOr<int64_t> RegularFileSize(int fd) {
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0) {
+    return ToStatusF(util::error::INTERNAL, "I/O error upon fstat: %d",
+                     errno);
+  }
+  if (!S_ISREG(file_stat.st_mode)) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+                        "input is not a regular file");
+  }
+  return static_cast<int64_t>(file_stat.st_size);
+}
+
+util::Status Truncate(int fd, int64_t size) {
+  if (ftruncate(fd, size) != 0) {
+    return ToStatusF(util::error::INTERNAL, "I/O error upon truncate: %d",
+                     errno);
+  }
+  return util::Status::OK;
+}
+
+// Transforms the segments [begin, end) of a stream.
+using ProcessBatch = std::function<util::Status(int64_t, int64_t)>;
+
+// Splits the segments of a stream into 'thread_count' contiguous ranges,
+// and processes each range on its own thread, in batches of at most
+// 'segments_per_batch' segments.  Returns the first error; once a batch
+// fails, the other threads stop at their next batch.
+util::Status RunInParallel(int64_t segment_count, int64_t segments_per_batch,
+                           int thread_count,
+                           const ProcessBatch& process_batch) {
+  int64_t range_count = std::min<int64_t>(thread_count, segment_count);
+  std::vector<util::Status> statuses(range_count);
+  std::atomic<bool> failed(false);
+  {
+    ThreadPool pool(range_count);
+    for (int64_t r = 0; r < range_count; r++) {
+      int64_t begin = segment_count * r / range_count;
+      int64_t end = segment_count * (r + 1) / range_count;
+      pool.Schedule([&, r, begin, end]() {
+        for (int64_t s = begin; s < end && !failed; s += segments_per_batch) {
+          auto status =
+              process_batch(s, std::min(s + segments_per_batch, end));
+          if (!status.ok()) {
+            statuses[r] = status;
+            failed = true;
+            return;
+          }
+        }
+      });
+    }
+  }  // Waits for all ranges.
+  for (const auto& status : statuses) {
+    if (!status.ok()) return status;
+  }
+  return util::Status::OK;
+}
+
+}  // anonymous namespace
+
+util::Status EncryptFileInParallel(
+    std::unique_ptr<subtle::StreamSegmentEncrypter> encrypter,
+    int plaintext_fd, int ciphertext_fd, int thread_count) {
+  if (encrypter == nullptr) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+                        "encrypter must be non-null");
+  }
+  if (encrypter->get_segment_number() != 0) {
+    return util::Status(util::error::FAILED_PRECONDITION,
+                        "encrypter has already been used");
+  }
+  if (thread_count < 1) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+                        "thread_count must be positive");
+  }
+  const std::vector<uint8_t>& header = encrypter->get_header();
+  SegmentLayout layout(header.size(), encrypter->get_ciphertext_offset(),
+                       encrypter->get_plaintext_segment_size(),
+                       encrypter->get_ciphertext_segment_size());
+  auto size_result = RegularFileSize(plaintext_fd);
+  if (!size_result.ok()) return size_result.status();
+  int64_t plaintext_size = size_result.ValueOrDie();
+  int64_t segment_count = layout.SegmentCountForPlaintext(plaintext_size);
+
+  auto status = Truncate(ciphertext_fd, layout.CiphertextOffset(0) +
+                                            plaintext_size +
+                                            segment_count * layout.overhead());
+  if (!status.ok()) return status;
+  status = WriteFully(ciphertext_fd, header.data(), header.size(), 0);
+  if (!status.ok()) return status;
+
+  const subtle::StreamSegmentEncrypter& shared_encrypter = *encrypter;
+  int64_t segments_per_batch = std::max<int64_t>(
+      1, kBatchSize / encrypter->get_ciphertext_segment_size());
+  return RunInParallel(
+      segment_count, segments_per_batch, thread_count,
+      [&](int64_t begin, int64_t end) -> util::Status {
+        int64_t pt_begin = layout.PlaintextOffset(begin);
+        int64_t pt_end = std::min(layout.PlaintextOffset(end), plaintext_size);
+        int64_t ct_begin = layout.CiphertextOffset(begin);
+        // One extra byte keeps the buffers non-null for empty plaintexts.
+        std::vector<uint8_t> pt(pt_end - pt_begin + 1);
+        std::vector<uint8_t> ct(pt_end - pt_begin +
+                                (end - begin) * layout.overhead() + 1);
+        auto status = ReadFully(plaintext_fd, pt.data(), pt_end - pt_begin,
+                                pt_begin);
+        if (!status.ok()) return status;
+        for (int64_t i = begin; i < end; i++) {
+          int64_t pt_offset = layout.PlaintextOffset(i) - pt_begin;
+          int64_t pt_size =
+              std::min(layout.PlaintextOffset(i + 1), plaintext_size) -
+              layout.PlaintextOffset(i);
+          int64_t ct_offset = layout.CiphertextOffset(i) - ct_begin;
+          status = shared_encrypter.EncryptSegmentAt(
+              absl::MakeConstSpan(pt.data() + pt_offset, pt_size), i,
+              /* is_last_segment = */ i == segment_count - 1,
+              absl::MakeSpan(ct.data() + ct_offset,
+                             pt_size + layout.overhead()));
+          if (!status.ok()) return status;
+        }
+        return WriteFully(ciphertext_fd, ct.data(), ct.size() - 1, ct_begin);
+      });
+}
+
+util::Status DecryptFileInParallel(
+    std::unique_ptr<subtle::StreamSegmentDecrypter> decrypter,
+    int ciphertext_fd, int plaintext_fd, int thread_count) {
+  if (decrypter == nullptr) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+                        "decrypter must be non-null");
+  }
+  if (thread_count < 1) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+                        "thread_count must be positive");
+  }
+  SegmentLayout layout(decrypter->get_header_size(),
+                       decrypter->get_ciphertext_offset(),
+                       decrypter->get_plaintext_segment_size(),
+                       decrypter->get_ciphertext_segment_size());
+  auto size_result = RegularFileSize(ciphertext_fd);
+  if (!size_result.ok()) return size_result.status();
+  int64_t ciphertext_size = size_result.ValueOrDie();
+  if (ciphertext_size < layout.header_size() + layout.overhead()) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+                        "ciphertext too short");
+  }
+  std::vector<uint8_t> header(layout.header_size());
+  auto status = ReadFully(ciphertext_fd, header.data(), header.size(), 0);
+  if (!status.ok()) return status;
+  status = decrypter->Init(header);
+  if (!status.ok()) return status;
+
+  int64_t segment_count = layout.SegmentCountForCiphertext(ciphertext_size);
+  if (ciphertext_size - layout.CiphertextOffset(segment_count - 1) <
+      layout.overhead()) {
+    return util::Status(util::error::INVALID_ARGUMENT,
+                        "last segment too short");
+  }
+  int64_t plaintext_size = ciphertext_size - layout.header_size() -
+                           segment_count * layout.overhead();
+  status = Truncate(plaintext_fd, plaintext_size);
+  if (!status.ok()) return status;
+
+  const subtle::StreamSegmentDecrypter& shared_decrypter = *decrypter;
+  int64_t segments_per_batch = std::max<int64_t>(
+      1, kBatchSize / decrypter->get_ciphertext_segment_size());
+  return RunInParallel(
+      segment_count, segments_per_batch, thread_count,
+      [&](int64_t begin, int64_t end) -> util::Status {
+        int64_t ct_begin = layout.CiphertextOffset(begin);
+        int64_t ct_end =
+            std::min(layout.CiphertextOffset(end), ciphertext_size);
+        int64_t pt_begin = layout.PlaintextOffset(begin);
+        // One extra byte keeps the buffers non-null for empty plaintexts.
+        std::vector<uint8_t> ct(ct_end - ct_begin + 1);
+        std::vector<uint8_t> pt(ct_end - ct_begin -
+                                (end - begin) * layout.overhead() + 1);
+        auto status = ReadFully(ciphertext_fd, ct.data(), ct_end - ct_begin,
+                                ct_begin);
+        if (!status.ok()) return status;
+        for (int64_t i = begin; i < end; i++) {
+          int64_t ct_offset = layout.CiphertextOffset(i) - ct_begin;
+          int64_t ct_size =
+              std::min(layout.CiphertextOffset(i + 1), ciphertext_size) -
+              layout.CiphertextOffset(i);
+          int64_t pt_offset = layout.PlaintextOffset(i) - pt_begin;
+          status = shared_decrypter.DecryptSegmentAt(
+              absl::MakeConstSpan(ct.data() + ct_offset, ct_size), i,
+              /* is_last_segment = */ i == segment_count - 1,
+              absl::MakeSpan(pt.data() + pt_offset,
+                             ct_size - layout.overhead()));
+          if (!status.ok()) return status;
+        }
+        return WriteFully(plaintext_fd, pt.data(), pt.size() - 1, pt_begin);
+      });
+}
+
+}  // namespace util
+}  // namespace tink
+}  // namespace crypto
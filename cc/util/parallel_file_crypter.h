@@ -0,0 +1,68 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_UTIL_PARALLEL_FILE_CRYPTER_H_
+#define TINK_UTIL_PARALLEL_FILE_CRYPTER_H_
+
+#include <memory>
+
+#include "tink/subtle/stream_segment_decrypter.h"
+#include "tink/subtle/stream_segment_encrypter.h"
+#include "tink/util/status.h"
+
+namespace crypto {
+namespace tink {
+namespace util {
+
+// Encryption and decryption of whole files with several threads.
+//
+// Streaming AEAD ciphertexts consist of a header followed by segments of
+// fixed size (only the first and the last segment are shorter), so the
+// position of each segment in the plaintext and in the ciphertext file
+// is known in advance.  The functions below split the segments into
+// 'thread_count' contiguous ranges, and each thread reads, encrypts
+// (resp. decrypts) and writes its range with pread()/pwrite(), in batches
+// of about 1 MB.  The output is the same as that of
+// StreamingAeadEncryptingStream (resp. StreamingAeadDecryptingStream).
+//
+// Both functions require a regular file as input, and an output file
+// that supports pwrite(); the output file is truncated to the size of
+// the result.  Neither function takes ownership of the file descriptors.
+// If a function fails, the output file contains partial results and
+// must be discarded.
+//
+// The segment encrypter or decrypter must support EncryptSegmentAt()
+// (resp. DecryptSegmentAt()), e.g. AesGcmStreamSegmentEncrypter.
+
+// Encrypts the contents of 'plaintext_fd' to 'ciphertext_fd'.
+// 'encrypter' must be fresh (no segment has been encrypted yet), and is
+// consumed, as the nonces of its segments must not be used again.
+util::Status EncryptFileInParallel(
+    std::unique_ptr<subtle::StreamSegmentEncrypter> encrypter,
+    int plaintext_fd, int ciphertext_fd, int thread_count);
+
+// Decrypts the contents of 'ciphertext_fd' to 'plaintext_fd'.
+// 'decrypter' must not have been initialized yet; it is initialized
+// with the header read from 'ciphertext_fd'.
+util::Status DecryptFileInParallel(
+    std::unique_ptr<subtle::StreamSegmentDecrypter> decrypter,
+    int ciphertext_fd, int plaintext_fd, int thread_count);
+
+}  // namespace util
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_UTIL_PARALLEL_FILE_CRYPTER_H_
@@ -0,0 +1,250 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/util/parallel_file_crypter.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "tink/output_stream.h"
+#include "tink/subtle/aes_gcm_stream_segment_decrypter.h"
+#include "tink/subtle/aes_gcm_stream_segment_encrypter.h"
+#include "tink/subtle/random.h"
+#include "tink/subtle/streaming_aead_encrypting_stream.h"
+#include "tink/util/file_output_stream.h"
+#include "tink/util/secret_data.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "tink/util/test_util.h"
+
+namespace crypto {
+namespace tink {
+namespace util {
+namespace {
+
+using subtle::AesGcmStreamSegmentDecrypter;
+using subtle::AesGcmStreamSegmentEncrypter;
+using subtle::Random;
+
+const int kHeaderSize = 24;
+const int kSegmentSize = 256;
+const int kOverhead = 16;
+
+std::string FullName(const std::string& filename) {
+  return absl::StrCat(test::TmpDir(), "/", filename);
+}
+
+void WriteFile(const std::string& filename, const std::string& contents) {
+  int fd = open(FullName(filename).c_str(), O_WRONLY | O_CREAT | O_TRUNC,
+                S_IWUSR | S_IRUSR);
+  ASSERT_NE(-1, fd);
+  ASSERT_EQ(contents.size(), write(fd, contents.data(), contents.size()));
+  close(fd);
+}
+
+std::string ReadFile(const std::string& filename) {
+  int fd = open(FullName(filename).c_str(), O_RDONLY);
+  std::string contents;
+  char buf[4096];
+  int result;
+  while ((result = read(fd, buf, sizeof(buf))) > 0) {
+    contents.append(buf, result);
+  }
+  close(fd);
+  return contents;
+}
+
+int OpenForReading(const std::string& filename) {
+  return open(FullName(filename).c_str(), O_RDONLY);
+}
+
+int OpenForWriting(const std::string& filename) {
+  return open(FullName(filename).c_str(), O_WRONLY | O_CREAT | O_TRUNC,
+              S_IWUSR | S_IRUSR);
+}
+
+class ParallelFileCrypterTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    key_ = SecretDataFromStringView(Random::GetRandomBytes(16));
+    std::string header = Random::GetRandomBytes(kHeaderSize);
+    header_ = std::vector<uint8_t>(header.begin(), header.end());
+  }
+
+  std::unique_ptr<subtle::StreamSegmentEncrypter> GetEncrypter() {
+    return std::move(
+        AesGcmStreamSegmentEncrypter::New(key_, header_, kSegmentSize)
+        .ValueOrDie());
+  }
+
+  std::unique_ptr<subtle::StreamSegmentDecrypter> GetDecrypter() {
+    SecretData key = key_;
+    std::vector<uint8_t> header = header_;
+    return std::move(AesGcmStreamSegmentDecrypter::New(
+        kHeaderSize, kSegmentSize,
+        [key, header](const std::vector<uint8_t>& actual_header)
+            -> StatusOr<SecretData> {
+          if (actual_header != header) {
+            return Status(error::INVALID_ARGUMENT, "unknown header");
+          }
+          return key;
+        }).ValueOrDie());
+  }
+
+  // Returns the ciphertext of 'plaintext' as written by
+  // StreamingAeadEncryptingStream.
+  std::string SequentialCiphertext(const std::string& plaintext) {
+    int fd = OpenForWriting("sequential_ct");
+    auto enc_stream = std::move(subtle::StreamingAeadEncryptingStream::New(
+        GetEncrypter(), absl::make_unique<FileOutputStream>(fd))
+        .ValueOrDie());
+    int pos = 0;
+    while (pos < plaintext.size()) {
+      void* buffer;
+      int size = enc_stream->Next(&buffer).ValueOrDie();
+      int count = std::min<int>(size, plaintext.size() - pos);
+      memcpy(buffer, plaintext.data() + pos, count);
+      enc_stream->BackUp(size - count);
+      pos += count;
+    }
+    EXPECT_TRUE(enc_stream->Close().ok());
+    return ReadFile("sequential_ct");
+  }
+
+  Status Encrypt(const std::string& pt_file, const std::string& ct_file,
+                 int thread_count) {
+    int pt_fd = OpenForReading(pt_file);
+    int ct_fd = OpenForWriting(ct_file);
+    auto status =
+        EncryptFileInParallel(GetEncrypter(), pt_fd, ct_fd, thread_count);
+    close(pt_fd);
+    close(ct_fd);
+    return status;
+  }
+
+  Status Decrypt(const std::string& ct_file, const std::string& pt_file,
+                 int thread_count) {
+    int ct_fd = OpenForReading(ct_file);
+    int pt_fd = OpenForWriting(pt_file);
+    auto status =
+        DecryptFileInParallel(GetDecrypter(), ct_fd, pt_fd, thread_count);
+    close(ct_fd);
+    close(pt_fd);
+    return status;
+  }
+
+  SecretData key_;
+  std::vector<uint8_t> header_;
+};
+
+TEST_F(ParallelFileCrypterTest, MatchesSequentialEncryption) {
+  const int first_segment = kSegmentSize - kOverhead - kHeaderSize;
+  const int segment = kSegmentSize - kOverhead;
+  for (int size : {0, 1, first_segment - 1, first_segment, first_segment + 1,
+                   first_segment + segment, first_segment + 10 * segment + 7,
+                   3 * 1024 * 1024 + 5}) {
+    for (int thread_count : {1, 2, 7}) {
+      SCOPED_TRACE(absl::StrCat("size: ", size, " threads: ", thread_count));
+      std::string plaintext = Random::GetRandomBytes(size);
+      WriteFile("pt", plaintext);
+      auto status = Encrypt("pt", "ct", thread_count);
+      ASSERT_TRUE(status.ok()) << status;
+      EXPECT_EQ(SequentialCiphertext(plaintext), ReadFile("ct"));
+
+      status = Decrypt("ct", "decrypted", thread_count);
+      ASSERT_TRUE(status.ok()) << status;
+      EXPECT_EQ(plaintext, ReadFile("decrypted"));
+    }
+  }
+}
+
+TEST_F(ParallelFileCrypterTest, OutputIsTruncated) {
+  WriteFile("pt", Random::GetRandomBytes(1000));
+  WriteFile("ct", std::string(5000, 'x'));
+  ASSERT_TRUE(Encrypt("pt", "ct", 3).ok());
+  EXPECT_EQ(kHeaderSize + 1000 + 5 * kOverhead, ReadFile("ct").size());
+}
+
+TEST_F(ParallelFileCrypterTest, ModifiedCiphertext) {
+  std::string plaintext = Random::GetRandomBytes(3000);
+  WriteFile("pt", plaintext);
+  ASSERT_TRUE(Encrypt("pt", "ct", 4).ok());
+  std::string ciphertext = ReadFile("ct");
+
+  // A modified byte in each of the segments.
+  for (int pos = kHeaderSize; pos < ciphertext.size(); pos += 100) {
+    std::string modified = ciphertext;
+    modified[pos] ^= 1;
+    WriteFile("modified", modified);
+    EXPECT_FALSE(Decrypt("modified", "decrypted", 4).ok()) << pos;
+  }
+  // Truncated at and inside segment boundaries.
+  for (int size : {static_cast<int>(ciphertext.size()) - 1,
+                   kSegmentSize, kSegmentSize + kOverhead,
+                   kSegmentSize + kOverhead - 1, kHeaderSize + kOverhead}) {
+    WriteFile("modified", ciphertext.substr(0, size));
+    EXPECT_FALSE(Decrypt("modified", "decrypted", 4).ok()) << size;
+  }
+  WriteFile("modified", ciphertext.substr(0, kHeaderSize + kOverhead - 1));
+  auto status = Decrypt("modified", "decrypted", 4);
+  EXPECT_EQ(error::INVALID_ARGUMENT, status.error_code());
+  // Extended by an empty segment.
+  std::string extended = ciphertext;
+  extended.append(ciphertext.end() - kOverhead, ciphertext.end());
+  WriteFile("modified", extended);
+  EXPECT_FALSE(Decrypt("modified", "decrypted", 4).ok());
+}
+
+TEST_F(ParallelFileCrypterTest, InvalidArguments) {
+  WriteFile("pt", Random::GetRandomBytes(100));
+  int pt_fd = OpenForReading("pt");
+  int ct_fd = OpenForWriting("ct");
+  EXPECT_FALSE(EncryptFileInParallel(nullptr, pt_fd, ct_fd, 2).ok());
+  EXPECT_FALSE(EncryptFileInParallel(GetEncrypter(), pt_fd, ct_fd, 0).ok());
+
+  // The nonces of a used encrypter must not be reused.
+  auto encrypter = GetEncrypter();
+  std::vector<uint8_t> ciphertext;
+  ASSERT_TRUE(encrypter->EncryptSegment({1, 2, 3}, false, &ciphertext).ok());
+  auto status = EncryptFileInParallel(std::move(encrypter), pt_fd, ct_fd, 2);
+  EXPECT_EQ(error::FAILED_PRECONDITION, status.error_code());
+
+  // The input must be a regular file.
+  int pipe_fds[2];
+  ASSERT_EQ(0, pipe(pipe_fds));
+  status = EncryptFileInParallel(GetEncrypter(), pipe_fds[0], ct_fd, 2);
+  EXPECT_EQ(error::INVALID_ARGUMENT, status.error_code());
+  close(pipe_fds[0]);
+  close(pipe_fds[1]);
+
+  EXPECT_FALSE(DecryptFileInParallel(nullptr, pt_fd, ct_fd, 2).ok());
+  EXPECT_FALSE(DecryptFileInParallel(GetDecrypter(), pt_fd, ct_fd, 0).ok());
+  close(pt_fd);
+  close(ct_fd);
+}
+
+}  // namespace
+}  // namespace util
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,190 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/util/read_ahead_file_input_stream.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>  // NOLINT(build/c++11)
+
+#include "absl/memory/memory.h"
+#include "absl/synchronization/mutex.h"
+#include "tink/input_stream.h"
+#include "tink/util/errors.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+namespace util {
+
+namespace {
+
+// Attempts to close file descriptor fd, while ignoring EINTR.
+int close_ignoring_eintr(int fd) {
+  int result;
+  do {
+    result = close(fd);
+  } while (result < 0 && errno == EINTR);
+  return result;
+}
+
+// Attempts to read 'count' bytes of data data from file descriptor fd
+// to 'buf' while ignoring EINTR.
+int read_ignoring_eintr(int fd, void *buf, size_t count) {
+  int result;
+  do {
+    result = read(fd, buf, count);
+  } while (result < 0 && errno == EINTR);
+  return result;
+}
+
+int64_t NanosSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+}  // anonymous namespace
+
+ReadAheadFileInputStream::ReadAheadFileInputStream(
+    int file_descriptor, int buffer_size, int buffer_count)
+    : fd_(file_descriptor),
+      buffer_size_(buffer_size > 0 ? buffer_size : 128 * 1024),  // 128 KB
+      buffers_(buffer_count > 1 ? buffer_count : 4),
+      status_(Status::OK),
+      position_(0),
+      current_(nullptr),
+      buffer_offset_(0),
+      count_backedup_(0),
+      io_status_(Status::OK),
+      stopping_(false),
+      stats_{0, 0, 0, 0} {
+  for (auto& buffer : buffers_) {
+    buffer.data = absl::make_unique<uint8_t[]>(buffer_size_);
+    buffer.count = 0;
+    free_.push_back(&buffer);
+  }
+  io_thread_ = std::thread(&ReadAheadFileInputStream::ReadLoop, this);
+}
+
+ReadAheadFileInputStream::~ReadAheadFileInputStream() {
+  {
+    absl::MutexLock lock(&mutex_);
+    stopping_ = true;
+  }
+  io_thread_.join();
+  close_ignoring_eintr(fd_);
+}
+
+bool ReadAheadFileInputStream::CanRead() const {
+  return !free_.empty() || stopping_;
+}
+
+bool ReadAheadFileInputStream::HasFilledOrDone() const {
+  return !filled_.empty() || !io_status_.ok();
+}
+
+void ReadAheadFileInputStream::ReadLoop() {
+  while (true) {
+    Buffer* buffer;
+    {
+      absl::MutexLock lock(&mutex_);
+      mutex_.Await(absl::Condition(this, &ReadAheadFileInputStream::CanRead));
+      if (stopping_) return;
+      buffer = free_.front();
+      free_.pop_front();
+    }
+    auto start = std::chrono::steady_clock::now();
+    int read_result = read_ignoring_eintr(fd_, buffer->data.get(),
+                                          buffer_size_);
+    int64_t io_ns = NanosSince(start);
+    absl::MutexLock lock(&mutex_);
+    stats_.io_ns += io_ns;
+    if (read_result <= 0) {  // EOF or an I/O error.
+      if (read_result == 0) {
+        io_status_ = Status(util::error::OUT_OF_RANGE, "EOF");
+      } else {
+        io_status_ = ToStatusF(util::error::INTERNAL, "I/O error: %d", errno);
+      }
+      free_.push_back(buffer);
+      return;
+    }
+    buffer->count = read_result;
+    stats_.bytes_read += read_result;
+    filled_.push_back(buffer);
+  }
+}
+
+crypto::tink::util::StatusOr<int> ReadAheadFileInputStream::Next(
+    const void** data) {
+  if (!status_.ok()) return status_;
+  if (count_backedup_ > 0) {  // Return the backed-up bytes.
+    buffer_offset_ = current_->count - count_backedup_;
+    int backedup = count_backedup_;
+    count_backedup_ = 0;
+    *data = current_->data.get() + buffer_offset_;
+    position_ += backedup;
+    return backedup;
+  }
+  {
+    absl::MutexLock lock(&mutex_);
+    // current_ has been consumed, hence the I/O thread may refill it.
+    if (current_ != nullptr) {
+      free_.push_back(current_);
+      current_ = nullptr;
+    }
+    auto start = std::chrono::steady_clock::now();
+    mutex_.Await(
+        absl::Condition(this, &ReadAheadFileInputStream::HasFilledOrDone));
+    stats_.wait_ns += NanosSince(start);
+    if (filled_.empty()) {
+      status_ = io_status_;
+      return status_;
+    }
+    current_ = filled_.front();
+    filled_.pop_front();
+  }
+  buffer_offset_ = 0;
+  position_ += current_->count;
+  *data = current_->data.get();
+  return current_->count;
+}
+
+void ReadAheadFileInputStream::BackUp(int count) {
+  if (!status_.ok() || count < 1 || current_ == nullptr) return;
+  int actual_count = std::min(
+      count, current_->count - buffer_offset_ - count_backedup_);
+  count_backedup_ += actual_count;
+  position_ -= actual_count;
+}
+
+int64_t ReadAheadFileInputStream::Position() const {
+  return position_;
+}
+
+ReadAheadFileInputStream::Stats ReadAheadFileInputStream::GetStats() const {
+  absl::MutexLock lock(&mutex_);
+  Stats stats = stats_;
+  stats.overlapped_ns = std::max<int64_t>(0, stats.io_ns - stats.wait_ns);
+  return stats;
+}
+
+}  // namespace util
+}  // namespace tink
+}  // namespace crypto
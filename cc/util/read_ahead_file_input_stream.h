@@ -0,0 +1,111 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_UTIL_READ_AHEAD_FILE_INPUT_STREAM_H_
+#define TINK_UTIL_READ_AHEAD_FILE_INPUT_STREAM_H_
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "tink/input_stream.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+namespace util {
+
+// An InputStream that reads from a file descriptor on a dedicated I/O
+// thread.  The I/O thread keeps up to 'buffer_count' buffers filled ahead
+// of the caller, and Next() returns the filled buffers themselves, so that
+// reading the file overlaps with the processing of the data returned
+// earlier (e.g. its decryption in StreamingAeadDecryptingStream).
+class ReadAheadFileInputStream : public crypto::tink::InputStream {
+ public:
+  struct Stats {
+    // Number of bytes read by the I/O thread.
+    int64_t bytes_read;
+    // Time the I/O thread spent in read().
+    int64_t io_ns;
+    // Time Next() spent waiting for the I/O thread.
+    int64_t wait_ns;
+    // Time the I/O thread spent reading while the caller was not waiting,
+    // i.e. io_ns - wait_ns (but at least 0).  Close to io_ns if the
+    // caller was the bottleneck.
+    int64_t overlapped_ns;
+  };
+
+  // Constructs an InputStream that will read from the file specified
+  // via 'file_descriptor', using 'buffer_count' buffers of the specified
+  // size, if any (if no legal 'buffer_size' or 'buffer_count' is given,
+  // reasonable defaults will be used).  Starts the I/O thread.
+  // Takes the ownership of the file, and will close it upon destruction.
+  explicit ReadAheadFileInputStream(int file_descriptor, int buffer_size = -1,
+                                    int buffer_count = -1);
+
+  ~ReadAheadFileInputStream() override;
+
+  crypto::tink::util::StatusOr<int> Next(const void** data) override;
+
+  void BackUp(int count) override;
+
+  int64_t Position() const override;
+
+  Stats GetStats() const LOCKS_EXCLUDED(mutex_);
+
+ private:
+  struct Buffer {
+    std::unique_ptr<uint8_t[]> data;
+    int count;  // # of bytes read into data
+  };
+
+  bool CanRead() const EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  bool HasFilledOrDone() const EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void ReadLoop() LOCKS_EXCLUDED(mutex_);
+
+  const int fd_;
+  const int buffer_size_;
+  std::vector<Buffer> buffers_;
+
+  // State of the caller of Next().
+  util::Status status_;
+  int64_t position_;      // current position in the file (from the beginning)
+  Buffer* current_;       // buffer returned by the last Next(), if any
+  int buffer_offset_;     // offset at which the returned bytes start
+  int count_backedup_;    // # of bytes at the end of current_ backed up
+
+  // State shared with the I/O thread.
+  mutable absl::Mutex mutex_;
+  std::deque<Buffer*> free_ GUARDED_BY(mutex_);
+  std::deque<Buffer*> filled_ GUARDED_BY(mutex_);
+  // EOF or the error of the I/O thread, once it is done.
+  util::Status io_status_ GUARDED_BY(mutex_);
+  bool stopping_ GUARDED_BY(mutex_);
+  Stats stats_ GUARDED_BY(mutex_);
+
+  std::thread io_thread_;
+};
+
+}  // namespace util
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_UTIL_READ_AHEAD_FILE_INPUT_STREAM_H_
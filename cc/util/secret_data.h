@@ -0,0 +1,111 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_UTIL_SECRET_DATA_H_
+#define TINK_UTIL_SECRET_DATA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "tink/util/secure_arena.h"
+#include "openssl/mem.h"
+
+namespace crypto {
+namespace tink {
+namespace util {
+
+// A standard allocator that takes its memory from SecureArena::Global(),
+// i.e. memory that is locked into RAM (when possible) and zeroed when it
+// is freed.
+template <typename T>
+class SecretAllocator {
+ public:
+  using value_type = T;
+
+  SecretAllocator() {}
+  template <typename U>
+  SecretAllocator(const SecretAllocator<U>&) {}  // NOLINT(runtime/explicit)
+
+  T* allocate(size_t n) {
+    void* ptr = SecureArena::Global()->Allocate(n * sizeof(T));
+    // The arena falls back to OPENSSL_malloc, so this is out of memory;
+    // like operator new in a build without exceptions, give up.
+    if (ptr == nullptr) std::abort();
+    return static_cast<T*>(ptr);
+  }
+
+  void deallocate(T* ptr, size_t n) {
+    SecureArena::Global()->Free(ptr, n * sizeof(T));
+  }
+};
+
+template <typename T, typename U>
+bool operator==(const SecretAllocator<T>&, const SecretAllocator<U>&) {
+  return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const SecretAllocator<T>&, const SecretAllocator<U>&) {
+  return false;
+}
+
+// Bytes of key material, e.g. a symmetric key or a private key.
+// Unlike std::string, which keeps short values inside the object itself,
+// SecretData always keeps its bytes in a SecureArena, so they are not
+// swapped out (unless the arena had to fall back to the heap), and are
+// zeroed whenever the buffer is freed (including when the vector grows).
+//
+// SecretData currently covers the copies of key material that primitives
+// keep for their lifetime (e.g. the keys of AesSivBoringSsl, HmacBoringSsl
+// and EciesHkdfRecipientKemBoringSsl).  Key managers still receive key
+// bytes as std::string inside the key protos, and their
+// GetPrimitiveFromKey() paths hand those bytes on as std::string; moving
+// them to SecretData needs changes to the proto handling and is deferred.
+// Such transient copies should be wiped with SafeZeroString() where the
+// code owns them.
+using SecretData = std::vector<uint8_t, SecretAllocator<uint8_t>>;
+
+inline SecretData SecretDataFromStringView(absl::string_view data) {
+  return SecretData(data.begin(), data.end());
+}
+
+// Returns a view of 'data', which is valid as long as 'data' is not
+// modified or destroyed.
+inline absl::string_view SecretDataAsStringView(const SecretData& data) {
+  return absl::string_view(reinterpret_cast<const char*>(data.data()),
+                           data.size());
+}
+
+// Zeroes 'size' bytes at 'ptr', in a way the compiler cannot optimize
+// away.  For temporary copies of key material that cannot be SecretData,
+// e.g. key bytes in protos.
+inline void SafeZeroMemory(void* ptr, size_t size) {
+  OPENSSL_cleanse(ptr, size);
+}
+
+inline void SafeZeroString(std::string* str) {
+  if (!str->empty()) SafeZeroMemory(&(*str)[0], str->size());
+}
+
+}  // namespace util
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_UTIL_SECRET_DATA_H_
@@ -0,0 +1,61 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/util/secret_data.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+#include "tink/util/secure_arena.h"
+
+namespace crypto {
+namespace tink {
+namespace util {
+namespace {
+
+TEST(SecretDataTest, StringViewConversions) {
+  std::string key = "some key bytes, longer than a short string";
+  SecretData data = SecretDataFromStringView(key);
+  EXPECT_EQ(key.size(), data.size());
+  EXPECT_EQ(key, SecretDataAsStringView(data));
+  EXPECT_TRUE(SecretDataFromStringView("").empty());
+  EXPECT_EQ("", SecretDataAsStringView(SecretData()));
+}
+
+TEST(SecretDataTest, UsesTheGlobalArena) {
+  int64_t before = SecureArena::Global()->GetStats().bytes_in_use;
+  {
+    SecretData data(100, 'a');
+    EXPECT_LT(before, SecureArena::Global()->GetStats().bytes_in_use);
+    SecretData copy = data;
+    EXPECT_EQ(data, copy);
+  }
+  EXPECT_EQ(before, SecureArena::Global()->GetStats().bytes_in_use);
+}
+
+TEST(SecretDataTest, SafeZeroString) {
+  std::string key = "0123456789abcdef0123456789abcdef";
+  SafeZeroString(&key);
+  EXPECT_EQ(std::string(32, '\0'), key);
+  std::string empty;
+  SafeZeroString(&empty);
+  EXPECT_TRUE(empty.empty());
+}
+
+}  // namespace
+}  // namespace util
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,197 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/util/secure_arena.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "absl/synchronization/mutex.h"
+#include "openssl/mem.h"
+
+namespace crypto {
+namespace tink {
+namespace util {
+
+constexpr int SecureArena::kMinSizeClass;
+constexpr int SecureArena::kMaxSizeClass;
+constexpr size_t SecureArena::kDefaultSlabSize;
+constexpr int SecureArena::kNumSizeClasses;
+
+SecureArena::SecureArena(size_t slab_size)
+    : page_size_(sysconf(_SC_PAGESIZE)),
+      slab_size_(RoundUpToPages(
+          std::max(slab_size, static_cast<size_t>(1) << kMaxSizeClass))),
+      stats_{0, 0, 0, 0, 0, 0} {
+  for (auto& size_class : size_classes_) {
+    size_class.next = nullptr;
+    size_class.end = nullptr;
+  }
+}
+
+SecureArena::~SecureArena() {
+  absl::MutexLock lock(&mutex_);
+  for (const auto& slab : slabs_) Unmap(slab);
+  for (const auto& entry : large_mappings_) Unmap(entry.second);
+  for (void* ptr : heap_allocations_) OPENSSL_free(ptr);
+}
+
+// static
+SecureArena* SecureArena::Global() {
+  static SecureArena* arena = new SecureArena(kDefaultSlabSize);
+  return arena;
+}
+
+// static
+int SecureArena::SizeClass(size_t size) {
+  int size_class = kMinSizeClass;
+  while (size_class <= kMaxSizeClass &&
+         (static_cast<size_t>(1) << size_class) < size) {
+    size_class++;
+  }
+  return size_class;
+}
+
+size_t SecureArena::RoundUpToPages(size_t size) const {
+  return (size + page_size_ - 1) / page_size_ * page_size_;
+}
+
+bool SecureArena::Map(size_t size, Mapping* mapping) {
+  size_t total_size = size + 2 * page_size_;
+  void* base = mmap(nullptr, total_size, PROT_NONE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED) return false;
+  uint8_t* usable = static_cast<uint8_t*>(base) + page_size_;
+  // Only the usable bytes become accessible; the pages before and after
+  // them stay PROT_NONE, so that overruns fault instead of reaching other
+  // memory.
+  if (mprotect(usable, size, PROT_READ | PROT_WRITE) != 0) {
+    munmap(base, total_size);
+    return false;
+  }
+#ifdef MADV_DONTDUMP
+  madvise(usable, size, MADV_DONTDUMP);
+#endif
+  mapping->usable = usable;
+  mapping->size = size;
+  mapping->locked = mlock(usable, size) == 0;
+  stats_.mapping_count++;
+  stats_.mapped_bytes += size;
+  if (mapping->locked) {
+    stats_.locked_bytes += size;
+  } else {
+    stats_.lock_failures++;
+  }
+  return true;
+}
+
+void SecureArena::Unmap(const Mapping& mapping) {
+  if (mapping.locked) {
+    munlock(mapping.usable, mapping.size);
+    stats_.locked_bytes -= mapping.size;
+  }
+  munmap(mapping.usable - page_size_, mapping.size + 2 * page_size_);
+  stats_.mapping_count--;
+  stats_.mapped_bytes -= mapping.size;
+}
+
+void* SecureArena::AllocateFromHeap(size_t size) {
+  void* ptr = OPENSSL_malloc(size);
+  if (ptr == nullptr) return nullptr;
+  heap_allocations_.insert(ptr);
+  stats_.heap_allocations++;
+  return ptr;
+}
+
+bool SecureArena::FreeFromHeap(void* ptr) {
+  if (heap_allocations_.empty()) return false;
+  auto found = heap_allocations_.find(ptr);
+  if (found == heap_allocations_.end()) return false;
+  heap_allocations_.erase(found);
+  stats_.heap_allocations--;
+  OPENSSL_free(ptr);
+  return true;
+}
+
+void* SecureArena::Allocate(size_t size) {
+  int size_class = SizeClass(size);
+  absl::MutexLock lock(&mutex_);
+  if (size_class > kMaxSizeClass) {
+    Mapping mapping;
+    if (!Map(RoundUpToPages(size), &mapping)) return AllocateFromHeap(size);
+    large_mappings_[mapping.usable] = mapping;
+    stats_.bytes_in_use += mapping.size;
+    return mapping.usable;
+  }
+  size_t chunk_size = static_cast<size_t>(1) << size_class;
+  SizeClassState& state = size_classes_[size_class - kMinSizeClass];
+  uint8_t* chunk;
+  if (!state.free_chunks.empty()) {
+    chunk = state.free_chunks.back();
+    state.free_chunks.pop_back();
+  } else {
+    if (state.next == nullptr ||
+        static_cast<size_t>(state.end - state.next) < chunk_size) {
+      Mapping slab;
+      if (!Map(slab_size_, &slab)) return AllocateFromHeap(chunk_size);
+      slabs_.push_back(slab);
+      state.next = slab.usable;
+      state.end = slab.usable + slab.size;
+    }
+    chunk = state.next;
+    state.next += chunk_size;
+  }
+  stats_.bytes_in_use += chunk_size;
+  return chunk;
+}
+
+void SecureArena::Free(void* ptr, size_t size) {
+  if (ptr == nullptr) return;
+  int size_class = SizeClass(size);
+  if (size_class > kMaxSizeClass) {
+    OPENSSL_cleanse(ptr, size);
+    absl::MutexLock lock(&mutex_);
+    auto found = large_mappings_.find(ptr);
+    if (found == large_mappings_.end()) {
+      FreeFromHeap(ptr);
+      return;
+    }
+    stats_.bytes_in_use -= found->second.size;
+    Unmap(found->second);
+    large_mappings_.erase(found);
+    return;
+  }
+  // The whole chunk is zeroed, since the owner may have written past
+  // 'size' (e.g. a vector that shrank).
+  size_t chunk_size = static_cast<size_t>(1) << size_class;
+  OPENSSL_cleanse(ptr, chunk_size);
+  absl::MutexLock lock(&mutex_);
+  if (FreeFromHeap(ptr)) return;
+  size_classes_[size_class - kMinSizeClass].free_chunks.push_back(
+      static_cast<uint8_t*>(ptr));
+  stats_.bytes_in_use -= chunk_size;
+}
+
+SecureArena::Stats SecureArena::GetStats() const {
+  absl::MutexLock lock(&mutex_);
+  return stats_;
+}
+
+}  // namespace util
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,144 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_UTIL_SECURE_ARENA_H_
+#define TINK_UTIL_SECURE_ARENA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+
+namespace crypto {
+namespace tink {
+namespace util {
+
+// An allocator for key material, see SecretData.
+//
+// Memory is taken from the OS in slabs, which are locked into RAM with
+// mlock() (so that they are never swapped out), excluded from core dumps
+// where the OS supports it, and surrounded by inaccessible guard pages.
+// Each slab is cut into chunks of one size class (a power of two between
+// 2^kMinSizeClass and 2^kMaxSizeClass bytes); freed chunks are zeroed and
+// reused for the same class, so that key churn neither fragments the
+// general-purpose heap nor leaves key bytes behind.  Larger allocations
+// get their own locked, guard-paged mapping, which is zeroed and unmapped
+// when freed.
+//
+// Locking fails when the process exceeds RLIMIT_MEMLOCK; the memory is
+// then still used, and the failure is counted in Stats::lock_failures.
+// If no memory can be mapped at all (e.g. the process hit its mapping
+// limit), allocations fall back to OPENSSL_malloc; such memory is neither
+// locked nor guarded, but is still zeroed when it is freed.
+class SecureArena {
+ public:
+  static constexpr int kMinSizeClass = 4;   // 16 bytes
+  static constexpr int kMaxSizeClass = 12;  // 4096 bytes
+  static constexpr size_t kDefaultSlabSize = 64 * 1024;
+
+  struct Stats {
+    // Number of slabs and of dedicated mappings for large allocations.
+    int64_t mapping_count;
+    // Bytes mapped for slabs and large allocations, without guard pages.
+    int64_t mapped_bytes;
+    // Bytes of 'mapped_bytes' that are locked into RAM.
+    int64_t locked_bytes;
+    // Number of mappings that could not be locked.
+    int64_t lock_failures;
+    // Bytes of allocated chunks, rounded up to their size classes.
+    int64_t bytes_in_use;
+    // Number of live allocations that fell back to OPENSSL_malloc.
+    int64_t heap_allocations;
+  };
+
+  // Creates an arena whose slabs have (at least) 'slab_size' usable bytes.
+  explicit SecureArena(size_t slab_size);
+  SecureArena(const SecureArena&) = delete;
+  SecureArena& operator=(const SecureArena&) = delete;
+
+  // Unmaps all the memory.  Everything allocated must have been freed.
+  ~SecureArena();
+
+  // Returns the arena used by SecretData, which is never destroyed.
+  static SecureArena* Global();
+
+  // Returns 'size' bytes, or nullptr if neither mapping them nor the
+  // OPENSSL_malloc fallback succeeded.
+  void* Allocate(size_t size) LOCKS_EXCLUDED(mutex_);
+
+  // Zeroes and frees 'ptr', which was returned by Allocate(size).
+  void Free(void* ptr, size_t size) LOCKS_EXCLUDED(mutex_);
+
+  Stats GetStats() const LOCKS_EXCLUDED(mutex_);
+
+  // Returns the size class of an allocation of 'size' bytes, i.e. the
+  // smallest n >= kMinSizeClass with 2^n >= size; larger than
+  // kMaxSizeClass if the allocation gets its own mapping.
+  static int SizeClass(size_t size);
+
+ private:
+  static constexpr int kNumSizeClasses = kMaxSizeClass - kMinSizeClass + 1;
+
+  // A mapping of usable bytes between two guard pages.
+  struct Mapping {
+    uint8_t* usable;
+    // Number of usable bytes, a multiple of the page size.
+    size_t size;
+    bool locked;
+  };
+
+  // The chunks of one size class.
+  struct SizeClassState {
+    std::vector<uint8_t*> free_chunks;
+    // The part of the current slab that has not been cut into chunks yet.
+    uint8_t* next;
+    uint8_t* end;
+  };
+
+  // Maps 'size' usable bytes (a multiple of the page size) between two
+  // guard pages, and tries to lock them.  Returns false if the mapping
+  // failed.
+  bool Map(size_t size, Mapping* mapping) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void Unmap(const Mapping& mapping) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Returns 'size' bytes from OPENSSL_malloc, for when Map() failed.
+  void* AllocateFromHeap(size_t size) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  // Frees 'ptr' and returns true if it came from AllocateFromHeap().
+  bool FreeFromHeap(void* ptr) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  size_t RoundUpToPages(size_t size) const;
+
+  const size_t page_size_;
+  const size_t slab_size_;
+
+  mutable absl::Mutex mutex_;
+  SizeClassState size_classes_[kNumSizeClasses] GUARDED_BY(mutex_);
+  std::vector<Mapping> slabs_ GUARDED_BY(mutex_);
+  // The mappings of large allocations, by their usable addresses.
+  std::unordered_map<const void*, Mapping> large_mappings_ GUARDED_BY(mutex_);
+  std::unordered_set<void*> heap_allocations_ GUARDED_BY(mutex_);
+  Stats stats_ GUARDED_BY(mutex_);
+};
+
+}  // namespace util
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_UTIL_SECURE_ARENA_H_
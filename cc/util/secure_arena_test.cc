@@ -0,0 +1,147 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/util/secure_arena.h"
+
+#include <cstring>
+#include <set>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace crypto {
+namespace tink {
+namespace util {
+namespace {
+
+TEST(SecureArenaTest, SizeClass) {
+  EXPECT_EQ(SecureArena::kMinSizeClass, SecureArena::SizeClass(0));
+  EXPECT_EQ(SecureArena::kMinSizeClass, SecureArena::SizeClass(16));
+  EXPECT_EQ(5, SecureArena::SizeClass(17));
+  EXPECT_EQ(5, SecureArena::SizeClass(32));
+  EXPECT_EQ(SecureArena::kMaxSizeClass,
+            SecureArena::SizeClass(size_t{1} << SecureArena::kMaxSizeClass));
+  EXPECT_LT(SecureArena::kMaxSizeClass,
+            SecureArena::SizeClass((size_t{1} << SecureArena::kMaxSizeClass) +
+                                   1));
+}
+
+TEST(SecureArenaTest, AllocateAndFree) {
+  SecureArena arena(SecureArena::kDefaultSlabSize);
+  uint8_t* data = static_cast<uint8_t*>(arena.Allocate(20));
+  ASSERT_NE(nullptr, data);
+  memset(data, 0xff, 20);
+  SecureArena::Stats stats = arena.GetStats();
+  EXPECT_EQ(1, stats.mapping_count);
+  EXPECT_EQ(SecureArena::kDefaultSlabSize, stats.mapped_bytes);
+  EXPECT_EQ(32, stats.bytes_in_use);
+  EXPECT_EQ(stats.mapped_bytes,
+            stats.locked_bytes + stats.lock_failures * stats.mapped_bytes);
+
+  arena.Free(data, 20);
+  EXPECT_EQ(0, arena.GetStats().bytes_in_use);
+  // The slab is kept for later allocations.
+  EXPECT_EQ(1, arena.GetStats().mapping_count);
+}
+
+TEST(SecureArenaTest, FreedChunksAreZeroedAndReused) {
+  SecureArena arena(SecureArena::kDefaultSlabSize);
+  uint8_t* data = static_cast<uint8_t*>(arena.Allocate(40));
+  ASSERT_NE(nullptr, data);
+  // Bytes past the requested size but within the chunk get zeroed too.
+  memset(data, 0xff, 64);
+  arena.Free(data, 40);
+  uint8_t* reused = static_cast<uint8_t*>(arena.Allocate(50));
+  ASSERT_EQ(data, reused);
+  for (int i = 0; i < 64; i++) ASSERT_EQ(0, reused[i]) << "at " << i;
+  // Another size class gets another chunk.
+  uint8_t* other = static_cast<uint8_t*>(arena.Allocate(16));
+  EXPECT_NE(data, other);
+  arena.Free(reused, 50);
+  arena.Free(other, 16);
+}
+
+TEST(SecureArenaTest, ChunksDoNotOverlap) {
+  SecureArena arena(SecureArena::kDefaultSlabSize);
+  size_t chunk_size = 1024;
+  // More chunks than fit into one slab.
+  int count = 2 * SecureArena::kDefaultSlabSize / chunk_size;
+  std::vector<uint8_t*> chunks;
+  std::set<uint8_t*> distinct;
+  for (int i = 0; i < count; i++) {
+    uint8_t* chunk = static_cast<uint8_t*>(arena.Allocate(chunk_size));
+    ASSERT_NE(nullptr, chunk);
+    memset(chunk, i, chunk_size);
+    chunks.push_back(chunk);
+    distinct.insert(chunk);
+  }
+  EXPECT_EQ(count, distinct.size());
+  EXPECT_EQ(2, arena.GetStats().mapping_count);
+  for (int i = 0; i < count; i++) {
+    EXPECT_EQ(static_cast<uint8_t>(i), chunks[i][0]);
+    EXPECT_EQ(static_cast<uint8_t>(i), chunks[i][chunk_size - 1]);
+    arena.Free(chunks[i], chunk_size);
+  }
+}
+
+TEST(SecureArenaTest, LargeAllocationsGetTheirOwnMapping) {
+  SecureArena arena(SecureArena::kDefaultSlabSize);
+  size_t size = (size_t{1} << SecureArena::kMaxSizeClass) + 1;
+  uint8_t* data = static_cast<uint8_t*>(arena.Allocate(size));
+  ASSERT_NE(nullptr, data);
+  data[size - 1] = 1;
+  EXPECT_EQ(1, arena.GetStats().mapping_count);
+  EXPECT_LE(size, arena.GetStats().bytes_in_use);
+  arena.Free(data, size);
+  EXPECT_EQ(0, arena.GetStats().mapping_count);
+  EXPECT_EQ(0, arena.GetStats().mapped_bytes);
+  EXPECT_EQ(0, arena.GetStats().bytes_in_use);
+}
+
+TEST(SecureArenaTest, GuardPages) {
+  SecureArena arena(SecureArena::kDefaultSlabSize);
+  size_t size = 2 * (size_t{1} << SecureArena::kMaxSizeClass);
+  uint8_t* data = static_cast<uint8_t*>(arena.Allocate(size));
+  ASSERT_NE(nullptr, data);
+  EXPECT_DEATH(data[size] = 1, "");
+  EXPECT_DEATH(data[-1] = 1, "");
+  arena.Free(data, size);
+}
+
+TEST(SecureArenaTest, FallsBackToTheHeapWhenMappingFails) {
+  // Slabs this large cannot be mapped.
+  SecureArena arena(size_t{1} << 60);
+  uint8_t* data = static_cast<uint8_t*>(arena.Allocate(20));
+  ASSERT_NE(nullptr, data);
+  memset(data, 0xff, 20);
+  SecureArena::Stats stats = arena.GetStats();
+  EXPECT_EQ(0, stats.mapping_count);
+  EXPECT_EQ(0, stats.bytes_in_use);
+  EXPECT_EQ(1, stats.heap_allocations);
+  arena.Free(data, 20);
+  EXPECT_EQ(0, arena.GetStats().heap_allocations);
+  EXPECT_EQ(0, arena.GetStats().bytes_in_use);
+}
+
+TEST(SecureArenaTest, Global) {
+  EXPECT_NE(nullptr, SecureArena::Global());
+  EXPECT_EQ(SecureArena::Global(), SecureArena::Global());
+}
+
+}  // namespace
+}  // namespace util
+}  // namespace tink
+}  // namespace crypto
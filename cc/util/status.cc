@@ -43,20 +43,34 @@ const Status& GetUnknown() {
 
 // placeholder_implicit_type_conversion, please ignore
 
-Status::Status() : code_(::crypto::tink::util::error::OK), message_("") {
+Status::Status()
+    : code_(::crypto::tink::util::error::OK),
+      message_(""),
+      static_message_(nullptr) {
 }
 
 Status::Status(::crypto::tink::util::error::Code error,
                const std::string& error_message)
-    : code_(error), message_(error_message) {
+    : code_(error), message_(error_message), static_message_(nullptr) {
   if (code_ == ::crypto::tink::util::error::OK) {
     message_.clear();
   }
 }
 
+Status::Status(const Status& other)
+    : code_(other.code_),
+      message_(other.static_message_ == nullptr ? other.message_ : ""),
+      static_message_(other.static_message_) {
+}
+
 Status& Status::operator=(const Status& other) {
   code_ = other.code_;
-  message_ = other.message_;
+  if (other.static_message_ == nullptr) {
+    message_ = other.message_;
+  } else {
+    message_.clear();
+  }
+  static_message_ = other.static_message_;
   return *this;
 }
 
@@ -70,7 +84,7 @@ std::string Status::ToString() const {
   }
 
   std::ostringstream oss;
-  oss << code_ << ": " << message_;
+  oss << code_ << ": " << error_message();
   return oss.str();
 }
 
@@ -136,6 +136,8 @@ class Status {
   Status(::crypto::tink::util::error::Code error,
          const std::string& error_message);
 
+  // Copies of a StaticStatus refer to its message instead of copying it.
+  Status(const Status& other);
   Status& operator=(const Status& other);
 
   // Some pre-defined Status objects
@@ -154,7 +156,7 @@ class Status {
     return code_;
   }
   const std::string& error_message() const {
-    return message_;
+    return static_message_ != nullptr ? *static_message_ : message_;
   }
 
   bool operator==(const Status& x) const;
@@ -169,12 +171,39 @@ class Status {
   // placeholder_implicit_type_conversion, please ignore
 
  private:
+  friend class StaticStatus;
+
   ::crypto::tink::util::error::Code code_;
+  // The message, unless it is the one of a StaticStatus.
   std::string message_;
+  // The message of the StaticStatus this was copied from, or nullptr.
+  const std::string* static_message_;
+};
+
+// A Status for an error that is common on a hot path, e.g. a rejected
+// ciphertext, which may only be one of many trial decryptions.  It is
+// created once, and must never be destroyed; the Statuses copied from it
+// (including the ones in StatusOrs) refer to its message instead of
+// copying it, so that returning it never allocates memory:
+//
+//   static const StaticStatus* kAuthenticationFailed = new StaticStatus(
+//       util::error::INVALID_ARGUMENT, "Authentication failed");
+//   return *kAuthenticationFailed;
+class StaticStatus : public Status {
+ public:
+  StaticStatus(::crypto::tink::util::error::Code error,
+               const std::string& error_message)
+      : Status(error, error_message) {
+    static_message_ = &message_;
+  }
+
+  StaticStatus(const StaticStatus&) = delete;
+  StaticStatus& operator=(const StaticStatus&) = delete;
 };
 
 inline bool Status::operator==(const Status& other) const {
-  return (this->code_ == other.code_) && (this->message_ == other.message_);
+  return (this->code_ == other.code_) &&
+         (this->error_message() == other.error_message());
 }
 
 inline bool Status::operator!=(const Status& other) const {
@@ -0,0 +1,98 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/util/status.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+namespace util {
+namespace {
+
+TEST(StatusTest, Copy) {
+  Status status(error::INVALID_ARGUMENT, "some error");
+  Status copy(status);
+  EXPECT_EQ(error::INVALID_ARGUMENT, copy.error_code());
+  EXPECT_EQ("some error", copy.error_message());
+  EXPECT_NE(&status.error_message(), &copy.error_message());
+  EXPECT_EQ(status, copy);
+
+  Status assigned;
+  assigned = status;
+  EXPECT_EQ(status, assigned);
+  EXPECT_EQ("INVALID_ARGUMENT: some error", assigned.ToString());
+}
+
+TEST(StatusTest, Ok) {
+  Status status(error::OK, "ignored");
+  EXPECT_TRUE(status.ok());
+  EXPECT_EQ("", status.error_message());
+  EXPECT_EQ(Status::OK, status);
+  Status copy(status);
+  EXPECT_TRUE(copy.ok());
+  EXPECT_EQ("OK", copy.ToString());
+}
+
+TEST(StaticStatusTest, CopiesShareTheMessage) {
+  static const StaticStatus* static_status =
+      new StaticStatus(error::INTERNAL, "static error");
+  Status copy(*static_status);
+  EXPECT_EQ(error::INTERNAL, copy.error_code());
+  EXPECT_EQ("static error", copy.error_message());
+  EXPECT_EQ(&static_status->error_message(), &copy.error_message());
+
+  Status copy_of_copy = copy;
+  EXPECT_EQ(&static_status->error_message(), &copy_of_copy.error_message());
+
+  StatusOr<std::string> result = *static_status;
+  EXPECT_FALSE(result.ok());
+  EXPECT_EQ(&static_status->error_message(),
+            &result.status().error_message());
+}
+
+TEST(StaticStatusTest, Assignment) {
+  static const StaticStatus* static_status =
+      new StaticStatus(error::INTERNAL, "static error");
+  Status status(error::UNKNOWN, "a dynamic message");
+  status = *static_status;
+  EXPECT_EQ(error::INTERNAL, status.error_code());
+  EXPECT_EQ(&static_status->error_message(), &status.error_message());
+  EXPECT_EQ("INTERNAL: static error", status.ToString());
+
+  // Assigning a dynamic status again drops the reference.
+  Status dynamic(error::UNKNOWN, "a dynamic message");
+  status = dynamic;
+  EXPECT_EQ("a dynamic message", status.error_message());
+  EXPECT_NE(&static_status->error_message(), &status.error_message());
+}
+
+TEST(StaticStatusTest, Equality) {
+  static const StaticStatus* static_status =
+      new StaticStatus(error::INTERNAL, "static error");
+  EXPECT_EQ(Status(error::INTERNAL, "static error"), *static_status);
+  EXPECT_EQ(*static_status, Status(error::INTERNAL, "static error"));
+  EXPECT_NE(Status(error::INTERNAL, "other error"), *static_status);
+  EXPECT_NE(Status(error::UNKNOWN, "static error"), *static_status);
+}
+
+}  // namespace
+}  // namespace util
+}  // namespace tink
+}  // namespace crypto
@@ -17,6 +17,8 @@
 #ifndef TINK_UTIL_TEST_UTIL_H_
 #define TINK_UTIL_TEST_UTIL_H_
 
+#include <algorithm>
+#include <cstring>
 #include <limits>
 #include <string>
 
@@ -34,6 +36,8 @@
 #include "tink/public_key_sign.h"
 #include "tink/public_key_verify.h"
 #include "tink/streaming_aead.h"
+#include "tink/streaming_hybrid_decrypt.h"
+#include "tink/streaming_hybrid_encrypt.h"
 #include "tink/subtle/common_enums.h"
 #include "tink/util/protobuf_helper.h"
 #include "tink/util/status.h"
@@ -304,6 +308,78 @@ class DummyHybridDecrypt : public HybridDecrypt {
   DummyAead dummy_aead_;
 };
 
+// A dummy implementation of StreamingHybridEncrypt-interface.
+// An instance of DummyStreamingHybridEncrypt can be identified by a name
+// specified as a parameter of the constructor.
+class DummyStreamingHybridEncrypt : public StreamingHybridEncrypt {
+ public:
+  explicit DummyStreamingHybridEncrypt(absl::string_view hybrid_name)
+      : hybrid_name_(absl::StrCat("DummyStreamingHybrid:", hybrid_name)) {}
+
+  // Writes to 'ciphertext_destination' the name of this instance
+  // followed by 'context_info', and returns 'ciphertext_destination'
+  // as the encrypting stream.
+  crypto::tink::util::StatusOr<std::unique_ptr<crypto::tink::OutputStream>>
+  NewEncryptingStream(
+      std::unique_ptr<crypto::tink::OutputStream> ciphertext_destination,
+      absl::string_view context_info) const override {
+    std::string header = absl::StrCat(hybrid_name_, context_info);
+    int pos = 0;
+    while (pos < header.size()) {
+      void* buffer;
+      auto next_result = ciphertext_destination->Next(&buffer);
+      if (!next_result.ok()) return next_result.status();
+      int count = std::min(next_result.ValueOrDie(),
+                           static_cast<int>(header.size()) - pos);
+      memcpy(buffer, header.data() + pos, count);
+      ciphertext_destination->BackUp(next_result.ValueOrDie() - count);
+      pos += count;
+    }
+    return std::move(ciphertext_destination);
+  }
+
+ private:
+  std::string hybrid_name_;
+};
+
+// A dummy implementation of StreamingHybridDecrypt-interface.
+// An instance of DummyStreamingHybridDecrypt can be identified by a name
+// specified as a parameter of the constructor.
+class DummyStreamingHybridDecrypt : public StreamingHybridDecrypt {
+ public:
+  explicit DummyStreamingHybridDecrypt(absl::string_view hybrid_name)
+      : hybrid_name_(absl::StrCat("DummyStreamingHybrid:", hybrid_name)) {}
+
+  // Reads a prefix from 'ciphertext_source' and verifies that it is
+  // the name of this instance, followed by 'context_info'.
+  // Returns 'ciphertext_source' as the decrypting stream.
+  crypto::tink::util::StatusOr<std::unique_ptr<crypto::tink::InputStream>>
+  NewDecryptingStream(
+      std::unique_ptr<crypto::tink::InputStream> ciphertext_source,
+      absl::string_view context_info) const override {
+    std::string header = absl::StrCat(hybrid_name_, context_info);
+    std::string read_header;
+    while (read_header.size() < header.size()) {
+      const void* buffer;
+      auto next_result = ciphertext_source->Next(&buffer);
+      if (!next_result.ok()) return next_result.status();
+      int count = std::min(next_result.ValueOrDie(),
+                           static_cast<int>(header.size() -
+                                            read_header.size()));
+      read_header.append(static_cast<const char*>(buffer), count);
+      ciphertext_source->BackUp(next_result.ValueOrDie() - count);
+    }
+    if (read_header != header) {
+      return crypto::tink::util::Status(
+          crypto::tink::util::error::INVALID_ARGUMENT, "Corrupted header");
+    }
+    return std::move(ciphertext_source);
+  }
+
+ private:
+  std::string hybrid_name_;
+};
+
 // A dummy implementation of PublicKeySign-interface.
 // An instance of DummyPublicKeySign can be identified by a name specified
 // as a parameter of the constructor.
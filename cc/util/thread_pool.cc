@@ -0,0 +1,91 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/util/thread_pool.h"
+
+#include <utility>
+
+#include "absl/synchronization/mutex.h"
+
+namespace crypto {
+namespace tink {
+namespace util {
+
+ThreadPool::ThreadPool(int num_threads) : ThreadPool(num_threads, 0) {}
+
+ThreadPool::ThreadPool(int num_threads, size_t max_queue_size)
+    : max_queue_size_(max_queue_size), stopping_(false) {
+  if (num_threads < 1) num_threads = 1;
+  workers_.reserve(num_threads);
+  for (int i = 0; i < num_threads; i++) {
+    workers_.emplace_back(&ThreadPool::WorkLoop, this);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    absl::MutexLock lock(&mutex_);
+    stopping_ = true;
+  }
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::Schedule(std::function<void()> closure) {
+  absl::MutexLock lock(&mutex_);
+  mutex_.Await(absl::Condition(this, &ThreadPool::HasSpace));
+  queue_.push_back(std::move(closure));
+}
+
+bool ThreadPool::TrySchedule(std::function<void()> closure) {
+  absl::MutexLock lock(&mutex_);
+  if (!HasSpace()) return false;
+  queue_.push_back(std::move(closure));
+  return true;
+}
+
+size_t ThreadPool::queue_size() const {
+  absl::MutexLock lock(&mutex_);
+  return queue_.size();
+}
+
+bool ThreadPool::HasWorkOrStopping() const {
+  return !queue_.empty() || stopping_;
+}
+
+bool ThreadPool::HasSpace() const {
+  return max_queue_size_ == 0 || queue_.size() < max_queue_size_;
+}
+
+void ThreadPool::WorkLoop() {
+  while (true) {
+    std::function<void()> closure;
+    {
+      absl::MutexLock lock(&mutex_);
+      mutex_.Await(absl::Condition(this, &ThreadPool::HasWorkOrStopping));
+      // Pending closures are drained before the workers exit.
+      if (queue_.empty()) return;
+      closure = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    closure();
+  }
+}
+
+}  // namespace util
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,88 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_UTIL_THREAD_POOL_H_
+#define TINK_UTIL_THREAD_POOL_H_
+
+#include <deque>
+#include <functional>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+
+namespace crypto {
+namespace tink {
+namespace util {
+
+// A fixed-size pool of worker threads executing scheduled closures
+// in FIFO order.  Intended for the asynchronous front-ends of Tink
+// primitives, which must not block the calling thread.
+//
+// The queue of pending closures is unbounded by default.  A pool with
+// a bounded queue applies back-pressure: Schedule() blocks while the queue
+// is full, and TrySchedule() fails instead.  Closures running on a pool
+// with a bounded queue must not Schedule() on the same pool, as this can
+// deadlock.
+//
+// The destructor waits until all closures scheduled so far have run,
+// and then joins the worker threads.
+class ThreadPool {
+ public:
+  // Starts 'num_threads' worker threads (at least one thread is started).
+  explicit ThreadPool(int num_threads);
+
+  // Same as above, but at most 'max_queue_size' closures wait for a worker
+  // thread at any time; 0 means unbounded.
+  ThreadPool(int num_threads, size_t max_queue_size);
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  ~ThreadPool();
+
+  // Schedules 'closure' for execution on one of the worker threads.
+  // Blocks while the queue is full.
+  void Schedule(std::function<void()> closure) LOCKS_EXCLUDED(mutex_);
+
+  // Same as Schedule(), but returns false without scheduling 'closure'
+  // if the queue is full.
+  bool TrySchedule(std::function<void()> closure) LOCKS_EXCLUDED(mutex_);
+
+  // Returns the number of closures waiting for a worker thread.
+  size_t queue_size() const LOCKS_EXCLUDED(mutex_);
+
+  // Returns the number of worker threads.
+  int num_threads() const { return workers_.size(); }
+
+ private:
+  bool HasWorkOrStopping() const EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  bool HasSpace() const EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void WorkLoop() LOCKS_EXCLUDED(mutex_);
+
+  const size_t max_queue_size_;
+  mutable absl::Mutex mutex_;
+  std::deque<std::function<void()>> queue_ GUARDED_BY(mutex_);
+  bool stopping_ GUARDED_BY(mutex_);
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace util
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_UTIL_THREAD_POOL_H_
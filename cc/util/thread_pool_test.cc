@@ -0,0 +1,95 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/util/thread_pool.h"
+
+#include <atomic>
+#include <thread>  // NOLINT(build/c++11)
+
+#include "gtest/gtest.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/notification.h"
+
+namespace crypto {
+namespace tink {
+namespace util {
+namespace {
+
+TEST(ThreadPoolTest, RunsAllClosures) {
+  const int kClosureCount = 1000;
+  std::atomic<int> counter(0);
+  absl::BlockingCounter done(kClosureCount);
+  ThreadPool pool(4);
+  EXPECT_EQ(4, pool.num_threads());
+  for (int i = 0; i < kClosureCount; i++) {
+    pool.Schedule([&counter, &done]() {
+      counter++;
+      done.DecrementCount();
+    });
+  }
+  done.Wait();
+  EXPECT_EQ(kClosureCount, counter.load());
+}
+
+TEST(ThreadPoolTest, DestructorDrainsQueue) {
+  const int kClosureCount = 100;
+  std::atomic<int> counter(0);
+  {
+    ThreadPool pool(2);
+    for (int i = 0; i < kClosureCount; i++) {
+      pool.Schedule([&counter]() { counter++; });
+    }
+  }
+  EXPECT_EQ(kClosureCount, counter.load());
+}
+
+TEST(ThreadPoolTest, BoundedQueue) {
+  absl::Notification release;
+  absl::Notification started;
+  ThreadPool pool(1, 2);
+  // Blocks the only worker thread.
+  pool.Schedule([&release, &started]() {
+    started.Notify();
+    release.WaitForNotification();
+  });
+  started.WaitForNotification();
+  EXPECT_TRUE(pool.TrySchedule([]() {}));
+  EXPECT_TRUE(pool.TrySchedule([]() {}));
+  EXPECT_EQ(2, pool.queue_size());
+  EXPECT_FALSE(pool.TrySchedule([]() {}));
+  EXPECT_EQ(2, pool.queue_size());
+
+  // Schedule() waits for space in the queue.
+  std::atomic<bool> scheduled(false);
+  std::thread producer([&pool, &scheduled]() {
+    pool.Schedule([]() {});
+    scheduled = true;
+  });
+  EXPECT_FALSE(scheduled.load());
+  release.Notify();
+  producer.join();
+  EXPECT_TRUE(scheduled.load());
+}
+
+TEST(ThreadPoolTest, AtLeastOneThread) {
+  ThreadPool pool(0);
+  EXPECT_EQ(1, pool.num_threads());
+}
+
+}  // namespace
+}  // namespace util
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,254 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/util/write_behind_file_output_stream.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>  // NOLINT(build/c++11)
+
+#include "absl/memory/memory.h"
+#include "absl/synchronization/mutex.h"
+#include "tink/output_stream.h"
+#include "tink/util/errors.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+namespace util {
+
+namespace {
+
+// Attempts to close file descriptor fd, while ignoring EINTR.
+int close_ignoring_eintr(int fd) {
+  int result;
+  do {
+    result = close(fd);
+  } while (result < 0 && errno == EINTR);
+  return result;
+}
+
+// Attempts to write 'count' bytes of data data from 'buf'
+// to file descriptor fd, while ignoring EINTR.
+int write_ignoring_eintr(int fd, const void *buf, size_t count) {
+  int result;
+  do {
+    result = write(fd, buf, count);
+  } while (result < 0 && errno == EINTR);
+  return result;
+}
+
+// Writes all 'count' bytes from 'buf' to fd.
+Status WriteFully(int fd, const uint8_t* buf, int count) {
+  while (count > 0) {
+    int write_result = write_ignoring_eintr(fd, buf, count);
+    if (write_result < 0) {
+      return ToStatusF(util::error::INTERNAL, "I/O error upon write: %d",
+                       errno);
+    } else if (write_result == 0) {  // No progress, hence abort.
+      return ToStatusF(util::error::INTERNAL,
+                       "I/O error: failed to write %d bytes.", count);
+    }
+    buf += write_result;
+    count -= write_result;
+  }
+  return Status::OK;
+}
+
+int64_t NanosSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+}  // anonymous namespace
+
+WriteBehindFileOutputStream::WriteBehindFileOutputStream(
+    int file_descriptor, int buffer_size, int buffer_count)
+    : fd_(file_descriptor),
+      buffer_size_(buffer_size > 0 ? buffer_size : 128 * 1024),  // 128 KB
+      buffers_(buffer_count > 1 ? buffer_count : 4),
+      status_(Status::OK),
+      position_(0),
+      current_(nullptr),
+      buffer_offset_(0),
+      count_backedup_(0),
+      io_status_(Status::OK),
+      stopping_(false),
+      stats_{0, 0, 0, 0} {
+  for (auto& buffer : buffers_) {
+    buffer.data = absl::make_unique<uint8_t[]>(buffer_size_);
+    buffer.count = 0;
+    free_.push_back(&buffer);
+  }
+  io_thread_ = std::thread(&WriteBehindFileOutputStream::WriteLoop, this);
+}
+
+WriteBehindFileOutputStream::~WriteBehindFileOutputStream() {
+  if (status_.ok()) Close().IgnoreError();
+  // After an error, the I/O thread may still run.
+  StopIoThread();
+  if (fd_ >= 0) close_ignoring_eintr(fd_);
+}
+
+bool WriteBehindFileOutputStream::HasFreeOrFailed() const {
+  return !free_.empty() || !io_status_.ok();
+}
+
+bool WriteBehindFileOutputStream::HasFilledOrStopping() const {
+  return !filled_.empty() || stopping_;
+}
+
+void WriteBehindFileOutputStream::WriteLoop() {
+  while (true) {
+    Buffer* buffer;
+    bool failed;
+    {
+      absl::MutexLock lock(&mutex_);
+      mutex_.Await(absl::Condition(
+          this, &WriteBehindFileOutputStream::HasFilledOrStopping));
+      // Filled buffers are written before the thread exits.
+      if (filled_.empty()) return;
+      buffer = filled_.front();
+      filled_.pop_front();
+      failed = !io_status_.ok();
+    }
+    // After an error, nothing more is written.
+    Status status = Status::OK;
+    int64_t io_ns = 0;
+    if (!failed) {
+      auto start = std::chrono::steady_clock::now();
+      status = WriteFully(fd_, buffer->data.get(), buffer->count);
+      io_ns = NanosSince(start);
+    }
+    absl::MutexLock lock(&mutex_);
+    stats_.io_ns += io_ns;
+    if (status.ok() && !failed) stats_.bytes_written += buffer->count;
+    if (!status.ok()) io_status_ = status;
+    free_.push_back(buffer);
+  }
+}
+
+void WriteBehindFileOutputStream::SubmitCurrent() {
+  if (current_ == nullptr) return;
+  current_->count = buffer_size_ - count_backedup_;
+  absl::MutexLock lock(&mutex_);
+  if (current_->count > 0) {
+    filled_.push_back(current_);
+  } else {
+    free_.push_back(current_);
+  }
+  current_ = nullptr;
+}
+
+void WriteBehindFileOutputStream::StopIoThread() {
+  if (!io_thread_.joinable()) return;
+  {
+    absl::MutexLock lock(&mutex_);
+    stopping_ = true;
+  }
+  auto start = std::chrono::steady_clock::now();
+  io_thread_.join();
+  absl::MutexLock lock(&mutex_);
+  stats_.wait_ns += NanosSince(start);
+}
+
+crypto::tink::util::StatusOr<int> WriteBehindFileOutputStream::Next(
+    void** data) {
+  if (!status_.ok()) return status_;
+
+  // If some space was backed up, return it first.
+  if (count_backedup_ > 0) {
+    buffer_offset_ = buffer_size_ - count_backedup_;
+    int backedup = count_backedup_;
+    count_backedup_ = 0;
+    position_ += backedup;
+    *data = current_->data.get() + buffer_offset_;
+    return backedup;
+  }
+
+  // current_, if any, is full: hand it over, and get an empty buffer.
+  SubmitCurrent();
+  {
+    absl::MutexLock lock(&mutex_);
+    auto start = std::chrono::steady_clock::now();
+    mutex_.Await(absl::Condition(
+        this, &WriteBehindFileOutputStream::HasFreeOrFailed));
+    stats_.wait_ns += NanosSince(start);
+    if (!io_status_.ok()) {
+      status_ = io_status_;
+      return status_;
+    }
+    current_ = free_.front();
+    free_.pop_front();
+  }
+  buffer_offset_ = 0;
+  position_ += buffer_size_;
+  *data = current_->data.get();
+  return buffer_size_;
+}
+
+void WriteBehindFileOutputStream::BackUp(int count) {
+  if (!status_.ok() || count < 1 || current_ == nullptr) return;
+  int actual_count = std::min(
+      count, buffer_size_ - buffer_offset_ - count_backedup_);
+  count_backedup_ += actual_count;
+  position_ -= actual_count;
+}
+
+Status WriteBehindFileOutputStream::Close() {
+  if (!status_.ok()) return status_;
+  SubmitCurrent();
+  StopIoThread();
+  Status io_status;
+  {
+    absl::MutexLock lock(&mutex_);
+    io_status = io_status_;
+  }
+  int close_result = close_ignoring_eintr(fd_);
+  int close_errno = errno;
+  fd_ = -1;
+  if (!io_status.ok()) {
+    status_ = io_status;
+    return status_;
+  }
+  if (close_result == -1) {
+    status_ = ToStatusF(
+        util::error::INTERNAL, "I/O error upon close: %d", close_errno);
+    return status_;
+  }
+  status_ = Status(util::error::FAILED_PRECONDITION, "Stream closed");
+  return Status::OK;
+}
+
+int64_t WriteBehindFileOutputStream::Position() const {
+  return position_;
+}
+
+WriteBehindFileOutputStream::Stats WriteBehindFileOutputStream::GetStats()
+    const {
+  absl::MutexLock lock(&mutex_);
+  Stats stats = stats_;
+  stats.overlapped_ns = std::max<int64_t>(0, stats.io_ns - stats.wait_ns);
+  return stats;
+}
+
+}  // namespace util
+}  // namespace tink
+}  // namespace crypto
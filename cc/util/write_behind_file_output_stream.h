@@ -0,0 +1,122 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_UTIL_WRITE_BEHIND_FILE_OUTPUT_STREAM_H_
+#define TINK_UTIL_WRITE_BEHIND_FILE_OUTPUT_STREAM_H_
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "tink/output_stream.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+namespace util {
+
+// An OutputStream that writes to a file descriptor on a dedicated I/O
+// thread.  Next() hands the buffer filled by the caller over to the I/O
+// thread, and returns another one of 'buffer_count' buffers, so that
+// writing the file overlaps with the production of the next data (e.g. its
+// encryption in StreamingAeadEncryptingStream).  Next() blocks only when
+// all buffers wait to be written.
+//
+// Errors of the I/O thread are returned by the next call to Next() or
+// Close(), after the error occurred.
+class WriteBehindFileOutputStream : public crypto::tink::OutputStream {
+ public:
+  struct Stats {
+    // Number of bytes written by the I/O thread.
+    int64_t bytes_written;
+    // Time the I/O thread spent in write().
+    int64_t io_ns;
+    // Time Next() and Close() spent waiting for the I/O thread.
+    int64_t wait_ns;
+    // Time the I/O thread spent writing while the caller was not waiting,
+    // i.e. io_ns - wait_ns (but at least 0).  Close to io_ns if the
+    // caller was the bottleneck.
+    int64_t overlapped_ns;
+  };
+
+  // Constructs an OutputStream that will write to the file specified
+  // via 'file_descriptor', using 'buffer_count' buffers of the specified
+  // size, if any (if no legal 'buffer_size' or 'buffer_count' is given,
+  // reasonable defaults will be used).  Starts the I/O thread.
+  // Takes the ownership of the file, and will close it upon destruction.
+  explicit WriteBehindFileOutputStream(int file_descriptor,
+                                       int buffer_size = -1,
+                                       int buffer_count = -1);
+
+  ~WriteBehindFileOutputStream() override;
+
+  crypto::tink::util::StatusOr<int> Next(void** data) override;
+
+  void BackUp(int count) override;
+
+  crypto::tink::util::Status Close() override;
+
+  int64_t Position() const override;
+
+  Stats GetStats() const LOCKS_EXCLUDED(mutex_);
+
+ private:
+  struct Buffer {
+    std::unique_ptr<uint8_t[]> data;
+    int count;  // # of bytes to be written from data
+  };
+
+  // Hands current_ over to the I/O thread, if it holds any bytes.
+  void SubmitCurrent() LOCKS_EXCLUDED(mutex_);
+  // Waits until the I/O thread has written everything submitted so far,
+  // or has failed, and stops it.
+  void StopIoThread() LOCKS_EXCLUDED(mutex_);
+  bool HasFreeOrFailed() const EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  bool HasFilledOrStopping() const EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void WriteLoop() LOCKS_EXCLUDED(mutex_);
+
+  int fd_;
+  const int buffer_size_;
+  std::vector<Buffer> buffers_;
+
+  // State of the caller of Next().
+  util::Status status_;
+  int64_t position_;      // current position in the file (from the beginning)
+  Buffer* current_;       // buffer being filled by the caller, if any
+  int buffer_offset_;     // offset where the returned *data starts in current_
+  int count_backedup_;    // # bytes at the end of current_ backed up
+
+  // State shared with the I/O thread.
+  mutable absl::Mutex mutex_;
+  std::deque<Buffer*> free_ GUARDED_BY(mutex_);
+  std::deque<Buffer*> filled_ GUARDED_BY(mutex_);
+  util::Status io_status_ GUARDED_BY(mutex_);  // first error of the thread
+  bool stopping_ GUARDED_BY(mutex_);
+  Stats stats_ GUARDED_BY(mutex_);
+
+  std::thread io_thread_;
+};
+
+}  // namespace util
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_UTIL_WRITE_BEHIND_FILE_OUTPUT_STREAM_H_
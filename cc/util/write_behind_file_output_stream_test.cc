@@ -0,0 +1,238 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/util/write_behind_file_output_stream.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tink/subtle/random.h"
+#include "tink/util/status.h"
+#include "tink/util/test_util.h"
+
+namespace crypto {
+namespace tink {
+namespace {
+
+std::string FullName(absl::string_view filename) {
+  return absl::StrCat(crypto::tink::test::TmpDir(), "/", filename);
+}
+
+// Creates a new test file with the specified 'filename', ready for writing.
+int GetTestFileDescriptor(absl::string_view filename) {
+  std::string full_filename = FullName(filename);
+  mode_t mode = S_IWUSR | S_IRUSR | S_IRGRP | S_IROTH;
+  int fd = open(full_filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, mode);
+  if (fd == -1) {
+    std::clog << "Cannot create file " << full_filename
+              << " error: " << errno << std::endl;
+    exit(1);
+  }
+  return fd;
+}
+
+// Writes 'contents' the specified 'output_stream', and closes the stream.
+// Returns the status of output_stream->Close()-operation, or a non-OK status
+// of a prior output_stream->Next()-operation, if any.
+util::Status WriteToStream(util::WriteBehindFileOutputStream* output_stream,
+                           absl::string_view contents) {
+  void* buffer;
+  int pos = 0;
+  int remaining = contents.length();
+  int available_space = 0;
+  int available_bytes = 0;
+  while (remaining > 0) {
+    auto next_result = output_stream->Next(&buffer);
+    if (!next_result.ok()) return next_result.status();
+    available_space = next_result.ValueOrDie();
+    available_bytes = std::min(available_space, remaining);
+    memcpy(buffer, contents.data() + pos, available_bytes);
+    remaining -= available_bytes;
+    pos += available_bytes;
+  }
+  if (available_space > available_bytes) {
+    output_stream->BackUp(available_space - available_bytes);
+  }
+  return output_stream->Close();
+}
+
+// Reads the test file specified by 'filename', and returns its contents.
+std::string ReadFile(absl::string_view filename) {
+  std::string full_filename = FullName(filename);
+  int fd = open(full_filename.c_str(), O_RDONLY);
+  if (fd == -1) {
+    std::clog << "Cannot open file " << full_filename
+              << " error: " << errno << std::endl;
+    exit(1);
+  }
+  std::string contents;
+  int buffer_size = 128 * 1024;
+  auto buffer = absl::make_unique<uint8_t[]>(buffer_size);
+  int read_result = read(fd, buffer.get(), buffer_size);
+  while (read_result > 0) {
+    contents.append(reinterpret_cast<const char*>(buffer.get()), read_result);
+    read_result = read(fd, buffer.get(), buffer_size);
+  }
+  close(fd);
+  return contents;
+}
+
+TEST(WriteBehindFileOutputStreamTest, WritingStreams) {
+  std::vector<int> stream_sizes = {0, 10, 100, 1000, 10000, 100000, 1000000};
+  for (auto stream_size : stream_sizes) {
+    std::string stream_contents = subtle::Random::GetRandomBytes(stream_size);
+    std::string filename =
+        absl::StrCat(stream_size, "_write_behind_writing_test.bin");
+    int output_fd = GetTestFileDescriptor(filename);
+    auto output_stream =
+        absl::make_unique<util::WriteBehindFileOutputStream>(output_fd);
+    auto status = WriteToStream(output_stream.get(), stream_contents);
+    EXPECT_TRUE(status.ok()) << status;
+    EXPECT_EQ(stream_size, output_stream->Position());
+    EXPECT_EQ(stream_contents, ReadFile(filename));
+
+    auto stats = output_stream->GetStats();
+    EXPECT_EQ(stream_size, stats.bytes_written);
+    EXPECT_LE(stats.overlapped_ns, stats.io_ns);
+  }
+}
+
+TEST(WriteBehindFileOutputStreamTest, CustomBufferSizesAndCounts) {
+  std::vector<int> buffer_sizes = {1, 10, 100, 1000, 10000, 100000};
+  std::vector<int> buffer_counts = {2, 3, 16};
+  int stream_size = 100000;
+  std::string stream_contents = subtle::Random::GetRandomBytes(stream_size);
+  for (auto buffer_size : buffer_sizes) {
+    for (auto buffer_count : buffer_counts) {
+      std::string filename = absl::StrCat(buffer_size, "_", buffer_count,
+                                          "_write_behind_buffer_test.bin");
+      int output_fd = GetTestFileDescriptor(filename);
+      auto output_stream =
+          absl::make_unique<util::WriteBehindFileOutputStream>(
+              output_fd, buffer_size, buffer_count);
+      void* buffer;
+      auto next_result = output_stream->Next(&buffer);
+      EXPECT_TRUE(next_result.ok()) << next_result.status();
+      EXPECT_EQ(buffer_size, next_result.ValueOrDie());
+      output_stream->BackUp(buffer_size);
+      auto status = WriteToStream(output_stream.get(), stream_contents);
+      EXPECT_TRUE(status.ok()) << status;
+      EXPECT_EQ(stream_contents, ReadFile(filename));
+    }
+  }
+}
+
+TEST(WriteBehindFileOutputStreamTest, BackupAndPosition) {
+  int stream_size = 1024 * 1024;
+  int buffer_size = 1234;
+  void* buffer;
+  std::string stream_contents = subtle::Random::GetRandomBytes(stream_size);
+  std::string filename =
+      absl::StrCat(buffer_size, "_write_behind_backup_test.bin");
+  int output_fd = GetTestFileDescriptor(filename);
+
+  auto output_stream = absl::make_unique<util::WriteBehindFileOutputStream>(
+      output_fd, buffer_size);
+  EXPECT_EQ(0, output_stream->Position());
+  auto next_result = output_stream->Next(&buffer);
+  EXPECT_TRUE(next_result.ok()) << next_result.status();
+  EXPECT_EQ(buffer_size, next_result.ValueOrDie());
+  EXPECT_EQ(buffer_size, output_stream->Position());
+  std::memcpy(buffer, stream_contents.data(), buffer_size);
+
+  // BackUp several times, but in total fewer bytes than returned by Next().
+  std::vector<int> backup_sizes = {0, 1, 5, 0, 10, 100, -42, 400, 20, -100};
+  int total_backup_size = 0;
+  for (auto backup_size : backup_sizes) {
+    output_stream->BackUp(backup_size);
+    total_backup_size += std::max(0, backup_size);
+    EXPECT_EQ(buffer_size - total_backup_size, output_stream->Position());
+  }
+  // Call Next(), it should return exactly the backed up space.
+  next_result = output_stream->Next(&buffer);
+  EXPECT_TRUE(next_result.ok()) << next_result.status();
+  EXPECT_EQ(total_backup_size, next_result.ValueOrDie());
+  EXPECT_EQ(buffer_size, output_stream->Position());
+  std::memcpy(buffer, stream_contents.data() + buffer_size - total_backup_size,
+              total_backup_size);
+
+  // BackUp more than returned by the last Next().
+  output_stream->BackUp(2 * buffer_size);
+  EXPECT_EQ(buffer_size - total_backup_size, output_stream->Position());
+  next_result = output_stream->Next(&buffer);
+  EXPECT_EQ(total_backup_size, next_result.ValueOrDie());
+
+  // Write the rest, and close the stream.
+  auto status = WriteToStream(
+      output_stream.get(),
+      absl::string_view(stream_contents).substr(buffer_size));
+  EXPECT_TRUE(status.ok()) << status;
+  EXPECT_EQ(stream_size, output_stream->Position());
+  EXPECT_EQ(stream_contents, ReadFile(filename));
+
+  // The stream is closed.
+  EXPECT_FALSE(output_stream->Next(&buffer).ok());
+  EXPECT_FALSE(output_stream->Close().ok());
+}
+
+TEST(WriteBehindFileOutputStreamTest, WriteError) {
+  std::string filename = "write_behind_error_test.bin";
+  close(GetTestFileDescriptor(filename));
+  // write() to a descriptor opened for reading fails with EBADF.
+  int output_fd = open(FullName(filename).c_str(), O_RDONLY);
+  ASSERT_NE(-1, output_fd);
+  auto output_stream = absl::make_unique<util::WriteBehindFileOutputStream>(
+      output_fd, 100, 2);
+  auto status = WriteToStream(output_stream.get(), std::string(1000, 'a'));
+  EXPECT_EQ(util::error::INTERNAL, status.error_code());
+  // Errors are permanent.
+  void* buffer;
+  EXPECT_EQ(util::error::INTERNAL,
+            output_stream->Next(&buffer).status().error_code());
+  EXPECT_EQ(util::error::INTERNAL, output_stream->Close().error_code());
+  EXPECT_EQ(0, output_stream->GetStats().bytes_written);
+}
+
+TEST(WriteBehindFileOutputStreamTest, DestroyedWithoutClose) {
+  std::string filename = "write_behind_destroy_test.bin";
+  std::string stream_contents = subtle::Random::GetRandomBytes(1000);
+  auto output_stream = absl::make_unique<util::WriteBehindFileOutputStream>(
+      GetTestFileDescriptor(filename), 100, 2);
+  void* buffer;
+  int pos = 0;
+  while (pos < stream_contents.size()) {
+    auto next_result = output_stream->Next(&buffer);
+    ASSERT_TRUE(next_result.ok()) << next_result.status();
+    std::memcpy(buffer, stream_contents.data() + pos, 100);
+    pos += 100;
+  }
+  // The destructor writes the pending buffers.
+  output_stream.reset();
+  EXPECT_EQ(stream_contents, ReadFile(filename));
+}
+
+}  // namespace
+}  // namespace tink
+}  // namespace crypto
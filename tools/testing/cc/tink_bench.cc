@@ -0,0 +1,607 @@
+// Copyright 2019 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tink/aead.h"
+#include "tink/cleartext_keyset_handle.h"
+#include "tink/deterministic_aead.h"
+#include "tink/hybrid_decrypt.h"
+#include "tink/hybrid_encrypt.h"
+#include "tink/keyset_handle.h"
+#include "tink/mac.h"
+#include "tink/public_key_sign.h"
+#include "tink/public_key_verify.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "tools/testing/cc/cli_util.h"
+#include "proto/tink.pb.h"
+
+using crypto::tink::Aead;
+using crypto::tink::CleartextKeysetHandle;
+using crypto::tink::DeterministicAead;
+using crypto::tink::HybridDecrypt;
+using crypto::tink::HybridEncrypt;
+using crypto::tink::KeysetHandle;
+using crypto::tink::Mac;
+using crypto::tink::PublicKeySign;
+using crypto::tink::PublicKeyVerify;
+using crypto::tink::util::Status;
+using crypto::tink::util::StatusOr;
+using google::crypto::tink::KeyData;
+
+// A load generator for the primitive of a keyset.
+// It requires the name of the file with the (binary, cleartext) keyset,
+// followed by options of the form --name=value:
+//   --operation:  the operation to measure, e.g. "encrypt" or "decrypt"
+//                 (default: the first operation of the primitive, see below)
+//   --message_size:  sizes of the messages, either "N" (default: 1024),
+//                    "uniform:MIN-MAX", or "choice:N1,N2,..." (each equally
+//                    likely)
+//   --associated_data_size:  size of associated data or context info
+//                            (default: 0)
+//   --threads:  number of threads issuing requests (default: 1)
+//   --duration_s:  duration of the measurement in seconds (default: 10)
+//   --rate:  requests per second of all threads together; 0 (default)
+//            means that each thread issues requests back to back
+//   --output:  name of the file for the JSON report (default: stdout)
+//
+// The primitive is chosen according to the primary key of the keyset:
+//   symmetric keys:    Aead (encrypt, decrypt), DeterministicAead
+//                      (encrypt, decrypt), Mac (compute, verify)
+//   private keys:      PublicKeySign (sign, verify),
+//                      HybridDecrypt (decrypt, encrypt)
+//   public keys:       HybridEncrypt (encrypt)
+// where operations of the public primitive of a private keyset use the
+// corresponding public keyset.
+//
+// With a positive --rate, requests are scheduled at fixed intervals,
+// independently of the completion of earlier requests, and their latency
+// is measured from the scheduled time, so that queueing delays of an
+// overloaded primitive show up in the latency percentiles.
+
+namespace {
+
+// Number of distinct messages (and their inputs) prepared in advance.
+const int kPoolSize = 1024;
+
+struct Options {
+  std::string keyset_filename;
+  std::string operation;
+  std::string message_size = "1024";
+  int associated_data_size = 0;
+  int threads = 1;
+  double duration_s = 10;
+  double rate = 0;
+  std::string output_filename;
+};
+
+[[noreturn]] void Fail(const std::string& message) {
+  std::clog << message << std::endl;
+  exit(1);
+}
+
+Options ParseOptions(int argc, char** argv) {
+  if (argc < 2) {
+    Fail(std::string("Usage: ") + argv[0] +
+         " keyset-file [--operation=OP] [--message_size=SIZES]"
+         " [--associated_data_size=N] [--threads=N] [--duration_s=S]"
+         " [--rate=R] [--output=FILE]");
+  }
+  Options options;
+  options.keyset_filename = argv[1];
+  for (int i = 2; i < argc; i++) {
+    std::string arg(argv[i]);
+    size_t equals = arg.find('=');
+    if (arg.compare(0, 2, "--") != 0 || equals == std::string::npos) {
+      Fail("Expected an option of the form --name=value, got '" + arg + "'.");
+    }
+    std::string name = arg.substr(2, equals - 2);
+    std::string value = arg.substr(equals + 1);
+    try {
+      if (name == "operation") {
+        options.operation = value;
+      } else if (name == "message_size") {
+        options.message_size = value;
+      } else if (name == "associated_data_size") {
+        options.associated_data_size = std::stoi(value);
+      } else if (name == "threads") {
+        options.threads = std::stoi(value);
+      } else if (name == "duration_s") {
+        options.duration_s = std::stod(value);
+      } else if (name == "rate") {
+        options.rate = std::stod(value);
+      } else if (name == "output") {
+        options.output_filename = value;
+      } else {
+        Fail("Unknown option '" + name + "'.");
+      }
+    } catch (const std::exception& e) {
+      Fail("Invalid value '" + value + "' of option '" + name + "'.");
+    }
+  }
+  if (options.threads < 1 || options.duration_s <= 0 || options.rate < 0 ||
+      options.associated_data_size < 0) {
+    Fail("Options out of range.");
+  }
+  return options;
+}
+
+// Message sizes, as specified by --message_size.
+class SizeDistribution {
+ public:
+  explicit SizeDistribution(const std::string& spec) : spec_(spec) {
+    try {
+      if (spec.compare(0, 8, "uniform:") == 0) {
+        size_t dash = spec.find('-', 8);
+        if (dash == std::string::npos) Fail("Expected uniform:MIN-MAX.");
+        min_ = std::stoi(spec.substr(8, dash - 8));
+        max_ = std::stoi(spec.substr(dash + 1));
+      } else if (spec.compare(0, 7, "choice:") == 0) {
+        std::stringstream sizes(spec.substr(7));
+        std::string size;
+        while (std::getline(sizes, size, ',')) {
+          choices_.push_back(std::stoi(size));
+        }
+      } else {
+        choices_.push_back(std::stoi(spec));
+      }
+    } catch (const std::exception& e) {
+      Fail("Invalid message sizes '" + spec + "'.");
+    }
+    bool valid = choices_.empty() ? (0 <= min_ && min_ <= max_)
+        : std::all_of(choices_.begin(), choices_.end(),
+                      [](int size) { return size >= 0; });
+    if (!valid) Fail("Invalid message sizes '" + spec + "'.");
+  }
+
+  int Sample(std::mt19937_64* rng) const {
+    if (choices_.empty()) {
+      return std::uniform_int_distribution<int>(min_, max_)(*rng);
+    }
+    return choices_[std::uniform_int_distribution<size_t>(
+        0, choices_.size() - 1)(*rng)];
+  }
+
+  const std::string& spec() const { return spec_; }
+
+ private:
+  std::string spec_;
+  int min_ = 0;
+  int max_ = 0;
+  std::vector<int> choices_;
+};
+
+std::string RandomBytes(int size, std::mt19937_64* rng) {
+  std::string bytes(size, '\0');
+  for (auto& byte : bytes) byte = static_cast<char>((*rng)() & 0xff);
+  return bytes;
+}
+
+// A histogram of latencies in nanoseconds, with a relative error below 2%:
+// values below 128 have their own buckets, and every larger power-of-two
+// range is split into 64 buckets.
+class LatencyHistogram {
+ public:
+  LatencyHistogram() : buckets_(kBucketCount, 0) {}
+
+  void Record(int64_t value) {
+    if (value < 0) value = 0;
+    buckets_[Bucket(value)]++;
+    count_++;
+    sum_ += value;
+    max_ = std::max(max_, value);
+  }
+
+  void Merge(const LatencyHistogram& other) {
+    for (int i = 0; i < kBucketCount; i++) buckets_[i] += other.buckets_[i];
+    count_ += other.count_;
+    sum_ += other.sum_;
+    max_ = std::max(max_, other.max_);
+  }
+
+  // Returns the upper bound of the bucket that holds the value at
+  // 'quantile' (in [0, 1]), or 0 if nothing was recorded.
+  int64_t Percentile(double quantile) const {
+    if (count_ == 0) return 0;
+    int64_t rank = static_cast<int64_t>(std::ceil(quantile * count_));
+    rank = std::max<int64_t>(rank, 1);
+    int64_t seen = 0;
+    for (int i = 0; i < kBucketCount; i++) {
+      seen += buckets_[i];
+      if (seen >= rank) return std::min(UpperBound(i), max_);
+    }
+    return max_;
+  }
+
+  int64_t count() const { return count_; }
+  int64_t max() const { return max_; }
+  double mean() const { return count_ == 0 ? 0 : 1.0 * sum_ / count_; }
+
+ private:
+  static const int kSubBuckets = 64;
+  static const int kBucketCount = 58 * kSubBuckets;
+
+  static int Bucket(int64_t value) {
+    if (value < 2 * kSubBuckets) return value;
+    int exponent = 63 - __builtin_clzll(value);
+    int shift = exponent - 6;
+    return (shift + 1) * kSubBuckets + ((value >> shift) - kSubBuckets);
+  }
+
+  static int64_t UpperBound(int bucket) {
+    if (bucket < 2 * kSubBuckets) return bucket;
+    int shift = bucket / kSubBuckets - 1;
+    int64_t mantissa = bucket % kSubBuckets + kSubBuckets;
+    return ((mantissa + 1) << shift) - 1;
+  }
+
+  std::vector<int64_t> buckets_;
+  int64_t count_ = 0;
+  int64_t sum_ = 0;
+  int64_t max_ = 0;
+};
+
+// One request, on the prepared message with the given index.
+using Request = std::function<Status(int index)>;
+
+struct Workload {
+  std::string primitive;
+  std::string operation;
+  Request request;
+};
+
+struct Messages {
+  std::vector<std::string> plaintexts;
+  std::string associated_data;
+};
+
+template <class P>
+std::unique_ptr<P> GetPrimitiveOrNull(const KeysetHandle& handle) {
+  auto primitive_result = handle.GetPrimitive<P>();
+  if (!primitive_result.ok()) return nullptr;
+  return std::move(primitive_result.ValueOrDie());
+}
+
+std::unique_ptr<KeysetHandle> GetPublicKeysetHandle(KeysetHandle* handle) {
+  auto public_handle_result = handle->GetPublicKeysetHandle();
+  if (!public_handle_result.ok()) {
+    Fail("Getting the public keyset failed: " +
+         public_handle_result.status().error_message());
+  }
+  return std::move(public_handle_result.ValueOrDie());
+}
+
+// Applies 'compute' to every prepared message, and returns the results.
+std::vector<std::string> Prepare(
+    const Messages& messages,
+    const std::function<StatusOr<std::string>(const std::string&)>& compute) {
+  std::vector<std::string> results;
+  for (const auto& plaintext : messages.plaintexts) {
+    auto result = compute(plaintext);
+    if (!result.ok()) {
+      Fail("Preparing the inputs failed: " + result.status().error_message());
+    }
+    results.push_back(result.ValueOrDie());
+  }
+  return results;
+}
+
+Status StatusOf(const StatusOr<std::string>& result) {
+  return result.status();
+}
+
+// Returns the workload for 'operation' (if empty, the default one) on
+// the primitive that matches the primary key of 'handle'.
+Workload GetWorkload(KeysetHandle* handle, std::string operation,
+                     std::shared_ptr<const Messages> messages) {
+  const auto& keyset = CleartextKeysetHandle::GetKeyset(*handle);
+  KeyData::KeyMaterialType key_material_type = KeyData::UNKNOWN_KEYMATERIAL;
+  for (const auto& key : keyset.key()) {
+    if (key.key_id() == keyset.primary_key_id()) {
+      key_material_type = key.key_data().key_material_type();
+    }
+  }
+  const std::string& ad = messages->associated_data;
+  auto unknown_operation = [&operation](const std::string& primitive) {
+    Fail("Unknown operation '" + operation + "' for " + primitive + ".");
+    return Workload();
+  };
+
+  if (key_material_type == KeyData::SYMMETRIC ||
+      key_material_type == KeyData::REMOTE) {
+    if (auto aead = GetPrimitiveOrNull<Aead>(*handle)) {
+      std::shared_ptr<Aead> shared(std::move(aead));
+      if (operation.empty()) operation = "encrypt";
+      if (operation == "encrypt") {
+        return {"Aead", operation, [shared, messages](int i) {
+          return StatusOf(shared->Encrypt(messages->plaintexts[i],
+                                          messages->associated_data));
+        }};
+      }
+      if (operation == "decrypt") {
+        auto ciphertexts = std::make_shared<std::vector<std::string>>(
+            Prepare(*messages, [&](const std::string& plaintext) {
+              return shared->Encrypt(plaintext, ad);
+            }));
+        return {"Aead", operation, [shared, messages, ciphertexts](int i) {
+          return StatusOf(shared->Decrypt((*ciphertexts)[i],
+                                          messages->associated_data));
+        }};
+      }
+      return unknown_operation("Aead");
+    }
+    if (auto daead = GetPrimitiveOrNull<DeterministicAead>(*handle)) {
+      std::shared_ptr<DeterministicAead> shared(std::move(daead));
+      if (operation.empty()) operation = "encrypt";
+      if (operation == "encrypt") {
+        return {"DeterministicAead", operation, [shared, messages](int i) {
+          return StatusOf(shared->EncryptDeterministically(
+              messages->plaintexts[i], messages->associated_data));
+        }};
+      }
+      if (operation == "decrypt") {
+        auto ciphertexts = std::make_shared<std::vector<std::string>>(
+            Prepare(*messages, [&](const std::string& plaintext) {
+              return shared->EncryptDeterministically(plaintext, ad);
+            }));
+        return {"DeterministicAead", operation,
+                [shared, messages, ciphertexts](int i) {
+          return StatusOf(shared->DecryptDeterministically(
+              (*ciphertexts)[i], messages->associated_data));
+        }};
+      }
+      return unknown_operation("DeterministicAead");
+    }
+    if (auto mac = GetPrimitiveOrNull<Mac>(*handle)) {
+      std::shared_ptr<Mac> shared(std::move(mac));
+      if (operation.empty()) operation = "compute";
+      if (operation == "compute") {
+        return {"Mac", operation, [shared, messages](int i) {
+          return StatusOf(shared->ComputeMac(messages->plaintexts[i]));
+        }};
+      }
+      if (operation == "verify") {
+        auto tags = std::make_shared<std::vector<std::string>>(
+            Prepare(*messages, [&](const std::string& plaintext) {
+              return shared->ComputeMac(plaintext);
+            }));
+        return {"Mac", operation, [shared, messages, tags](int i) {
+          return shared->VerifyMac((*tags)[i], messages->plaintexts[i]);
+        }};
+      }
+      return unknown_operation("Mac");
+    }
+  } else if (key_material_type == KeyData::ASYMMETRIC_PRIVATE) {
+    if (auto sign = GetPrimitiveOrNull<PublicKeySign>(*handle)) {
+      std::shared_ptr<PublicKeySign> shared(std::move(sign));
+      if (operation.empty()) operation = "sign";
+      if (operation == "sign") {
+        return {"PublicKeySign", operation, [shared, messages](int i) {
+          return StatusOf(shared->Sign(messages->plaintexts[i]));
+        }};
+      }
+      if (operation == "verify") {
+        auto signatures = std::make_shared<std::vector<std::string>>(
+            Prepare(*messages, [&](const std::string& plaintext) {
+              return shared->Sign(plaintext);
+            }));
+        std::shared_ptr<PublicKeyVerify> verify(
+            GetPrimitiveOrNull<PublicKeyVerify>(
+                *GetPublicKeysetHandle(handle)));
+        if (verify == nullptr) Fail("Getting PublicKeyVerify failed.");
+        return {"PublicKeyVerify", operation,
+                [verify, messages, signatures](int i) {
+          return verify->Verify((*signatures)[i], messages->plaintexts[i]);
+        }};
+      }
+      return unknown_operation("PublicKeySign");
+    }
+    if (auto decrypt = GetPrimitiveOrNull<HybridDecrypt>(*handle)) {
+      std::shared_ptr<HybridDecrypt> shared(std::move(decrypt));
+      std::shared_ptr<HybridEncrypt> encrypt(
+          GetPrimitiveOrNull<HybridEncrypt>(*GetPublicKeysetHandle(handle)));
+      if (encrypt == nullptr) Fail("Getting HybridEncrypt failed.");
+      if (operation.empty()) operation = "decrypt";
+      if (operation == "decrypt") {
+        auto ciphertexts = std::make_shared<std::vector<std::string>>(
+            Prepare(*messages, [&](const std::string& plaintext) {
+              return encrypt->Encrypt(plaintext, ad);
+            }));
+        return {"HybridDecrypt", operation,
+                [shared, messages, ciphertexts](int i) {
+          return StatusOf(shared->Decrypt((*ciphertexts)[i],
+                                          messages->associated_data));
+        }};
+      }
+      if (operation == "encrypt") {
+        return {"HybridEncrypt", operation, [encrypt, messages](int i) {
+          return StatusOf(encrypt->Encrypt(messages->plaintexts[i],
+                                           messages->associated_data));
+        }};
+      }
+      return unknown_operation("HybridDecrypt");
+    }
+  } else if (key_material_type == KeyData::ASYMMETRIC_PUBLIC) {
+    if (auto encrypt = GetPrimitiveOrNull<HybridEncrypt>(*handle)) {
+      std::shared_ptr<HybridEncrypt> shared(std::move(encrypt));
+      if (operation.empty()) operation = "encrypt";
+      if (operation == "encrypt") {
+        return {"HybridEncrypt", operation, [shared, messages](int i) {
+          return StatusOf(shared->Encrypt(messages->plaintexts[i],
+                                          messages->associated_data));
+        }};
+      }
+      return unknown_operation("HybridEncrypt");
+    }
+    if (GetPrimitiveOrNull<PublicKeyVerify>(*handle) != nullptr) {
+      Fail("Measuring PublicKeyVerify requires the private keyset, "
+           "to produce the signatures.");
+    }
+  }
+  Fail("No supported primitive for the primary key of the keyset.");
+  return Workload();
+}
+
+struct ThreadResult {
+  LatencyHistogram latencies;
+  int64_t errors = 0;
+  int64_t bytes = 0;
+  std::string first_error;
+};
+
+// Issues requests until 'end', either back to back (closed loop), or
+// every 'interval' starting at 'first_start' (open loop, if 'interval'
+// is positive).
+void RunThread(const Workload& workload, const Messages& messages,
+               std::chrono::steady_clock::time_point first_start,
+               std::chrono::steady_clock::time_point end,
+               std::chrono::nanoseconds interval, uint64_t seed,
+               ThreadResult* result) {
+  std::mt19937_64 rng(seed);
+  std::uniform_int_distribution<int> index_distribution(0, kPoolSize - 1);
+  auto scheduled = first_start;
+  while (true) {
+    if (interval.count() > 0) {
+      if (scheduled >= end) break;
+      std::this_thread::sleep_until(scheduled);
+    } else {
+      scheduled = std::chrono::steady_clock::now();
+      if (scheduled >= end) break;
+    }
+    int index = index_distribution(rng);
+    Status status = workload.request(index);
+    auto done = std::chrono::steady_clock::now();
+    if (status.ok()) {
+      result->latencies.Record(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              done - scheduled).count());
+      result->bytes += messages.plaintexts[index].size();
+    } else {
+      if (result->errors == 0) result->first_error = status.error_message();
+      result->errors++;
+    }
+    scheduled += interval;
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options = ParseOptions(argc, argv);
+  SizeDistribution sizes(options.message_size);
+
+  CliUtil::InitTink();
+  std::unique_ptr<KeysetHandle> keyset_handle =
+      CliUtil::ReadKeyset(options.keyset_filename);
+
+  std::clog << "Preparing " << kPoolSize << " messages...\n";
+  std::mt19937_64 rng(42);
+  auto messages = std::make_shared<Messages>();
+  for (int i = 0; i < kPoolSize; i++) {
+    messages->plaintexts.push_back(RandomBytes(sizes.Sample(&rng), &rng));
+  }
+  messages->associated_data = RandomBytes(options.associated_data_size, &rng);
+  Workload workload =
+      GetWorkload(keyset_handle.get(), options.operation, messages);
+
+  std::clog << "Running " << workload.primitive << "-" << workload.operation
+            << " on " << options.threads << " thread(s) for "
+            << options.duration_s << " s...\n";
+  std::chrono::nanoseconds interval(0);
+  if (options.rate > 0) {
+    interval = std::chrono::nanoseconds(
+        static_cast<int64_t>(1e9 * options.threads / options.rate));
+  }
+  auto start = std::chrono::steady_clock::now();
+  auto end = start + std::chrono::nanoseconds(
+      static_cast<int64_t>(1e9 * options.duration_s));
+  std::vector<ThreadResult> results(options.threads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < options.threads; t++) {
+    // In the open loop, the threads are staggered evenly over an interval.
+    auto first_start = start + interval * t / options.threads;
+    threads.emplace_back(RunThread, std::cref(workload), std::cref(*messages),
+                         first_start, end, interval, 1000 + t, &results[t]);
+  }
+  for (auto& thread : threads) thread.join();
+  double elapsed_s = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+
+  ThreadResult total;
+  for (const auto& result : results) {
+    total.latencies.Merge(result.latencies);
+    total.errors += result.errors;
+    total.bytes += result.bytes;
+    if (total.first_error.empty()) total.first_error = result.first_error;
+  }
+  if (total.errors > 0) {
+    std::clog << total.errors << " request(s) failed, the first one with: "
+              << total.first_error << std::endl;
+  }
+
+  const auto& keyset = CleartextKeysetHandle::GetKeyset(*keyset_handle);
+  std::string type_url;
+  for (const auto& key : keyset.key()) {
+    if (key.key_id() == keyset.primary_key_id()) {
+      type_url = key.key_data().type_url();
+    }
+  }
+  std::ostringstream json;
+  json << "{\n"
+       << "  \"type_url\": \"" << type_url << "\",\n"
+       << "  \"primitive\": \"" << workload.primitive << "\",\n"
+       << "  \"operation\": \"" << workload.operation << "\",\n"
+       << "  \"message_size\": \"" << sizes.spec() << "\",\n"
+       << "  \"associated_data_size\": " << options.associated_data_size
+       << ",\n"
+       << "  \"threads\": " << options.threads << ",\n"
+       << "  \"target_rate\": " << options.rate << ",\n"
+       << "  \"duration_s\": " << elapsed_s << ",\n"
+       << "  \"requests\": " << total.latencies.count() << ",\n"
+       << "  \"errors\": " << total.errors << ",\n"
+       << "  \"throughput_rps\": " << total.latencies.count() / elapsed_s
+       << ",\n"
+       << "  \"throughput_mbps\": " << total.bytes / elapsed_s / 1e6 << ",\n"
+       << "  \"latency_ns\": {\n"
+       << "    \"mean\": " << static_cast<int64_t>(total.latencies.mean())
+       << ",\n"
+       << "    \"p50\": " << total.latencies.Percentile(0.5) << ",\n"
+       << "    \"p99\": " << total.latencies.Percentile(0.99) << ",\n"
+       << "    \"p999\": " << total.latencies.Percentile(0.999) << ",\n"
+       << "    \"max\": " << total.latencies.max() << "\n"
+       << "  }\n"
+       << "}\n";
+  if (options.output_filename.empty()) {
+    std::cout << json.str();
+  } else {
+    CliUtil::Write(json.str(), options.output_filename);
+  }
+  std::clog << "All done.\n";
+  return 0;
+}
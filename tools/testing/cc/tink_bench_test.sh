@@ -0,0 +1,75 @@
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+################################################################################
+
+
+#!/bin/bash
+
+ROOT_DIR="$TEST_SRCDIR/tink"
+TINK_BENCH="$ROOT_DIR/tools/testing/cc/tink_bench"
+TEST_UTIL="$ROOT_DIR/tools/testing/cross_language/test_util.sh"
+
+source $TEST_UTIL || exit 1
+
+#############################################################################
+### Helpers for tink_bench-tests.
+
+# Runs tink_bench with keyset $1 and the remaining arguments as options,
+# and checks the primitive and operation in the report.
+bench_test() {
+  local test_name="$1"
+  local keyset_file="$2"
+  local expected_primitive="$3"
+  local expected_operation="$4"
+  shift 4
+  local report_file="$TEST_TMPDIR/${test_name}_report.json"
+  echo "+++ starting test $test_name ..."
+  $TINK_BENCH $keyset_file --duration_s=0.2 --output=$report_file "$@"\
+      || exit 1
+  assert_file_contains $report_file\
+      "\"primitive\": \"$expected_primitive\""\
+      "\"operation\": \"$expected_operation\""\
+      "\"errors\": 0"\
+      "\"p999\""
+}
+
+#############################################################################
+##### Run the actual tests.
+
+generate_symmetric_key "bench_aead" AES128_GCM
+bench_test "aead_encrypt" $symmetric_key_file "Aead" "encrypt"\
+    --message_size=uniform:0-4096 --associated_data_size=16
+bench_test "aead_decrypt" $symmetric_key_file "Aead" "decrypt"\
+    --operation=decrypt --threads=4
+bench_test "aead_open_loop" $symmetric_key_file "Aead" "encrypt"\
+    --threads=2 --rate=1000
+
+generate_symmetric_key "bench_daead" AES256_SIV
+bench_test "daead_decrypt" $symmetric_key_file "DeterministicAead" "decrypt"\
+    --operation=decrypt --message_size=choice:16,1024
+
+generate_symmetric_key "bench_mac" HMAC_SHA256_128BITTAG
+bench_test "mac_verify" $symmetric_key_file "Mac" "verify" --operation=verify
+
+generate_asymmetric_keys "bench_signature" ECDSA_P256
+bench_test "sign" $priv_key_file "PublicKeySign" "sign"
+bench_test "verify" $priv_key_file "PublicKeyVerify" "verify"\
+    --operation=verify
+
+generate_asymmetric_keys "bench_hybrid" ECIES_P256_HKDF_HMAC_SHA256_AES128_GCM
+bench_test "hybrid_decrypt" $priv_key_file "HybridDecrypt" "decrypt"
+bench_test "hybrid_encrypt" $pub_key_file "HybridEncrypt" "encrypt"
+
+# Unknown operations are rejected.
+log_file="$TEST_TMPDIR/unknown_operation.log"
+$TINK_BENCH $pub_key_file --operation=sign 2> $log_file && exit 1
+assert_file_contains $log_file "Unknown operation 'sign'"